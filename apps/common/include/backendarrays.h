@@ -0,0 +1,67 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision: $
+// $Date: $
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt in
+// the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+ * @file
+ * backendarrays.h
+ *
+ * @brief Arrays in device memory, or in host memory for algorithms run
+ * with CUDPP_OPTION_HOST
+ */
+
+#ifndef _BACKEND_ARRAYS_H_
+#define _BACKEND_ARRAYS_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cuda_runtime_api.h>
+
+#include "cuda_util.h"
+
+namespace cudpp_app {
+
+    //! Allocates \a count elements on the device, or on the host if \a host
+    template <typename T>
+    T* backendAlloc(bool host, size_t count)
+    {
+        T *p = NULL;
+        if (host)
+            p = (T*) malloc(sizeof(T) * (count ? count : 1));
+        else
+            CUDA_SAFE_CALL( cudaMalloc( (void**) &p, sizeof(T) * (count ? count : 1)));
+        return p;
+    }
+
+    //! Frees an array allocated by backendAlloc()
+    template <typename T>
+    void backendFree(bool host, T *p)
+    {
+        if (host)
+            free(p);
+        else
+            cudaFree(p);
+    }
+
+    //! Copies \a count elements to (\a toDevice) or from the backend's memory
+    template <typename T>
+    void backendCopy(bool host, T *dst, const T *src, size_t count, bool toDevice)
+    {
+        if (host)
+            memcpy(dst, src, sizeof(T) * count);
+        else
+            CUDA_SAFE_CALL( cudaMemcpy(dst, src, sizeof(T) * count,
+                                       toDevice ? cudaMemcpyHostToDevice :
+                                                  cudaMemcpyDeviceToHost) );
+    }
+
+} // namespace cudpp_app
+
+#endif // _BACKEND_ARRAYS_H_
@@ -0,0 +1,137 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision: $
+// $Date: $
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt in
+// the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+ * @file
+ * sparsematrix.h
+ *
+ * @brief Sparse matrix file loading: Matrix Market and binary CSR
+ */
+
+#ifndef _SPARSEMATRIX_H_
+#define _SPARSEMATRIX_H_
+
+#include <cstddef>
+
+#ifdef WIN32
+#define WINDOWS_LEAN_AND_MEAN
+#include <windows.h>
+#undef min
+#undef max
+#endif
+
+namespace cudpp_app {
+
+    //! Read-only memory mapping of a whole file
+    class MappedFile
+    {
+    public:
+        MappedFile();
+        ~MappedFile();
+
+        //! Map \a filename; returns false if it cannot be opened or mapped
+        bool open(const char * filename);
+
+        //! Unmap the file
+        void close();
+
+        const char * data() const { return m_data; }
+        size_t size() const { return m_size; }
+        bool isOpen() const { return m_isOpen; }
+
+    private:
+        MappedFile(const MappedFile &);
+        MappedFile & operator=(const MappedFile &);
+
+        const char * m_data;
+        size_t       m_size;
+        bool         m_isOpen;
+    #ifdef WIN32
+        HANDLE       m_file;
+        HANDLE       m_mapping;
+    #endif
+    };
+
+    /**
+     * @brief Sparse matrix in compressed sparse row (CSR) format
+     *
+     * Rows are sorted by column; duplicate entries are kept.  The row
+     * pointer array has getRows() + 1 elements, so getRowPtrs() can be
+     * passed directly to cudppSparseMatrix().
+     *
+     * readMatrixMarket() maps the file and parses it in parallel chunks
+     * (with OpenMP, when enabled) with a specialized number parser, then
+     * builds CSR with a parallel counting sort by row instead of a
+     * comparison sort of all entries.  writeBinary() stores the result in
+     * a compact binary file that readBinary() maps without parsing or
+     * copying: the arrays then point into the mapping.
+     */
+    template <typename T>
+    class SparseMatrixCSR
+    {
+    public:
+        SparseMatrixCSR();
+        ~SparseMatrixCSR();
+
+        //! Parse a Matrix Market coordinate file (real, integer or pattern;
+        //! general, symmetric or skew-symmetric)
+        bool readMatrixMarket(const char * filename);
+
+        //! Map a binary CSR file written by writeBinary() with the same \a T;
+        //! files with out-of-range row pointers or column indices are rejected
+        bool readBinary(const char * filename);
+
+        //! Write the matrix as a binary CSR file (native byte order)
+        bool writeBinary(const char * filename) const;
+
+        //! Free the arrays or unmap the binary file
+        void clear();
+
+        unsigned int getRows() const { return m_rows; }
+        unsigned int getCols() const { return m_cols; }
+        unsigned int getNumEntries() const { return m_numEntries; }
+        const unsigned int * getRowPtrs() const { return m_rowPtrs; }
+        const unsigned int * getColIndices() const { return m_colIndices; }
+        const T * getValues() const { return m_values; }
+
+    private:
+        SparseMatrixCSR(const SparseMatrixCSR &);
+        SparseMatrixCSR & operator=(const SparseMatrixCSR &);
+
+        unsigned int         m_rows;
+        unsigned int         m_cols;
+        unsigned int         m_numEntries;
+        const unsigned int * m_rowPtrs;
+        const unsigned int * m_colIndices;
+        const T *            m_values;
+        MappedFile           m_file; //!< The binary file the arrays point into, if open
+    };
+
+    //! Load \a filename into \a m.  Files ending in .csr are read as binary
+    //! directly.  If \a cacheDir is not NULL, a Matrix Market file is also
+    //! cached in binary as \a cacheDir/<file name>.csr, which is read
+    //! instead when it is at least as new, and written otherwise.
+    template <typename T>
+    bool loadSparseMatrix(SparseMatrixCSR<T> & m, const char * filename,
+                          const char * cacheDir = NULL);
+
+}
+
+#ifdef CUDPP_APP_COMMON_IMPL
+#include "sparsematrix.inl"
+#endif
+
+#endif  //#ifndef _SPARSEMATRIX_H_
+
+// Leave this at the end of the file
+// Local Variables:
+// mode:c++
+// c-file-style: "NVIDIA"
+// End:
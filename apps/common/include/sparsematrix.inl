@@ -0,0 +1,688 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision: $
+// $Date: $
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt in
+// the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+ * @file
+ * sparsematrix.inl
+ *
+ * @brief Sparse matrix file loading: Matrix Market and binary CSR
+ */
+
+#ifdef CUDPP_APP_COMMON_IMPL
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <climits>
+#include <limits>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Scattering entries to their rows in parallel needs OpenMP 3.1 atomic capture
+#if defined(_OPENMP) && (_OPENMP >= 201107)
+#define CUDPP_APP_PARALLEL_SCATTER 1
+#else
+#define CUDPP_APP_PARALLEL_SCATTER 0
+#endif
+
+namespace cudpp_app {
+
+    MappedFile::MappedFile() : m_data(0), m_size(0), m_isOpen(false)
+    #ifdef WIN32
+        , m_file(INVALID_HANDLE_VALUE), m_mapping(0)
+    #endif
+    {
+    }
+
+    MappedFile::~MappedFile()
+    {
+        close();
+    }
+
+    bool MappedFile::open(const char * filename)
+    {
+        close();
+    #ifdef WIN32
+        m_file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, 0,
+                             OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, 0);
+        if (m_file == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(m_file, &size))
+        {
+            close();
+            return false;
+        }
+        m_size = (size_t)size.QuadPart;
+        if (m_size > 0)
+        {
+            m_mapping = CreateFileMappingA(m_file, 0, PAGE_READONLY, 0, 0, 0);
+            if (m_mapping)
+                m_data = (const char *)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+            if (!m_data)
+            {
+                close();
+                return false;
+            }
+        }
+    #else
+        int fd = ::open(filename, O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        m_size = (size_t)st.st_size;
+        if (m_size > 0)
+        {
+            void * p = mmap(0, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED)
+            {
+                ::close(fd);
+                m_size = 0;
+                return false;
+            }
+            m_data = (const char *)p;
+        }
+        ::close(fd);
+    #endif
+        m_isOpen = true;
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+    #ifdef WIN32
+        if (m_data)
+            UnmapViewOfFile(m_data);
+        if (m_mapping)
+            CloseHandle(m_mapping);
+        if (m_file != INVALID_HANDLE_VALUE)
+            CloseHandle(m_file);
+        m_mapping = 0;
+        m_file = INVALID_HANDLE_VALUE;
+    #else
+        if (m_data)
+            munmap((void *)m_data, m_size);
+    #endif
+        m_data = 0;
+        m_size = 0;
+        m_isOpen = false;
+    }
+
+    //! Skip spaces and tabs
+    inline const char * skipBlanks(const char * p, const char * end)
+    {
+        while (p < end && (*p == ' ' || *p == '\t'))
+            ++p;
+        return p;
+    }
+
+    //! Skip to the start of the next line
+    inline const char * skipLine(const char * p, const char * end)
+    {
+        const char * eol = (const char *)memchr(p, '\n', end - p);
+        return eol ? eol + 1 : end;
+    }
+
+    //! Whether the line at \a p holds data, i.e. is not blank or a comment
+    inline bool isDataLine(const char * p, const char * end)
+    {
+        p = skipBlanks(p, end);
+        return p < end && *p != '%' && *p != '\n' && *p != '\r';
+    }
+
+    //! Parse an unsigned decimal integer; returns NULL if there is none
+    inline const char * parseUnsigned(const char * p, const char * end, size_t * value)
+    {
+        p = skipBlanks(p, end);
+        if (p == end || *p < '0' || *p > '9')
+            return 0;
+
+        size_t v = 0;
+        for (; p < end && *p >= '0' && *p <= '9'; ++p)
+            v = v * 10 + (*p - '0');
+        *value = v;
+        return p;
+    }
+
+    //! Parse a real number with strtod; returns NULL if there is none
+    inline const char * parseRealSlow(const char * p, const char * end, double * value)
+    {
+        char token[64];
+        size_t n = 0;
+        while (p + n < end && n < sizeof(token) - 1 && !isspace((unsigned char)p[n]))
+        {
+            token[n] = p[n];
+            ++n;
+        }
+        token[n] = 0;
+
+        char * tokenEnd;
+        *value = strtod(token, &tokenEnd);
+        return (tokenEnd == token) ? 0 : p + (tokenEnd - token);
+    }
+
+    /** Parse a real number; returns NULL if there is none.
+     *
+     * Numbers whose significant digits and power of ten are both exact in
+     * double precision, which covers nearly all matrix files, are converted
+     * with one multiply or divide, which is correctly rounded; anything
+     * else (long mantissas, large exponents, inf, nan) falls back to strtod.
+     */
+    inline const char * parseReal(const char * p, const char * end, double * value)
+    {
+        static const double powersOf10[] = {
+            1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+        p = skipBlanks(p, end);
+        const char * start = p;
+
+        bool isNegative = false;
+        if (p < end && (*p == '-' || *p == '+'))
+            isNegative = (*p++ == '-');
+
+        unsigned long long mantissa = 0;
+        int numDigits = 0;
+        int exponent = 0;
+        bool hasDigits = false;
+        for (; p < end && *p >= '0' && *p <= '9'; ++p, hasDigits = true)
+        {
+            if (numDigits < 19)
+            {
+                mantissa = mantissa * 10 + (*p - '0');
+                numDigits += (mantissa != 0);
+            }
+            else
+                ++exponent;
+        }
+        if (p < end && *p == '.')
+        {
+            for (++p; p < end && *p >= '0' && *p <= '9'; ++p, hasDigits = true)
+            {
+                if (numDigits < 19)
+                {
+                    mantissa = mantissa * 10 + (*p - '0');
+                    numDigits += (mantissa != 0);
+                    --exponent;
+                }
+            }
+        }
+        if (!hasDigits)
+            return parseRealSlow(start, end, value);
+
+        if (p < end && (*p == 'e' || *p == 'E'))
+        {
+            const char * q = p + 1;
+            bool isNegativeExponent = false;
+            if (q < end && (*q == '-' || *q == '+'))
+                isNegativeExponent = (*q++ == '-');
+            if (q < end && *q >= '0' && *q <= '9')
+            {
+                int e = 0;
+                for (; q < end && *q >= '0' && *q <= '9'; ++q)
+                    if (e < 100000)
+                        e = e * 10 + (*q - '0');
+                exponent += isNegativeExponent ? -e : e;
+                p = q;
+            }
+        }
+
+        if (mantissa >= (1ULL << 53) || exponent < -22 || exponent > 22)
+            return parseRealSlow(start, end, value);
+
+        double v = (double)mantissa;
+        v = (exponent < 0) ? v / powersOf10[-exponent] : v * powersOf10[exponent];
+        *value = isNegative ? -v : v;
+        return p;
+    }
+
+    //! Put an entry in the next free slot of its row
+    template <typename T>
+    inline void placeEntry(unsigned int * next, unsigned int * colIndices, T * values,
+                           unsigned int row, unsigned int col, T value)
+    {
+        unsigned int slot;
+    #if CUDPP_APP_PARALLEL_SCATTER
+    #pragma omp atomic capture
+    #endif
+        slot = next[row]++;
+        colIndices[slot] = col;
+        values[slot] = value;
+    }
+
+    //! Sort the entries of a row by column (then value, so the order is deterministic)
+    template <typename T>
+    void sortRowByColumn(unsigned int * colIndices, T * values, size_t n)
+    {
+        if (n <= 32)
+        {
+            for (size_t i = 1; i < n; ++i)
+            {
+                unsigned int col = colIndices[i];
+                T value = values[i];
+                size_t j = i;
+                for (; j > 0 && (colIndices[j-1] > col ||
+                                 (colIndices[j-1] == col && values[j-1] > value)); --j)
+                {
+                    colIndices[j] = colIndices[j-1];
+                    values[j] = values[j-1];
+                }
+                colIndices[j] = col;
+                values[j] = value;
+            }
+            return;
+        }
+
+        std::vector<std::pair<unsigned int, T> > entries(n);
+        for (size_t i = 0; i < n; ++i)
+            entries[i] = std::make_pair(colIndices[i], values[i]);
+        std::sort(entries.begin(), entries.end());
+        for (size_t i = 0; i < n; ++i)
+        {
+            colIndices[i] = entries[i].first;
+            values[i] = entries[i].second;
+        }
+    }
+
+    //! Binary CSR file layout: a 64-byte header, then the row pointers,
+    //! column indices and values, each starting on an 8-byte boundary
+    const size_t BINARY_CSR_HEADER_SIZE = 64;
+    const unsigned int BINARY_CSR_VERSION = 1;
+
+    inline size_t alignBinaryCSROffset(size_t offset)
+    {
+        return (offset + 7) & ~(size_t)7;
+    }
+
+    //! Identifies the value type of a binary CSR file beyond its size
+    template <typename T>
+    inline unsigned int binaryCSRValueKind()
+    {
+        return std::numeric_limits<T>::is_integer ?
+            (std::numeric_limits<T>::is_signed ? 1 : 0) : 2;
+    }
+
+    template <typename T>
+    SparseMatrixCSR<T>::SparseMatrixCSR() :
+        m_rows(0), m_cols(0), m_numEntries(0),
+        m_rowPtrs(0), m_colIndices(0), m_values(0)
+    {
+    }
+
+    template <typename T>
+    SparseMatrixCSR<T>::~SparseMatrixCSR()
+    {
+        clear();
+    }
+
+    template <typename T>
+    void SparseMatrixCSR<T>::clear()
+    {
+        if (m_file.isOpen())
+            m_file.close();
+        else
+        {
+            delete [] const_cast<unsigned int *>(m_rowPtrs);
+            delete [] const_cast<unsigned int *>(m_colIndices);
+            delete [] const_cast<T *>(m_values);
+        }
+        m_rows = m_cols = m_numEntries = 0;
+        m_rowPtrs = 0;
+        m_colIndices = 0;
+        m_values = 0;
+    }
+
+    template <typename T>
+    bool SparseMatrixCSR<T>::readMatrixMarket(const char * filename)
+    {
+        clear();
+
+        MappedFile file;
+        if (!file.open(filename))
+            return false;
+
+        const char * p = file.data();
+        const char * end = p + file.size();
+
+        // The banner gives the entry type and the symmetry
+        bool isPattern = false;
+        bool isSymmetric = false;
+        bool isSkewSymmetric = false;
+        if (end - p >= 14 && strncmp(p, "%%MatrixMarket", 14) == 0)
+        {
+            const char * eol = skipLine(p, end);
+            std::string banner(p, eol);
+            for (size_t i = 0; i < banner.size(); ++i)
+                banner[i] = (char)tolower((unsigned char)banner[i]);
+
+            if (banner.find("coordinate") == std::string::npos ||
+                banner.find("complex") != std::string::npos)
+                return false;
+            isPattern = (banner.find("pattern") != std::string::npos);
+            isSkewSymmetric = (banner.find("skew-symmetric") != std::string::npos);
+            isSymmetric = !isSkewSymmetric &&
+                          (banner.find("symmetric") != std::string::npos ||
+                           banner.find("hermitian") != std::string::npos);
+            p = eol;
+        }
+        bool isMirrored = isSymmetric || isSkewSymmetric;
+
+        while (p < end && !isDataLine(p, end))
+            p = skipLine(p, end);
+
+        size_t rows, cols, count;
+        if (!(p = parseUnsigned(p, end, &rows)) ||
+            !(p = parseUnsigned(p, end, &cols)) ||
+            !(p = parseUnsigned(p, end, &count)) ||
+            rows == 0 || rows > UINT_MAX || cols > UINT_MAX)
+            return false;
+        p = skipLine(p, end);
+
+        // Split the entries into chunks at line boundaries and count the
+        // entries of each, so every chunk knows where its entries go
+        int numChunks = 1;
+    #ifdef _OPENMP
+        numChunks = 4 * omp_get_max_threads();
+    #endif
+        size_t bodySize = end - p;
+        std::vector<const char *> chunkStart(numChunks + 1);
+        chunkStart[0] = p;
+        chunkStart[numChunks] = end;
+        for (int c = 1; c < numChunks; ++c)
+        {
+            const char * q = p + (size_t)((double)bodySize * c / numChunks);
+            if (q > p && q[-1] != '\n')
+                q = skipLine(q, end);
+            chunkStart[c] = std::max(q, chunkStart[c-1]);
+        }
+
+        std::vector<size_t> chunkOffset(numChunks + 1, 0);
+    #pragma omp parallel for schedule(dynamic)
+        for (int c = 0; c < numChunks; ++c)
+        {
+            size_t n = 0;
+            for (const char * q = chunkStart[c]; q < chunkStart[c+1]; q = skipLine(q, end))
+                n += isDataLine(q, end);
+            chunkOffset[c+1] = n;
+        }
+        for (int c = 0; c < numChunks; ++c)
+            chunkOffset[c+1] += chunkOffset[c];
+        if (chunkOffset[numChunks] != count)
+            return false;
+
+        // Parse the entries in parallel and count the entries of each row
+        unsigned int * entryRow = new unsigned int[count];
+        unsigned int * entryCol = new unsigned int[count];
+        T * entryValue = new T[count];
+        unsigned int * rowPtrs = new unsigned int[rows + 1];
+        memset(rowPtrs, 0, (rows + 1) * sizeof(unsigned int));
+        std::vector<int> isChunkValid(numChunks, 1);
+
+    #pragma omp parallel for schedule(dynamic)
+        for (int c = 0; c < numChunks; ++c)
+        {
+            size_t k = chunkOffset[c];
+            for (const char * q = chunkStart[c]; q < chunkStart[c+1]; q = skipLine(q, end))
+            {
+                if (!isDataLine(q, end))
+                    continue;
+
+                size_t row, col;
+                double value = 1.0;
+                if (!(q = parseUnsigned(q, end, &row)) ||
+                    !(q = parseUnsigned(q, end, &col)) ||
+                    (!isPattern && !(q = parseReal(q, end, &value))) ||
+                    row < 1 || row > rows || col < 1 || col > cols ||
+                    (isMirrored && col > rows))
+                {
+                    isChunkValid[c] = 0;
+                    break;
+                }
+
+                entryRow[k] = (unsigned int)(row - 1);
+                entryCol[k] = (unsigned int)(col - 1);
+                entryValue[k] = (T)value;
+                ++k;
+
+    #pragma omp atomic
+                rowPtrs[row]++;
+                if (isMirrored && row != col)
+                {
+    #pragma omp atomic
+                    rowPtrs[col]++;
+                }
+            }
+        }
+
+        bool isValid = true;
+        for (int c = 0; c < numChunks; ++c)
+            isValid = isValid && isChunkValid[c];
+
+        size_t numEntries = 0;
+        for (size_t r = 1; r <= rows; ++r)
+            numEntries += rowPtrs[r];
+        isValid = isValid && (numEntries <= UINT_MAX);
+
+        if (!isValid)
+        {
+            delete [] entryRow;
+            delete [] entryCol;
+            delete [] entryValue;
+            delete [] rowPtrs;
+            return false;
+        }
+
+        // Counting sort by row: scatter each entry (and its mirror image)
+        // to the next free slot of its row, then sort each row by column
+        for (size_t r = 0; r < rows; ++r)
+            rowPtrs[r+1] += rowPtrs[r];
+
+        unsigned int * colIndices = new unsigned int[numEntries];
+        T * values = new T[numEntries];
+        unsigned int * next = new unsigned int[rows];
+        memcpy(next, rowPtrs, rows * sizeof(unsigned int));
+
+        long long numFileEntries = (long long)count;
+    #pragma omp parallel for if (CUDPP_APP_PARALLEL_SCATTER)
+        for (long long k = 0; k < numFileEntries; ++k)
+        {
+            unsigned int row = entryRow[k];
+            unsigned int col = entryCol[k];
+            placeEntry(next, colIndices, values, row, col, entryValue[k]);
+            if (isMirrored && row != col)
+                placeEntry(next, colIndices, values, col, row,
+                           isSkewSymmetric ? (T)-entryValue[k] : entryValue[k]);
+        }
+
+        delete [] next;
+        delete [] entryRow;
+        delete [] entryCol;
+        delete [] entryValue;
+
+        long long numRows = (long long)rows;
+    #pragma omp parallel for schedule(dynamic, 1024)
+        for (long long r = 0; r < numRows; ++r)
+            sortRowByColumn(colIndices + rowPtrs[r], values + rowPtrs[r],
+                            rowPtrs[r+1] - rowPtrs[r]);
+
+        m_rows = (unsigned int)rows;
+        m_cols = (unsigned int)cols;
+        m_numEntries = (unsigned int)numEntries;
+        m_rowPtrs = rowPtrs;
+        m_colIndices = colIndices;
+        m_values = values;
+        return true;
+    }
+
+    template <typename T>
+    bool SparseMatrixCSR<T>::writeBinary(const char * filename) const
+    {
+        FILE * f = fopen(filename, "wb");
+        if (!f)
+            return false;
+
+        unsigned char header[BINARY_CSR_HEADER_SIZE];
+        memset(header, 0, sizeof(header));
+        unsigned int version = BINARY_CSR_VERSION;
+        unsigned int valueSize = sizeof(T);
+        unsigned int valueKind = binaryCSRValueKind<T>();
+        unsigned long long rows = m_rows;
+        unsigned long long cols = m_cols;
+        unsigned long long numEntries = m_numEntries;
+        memcpy(header, "CUDPPCSR", 8);
+        memcpy(header + 8, &version, 4);
+        memcpy(header + 12, &valueSize, 4);
+        memcpy(header + 16, &valueKind, 4);
+        memcpy(header + 24, &rows, 8);
+        memcpy(header + 32, &cols, 8);
+        memcpy(header + 40, &numEntries, 8);
+
+        const char padding[8] = { 0 };
+        size_t numRowPtrs = (size_t)m_rows + 1;
+        size_t rowPtrsEnd = BINARY_CSR_HEADER_SIZE + numRowPtrs * sizeof(unsigned int);
+        size_t colIndicesEnd = alignBinaryCSROffset(rowPtrsEnd) +
+                               (size_t)m_numEntries * sizeof(unsigned int);
+
+        bool isWritten =
+            fwrite(header, 1, sizeof(header), f) == sizeof(header) &&
+            fwrite(m_rowPtrs, sizeof(unsigned int), numRowPtrs, f) == numRowPtrs &&
+            fwrite(padding, 1, alignBinaryCSROffset(rowPtrsEnd) - rowPtrsEnd, f) ==
+                alignBinaryCSROffset(rowPtrsEnd) - rowPtrsEnd &&
+            fwrite(m_colIndices, sizeof(unsigned int), m_numEntries, f) == m_numEntries &&
+            fwrite(padding, 1, alignBinaryCSROffset(colIndicesEnd) - colIndicesEnd, f) ==
+                alignBinaryCSROffset(colIndicesEnd) - colIndicesEnd &&
+            fwrite(m_values, sizeof(T), m_numEntries, f) == m_numEntries;
+
+        isWritten = (fclose(f) == 0) && isWritten;
+        if (!isWritten)
+            remove(filename);
+        return isWritten;
+    }
+
+    template <typename T>
+    bool SparseMatrixCSR<T>::readBinary(const char * filename)
+    {
+        clear();
+        if (!m_file.open(filename))
+            return false;
+
+        const char * data = m_file.data();
+        size_t size = m_file.size();
+
+        unsigned int version = 0, valueSize = 0, valueKind = 0;
+        unsigned long long rows = 0, cols = 0, numEntries = 0;
+        if (size >= BINARY_CSR_HEADER_SIZE && memcmp(data, "CUDPPCSR", 8) == 0)
+        {
+            memcpy(&version, data + 8, 4);
+            memcpy(&valueSize, data + 12, 4);
+            memcpy(&valueKind, data + 16, 4);
+            memcpy(&rows, data + 24, 8);
+            memcpy(&cols, data + 32, 8);
+            memcpy(&numEntries, data + 40, 8);
+        }
+
+        size_t colIndicesOffset = alignBinaryCSROffset(BINARY_CSR_HEADER_SIZE +
+                                                       (size_t)(rows + 1) * sizeof(unsigned int));
+        size_t valuesOffset = alignBinaryCSROffset(colIndicesOffset +
+                                                   (size_t)numEntries * sizeof(unsigned int));
+
+        if (version != BINARY_CSR_VERSION || valueSize != sizeof(T) ||
+            valueKind != binaryCSRValueKind<T>() ||
+            rows > UINT_MAX || cols > UINT_MAX || numEntries > UINT_MAX ||
+            valuesOffset + (size_t)numEntries * sizeof(T) > size)
+        {
+            m_file.close();
+            return false;
+        }
+
+        // A corrupt file must not make the users of the arrays index out
+        // of bounds: check the row pointers and column indices
+        const unsigned int * rowPtrs = (const unsigned int *)(data + BINARY_CSR_HEADER_SIZE);
+        const unsigned int * colIndices = (const unsigned int *)(data + colIndicesOffset);
+        long long numRows = (long long)rows;
+        long long numCols = (long long)cols;
+        long long numBad = (rowPtrs[0] != 0 || rowPtrs[rows] != numEntries) ? 1 : 0;
+    #pragma omp parallel for reduction(+:numBad)
+        for (long long r = 0; r < numRows; ++r)
+            numBad += (rowPtrs[r] > rowPtrs[r+1]) ? 1 : 0;
+    #pragma omp parallel for reduction(+:numBad)
+        for (long long i = 0; i < (long long)numEntries; ++i)
+            numBad += (colIndices[i] >= numCols) ? 1 : 0;
+        if (numBad != 0)
+        {
+            m_file.close();
+            return false;
+        }
+
+        m_rows = (unsigned int)rows;
+        m_cols = (unsigned int)cols;
+        m_numEntries = (unsigned int)numEntries;
+        m_rowPtrs = rowPtrs;
+        m_colIndices = colIndices;
+        m_values = (const T *)(data + valuesOffset);
+        return true;
+    }
+
+    template <typename T>
+    bool loadSparseMatrix(SparseMatrixCSR<T> & m, const char * filename,
+                          const char * cacheDir)
+    {
+        std::string name(filename);
+        if (name.size() > 4 && name.compare(name.size() - 4, 4, ".csr") == 0)
+            return m.readBinary(filename);
+
+        if (cacheDir == NULL)
+            return m.readMatrixMarket(filename);
+
+        size_t slash = name.find_last_of("/\\");
+        std::string cache = std::string(cacheDir) + "/" +
+            ((slash == std::string::npos) ? name : name.substr(slash + 1)) + ".csr";
+        struct stat source, cached;
+        if (stat(filename, &source) == 0 && stat(cache.c_str(), &cached) == 0 &&
+            cached.st_mtime >= source.st_mtime && m.readBinary(cache.c_str()))
+            return true;
+
+        if (!m.readMatrixMarket(filename))
+            return false;
+
+        // The cache is only an optimization, e.g. the directory may be read-only
+        m.writeBinary(cache.c_str());
+        return true;
+    }
+
+}
+
+#endif // CUDPP_APP_COMMON_IMPL
+
+// Leave this at the end of the file
+// Local Variables:
+// mode:c++
+// c-file-style: "NVIDIA"
+// End:
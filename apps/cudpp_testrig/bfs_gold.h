@@ -0,0 +1,88 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// ------------------------------------------------------------- 
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// ------------------------------------------------------------- 
+#include <stdlib.h>
+
+////////////////////////////////////////////////////////////////////////////////
+//! Compute reference breadth-first search distances with a serial queue
+//! Unreached vertices have distance -1.
+//! @param distances        distance of each vertex from source, preallocated
+//! @param rowIndices       offset of the first neighbor of each vertex
+//! @param indices          neighbors of all vertices
+//! @param numVertices      number of vertices
+//! @param source           the source vertex
+//! @return                 number of edges of the reached vertices
+////////////////////////////////////////////////////////////////////////////////
+inline size_t bfsGold(int *distances, const unsigned int *rowIndices,
+                      const unsigned int *indices, int numVertices, int source)
+{
+    int *queue = (int*) malloc(sizeof(int) * numVertices);
+    for (int v = 0; v < numVertices; v++)
+        distances[v] = -1;
+
+    size_t numEdges = 0;
+    int tail = 0;
+    distances[source] = 0;
+    queue[tail++] = source;
+    for (int head = 0; head < tail; head++)
+    {
+        int u = queue[head];
+        numEdges += rowIndices[u+1] - rowIndices[u];
+        for (unsigned int j = rowIndices[u]; j < rowIndices[u+1]; j++)
+        {
+            int w = indices[j];
+            if (distances[w] < 0)
+            {
+                distances[w] = distances[u] + 1;
+                queue[tail++] = w;
+            }
+        }
+    }
+
+    free(queue);
+    return numEdges;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Check a breadth-first search tree against reference distances
+//! The source must be its own parent, unreached vertices must have parent
+//! -1, and every other vertex must be a neighbor of its parent, one level
+//! further from the source.
+//! @param parents          parent of each vertex
+//! @param distances        reference distance of each vertex
+//! @param rowIndices       offset of the first neighbor of each vertex
+//! @param indices          neighbors of all vertices
+//! @param numVertices      number of vertices
+//! @param source           the source vertex
+//! @return                 whether the tree is valid
+////////////////////////////////////////////////////////////////////////////////
+inline bool bfsParentsValid(const int *parents, const int *distances,
+                            const unsigned int *rowIndices, const unsigned int *indices,
+                            int numVertices, int source)
+{
+    for (int v = 0; v < numVertices; v++)
+    {
+        int p = parents[v];
+        if (v == source || distances[v] < 0)
+        {
+            if (p != ((v == source) ? source : -1))
+                return false;
+            continue;
+        }
+        if (p < 0 || p >= numVertices || distances[p] != distances[v] - 1)
+            return false;
+
+        bool isEdge = false;
+        for (unsigned int j = rowIndices[p]; j < rowIndices[p+1] && !isEdge; j++)
+            isEdge = ((int)indices[j] == v);
+        if (!isEdge)
+            return false;
+    }
+    return true;
+}
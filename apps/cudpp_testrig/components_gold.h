@@ -0,0 +1,51 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// ------------------------------------------------------------- 
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// ------------------------------------------------------------- 
+#include <stdlib.h>
+
+////////////////////////////////////////////////////////////////////////////////
+//! Compute reference connected component labels with a serial union-find
+//! Components are numbered from 0 in the order of their smallest vertex.
+//! @param labels           component of each vertex, preallocated
+//! @param edgeU            first vertex of each edge
+//! @param edgeV            second vertex of each edge
+//! @param numEdges         number of edges
+//! @param numVertices      number of vertices
+//! @return                 number of components
+////////////////////////////////////////////////////////////////////////////////
+inline int connectedComponentsGold(int *labels, const int *edgeU, const int *edgeV,
+                                   int numEdges, int numVertices)
+{
+    int *parent = (int*) malloc(sizeof(int) * numVertices);
+    for (int v = 0; v < numVertices; v++)
+        parent[v] = v;
+
+    for (int e = 0; e < numEdges; e++)
+    {
+        int a = edgeU[e], b = edgeV[e];
+        while (parent[a] != a) a = parent[a] = parent[parent[a]];
+        while (parent[b] != b) b = parent[b] = parent[parent[b]];
+        if (a < b)
+            parent[b] = a;
+        else if (b < a)
+            parent[a] = b;
+    }
+
+    // every root is the smallest vertex of its component
+    int numComponents = 0;
+    for (int v = 0; v < numVertices; v++)
+    {
+        int r = v;
+        while (parent[r] != r) r = parent[r];
+        labels[v] = (r == v) ? numComponents++ : labels[r];
+    }
+
+    free(parent);
+    return numComponents;
+}
@@ -50,6 +50,14 @@ int testSparseMatrixVectorMultiply(int argc, const char ** argv);
 int testMergeSort(int argc, const char ** argv, const CUDPPConfiguration *config);
 int testStringSort(int argc, const char ** argv, const CUDPPConfiguration *config);
 int testRandMD5(int argc, const char ** argv);
+int testRandCounter(int argc, const char ** argv);
+int testRandDistributions(int argc, const char ** argv);
+int testShuffle(int argc, const char ** argv);
+int testTree(int argc, const char ** argv);
+int testConnectedComponents(int argc, const char ** argv);
+int testBFS(int argc, const char ** argv);
+int testReduceByKey(int argc, const char ** argv);
+int testUnique(int argc, const char ** argv);
 int testTridiagonal(int argc, const char** argv, const CUDPPConfiguration *config);
 int testMtf(int argc, const char** argv, const CUDPPConfiguration *config);
 int testBwt(int argc, const char** argv, const CUDPPConfiguration *config);
@@ -305,6 +313,7 @@ int main(int argc, const char** argv)
         printf("compact: Run compact test(s)\n\n");
         printf("reduce: Run reduce test(s)\n\n");
         printf("rand: Run random number generator test(s)\n\n");
+        printf("shuffle: Run shuffle and sampling test(s)\n\n");
         printf("tridiagonal: Run tridiagonal solver test(s)\n\n");
         printf("mtf: Run move-to-front transform test(s) "
                "(compute 2.0+ only)\n\n"); 
@@ -312,6 +321,11 @@ int main(int argc, const char** argv)
                "(compute 2.0+ only)\n\n");
         printf("compress: Run compression test(s) (compute 2.0+ only)\n\n");
         printf("listrank: Run list ranking test(s)\n\n");
+        printf("tree: Run Euler tour tree test(s)\n\n");
+        printf("components: Run connected components test(s)\n\n");
+        printf("bfs: Run breadth-first search test(s)\n\n");
+        printf("reducebykey: Run reduce-by-key and run-length encoding test(s)\n\n");
+        printf("unique: Run unique test(s) on sorted and unsorted keys\n\n");
         printf("--- Global Options ---\n");
         printf("iterations=<N>: Number of times to run each test\n");
         printf("n=<N>: Number of values to use in a single test\n");
@@ -335,6 +349,7 @@ int main(int argc, const char** argv)
         printf("backward: Run backward sorts (DOES NOT WORK YET)\n");
         printf("--- Sparse Matrix-Vector Multiply Options ---\n");
         printf("mat=<File Name>: File containing sparse matrix in Matrix Market format\n");
+        printf("csrcache=<directory>: Directory for binary copies of the matrices\n");
         printf("--- Rand Options ---\n");
         printf("dir=<directory>: Directory containing all the random number regression tests\n");
     }
@@ -349,10 +364,16 @@ int main(int argc, const char** argv)
     bool runMergeSort = runAll || checkCommandLineFlag(argc, argv, "mergesort");
     bool runStringSort = runAll || checkCommandLineFlag(argc, argv, "stringsort");
     bool runRand = runAll || checkCommandLineFlag(argc, argv, "rand");
+    bool runShuffle = runAll || checkCommandLineFlag(argc, argv, "shuffle");
     bool runSpmv = checkCommandLineFlag(argc, argv, "spmv");
     bool runTridiagonal = runAll ||  checkCommandLineFlag(argc, argv, "tridiagonal");
     bool runMtf = runAll || checkCommandLineFlag(argc, argv, "mtf");
     bool runListRank = runAll || checkCommandLineFlag(argc, argv, "listrank");
+    bool runTree = runAll || checkCommandLineFlag(argc, argv, "tree");
+    bool runComponents = runAll || checkCommandLineFlag(argc, argv, "components");
+    bool runBFS = runAll || checkCommandLineFlag(argc, argv, "bfs");
+    bool runReduceByKey = runAll || checkCommandLineFlag(argc, argv, "reducebykey");
+    bool runUnique = runAll || checkCommandLineFlag(argc, argv, "unique");
     if (!supports48KBInShared && runMtf)
     {
         fprintf(stderr, "MTF is only supported on devices with "
@@ -475,8 +496,39 @@ int main(int argc, const char** argv)
 
     if (runRand)
     {
-        //in the future we need to add so that it tests other random numbers as well
         retval += testRandMD5(argc, argv);
+        retval += testRandCounter(argc, argv);
+        retval += testRandDistributions(argc, argv);
+    }
+
+    if (runShuffle)
+    {
+        retval += testShuffle(argc, argv);
+    }
+
+    if (runTree)
+    {
+        retval += testTree(argc, argv);
+    }
+
+    if (runComponents)
+    {
+        retval += testConnectedComponents(argc, argv);
+    }
+
+    if (runBFS)
+    {
+        retval += testBFS(argc, argv);
+    }
+
+    if (runReduceByKey)
+    {
+        retval += testReduceByKey(argc, argv);
+    }
+
+    if (runUnique)
+    {
+        retval += testUnique(argc, argv);
     }
 
     if (retval)
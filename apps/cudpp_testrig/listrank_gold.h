@@ -9,6 +9,7 @@
 // ------------------------------------------------------------- 
 #include <cudpp.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <limits.h>
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -32,6 +33,44 @@ void listRankGold( T* reference, const T* ivalues,
     }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+//! Compute reference data set for list scans
+//! Each list of the forest starts at a head, a node that is no node's
+//! successor, and each node gets the prefix of the values along its list.
+//! @param reference        reference data, computed but preallocated
+//! @param ivalues          const input values as provided to device
+//! @param inextindices     const input next indices as provided to device
+//! @param count            number of elements in reference / forest
+//! @param op               CUDPP_ADD, CUDPP_MAX or CUDPP_MIN
+//! @param identity         identity of \a op
+//! @param exclusive        whether a node's prefix excludes its own value
+////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+void listScanGold( T* reference, const T* ivalues,
+                   const int* inextindices, const unsigned int count,
+                   CUDPPOperator op, T identity, bool exclusive)
+{
+    char *isSuccessor = (char*) calloc(count, sizeof(char));
+    for(unsigned int i=0; i<count; i++){
+        if (inextindices[i] >= 0)
+            isSuccessor[inextindices[i]] = 1;
+    }
+    for(unsigned int h=0; h<count; h++){
+        if (isSuccessor[h])
+            continue;
+        T sum = identity;
+        for(int cur_id = h; cur_id >= 0; cur_id = inextindices[cur_id]){
+            T value = ivalues[cur_id];
+            T next_sum = (op == CUDPP_ADD) ? sum + value :
+                         (op == CUDPP_MAX) ? (sum > value ? sum : value) :
+                                             (sum < value ? sum : value);
+            reference[cur_id] = exclusive ? sum : next_sum;
+            sum = next_sum;
+        }
+    }
+    free(isSuccessor);
+}
+
 // Leave this at the end of the file
 // Local Variables:
 // mode:c++
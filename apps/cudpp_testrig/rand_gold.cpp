@@ -19,6 +19,8 @@
 #include <stdlib.h>
 #include <stdio.h>
 
+#include "cudpp.h"
+
 namespace testrig {
 
     struct uint4
@@ -147,7 +149,7 @@ namespace testrig {
         input[15] = 128 ^ seed;
     }
 
-    void gen_randMD5CPU(uint4 *d_out, size_t numElements, unsigned int seed,dim3 threadIdx, dim3 blockIdx, dim3 blockDim)
+    void gen_randMD5CPU(unsigned int *d_out, size_t numElements, unsigned int seed,dim3 threadIdx, dim3 blockIdx, dim3 blockDim)
     {
         unsigned int idx = blockIdx.x*blockDim.x + threadIdx.x;
         unsigned int data[16];
@@ -242,22 +244,21 @@ namespace testrig {
         result.z = result.z + td.z;
         result.w = result.w + td.w;
     
-        //printf("computed result: %u %u %u %u\n", result.x, result.y, result.z, result.w);
-        //printf("idx is: %d and numElements: %d\n", idx, numElements);
-        if (idx < numElements)
-            d_out[idx] = result;
+        //write the 128 bits straight into the output, clipping the last group
+        size_t outIdx = (size_t)idx * 4;
+        if (outIdx < numElements)     d_out[outIdx]     = result.x;
+        if (outIdx + 1 < numElements) d_out[outIdx + 1] = result.y;
+        if (outIdx + 2 < numElements) d_out[outIdx + 2] = result.z;
+        if (outIdx + 3 < numElements) d_out[outIdx + 3] = result.w;
     }
 
     void randMD5CPUDispatch(unsigned int * data, size_t numElements, unsigned int seed)
     {
-        //compute the new element size for the uint4 array
-
+        //each generated digest fills four elements of data
         unsigned int newSize = (unsigned int)numElements / 4;
 
         newSize += (numElements %4 == 0) ? 0:1;
 
-        uint4 * h_out = (uint4 *) malloc(sizeof(uint4) * newSize);
-
         //now we need to manually calculate the block size and such
         dim3 blockSize, blockID, threadID;
     
@@ -274,32 +275,310 @@ namespace testrig {
             for(unsigned int j = 0; j < blockSize.x; j++)
             {
                 threadID.x = i + j;
-                gen_randMD5CPU(h_out, newSize, seed, threadID, blockID, blockSize);
+                gen_randMD5CPU(data, numElements, seed, threadID, blockID, blockSize);
             }//end for j
 
             blockID.x++;
         }//end for i
+    }//end randMD5CPUDispatch
+}
 
-        //now copy all the generated elements back into data
-        unsigned int j = 0;
-        for(unsigned int i = 0; i < newSize; i++)
+namespace testrig {
+
+    //------------COUNTER-BASED (PHILOX / THREEFRY) GENERATORS-------------
+
+    const int PHILOX_ROUNDS = 10;
+    const unsigned int PHILOX_M0 = 0xD2511F53;
+    const unsigned int PHILOX_M1 = 0xCD9E8D57;
+    const unsigned int PHILOX_W0 = 0x9E3779B9;
+    const unsigned int PHILOX_W1 = 0xBB67AE85;
+    const int THREEFRY_ROUNDS = 20;
+    const unsigned int THREEFRY_PARITY = 0x1BD11BDA;
+
+    void philox4x32(unsigned int ctr[4], unsigned int k0, unsigned int k1)
+    {
+        for (int r = 0; r < PHILOX_ROUNDS; r++)
         {
-            //this is bad code, but I will fix later!
-            if (j >=numElements) break;
-            data[j++] = h_out[i].x;
-            if (j >=numElements) break;
-            data[j++] = h_out[i].y;
-            if (j >=numElements) break;
-            data[j++] = h_out[i].z;
-            if (j >=numElements) break;
-            data[j++] = h_out[i].w;
+            if (r > 0)
+            {
+                k0 += PHILOX_W0;
+                k1 += PHILOX_W1;
+            }
+            unsigned long long p0 = (unsigned long long)PHILOX_M0 * ctr[0];
+            unsigned long long p1 = (unsigned long long)PHILOX_M1 * ctr[2];
+            unsigned int hi0 = (unsigned int)(p0 >> 32), lo0 = (unsigned int)p0;
+            unsigned int hi1 = (unsigned int)(p1 >> 32), lo1 = (unsigned int)p1;
+            unsigned int x0 = hi1 ^ ctr[1] ^ k0;
+            unsigned int x2 = hi0 ^ ctr[3] ^ k1;
+            ctr[0] = x0;
+            ctr[1] = lo1;
+            ctr[2] = x2;
+            ctr[3] = lo0;
         }
-        //debug use only: print out the rands:
+    }
 
-        for(unsigned int i = 0; i < newSize; i++)
-            printf("%u %u %u %u\n", h_out[i].x,h_out[i].y,h_out[i].z,h_out[i].w);
+    unsigned int rotl32(unsigned int x, unsigned int n)
+    {
+        return (x << n) | (x >> (32 - n));
+    }
 
-        printf("\n\n");
-    }//end randMD5CPUDispatch
+    void threefry4x32(unsigned int x[4], unsigned int k0, unsigned int k1)
+    {
+        static const unsigned int rot[8][2] = { {10, 26}, {11, 21}, {13, 27}, {23,  5},
+                                                { 6, 20}, {17, 11}, {25, 10}, {18, 20} };
+        unsigned int ks[5] = { k0, k1, 0, 0, THREEFRY_PARITY ^ k0 ^ k1 };
+
+        for (int i = 0; i < 4; i++)
+            x[i] += ks[i];
+
+        for (int r = 0; r < THREEFRY_ROUNDS; r++)
+        {
+            int a = (r % 2 == 0) ? 1 : 3;   // word mixed into x[0]
+            int b = (r % 2 == 0) ? 3 : 1;   // word mixed into x[2]
+            x[0] += x[a]; x[a] = rotl32(x[a], rot[r % 8][0]); x[a] ^= x[0];
+            x[2] += x[b]; x[b] = rotl32(x[b], rot[r % 8][1]); x[b] ^= x[2];
+
+            if (r % 4 == 3)
+            {
+                unsigned int s = (r + 1) / 4;
+                for (int i = 0; i < 4; i++)
+                    x[i] += ks[(s + i) % 5];
+                x[3] += s;
+            }
+        }
+    }
+
+    void counterBlock(unsigned int x[4], CUDPPAlgorithm algorithm, 
+                      unsigned long long block, unsigned int hi0, 
+                      unsigned int hi1, unsigned int seed, unsigned int stream)
+    {
+        x[0] = (unsigned int)block;
+        x[1] = (unsigned int)(block >> 32);
+        x[2] = hi0;
+        x[3] = hi1;
+        if (algorithm == CUDPP_RAND_PHILOX)
+            philox4x32(x, seed, stream);
+        else
+            threefry4x32(x, seed, stream);
+    }
+
+    double uniformDouble(unsigned int a, unsigned int b, bool open)
+    {
+        return ((a >> 5) * 67108864.0 + (b >> 6) + (open ? 1.0 : 0.0)) 
+               * (1.0 / 9007199254740992.0);
+    }
+
+    float uniformFloat(unsigned int x, bool open)
+    {
+        return ((x >> 8) + (open ? 1 : 0)) * (1.0f / 16777216.0f);
+    }
+}
+
+/**
+ * @brief Computes elements [offset, offset + numElements) of the random 
+ * sequence of a counter-based generator on the CPU.
+ *
+ * Element p of the sequence is word p % 4 of the generator output for 
+ * counter (p / 4, 0), under the key (seed, stream).
+ *
+ * @param[out] data the output array
+ * @param[in] numElements the number of elements to generate
+ * @param[in] algorithm CUDPP_RAND_PHILOX or CUDPP_RAND_THREEFRY
+ * @param[in] seed first key word
+ * @param[in] stream second key word
+ * @param[in] offset position of data[0] in the sequence
+ */
+extern "C"
+void randCounterGold(unsigned int * data, size_t numElements, 
+                     CUDPPAlgorithm algorithm, unsigned int seed, 
+                     unsigned int stream, unsigned long long offset)
+{
+    for (size_t i = 0; i < numElements; i++)
+    {
+        unsigned long long p = offset + i;
+        unsigned int x[4];
+        testrig::counterBlock(x, algorithm, p / 4, 0, 0, seed, stream);
+        data[i] = x[p % 4];
+    }
+}
+
+/**
+ * @brief Computes elements [offset, offset + numElements) of a random 
+ * distribution generated by a counter-based generator on the CPU.
+ *
+ * Each counter block yields four values (two for CUDPP_DOUBLE); see 
+ * cudppRandDistribution() for the distributions and their parameters.
+ *
+ * @param[out] data the output array, of type \a datatype
+ * @param[in] numElements the number of elements to generate
+ * @param[in] algorithm CUDPP_RAND_PHILOX or CUDPP_RAND_THREEFRY
+ * @param[in] seed first key word
+ * @param[in] stream second key word
+ * @param[in] offset position of data[0] in the sequence
+ * @param[in] distribution the output distribution
+ * @param[in] datatype CUDPP_UINT, CUDPP_FLOAT or CUDPP_DOUBLE
+ * @param[in] param0 first distribution parameter
+ * @param[in] param1 second distribution parameter
+ */
+extern "C"
+void randDistributionGold(void * data, size_t numElements, 
+                          CUDPPAlgorithm algorithm, unsigned int seed, 
+                          unsigned int stream, unsigned long long offset,
+                          CUDPPRandDistribution distribution, 
+                          CUDPPDatatype datatype, double param0, double param1)
+{
+    const double twoPi = 6.283185307179586;
+    bool isDouble = (datatype == CUDPP_DOUBLE);
+    unsigned int valuesPerBlock = isDouble ? 2 : 4;
+
+    for (size_t i = 0; i < numElements; i++)
+    {
+        unsigned long long p = offset + i;
+        unsigned long long block = p / valuesPerBlock;
+        unsigned int lane = (unsigned int)(p % valuesPerBlock);
+        unsigned int x[4];
+        testrig::counterBlock(x, algorithm, block, 0, 0, seed, stream);
+
+        switch (distribution)
+        {
+        case CUDPP_RAND_BITS:
+            ((unsigned int*)data)[i] = x[lane];
+            break;
+        case CUDPP_RAND_UNIFORM_INT:
+            {
+                unsigned int low = (unsigned int)param0;
+                unsigned int range = (unsigned int)(param1 - param0);
+                unsigned int threshold = (0u - range) % range;
+                unsigned long long m = (unsigned long long)x[lane] * range;
+                unsigned int attempt = 0;
+                while ((unsigned int)m < threshold)
+                {
+                    unsigned int y[4];
+                    testrig::counterBlock(y, algorithm, block, lane + 1, 
+                                          attempt++, seed, stream);
+                    m = (unsigned long long)y[0] * range;
+                }
+                ((unsigned int*)data)[i] = low + (unsigned int)(m >> 32);
+            }
+            break;
+        case CUDPP_RAND_UNIFORM:
+            if (isDouble)
+                ((double*)data)[i] = testrig::uniformDouble(x[2*lane], x[2*lane+1], false);
+            else
+                ((float*)data)[i] = testrig::uniformFloat(x[lane], false);
+            break;
+        case CUDPP_RAND_NORMAL:
+            if (isDouble)
+            {
+                double r = sqrt(-2.0 * log(testrig::uniformDouble(x[0], x[1], true)));
+                double t = twoPi * testrig::uniformDouble(x[2], x[3], false);
+                ((double*)data)[i] = param0 + param1 * r * (lane == 0 ? cos(t) : sin(t));
+            }
+            else
+            {
+                unsigned int pair = lane & ~1u;
+                float r = sqrtf(-2.0f * logf(testrig::uniformFloat(x[pair], true)));
+                float t = 6.2831853f * testrig::uniformFloat(x[pair + 1], false);
+                ((float*)data)[i] = (float)param0 + (float)param1 * r * 
+                                    ((lane & 1) ? sinf(t) : cosf(t));
+            }
+            break;
+        case CUDPP_RAND_EXPONENTIAL:
+            if (isDouble)
+                ((double*)data)[i] = -log(testrig::uniformDouble(x[2*lane], x[2*lane+1], true)) / param0;
+            else
+                ((float*)data)[i] = -logf(testrig::uniformFloat(x[lane], true)) / (float)param0;
+            break;
+        default:
+            break;
+        }
+    }
 }
 
+namespace testrig {
+
+    //------------SHUFFLE AND SAMPLING-------------
+
+    const int SHUFFLE_FEISTEL_ROUNDS = 8;
+
+    unsigned int feistelRound(unsigned int x, unsigned int roundKey)
+    {
+        x = (x ^ roundKey) * 0x9E3779B1;
+        x ^= x >> 16;
+        x *= 0x85EBCA6B;
+        x ^= x >> 13;
+        x *= 0xC2B2AE35;
+        x ^= x >> 16;
+        return x;
+    }
+
+    unsigned int feistelPermute(unsigned int i, unsigned int n, 
+                                unsigned int halfBits, 
+                                const unsigned int roundKeys[])
+    {
+        unsigned int mask = (1u << halfBits) - 1;
+        unsigned int x = i;
+        do
+        {
+            unsigned int left = x >> halfBits;
+            unsigned int right = x & mask;
+            for (int r = 0; r < SHUFFLE_FEISTEL_ROUNDS; r++)
+            {
+                unsigned int t = right;
+                right = left ^ (feistelRound(right, roundKeys[r]) & mask);
+                left = t;
+            }
+            x = (left << halfBits) | right;
+        } while (x >= n);
+        return x;
+    }
+}
+
+/**
+ * @brief Computes on the CPU the source indices gathered by one call to 
+ * cudppShuffle() or cudppSample().
+ *
+ * Output i of the call is input \a indices[i].
+ *
+ * @param[out] indices the source index of each output
+ * @param[in] numOutputs the number of outputs
+ * @param[in] numElements the number of inputs
+ * @param[in] withReplacement true for sampling with replacement
+ * @param[in] seed first key word
+ * @param[in] stream second key word
+ * @param[in] call number of shuffle and sample calls since the seed was set
+ */
+extern "C"
+void shuffleIndicesGold(unsigned int * indices, size_t numOutputs, 
+                        size_t numElements, bool withReplacement,
+                        unsigned int seed, unsigned int stream, 
+                        unsigned long long call)
+{
+    if (withReplacement)
+    {
+        unsigned int k[4];
+        testrig::counterBlock(k, CUDPP_RAND_PHILOX, call, 0xFFFFFFFF, 2, 
+                              seed, stream);
+        randDistributionGold(indices, numOutputs, CUDPP_RAND_PHILOX, 
+                             k[0], k[1], 0, CUDPP_RAND_UNIFORM_INT, 
+                             CUDPP_UINT, 0, (double)numElements);
+        return;
+    }
+
+    unsigned int roundKeys[testrig::SHUFFLE_FEISTEL_ROUNDS];
+    testrig::counterBlock(roundKeys, CUDPP_RAND_PHILOX, call, 0xFFFFFFFF, 0,
+                          seed, stream);
+    testrig::counterBlock(roundKeys + 4, CUDPP_RAND_PHILOX, call, 0xFFFFFFFF,
+                          1, seed, stream);
+
+    unsigned int bits = 0;
+    for (size_t m = numElements - 1; m > 0; m >>= 1)
+        bits++;
+    unsigned int halfBits = (bits + 1) / 2;
+    if (halfBits < 1) halfBits = 1;
+
+    for (size_t i = 0; i < numOutputs; i++)
+        indices[i] = testrig::feistelPermute((unsigned int)i, 
+                                             (unsigned int)numElements,
+                                             halfBits, roundKeys);
+}
@@ -0,0 +1,71 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// ------------------------------------------------------------- 
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// ------------------------------------------------------------- 
+#include <stdlib.h>
+
+////////////////////////////////////////////////////////////////////////////////
+//! Compute a reference reduction of every run of equal consecutive keys
+//! @param keysOut          key of each run, preallocated
+//! @param valuesOut        reduction of each run, preallocated
+//! @param keys             keys
+//! @param values           values
+//! @param numElements      number of elements
+//! @param op               the operator (CUDPP_ADD, CUDPP_MULTIPLY, CUDPP_MIN or CUDPP_MAX)
+//! @return                 number of runs
+////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+size_t reduceByKeyGold(unsigned int *keysOut, T *valuesOut, const unsigned int *keys,
+                       const T *values, size_t numElements, CUDPPOperator op)
+{
+    size_t numSegments = 0;
+    for (size_t i = 0; i < numElements; i++)
+    {
+        if (i == 0 || keys[i] != keys[i-1])
+        {
+            keysOut[numSegments] = keys[i];
+            valuesOut[numSegments++] = values[i];
+            continue;
+        }
+        T &acc = valuesOut[numSegments-1];
+        switch (op)
+        {
+        case CUDPP_ADD:      acc = acc + values[i]; break;
+        case CUDPP_MULTIPLY: acc = acc * values[i]; break;
+        case CUDPP_MIN:      acc = (values[i] < acc) ? values[i] : acc; break;
+        case CUDPP_MAX:      acc = (values[i] > acc) ? values[i] : acc; break;
+        default: break;
+        }
+    }
+    return numSegments;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Compute a reference run-length encoding
+//! @param runValues        element of each run, preallocated
+//! @param runLengths       length of each run, preallocated
+//! @param in               input elements
+//! @param numElements      number of elements
+//! @return                 number of runs
+////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+size_t runLengthEncodeGold(T *runValues, unsigned int *runLengths, const T *in,
+                           size_t numElements)
+{
+    size_t numRuns = 0;
+    for (size_t i = 0; i < numElements; i++)
+    {
+        if (i == 0 || in[i] != in[i-1])
+        {
+            runValues[numRuns] = in[i];
+            runLengths[numRuns++] = 0;
+        }
+        runLengths[numRuns-1]++;
+    }
+    return numRuns;
+}
@@ -8,44 +8,26 @@
 // in the root directory of this source distribution.
 // ------------------------------------------------------------- 
 #include <iostream>
-#include <fstream>
 #include <string>
 #include "sparse.h"
 
+#define CUDPP_APP_COMMON_IMPL
+#include "sparsematrix.h"
+
 extern "C"
-void readMatrixMarket(MMMatrix * m, const char * filename);
+void readMatrixMarket(MMMatrix * m, const char * filename, const char * cacheDir);
 
 extern "C"
 void sparseMatrixVectorMultiplyGold(const MMMatrix * m, const float * x, float * y);
 
 using namespace std;
 
-istream & operator>>(istream & is, MMEntry & mme)
-{
-    unsigned int row;
-    unsigned int col;
-    float entry;
-    is >> row >> col >> entry;
-    mme = MMEntry(row-1, col-1, entry); // convert to 0-based
-    return is;
-}
-
 ostream & operator<<(ostream & os, const MMEntry & mme)
 {
     os << mme.getRow() << " " << mme.getCol() << " " << mme.getEntry() << endl;
     return os;
 }
 
-istream & operator>>(istream & is, MMMatrix & m)
-{
-    unsigned int rows;
-    unsigned int cols;
-    unsigned int count;
-    is >> rows >> cols >> count;
-    m = MMMatrix(rows, cols, count);
-    return is;
-}
-
 ostream & operator<<(ostream & os, const MMMatrix & m)
 {
     os << m.getRows() << " " << m.getCols() << " " << m.getNumEntries() << endl;
@@ -62,83 +44,36 @@ ostream & operator<<(ostream & os, const MMMatrix & m)
     return os;
 }
 
-int mmecmp(const void * aa, const void * bb) {
-    MMEntry * a = (MMEntry *) aa;
-    MMEntry * b = (MMEntry *) bb;
-    if (a->getRow() < b->getRow())
-    {
-        return -1;
-    }
-    if (a->getRow() > b->getRow())
-    {
-        return 1;
-    }
-    if (a->getCol() < b->getCol())
-    {
-        return -1;
-    }
-    if (a->getCol() > b->getCol())
-    {
-        return 1;
-    }
-    return 0;
-}
-
-
-void readMatrixMarket(MMMatrix * m, const char * filename)
+/**
+ * Reads a Matrix Market file into \a m in row-major order, using the
+ * parallel loader from the common app utilities; a .csr file is read 
+ * directly.  If \a cacheDir is not NULL, the binary cache of the file is
+ * kept there.
+ */
+void readMatrixMarket(MMMatrix * m, const char * filename, const char * cacheDir)
 {
-    ifstream f(filename);
-    if (!f)
+    cudpp_app::SparseMatrixCSR<float> csr;
+    if (!cudpp_app::loadSparseMatrix(csr, filename, cacheDir))
     {
-        cerr << "Cannot open file " << filename << endl;
+        cerr << "Cannot read matrix file " << filename << endl;
         exit(1);
     }
 
-    string s;
-    char c = 0;
-    while ((c = f.get()) && (c != EOF))
-    {
-        f.putback(c);
-        if (c != '%') 
-        {
-            break;
-        }
-        getline(f, s);
-    }
+    const unsigned int * rowPtrs = csr.getRowPtrs();
+    const unsigned int * colIndices = csr.getColIndices();
+    const float * values = csr.getValues();
 
-    // now we've cleared all comments away
-    f >> *m;
-    
-    MMEntry e;
-    unsigned int i;
-    for (i = 0 ; i < m->getNumEntries() ; i++)
-    {
-        f >> e;
-        m->setEntry(i, e);
-    }
-    
-    // sort into row-major order
-    qsort(m->getEntriesForSorting(), m->getNumEntries(), 
-          sizeof(MMEntry), mmecmp);
-    
-    // set index of first elt in each row
-    // relies on at least one item in each row
-    unsigned int row;
-    for (i = 0 ; i < m->getNumEntries() ; i++)
+    *m = MMMatrix(csr.getRows(), csr.getCols(), csr.getNumEntries());
+    for (unsigned int row = 0; row < csr.getRows(); row++)
     {
-        row = (*m)[i].getRow();
-        if (m->getRowPtr(row) > i)
+        for (unsigned int i = rowPtrs[row]; i < rowPtrs[row+1]; i++)
         {
-            m->setRowPtr(row, i);
+            m->setEntry(i, MMEntry(row, colIndices[i], values[i]));
         }
+        // index of the first and last elt in each row
+        m->setRowPtr(row, rowPtrs[row]);
+        m->setRowFPtr(row, rowPtrs[row+1] - 1);
     }
-    
-    // now set rowFPtr
-    for (row = 0 ; row < m->getRows() - 1 ; row++)
-    {
-        m->setRowFPtr(row, m->getRowPtr(row+1) - 1);
-    }
-    m->setRowFPtr(m->getRows() - 1, m->getNumEntries() - 1);
 }
 
 void sparseMatrixVectorMultiplyGold(const MMMatrix * m, const float * x, float * y)
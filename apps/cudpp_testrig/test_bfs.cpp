@@ -0,0 +1,274 @@
+// -------------------------------------------------------------
+// CUDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision: $
+// $Date: $
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt in
+// the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+ * @file
+ * test_bfs.cpp
+ *
+ * @brief Host testrig routines to exercise cudpp's breadth-first search
+ * functionality.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cuda_runtime_api.h>
+
+#include "cudpp.h"
+
+#include "cudpp_testrig_options.h"
+#include "cudpp_testrig_utils.h"
+#include "cuda_util.h"
+#include "stopwatch.h"
+#include "comparearrays.h"
+#include "backendarrays.h"
+#include "commandline.h"
+#include "bfs_gold.h"
+
+using namespace cudpp_app;
+
+/**
+ * bfsTest exercises breadth-first search on one backend.
+ *
+ * For each size the test builds a random undirected graph of average
+ * degree 16 in symmetric CSR form, which a search crosses in a few
+ * levels and which makes it switch to pulling, or (on alternate sizes)
+ * a shuffled path, which needs a level per vertex, up to 65536 vertices
+ * and a sparse random graph of many small components beyond.  It
+ * searches from a random vertex and checks the distances against the
+ * CPU reference and that the parents form a breadth-first tree.  The
+ * rate is reported in traversed edges per second: the undirected edges
+ * of the reached vertices over the search time.
+ *
+ * Possible command line arguments:
+ * - --n=#: number of vertices
+ * @param argc Number of arguments on the command line, passed
+ * directly from main
+ * @param argv Array of arguments on the command line, passed directly
+ * from main
+ * @param config Plan configuration, with or without CUDPP_OPTION_HOST
+ * @param testOptions Global test options
+ * @return Number of tests that failed regression (0 for all pass)
+ * @see cudppBFS
+ */
+int bfsTest(int argc, const char **argv, const CUDPPConfiguration &config,
+            const testrigOptions &testOptions)
+{
+    int retval = 0;
+
+    cudpp_app::StopWatch timer;
+
+    bool host = (config.options & CUDPP_OPTION_HOST) != 0;
+
+    bool quiet = checkCommandLineFlag(argc, (const char**)argv, "quiet");   
+
+    unsigned int test[] = {1, 2, 39, 1000, 1025, 65536, 500001, 1048576};
+    int numTests = sizeof(test) / sizeof(test[0]);
+    int numVertices = test[numTests-1]; // maximum test size
+
+    bool oneTest = false;
+    if (commandLineArg(numVertices, argc, (const char**) argv, "n"))
+    {
+        oneTest = true;
+        numTests = 1;
+        test[0] = numVertices;
+    }
+
+    CUDPPResult result = CUDPP_SUCCESS;
+    CUDPPHandle theCudpp;
+    result = cudppCreate(&theCudpp);
+    if (result != CUDPP_SUCCESS)
+    {
+        if (!quiet)
+            fprintf(stderr, "Error initializing CUDPP Library.\n");
+        retval = (oneTest) ? 1 : numTests;
+        return retval;
+    }
+
+    CUDPPHandle plan;
+    result = cudppPlan(theCudpp, &plan, config, numVertices, 1, 0);
+
+    if (result != CUDPP_SUCCESS)
+    {
+        if (!quiet)
+            fprintf(stderr, "Error creating plan for BFS\n");
+        retval = (oneTest) ? 1 : numTests;
+        return retval;
+    }
+
+    int maxEdges = 8 * numVertices;
+
+    int *h_order          = (int*) malloc(sizeof(int) * numVertices);
+    int *h_edgeU          = (int*) malloc(sizeof(int) * maxEdges);
+    int *h_edgeV          = (int*) malloc(sizeof(int) * maxEdges);
+    unsigned int *h_rows  = (unsigned int*) malloc(sizeof(unsigned int) * (numVertices + 1));
+    unsigned int *h_cols  = (unsigned int*) malloc(sizeof(unsigned int) * 2 * maxEdges);
+    unsigned int *h_fill  = (unsigned int*) malloc(sizeof(unsigned int) * numVertices);
+    int *reference        = (int*) malloc(sizeof(int) * numVertices);
+    int *o_distances      = (int*) malloc(sizeof(int) * numVertices);
+    int *o_parents        = (int*) malloc(sizeof(int) * numVertices);
+
+    unsigned int *d_rows  = backendAlloc<unsigned int>(host, numVertices + 1);
+    unsigned int *d_cols  = backendAlloc<unsigned int>(host, 2 * maxEdges);
+    int *d_distances      = backendAlloc<int>(host, numVertices);
+    int *d_parents        = backendAlloc<int>(host, numVertices);
+
+    for (int k = 0; k < numTests; ++k)
+    {
+        int n = test[k];
+        bool path = (k % 2) == 1 && n <= 65536;
+        bool sparse = (k % 2) == 1 && !path;
+        int numEdges = path ? n - 1 : (sparse ? n / 2 : 8 * n);
+
+        if (!quiet)
+        {
+            printf("Running %sBFS of %d vertices and %d %s edges\n",
+                host ? "host " : "", n, numEdges, 
+                path ? "path" : (sparse ? "sparse random" : "random"));
+            fflush(stdout);
+        }
+
+        for (int i = 0; i < n; i++)
+            h_order[i] = i;
+        for (int i = 0; i < n; i++)
+        {
+            int other = i + (rand() % (n - i));
+            int tmp = h_order[i];
+            h_order[i] = h_order[other];
+            h_order[other] = tmp;
+        }
+        for (int e = 0; e < numEdges; e++)
+        {
+            h_edgeU[e] = path ? h_order[e] : rand() % n;
+            h_edgeV[e] = path ? h_order[e + 1] : rand() % n;
+        }
+
+        // the symmetric CSR form lists every edge at both vertices
+        memset(h_rows, 0, sizeof(unsigned int) * (n + 1));
+        for (int e = 0; e < numEdges; e++)
+        {
+            h_rows[h_edgeU[e] + 1]++;
+            h_rows[h_edgeV[e] + 1]++;
+        }
+        for (int v = 0; v < n; v++)
+        {
+            h_rows[v + 1] += h_rows[v];
+            h_fill[v] = h_rows[v];
+        }
+        for (int e = 0; e < numEdges; e++)
+        {
+            h_cols[h_fill[h_edgeU[e]]++] = h_edgeV[e];
+            h_cols[h_fill[h_edgeV[e]]++] = h_edgeU[e];
+        }
+
+        int source = rand() % n;
+        size_t reachedEdges = bfsGold(reference, h_rows, h_cols, n, source) / 2;
+
+        backendCopy(host, d_rows, h_rows, n + 1, true);
+        backendCopy(host, d_cols, h_cols, h_rows[n], true);
+
+        // run once to avoid timing startup overhead.
+        result = cudppBFS(plan, d_distances, d_parents, d_rows, d_cols, n, source);
+
+        timer.reset();
+        timer.start();
+        for (int i = 0; i < testOptions.numIterations; i++)
+        {
+            cudppBFS(plan, d_distances, d_parents, d_rows, d_cols, n, source);
+        }
+        cudaThreadSynchronize();
+        timer.stop();
+
+        bool passed = (result == CUDPP_SUCCESS);
+        backendCopy(host, o_distances, d_distances, n, false);
+        backendCopy(host, o_parents, d_parents, n, false);
+        passed = compareArrays<int>(reference, o_distances, n) && passed;
+        passed = bfsParentsValid(o_parents, reference, h_rows, h_cols, n, source) && passed;
+
+        // distances only
+        result = cudppBFS(plan, d_distances, NULL, d_rows, d_cols, n, source);
+        passed = passed && (result == CUDPP_SUCCESS);
+        backendCopy(host, o_distances, d_distances, n, false);
+        passed = compareArrays<int>(reference, o_distances, n) && passed;
+
+        retval += passed ? 0 : 1;
+        float time = timer.getTime() / testOptions.numIterations;
+        if (!quiet)
+        {
+            if (!passed)
+                printf("Invalid BFS tree\n");
+            printf("test %s\n", passed ? "PASSED" : "FAILED");
+            printf("Average execution time: %f ms (%.3f GTEPS)\n", time,
+                   (time > 0) ? reachedEdges / (time * 1e6) : 0.0);
+        }
+        else
+            printf("\t%10d\t%0.4f\n", n, time);
+    }
+
+    result = cudppDestroyPlan(plan);
+    if (result != CUDPP_SUCCESS)
+    {
+        if (!quiet)
+            printf("Error destroying CUDPPPlan for BFS\n");
+    }
+
+    result = cudppDestroy(theCudpp);
+    if (result != CUDPP_SUCCESS)
+    {
+        if (!quiet)
+            printf("Error shutting down CUDPP Library.\n");
+    }
+
+    free(h_order);
+    free(h_edgeU);
+    free(h_edgeV);
+    free(h_rows);
+    free(h_cols);
+    free(h_fill);
+    free(reference);
+    free(o_distances);
+    free(o_parents);
+
+    backendFree(host, d_rows);
+    backendFree(host, d_cols);
+    backendFree(host, d_distances);
+    backendFree(host, d_parents);
+
+    return retval;
+}
+
+/**
+ * testBFS runs the breadth-first search tests on the GPU and on the host
+ * backend.
+ * @param argc Number of arguments on the command line, passed
+ * directly from main
+ * @param argv Array of arguments on the command line, passed directly
+ * from main
+ * @return Number of tests that failed regression (0 for all pass)
+ * @see bfsTest
+ */
+int testBFS(int argc, const char **argv)
+{
+    testrigOptions testOptions;
+    setOptions(argc, argv, testOptions);
+
+    CUDPPConfiguration config;
+    config.algorithm = CUDPP_BFS;
+    config.op = CUDPP_ADD;
+    config.datatype = CUDPP_INT;
+    config.options = 0;
+
+    int retval = bfsTest(argc, argv, config, testOptions);
+
+    config.options = CUDPP_OPTION_HOST;
+    retval += bfsTest(argc, argv, config, testOptions);
+
+    return retval;
+}
@@ -0,0 +1,284 @@
+// -------------------------------------------------------------
+// CUDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision: $
+// $Date: $
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt in
+// the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+ * @file
+ * test_components.cpp
+ *
+ * @brief Host testrig routines to exercise cudpp's connected components
+ * functionality.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cuda_runtime_api.h>
+
+#include "cudpp.h"
+
+#include "cudpp_testrig_options.h"
+#include "cudpp_testrig_utils.h"
+#include "cuda_util.h"
+#include "stopwatch.h"
+#include "comparearrays.h"
+#include "backendarrays.h"
+#include "commandline.h"
+#include "components_gold.h"
+
+using namespace cudpp_app;
+
+/**
+ * componentsTest exercises connected components on one backend.
+ *
+ * For each size the test builds a random graph with shuffled vertex ids:
+ * clusters of up to 64 vertices with a few edges between clusters, which
+ * gives one large component and many small ones, or (on alternate sizes)
+ * a sparse random graph with many small components.  It labels the
+ * graph as an edge list and as a symmetric CSR graph, and checks the
+ * labels and the number of components against the CPU reference.
+ *
+ * Possible command line arguments:
+ * - --n=#: number of vertices
+ * @param argc Number of arguments on the command line, passed
+ * directly from main
+ * @param argv Array of arguments on the command line, passed directly
+ * from main
+ * @param config Plan configuration, with or without CUDPP_OPTION_HOST
+ * @param testOptions Global test options
+ * @return Number of tests that failed regression (0 for all pass)
+ * @see cudppConnectedComponents, cudppConnectedComponentsCSR
+ */
+int componentsTest(int argc, const char **argv, const CUDPPConfiguration &config,
+                   const testrigOptions &testOptions)
+{
+    int retval = 0;
+
+    cudpp_app::StopWatch timer;
+
+    bool host = (config.options & CUDPP_OPTION_HOST) != 0;
+
+    bool quiet = checkCommandLineFlag(argc, (const char**)argv, "quiet");   
+
+    unsigned int test[] = {1, 2, 39, 1000, 1025, 65536, 500001, 1048576};
+    int numTests = sizeof(test) / sizeof(test[0]);
+    int numVertices = test[numTests-1]; // maximum test size
+
+    bool oneTest = false;
+    if (commandLineArg(numVertices, argc, (const char**) argv, "n"))
+    {
+        oneTest = true;
+        numTests = 1;
+        test[0] = numVertices;
+    }
+
+    CUDPPResult result = CUDPP_SUCCESS;
+    CUDPPHandle theCudpp;
+    result = cudppCreate(&theCudpp);
+    if (result != CUDPP_SUCCESS)
+    {
+        if (!quiet)
+            fprintf(stderr, "Error initializing CUDPP Library.\n");
+        retval = (oneTest) ? 1 : numTests;
+        return retval;
+    }
+
+    CUDPPHandle plan;
+    result = cudppPlan(theCudpp, &plan, config, numVertices, 1, 0);
+
+    if (result != CUDPP_SUCCESS)
+    {
+        if (!quiet)
+            fprintf(stderr, "Error creating plan for ConnectedComponents\n");
+        retval = (oneTest) ? 1 : numTests;
+        return retval;
+    }
+
+    int maxEdges = 2 * numVertices;
+
+    int *h_order          = (int*) malloc(sizeof(int) * numVertices);
+    int *h_edgeU          = (int*) malloc(sizeof(int) * maxEdges);
+    int *h_edgeV          = (int*) malloc(sizeof(int) * maxEdges);
+    unsigned int *h_rows  = (unsigned int*) malloc(sizeof(unsigned int) * (numVertices + 1));
+    unsigned int *h_cols  = (unsigned int*) malloc(sizeof(unsigned int) * 2 * maxEdges);
+    unsigned int *h_fill  = (unsigned int*) malloc(sizeof(unsigned int) * numVertices);
+    int *reference        = (int*) malloc(sizeof(int) * numVertices);
+    int *o_data           = (int*) malloc(sizeof(int) * numVertices);
+
+    int *d_edgeU          = backendAlloc<int>(host, maxEdges);
+    int *d_edgeV          = backendAlloc<int>(host, maxEdges);
+    unsigned int *d_rows  = backendAlloc<unsigned int>(host, numVertices + 1);
+    unsigned int *d_cols  = backendAlloc<unsigned int>(host, 2 * maxEdges);
+    int *d_labels         = backendAlloc<int>(host, numVertices);
+
+    for (int k = 0; k < numTests; ++k)
+    {
+        int n = test[k];
+        bool clustered = (k % 2) == 0;
+        int numEdges = clustered ? 2 * n : n / 2;
+
+        if (!quiet)
+        {
+            printf("Running %sconnected components of %d vertices and %d %s edges\n",
+                host ? "host " : "", n, numEdges, clustered ? "clustered" : "random");
+            fflush(stdout);
+        }
+
+        for (int i = 0; i < n; i++)
+            h_order[i] = i;
+        for (int i = 0; i < n; i++)
+        {
+            int other = i + (rand() % (n - i));
+            int tmp = h_order[i];
+            h_order[i] = h_order[other];
+            h_order[other] = tmp;
+        }
+        // clustered graphs join shuffled runs of up to 64 vertices, and
+        // one edge in 64 joins two random vertices
+        for (int e = 0; e < numEdges; e++)
+        {
+            int a = rand() % n;
+            int b = rand() % n;
+            if (clustered && (e % 64) != 0)
+            {
+                int base = a & ~63;
+                int size = (n - base < 64) ? n - base : 64;
+                b = base + rand() % size;
+            }
+            h_edgeU[e] = h_order[a];
+            h_edgeV[e] = h_order[b];
+        }
+
+        // the symmetric CSR form lists every edge at both vertices
+        memset(h_rows, 0, sizeof(unsigned int) * (n + 1));
+        for (int e = 0; e < numEdges; e++)
+        {
+            h_rows[h_edgeU[e] + 1]++;
+            h_rows[h_edgeV[e] + 1]++;
+        }
+        for (int v = 0; v < n; v++)
+        {
+            h_rows[v + 1] += h_rows[v];
+            h_fill[v] = h_rows[v];
+        }
+        for (int e = 0; e < numEdges; e++)
+        {
+            h_cols[h_fill[h_edgeU[e]]++] = h_edgeV[e];
+            h_cols[h_fill[h_edgeV[e]]++] = h_edgeU[e];
+        }
+
+        int refComponents = connectedComponentsGold(reference, h_edgeU, h_edgeV, 
+                                                    numEdges, n);
+
+        backendCopy(host, d_edgeU, h_edgeU, numEdges, true);
+        backendCopy(host, d_edgeV, h_edgeV, numEdges, true);
+        backendCopy(host, d_rows, h_rows, n + 1, true);
+        backendCopy(host, d_cols, h_cols, h_rows[n], true);
+
+        size_t numComponents = 0;
+
+        // run once to avoid timing startup overhead.
+        result = cudppConnectedComponents(plan, d_labels, &numComponents, 
+                                          d_edgeU, d_edgeV, numEdges, n);
+
+        timer.reset();
+        timer.start();
+        for (int i = 0; i < testOptions.numIterations; i++)
+        {
+            cudppConnectedComponents(plan, d_labels, &numComponents, 
+                                     d_edgeU, d_edgeV, numEdges, n);
+        }
+        cudaThreadSynchronize();
+        timer.stop();
+
+        bool passed = (result == CUDPP_SUCCESS) && 
+                      (numComponents == (size_t)refComponents);
+        backendCopy(host, o_data, d_labels, n, false);
+        passed = compareArrays<int>(reference, o_data, n) && passed;
+
+        numComponents = 0;
+        result = cudppConnectedComponentsCSR(plan, d_labels, &numComponents,
+                                             d_rows, d_cols, n);
+        passed = passed && (result == CUDPP_SUCCESS) && 
+                 (numComponents == (size_t)refComponents);
+        backendCopy(host, o_data, d_labels, n, false);
+        passed = compareArrays<int>(reference, o_data, n) && passed;
+
+        retval += passed ? 0 : 1;
+        if (!quiet)
+        {
+            printf("test %s (%d components)\n", passed ? "PASSED" : "FAILED", 
+                   refComponents);
+            printf("Average execution time: %f ms\n",
+                timer.getTime() / testOptions.numIterations);
+        }
+        else
+            printf("\t%10d\t%0.4f\n", n, timer.getTime() / testOptions.numIterations);
+    }
+
+    result = cudppDestroyPlan(plan);
+    if (result != CUDPP_SUCCESS)
+    {
+        if (!quiet)
+            printf("Error destroying CUDPPPlan for ConnectedComponents\n");
+    }
+
+    result = cudppDestroy(theCudpp);
+    if (result != CUDPP_SUCCESS)
+    {
+        if (!quiet)
+            printf("Error shutting down CUDPP Library.\n");
+    }
+
+    free(h_order);
+    free(h_edgeU);
+    free(h_edgeV);
+    free(h_rows);
+    free(h_cols);
+    free(h_fill);
+    free(reference);
+    free(o_data);
+
+    backendFree(host, d_edgeU);
+    backendFree(host, d_edgeV);
+    backendFree(host, d_rows);
+    backendFree(host, d_cols);
+    backendFree(host, d_labels);
+
+    return retval;
+}
+
+/**
+ * testConnectedComponents runs the connected components tests on the GPU
+ * and on the host backend.
+ * @param argc Number of arguments on the command line, passed
+ * directly from main
+ * @param argv Array of arguments on the command line, passed directly
+ * from main
+ * @return Number of tests that failed regression (0 for all pass)
+ * @see componentsTest
+ */
+int testConnectedComponents(int argc, const char **argv)
+{
+    testrigOptions testOptions;
+    setOptions(argc, argv, testOptions);
+
+    CUDPPConfiguration config;
+    config.algorithm = CUDPP_CONNECTED_COMPONENTS;
+    config.op = CUDPP_ADD;
+    config.datatype = CUDPP_INT;
+    config.options = 0;
+
+    int retval = componentsTest(argc, argv, config, testOptions);
+
+    config.options = CUDPP_OPTION_HOST;
+    retval += componentsTest(argc, argv, config, testOptions);
+
+    return retval;
+}
@@ -35,7 +35,9 @@
 using namespace cudpp_app;
 
 /**
- * testListRank exercises cudpp's listrank functionality.
+ * listRankTest exercises cudpp's listrank functionality for one datatype.
+ * With CUDPP_OPTION_HOST in \a config the arrays are in host memory,
+ * and the test also checks that the next indices are left unchanged.
  * Possible command line arguments:
  * - --n=#: number of elements in input
  * @param argc Number of arguments on the command line, passed
@@ -53,6 +55,8 @@ int listRankTest(int argc, const char **argv, const CUDPPConfiguration &config,
 
     cudpp_app::StopWatch timer;
 
+    bool host = (config.options & CUDPP_OPTION_HOST) != 0;
+
     bool quiet = checkCommandLineFlag(argc, (const char**)argv, "quiet");   
 
     unsigned int test[] = {39, 128, 256, 512, 1000, 1024, 1025, 32768, 45537, 65536, 131072,
@@ -97,6 +101,7 @@ int listRankTest(int argc, const char **argv, const CUDPPConfiguration &config,
     T* h_values    = (T*) malloc( memSize);
     int* h_tmpvalues    = (int*) malloc( sizeof(int) * numElements);
     int* h_next_indices = (int*) malloc( sizeof(int) * numElements);
+    int* h_saved_indices = (int*) malloc( sizeof(int) * numElements);
 
     // allocate and compute reference solution
     T* reference = (T*) malloc( memSize);
@@ -106,15 +111,26 @@ int listRankTest(int argc, const char **argv, const CUDPPConfiguration &config,
     int* d_inextindices = NULL;
     T* d_ovalues        = NULL;
 
-    CUDA_SAFE_CALL( cudaMalloc( (void**) &d_ivalues, memSize));
-    CUDA_SAFE_CALL( cudaMalloc( (void**) &d_inextindices, sizeof(int) * numElements));
-    CUDA_SAFE_CALL( cudaMalloc( (void**) &d_ovalues, memSize));
+    if (host)
+    {
+        // the host backend reads and writes the host arrays directly
+        d_ivalues = h_values;
+        d_inextindices = h_next_indices;
+        d_ovalues = (T*) malloc( memSize);
+    }
+    else
+    {
+        CUDA_SAFE_CALL( cudaMalloc( (void**) &d_ivalues, memSize));
+        CUDA_SAFE_CALL( cudaMalloc( (void**) &d_inextindices, sizeof(int) * numElements));
+        CUDA_SAFE_CALL( cudaMalloc( (void**) &d_ovalues, memSize));
+    }
 
     for (int k = 0; k < numTests; ++k)
     {
         if (!quiet)
         {
-            printf("Running a listrank of %u %s nodes\n",
+            printf("Running a %slistrank of %u %s nodes\n",
+                host ? "host " : "",
                 test[k],
                 datatypeToString(config.datatype));
             fflush(stdout);
@@ -164,13 +180,21 @@ int listRankTest(int argc, const char **argv, const CUDPPConfiguration &config,
         memset(reference, 0, sizeof(T) * test[k]);
         listRankGold<T>( reference, h_values, h_next_indices, head, test[k]);
         
-        CUDA_SAFE_CALL( cudaMemcpy(d_ivalues, h_values, sizeof(T) * test[k],
-                                   cudaMemcpyHostToDevice) );
+        if (host)
+        {
+            memcpy(h_saved_indices, h_next_indices, sizeof(int) * test[k]);
+            memset(d_ovalues, 0, sizeof(T) * test[k]);
+        }
+        else
+        {
+            CUDA_SAFE_CALL( cudaMemcpy(d_ivalues, h_values, sizeof(T) * test[k],
+                                       cudaMemcpyHostToDevice) );
 
-        CUDA_SAFE_CALL( cudaMemcpy(d_inextindices, h_next_indices, sizeof(int) * test[k],
-                                   cudaMemcpyHostToDevice) );
+            CUDA_SAFE_CALL( cudaMemcpy(d_inextindices, h_next_indices, sizeof(int) * test[k],
+                                       cudaMemcpyHostToDevice) );
 
-        CUDA_SAFE_CALL( cudaMemset(d_ovalues, 0, sizeof(T) * test[k]));
+            CUDA_SAFE_CALL( cudaMemset(d_ovalues, 0, sizeof(T) * test[k]));
+        }
 
         // run once to avoid timing startup overhead.
         cudppListRank(plan, d_ovalues, d_ivalues, d_inextindices, head, test[k]);
@@ -188,12 +212,19 @@ int listRankTest(int argc, const char **argv, const CUDPPConfiguration &config,
         T* o_data = (T*) malloc( sizeof(T) * test[k]);
 
         // copy result from device to host
-        CUDA_SAFE_CALL(cudaMemcpy(o_data, d_ovalues,
-                                  sizeof(T) * test[k],
-                                  cudaMemcpyDeviceToHost));
+        if (host)
+            memcpy(o_data, d_ovalues, sizeof(T) * test[k]);
+        else
+            CUDA_SAFE_CALL(cudaMemcpy(o_data, d_ovalues,
+                                      sizeof(T) * test[k],
+                                      cudaMemcpyDeviceToHost));
             
         bool result = compareArrays<T>( reference, o_data, test[k]);
 
+        // the host backend must restore the next indices it marks
+        if (host)
+            result = compareArrays<int>( h_saved_indices, h_next_indices, test[k]) && result;
+
         free(o_data);
 
         retval += result ? 0 : 1;
@@ -203,6 +234,10 @@ int listRankTest(int argc, const char **argv, const CUDPPConfiguration &config,
         }
         if (!quiet)
         {
+            CUDPPListRankStats stats;
+            cudppListRankStats(plan, &stats);
+            printf("%lu sublists walked by %lu threads\n",
+                (unsigned long)stats.numSublists, (unsigned long)stats.numThreads);
             printf("Average execution time: %f ms\n",
                 timer.getTime() / testOptions.numIterations);
         }
@@ -228,32 +263,230 @@ int listRankTest(int argc, const char **argv, const CUDPPConfiguration &config,
     free( h_values);
     free( h_tmpvalues);
     free( h_next_indices);
+    free( h_saved_indices);
     free( reference);
-    cudaFree( d_ivalues);
-    cudaFree( d_inextindices);
-    cudaFree( d_ovalues);
+    if (host)
+    {
+        free( d_ovalues);
+    }
+    else
+    {
+        cudaFree( d_ivalues);
+        cudaFree( d_inextindices);
+        cudaFree( d_ovalues);
+    }
     return retval;
 }
 
-int testListRank(int argc, const char **argv, 
-                 const CUDPPConfiguration *configPtr)
+/**
+ * listScanTest exercises cudppListScan on random forests of int lists,
+ * with the operator and options in \a config.  The lists are found from
+ * the next indices (no heads are passed).
+ * Possible command line arguments:
+ * - --n=#: number of elements in input
+ * @return Number of tests that failed regression (0 for all pass)
+ * @see cudppListScan
+ */
+int listScanTest(int argc, const char **argv, const CUDPPConfiguration &config,
+                 const testrigOptions &testOptions)
 {
-    testrigOptions testOptions;
-    setOptions(argc, argv, testOptions);
+    int retval = 0;
 
-    CUDPPConfiguration config;
-    config.algorithm = CUDPP_LISTRANK;
-    config.options = 0;
+    cudpp_app::StopWatch timer;
 
-    if (configPtr != NULL)
+    bool host = (config.options & CUDPP_OPTION_HOST) != 0;
+    bool exclusive = (config.options & CUDPP_OPTION_EXCLUSIVE) != 0;
+    int identity = (config.op == CUDPP_MAX) ? INT_MIN :
+                   (config.op == CUDPP_MIN) ? INT_MAX : 0;
+
+    bool quiet = checkCommandLineFlag(argc, (const char**)argv, "quiet");   
+
+    unsigned int test[] = {39, 1000, 45537, 1048576};
+    int numTests = sizeof(test) / sizeof(test[0]);
+    int numElements = test[numTests-1]; // maximum test size
+
+    bool oneTest = false;
+    if (commandLineArg(numElements, argc, (const char**) argv, "n"))
     {
-        config = *configPtr;
+        oneTest = true;
+        numTests = 1;
+        test[0] = numElements;
+    }
+
+    CUDPPResult result = CUDPP_SUCCESS;
+    CUDPPHandle theCudpp;
+    result = cudppCreate(&theCudpp);
+    if (result != CUDPP_SUCCESS)
+    {
+        if (!quiet)
+            fprintf(stderr, "Error initializing CUDPP Library.\n");
+        retval = (oneTest) ? 1 : numTests;
+        return retval;
+    }
+
+    CUDPPHandle plan;
+    result = cudppPlan(theCudpp, &plan, config, numElements, 1, 0);
+
+    if (result != CUDPP_SUCCESS)
+    {
+        if (!quiet)
+            fprintf(stderr, "Error creating plan for ListScan\n");
+        retval = (oneTest) ? 1 : numTests;
+        return retval;
+    }
+
+    unsigned int memSize = sizeof(int) * numElements;
+
+    int* h_values       = (int*) malloc( memSize);
+    int* h_order        = (int*) malloc( memSize);
+    int* h_next_indices = (int*) malloc( memSize);
+    int* h_saved_indices = (int*) malloc( memSize);
+    int* reference      = (int*) malloc( memSize);
+    int* o_data         = (int*) malloc( memSize);
+
+    int* d_ivalues      = NULL;
+    int* d_inextindices = NULL;
+    int* d_ovalues      = NULL;
+
+    if (host)
+    {
+        d_ivalues = h_values;
+        d_inextindices = h_next_indices;
+        d_ovalues = (int*) malloc( memSize);
     }
     else
     {
-        config.datatype = CUDPP_INT;
+        CUDA_SAFE_CALL( cudaMalloc( (void**) &d_ivalues, memSize));
+        CUDA_SAFE_CALL( cudaMalloc( (void**) &d_inextindices, memSize));
+        CUDA_SAFE_CALL( cudaMalloc( (void**) &d_ovalues, memSize));
     }
 
+    for (int k = 0; k < numTests; ++k)
+    {
+        unsigned int n = test[k];
+        if (!quiet)
+        {
+            printf("Running a %s%s %s list scan of %u int nodes\n",
+                host ? "host " : "",
+                exclusive ? "exclusive" : "inclusive",
+                (config.op == CUDPP_MAX) ? "max" :
+                (config.op == CUDPP_MIN) ? "min" : "sum",
+                n);
+            fflush(stdout);
+        }
+
+        // a random forest: a shuffled order of the nodes cut into lists
+        // that average a thousand nodes
+        for (unsigned int i = 0; i < n; i++)
+        {
+            h_order[i] = i;
+            h_values[i] = (rand() % 1000) - 500;
+        }
+        for (unsigned int i = 0; i < n; i++)
+        {
+            int other = i + (rand() % (n - i));
+            int tmp = h_order[i];
+            h_order[i] = h_order[other];
+            h_order[other] = tmp;
+        }
+        for (unsigned int i = 0; i < n; i++)
+        {
+            bool tail = (i + 1 == n) || (rand() % 1000 == 0);
+            h_next_indices[h_order[i]] = tail ? -1 : h_order[i+1];
+        }
+
+        listScanGold<int>(reference, h_values, h_next_indices, n,
+                          config.op, identity, exclusive);
+
+        if (host)
+            memcpy(h_saved_indices, h_next_indices, memSize);
+        else
+        {
+            CUDA_SAFE_CALL( cudaMemcpy(d_ivalues, h_values, sizeof(int) * n,
+                                       cudaMemcpyHostToDevice) );
+            CUDA_SAFE_CALL( cudaMemcpy(d_inextindices, h_next_indices, sizeof(int) * n,
+                                       cudaMemcpyHostToDevice) );
+        }
+
+        // run once to avoid timing startup overhead.
+        result = cudppListScan(plan, d_ovalues, d_ivalues, d_inextindices,
+                               NULL, 0, n);
+
+        timer.reset();
+        timer.start();
+        for (int i = 0; i < testOptions.numIterations; i++)
+        {
+            cudppListScan(plan, d_ovalues, d_ivalues, d_inextindices, NULL, 0, n);
+        }
+        cudaThreadSynchronize();
+        timer.stop();
+
+        if (host)
+            memcpy(o_data, d_ovalues, sizeof(int) * n);
+        else
+            CUDA_SAFE_CALL(cudaMemcpy(o_data, d_ovalues, sizeof(int) * n,
+                                      cudaMemcpyDeviceToHost));
+
+        bool passed = (result == CUDPP_SUCCESS) &&
+            compareArrays<int>( reference, o_data, n);
+        if (host)
+            passed = compareArrays<int>( h_saved_indices, h_next_indices, n) && passed;
+
+        retval += passed ? 0 : 1;
+        if (!quiet)
+        {
+            printf("test %s\n", passed ? "PASSED" : "FAILED");
+            CUDPPListRankStats stats;
+            cudppListRankStats(plan, &stats);
+            printf("%lu sublists walked by %lu threads\n",
+                (unsigned long)stats.numSublists, (unsigned long)stats.numThreads);
+            printf("Average execution time: %f ms\n",
+                timer.getTime() / testOptions.numIterations);
+        }
+        else
+            printf("\t%10d\t%0.4f\n", n, timer.getTime() / testOptions.numIterations);
+    }
+
+    result = cudppDestroyPlan(plan);
+    if (result != CUDPP_SUCCESS)
+    {
+        if (!quiet)
+            printf("Error destroying CUDPPPlan for ListScan\n");
+    }
+
+    result = cudppDestroy(theCudpp);
+    if (result != CUDPP_SUCCESS)
+    {
+        if (!quiet)
+            printf("Error shutting down CUDPP Library.\n");
+    }
+
+    free( h_values);
+    free( h_order);
+    free( h_next_indices);
+    free( h_saved_indices);
+    free( reference);
+    free( o_data);
+    if (host)
+    {
+        free( d_ovalues);
+    }
+    else
+    {
+        cudaFree( d_ivalues);
+        cudaFree( d_inextindices);
+        cudaFree( d_ovalues);
+    }
+    return retval;
+}
+
+/**
+ * listRankTestDatatype runs listRankTest for the datatype of \a config.
+ * @return Number of tests that failed regression (0 for all pass)
+ */
+int listRankTestDatatype(int argc, const char **argv, const CUDPPConfiguration &config,
+                         const testrigOptions &testOptions)
+{
     switch(config.datatype)
     {
     case CUDPP_CHAR:
@@ -284,6 +517,51 @@ int testListRank(int argc, const char **argv,
     return 0;
 }
 
+int testListRank(int argc, const char **argv, 
+                 const CUDPPConfiguration *configPtr)
+{
+    testrigOptions testOptions;
+    setOptions(argc, argv, testOptions);
+
+    CUDPPConfiguration config;
+    config.algorithm = CUDPP_LISTRANK;
+    config.options = 0;
+
+    if (configPtr != NULL)
+    {
+        config = *configPtr;
+    }
+    else
+    {
+        config.datatype = CUDPP_INT;
+    }
+
+    int retval = listRankTestDatatype(argc, argv, config, testOptions);
+
+    // and again on the host backend
+    if (!(config.options & CUDPP_OPTION_HOST))
+    {
+        config.options |= CUDPP_OPTION_HOST;
+        retval += listRankTestDatatype(argc, argv, config, testOptions);
+    }
+
+    // list scans of forests: inclusive sums and exclusive maxima
+    CUDPPConfiguration scanConfig = config;
+    scanConfig.op = CUDPP_ADD;
+    scanConfig.datatype = CUDPP_INT;
+    scanConfig.options = 0;
+    retval += listScanTest(argc, argv, scanConfig, testOptions);
+    scanConfig.options = CUDPP_OPTION_HOST;
+    retval += listScanTest(argc, argv, scanConfig, testOptions);
+
+    scanConfig.op = CUDPP_MAX;
+    scanConfig.options = CUDPP_OPTION_EXCLUSIVE;
+    retval += listScanTest(argc, argv, scanConfig, testOptions);
+    scanConfig.options = CUDPP_OPTION_EXCLUSIVE | CUDPP_OPTION_HOST;
+    retval += listScanTest(argc, argv, scanConfig, testOptions);
+    return retval;
+}
+
 // Leave this at the end of the file
 // Local Variables:
 // mode:c++
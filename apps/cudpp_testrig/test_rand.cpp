@@ -17,6 +17,7 @@
 
 #include <cstdio>
 #include <cstring>
+#include <cmath>
 #include <cuda_runtime_api.h>
 #include "cudpp_testrig_options.h"
 #include "cudpp_testrig_utils.h"
@@ -27,6 +28,15 @@
 #include "common_config.h"
 
 using namespace cudpp_app;
+
+extern "C" void randCounterGold(unsigned int * data, size_t numElements, 
+                                CUDPPAlgorithm algorithm, unsigned int seed, 
+                                unsigned int stream, unsigned long long offset);
+extern "C" void randDistributionGold(void * data, size_t numElements, 
+                                     CUDPPAlgorithm algorithm, unsigned int seed, 
+                                     unsigned int stream, unsigned long long offset,
+                                     CUDPPRandDistribution distribution, 
+                                     CUDPPDatatype datatype, double param0, double param1);
  
 //windows uses \ as the path, so we must adjust our original path for this
 //also if you're using Visual Studio, the path is only two directories up rather than three
@@ -372,3 +382,345 @@ testRandMD5(int argc, const char** argv)
     return retval;
 }
 
+/**
+ * testRandCounter exercises the counter-based random number generators
+ * (CUDPP_RAND_PHILOX and CUDPP_RAND_THREEFRY).  For each size it checks
+ * - the GPU output against the CPU reference,
+ * - that generating the sequence in several unevenly sized chunks gives
+ *   the same result as generating it in one call, and
+ * - that cudppRandSkipAhead() jumps to the right position of the sequence.
+ *
+ * @param argc Number of arguments on the command line, passed
+ * directly from main
+ * @param argv Array of arguments on the command line, passed directly
+ * from main
+ * @return Number of tests that failed regression (0 for all pass)
+ * @see cudppRand, cudppRandSkipAhead, cudppRandStream
+ */
+int
+testRandCounter(int argc, const char** argv)
+{
+    int retval = 0;
+    unsigned int seed = 9999;   //constant seed
+    unsigned int stream = 17;
+    testrigOptions testOptions;
+    setOptions(argc, argv, testOptions);
+
+    bool quiet = checkCommandLineFlag(argc, (const char**) argv, "quiet");
+
+    unsigned int test[] = {1, 3, 39, 128, 1000, 1025, 65536, 500001, 1048581, 
+                           8388608, 33554433};
+    int numTests = sizeof(test) / sizeof(test[0]);
+
+    CUDPPAlgorithm algorithms[] = { CUDPP_RAND_PHILOX, CUDPP_RAND_THREEFRY };
+    const char * names[] = { "Philox4x32-10", "Threefry4x32-20" };
+
+    CUDPPHandle theCudpp;
+    CUDPPResult result = cudppCreate(&theCudpp);
+    if(result != CUDPP_SUCCESS)
+    {
+        printf("Error initializing CUDPP Library.\n");
+        return 2 * numTests;
+    }
+
+    StopWatch timer;
+
+    for (int a = 0; a < 2; a++)
+    {
+        CUDPPConfiguration config;
+        config.op = CUDPP_ADD;
+        config.datatype = CUDPP_UINT;
+        config.algorithm = algorithms[a];
+        config.options = 0;
+
+        for (int i = 0; i < numTests; i++)
+        {
+            unsigned int n = test[i];
+            CUDPPHandle randPlan = 0;
+            result = cudppPlan(theCudpp, &randPlan, config, n, 1, 0);
+            if (CUDPP_SUCCESS != result)
+            {
+                printf("Error creating CUDPPPlan\n");
+                exit(-1);
+            }
+
+            unsigned int * d_rand;
+            CUDA_SAFE_CALL(cudaMalloc((void**)&d_rand, n * sizeof(unsigned int)));
+            unsigned int * h_rand = (unsigned int *) malloc(sizeof(unsigned int) * n);
+            unsigned int * h_chunked = (unsigned int *) malloc(sizeof(unsigned int) * n);
+            unsigned int * reference = (unsigned int *) malloc(sizeof(unsigned int) * n);
+
+            if (!quiet)
+                printf("Generating %u random numbers with %s\n", n, names[a]);
+
+            // one-shot generation
+            cudppRandSeed(randPlan, seed);
+            cudppRandStream(randPlan, stream);
+            timer.reset();
+            timer.start();
+            cudppRand(randPlan, d_rand, n);
+            cudaThreadSynchronize();
+            timer.stop();
+            CUDA_SAFE_CALL(cudaMemcpy(h_rand, d_rand, sizeof(unsigned int) * n,
+                                      cudaMemcpyDeviceToHost));
+
+            randCounterGold(reference, n, algorithms[a], seed, stream, 0);
+            bool passed = (memcmp(h_rand, reference, sizeof(unsigned int) * n) == 0);
+
+            // chunked generation: odd chunk sizes so chunks start mid-block
+            cudppRandSeed(randPlan, seed);
+            cudppRandStream(randPlan, stream);
+            unsigned int chunk = (n > 7) ? n / 7 + 1 : 1;
+            for (unsigned int start = 0; start < n; start += chunk)
+            {
+                unsigned int count = (n - start < chunk) ? n - start : chunk;
+                cudppRand(randPlan, d_rand + start, count);
+            }
+            CUDA_SAFE_CALL(cudaMemcpy(h_chunked, d_rand, sizeof(unsigned int) * n,
+                                      cudaMemcpyDeviceToHost));
+            bool chunkPassed = (memcmp(h_chunked, reference, sizeof(unsigned int) * n) == 0);
+
+            // skip-ahead to the middle of the sequence
+            unsigned int skip = n / 2 + (n > 1 ? 1 : 0);
+            cudppRandSeed(randPlan, seed);
+            cudppRandStream(randPlan, stream);
+            cudppRandSkipAhead(randPlan, skip);
+            cudppRand(randPlan, d_rand, n - skip);
+            CUDA_SAFE_CALL(cudaMemcpy(h_chunked, d_rand, sizeof(unsigned int) * (n - skip),
+                                      cudaMemcpyDeviceToHost));
+            bool skipPassed = (memcmp(h_chunked, reference + skip, 
+                                      sizeof(unsigned int) * (n - skip)) == 0);
+
+            if (!passed || !chunkPassed || !skipPassed)
+                retval++;
+
+            if (!quiet)
+            {
+                printf("%u pseudorandom numbers generated in %f ms\n", n, timer.getTime());
+                printf("reference: %s, chunked: %s, skip-ahead: %s\n",
+                       passed ? "PASSED" : "FAILED", 
+                       chunkPassed ? "PASSED" : "FAILED",
+                       skipPassed ? "PASSED" : "FAILED");
+                printf("Test %s\n\n", (passed && chunkPassed && skipPassed) ? "PASSED" : "FAILED");
+            }
+            else
+                printf("\t%10u\t%0.4f%5c\n", n, timer.getTime(),' ');
+
+            CUDA_SAFE_CALL(cudaFree(d_rand));
+            free(h_rand);
+            free(h_chunked);
+            free(reference);
+            result = cudppDestroyPlan(randPlan);
+            if (CUDPP_SUCCESS != result)
+            {
+                printf("Error destroying CUDPPPlan\n");
+                exit(-1);
+            }
+        }
+    }
+
+    result = cudppDestroy(theCudpp);
+    if (CUDPP_SUCCESS != result)
+    {
+        printf("Error shutting down CUDPP Library.\n");
+        exit(-1);
+    }
+
+    if(!quiet)
+        printf("%u total tests failed in counter-based rand test.\n", retval);
+
+    return retval;
+}
+
+//compares a generated distribution against the CPU reference and returns 
+//the sample mean and variance of the generated values
+template <typename T>
+bool compareDistribution(const T * gpu, const T * reference, size_t n, 
+                         double tolerance, double & mean, double & variance)
+{
+    bool passed = true;
+    double sum = 0, sumSq = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        double g = (double)gpu[i], r = (double)reference[i];
+        if (fabs(g - r) > tolerance * (1.0 + fabs(r)))
+            passed = false;
+        sum += g;
+        sumSq += g * g;
+    }
+    mean = sum / n;
+    variance = sumSq / n - mean * mean;
+    return passed;
+}
+
+/**
+ * testRandDistributions exercises the distributions of the counter-based 
+ * random number generators (see cudppRandDistribution).  Each distribution
+ * is checked against the CPU reference (exactly for integer and uniform 
+ * outputs, to a small relative tolerance for the transcendental ones) and
+ * its sample mean and variance are checked against the expected values.
+ *
+ * @param argc Number of arguments on the command line, passed
+ * directly from main
+ * @param argv Array of arguments on the command line, passed directly
+ * from main
+ * @return Number of tests that failed regression (0 for all pass)
+ * @see cudppRand, cudppRandDistribution
+ */
+int
+testRandDistributions(int argc, const char** argv)
+{
+    int retval = 0;
+    unsigned int seed = 9999;
+    bool quiet = checkCommandLineFlag(argc, (const char**) argv, "quiet");
+
+    unsigned int n = 1048581;
+    commandLineArg(n, argc, (const char**) argv, "n");
+
+    struct DistributionTest
+    {
+        CUDPPRandDistribution distribution;
+        CUDPPDatatype datatype;
+        double param0, param1;
+        double expectedMean, expectedVariance;
+        const char * name;
+    };
+    
+    const DistributionTest tests[] = 
+    {
+        { CUDPP_RAND_UNIFORM,     CUDPP_FLOAT,  0, 0,  0.5,  1.0 / 12, "uniform float" },
+        { CUDPP_RAND_UNIFORM,     CUDPP_DOUBLE, 0, 0,  0.5,  1.0 / 12, "uniform double" },
+        { CUDPP_RAND_NORMAL,      CUDPP_FLOAT,  3, 2,  3.0,  4.0,      "normal float" },
+        { CUDPP_RAND_NORMAL,      CUDPP_DOUBLE, 3, 2,  3.0,  4.0,      "normal double" },
+        { CUDPP_RAND_EXPONENTIAL, CUDPP_FLOAT,  4, 0,  0.25, 1.0 / 16, "exponential float" },
+        { CUDPP_RAND_EXPONENTIAL, CUDPP_DOUBLE, 4, 0,  0.25, 1.0 / 16, "exponential double" },
+        { CUDPP_RAND_UNIFORM_INT, CUDPP_UINT,   10, 16, 12.5, 35.0 / 12, "integers in [10, 16)" },
+        { CUDPP_RAND_UNIFORM_INT, CUDPP_UINT,   0, 3000000000.0, 1.5e9, 7.5e17, 
+          "integers in [0, 3e9)" },
+    };
+    int numTests = sizeof(tests) / sizeof(tests[0]);
+
+    CUDPPAlgorithm algorithms[] = { CUDPP_RAND_PHILOX, CUDPP_RAND_THREEFRY };
+    const char * names[] = { "Philox4x32-10", "Threefry4x32-20" };
+
+    CUDPPHandle theCudpp;
+    CUDPPResult result = cudppCreate(&theCudpp);
+    if(result != CUDPP_SUCCESS)
+    {
+        printf("Error initializing CUDPP Library.\n");
+        return 2 * numTests;
+    }
+
+    void * d_rand;
+    CUDA_SAFE_CALL(cudaMalloc(&d_rand, n * sizeof(double)));
+    void * h_rand = malloc(n * sizeof(double));
+    void * reference = malloc(n * sizeof(double));
+
+    StopWatch timer;
+
+    for (int a = 0; a < 2; a++)
+    {
+        for (int t = 0; t < numTests; t++)
+        {
+            const DistributionTest & test = tests[t];
+
+            CUDPPConfiguration config;
+            config.op = CUDPP_ADD;
+            config.datatype = test.datatype;
+            config.algorithm = algorithms[a];
+            config.options = 0;
+
+            CUDPPHandle randPlan = 0;
+            result = cudppPlan(theCudpp, &randPlan, config, n, 1, 0);
+            if (CUDPP_SUCCESS != result)
+            {
+                printf("Error creating CUDPPPlan\n");
+                exit(-1);
+            }
+
+            cudppRandSeed(randPlan, seed);
+            // uniform is the default for real datatypes: Threefry relies
+            // on it, Philox selects it explicitly
+            if (test.distribution != CUDPP_RAND_UNIFORM || a == 0)
+                result = cudppRandDistribution(randPlan, test.distribution, 
+                                               test.param0, test.param1);
+            if (CUDPP_SUCCESS != result)
+            {
+                printf("Error setting distribution %s\n", test.name);
+                retval++;
+                cudppDestroyPlan(randPlan);
+                continue;
+            }
+
+            timer.reset();
+            timer.start();
+            cudppRand(randPlan, d_rand, n);
+            cudaThreadSynchronize();
+            timer.stop();
+
+            size_t elementSize = (test.datatype == CUDPP_DOUBLE) ? 
+                                 sizeof(double) : sizeof(unsigned int);
+            CUDA_SAFE_CALL(cudaMemcpy(h_rand, d_rand, n * elementSize, 
+                                      cudaMemcpyDeviceToHost));
+            randDistributionGold(reference, n, algorithms[a], seed, 0, 0,
+                                 test.distribution, test.datatype, 
+                                 test.param0, test.param1);
+
+            double mean = 0, variance = 0;
+            bool passed;
+            if (test.datatype == CUDPP_DOUBLE)
+                passed = compareDistribution((double*)h_rand, (double*)reference,
+                                             n, 1e-12, mean, variance);
+            else if (test.datatype == CUDPP_FLOAT)
+                passed = compareDistribution((float*)h_rand, (float*)reference,
+                                             n, 1e-5, mean, variance);
+            else
+                passed = compareDistribution((unsigned int*)h_rand, 
+                                             (unsigned int*)reference,
+                                             n, 0, mean, variance);
+
+            // loose statistical sanity check: 6 standard errors of the mean
+            double stdErr = sqrt(test.expectedVariance / n);
+            bool statsPassed = 
+                fabs(mean - test.expectedMean) < 6 * stdErr &&
+                fabs(variance - test.expectedVariance) < 0.05 * test.expectedVariance;
+
+            if (!passed || !statsPassed)
+                retval++;
+
+            if (!quiet)
+            {
+                printf("%s %s: %u values in %f ms, mean %g (expected %g), "
+                       "variance %g (expected %g)\n",
+                       names[a], test.name, n, timer.getTime(), 
+                       mean, test.expectedMean, variance, test.expectedVariance);
+                printf("Test %s\n\n", (passed && statsPassed) ? "PASSED" : "FAILED");
+            }
+            else
+                printf("\t%10u\t%0.4f%5c\n", n, timer.getTime(),' ');
+
+            result = cudppDestroyPlan(randPlan);
+            if (CUDPP_SUCCESS != result)
+            {
+                printf("Error destroying CUDPPPlan\n");
+                exit(-1);
+            }
+        }
+    }
+
+    CUDA_SAFE_CALL(cudaFree(d_rand));
+    free(h_rand);
+    free(reference);
+
+    result = cudppDestroy(theCudpp);
+    if (CUDPP_SUCCESS != result)
+    {
+        printf("Error shutting down CUDPP Library.\n");
+        exit(-1);
+    }
+
+    if(!quiet)
+        printf("%u total tests failed in rand distribution test.\n", retval);
+
+    return retval;
+}
@@ -0,0 +1,415 @@
+// -------------------------------------------------------------
+// CUDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision: $
+// $Date: $
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt in
+// the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+ * @file
+ * test_reduce_by_key.cpp
+ *
+ * @brief Host testrig routines to exercise cudpp's reduce-by-key and
+ * run-length encoding functionality.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cuda_runtime_api.h>
+
+#include "cudpp.h"
+
+#include "cudpp_testrig_options.h"
+#include "cudpp_testrig_utils.h"
+#include "cuda_util.h"
+#include "stopwatch.h"
+#include "comparearrays.h"
+#include "backendarrays.h"
+#include "commandline.h"
+#include "reduce_by_key_gold.h"
+
+using namespace cudpp_app;
+
+// Random runs of keys: a new key starts with probability 1 / meanRun
+static void rbkRandomRuns(unsigned int *keys, size_t numElements, int meanRun)
+{
+    unsigned int key = rand() % 16;
+    for (size_t i = 0; i < numElements; i++)
+    {
+        if (rand() % meanRun == 0)
+            key = rand() % 16;
+        keys[i] = key;
+    }
+}
+
+/**
+ * reduceByKeyTest exercises reduce-by-key for values of type T on one
+ * backend.
+ *
+ * For each size the keys are random runs of a few keys, with short runs
+ * on even sizes and long runs on odd ones, and the values are small
+ * random numbers.  The segment keys, reductions and count are checked
+ * against the CPU reference.
+ *
+ * Possible command line arguments:
+ * - --n=#: number of elements
+ * @param argc Number of arguments on the command line, passed
+ * directly from main
+ * @param argv Array of arguments on the command line, passed directly
+ * from main
+ * @param config Plan configuration, with or without CUDPP_OPTION_HOST
+ * @param testOptions Global test options
+ * @return Number of tests that failed regression (0 for all pass)
+ * @see cudppReduceByKey
+ */
+template <typename T>
+int reduceByKeyTest(int argc, const char **argv, const CUDPPConfiguration &config,
+                    const testrigOptions &testOptions)
+{
+    int retval = 0;
+
+    cudpp_app::StopWatch timer;
+
+    bool host = (config.options & CUDPP_OPTION_HOST) != 0;
+
+    bool quiet = checkCommandLineFlag(argc, (const char**)argv, "quiet");   
+
+    unsigned int test[] = {1, 7, 39, 1000, 1025, 65536, 131073, 1048576, 4194304};
+    int numTests = sizeof(test) / sizeof(test[0]);
+    int numElements = test[numTests-1]; // maximum test size
+
+    bool oneTest = false;
+    if (commandLineArg(numElements, argc, (const char**) argv, "n"))
+    {
+        oneTest = true;
+        numTests = 1;
+        test[0] = numElements;
+    }
+
+    CUDPPResult result = CUDPP_SUCCESS;
+    CUDPPHandle theCudpp;
+    result = cudppCreate(&theCudpp);
+    if (result != CUDPP_SUCCESS)
+    {
+        if (!quiet)
+            fprintf(stderr, "Error initializing CUDPP Library.\n");
+        retval = (oneTest) ? 1 : numTests;
+        return retval;
+    }
+
+    CUDPPHandle plan;
+    result = cudppPlan(theCudpp, &plan, config, numElements, 1, 0);
+
+    if (result != CUDPP_SUCCESS)
+    {
+        if (!quiet)
+            fprintf(stderr, "Error creating plan for ReduceByKey\n");
+        retval = (oneTest) ? 1 : numTests;
+        return retval;
+    }
+
+    unsigned int *h_keys      = (unsigned int*) malloc(sizeof(unsigned int) * numElements);
+    T *h_values               = (T*) malloc(sizeof(T) * numElements);
+    unsigned int *refKeys     = (unsigned int*) malloc(sizeof(unsigned int) * numElements);
+    T *refValues              = (T*) malloc(sizeof(T) * numElements);
+    unsigned int *o_keys      = (unsigned int*) malloc(sizeof(unsigned int) * numElements);
+    T *o_values               = (T*) malloc(sizeof(T) * numElements);
+
+    unsigned int *d_keys      = backendAlloc<unsigned int>(host, numElements);
+    T *d_values               = backendAlloc<T>(host, numElements);
+    unsigned int *d_keysOut   = backendAlloc<unsigned int>(host, numElements);
+    T *d_valuesOut            = backendAlloc<T>(host, numElements);
+
+    for (int k = 0; k < numTests; ++k)
+    {
+        size_t n = test[k];
+        int meanRun = (k % 2) ? 1000 : 4;
+
+        if (!quiet)
+        {
+            printf("Running %sreduce-by-key of %zu elements in runs of ~%d\n",
+                host ? "host " : "", n, meanRun);
+            fflush(stdout);
+        }
+
+        rbkRandomRuns(h_keys, n, meanRun);
+        for (size_t i = 0; i < n; i++)
+            h_values[i] = (T)(rand() % 4 + 1);
+
+        size_t refSegments = reduceByKeyGold(refKeys, refValues, h_keys, h_values, n,
+                                             config.op);
+
+        backendCopy(host, d_keys, h_keys, n, true);
+        backendCopy(host, d_values, h_values, n, true);
+
+        size_t numSegments = 0;
+
+        // run once to avoid timing startup overhead.
+        result = cudppReduceByKey(plan, d_keysOut, d_valuesOut, &numSegments,
+                                  d_keys, d_values, n);
+
+        timer.reset();
+        timer.start();
+        for (int i = 0; i < testOptions.numIterations; i++)
+        {
+            cudppReduceByKey(plan, d_keysOut, d_valuesOut, &numSegments,
+                             d_keys, d_values, n);
+        }
+        cudaThreadSynchronize();
+        timer.stop();
+
+        bool passed = (result == CUDPP_SUCCESS) && (numSegments == refSegments);
+        if (passed)
+        {
+            backendCopy(host, o_keys, d_keysOut, numSegments, false);
+            backendCopy(host, o_values, d_valuesOut, numSegments, false);
+            passed = compareArrays<unsigned int>(refKeys, o_keys, (unsigned int)numSegments);
+            passed = compareArrays<T>(refValues, o_values, (unsigned int)numSegments, 
+                                      0.001f) && passed;
+        }
+
+        retval += passed ? 0 : 1;
+        if (!quiet)
+        {
+            printf("test %s (%zu segments)\n", passed ? "PASSED" : "FAILED", refSegments);
+            printf("Average execution time: %f ms\n",
+                timer.getTime() / testOptions.numIterations);
+        }
+        else
+            printf("\t%10zu\t%0.4f\n", n, timer.getTime() / testOptions.numIterations);
+    }
+
+    result = cudppDestroyPlan(plan);
+    if (result != CUDPP_SUCCESS)
+    {
+        if (!quiet)
+            printf("Error destroying CUDPPPlan for ReduceByKey\n");
+    }
+
+    result = cudppDestroy(theCudpp);
+    if (result != CUDPP_SUCCESS)
+    {
+        if (!quiet)
+            printf("Error shutting down CUDPP Library.\n");
+    }
+
+    free(h_keys);
+    free(h_values);
+    free(refKeys);
+    free(refValues);
+    free(o_keys);
+    free(o_values);
+
+    backendFree(host, d_keys);
+    backendFree(host, d_values);
+    backendFree(host, d_keysOut);
+    backendFree(host, d_valuesOut);
+
+    return retval;
+}
+
+/**
+ * rleTest exercises run-length encoding of elements of type T on one
+ * backend, with the same random runs as reduceByKeyTest().
+ *
+ * Possible command line arguments:
+ * - --n=#: number of elements
+ * @param argc Number of arguments on the command line, passed
+ * directly from main
+ * @param argv Array of arguments on the command line, passed directly
+ * from main
+ * @param config Plan configuration, with or without CUDPP_OPTION_HOST
+ * @param testOptions Global test options
+ * @return Number of tests that failed regression (0 for all pass)
+ * @see cudppRLE
+ */
+template <typename T>
+int rleTest(int argc, const char **argv, const CUDPPConfiguration &config,
+            const testrigOptions &testOptions)
+{
+    int retval = 0;
+
+    cudpp_app::StopWatch timer;
+
+    bool host = (config.options & CUDPP_OPTION_HOST) != 0;
+
+    bool quiet = checkCommandLineFlag(argc, (const char**)argv, "quiet");   
+
+    unsigned int test[] = {1, 7, 39, 1000, 1025, 65536, 131073, 1048576, 4194304};
+    int numTests = sizeof(test) / sizeof(test[0]);
+    int numElements = test[numTests-1]; // maximum test size
+
+    bool oneTest = false;
+    if (commandLineArg(numElements, argc, (const char**) argv, "n"))
+    {
+        oneTest = true;
+        numTests = 1;
+        test[0] = numElements;
+    }
+
+    CUDPPResult result = CUDPP_SUCCESS;
+    CUDPPHandle theCudpp;
+    result = cudppCreate(&theCudpp);
+    if (result != CUDPP_SUCCESS)
+    {
+        if (!quiet)
+            fprintf(stderr, "Error initializing CUDPP Library.\n");
+        retval = (oneTest) ? 1 : numTests;
+        return retval;
+    }
+
+    CUDPPHandle plan;
+    result = cudppPlan(theCudpp, &plan, config, numElements, 1, 0);
+
+    if (result != CUDPP_SUCCESS)
+    {
+        if (!quiet)
+            fprintf(stderr, "Error creating plan for RLE\n");
+        retval = (oneTest) ? 1 : numTests;
+        return retval;
+    }
+
+    unsigned int *h_keys      = (unsigned int*) malloc(sizeof(unsigned int) * numElements);
+    T *h_in                   = (T*) malloc(sizeof(T) * numElements);
+    T *refValues              = (T*) malloc(sizeof(T) * numElements);
+    unsigned int *refLengths  = (unsigned int*) malloc(sizeof(unsigned int) * numElements);
+    T *o_values               = (T*) malloc(sizeof(T) * numElements);
+    unsigned int *o_lengths   = (unsigned int*) malloc(sizeof(unsigned int) * numElements);
+
+    T *d_in                   = backendAlloc<T>(host, numElements);
+    T *d_runValues            = backendAlloc<T>(host, numElements);
+    unsigned int *d_runLengths = backendAlloc<unsigned int>(host, numElements);
+
+    for (int k = 0; k < numTests; ++k)
+    {
+        size_t n = test[k];
+        int meanRun = (k % 2) ? 1000 : 4;
+
+        if (!quiet)
+        {
+            printf("Running %sRLE of %zu elements in runs of ~%d\n",
+                host ? "host " : "", n, meanRun);
+            fflush(stdout);
+        }
+
+        rbkRandomRuns(h_keys, n, meanRun);
+        for (size_t i = 0; i < n; i++)
+            h_in[i] = (T)h_keys[i];
+
+        size_t refRuns = runLengthEncodeGold(refValues, refLengths, h_in, n);
+
+        backendCopy(host, d_in, h_in, n, true);
+
+        size_t numRuns = 0;
+
+        // run once to avoid timing startup overhead.
+        result = cudppRLE(plan, d_runValues, d_runLengths, &numRuns, d_in, n);
+
+        timer.reset();
+        timer.start();
+        for (int i = 0; i < testOptions.numIterations; i++)
+        {
+            cudppRLE(plan, d_runValues, d_runLengths, &numRuns, d_in, n);
+        }
+        cudaThreadSynchronize();
+        timer.stop();
+
+        bool passed = (result == CUDPP_SUCCESS) && (numRuns == refRuns);
+        if (passed)
+        {
+            backendCopy(host, o_values, d_runValues, numRuns, false);
+            backendCopy(host, o_lengths, d_runLengths, numRuns, false);
+            passed = compareArrays<T>(refValues, o_values, (unsigned int)numRuns);
+            passed = compareArrays<unsigned int>(refLengths, o_lengths, 
+                                                 (unsigned int)numRuns) && passed;
+        }
+
+        retval += passed ? 0 : 1;
+        if (!quiet)
+        {
+            printf("test %s (%zu runs)\n", passed ? "PASSED" : "FAILED", refRuns);
+            printf("Average execution time: %f ms\n",
+                timer.getTime() / testOptions.numIterations);
+        }
+        else
+            printf("\t%10zu\t%0.4f\n", n, timer.getTime() / testOptions.numIterations);
+    }
+
+    result = cudppDestroyPlan(plan);
+    if (result != CUDPP_SUCCESS)
+    {
+        if (!quiet)
+            printf("Error destroying CUDPPPlan for RLE\n");
+    }
+
+    result = cudppDestroy(theCudpp);
+    if (result != CUDPP_SUCCESS)
+    {
+        if (!quiet)
+            printf("Error shutting down CUDPP Library.\n");
+    }
+
+    free(h_keys);
+    free(h_in);
+    free(refValues);
+    free(refLengths);
+    free(o_values);
+    free(o_lengths);
+
+    backendFree(host, d_in);
+    backendFree(host, d_runValues);
+    backendFree(host, d_runLengths);
+
+    return retval;
+}
+
+/**
+ * testReduceByKey runs the reduce-by-key tests (int sums, float maxima
+ * and double minima) and the run-length encoding tests (unsigned char
+ * and int elements) on the GPU and on the host backend.
+ * @param argc Number of arguments on the command line, passed
+ * directly from main
+ * @param argv Array of arguments on the command line, passed directly
+ * from main
+ * @return Number of tests that failed regression (0 for all pass)
+ * @see reduceByKeyTest, rleTest
+ */
+int testReduceByKey(int argc, const char **argv)
+{
+    testrigOptions testOptions;
+    setOptions(argc, argv, testOptions);
+
+    int retval = 0;
+    for (int host = 0; host < 2; ++host)
+    {
+        CUDPPConfiguration config;
+        config.algorithm = CUDPP_REDUCE_BY_KEY;
+        config.options = host ? CUDPP_OPTION_HOST : 0;
+
+        config.op = CUDPP_ADD;
+        config.datatype = CUDPP_INT;
+        retval += reduceByKeyTest<int>(argc, argv, config, testOptions);
+
+        config.op = CUDPP_MAX;
+        config.datatype = CUDPP_FLOAT;
+        retval += reduceByKeyTest<float>(argc, argv, config, testOptions);
+
+        config.op = CUDPP_MIN;
+        config.datatype = CUDPP_DOUBLE;
+        retval += reduceByKeyTest<double>(argc, argv, config, testOptions);
+
+        config.algorithm = CUDPP_RLE;
+        config.op = CUDPP_ADD;
+        config.datatype = CUDPP_UCHAR;
+        retval += rleTest<unsigned char>(argc, argv, config, testOptions);
+
+        config.datatype = CUDPP_INT;
+        retval += rleTest<int>(argc, argv, config, testOptions);
+    }
+
+    return retval;
+}
@@ -0,0 +1,252 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision: $
+// $Date: $
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt in
+// the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+ * @file
+ * test_shuffle.cpp
+ *
+ * @brief Host testrig routines to exercise cudpp's shuffle and sampling 
+ * functionality.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cuda_runtime_api.h>
+#include "cudpp_testrig_options.h"
+#include "cudpp_testrig_utils.h"
+#include "cuda_util.h"
+#include "stopwatch.h"
+#include "commandline.h"
+
+using namespace cudpp_app;
+
+extern "C" void shuffleIndicesGold(unsigned int * indices, size_t numOutputs, 
+                                   size_t numElements, bool withReplacement,
+                                   unsigned int seed, unsigned int stream, 
+                                   unsigned long long call);
+
+/**
+ * testShuffle exercises cudpp's random permutation and sampling 
+ * functionality.
+ *
+ * For each size, the test shuffles key-value pairs whose keys are 
+ * 100 * i and whose values are i, then checks that the output matches the 
+ * CPU reference, that it is a permutation of the input, and that each 
+ * value travelled with its key.  It then draws samples without and with 
+ * replacement on subsequent calls, and checks that reseeding reproduces 
+ * the first permutation.
+ * 
+ * Possible command line arguments:
+ * - --n=#: number of elements to shuffle
+ * - Also "global" options (see setOptions)
+ * @param argc Number of arguments on the command line, passed
+ * directly from main
+ * @param argv Array of arguments on the command line, passed directly
+ * from main
+ * @return Number of tests that failed regression (0 for all pass)
+ * @see cudppShuffle, cudppSample, cudppRandSeed
+ */
+int
+testShuffle(int argc, const char** argv)
+{
+    int retval = 0;
+    unsigned int seed = 2011;
+    unsigned int stream = 5;
+    testrigOptions testOptions;
+    setOptions(argc, argv, testOptions);
+
+    bool quiet = checkCommandLineFlag(argc, (const char**) argv, "quiet");
+
+    unsigned int test[] = {1, 2, 3, 39, 128, 1000, 1025, 65536, 500001, 
+                           1048581, 8388608};
+    int numTests = sizeof(test) / sizeof(test[0]);
+
+    int n = 0;
+    if (commandLineArg(n, argc, (const char**) argv, "n") && n > 0)
+    {
+        test[0] = n;
+        numTests = 1;
+    }
+
+    CUDPPHandle theCudpp;
+    CUDPPResult result = cudppCreate(&theCudpp);
+    if(result != CUDPP_SUCCESS)
+    {
+        printf("Error initializing CUDPP Library.\n");
+        return numTests;
+    }
+
+    CUDPPConfiguration config;
+    config.op = CUDPP_ADD;
+    config.datatype = CUDPP_UINT;
+    config.algorithm = CUDPP_SHUFFLE;
+    config.options = CUDPP_OPTION_KEY_VALUE_PAIRS;
+
+    StopWatch timer;
+
+    for (int i = 0; i < numTests; i++)
+    {
+        unsigned int numElements = test[i];
+        unsigned int numSamples = (numElements + 2) / 3;
+
+        CUDPPHandle plan = 0;
+        result = cudppPlan(theCudpp, &plan, config, numElements, 1, 0);
+        if (CUDPP_SUCCESS != result)
+        {
+            printf("Error creating CUDPPPlan\n");
+            exit(-1);
+        }
+
+        size_t memSize = sizeof(unsigned int) * numElements;
+        unsigned int *h_keys = (unsigned int*) malloc(memSize);
+        unsigned int *h_values = (unsigned int*) malloc(memSize);
+        unsigned int *h_keysOut = (unsigned int*) malloc(memSize);
+        unsigned int *h_valuesOut = (unsigned int*) malloc(memSize);
+        unsigned int *h_keysFirst = (unsigned int*) malloc(memSize);
+        unsigned int *indices = (unsigned int*) malloc(memSize);
+        unsigned char *seen = (unsigned char*) malloc(numElements);
+
+        for (unsigned int j = 0; j < numElements; j++)
+        {
+            h_keys[j] = 100 * j;
+            h_values[j] = j;
+        }
+
+        unsigned int *d_keys, *d_values, *d_keysOut, *d_valuesOut;
+        CUDA_SAFE_CALL(cudaMalloc((void**)&d_keys, memSize));
+        CUDA_SAFE_CALL(cudaMalloc((void**)&d_values, memSize));
+        CUDA_SAFE_CALL(cudaMalloc((void**)&d_keysOut, memSize));
+        CUDA_SAFE_CALL(cudaMalloc((void**)&d_valuesOut, memSize));
+        CUDA_SAFE_CALL(cudaMemcpy(d_keys, h_keys, memSize, cudaMemcpyHostToDevice));
+        CUDA_SAFE_CALL(cudaMemcpy(d_values, h_values, memSize, cudaMemcpyHostToDevice));
+
+        if (!quiet)
+            printf("Shuffling %u key-value pairs\n", numElements);
+
+        // call 0: full shuffle
+        cudppRandSeed(plan, seed);
+        cudppRandStream(plan, stream);
+        timer.reset();
+        timer.start();
+        cudppShuffle(plan, d_keysOut, d_valuesOut, d_keys, d_values, numElements);
+        cudaThreadSynchronize();
+        timer.stop();
+
+        CUDA_SAFE_CALL(cudaMemcpy(h_keysOut, d_keysOut, memSize, cudaMemcpyDeviceToHost));
+        CUDA_SAFE_CALL(cudaMemcpy(h_valuesOut, d_valuesOut, memSize, cudaMemcpyDeviceToHost));
+        memcpy(h_keysFirst, h_keysOut, memSize);
+
+        shuffleIndicesGold(indices, numElements, numElements, false, seed, stream, 0);
+        memset(seen, 0, numElements);
+        bool shufflePassed = true;
+        for (unsigned int j = 0; j < numElements && shufflePassed; j++)
+        {
+            unsigned int v = h_valuesOut[j];
+            shufflePassed = (v < numElements) && !seen[v] && 
+                            (h_keysOut[j] == 100 * v) && (v == indices[j]);
+            if (v < numElements) 
+                seen[v] = 1;
+        }
+
+        // call 1: sample without replacement
+        cudppSample(plan, d_keysOut, d_valuesOut, d_keys, d_values, 
+                    numSamples, numElements, 0);
+        CUDA_SAFE_CALL(cudaMemcpy(h_keysOut, d_keysOut, numSamples * sizeof(unsigned int),
+                                  cudaMemcpyDeviceToHost));
+        CUDA_SAFE_CALL(cudaMemcpy(h_valuesOut, d_valuesOut, numSamples * sizeof(unsigned int),
+                                  cudaMemcpyDeviceToHost));
+        shuffleIndicesGold(indices, numSamples, numElements, false, seed, stream, 1);
+        bool samplePassed = true;
+        for (unsigned int j = 0; j < numSamples && samplePassed; j++)
+            samplePassed = (h_valuesOut[j] == indices[j]) && 
+                           (h_keysOut[j] == 100 * indices[j]);
+
+        // call 2: sample with replacement, as many samples as elements
+        cudppSample(plan, d_keysOut, d_valuesOut, d_keys, d_values, 
+                    numElements, numElements, 1);
+        CUDA_SAFE_CALL(cudaMemcpy(h_keysOut, d_keysOut, memSize, cudaMemcpyDeviceToHost));
+        CUDA_SAFE_CALL(cudaMemcpy(h_valuesOut, d_valuesOut, memSize, cudaMemcpyDeviceToHost));
+        shuffleIndicesGold(indices, numElements, numElements, true, seed, stream, 2);
+        bool replacePassed = true;
+        for (unsigned int j = 0; j < numElements && replacePassed; j++)
+            replacePassed = (h_valuesOut[j] == indices[j]) && 
+                            (h_keysOut[j] == 100 * indices[j]) &&
+                            (indices[j] < numElements);
+
+        // reseeding reproduces the first permutation
+        cudppRandSeed(plan, seed);
+        cudppShuffle(plan, d_keysOut, 0, d_keys, 0, numElements);
+        CUDA_SAFE_CALL(cudaMemcpy(h_keysOut, d_keysOut, memSize, cudaMemcpyDeviceToHost));
+        bool reseedPassed = (memcmp(h_keysOut, h_keysFirst, memSize) == 0);
+
+        // sampling more elements than there are without replacement fails,
+        // and so does shuffling in place
+        bool errorPassed = (cudppSample(plan, d_keysOut, d_valuesOut, d_keys, 
+                                        d_values, numElements + 1, numElements, 
+                                        0) == CUDPP_ERROR_ILLEGAL_CONFIGURATION) &&
+                           (cudppShuffle(plan, d_keys, 0, d_keys, 0, numElements) ==
+                            CUDPP_ERROR_ILLEGAL_CONFIGURATION) &&
+                           (cudppShuffle(plan, d_keysOut, d_values, d_keys, d_values, 
+                                         numElements) == 
+                            CUDPP_ERROR_ILLEGAL_CONFIGURATION);
+
+        bool passed = shufflePassed && samplePassed && replacePassed && 
+                      reseedPassed && errorPassed;
+        if (!passed)
+            retval++;
+
+        if (!quiet)
+        {
+            printf("%u elements shuffled in %f ms\n", numElements, timer.getTime());
+            printf("shuffle: %s, sample: %s, with replacement: %s, "
+                   "reseed: %s, errors: %s\n",
+                   shufflePassed ? "PASSED" : "FAILED",
+                   samplePassed ? "PASSED" : "FAILED",
+                   replacePassed ? "PASSED" : "FAILED",
+                   reseedPassed ? "PASSED" : "FAILED",
+                   errorPassed ? "PASSED" : "FAILED");
+            printf("Test %s\n\n", passed ? "PASSED" : "FAILED");
+        }
+        else
+            printf("\t%10u\t%0.4f%5c\n", numElements, timer.getTime(), ' ');
+
+        CUDA_SAFE_CALL(cudaFree(d_keys));
+        CUDA_SAFE_CALL(cudaFree(d_values));
+        CUDA_SAFE_CALL(cudaFree(d_keysOut));
+        CUDA_SAFE_CALL(cudaFree(d_valuesOut));
+        free(h_keys);
+        free(h_values);
+        free(h_keysOut);
+        free(h_valuesOut);
+        free(h_keysFirst);
+        free(indices);
+        free(seen);
+
+        result = cudppDestroyPlan(plan);
+        if (CUDPP_SUCCESS != result)
+        {
+            printf("Error destroying CUDPPPlan\n");
+            exit(-1);
+        }
+    }
+
+    result = cudppDestroy(theCudpp);
+    if (CUDPP_SUCCESS != result)
+    {
+        printf("Error shutting down CUDPP Library.\n");
+        exit(-1);
+    }
+
+    if(!quiet)
+        printf("%d total tests failed in shuffle test.\n", retval);
+
+    return retval;
+}
@@ -26,6 +26,7 @@
 #include "cudpp_testrig_utils.h"
 #include "cuda_util.h"
 #include "comparearrays.h"
+#include "backendarrays.h"
 #include "stopwatch.h"
 #include "findfile.h"
 #include "commandline.h"
@@ -33,7 +34,8 @@
 using namespace cudpp_app;
 
 extern "C" void sparseMatrixVectorMultiplyGold(const MMMatrix * m, const float * x, float * y);
-extern "C" void readMatrixMarket(MMMatrix * m, const char * filename);
+extern "C" void readMatrixMarket(MMMatrix * m, const char * filename, 
+                                 const char * cacheDir);
 
 /** just plain fopen, but if it doesn't work, lop off subdirectories 
  * until it does */
@@ -66,10 +68,374 @@ extern "C" void readMatrixMarket(MMMatrix * m, const char * filename);
 }*/
 
 
+/**
+ * Computes Y = alpha * A * X + beta * Y on the host for the matrix \a m.
+ */
+template <typename T>
+void sparseMatrixDenseMultiplyGold(const MMMatrix & m, const T * x, T * y, 
+                                   size_t numVectors, size_t yPitch, size_t xPitch,
+                                   T alpha, T beta)
+{
+    for (size_t v = 0; v < numVectors; v++)
+    {
+        for (unsigned int i = 0; i < m.getRows(); i++)
+        {
+            y[v * yPitch + i] *= beta;
+        }
+        for (unsigned int i = 0; i < m.getNumEntries(); i++)
+        {
+            y[v * yPitch + m[i].getRow()] += 
+                alpha * (T)m[i].getEntry() * x[v * xPitch + m[i].getCol()];
+        }
+    }
+}
+
+/**
+ * testSparseMatrixDenseMultiply exercises cudppSparseMatrixDenseMultiply for
+ * datatype \a T: y = alpha * A * x + beta * y for one vector, and for a block
+ * of vectors with padded pitches and beta = 0 (y is not read).  If \a host,
+ * the matrix and vectors are in host memory (CUDPP_OPTION_HOST).
+ * @param m The matrix
+ * @param rowPtrs The index of the first entry of each row of \a m
+ * @param indx The column of each entry of \a m
+ * @param theCudpp The CUDPP library handle
+ * @param datatype The CUDPP datatype matching \a T
+ * @param epsilon The largest error allowed in each result element
+ * @param host Whether to multiply on the host
+ * @return Number of tests that failed regression (0 for all pass)
+ */
+template <typename T>
+int testSparseMatrixDenseMultiply(const MMMatrix & m, const unsigned int * rowPtrs,
+                                  const unsigned int * indx, CUDPPHandle theCudpp, 
+                                  CUDPPDatatype datatype, float epsilon, bool host)
+{
+    int retval = 0;
+
+    const unsigned int rows = m.getRows();
+    const unsigned int cols = m.getCols();
+    const unsigned int entries = m.getNumEntries();
+
+    T * A = (T *) malloc(sizeof(T) * entries);
+    for (unsigned int i = 0; i < entries; i++)
+    {
+        A[i] = (T)m[i].getEntry();
+    }
+
+    CUDPPConfiguration config;
+    config.datatype = datatype;
+    config.options = host ? CUDPP_OPTION_HOST : (CUDPPOption)0;
+    config.algorithm = CUDPP_SPMVMULT;
+
+    CUDPPHandle sparseMatrixHandle;
+    CUDPPResult result = cudppSparseMatrix(theCudpp, &sparseMatrixHandle, config, 
+                                           entries, rows, (void *)A, rowPtrs, indx);
+    if (result != CUDPP_SUCCESS)
+    {
+        fprintf(stderr, "Error creating Sparse matrix object\n");
+        free(A);
+        return 1;
+    }
+
+    const size_t numVectorsTested[] = { 1, 5 };
+    for (unsigned int t = 0; t < 2; t++)
+    {
+        size_t numVectors = numVectorsTested[t];
+        size_t xPitch = cols + 3 * t;
+        size_t yPitch = rows + 5 * t;
+        T alpha = (T)2;
+        T beta = (numVectors == 1) ? (T)0.5 : (T)0;
+
+        T * x = (T *) malloc(sizeof(T) * xPitch * numVectors);
+        T * y = (T *) malloc(sizeof(T) * yPitch * numVectors);
+        T * reference = (T *) malloc(sizeof(T) * yPitch * numVectors);
+
+        for (size_t i = 0; i < xPitch * numVectors; i++)
+        {
+            x[i] = (T)1 + (T)(i % 4) * (T)0.25;
+        }
+        for (size_t i = 0; i < yPitch * numVectors; i++)
+        {
+            y[i] = (T)(i % 3);
+            reference[i] = y[i];
+        }
+
+        sparseMatrixDenseMultiplyGold(m, x, reference, numVectors, yPitch, xPitch, 
+                                      alpha, beta);
+
+        T * d_x = backendAlloc<T>(host, xPitch * numVectors);
+        T * d_y = backendAlloc<T>(host, yPitch * numVectors);
+        backendCopy(host, d_x, x, xPitch * numVectors, true);
+        backendCopy(host, d_y, y, yPitch * numVectors, true);
+
+        result = cudppSparseMatrixDenseMultiply(sparseMatrixHandle, d_y, d_x, numVectors,
+                                                yPitch, xPitch, &alpha, &beta);
+
+        backendCopy(host, y, d_y, yPitch * numVectors, false);
+
+        bool spmm_result = (result == CUDPP_SUCCESS);
+        for (size_t v = 0; v < numVectors; v++)
+        {
+            spmm_result &= compareArrays(reference + v * yPitch, y + v * yPitch, 
+                                         rows, epsilon);
+        }
+        retval += spmm_result ? 0 : 1;
+
+        printf("sparse matrix-dense multiply test (%s%s, %d vectors) %s\n", 
+               host ? "host, " : "", datatypeToString(datatype), (int)numVectors, 
+               spmm_result ? "PASSED" : "FAILED");
+
+        free(x);
+        free(y);
+        free(reference);
+        backendFree(host, d_x);
+        backendFree(host, d_y);
+    }
+
+    cudppDestroySparseMatrix(sparseMatrixHandle);
+    free(A);
+
+    return retval;
+}
+
+/**
+ * testSparseMatrixMultiply exercises cudppSparseMatrixMultiply for datatype
+ * \a T: C = A^T * A is checked by multiplying it with a vector, then A is 
+ * scaled by 2 with cudppSparseMatrixUpdateValues and C recomputed with 
+ * cudppSparseMatrixMultiplyNumeric, which must give 4 * A^T * A.
+ * @param m The matrix
+ * @param rowPtrs The index of the first entry of each row of \a m
+ * @param indx The column of each entry of \a m
+ * @param theCudpp The CUDPP library handle
+ * @param datatype The CUDPP datatype matching \a T
+ * @param epsilon The largest error allowed in each result element
+ * @return Number of tests that failed regression (0 for all pass)
+ */
+template <typename T>
+int testSparseMatrixMultiply(const MMMatrix & m, const unsigned int * rowPtrs,
+                             const unsigned int * indx, CUDPPHandle theCudpp, 
+                             CUDPPDatatype datatype, float epsilon)
+{
+    int retval = 0;
+
+    const unsigned int rows = m.getRows();
+    const unsigned int cols = m.getCols();
+    const unsigned int entries = m.getNumEntries();
+
+    T * A = (T *) malloc(sizeof(T) * entries);
+    for (unsigned int i = 0; i < entries; i++)
+    {
+        A[i] = (T)m[i].getEntry();
+    }
+
+    CUDPPConfiguration config;
+    config.datatype = datatype;
+    config.options = (CUDPPOption)0;
+    config.algorithm = CUDPP_SPMVMULT;
+
+    CUDPPHandle sparseMatrixHandle;
+    CUDPPResult result = cudppSparseMatrix(theCudpp, &sparseMatrixHandle, config, 
+                                           entries, rows, (void *)A, rowPtrs, indx);
+    if (result != CUDPP_SUCCESS)
+    {
+        fprintf(stderr, "Error creating Sparse matrix object\n");
+        free(A);
+        return 1;
+    }
+
+    CUDPPHandle productHandle;
+    config.options = CUDPP_OPTION_SPMV_TRANSPOSE_A;
+    result = cudppSparseMatrixMultiply(theCudpp, &productHandle, config, 
+                                       sparseMatrixHandle, sparseMatrixHandle);
+    if (result != CUDPP_SUCCESS)
+    {
+        fprintf(stderr, "Error creating Sparse matrix product\n");
+        cudppDestroySparseMatrix(sparseMatrixHandle);
+        free(A);
+        return 1;
+    }
+
+    // reference = A^T * (A * x)
+    T * x = (T *) malloc(sizeof(T) * cols);
+    T * y = (T *) malloc(sizeof(T) * cols);
+    T * ax = (T *) malloc(sizeof(T) * rows);
+    T * reference = (T *) malloc(sizeof(T) * cols);
+    for (unsigned int i = 0; i < cols; i++)
+    {
+        x[i] = (T)1 + (T)(i % 4) * (T)0.25;
+        reference[i] = 0;
+    }
+    for (unsigned int i = 0; i < rows; i++)
+    {
+        ax[i] = 0;
+    }
+    for (unsigned int i = 0; i < entries; i++)
+    {
+        ax[m[i].getRow()] += A[i] * x[m[i].getCol()];
+    }
+    for (unsigned int i = 0; i < entries; i++)
+    {
+        reference[m[i].getCol()] += A[i] * ax[m[i].getRow()];
+    }
+
+    T * d_x;
+    T * d_y;
+    CUDA_SAFE_CALL(cudaMalloc((void**) &d_x, cols * sizeof(T))); 
+    CUDA_SAFE_CALL(cudaMalloc((void**) &d_y, cols * sizeof(T))); 
+    CUDA_SAFE_CALL(cudaMemcpy(d_x, x, cols * sizeof(T), cudaMemcpyHostToDevice));
+    CUDA_SAFE_CALL(cudaMemset(d_y, 0, cols * sizeof(T)));
+
+    for (unsigned int t = 0; t < 2; t++)
+    {
+        T alpha = (T)1;
+        T beta = (T)0;
+        if (t == 1)
+        {
+            // Recompute the product for 2 * A: 4 * A^T * A
+            for (unsigned int i = 0; i < entries; i++)
+            {
+                A[i] *= (T)2;
+            }
+            for (unsigned int i = 0; i < cols; i++)
+            {
+                reference[i] *= (T)4;
+            }
+            result = cudppSparseMatrixUpdateValues(sparseMatrixHandle, A);
+            if (result == CUDPP_SUCCESS)
+            {
+                result = cudppSparseMatrixMultiplyNumeric(productHandle, sparseMatrixHandle,
+                                                          sparseMatrixHandle);
+            }
+        }
+
+        if (result == CUDPP_SUCCESS)
+        {
+            result = cudppSparseMatrixDenseMultiply(productHandle, d_y, d_x, 1, 0, 0,
+                                                    &alpha, &beta);
+        }
+        CUDA_SAFE_CALL(cudaMemcpy(y, d_y, cols * sizeof(T), cudaMemcpyDeviceToHost));
+
+        bool spgemm_result = (result == CUDPP_SUCCESS) && 
+                             compareArrays(reference, y, cols, epsilon);
+        retval += spgemm_result ? 0 : 1;
+
+        printf("sparse matrix multiply test (%s, A^T * A%s) %s\n", 
+               datatypeToString(datatype), (t == 1) ? ", numeric reuse" : "", 
+               spgemm_result ? "PASSED" : "FAILED");
+    }
+
+    free(x);
+    free(y);
+    free(ax);
+    free(reference);
+    CUDA_SAFE_CALL(cudaFree(d_x));
+    CUDA_SAFE_CALL(cudaFree(d_y));
+
+    cudppDestroySparseMatrix(productHandle);
+    cudppDestroySparseMatrix(sparseMatrixHandle);
+    free(A);
+
+    return retval;
+}
+
+/**
+ * testSparseMatrixVectorRowLengths multiplies a generated matrix whose rows
+ * include empty ones (among them the first and the last) and one row that
+ * spans many CTAs' shares of the merge path, so that partial row sums are
+ * carried between threads and between CTAs.  The entries are small
+ * integers, so the result must match the host product exactly.  If \a host,
+ * the matrix and vectors are in host memory (CUDPP_OPTION_HOST).
+ * @param theCudpp The CUDPP library handle
+ * @param host Whether to multiply on the host
+ * @return Number of tests that failed regression (0 for all pass)
+ */
+int testSparseMatrixVectorRowLengths(CUDPPHandle theCudpp, bool host)
+{
+    const unsigned int rows = 5000;
+    const unsigned int cols = 3000;
+    const unsigned int longRow = 1000;
+    const unsigned int longRowLength = 20000;
+
+    unsigned int * rowPtrs = (unsigned int *) malloc(sizeof(unsigned int) * (rows + 1));
+    rowPtrs[0] = 0;
+    for (unsigned int i = 0; i < rows; i++)
+    {
+        unsigned int length = (i == longRow) ? longRowLength :
+            (i % 3 == 0 || i == rows - 1) ? 0 : 1 + i % 5;
+        rowPtrs[i + 1] = rowPtrs[i] + length;
+    }
+    const unsigned int entries = rowPtrs[rows];
+
+    float * A = (float *) malloc(sizeof(float) * entries);
+    unsigned int * indx = (unsigned int *) malloc(sizeof(unsigned int) * entries);
+    float * x = (float *) malloc(sizeof(float) * cols);
+    float * y = (float *) malloc(sizeof(float) * rows);
+    float * reference = (float *) malloc(sizeof(float) * rows);
+
+    for (unsigned int j = 0; j < cols; j++)
+        x[j] = (float)((int)(j % 5) - 2);
+
+    for (unsigned int i = 0; i < rows; i++)
+    {
+        reference[i] = 1.0f;
+        for (unsigned int e = rowPtrs[i]; e < rowPtrs[i + 1]; e++)
+        {
+            A[e] = (float)((int)(e % 7) - 3);
+            indx[e] = (e * 7919 + i) % cols;
+            reference[i] += A[e] * x[indx[e]];
+        }
+    }
+
+    for (unsigned int i = 0; i < rows; i++)
+        y[i] = 1.0f;
+    float * d_x = backendAlloc<float>(host, cols);
+    float * d_y = backendAlloc<float>(host, rows);
+    backendCopy(host, d_x, x, cols, true);
+    backendCopy(host, d_y, y, rows, true);
+
+    CUDPPConfiguration config;
+    config.datatype = CUDPP_FLOAT;
+    config.options = host ? CUDPP_OPTION_HOST : CUDPP_OPTION_SPMV_CSR;
+    config.algorithm = CUDPP_SPMVMULT;
+
+    int retval = 0;
+    CUDPPHandle sparseMatrixHandle;
+    if (cudppSparseMatrix(theCudpp, &sparseMatrixHandle, config, entries, rows,
+                          (void *)A, rowPtrs, indx) != CUDPP_SUCCESS)
+    {
+        fprintf(stderr, "Error creating Sparse matrix object\n");
+        retval = 1;
+    }
+    else
+    {
+        cudppSparseMatrixVectorMultiply(sparseMatrixHandle, d_y, d_x);
+        backendCopy(host, y, d_y, rows, false);
+
+        bool passed = compareArrays(reference, y, rows);
+        retval += passed ? 0 : 1;
+        printf("sparsemv row length test (%s) %s\n", host ? "host" : "GPU",
+               passed ? "PASSED" : "FAILED");
+
+        cudppDestroySparseMatrix(sparseMatrixHandle);
+    }
+
+    free(rowPtrs);
+    free(A);
+    free(indx);
+    free(x);
+    free(y);
+    free(reference);
+    backendFree(host, d_x);
+    backendFree(host, d_y);
+
+    return retval;
+}
+
 /**
  * testSparseMatrixVectorMultiply exercises cudpp's sparse matrix-vector functionality.
  * Possible command line arguments:
  * - --mat=filename: path to filename with matrix in MatrixMarket format
+ * - --csrcache=directory: keep a binary copy of the matrix in directory, 
+ *   which later runs read instead of parsing the file
  * - Also "global" options (see setOptions)
  * @param argc Number of arguments on the command line, passed
  * directly from main
@@ -103,8 +469,11 @@ testSparseMatrixVectorMultiply(int argc, const char** argv)
         exit(1);
     }
 
+    std::string cacheDir = "";
+    bool isCached = commandLineArg(cacheDir, argc, (const char**) argv, "csrcache");
+
     MMMatrix m;
-    readMatrixMarket(&m, foundMfile);
+    readMatrixMarket(&m, foundMfile, isCached ? cacheDir.c_str() : NULL);
 
     const unsigned int cols = m.getCols();
     const unsigned int rows = m.getRows();
@@ -163,68 +532,190 @@ testSparseMatrixVectorMultiply(int argc, const char** argv)
         return 1;
     }
 
-    CUDPPHandle sparseMatrixHandle;
-    
-    result = cudppSparseMatrix(theCudpp, &sparseMatrixHandle, config, entries, 
-                               rows, (void *)A, m.getRowPtrs(), indx);
-
-    if (result != CUDPP_SUCCESS)
-    {
-        fprintf(stderr, "Error creating Sparse matrix object\n");
-        return 1;
-    }
-
-    // Run it once to avoid timing startup overhead
-    cudppSparseMatrixVectorMultiply(sparseMatrixHandle, d_y, d_x);
-    
     // Compute gold comparison
     sparseMatrixVectorMultiplyGold(&m, x, reference);
-    
-    for (int i = 0; i < testOptions.numIterations; i++)
+
+    // Automatic format selection, then each storage format explicitly,
+    // then reordered (square matrices only)
+    const unsigned int formats[] = { 0, 
+                                     CUDPP_OPTION_SPMV_CSR, 
+                                     CUDPP_OPTION_SPMV_ELL, 
+                                     CUDPP_OPTION_SPMV_SELL, 
+                                     CUDPP_OPTION_SPMV_BSR,
+                                     CUDPP_OPTION_SPMV_REORDER,
+                                     CUDPP_OPTION_SPMV_REORDER | CUDPP_OPTION_SPMV_CSR };
+    const unsigned int numFormats = sizeof(formats) / sizeof(formats[0]);
+
+    for (unsigned int f = 0; f < numFormats; f++)
     {
+        if ((formats[f] & CUDPP_OPTION_SPMV_REORDER) && rows != cols)
+        {
+            continue;
+        }
+        config.options = (CUDPPOption)formats[f];
+
+        CUDPPHandle sparseMatrixHandle;
+
+        result = cudppSparseMatrix(theCudpp, &sparseMatrixHandle, config, entries, 
+                                   rows, (void *)A, m.getRowPtrs(), indx);
+
+        if (result != CUDPP_SUCCESS)
+        {
+            fprintf(stderr, "Error creating Sparse matrix object\n");
+            return 1;
+        }
+
+        CUDPPOption format;
+        cudppSparseMatrixFormat(sparseMatrixHandle, &format);
+
+        const char *formatName = 
+            (format == CUDPP_OPTION_SPMV_ELL)  ? "ELL" :
+            (format == CUDPP_OPTION_SPMV_SELL) ? "SELL" :
+            (format == CUDPP_OPTION_SPMV_BSR)  ? "BSR" : "CSR";
+
+        // Run it once to avoid timing startup overhead
+        cudppSparseMatrixVectorMultiply(sparseMatrixHandle, d_y, d_x);
+
+        timer.reset();
+        for (int i = 0; i < testOptions.numIterations; i++)
+        {
+            CUDA_SAFE_CALL(cudaMemcpy(d_y, y, rows * sizeof(float),
+                                      cudaMemcpyHostToDevice));
+            timer.start();
+            cudppSparseMatrixVectorMultiply(sparseMatrixHandle, d_y, d_x);
+            cudaThreadSynchronize();
+            timer.stop();
+        }
+
+        float * h_y = (float *) malloc(sizeof(float) * rows);
+        CUDA_SAFE_CALL(cudaMemcpy(h_y, d_y, rows * sizeof(float),
+                                  cudaMemcpyDeviceToHost));
+
+        // epsilon is 0.001f, answer must be within epsilon
+        bool spmv_result = compareArrays(reference, h_y, rows, 0.001f);
+        retval += spmv_result ? 0 : 1;
+
+        if (testOptions.debug)
+        {
+            for (unsigned int i = 0; i < rows; i++)
+            {
+                printf("i: %d\tref: %f\ty: %f\n", i, reference[i], h_y[i]);
+            }
+        }
+
+        printf("sparsemv test (%s%s%s) %s\n", 
+               (formats[f] & ~CUDPP_OPTION_SPMV_REORDER) ? "" : "auto: ", formatName,
+               (formats[f] & CUDPP_OPTION_SPMV_REORDER) ? ", reordered" : "",
+               spmv_result ? "PASSED" : "FAILED");
+        printf("Average execution time: %f ms\n", 
+               timer.getTime() / testOptions.numIterations);
+
+        // Double the values in place; the product must double too
+        float * A2 = (float *) malloc(sizeof(float) * entries);
+        float * reference2 = (float *) malloc(sizeof(float) * rows);
+        for (unsigned int i = 0; i < entries; i++)
+        {
+            A2[i] = 2.0f * A[i];
+        }
+        for (unsigned int i = 0; i < rows; i++)
+        {
+            reference2[i] = 2.0f * reference[i];
+        }
+
         CUDA_SAFE_CALL(cudaMemcpy(d_y, y, rows * sizeof(float),
                                   cudaMemcpyHostToDevice));
-        timer.start();
+        result = cudppSparseMatrixUpdateValues(sparseMatrixHandle, A2);
         cudppSparseMatrixVectorMultiply(sparseMatrixHandle, d_y, d_x);
-        cudaThreadSynchronize();
-        timer.stop();
-    }
+        CUDA_SAFE_CALL(cudaMemcpy(h_y, d_y, rows * sizeof(float),
+                                  cudaMemcpyDeviceToHost));
 
-    CUDA_SAFE_CALL(cudaMemcpy(y, d_y, rows * sizeof(float),
-                              cudaMemcpyDeviceToHost));
+        bool update_result = (result == CUDPP_SUCCESS) && 
+                             compareArrays(reference2, h_y, rows, 0.002f);
+        retval += update_result ? 0 : 1;
 
-    // epsilon is 0.001f, answer must be within epsilon
-    bool spmv_result = compareArrays(reference, y, rows, 0.001f);
-    retval += spmv_result ? 0 : 1;
+        printf("sparse matrix update values test (%s) %s\n", formatName,
+               update_result ? "PASSED" : "FAILED");
 
-    if (testOptions.debug)
-    {
+        // y = A^T * ones on the updated matrix: twice the column sums of A
+        float * ones = (float *) malloc(sizeof(float) * rows);
+        float * yt = (float *) malloc(sizeof(float) * cols);
+        float * referencet = (float *) malloc(sizeof(float) * cols);
         for (unsigned int i = 0; i < rows; i++)
         {
-            printf("i: %d\tref: %f\ty: %f\n", i, reference[i], y[i]);
+            ones[i] = 1.0f;
+        }
+        for (unsigned int i = 0; i < cols; i++)
+        {
+            yt[i] = 0.0f;
+            referencet[i] = 0.0f;
+        }
+        for (unsigned int i = 0; i < entries; i++)
+        {
+            referencet[m[i].getCol()] += A2[i];
         }
-    }
-
-    printf("sparsemv test %s\n", spmv_result ? "PASSED" : "FAILED");
-    printf("Average execution time: %f ms\n", 
-           timer.getTime() / testOptions.numIterations);
 
-    // count FLOPS: y <- y + Mx
-    // one flop for each entry in matrix for multiply
-    // summing up all rows is (entry - rows)
-    // adding y to resulting vector is another rows
-    // total: 2 * entries
-    printf("FLOPS: %f FLOPS\n", 
-           float(2 * entries) * 1000.0f / 
-           (timer.getTime() / testOptions.numIterations));
-    fflush(stdout);
+        float * d_ones;
+        float * d_yt;
+        CUDA_SAFE_CALL(cudaMalloc((void**) &d_ones, rows * sizeof(float))); 
+        CUDA_SAFE_CALL(cudaMalloc((void**) &d_yt, cols * sizeof(float))); 
+        CUDA_SAFE_CALL(cudaMemcpy(d_ones, ones, rows * sizeof(float),
+                                  cudaMemcpyHostToDevice));
+        CUDA_SAFE_CALL(cudaMemcpy(d_yt, yt, cols * sizeof(float),
+                                  cudaMemcpyHostToDevice));
 
-    result = cudppDestroySparseMatrix(sparseMatrixHandle);
+        float one = 1.0f;
+        result = cudppSparseMatrixTransposeMultiply(sparseMatrixHandle, d_yt, d_ones, 1,
+                                                    0, 0, &one, &one);
+        CUDA_SAFE_CALL(cudaMemcpy(yt, d_yt, cols * sizeof(float),
+                                  cudaMemcpyDeviceToHost));
+
+        bool transpose_result = (result == CUDPP_SUCCESS) && 
+                                compareArrays(referencet, yt, cols, 0.002f);
+        retval += transpose_result ? 0 : 1;
+
+        printf("sparse matrix transpose multiply test (%s) %s\n", formatName,
+               transpose_result ? "PASSED" : "FAILED");
+
+        free(ones);
+        free(yt);
+        free(referencet);
+        CUDA_SAFE_CALL(cudaFree(d_ones));
+        CUDA_SAFE_CALL(cudaFree(d_yt));
+        free(A2);
+        free(reference2);
+
+        // count FLOPS: y <- y + Mx
+        // one flop for each entry in matrix for multiply
+        // summing up all rows is (entry - rows)
+        // adding y to resulting vector is another rows
+        // total: 2 * entries
+        printf("FLOPS: %f FLOPS\n", 
+               float(2 * entries) * 1000.0f / 
+               (timer.getTime() / testOptions.numIterations));
+        fflush(stdout);
+
+        free(h_y);
+
+        result = cudppDestroySparseMatrix(sparseMatrixHandle);
+
+        if (result != CUDPP_SUCCESS)
+        {
+            printf("Error destroying Sparse Matrix\n");
+        }
+    }
 
-    if (result != CUDPP_SUCCESS)
+    for (int host = 0; host < 2; host++)
     {
-        printf("Error destroying Sparse Matrix\n");
+        retval += testSparseMatrixDenseMultiply<float>(m, m.getRowPtrs(), indx, theCudpp, 
+                                                       CUDPP_FLOAT, 0.001f, host != 0);
+        retval += testSparseMatrixDenseMultiply<double>(m, m.getRowPtrs(), indx, theCudpp, 
+                                                        CUDPP_DOUBLE, 1e-8f, host != 0);
     }
+    retval += testSparseMatrixMultiply<double>(m, m.getRowPtrs(), indx, theCudpp, 
+                                               CUDPP_DOUBLE, 1e-6f);
+
+    retval += testSparseMatrixVectorRowLengths(theCudpp, false);
+    retval += testSparseMatrixVectorRowLengths(theCudpp, true);
 
     result = cudppDestroy(theCudpp);
 
@@ -0,0 +1,324 @@
+// -------------------------------------------------------------
+// CUDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision: $
+// $Date: $
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt in
+// the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+ * @file
+ * test_tree.cpp
+ *
+ * @brief Host testrig routines to exercise cudpp's Euler tour tree 
+ * primitives.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cuda_runtime_api.h>
+
+#include "cudpp.h"
+
+#include "cudpp_testrig_options.h"
+#include "cudpp_testrig_utils.h"
+#include "cuda_util.h"
+#include "stopwatch.h"
+#include "comparearrays.h"
+#include "backendarrays.h"
+#include "commandline.h"
+#include "tree_gold.h"
+
+using namespace cudpp_app;
+
+/**
+ * treeTest exercises the tree primitives on one backend.
+ *
+ * For each size the test builds a random forest of bushy and path-like
+ * trees with shuffled node ids, builds it with cudppTreeFromParents, and
+ * checks the pre-order, post-order, depth and subtree size of every node
+ * and the LCA of random pairs against the CPU reference.  It then joins
+ * the forest into one tree, passes its edges in random order and 
+ * orientation to cudppTreeFromEdges, and checks the parents and the
+ * numbering it produces.
+ *
+ * Possible command line arguments:
+ * - --n=#: number of nodes
+ * @param argc Number of arguments on the command line, passed
+ * directly from main
+ * @param argv Array of arguments on the command line, passed directly
+ * from main
+ * @param config Plan configuration, with or without CUDPP_OPTION_HOST
+ * @param testOptions Global test options
+ * @return Number of tests that failed regression (0 for all pass)
+ * @see cudppTreeFromParents, cudppTreeFromEdges, cudppTreeOrder, cudppTreeLCA
+ */
+int treeTest(int argc, const char **argv, const CUDPPConfiguration &config,
+             const testrigOptions &testOptions)
+{
+    int retval = 0;
+
+    cudpp_app::StopWatch timer;
+
+    bool host = (config.options & CUDPP_OPTION_HOST) != 0;
+
+    bool quiet = checkCommandLineFlag(argc, (const char**)argv, "quiet");   
+
+    unsigned int test[] = {1, 2, 39, 1000, 1025, 65536, 500001, 1048576};
+    int numTests = sizeof(test) / sizeof(test[0]);
+    int numNodes = test[numTests-1]; // maximum test size
+
+    bool oneTest = false;
+    if (commandLineArg(numNodes, argc, (const char**) argv, "n"))
+    {
+        oneTest = true;
+        numTests = 1;
+        test[0] = numNodes;
+    }
+
+    CUDPPResult result = CUDPP_SUCCESS;
+    CUDPPHandle theCudpp;
+    result = cudppCreate(&theCudpp);
+    if (result != CUDPP_SUCCESS)
+    {
+        if (!quiet)
+            fprintf(stderr, "Error initializing CUDPP Library.\n");
+        retval = (oneTest) ? 1 : numTests;
+        return retval;
+    }
+
+    CUDPPHandle plan;
+    result = cudppPlan(theCudpp, &plan, config, numNodes, 1, 0);
+
+    if (result != CUDPP_SUCCESS)
+    {
+        if (!quiet)
+            fprintf(stderr, "Error creating plan for Tree\n");
+        retval = (oneTest) ? 1 : numTests;
+        return retval;
+    }
+
+    size_t memSize = sizeof(int) * numNodes;
+
+    int *h_order    = (int*) malloc(memSize);
+    int *h_parent   = (int*) malloc(memSize);
+    int *h_tree     = (int*) malloc(memSize);
+    int *h_edgeU    = (int*) malloc(memSize);
+    int *h_edgeV    = (int*) malloc(memSize);
+    int *h_u        = (int*) malloc(memSize);
+    int *h_v        = (int*) malloc(memSize);
+    int *refPre     = (int*) malloc(memSize);
+    int *refPost    = (int*) malloc(memSize);
+    int *refDepth   = (int*) malloc(memSize);
+    int *refSize    = (int*) malloc(memSize);
+    int *refLCA     = (int*) malloc(memSize);
+    int *o_data     = (int*) malloc(memSize);
+
+    int *d_parent   = backendAlloc<int>(host, numNodes);
+    int *d_edgeU    = backendAlloc<int>(host, numNodes);
+    int *d_edgeV    = backendAlloc<int>(host, numNodes);
+    int *d_u        = backendAlloc<int>(host, numNodes);
+    int *d_v        = backendAlloc<int>(host, numNodes);
+    int *d_pre      = backendAlloc<int>(host, numNodes);
+    int *d_post     = backendAlloc<int>(host, numNodes);
+    int *d_depth    = backendAlloc<int>(host, numNodes);
+    int *d_size     = backendAlloc<int>(host, numNodes);
+    int *d_lca      = backendAlloc<int>(host, numNodes);
+
+    for (int k = 0; k < numTests; ++k)
+    {
+        int n = test[k];
+        if (!quiet)
+        {
+            printf("Running a %stree test of %d nodes\n",
+                host ? "host " : "", n);
+            fflush(stdout);
+        }
+
+        // a random forest over shuffled ids: each node in the shuffled 
+        // order is a root, the child of the node before it, or the child
+        // of any node before it
+        for (int i = 0; i < n; i++)
+            h_order[i] = i;
+        for (int i = 0; i < n; i++)
+        {
+            int other = i + (rand() % (n - i));
+            int tmp = h_order[i];
+            h_order[i] = h_order[other];
+            h_order[other] = tmp;
+        }
+        for (int i = 0; i < n; i++)
+        {
+            int r = rand() % 1000;
+            int p = (i == 0 || r == 0) ? -1 :
+                    (r < 250) ? h_order[i-1] : h_order[rand() % i];
+            h_parent[h_order[i]] = p;
+        }
+        for (int q = 0; q < n; q++)
+        {
+            h_u[q] = rand() % n;
+            h_v[q] = (q % 8 == 0) ? h_u[q] : rand() % n;
+        }
+
+        treeOrderGold(refPre, refPost, refDepth, refSize, h_parent, n);
+        treeLCAGold(refLCA, h_u, h_v, h_parent, refDepth, n);
+
+        backendCopy(host, d_parent, h_parent, n, true);
+        backendCopy(host, d_u, h_u, n, true);
+        backendCopy(host, d_v, h_v, n, true);
+
+        // run once to avoid timing startup overhead.
+        result = cudppTreeFromParents(plan, d_parent, n);
+
+        timer.reset();
+        timer.start();
+        for (int i = 0; i < testOptions.numIterations; i++)
+        {
+            cudppTreeFromParents(plan, d_parent, n);
+        }
+        cudaThreadSynchronize();
+        timer.stop();
+
+        bool passed = (result == CUDPP_SUCCESS);
+
+        cudppTreeOrder(plan, d_pre, d_post, d_depth, d_size);
+        cudppTreeLCA(plan, d_lca, d_u, d_v, n);
+
+        backendCopy(host, o_data, d_pre, n, false);
+        passed = compareArrays<int>(refPre, o_data, n) && passed;
+        backendCopy(host, o_data, d_post, n, false);
+        passed = compareArrays<int>(refPost, o_data, n) && passed;
+        backendCopy(host, o_data, d_depth, n, false);
+        passed = compareArrays<int>(refDepth, o_data, n) && passed;
+        backendCopy(host, o_data, d_size, n, false);
+        passed = compareArrays<int>(refSize, o_data, n) && passed;
+        backendCopy(host, o_data, d_lca, n, false);
+        passed = compareArrays<int>(refLCA, o_data, n) && passed;
+
+        // join the forest into one tree under its first root and pass
+        // the edges shuffled, each in a random orientation
+        int root = h_order[0];
+        int numEdges = 0;
+        for (int v = 0; v < n; v++)
+        {
+            h_tree[v] = (v == root) ? -1 : 
+                        (h_parent[v] < 0) ? root : h_parent[v];
+            if (v == root)
+                continue;
+            bool flip = (rand() & 1) != 0;
+            h_edgeU[numEdges] = flip ? h_tree[v] : v;
+            h_edgeV[numEdges] = flip ? v : h_tree[v];
+            numEdges++;
+        }
+        for (int e = 0; e < numEdges; e++)
+        {
+            int other = e + (rand() % (numEdges - e));
+            int tmp = h_edgeU[e];
+            h_edgeU[e] = h_edgeU[other];
+            h_edgeU[other] = tmp;
+            tmp = h_edgeV[e];
+            h_edgeV[e] = h_edgeV[other];
+            h_edgeV[other] = tmp;
+        }
+
+        treeOrderGold(refPre, refPost, refDepth, refSize, h_tree, n);
+
+        backendCopy(host, d_edgeU, h_edgeU, numEdges, true);
+        backendCopy(host, d_edgeV, h_edgeV, numEdges, true);
+
+        result = cudppTreeFromEdges(plan, d_parent, d_edgeU, d_edgeV, n, root);
+        passed = (result == CUDPP_SUCCESS) && passed;
+
+        cudppTreeOrder(plan, d_pre, NULL, d_depth, NULL);
+
+        backendCopy(host, o_data, d_parent, n, false);
+        passed = compareArrays<int>(h_tree, o_data, n) && passed;
+        backendCopy(host, o_data, d_pre, n, false);
+        passed = compareArrays<int>(refPre, o_data, n) && passed;
+        backendCopy(host, o_data, d_depth, n, false);
+        passed = compareArrays<int>(refDepth, o_data, n) && passed;
+
+        retval += passed ? 0 : 1;
+        if (!quiet)
+        {
+            printf("test %s\n", passed ? "PASSED" : "FAILED");
+            printf("Average execution time: %f ms\n",
+                timer.getTime() / testOptions.numIterations);
+        }
+        else
+            printf("\t%10d\t%0.4f\n", n, timer.getTime() / testOptions.numIterations);
+    }
+
+    result = cudppDestroyPlan(plan);
+    if (result != CUDPP_SUCCESS)
+    {
+        if (!quiet)
+            printf("Error destroying CUDPPPlan for Tree\n");
+    }
+
+    result = cudppDestroy(theCudpp);
+    if (result != CUDPP_SUCCESS)
+    {
+        if (!quiet)
+            printf("Error shutting down CUDPP Library.\n");
+    }
+
+    free(h_order);
+    free(h_parent);
+    free(h_tree);
+    free(h_edgeU);
+    free(h_edgeV);
+    free(h_u);
+    free(h_v);
+    free(refPre);
+    free(refPost);
+    free(refDepth);
+    free(refSize);
+    free(refLCA);
+    free(o_data);
+
+    backendFree(host, d_parent);
+    backendFree(host, d_edgeU);
+    backendFree(host, d_edgeV);
+    backendFree(host, d_u);
+    backendFree(host, d_v);
+    backendFree(host, d_pre);
+    backendFree(host, d_post);
+    backendFree(host, d_depth);
+    backendFree(host, d_size);
+    backendFree(host, d_lca);
+
+    return retval;
+}
+
+/**
+ * testTree runs the tree primitive tests on the GPU and on the host 
+ * backend.
+ * @param argc Number of arguments on the command line, passed
+ * directly from main
+ * @param argv Array of arguments on the command line, passed directly
+ * from main
+ * @return Number of tests that failed regression (0 for all pass)
+ * @see treeTest
+ */
+int testTree(int argc, const char **argv)
+{
+    testrigOptions testOptions;
+    setOptions(argc, argv, testOptions);
+
+    CUDPPConfiguration config;
+    config.algorithm = CUDPP_TREE;
+    config.op = CUDPP_ADD;
+    config.datatype = CUDPP_INT;
+    config.options = 0;
+
+    int retval = treeTest(argc, argv, config, testOptions);
+
+    config.options = CUDPP_OPTION_HOST;
+    retval += treeTest(argc, argv, config, testOptions);
+
+    return retval;
+}
@@ -31,6 +31,7 @@
 #include "cudpp_testrig_utils.h"
 #include "tridiagonal_gold.h"
 #include "stopwatch.h"
+#include "backendarrays.h"
 
 using namespace cudpp_app;
 
@@ -68,7 +69,7 @@ int testTridiagonalDataType(int argc, const char** argv, CUDPPConfiguration &con
         oneTest = true;
     }
 
-    int systemSizes[] = { 5, 32, 39, 128, 177, 255, 256, 500, 512 };
+    int systemSizes[] = { 5, 32, 39, 128, 177, 255, 256, 500, 512, 1024, 2000, 4099 };
 
     int numTests = sizeof(systemSizes) / sizeof(int);
 
@@ -139,7 +140,7 @@ int testTridiagonalDataType(int argc, const char** argv, CUDPPConfiguration &con
        }
         
         if (!quiet)
-            printf("Running a %s CR-PCR tridiagonal solver solving %d "
+            printf("Running a %s tridiagonal solver solving %d "
                    "systems of %d equations\n", 
                    config.datatype == CUDPP_FLOAT ? "fp32" : "fp64",
                    numSystems, systemSize);
@@ -214,6 +215,891 @@ int testTridiagonalDataType(int argc, const char** argv, CUDPPConfiguration &con
     
 }
 
+/**
+ * Tests the solver on batches of \a numSystems[k] systems of 
+ * \a systemSizes[k] equations.  If \a interleaved, the systems are stored 
+ * interleaved (CUDPP_OPTION_INTERLEAVED): element i of system s is at 
+ * i * numSystems + s.
+ */
+template <typename T>
+int testTridiagonalBatches(int argc, const char** argv, CUDPPConfiguration config,
+                           bool interleaved, const int *systemSizes, 
+                           const int *numSystemsList, int numTests)
+{
+    bool quiet = checkCommandLineFlag(argc, argv, "quiet");
+
+    int retval = 0;
+    if (interleaved)
+        config.options |= CUDPP_OPTION_INTERLEAVED;
+    bool host = (config.options & CUDPP_OPTION_HOST) != 0;
+
+    CUDPPHandle theCudpp;
+    CUDPPResult result = cudppCreate(&theCudpp);
+    if(result != CUDPP_SUCCESS)
+    {
+        printf("Error initializing CUDPP Library.\n");
+        return 1;
+    }
+
+    size_t maxElements = 0;
+    for (int k = 0; k < numTests; k++)
+    {
+        size_t numElements = (size_t)numSystemsList[k] * systemSizes[k];
+        if (numElements > maxElements)
+            maxElements = numElements;
+    }
+
+    CUDPPHandle tridiagonalPlan = 0;
+    result = cudppPlan(theCudpp, &tridiagonalPlan, config, maxElements, 1, 0);
+    if (CUDPP_SUCCESS != result)
+    {
+        printf("Error creating CUDPPPlan\n");
+        exit(-1);
+    }
+
+    for (int k = 0; k < numTests; k++)
+    {
+        int systemSize = systemSizes[k];
+        int numSystems = numSystemsList[k];
+        const size_t numElements = (size_t)numSystems * systemSize;
+        const size_t memSize = sizeof(T) * numElements;
+
+        T* a = (T*) malloc(memSize);
+        T* b = (T*) malloc(memSize);
+        T* c = (T*) malloc(memSize);
+        T* d = (T*) malloc(memSize);
+        T* x1 = (T*) malloc(memSize);
+        T* x2 = (T*) malloc(memSize);
+        T* tmp = (T*) malloc(memSize);
+
+        for (int i = 0; i < numSystems; i++)
+        {
+            testGeneration(&a[i*systemSize], &b[i*systemSize], &c[i*systemSize], 
+                           &d[i*systemSize], &x1[i*systemSize], systemSize);
+        }
+
+        T* d_a = backendAlloc<T>(host, numElements);
+        T* d_b = backendAlloc<T>(host, numElements);
+        T* d_c = backendAlloc<T>(host, numElements);
+        T* d_d = backendAlloc<T>(host, numElements);
+        T* d_x = backendAlloc<T>(host, numElements);
+
+        // copy the systems to the device, interleaving them if requested
+        T* h_arrays[] = { a, b, c, d };
+        T* d_arrays[] = { d_a, d_b, d_c, d_d };
+        for (int arr = 0; arr < 4; arr++)
+        {
+            if (interleaved)
+            {
+                for (int s = 0; s < numSystems; s++)
+                    for (int i = 0; i < systemSize; i++)
+                        tmp[(size_t)i * numSystems + s] = h_arrays[arr][(size_t)s * systemSize + i];
+            }
+            else
+                memcpy(tmp, h_arrays[arr], memSize);
+            backendCopy(host, d_arrays[arr], tmp, numElements, true);
+        }
+
+        if (!quiet)
+            printf("Running a %s %s%stridiagonal solver solving %d "
+                   "systems of %d equations\n", 
+                   config.datatype == CUDPP_FLOAT ? "fp32" : "fp64",
+                   host ? "host " : "", interleaved ? "interleaved " : "",
+                   numSystems, systemSize);
+
+        cudpp_app::StopWatch timer;
+        timer.reset();
+        timer.start();
+
+        CUDPPResult err = cudppTridiagonal(tridiagonalPlan, d_a, d_b, d_c, d_d, d_x, 
+                                           systemSize, numSystems);
+        cudaThreadSynchronize();
+        timer.stop();
+
+        if (err != CUDPP_SUCCESS)
+        {
+            printf("Error running cudppTridiagonal\n");
+            retval++;
+        }
+        else
+        {
+            if (!quiet)
+                printf("%s execution time: %f ms\n", host ? "CPU" : "GPU", timer.getTime());
+            else
+                printf("%f\n", timer.getTime());
+
+            backendCopy(host, tmp, d_x, numElements, false);
+            if (interleaved)
+            {
+                for (int s = 0; s < numSystems; s++)
+                    for (int i = 0; i < systemSize; i++)
+                        x2[(size_t)s * systemSize + i] = tmp[(size_t)i * numSystems + s];
+            }
+            else
+                memcpy(x2, tmp, memSize);
+
+            serialManySystems<T>(a, b, c, d, x1, systemSize, numSystems);
+
+            int failed = compareManySystems<T>(x1, x2, systemSize, numSystems, 0.001f);
+            retval += failed;
+
+            if (!quiet)
+                printf("test %s\n\n", failed ? "FAILED" : "PASSED");
+        }
+
+        backendFree(host, d_a);
+        backendFree(host, d_b);
+        backendFree(host, d_c);
+        backendFree(host, d_d);
+        backendFree(host, d_x);
+        free(a);
+        free(b);
+        free(c);
+        free(d);
+        free(x1);
+        free(x2);
+        free(tmp);
+    }
+
+    result = cudppDestroyPlan(tridiagonalPlan);
+    if (CUDPP_SUCCESS != result)
+    {
+        printf("Error destroying CUDPPPlan\n");
+        exit(-1);
+    }
+
+    result = cudppDestroy(theCudpp);
+    if (CUDPP_SUCCESS != result)
+    {
+        printf("Error shutting down CUDPP Library.\n");
+        exit(-1);
+    }
+
+    return retval;
+}
+
+/**
+ * Tests batches that CR-PCR cannot solve: many small interleaved systems
+ * (including more than 65535 of them), which use the Thomas solver, and 
+ * a few large systems in both layouts, which use the partitioned solver.
+ */
+template <typename T>
+int testTridiagonalLarge(int argc, const char** argv, CUDPPConfiguration &config)
+{
+    int retval = 0;
+
+    const int smallSizes[] = { 1, 2, 7, 32, 100 };
+    const int smallCounts[] = { 100000, 100000, 100000, 100000, 100000 };
+    retval += testTridiagonalBatches<T>(argc, argv, config, true, 
+                                        smallSizes, smallCounts, 5);
+
+    const int largeSizes[] = { 1000, 100000, 1048577, 250007, 4194304 };
+    const int largeCounts[] = { 1, 1, 1, 4, 1 };
+    retval += testTridiagonalBatches<T>(argc, argv, config, false, 
+                                        largeSizes, largeCounts, 5);
+    retval += testTridiagonalBatches<T>(argc, argv, config, true, 
+                                        largeSizes, largeCounts, 4);
+
+    return retval;
+}
+
+/**
+ * Tests the host solvers (CUDPP_OPTION_HOST) on batches of many small 
+ * systems and of a few large ones, in both layouts.
+ */
+template <typename T>
+int testTridiagonalHost(int argc, const char** argv, CUDPPConfiguration config)
+{
+    int retval = 0;
+    config.options |= CUDPP_OPTION_HOST;
+
+    const int sizes[] = { 1, 7, 100, 1000, 100000, 1048577 };
+    const int counts[] = { 100000, 1000, 300, 257, 4, 1 };
+    retval += testTridiagonalBatches<T>(argc, argv, config, false, sizes, counts, 6);
+    retval += testTridiagonalBatches<T>(argc, argv, config, true, sizes, counts, 6);
+
+    return retval;
+}
+
+/**
+ * Copies \a numSystems systems of \a systemSize items of \a width values 
+ * each from \a src (stored contiguously) to \a dst, interleaving them if 
+ * \a interleaved.  If \a inverse, converts from \a dst layout back into \a src.
+ */
+template <typename T>
+void convertLayout(T *dst, T *src, int systemSize, int numSystems, int width, 
+                   bool interleaved, bool inverse)
+{
+    for (int s = 0; s < numSystems; s++)
+    {
+        for (int i = 0; i < systemSize; i++)
+        {
+            size_t from = ((size_t)s * systemSize + i) * width;
+            size_t to = (interleaved ? (size_t)i * numSystems + s 
+                                     : (size_t)s * systemSize + i) * width;
+            for (int w = 0; w < width; w++)
+            {
+                if (inverse)
+                    src[from + w] = dst[to + w];
+                else
+                    dst[to + w] = src[from + w];
+            }
+        }
+    }
+}
+
+enum BandedSystemType
+{
+    BANDED_CYCLIC,
+    BANDED_PENTADIAGONAL,
+    BANDED_BLOCK2,
+    BANDED_BLOCK3
+};
+
+/**
+ * Tests the cyclic (CUDPP_OPTION_CYCLIC), pentadiagonal and 
+ * block-tridiagonal solvers on batches of \a numSystemsList[k] systems of 
+ * \a systemSizes[k] rows in the given layout, against the serial solvers.
+ */
+template <typename T>
+int testBandedSystems(int argc, const char** argv, CUDPPConfiguration config,
+                      BandedSystemType type, bool interleaved, 
+                      const int *systemSizes, const int *numSystemsList, int numTests)
+{
+    bool quiet = checkCommandLineFlag(argc, argv, "quiet");
+    const char *names[] = { "cyclic tridiagonal", "pentadiagonal", 
+                            "2x2 block-tridiagonal", "3x3 block-tridiagonal" };
+
+    int retval = 0;
+    if (interleaved)
+        config.options |= CUDPP_OPTION_INTERLEAVED;
+    if (type == BANDED_CYCLIC)
+        config.options |= CUDPP_OPTION_CYCLIC;
+
+    // number of values per matrix entry (M*M) and per right-hand side entry (M)
+    int blockSize = (type == BANDED_BLOCK2) ? 2 : (type == BANDED_BLOCK3) ? 3 : 1;
+    int matWidth = blockSize * blockSize;
+    int numDiagonals = (type == BANDED_PENTADIAGONAL) ? 5 : 3;
+
+    CUDPPHandle theCudpp;
+    CUDPPResult result = cudppCreate(&theCudpp);
+    if(result != CUDPP_SUCCESS)
+    {
+        printf("Error initializing CUDPP Library.\n");
+        return 1;
+    }
+
+    size_t maxElements = 0;
+    for (int k = 0; k < numTests; k++)
+    {
+        size_t numElements = (size_t)numSystemsList[k] * systemSizes[k];
+        if (numElements > maxElements)
+            maxElements = numElements;
+    }
+
+    CUDPPHandle plan = 0;
+    result = cudppPlan(theCudpp, &plan, config, maxElements, 1, 0);
+    if (CUDPP_SUCCESS != result)
+    {
+        printf("Error creating CUDPPPlan\n");
+        exit(-1);
+    }
+
+    for (int k = 0; k < numTests; k++)
+    {
+        int systemSize = systemSizes[k];
+        int numSystems = numSystemsList[k];
+        const size_t numElements = (size_t)numSystems * systemSize;
+        const size_t matSize = sizeof(T) * numElements * matWidth;
+        const size_t vecSize = sizeof(T) * numElements * blockSize;
+
+        // diagonals in the order (e,) a, b, c, (f)
+        T* diag[5];
+        T* d_diag[5];
+        for (int j = 0; j < numDiagonals; j++)
+        {
+            diag[j] = (T*) malloc(matSize);
+            CUDA_SAFE_CALL( cudaMalloc( (void**) &d_diag[j], matSize));
+        }
+        T* d = (T*) malloc(vecSize);
+        T* x1 = (T*) malloc(vecSize);
+        T* x2 = (T*) malloc(vecSize);
+        T* tmp = (T*) malloc(matSize);
+        T* d_d;
+        T* d_x;
+        CUDA_SAFE_CALL( cudaMalloc( (void**) &d_d, vecSize));
+        CUDA_SAFE_CALL( cudaMalloc( (void**) &d_x, vecSize));
+
+        for (int i = 0; i < numSystems; i++)
+        {
+            size_t m = (size_t)i * systemSize * matWidth;
+            size_t v = (size_t)i * systemSize * blockSize;
+            if (type == BANDED_PENTADIAGONAL)
+            {
+                testGeneration(&diag[1][m], &diag[2][m], &diag[3][m], &d[v], &x1[v], systemSize);
+                for (int j = 0; j < systemSize; j++)
+                {
+                    diag[0][m + j] = rand01<T>();
+                    diag[4][m + j] = rand01<T>();
+                    diag[2][m + j] += 2;
+                }
+            }
+            else if (type == BANDED_CYCLIC)
+            {
+                testGeneration(&diag[0][m], &diag[1][m], &diag[2][m], &d[v], &x1[v], systemSize);
+                // the periodic corner entries
+                diag[0][m] = 3 + rand01<T>();
+                diag[2][m + systemSize - 1] = 2 + rand01<T>();
+            }
+            else
+                testGenerationBlock(&diag[0][m], &diag[1][m], &diag[2][m], &d[v], 
+                                    blockSize, systemSize);
+        }
+
+        for (int j = 0; j < numDiagonals; j++)
+        {
+            convertLayout(tmp, diag[j], systemSize, numSystems, matWidth, interleaved, false);
+            CUDA_SAFE_CALL( cudaMemcpy( d_diag[j], tmp, matSize, cudaMemcpyHostToDevice));
+        }
+        convertLayout(tmp, d, systemSize, numSystems, blockSize, interleaved, false);
+        CUDA_SAFE_CALL( cudaMemcpy( d_d, tmp, vecSize, cudaMemcpyHostToDevice));
+
+        if (!quiet)
+            printf("Running a %s %s%s solver solving %d systems of %d rows\n", 
+                   config.datatype == CUDPP_FLOAT ? "fp32" : "fp64",
+                   interleaved ? "interleaved " : "", names[type],
+                   numSystems, systemSize);
+
+        cudpp_app::StopWatch timer;
+        timer.reset();
+        timer.start();
+
+        CUDPPResult err;
+        if (type == BANDED_CYCLIC)
+            err = cudppTridiagonal(plan, d_diag[0], d_diag[1], d_diag[2], d_d, d_x, 
+                                   systemSize, numSystems);
+        else if (type == BANDED_PENTADIAGONAL)
+            err = cudppPentadiagonal(plan, d_diag[0], d_diag[1], d_diag[2], d_diag[3], 
+                                     d_diag[4], d_d, d_x, systemSize, numSystems);
+        else
+            err = cudppBlockTridiagonal(plan, d_diag[0], d_diag[1], d_diag[2], d_d, d_x, 
+                                        blockSize, systemSize, numSystems);
+        cudaThreadSynchronize();
+        timer.stop();
+
+        if (err != CUDPP_SUCCESS)
+        {
+            printf("Error running %s solver\n", names[type]);
+            retval++;
+        }
+        else
+        {
+            if (!quiet)
+                printf("GPU execution time: %f ms\n", timer.getTime());
+            else
+                printf("%f\n", timer.getTime());
+
+            CUDA_SAFE_CALL( cudaMemcpy(tmp, d_x, vecSize, cudaMemcpyDeviceToHost));
+            convertLayout(tmp, x2, systemSize, numSystems, blockSize, interleaved, true);
+
+            for (int i = 0; i < numSystems; i++)
+            {
+                size_t m = (size_t)i * systemSize * matWidth;
+                size_t v = (size_t)i * systemSize * blockSize;
+                if (type == BANDED_CYCLIC)
+                    serialCyclic(&diag[0][m], &diag[1][m], &diag[2][m], &d[v], 
+                                 &x1[v], systemSize);
+                else if (type == BANDED_PENTADIAGONAL)
+                    serialPentadiagonal(&diag[0][m], &diag[1][m], &diag[2][m], 
+                                        &diag[3][m], &diag[4][m], &d[v], &x1[v], systemSize);
+                else
+                    serialBlockTridiagonal(&diag[0][m], &diag[1][m], &diag[2][m], &d[v], 
+                                           &x1[v], blockSize, systemSize);
+            }
+
+            int failed = compareManySystems<T>(x1, x2, systemSize * blockSize, 
+                                               numSystems, 0.001f);
+            retval += failed;
+
+            if (!quiet)
+                printf("test %s\n\n", failed ? "FAILED" : "PASSED");
+        }
+
+        for (int j = 0; j < numDiagonals; j++)
+        {
+            CUDA_SAFE_CALL(cudaFree(d_diag[j]));
+            free(diag[j]);
+        }
+        CUDA_SAFE_CALL(cudaFree(d_d));
+        CUDA_SAFE_CALL(cudaFree(d_x));
+        free(d);
+        free(x1);
+        free(x2);
+        free(tmp);
+    }
+
+    result = cudppDestroyPlan(plan);
+    if (CUDPP_SUCCESS != result)
+    {
+        printf("Error destroying CUDPPPlan\n");
+        exit(-1);
+    }
+
+    result = cudppDestroy(theCudpp);
+    if (CUDPP_SUCCESS != result)
+    {
+        printf("Error shutting down CUDPP Library.\n");
+        exit(-1);
+    }
+
+    return retval;
+}
+
+/**
+ * Tests the cyclic, pentadiagonal and block-tridiagonal solvers in both
+ * layouts.  The cyclic sizes cover every underlying tridiagonal solver.
+ */
+template <typename T>
+int testBandedSolvers(int argc, const char** argv, CUDPPConfiguration &config)
+{
+    int retval = 0;
+
+    const int cyclicSizes[] = { 3, 5, 64, 500, 4099, 100000 };
+    const int cyclicCounts[] = { 512, 512, 512, 512, 64, 1 };
+    const int pentaSizes[] = { 1, 2, 3, 7, 100, 1000 };
+    const int pentaCounts[] = { 1000, 1000, 1000, 1000, 256, 256 };
+    const int blockSizes[] = { 1, 2, 10, 50 };
+    const int blockCounts[] = { 256, 256, 256, 64 };
+
+    for (int interleaved = 0; interleaved < 2; interleaved++)
+    {
+        retval += testBandedSystems<T>(argc, argv, config, BANDED_CYCLIC, interleaved != 0,
+                                       cyclicSizes, cyclicCounts, 6);
+        retval += testBandedSystems<T>(argc, argv, config, BANDED_PENTADIAGONAL, interleaved != 0,
+                                       pentaSizes, pentaCounts, 6);
+        retval += testBandedSystems<T>(argc, argv, config, BANDED_BLOCK2, interleaved != 0,
+                                       blockSizes, blockCounts, 4);
+        retval += testBandedSystems<T>(argc, argv, config, BANDED_BLOCK3, interleaved != 0,
+                                       blockSizes, blockCounts, 4);
+    }
+
+    return retval;
+}
+
+/**
+ * Tests cudppTridiagonalStrided() on the systems along each axis of 
+ * \a nx x \a ny grids stored row by row with row pitch \a pitch, as in an
+ * ADI sweep, and checks that the padding of the solution is untouched.
+ */
+template <typename T>
+int testTridiagonalStrided(int argc, const char** argv, CUDPPConfiguration config,
+                           bool isCyclic)
+{
+    bool quiet = checkCommandLineFlag(argc, argv, "quiet");
+
+    int retval = 0;
+    if (isCyclic)
+        config.options |= CUDPP_OPTION_CYCLIC;
+
+    CUDPPHandle theCudpp;
+    CUDPPResult result = cudppCreate(&theCudpp);
+    if(result != CUDPP_SUCCESS)
+    {
+        printf("Error initializing CUDPP Library.\n");
+        return 1;
+    }
+
+    const int nxList[] = { 300, 64, 1000 };
+    const int nyList[] = { 200, 100000, 5 };
+    const int pitchList[] = { 320, 64, 1003 };
+    const int numTests = sizeof(nxList) / sizeof(int);
+
+    CUDPPHandle plan = 0;
+    result = cudppPlan(theCudpp, &plan, config, 0, 1, 0);
+    if (CUDPP_SUCCESS != result)
+    {
+        printf("Error creating CUDPPPlan\n");
+        exit(-1);
+    }
+
+    for (int k = 0; k < numTests; k++)
+    {
+        int nx = nxList[k];
+        int ny = nyList[k];
+        int pitch = pitchList[k];
+        const size_t gridSize = (size_t)pitch * ny;
+        const size_t memSize = sizeof(T) * gridSize;
+        const T padding = -12345;
+
+        // every grid point holds one equation of the systems along x and 
+        // one of the systems along y
+        T* grid[4];
+        T* d_grid[4];
+        for (int j = 0; j < 4; j++)
+        {
+            grid[j] = (T*) malloc(memSize);
+            CUDA_SAFE_CALL( cudaMalloc( (void**) &d_grid[j], memSize));
+        }
+        T* x = (T*) malloc(memSize);
+        T* d_x;
+        CUDA_SAFE_CALL( cudaMalloc( (void**) &d_x, memSize));
+
+        for (size_t i = 0; i < gridSize; i++)
+        {
+            grid[0][i] = 3 + rand01<T>();
+            grid[1][i] = 8 + rand01<T>();
+            grid[2][i] = 2 + rand01<T>();
+            grid[3][i] = 5 + rand01<T>();
+        }
+        for (int j = 0; j < 4; j++)
+            CUDA_SAFE_CALL( cudaMemcpy( d_grid[j], grid[j], memSize, cudaMemcpyHostToDevice));
+
+        for (int axis = 0; axis < 2; axis++)
+        {
+            int systemSize = axis ? ny : nx;
+            int numSystems = axis ? nx : ny;
+            size_t elementStride = axis ? pitch : 1;
+            size_t systemStride = axis ? 1 : pitch;
+
+            if (isCyclic && systemSize < 3)
+                continue;
+
+            for (size_t i = 0; i < gridSize; i++)
+                x[i] = padding;
+            CUDA_SAFE_CALL( cudaMemcpy( d_x, x, memSize, cudaMemcpyHostToDevice));
+
+            if (!quiet)
+                printf("Running a %s %stridiagonal solver along %c of a %d x %d grid "
+                       "(pitch %d)\n", 
+                       config.datatype == CUDPP_FLOAT ? "fp32" : "fp64",
+                       isCyclic ? "cyclic " : "", axis ? 'y' : 'x', nx, ny, pitch);
+
+            cudpp_app::StopWatch timer;
+            timer.reset();
+            timer.start();
+
+            CUDPPResult err = cudppTridiagonalStrided(plan, d_grid[0], d_grid[1], 
+                                                      d_grid[2], d_grid[3], d_x, 
+                                                      systemSize, numSystems, 
+                                                      elementStride, systemStride);
+            cudaThreadSynchronize();
+            timer.stop();
+
+            if (err != CUDPP_SUCCESS)
+            {
+                printf("Error running cudppTridiagonalStrided\n");
+                retval++;
+                continue;
+            }
+
+            if (!quiet)
+                printf("GPU execution time: %f ms\n", timer.getTime());
+            else
+                printf("%f\n", timer.getTime());
+
+            CUDA_SAFE_CALL( cudaMemcpy(x, d_x, memSize, cudaMemcpyDeviceToHost));
+
+            // gather each system, solve it on the host and compare
+            const size_t numElements = (size_t)systemSize * numSystems;
+            T* sys[4];
+            for (int j = 0; j < 4; j++)
+                sys[j] = (T*) malloc(sizeof(T) * numElements);
+            T* x1 = (T*) malloc(sizeof(T) * numElements);
+            T* x2 = (T*) malloc(sizeof(T) * numElements);
+
+            for (int s = 0; s < numSystems; s++)
+            {
+                for (int i = 0; i < systemSize; i++)
+                {
+                    size_t idx = i * elementStride + s * systemStride;
+                    size_t to = (size_t)s * systemSize + i;
+                    for (int j = 0; j < 4; j++)
+                        sys[j][to] = grid[j][idx];
+                    x2[to] = x[idx];
+                }
+                size_t first = (size_t)s * systemSize;
+                if (isCyclic)
+                    serialCyclic(&sys[0][first], &sys[1][first], &sys[2][first], 
+                                 &sys[3][first], &x1[first], systemSize);
+                else
+                {
+                    sys[0][first] = 0;
+                    serial(&sys[0][first], &sys[1][first], &sys[2][first], 
+                           &sys[3][first], &x1[first], systemSize);
+                }
+            }
+
+            int failed = compareManySystems<T>(x1, x2, systemSize, numSystems, 0.001f);
+
+            for (int row = 0; row < ny && !failed; row++)
+            {
+                for (int col = nx; col < pitch; col++)
+                {
+                    if (x[(size_t)row * pitch + col] != padding)
+                    {
+                        printf("test failed, padding overwritten\n");
+                        failed = 1;
+                        break;
+                    }
+                }
+            }
+            retval += failed;
+
+            if (!quiet)
+                printf("test %s\n\n", failed ? "FAILED" : "PASSED");
+
+            for (int j = 0; j < 4; j++)
+                free(sys[j]);
+            free(x1);
+            free(x2);
+        }
+
+        for (int j = 0; j < 4; j++)
+        {
+            CUDA_SAFE_CALL(cudaFree(d_grid[j]));
+            free(grid[j]);
+        }
+        CUDA_SAFE_CALL(cudaFree(d_x));
+        free(x);
+    }
+
+    result = cudppDestroyPlan(plan);
+    if (CUDPP_SUCCESS != result)
+    {
+        printf("Error destroying CUDPPPlan\n");
+        exit(-1);
+    }
+
+    result = cudppDestroy(theCudpp);
+    if (CUDPP_SUCCESS != result)
+    {
+        printf("Error shutting down CUDPP Library.\n");
+        exit(-1);
+    }
+
+    return retval;
+}
+
+/**
+ * Tests cudppTridiagonalFactor() and cudppTridiagonalSolveFactored(): 
+ * each batch is factored once and solved for several sets of 
+ * \a numRHS right hand sides.
+ */
+template <typename T>
+int testTridiagonalFactored(int argc, const char** argv, CUDPPConfiguration config,
+                            bool interleaved, bool isCyclic)
+{
+    bool quiet = checkCommandLineFlag(argc, argv, "quiet");
+
+    int retval = 0;
+    if (interleaved)
+        config.options |= CUDPP_OPTION_INTERLEAVED;
+    if (isCyclic)
+        config.options |= CUDPP_OPTION_CYCLIC;
+
+    CUDPPHandle theCudpp;
+    CUDPPResult result = cudppCreate(&theCudpp);
+    if(result != CUDPP_SUCCESS)
+    {
+        printf("Error initializing CUDPP Library.\n");
+        return 1;
+    }
+
+    const int systemSizes[] = { 5, 128, 1000 };
+    const int numSystemsList[] = { 1000, 256, 64 };
+    const int numTests = sizeof(systemSizes) / sizeof(int);
+    const int numRHS = 4;
+    const int numSteps = 2;
+
+    for (int k = 0; k < numTests; k++)
+    {
+        int systemSize = systemSizes[k];
+        int numSystems = numSystemsList[k];
+        const size_t numElements = (size_t)numSystems * systemSize;
+        const size_t memSize = sizeof(T) * numElements;
+
+        T* diag[3];
+        T* d_diag[3];
+        for (int j = 0; j < 3; j++)
+        {
+            diag[j] = (T*) malloc(memSize);
+            CUDA_SAFE_CALL( cudaMalloc( (void**) &d_diag[j], memSize));
+        }
+        T* d = (T*) malloc(memSize * numRHS);
+        T* x1 = (T*) malloc(memSize);
+        T* x2 = (T*) malloc(memSize * numRHS);
+        T* tmp = (T*) malloc(memSize);
+        T* cc = (T*) malloc(memSize);
+        T* dd = (T*) malloc(memSize);
+        T* d_d;
+        T* d_x;
+        CUDA_SAFE_CALL( cudaMalloc( (void**) &d_d, memSize * numRHS));
+        CUDA_SAFE_CALL( cudaMalloc( (void**) &d_x, memSize * numRHS));
+
+        for (int s = 0; s < numSystems; s++)
+        {
+            size_t first = (size_t)s * systemSize;
+            testGeneration(&diag[0][first], &diag[1][first], &diag[2][first], 
+                           &d[first], &x1[first], systemSize);
+            if (isCyclic)
+            {
+                diag[0][first] = 3 + rand01<T>();
+                diag[2][first + systemSize - 1] = 2 + rand01<T>();
+            }
+        }
+        for (int j = 0; j < 3; j++)
+        {
+            convertLayout(tmp, diag[j], systemSize, numSystems, 1, interleaved, false);
+            CUDA_SAFE_CALL( cudaMemcpy( d_diag[j], tmp, memSize, cudaMemcpyHostToDevice));
+        }
+
+        if (!quiet)
+            printf("Running a %s %s%sfactored tridiagonal solver on %d systems of "
+                   "%d equations with %d right hand sides\n", 
+                   config.datatype == CUDPP_FLOAT ? "fp32" : "fp64",
+                   interleaved ? "interleaved " : "", isCyclic ? "cyclic " : "",
+                   numSystems, systemSize, numRHS);
+
+        cudpp_app::StopWatch timer;
+        timer.reset();
+        timer.start();
+
+        CUDPPHandle factor;
+        result = cudppTridiagonalFactor(theCudpp, &factor, config, 
+                                        d_diag[0], d_diag[1], d_diag[2],
+                                        systemSize, numSystems);
+        cudaThreadSynchronize();
+        timer.stop();
+
+        if (result != CUDPP_SUCCESS)
+        {
+            printf("Error in cudppTridiagonalFactor\n");
+            retval++;
+        }
+        else
+        {
+            if (!quiet)
+                printf("GPU factorization time: %f ms\n", timer.getTime());
+
+            // plans and factor objects must not be taken for each other
+            CUDPPHandle plan;
+            if (k == 0 &&
+                cudppPlan(theCudpp, &plan, config, numElements, 1, 0) == CUDPP_SUCCESS)
+            {
+                if (cudppTridiagonalSolveFactored(plan, d_d, d_x, numRHS) !=
+                        CUDPP_ERROR_INVALID_PLAN ||
+                    cudppTridiagonal(factor, d_diag[0], d_diag[1], d_diag[2], d_d, d_x,
+                                     systemSize, numSystems) != CUDPP_ERROR_INVALID_PLAN ||
+                    cudppDestroyTridiagonalFactor(plan) != CUDPP_ERROR_INVALID_PLAN ||
+                    cudppDestroyPlan(factor) != CUDPP_ERROR_INVALID_PLAN)
+                {
+                    printf("Error: tridiagonal plan and factor handles are interchangeable\n");
+                    retval++;
+                }
+                cudppDestroyPlan(plan);
+            }
+            if (k == 0 &&
+                (cudppTridiagonalSolveFactored(0, d_d, d_x, numRHS) != 
+                     CUDPP_ERROR_INVALID_HANDLE ||
+                 cudppDestroyTridiagonalFactor(0) != CUDPP_ERROR_INVALID_HANDLE))
+            {
+                printf("Error: null factor handle not rejected\n");
+                retval++;
+            }
+
+            // new right hand sides every step, as in implicit time stepping
+            for (int step = 0; step < numSteps; step++)
+            {
+                for (size_t i = 0; i < numElements * numRHS; i++)
+                    d[i] = 5 + rand01<T>();
+                for (int r = 0; r < numRHS; r++)
+                {
+                    convertLayout(tmp, &d[r * numElements], systemSize, numSystems, 1, 
+                                  interleaved, false);
+                    CUDA_SAFE_CALL( cudaMemcpy( d_d + r * numElements, tmp, memSize, 
+                                                cudaMemcpyHostToDevice));
+                }
+
+                timer.reset();
+                timer.start();
+                CUDPPResult err = cudppTridiagonalSolveFactored(factor, d_d, d_x, numRHS);
+                cudaThreadSynchronize();
+                timer.stop();
+
+                if (err != CUDPP_SUCCESS)
+                {
+                    printf("Error in cudppTridiagonalSolveFactored\n");
+                    retval++;
+                    break;
+                }
+                if (!quiet)
+                    printf("GPU solve time: %f ms\n", timer.getTime());
+                else
+                    printf("%f\n", timer.getTime());
+
+                int failed = 0;
+                for (int r = 0; r < numRHS && !failed; r++)
+                {
+                    CUDA_SAFE_CALL( cudaMemcpy(tmp, d_x + r * numElements, memSize, 
+                                               cudaMemcpyDeviceToHost));
+                    convertLayout(tmp, &x2[r * numElements], systemSize, numSystems, 1, 
+                                  interleaved, true);
+
+                    for (int s = 0; s < numSystems; s++)
+                    {
+                        size_t first = (size_t)s * systemSize;
+                        memcpy(&cc[first], &diag[2][first], sizeof(T) * systemSize);
+                        memcpy(&dd[first], &d[r * numElements + first], 
+                               sizeof(T) * systemSize);
+                        if (isCyclic)
+                            serialCyclic(&diag[0][first], &diag[1][first], &cc[first], 
+                                         &dd[first], &x1[first], systemSize);
+                        else
+                            serial(&diag[0][first], &diag[1][first], &cc[first], 
+                                   &dd[first], &x1[first], systemSize);
+                    }
+                    failed = compareManySystems<T>(x1, &x2[r * numElements], 
+                                                   systemSize, numSystems, 0.001f);
+                }
+                retval += failed;
+
+                if (!quiet)
+                    printf("test %s\n\n", failed ? "FAILED" : "PASSED");
+            }
+
+            result = cudppDestroyTridiagonalFactor(factor);
+            if (result != CUDPP_SUCCESS)
+            {
+                printf("Error in cudppDestroyTridiagonalFactor\n");
+                retval++;
+            }
+        }
+
+        for (int j = 0; j < 3; j++)
+        {
+            CUDA_SAFE_CALL(cudaFree(d_diag[j]));
+            free(diag[j]);
+        }
+        CUDA_SAFE_CALL(cudaFree(d_d));
+        CUDA_SAFE_CALL(cudaFree(d_x));
+        free(d);
+        free(x1);
+        free(x2);
+        free(tmp);
+        free(cc);
+        free(dd);
+    }
+
+    result = cudppDestroy(theCudpp);
+    if (CUDPP_SUCCESS != result)
+    {
+        printf("Error shutting down CUDPP Library.\n");
+        exit(-1);
+    }
+
+    return retval;
+}
+
 int testTridiagonal(int argc, const char** argv, const CUDPPConfiguration *configPtr)
 {
     int retval = 0;
@@ -236,9 +1122,31 @@ int testTridiagonal(int argc, const char** argv, const CUDPPConfiguration *confi
     
     
     if (config.datatype == CUDPP_FLOAT)
+    {
         retval = testTridiagonalDataType<float>(argc, argv, config);
+        retval += testTridiagonalLarge<float>(argc, argv, config);
+        retval += testTridiagonalHost<float>(argc, argv, config);
+        retval += testBandedSolvers<float>(argc, argv, config);
+        retval += testTridiagonalStrided<float>(argc, argv, config, false);
+        retval += testTridiagonalStrided<float>(argc, argv, config, true);
+        for (int layout = 0; layout < 2; layout++)
+            for (int cyclic = 0; cyclic < 2; cyclic++)
+                retval += testTridiagonalFactored<float>(argc, argv, config, 
+                                                       layout != 0, cyclic != 0);
+    }
     else if (config.datatype == CUDPP_DOUBLE)
+    {
         retval = testTridiagonalDataType<double>(argc, argv, config);  
+        retval += testTridiagonalLarge<double>(argc, argv, config);
+        retval += testTridiagonalHost<double>(argc, argv, config);
+        retval += testBandedSolvers<double>(argc, argv, config);
+        retval += testTridiagonalStrided<double>(argc, argv, config, false);
+        retval += testTridiagonalStrided<double>(argc, argv, config, true);
+        for (int layout = 0; layout < 2; layout++)
+            for (int cyclic = 0; cyclic < 2; cyclic++)
+                retval += testTridiagonalFactored<double>(argc, argv, config, 
+                                                       layout != 0, cyclic != 0);
+    }
     
     return retval;
     
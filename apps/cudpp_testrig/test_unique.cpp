@@ -0,0 +1,271 @@
+// -------------------------------------------------------------
+// CUDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision: $
+// $Date: $
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt in
+// the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+ * @file
+ * test_unique.cpp
+ *
+ * @brief Host testrig routines to exercise cudpp's unique functionality.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cuda_runtime_api.h>
+
+#include "cudpp.h"
+
+#include "cudpp_testrig_options.h"
+#include "cudpp_testrig_utils.h"
+#include "cuda_util.h"
+#include "stopwatch.h"
+#include "comparearrays.h"
+#include "backendarrays.h"
+#include "commandline.h"
+#include "unique_gold.h"
+
+using namespace cudpp_app;
+
+/**
+ * uniqueTest exercises unique of keys of type T on one backend.
+ *
+ * Sorted keys (the default) are random runs of increasing keys; unsorted
+ * keys (CUDPP_OPTION_UNSORTED) are random keys with about four
+ * occurrences each.  The timed calls write to separate output arrays;
+ * for odd sizes a final call uniques in place and its output is the one
+ * checked.  The kept keys, their values and their count are checked
+ * against the CPU reference.
+ *
+ * Possible command line arguments:
+ * - --n=#: number of elements
+ * @param argc Number of arguments on the command line, passed
+ * directly from main
+ * @param argv Array of arguments on the command line, passed directly
+ * from main
+ * @param config Plan configuration, with or without CUDPP_OPTION_HOST
+ * and CUDPP_OPTION_UNSORTED
+ * @param testOptions Global test options
+ * @param withValues Whether to unique key-value pairs
+ * @return Number of tests that failed regression (0 for all pass)
+ * @see cudppUnique
+ */
+template <typename T>
+int uniqueTest(int argc, const char **argv, const CUDPPConfiguration &config,
+               const testrigOptions &testOptions, bool withValues)
+{
+    int retval = 0;
+
+    cudpp_app::StopWatch timer;
+
+    bool host = (config.options & CUDPP_OPTION_HOST) != 0;
+    bool sorted = (config.options & CUDPP_OPTION_UNSORTED) == 0;
+
+    bool quiet = checkCommandLineFlag(argc, (const char**)argv, "quiet");   
+
+    unsigned int test[] = {1, 7, 39, 1000, 1025, 65536, 131073, 1048576, 4194304};
+    int numTests = sizeof(test) / sizeof(test[0]);
+    int numElements = test[numTests-1]; // maximum test size
+
+    bool oneTest = false;
+    if (commandLineArg(numElements, argc, (const char**) argv, "n"))
+    {
+        oneTest = true;
+        numTests = 1;
+        test[0] = numElements;
+    }
+
+    CUDPPResult result = CUDPP_SUCCESS;
+    CUDPPHandle theCudpp;
+    result = cudppCreate(&theCudpp);
+    if (result != CUDPP_SUCCESS)
+    {
+        if (!quiet)
+            fprintf(stderr, "Error initializing CUDPP Library.\n");
+        retval = (oneTest) ? 1 : numTests;
+        return retval;
+    }
+
+    CUDPPHandle plan;
+    result = cudppPlan(theCudpp, &plan, config, numElements, 1, 0);
+
+    if (result != CUDPP_SUCCESS)
+    {
+        if (!quiet)
+            fprintf(stderr, "Error creating plan for Unique\n");
+        retval = (oneTest) ? 1 : numTests;
+        return retval;
+    }
+
+    T *h_keys                 = (T*) malloc(sizeof(T) * numElements);
+    unsigned int *h_values    = (unsigned int*) malloc(sizeof(unsigned int) * numElements);
+    T *refKeys                = (T*) malloc(sizeof(T) * numElements);
+    unsigned int *refValues   = (unsigned int*) malloc(sizeof(unsigned int) * numElements);
+    T *o_keys                 = (T*) malloc(sizeof(T) * numElements);
+    unsigned int *o_values    = (unsigned int*) malloc(sizeof(unsigned int) * numElements);
+
+    T *d_keys                 = backendAlloc<T>(host, numElements);
+    unsigned int *d_values    = backendAlloc<unsigned int>(host, numElements);
+    T *d_keysOut              = backendAlloc<T>(host, numElements);
+    unsigned int *d_valuesOut = backendAlloc<unsigned int>(host, numElements);
+
+    for (int k = 0; k < numTests; ++k)
+    {
+        size_t n = test[k];
+        bool inPlace = (n % 2) != 0;
+
+        if (!quiet)
+        {
+            printf("Running %s%s unique of %zu %s%s\n",
+                host ? "host " : "", sorted ? "sorted" : "unsorted", n,
+                withValues ? "key-value pairs" : "keys",
+                inPlace ? " in place" : "");
+            fflush(stdout);
+        }
+
+        unsigned int key = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            if (sorted)
+            {
+                key += (rand() % 4 == 0) ? rand() % 3 + 1 : 0;
+                h_keys[i] = (T)key;
+            }
+            else
+                h_keys[i] = (T)(rand() % (n / 4 + 1));
+            h_values[i] = (unsigned int)i;
+        }
+
+        unsigned int *h_vals = withValues ? h_values : NULL;
+        size_t refUnique = uniqueGold(refKeys, withValues ? refValues : NULL, h_keys,
+                                      h_vals, n, sorted);
+
+        backendCopy(host, d_keys, h_keys, n, true);
+        backendCopy(host, d_values, h_values, n, true);
+
+        const unsigned int *values = withValues ? d_values : NULL;
+        size_t numUnique = 0;
+
+        // run once to avoid timing startup overhead.
+        result = cudppUnique(plan, d_keysOut, d_valuesOut, &numUnique, d_keys, values, n);
+
+        timer.reset();
+        timer.start();
+        for (int i = 0; i < testOptions.numIterations; i++)
+        {
+            cudppUnique(plan, d_keysOut, d_valuesOut, &numUnique, d_keys, values, n);
+        }
+        cudaThreadSynchronize();
+        timer.stop();
+
+        // check an in-place call, which overwrites the input, after timing
+        T *keysOut = d_keysOut;
+        unsigned int *valuesOut = d_valuesOut;
+        if (inPlace && result == CUDPP_SUCCESS)
+        {
+            keysOut = d_keys;
+            valuesOut = d_values;
+            result = cudppUnique(plan, keysOut, valuesOut, &numUnique, d_keys, values, n);
+        }
+
+        bool passed = (result == CUDPP_SUCCESS) && (numUnique == refUnique);
+        if (passed)
+        {
+            backendCopy(host, o_keys, keysOut, numUnique, false);
+            passed = compareArrays<T>(refKeys, o_keys, (unsigned int)numUnique);
+            if (withValues)
+            {
+                backendCopy(host, o_values, valuesOut, numUnique, false);
+                passed = compareArrays<unsigned int>(refValues, o_values, 
+                                                     (unsigned int)numUnique) && passed;
+            }
+        }
+
+        retval += passed ? 0 : 1;
+        if (!quiet)
+        {
+            printf("test %s (%zu unique)\n", passed ? "PASSED" : "FAILED", refUnique);
+            printf("Average execution time: %f ms\n",
+                timer.getTime() / testOptions.numIterations);
+        }
+        else
+            printf("\t%10zu\t%0.4f\n", n, timer.getTime() / testOptions.numIterations);
+    }
+
+    result = cudppDestroyPlan(plan);
+    if (result != CUDPP_SUCCESS)
+    {
+        if (!quiet)
+            printf("Error destroying CUDPPPlan for Unique\n");
+    }
+
+    result = cudppDestroy(theCudpp);
+    if (result != CUDPP_SUCCESS)
+    {
+        if (!quiet)
+            printf("Error shutting down CUDPP Library.\n");
+    }
+
+    free(h_keys);
+    free(h_values);
+    free(refKeys);
+    free(refValues);
+    free(o_keys);
+    free(o_values);
+
+    backendFree(host, d_keys);
+    backendFree(host, d_values);
+    backendFree(host, d_keysOut);
+    backendFree(host, d_valuesOut);
+
+    return retval;
+}
+
+/**
+ * testUnique runs the unique tests (sorted and unsorted unsigned int
+ * key-value pairs, unsorted unsigned char keys and sorted double keys)
+ * on the GPU and on the host backend.
+ * @param argc Number of arguments on the command line, passed
+ * directly from main
+ * @param argv Array of arguments on the command line, passed directly
+ * from main
+ * @return Number of tests that failed regression (0 for all pass)
+ * @see uniqueTest
+ */
+int testUnique(int argc, const char **argv)
+{
+    testrigOptions testOptions;
+    setOptions(argc, argv, testOptions);
+
+    int retval = 0;
+    for (int host = 0; host < 2; ++host)
+    {
+        unsigned int backend = host ? CUDPP_OPTION_HOST : 0;
+
+        CUDPPConfiguration config;
+        config.algorithm = CUDPP_UNIQUE;
+        config.op = CUDPP_ADD;
+
+        config.datatype = CUDPP_UINT;
+        config.options = backend;
+        retval += uniqueTest<unsigned int>(argc, argv, config, testOptions, true);
+
+        config.options = backend | CUDPP_OPTION_UNSORTED;
+        retval += uniqueTest<unsigned int>(argc, argv, config, testOptions, true);
+
+        config.datatype = CUDPP_UCHAR;
+        retval += uniqueTest<unsigned char>(argc, argv, config, testOptions, false);
+
+        config.datatype = CUDPP_DOUBLE;
+        config.options = backend;
+        retval += uniqueTest<double>(argc, argv, config, testOptions, false);
+    }
+
+    return retval;
+}
@@ -0,0 +1,105 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// ------------------------------------------------------------- 
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// ------------------------------------------------------------- 
+#include <stdlib.h>
+
+////////////////////////////////////////////////////////////////////////////////
+//! Compute reference pre-order, post-order, depth and subtree size of a forest
+//! The trees are visited in the order of their roots and the children of
+//! each node in node order, with pre-order and post-order numbers running
+//! over the whole forest.
+//! @param pre              pre-order number of each node, preallocated
+//! @param post             post-order number of each node, preallocated
+//! @param depth            depth of each node, preallocated
+//! @param size             subtree size of each node, preallocated
+//! @param parent           parent of each node, negative for roots
+//! @param n                number of nodes
+////////////////////////////////////////////////////////////////////////////////
+inline void treeOrderGold(int *pre, int *post, int *depth, int *size,
+                          const int *parent, int n)
+{
+    // children of each node, in node order
+    int *first = (int*) malloc(sizeof(int) * (n+1));
+    int *children = (int*) malloc(sizeof(int) * (n+1));
+    int *stack = (int*) malloc(sizeof(int) * (n+1));
+    int *cursor = (int*) malloc(sizeof(int) * (n+1));
+    for (int v = 0; v <= n; v++)
+        first[v] = 0;
+    for (int v = 0; v < n; v++)
+        first[(parent[v] < 0) ? n : parent[v]]++;
+    int sum = 0;
+    for (int v = 0; v <= n; v++)
+    {
+        int count = first[v];
+        first[v] = sum;
+        cursor[v] = sum;
+        sum += count;
+    }
+    for (int v = 0; v < n; v++)
+        children[cursor[(parent[v] < 0) ? n : parent[v]]++] = v;
+    
+    // depth first from the virtual root n
+    int preCount = 0, postCount = 0, top = 0;
+    for (int v = 0; v <= n; v++)
+        cursor[v] = first[v];
+    stack[top++] = n;
+    while (top > 0)
+    {
+        int v = stack[top-1];
+        int end = (v == n) ? sum : first[v+1];
+        if (cursor[v] < end)
+        {
+            int c = children[cursor[v]++];
+            pre[c] = preCount++;
+            depth[c] = top - 1;
+            stack[top++] = c;
+        }
+        else
+        {
+            top--;
+            if (v < n)
+            {
+                post[v] = postCount++;
+                size[v] = preCount - pre[v];
+            }
+        }
+    }
+
+    free(first);
+    free(children);
+    free(stack);
+    free(cursor);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Compute reference lowest common ancestors by climbing the parent links
+//! @param lca              lowest common ancestor of each pair (-1 if the
+//!                         nodes are in different trees), preallocated
+//! @param u                first node of each pair
+//! @param v                second node of each pair
+//! @param parent           parent of each node, negative for roots
+//! @param depth            depth of each node
+//! @param numQueries       number of pairs
+////////////////////////////////////////////////////////////////////////////////
+inline void treeLCAGold(int *lca, const int *u, const int *v,
+                        const int *parent, const int *depth, int numQueries)
+{
+    for (int q = 0; q < numQueries; q++)
+    {
+        int a = u[q], b = v[q];
+        while (depth[a] > depth[b]) a = parent[a];
+        while (depth[b] > depth[a]) b = parent[b];
+        while (a != b && a >= 0)
+        {
+            a = parent[a];
+            b = parent[b];
+        }
+        lca[q] = (a < 0) ? -1 : a;
+    }
+}
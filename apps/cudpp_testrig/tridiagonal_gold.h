@@ -76,6 +76,161 @@ void testGeneration(T *a, T *b, T *c, T *d, T *x, int systemSize)
     c[systemSize-1] = 0;
 }
 
+template <class T>
+void serialCyclic(const T *a, const T *b, const T *c, const T *d, T *x, int n)
+{
+    // Sherman-Morrison: solve the modified (non-periodic) system for both
+    // the right-hand side d and the correction vector u, then combine
+    T *aa = new T[n];
+    T *bb = new T[n];
+    T *cc = new T[n];
+    T *dd = new T[n];
+    T *u  = new T[n];
+    T *z  = new T[n];
+
+    T gamma = -b[0];
+    for (int i = 0; i < n; i++)
+    {
+        aa[i] = a[i];
+        bb[i] = b[i];
+        cc[i] = c[i];
+        dd[i] = d[i];
+        u[i] = 0;
+    }
+    aa[0] = 0;
+    bb[0] = b[0] - gamma;
+    bb[n-1] = b[n-1] - c[n-1] * a[0] / gamma;
+    u[0] = gamma;
+    u[n-1] = c[n-1];
+
+    serial(aa, bb, cc, dd, x, n);
+    for (int i = 0; i < n; i++) cc[i] = c[i];
+    serial(aa, bb, cc, u, z, n);
+
+    T fact = (x[0] + a[0] * x[n-1] / gamma) / (1 + z[0] + a[0] * z[n-1] / gamma);
+    for (int i = 0; i < n; i++)
+        x[i] -= fact * z[i];
+
+    delete [] aa;
+    delete [] bb;
+    delete [] cc;
+    delete [] dd;
+    delete [] u;
+    delete [] z;
+}
+
+template <class T>
+void serialPentadiagonal(const T *e, const T *a, const T *b, const T *c, const T *f, 
+                         const T *d, T *x, int n)
+{
+    // banded Gaussian elimination on a copy of the five diagonals
+    T *band = new T[5 * n];
+    T *rhs = new T[n];
+    for (int i = 0; i < n; i++)
+    {
+        band[5*i+0] = (i >= 2) ? e[i] : 0;
+        band[5*i+1] = (i >= 1) ? a[i] : 0;
+        band[5*i+2] = b[i];
+        band[5*i+3] = (i + 1 < n) ? c[i] : 0;
+        band[5*i+4] = (i + 2 < n) ? f[i] : 0;
+        rhs[i] = d[i];
+    }
+    // band[5*i + 2 + (j - i)] holds entry (i, j)
+    for (int k = 0; k < n; k++)
+    {
+        for (int i = k + 1; i <= k + 2 && i < n; i++)
+        {
+            T l = band[5*i + 2 + (k - i)] / band[5*k + 2];
+            for (int j = k; j <= k + 2 && j < n; j++)
+                band[5*i + 2 + (j - i)] -= l * band[5*k + 2 + (j - k)];
+            rhs[i] -= l * rhs[k];
+        }
+    }
+    for (int i = n - 1; i >= 0; i--)
+    {
+        T v = rhs[i];
+        for (int j = i + 1; j <= i + 2 && j < n; j++)
+            v -= band[5*i + 2 + (j - i)] * x[j];
+        x[i] = v / band[5*i + 2];
+    }
+    delete [] band;
+    delete [] rhs;
+}
+
+template <class T>
+void serialBlockTridiagonal(const T *a, const T *b, const T *c, const T *d, T *x, 
+                            int m, int n)
+{
+    // dense Gaussian elimination with partial pivoting (fine for test sizes)
+    int size = m * n;
+    T *mat = new T[size * size];
+    T *rhs = new T[size];
+    for (int i = 0; i < size * size; i++) mat[i] = 0;
+    for (int i = 0; i < n; i++)
+    {
+        for (int r = 0; r < m; r++)
+        {
+            rhs[i*m + r] = d[i*m + r];
+            for (int col = 0; col < m; col++)
+            {
+                if (i > 0)
+                    mat[(i*m + r) * size + (i-1)*m + col] = a[(i*m + r) * m + col];
+                mat[(i*m + r) * size + i*m + col] = b[(i*m + r) * m + col];
+                if (i < n - 1)
+                    mat[(i*m + r) * size + (i+1)*m + col] = c[(i*m + r) * m + col];
+            }
+        }
+    }
+    for (int k = 0; k < size; k++)
+    {
+        int p = k;
+        for (int i = k + 1; i < size; i++)
+            if (fabs(mat[i*size + k]) > fabs(mat[p*size + k])) p = i;
+        if (p != k)
+        {
+            for (int j = 0; j < size; j++)
+            {
+                T t = mat[k*size + j]; mat[k*size + j] = mat[p*size + j]; mat[p*size + j] = t;
+            }
+            T t = rhs[k]; rhs[k] = rhs[p]; rhs[p] = t;
+        }
+        for (int i = k + 1; i < size; i++)
+        {
+            T l = mat[i*size + k] / mat[k*size + k];
+            if (l == 0) continue;
+            for (int j = k; j < size; j++)
+                mat[i*size + j] -= l * mat[k*size + j];
+            rhs[i] -= l * rhs[k];
+        }
+    }
+    for (int i = size - 1; i >= 0; i--)
+    {
+        T v = rhs[i];
+        for (int j = i + 1; j < size; j++)
+            v -= mat[i*size + j] * x[j];
+        x[i] = v / mat[i*size + i];
+    }
+    delete [] mat;
+    delete [] rhs;
+}
+
+template <class T>
+void testGenerationBlock(T *a, T *b, T *c, T *d, int m, int n)
+{
+    //generate a block diagonally dominant matrix
+    for (int i = 0; i < n * m * m; i++)
+    {
+        a[i] = rand01<T>() - T(0.5);
+        b[i] = rand01<T>() - T(0.5);
+        c[i] = rand01<T>() - T(0.5);
+    }
+    for (int i = 0; i < n * m; i++)
+    {
+        b[i * m + i % m] += 4 + m;
+        d[i] = 5 + rand01<T>();
+    }
+}
+
 template <class T>
 T compare(T *x1, T *x2, int numElements)
 {
@@ -0,0 +1,42 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// ------------------------------------------------------------- 
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// ------------------------------------------------------------- 
+#include <stdlib.h>
+#include <set>
+
+////////////////////////////////////////////////////////////////////////////////
+//! Compute a reference unique, keeping the first element of every run of
+//! equal consecutive keys, or the first occurrence of every key
+//! @param keysOut          kept keys, preallocated
+//! @param valuesOut        values of the kept keys, preallocated (NULL for keys only)
+//! @param keys             keys
+//! @param values           values (NULL for keys only)
+//! @param numElements      number of elements
+//! @param sorted           whether equal keys are adjacent
+//! @return                 number of kept keys
+////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+size_t uniqueGold(T *keysOut, unsigned int *valuesOut, const T *keys,
+                  const unsigned int *values, size_t numElements, bool sorted)
+{
+    std::set<T> seen;
+    size_t numUnique = 0;
+    for (size_t i = 0; i < numElements; i++)
+    {
+        bool keep = sorted ? (i == 0 || keys[i] != keys[i-1])
+                           : seen.insert(keys[i]).second;
+        if (!keep)
+            continue;
+        keysOut[numUnique] = keys[i];
+        if (valuesOut != NULL)
+            valuesOut[numUnique] = values[i];
+        numUnique++;
+    }
+    return numUnique;
+}
@@ -104,16 +104,34 @@
  * - CUDPP_SEGMENTED_SCAN     67,107,840 elements
  * - CUDPP_COMPACT            67,107,840 elements
  * - CUDPP_COMPRESS           1,048,576 elements
+ * - CUDPP_CONNECTED_COMPONENTS 2,147,483,647 vertices and edges
+ * - CUDPP_BFS                2,147,483,647 vertices, 4,294,967,295 edges
  * - CUDPP_LISTRANK           NO LIMIT
  * - CUDPP_MTF                1,048,576 elements
  * - CUDPP_BWT                1,048,576 elements
  * - CUDPP_SORT               2,147,450,880 elements
  * - CUDPP_REDUCE             NO LIMIT
- * - CUDPP_RAND               33,554,432 elements
- * - CUDPP_SPMVMULT           67,107,840 non-zero elements
+ * - CUDPP_REDUCE_BY_KEY      536,862,720 elements (4,294,967,295 with CUDPP_OPTION_HOST)
+ * - CUDPP_RLE                536,862,720 elements (4,294,967,295 with CUDPP_OPTION_HOST)
+ * - CUDPP_UNIQUE             536,862,720 elements (4,294,967,295 with CUDPP_OPTION_HOST)
+ * - CUDPP_RAND_MD5           33,554,432 elements
+ * - CUDPP_RAND_PHILOX        NO LIMIT
+ * - CUDPP_RAND_THREEFRY      NO LIMIT
+ * - CUDPP_SHUFFLE            4,294,967,295 elements
+ * - CUDPP_SPMVMULT           67,107,840 non-zero elements (4,294,967,295 rows plus
+ *                                           non-zero elements with CUDPP_OPTION_HOST;
+ *                                           cudppSparseMatrixMultiply: 4,294,967,295 
+ *                                           products, where each nonzero A(i,k) 
+ *                                           contributes one per nonzero of row k of B)
+ * - CUDPP_TREE               1,073,741,823 nodes
  * - CUDPP_HASH               See \ref hash_space_limitations
- * - CUDPP_TRIDIAGONAL        65535 systems, 1024 equations per system (Compute capability 2.x),
- *                                           512 equations per system (Compute capability < 2.0)
+ * - CUDPP_TRIDIAGONAL        NO LIMIT (CR-PCR: 65535 systems, 1024 equations per system 
+ *                                           (Compute capability 2.x), 512 equations per 
+ *                                           system (Compute capability < 2.0); larger 
+ *                                           problems use the Thomas or partitioned solvers;
+ *                                           cudppPentadiagonal, cudppBlockTridiagonal: 
+ *                                           one GPU thread per system, no 
+ *                                           CUDPP_OPTION_HOST or CUDPP_OPTION_CYCLIC)
  * 
  * \section opSys Operating System Support and Requirements
  * 
@@ -201,6 +219,7 @@
  * - Dan A. Alcantara, Andrei Sharf, Fatemeh Abbasinejad, Shubhabrata Sengupta, Michael Mitzenmacher, John D. Owens, and Nina Amenta. Real-Time Parallel Hashing on the GPU. ACM Transactions on Graphics, 28(5):154:1–154:9, December 2009. http://www.idav.ucdavis.edu/publications/print_pub?pub_id=973
  * - Dan A. Alcantara, Vasily Volkov, Shubhabrata Sengupta, Michael Mitzenmacher, John D. Owens, and Nina Amenta. Building an Efficient Hash Table on the GPU. In Wen-mei W. Hwu, editor, GPU Computing Gems, volume 2, chapter 1. Morgan Kaufmann, August 2011. 
  * - Ritesh A. Patel, Yao Zhang, Jason Mak, Andrew Davidson, John D. Owens. "Parallel Lossless Data Compression on the GPU". In <i>Proceedings of Innovative Parallel Computing (InPar '12)</i>, May 2012. http://idav.ucdavis.edu/publications/print_pub?pub_id=1087
+ * - John K. Salmon, Mark A. Moraes, Ron O. Dror, and David E. Shaw. "Parallel Random Numbers: As Easy as 1, 2, 3". In <i>Proceedings of the 2011 International Conference for High Performance Computing, Networking, Storage and Analysis (SC '11)</i>, November 2011. http://dx.doi.org/10.1145/2063384.2063405
  *
  * Many researchers are using CUDPP in their work, and there are many
  * publications that have used it \ref cudpp_refs "(references)". If
@@ -429,6 +448,50 @@ enum CUDPPOption
     CUDPP_OPTION_KEYS_ONLY = 0x20, /**< No associated value to a key 
                                     * (for global radix sort) */
     CUDPP_OPTION_KEY_VALUE_PAIRS = 0x40, /**< Each key has an associated value */
+    CUDPP_OPTION_INTERLEAVED = 0x80, /**< Batched systems are stored
+                                      * interleaved: element i of
+                                      * system s is at index
+                                      * i * numSystems + s (for
+                                      * tridiagonal solvers) */
+    CUDPP_OPTION_CYCLIC = 0x100,    /**< Tridiagonal systems are cyclic
+                                      * (periodic): a[0] couples the 
+                                      * first row to the last unknown
+                                      * and c[n-1] the last row to the
+                                      * first */
+    CUDPP_OPTION_SPMV_CSR = 0x200,  /**< Sparse matrix is kept in CSR
+                                      * format and multiplied with 
+                                      * merge-path load balancing */
+    CUDPP_OPTION_SPMV_ELL = 0x400,  /**< Sparse matrix is converted to
+                                      * ELLPACK format */
+    CUDPP_OPTION_SPMV_SELL = 0x800, /**< Sparse matrix is converted to
+                                      * SELL-C-sigma (sliced ELLPACK
+                                      * with rows sorted by length in
+                                      * windows of sigma rows) format */
+    CUDPP_OPTION_SPMV_BSR = 0x1000, /**< Sparse matrix is converted to
+                                      * block sparse row format with
+                                      * small dense blocks */
+    CUDPP_OPTION_SPMV_REORDER = 0x2000, /**< Sparse matrix rows and
+                                          * columns are renumbered by
+                                          * reverse Cuthill-McKee to
+                                          * improve the locality of
+                                          * reads of x */
+    CUDPP_OPTION_SPMV_TRANSPOSE_A = 0x4000, /**< Sparse matrix product of
+                                              * the transpose of the first
+                                              * matrix, C = A^T * B 
+                                              * (cudppSparseMatrixMultiply()) */
+    CUDPP_OPTION_HOST = 0x8000,     /**< Algorithm runs on the host CPU
+                                      * and its arrays are in host
+                                      * memory (tridiagonal solvers,
+                                      * CSR sparse matrix-vector
+                                      * multiply, list ranking, tree
+                                      * primitives, connected
+                                      * components, breadth-first
+                                      * search, reduce-by-key,
+                                      * run-length encoding, unique) */
+    CUDPP_OPTION_UNSORTED = 0x10000, /**< Input keys are not sorted:
+                                       * unique keeps the first
+                                       * occurrence of each key, found
+                                       * with a hash table */
 };
 
 
@@ -488,12 +551,40 @@ enum CUDPPAlgorithm
     CUDPP_RAND_MD5,          //!< Pseudorandom number generator using MD5 hash algorithm
     CUDPP_TRIDIAGONAL,       //!< Tridiagonal solver algorithm
     CUDPP_COMPRESS,          //!< Lossless data compression
-    CUDPP_LISTRANK,          //!< List ranking
+    CUDPP_LISTRANK,          //!< List ranking and list scans
     CUDPP_BWT,               //!< Burrows-Wheeler transform
     CUDPP_MTF,               //!< Move-to-Front transform
+    CUDPP_RAND_PHILOX,       //!< Counter-based pseudorandom number generator (Philox4x32-10)
+    CUDPP_RAND_THREEFRY,     //!< Counter-based pseudorandom number generator (Threefry4x32-20)
+    CUDPP_SHUFFLE,           //!< Random permutation and sampling
+    CUDPP_TREE,              //!< Euler tour tree primitives
+    CUDPP_CONNECTED_COMPONENTS, //!< Connected components of a graph
+    CUDPP_BFS,               //!< Direction-optimizing breadth-first search
+    CUDPP_REDUCE_BY_KEY,     //!< Reduction of runs of equal keys
+    CUDPP_RLE,               //!< Run-length encoding
+    CUDPP_UNIQUE,            //!< Removal of duplicate keys
     CUDPP_ALGORITHM_INVALID, //!< Placeholder at end of enum
 };
 
+/**
+* @brief Output distributions of the counter-based random number generators.
+*
+* Set with cudppRandDistribution().  The output array passed to cudppRand()
+* has the datatype of the plan: CUDPP_UINT for CUDPP_RAND_BITS and 
+* CUDPP_RAND_UNIFORM_INT, CUDPP_FLOAT or CUDPP_DOUBLE for the others.
+* 
+* @see cudppRandDistribution, cudppRand
+*/
+enum CUDPPRandDistribution
+{
+    CUDPP_RAND_BITS,         //!< Raw 32-bit unsigned integers (default for CUDPP_UINT)
+    CUDPP_RAND_UNIFORM,      //!< Uniform in [0, 1) (default for CUDPP_FLOAT and CUDPP_DOUBLE)
+    CUDPP_RAND_NORMAL,       //!< Normal with mean param0 and standard deviation param1 (Box-Muller)
+    CUDPP_RAND_EXPONENTIAL,  //!< Exponential with rate param0
+    CUDPP_RAND_UNIFORM_INT,  //!< Unbiased unsigned integers in [param0, param1) (Lemire's method)
+    CUDPP_RAND_DISTRIBUTION_INVALID, //!< Placeholder at end of enum
+};
+
 /**
 * @brief Configuration struct used to specify algorithm, datatype,
 * operator, and options when creating a plan for CUDPP algorithms.
@@ -508,6 +599,20 @@ struct CUDPPConfiguration
     unsigned int   options;   //!< Options to configure the algorithm
 };
 
+/**
+* @brief Work decomposition of a list ranking, as reported by
+* cudppListRankStats().
+*
+* @see cudppListRank, cudppListRankStats
+*/
+struct CUDPPListRankStats
+{
+    size_t numElements; //!< Number of nodes ranked or scanned
+    size_t numSublists; //!< Number of sublists the ruling set split the list(s) into
+    size_t numThreads;  //!< Number of GPU threads, or host threads with 
+                        //!< CUDPP_OPTION_HOST, that walked the sublists
+};
+
 #define CUDPP_INVALID_HANDLE 0xC0DABAD1
 typedef size_t CUDPPHandle;
 
@@ -615,6 +720,30 @@ CUDPPResult cudppSparseMatrix(const CUDPPHandle  cudppHandle,
 CUDPP_DLL
 CUDPPResult cudppDestroySparseMatrix(CUDPPHandle sparseMatrixHandle);
 
+CUDPP_DLL
+CUDPPResult cudppSparseMatrixMultiply(const CUDPPHandle  cudppHandle,
+                                      CUDPPHandle        *sparseMatrixHandleC,
+                                      CUDPPConfiguration config,
+                                      const CUDPPHandle  sparseMatrixHandleA,
+                                      const CUDPPHandle  sparseMatrixHandleB);
+
+CUDPP_DLL
+CUDPPResult cudppSparseMatrixMultiplyNumeric(const CUDPPHandle sparseMatrixHandleC,
+                                             const CUDPPHandle sparseMatrixHandleA,
+                                             const CUDPPHandle sparseMatrixHandleB);
+
+CUDPP_DLL
+CUDPPResult cudppSparseMatrixFormat(const CUDPPHandle sparseMatrixHandle,
+                                    CUDPPOption       *format);
+
+CUDPP_DLL
+CUDPPResult cudppSparseMatrixPermutation(const CUDPPHandle sparseMatrixHandle,
+                                         unsigned int      *h_permutation);
+
+CUDPP_DLL
+CUDPPResult cudppSparseMatrixUpdateValues(const CUDPPHandle sparseMatrixHandle,
+                                          const void        *A);
+
 // Sparse matrix-vector algorithms
 
 CUDPP_DLL
@@ -622,6 +751,26 @@ CUDPPResult cudppSparseMatrixVectorMultiply(const CUDPPHandle sparseMatrixHandle
                                             void        *d_y,
                                             const void  *d_x);
 
+CUDPP_DLL
+CUDPPResult cudppSparseMatrixDenseMultiply(const CUDPPHandle sparseMatrixHandle,
+                                           void              *d_y,
+                                           const void        *d_x,
+                                           size_t            numVectors,
+                                           size_t            yPitch,
+                                           size_t            xPitch,
+                                           const void        *alpha,
+                                           const void        *beta);
+
+CUDPP_DLL
+CUDPPResult cudppSparseMatrixTransposeMultiply(const CUDPPHandle sparseMatrixHandle,
+                                               void              *d_y,
+                                               const void        *d_x,
+                                               size_t            numVectors,
+                                               size_t            yPitch,
+                                               size_t            xPitch,
+                                               const void        *alpha,
+                                               const void        *beta);
+
 // random number generation algorithms
 CUDPP_DLL
 CUDPPResult cudppRand(const CUDPPHandle planHandle,
@@ -632,6 +781,39 @@ CUDPP_DLL
 CUDPPResult cudppRandSeed(const CUDPPHandle planHandle, 
                           unsigned int      seed);
 
+CUDPP_DLL
+CUDPPResult cudppRandStream(const CUDPPHandle planHandle, 
+                            unsigned int      stream);
+
+CUDPP_DLL
+CUDPPResult cudppRandSkipAhead(const CUDPPHandle  planHandle, 
+                               unsigned long long offset);
+
+CUDPP_DLL
+CUDPPResult cudppRandDistribution(const CUDPPHandle    planHandle, 
+                                  CUDPPRandDistribution distribution,
+                                  double               param0,
+                                  double               param1);
+
+// random permutation and sampling algorithms
+CUDPP_DLL
+CUDPPResult cudppShuffle(const CUDPPHandle planHandle,
+                         void              *d_keysOut,
+                         void              *d_valuesOut,
+                         const void        *d_keysIn,
+                         const void        *d_valuesIn,
+                         size_t            numElements);
+
+CUDPP_DLL
+CUDPPResult cudppSample(const CUDPPHandle planHandle,
+                        void              *d_keysOut,
+                        void              *d_valuesOut,
+                        const void        *d_keysIn,
+                        const void        *d_valuesIn,
+                        size_t            numSamples,
+                        size_t            numElements,
+                        int               withReplacement);
+
 // tridiagonal solver algorithms
 CUDPP_DLL
 CUDPPResult cudppTridiagonal(CUDPPHandle planHandle, 
@@ -643,6 +825,60 @@ CUDPPResult cudppTridiagonal(CUDPPHandle planHandle,
                              int systemSize, 
                              int numSystems);
 
+CUDPP_DLL
+CUDPPResult cudppTridiagonalStrided(CUDPPHandle planHandle, 
+                                    void *a, 
+                                    void *b, 
+                                    void *c, 
+                                    void *d, 
+                                    void *x, 
+                                    int systemSize, 
+                                    int numSystems,
+                                    size_t elementStride,
+                                    size_t systemStride);
+
+CUDPP_DLL
+CUDPPResult cudppTridiagonalFactor(const CUDPPHandle  cudppHandle,
+                                   CUDPPHandle        *factorHandle, 
+                                   CUDPPConfiguration config, 
+                                   const void         *a,
+                                   const void         *b,
+                                   const void         *c,
+                                   int                systemSize, 
+                                   int                numSystems);
+
+CUDPP_DLL
+CUDPPResult cudppDestroyTridiagonalFactor(CUDPPHandle factorHandle);
+
+CUDPP_DLL
+CUDPPResult cudppTridiagonalSolveFactored(const CUDPPHandle factorHandle, 
+                                          const void *d, 
+                                          void *x, 
+                                          int numRHS);
+
+CUDPP_DLL
+CUDPPResult cudppPentadiagonal(CUDPPHandle planHandle, 
+                               const void *e, 
+                               const void *a, 
+                               const void *b, 
+                               const void *c, 
+                               const void *f, 
+                               const void *d, 
+                               void *x, 
+                               int systemSize, 
+                               int numSystems);
+
+CUDPP_DLL
+CUDPPResult cudppBlockTridiagonal(CUDPPHandle planHandle, 
+                                  const void *a, 
+                                  const void *b, 
+                                  const void *c, 
+                                  const void *d, 
+                                  void *x, 
+                                  int blockSize,
+                                  int systemSize, 
+                                  int numSystems);
+
 // lossless data compression algorithms
 CUDPP_DLL
 CUDPPResult cudppCompress(CUDPPHandle planHandle, 
@@ -679,6 +915,103 @@ CUDPPResult cudppListRank(CUDPPHandle planHandle,
                           size_t head,
                           size_t numElements);
 
+CUDPP_DLL
+CUDPPResult cudppListScan(CUDPPHandle planHandle,
+                          void *d_x,
+                          const void *d_a,
+                          void *d_b,
+                          const int *d_heads,
+                          size_t numHeads,
+                          size_t numElements);
+
+CUDPP_DLL
+CUDPPResult cudppListRankStats(CUDPPHandle planHandle,
+                               CUDPPListRankStats *stats);
+
+// Euler tour tree primitives
+CUDPP_DLL
+CUDPPResult cudppTreeFromParents(CUDPPHandle planHandle,
+                                 const int *d_parent,
+                                 size_t numNodes);
+
+CUDPP_DLL
+CUDPPResult cudppTreeFromEdges(CUDPPHandle planHandle,
+                               int *d_parent,
+                               const int *d_edgeU,
+                               const int *d_edgeV,
+                               size_t numNodes,
+                               int root);
+
+CUDPP_DLL
+CUDPPResult cudppTreeOrder(CUDPPHandle planHandle,
+                           int *d_preorder,
+                           int *d_postorder,
+                           int *d_depth,
+                           int *d_subtreeSize);
+
+CUDPP_DLL
+CUDPPResult cudppTreeLCA(CUDPPHandle planHandle,
+                         int *d_lca,
+                         const int *d_u,
+                         const int *d_v,
+                         size_t numQueries);
+
+// Connected components
+CUDPP_DLL
+CUDPPResult cudppConnectedComponents(CUDPPHandle planHandle,
+                                     int *d_labels,
+                                     size_t *numComponents,
+                                     const int *d_edgeU,
+                                     const int *d_edgeV,
+                                     size_t numEdges,
+                                     size_t numVertices);
+
+CUDPP_DLL
+CUDPPResult cudppConnectedComponentsCSR(CUDPPHandle planHandle,
+                                        int *d_labels,
+                                        size_t *numComponents,
+                                        const unsigned int *d_rowIndices,
+                                        const unsigned int *d_indices,
+                                        size_t numVertices);
+
+// Breadth-first search
+CUDPP_DLL
+CUDPPResult cudppBFS(CUDPPHandle planHandle,
+                     int *d_distances,
+                     int *d_parents,
+                     const unsigned int *d_rowIndices,
+                     const unsigned int *d_indices,
+                     size_t numVertices,
+                     int source);
+
+// Reduce-by-key and run-length encoding
+CUDPP_DLL
+CUDPPResult cudppReduceByKey(const CUDPPHandle planHandle,
+                             unsigned int *d_keysOut,
+                             void *d_valuesOut,
+                             size_t *numSegments,
+                             const unsigned int *d_keys,
+                             const void *d_values,
+                             size_t numElements);
+
+CUDPP_DLL
+CUDPPResult cudppRLE(const CUDPPHandle planHandle,
+                     void *d_runValues,
+                     unsigned int *d_runLengths,
+                     size_t *numRuns,
+                     const void *d_in,
+                     size_t numElements);
+
+// Unique
+CUDPP_DLL
+CUDPPResult cudppUnique(const CUDPPHandle planHandle,
+                        void *d_keysOut,
+                        unsigned int *d_valuesOut,
+                        size_t *numUnique,
+                        const void *d_keys,
+                        const unsigned int *d_values,
+                        size_t numElements);
+
 #ifdef __cplusplus
 }
 #endif
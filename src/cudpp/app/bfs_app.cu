@@ -0,0 +1,386 @@
+// -------------------------------------------------------------
+// CUDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#include "cuda_util.h"
+#include "cudpp_globals.h"
+#include "cudpp.h"
+#include "cudpp_util.h"
+#include "cudpp_plan.h"
+#include "cudpp_scan.h"
+
+#include "kernel/bfs_kernel.cuh"
+
+/**
+ * @file
+ * bfs_app.cu
+ *
+ * @brief CUDPP application-level breadth-first search routines
+ */
+
+/** \addtogroup cudpp_app
+ * @{
+ */
+
+/** @name Breadth-First Search Functions
+ * @{
+ */
+
+/* The search is level synchronous and direction optimizing (Beamer et
+ * al., 2012).  It starts top-down, pushing from a queue of frontier
+ * vertices to their neighbors, and switches to bottom-up, where every
+ * unvisited vertex pulls from a frontier bitmap, once the frontier's
+ * edges exceed 1/BFS_ALPHA of the edges not yet explored.  It switches
+ * back once the frontier is shrinking and holds fewer than 1/BFS_BETA of
+ * the vertices, compacting the frontier bitmap into a queue.
+ */
+
+/** @brief Grid of BFS_CTA_SIZE threads per block for \a numItems items
+ *
+ * The kernels loop over their items, so the grid is capped at 65535 blocks.
+ */
+dim3 bfsGrid(size_t numItems)
+{
+    size_t numBlocks = (numItems + BFS_CTA_SIZE - 1) / BFS_CTA_SIZE;
+    if (numBlocks > 65535)
+        numBlocks = 65535;
+    if (numBlocks < 1)
+        numBlocks = 1;
+    return dim3((unsigned int)numBlocks, 1, 1);
+}
+
+/** @brief Breadth-first search on the host
+ *
+ * Push levels hand out the frontier vertices to OpenMP threads in small
+ * chunks and pull levels the visited words; the frontier bitmap is
+ * compacted into a queue serially.
+ *
+ * @param[in,out] plan Pointer to CUDPPBfsPlan object
+ * @param[out] distances Distance of each vertex from \a source, -1 if unreached
+ * @param[out] parents Parent of each vertex (may be NULL)
+ * @param[in] rowIndices Offset of the first neighbor of each vertex
+ * @param[in] indices Neighbors of all vertices
+ * @param[in] numVertices Number of vertices
+ * @param[in] source The source vertex
+ */
+void bfsHost(CUDPPBfsPlan         *plan,
+             int                  *distances,
+             int                  *parents,
+             const unsigned int   *rowIndices,
+             const unsigned int   *indices,
+             size_t               numVertices,
+             int                  source)
+{
+    int n = (int)numVertices;
+    int numWords = (n + 31) / 32;
+    int *queue = plan->m_d_queue;
+    int *nextQueue = plan->m_d_nextQueue;
+    unsigned int *visited = plan->m_d_visited;
+    unsigned int *frontierBits = plan->m_d_frontierBits;
+    unsigned int *nextBits = plan->m_d_nextBits;
+
+#pragma omp parallel for
+    for (int v = 0; v < n; ++v)
+    {
+        distances[v] = (v == source) ? 0 : -1;
+        if (parents != NULL)
+            parents[v] = (v == source) ? source : -1;
+    }
+    memset(visited, 0, numWords * sizeof(unsigned int));
+    visited[source >> 5] = 1u << (source & 31);
+    queue[0] = source;
+
+    size_t edgesToCheck = rowIndices[n];
+    int numFrontier = 1;
+    bool pull = false;
+
+    for (int level = 1; numFrontier > 0; ++level)
+    {
+        if (!pull)
+        {
+            size_t frontierEdges = 0;
+#pragma omp parallel for reduction(+:frontierEdges)
+            for (int i = 0; i < numFrontier; ++i)
+                frontierEdges += rowIndices[queue[i]+1] - rowIndices[queue[i]];
+
+            if (frontierEdges <= edgesToCheck / BFS_ALPHA)
+            {
+                edgesToCheck -= frontierEdges;
+
+                int numNext = 0;
+#pragma omp parallel for schedule(dynamic, 64)
+                for (int i = 0; i < numFrontier; ++i)
+                {
+                    int u = queue[i];
+                    for (unsigned int j = rowIndices[u]; j < rowIndices[u+1]; ++j)
+                    {
+                        int w = (int)indices[j];
+                        if (bfsClaim(distances, parents, visited, u, w, level))
+                        {
+                            nextQueue[bfsFetchAdd(&numNext, 1)] = w;
+                        }
+                    }
+                }
+                numFrontier = numNext;
+                std::swap(queue, nextQueue);
+                continue;
+            }
+
+            pull = true;
+            memset(frontierBits, 0, numWords * sizeof(unsigned int));
+#pragma omp parallel for
+            for (int i = 0; i < numFrontier; ++i)
+                bfsFetchOr(&frontierBits[queue[i] >> 5], 1u << (queue[i] & 31));
+        }
+
+        int numFound = 0;
+#pragma omp parallel for reduction(+:numFound) schedule(dynamic, 64)
+        for (int i = 0; i < numWords; ++i)
+            numFound += bfsPullWord(distances, parents, visited, nextBits, frontierBits,
+                                    rowIndices, indices, i, numVertices, level);
+        std::swap(frontierBits, nextBits);
+
+        bool shrinking = numFound < numFrontier;
+        numFrontier = numFound;
+        if (shrinking && numFrontier <= n / BFS_BETA)
+        {
+            pull = false;
+            int k = 0;
+            for (int i = 0; i < numWords; ++i)
+                for (unsigned int bits = frontierBits[i]; bits != 0; bits &= bits - 1)
+                {
+                    int b = 0;
+                    while (!(bits & (1u << b)))
+                        ++b;
+                    queue[k++] = i * 32 + b;
+                }
+        }
+    }
+}
+
+/** @brief Breadth-first search on the GPU
+ *
+ * Push levels scan the frontier degrees so that bfs_push() can give every
+ * frontier edge its own thread.  Leaving pull mode, the frontier bitmap
+ * is compacted into a queue with the same scan plan.
+ *
+ * @param[in,out] plan Pointer to CUDPPBfsPlan object
+ * @param[out] d_distances Distance of each vertex from \a source, -1 if unreached
+ * @param[out] d_parents Parent of each vertex (may be NULL)
+ * @param[in] d_rowIndices Offset of the first neighbor of each vertex
+ * @param[in] d_indices Neighbors of all vertices
+ * @param[in] numVertices Number of vertices
+ * @param[in] source The source vertex
+ */
+void bfsDevice(CUDPPBfsPlan         *plan,
+               int                  *d_distances,
+               int                  *d_parents,
+               const unsigned int   *d_rowIndices,
+               const unsigned int   *d_indices,
+               size_t               numVertices,
+               int                  source)
+{
+    size_t numWords = (numVertices + 31) / 32;
+    int *d_queue = plan->m_d_queue;
+    int *d_nextQueue = plan->m_d_nextQueue;
+    unsigned int *d_frontierBits = plan->m_d_frontierBits;
+    unsigned int *d_nextBits = plan->m_d_nextBits;
+    unsigned int *d_counters = plan->m_d_counters;
+
+    bfs_init<<< bfsGrid(numVertices), BFS_CTA_SIZE >>>
+        (d_distances, d_parents, plan->m_d_visited, d_queue, source, numVertices);
+    CUDA_CHECK_ERROR("bfs_init");
+
+    unsigned int numEdges;
+    CUDA_SAFE_CALL(cudaMemcpy(&numEdges, d_rowIndices + numVertices, sizeof(unsigned int),
+                              cudaMemcpyDeviceToHost));
+
+    size_t edgesToCheck = numEdges;
+    size_t numFrontier = 1;
+    bool pull = false;
+
+    for (int level = 1; numFrontier > 0; ++level)
+    {
+        if (!pull)
+        {
+            bfs_frontier_degrees<<< bfsGrid(numFrontier), BFS_CTA_SIZE >>>
+                (plan->m_d_degrees, d_queue, d_rowIndices, numFrontier);
+            CUDA_CHECK_ERROR("bfs_frontier_degrees");
+            cudppScanDispatch(plan->m_d_offsets, plan->m_d_degrees, numFrontier, 1,
+                              plan->m_scanPlan);
+
+            unsigned int lastOffset, lastDegree;
+            CUDA_SAFE_CALL(cudaMemcpy(&lastOffset, plan->m_d_offsets + numFrontier - 1,
+                                      sizeof(unsigned int), cudaMemcpyDeviceToHost));
+            CUDA_SAFE_CALL(cudaMemcpy(&lastDegree, plan->m_d_degrees + numFrontier - 1,
+                                      sizeof(unsigned int), cudaMemcpyDeviceToHost));
+            size_t frontierEdges = (size_t)lastOffset + lastDegree;
+
+            if (frontierEdges <= edgesToCheck / BFS_ALPHA)
+            {
+                edgesToCheck -= frontierEdges;
+
+                unsigned int numNext = 0;
+                if (frontierEdges > 0)
+                {
+                    CUDA_SAFE_CALL(cudaMemset(d_counters, 0, 2 * sizeof(unsigned int)));
+                    bfs_push<<< bfsGrid(frontierEdges), BFS_CTA_SIZE >>>
+                        (d_nextQueue, d_counters, d_distances, d_parents, plan->m_d_visited,
+                         d_queue, plan->m_d_offsets, d_rowIndices, d_indices,
+                         numFrontier, frontierEdges, level);
+                    CUDA_CHECK_ERROR("bfs_push");
+                    CUDA_SAFE_CALL(cudaMemcpy(&numNext, d_counters, sizeof(unsigned int),
+                                              cudaMemcpyDeviceToHost));
+                }
+                numFrontier = numNext;
+                std::swap(d_queue, d_nextQueue);
+                continue;
+            }
+
+            pull = true;
+            CUDA_SAFE_CALL(cudaMemset(d_frontierBits, 0, numWords * sizeof(unsigned int)));
+            bfs_queue_to_bitmap<<< bfsGrid(numFrontier), BFS_CTA_SIZE >>>
+                (d_frontierBits, d_queue, numFrontier);
+            CUDA_CHECK_ERROR("bfs_queue_to_bitmap");
+        }
+
+        unsigned int numFound;
+        CUDA_SAFE_CALL(cudaMemset(d_counters, 0, 2 * sizeof(unsigned int)));
+        bfs_pull<<< bfsGrid(numWords), BFS_CTA_SIZE >>>
+            (d_nextBits, d_counters, d_distances, d_parents, plan->m_d_visited,
+             d_frontierBits, d_rowIndices, d_indices, numVertices, level);
+        CUDA_CHECK_ERROR("bfs_pull");
+        CUDA_SAFE_CALL(cudaMemcpy(&numFound, d_counters + 1, sizeof(unsigned int),
+                                  cudaMemcpyDeviceToHost));
+        std::swap(d_frontierBits, d_nextBits);
+
+        bool shrinking = numFound < numFrontier;
+        numFrontier = numFound;
+        if (shrinking && numFrontier <= numVertices / BFS_BETA && numFrontier > 0)
+        {
+            // compact the frontier bitmap into a queue
+            pull = false;
+            bfs_bitmap_flags<<< bfsGrid(numVertices), BFS_CTA_SIZE >>>
+                (plan->m_d_degrees, d_frontierBits, numVertices);
+            CUDA_CHECK_ERROR("bfs_bitmap_flags");
+            cudppScanDispatch(plan->m_d_offsets, plan->m_d_degrees, numVertices, 1,
+                              plan->m_scanPlan);
+            bfs_bitmap_scatter<<< bfsGrid(numVertices), BFS_CTA_SIZE >>>
+                (d_queue, plan->m_d_degrees, plan->m_d_offsets, numVertices);
+            CUDA_CHECK_ERROR("bfs_bitmap_scatter");
+        }
+    }
+}
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @brief Allocate intermediate arrays used by breadth-first search.
+ *
+ * The plan holds two frontier queues of the plan's number of vertices
+ * and the visited, frontier and next frontier bitmaps, in host memory
+ * with CUDPP_OPTION_HOST.  On the GPU it also holds the frontier degrees
+ * and their scan, and two counters.
+ *
+ * @param[in,out] plan Pointer to CUDPPBfsPlan object
+ */
+void allocBfsStorage(CUDPPBfsPlan *plan)
+{
+    size_t n = plan->m_numElements;
+    if (n < 1)
+        n = 1;
+    size_t numWords = (n + 31) / 32;
+
+    if (plan->m_config.options & CUDPP_OPTION_HOST)
+    {
+        plan->m_d_queue        = (int*) malloc(n * sizeof(int));
+        plan->m_d_nextQueue    = (int*) malloc(n * sizeof(int));
+        plan->m_d_visited      = (unsigned int*) malloc(numWords * sizeof(unsigned int));
+        plan->m_d_frontierBits = (unsigned int*) malloc(numWords * sizeof(unsigned int));
+        plan->m_d_nextBits     = (unsigned int*) malloc(numWords * sizeof(unsigned int));
+        return;
+    }
+
+    CUDA_SAFE_CALL(cudaMalloc((void**)&plan->m_d_queue, n * sizeof(int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&plan->m_d_nextQueue, n * sizeof(int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&plan->m_d_degrees, n * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&plan->m_d_offsets, n * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&plan->m_d_visited, numWords * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&plan->m_d_frontierBits, numWords * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&plan->m_d_nextBits, numWords * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&plan->m_d_counters, 2 * sizeof(unsigned int)));
+}
+
+/** @brief Deallocate intermediate arrays in a CUDPPBfsPlan object.
+ *
+ * @param[in,out] plan Pointer to CUDPPBfsPlan object initialized by allocBfsStorage().
+ */
+void freeBfsStorage(CUDPPBfsPlan *plan)
+{
+    if (plan->m_config.options & CUDPP_OPTION_HOST)
+    {
+        free(plan->m_d_queue);
+        free(plan->m_d_nextQueue);
+        free(plan->m_d_visited);
+        free(plan->m_d_frontierBits);
+        free(plan->m_d_nextBits);
+        return;
+    }
+
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_queue));
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_nextQueue));
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_degrees));
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_offsets));
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_visited));
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_frontierBits));
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_nextBits));
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_counters));
+}
+
+/** @brief Dispatch function for breadth-first search.
+ *
+ * This is the app-level interface used by cudppBFS().
+ *
+ * @param[in,out] plan Pointer to CUDPPBfsPlan object
+ * @param[out] d_distances Distance of each vertex from \a source, -1 if unreached
+ * @param[out] d_parents Parent of each vertex (may be NULL)
+ * @param[in] d_rowIndices Offset of the first neighbor of each vertex (numVertices + 1)
+ * @param[in] d_indices Neighbors of all vertices
+ * @param[in] numVertices Number of vertices
+ * @param[in] source The source vertex
+ */
+void cudppBFSDispatch(CUDPPBfsPlan         *plan,
+                      int                  *d_distances,
+                      int                  *d_parents,
+                      const unsigned int   *d_rowIndices,
+                      const unsigned int   *d_indices,
+                      size_t               numVertices,
+                      int                  source)
+{
+    if (plan->m_config.options & CUDPP_OPTION_HOST)
+        bfsHost(plan, d_distances, d_parents, d_rowIndices, d_indices,
+                numVertices, source);
+    else
+        bfsDevice(plan, d_distances, d_parents, d_rowIndices, d_indices,
+                  numVertices, source);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} */ // end breadth-first search functions
+/** @} */ // end cudpp_app
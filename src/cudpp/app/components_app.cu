@@ -0,0 +1,366 @@
+// -------------------------------------------------------------
+// CUDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+
+#include "cuda_util.h"
+#include "cudpp_globals.h"
+#include "cudpp.h"
+#include "cudpp_util.h"
+#include "cudpp_plan.h"
+#include "cudpp_scan.h"
+
+#include "kernel/components_kernel.cuh"
+
+/**
+ * @file
+ * components_app.cu
+ *
+ * @brief CUDPP application-level connected components routines
+ */
+
+/** \addtogroup cudpp_app
+ * @{
+ */
+
+/** @name Connected Components Functions
+ * @{
+ */
+
+/* Components are found as in Afforest (Sutton et al., 2018): a few
+ * neighbors of every vertex (or a strided sample of an edge list) are
+ * linked first, which already joins most of a large component.  The
+ * component that most of CC_NUM_SAMPLES sampled vertices belong to is
+ * then skipped while the remaining edges are linked, so the edges inside
+ * the giant component of a typical graph are never traversed.
+ */
+
+/** @brief Grid of CC_CTA_SIZE threads per block for \a numItems items
+ *
+ * The kernels loop over their items, so the grid is capped at 65535 blocks.
+ */
+dim3 ccGrid(size_t numItems)
+{
+    size_t numBlocks = (numItems + CC_CTA_SIZE - 1) / CC_CTA_SIZE;
+    if (numBlocks > 65535)
+        numBlocks = 65535;
+    if (numBlocks < 1)
+        numBlocks = 1;
+    return dim3((unsigned int)numBlocks, 1, 1);
+}
+
+/** @brief The most frequent root among the sampled roots
+ *
+ * @param[in,out] samples Roots of the sampled vertices (sorted on return)
+ * @returns The root that occurs most often
+ */
+int ccMostFrequent(int *samples)
+{
+    std::sort(samples, samples + CC_NUM_SAMPLES);
+
+    int best = samples[0], bestCount = 0;
+    for (int i = 0; i < CC_NUM_SAMPLES; )
+    {
+        int j = i;
+        while (j < CC_NUM_SAMPLES && samples[j] == samples[i])
+            ++j;
+        if (j - i > bestCount)
+        {
+            best = samples[i];
+            bestCount = j - i;
+        }
+        i = j;
+    }
+    return best;
+}
+
+/** @brief Label the components on the host
+ *
+ * The links and compressions run in parallel with OpenMP; the labels are
+ * given in one serial pass, since the root of every vertex precedes it.
+ *
+ * @param[in,out] plan Pointer to CUDPPComponentsPlan object
+ * @param[out] labels Component of each vertex
+ * @param[in] rowIndices Offset of the first neighbor of each vertex (CSR), or NULL
+ * @param[in] indices Neighbors of all vertices (CSR)
+ * @param[in] edgeU First vertex of each edge (edge list)
+ * @param[in] edgeV Second vertex of each edge (edge list)
+ * @param[in] numEdges Number of edges (edge list)
+ * @param[in] numVertices Number of vertices
+ * @returns The number of components
+ */
+size_t ccHost(CUDPPComponentsPlan   *plan,
+              int                   *labels,
+              const unsigned int    *rowIndices,
+              const unsigned int    *indices,
+              const int             *edgeU,
+              const int             *edgeV,
+              size_t                numEdges,
+              size_t                numVertices)
+{
+    int *parent = plan->m_d_parent;
+    int n = (int)numVertices;
+    int m = (int)numEdges;
+
+#pragma omp parallel for
+    for (int v = 0; v < n; ++v)
+        parent[v] = v;
+
+    if (rowIndices != NULL)
+    {
+        for (unsigned int round = 0; round < CC_NEIGHBOR_ROUNDS; ++round)
+        {
+#pragma omp parallel for
+            for (int v = 0; v < n; ++v)
+            {
+                unsigned int j = rowIndices[v] + round;
+                if (j < rowIndices[v+1])
+                    ccLink(parent, v, (int)indices[j]);
+            }
+#pragma omp parallel for
+            for (int v = 0; v < n; ++v)
+                ccCompress(parent, v);
+        }
+    }
+    else
+    {
+        int numSampled = (int)((numEdges + CC_EDGE_SAMPLE_STRIDE - 1) / CC_EDGE_SAMPLE_STRIDE);
+#pragma omp parallel for
+        for (int s = 0; s < numSampled; ++s)
+            ccLink(parent, edgeU[s * CC_EDGE_SAMPLE_STRIDE], edgeV[s * CC_EDGE_SAMPLE_STRIDE]);
+#pragma omp parallel for
+        for (int v = 0; v < n; ++v)
+            ccCompress(parent, v);
+    }
+
+    int samples[CC_NUM_SAMPLES];
+    for (unsigned int i = 0; i < CC_NUM_SAMPLES; ++i)
+        samples[i] = parent[ccSampleVertex(i, numVertices)];
+    int skip = ccMostFrequent(samples);
+
+    if (rowIndices != NULL)
+    {
+        // vertex degrees vary, so hand out the vertices in small chunks
+#pragma omp parallel for schedule(dynamic, 1024)
+        for (int v = 0; v < n; ++v)
+        {
+            if (parent[v] == skip)
+                continue;
+            for (unsigned int j = rowIndices[v] + CC_NEIGHBOR_ROUNDS; j < rowIndices[v+1]; ++j)
+                ccLink(parent, v, (int)indices[j]);
+        }
+    }
+    else
+    {
+#pragma omp parallel for
+        for (int e = 0; e < m; ++e)
+        {
+            if (e % CC_EDGE_SAMPLE_STRIDE == 0 ||
+                (parent[edgeU[e]] == skip && parent[edgeV[e]] == skip))
+                continue;
+            ccLink(parent, edgeU[e], edgeV[e]);
+        }
+    }
+
+#pragma omp parallel for
+    for (int v = 0; v < n; ++v)
+        ccCompress(parent, v);
+
+    int numComponents = 0;
+    for (int v = 0; v < n; ++v)
+        labels[v] = (parent[v] == v) ? numComponents++ : labels[parent[v]];
+
+    return (size_t)numComponents;
+}
+
+/** @brief Label the components on the GPU
+ *
+ * The roots are flagged and ranked with an exclusive scan, and every
+ * vertex takes the rank of its root as its label.
+ *
+ * @param[in,out] plan Pointer to CUDPPComponentsPlan object
+ * @param[out] d_labels Component of each vertex
+ * @param[in] d_rowIndices Offset of the first neighbor of each vertex (CSR), or NULL
+ * @param[in] d_indices Neighbors of all vertices (CSR)
+ * @param[in] d_edgeU First vertex of each edge (edge list)
+ * @param[in] d_edgeV Second vertex of each edge (edge list)
+ * @param[in] numEdges Number of edges (edge list)
+ * @param[in] numVertices Number of vertices
+ * @returns The number of components
+ */
+size_t ccDevice(CUDPPComponentsPlan   *plan,
+                int                   *d_labels,
+                const unsigned int    *d_rowIndices,
+                const unsigned int    *d_indices,
+                const int             *d_edgeU,
+                const int             *d_edgeV,
+                size_t                numEdges,
+                size_t                numVertices)
+{
+    int *d_parent = plan->m_d_parent;
+    dim3 grid = ccGrid(numVertices);
+
+    cc_init<<< grid, CC_CTA_SIZE >>>(d_parent, numVertices);
+    CUDA_CHECK_ERROR("cc_init");
+
+    if (d_rowIndices != NULL)
+    {
+        for (unsigned int round = 0; round < CC_NEIGHBOR_ROUNDS; ++round)
+        {
+            cc_link_neighbor<<< grid, CC_CTA_SIZE >>>
+                (d_parent, d_rowIndices, d_indices, round, numVertices);
+            CUDA_CHECK_ERROR("cc_link_neighbor");
+            cc_compress<<< grid, CC_CTA_SIZE >>>(d_parent, numVertices);
+            CUDA_CHECK_ERROR("cc_compress");
+        }
+    }
+    else if (numEdges > 0)
+    {
+        cc_link_edges<<< ccGrid(numEdges), CC_CTA_SIZE >>>
+            (d_parent, d_edgeU, d_edgeV, true, -1, numEdges);
+        CUDA_CHECK_ERROR("cc_link_edges");
+        cc_compress<<< grid, CC_CTA_SIZE >>>(d_parent, numVertices);
+        CUDA_CHECK_ERROR("cc_compress");
+    }
+
+    int samples[CC_NUM_SAMPLES];
+    cc_sample<<< ccGrid(CC_NUM_SAMPLES), CC_CTA_SIZE >>>
+        (plan->m_d_samples, d_parent, numVertices);
+    CUDA_CHECK_ERROR("cc_sample");
+    CUDA_SAFE_CALL(cudaMemcpy(samples, plan->m_d_samples, CC_NUM_SAMPLES * sizeof(int),
+                              cudaMemcpyDeviceToHost));
+    int skip = ccMostFrequent(samples);
+
+    if (d_rowIndices != NULL)
+    {
+        cc_link_remaining<<< grid, CC_CTA_SIZE >>>
+            (d_parent, d_rowIndices, d_indices, skip, numVertices);
+        CUDA_CHECK_ERROR("cc_link_remaining");
+    }
+    else if (numEdges > 0)
+    {
+        cc_link_edges<<< ccGrid(numEdges), CC_CTA_SIZE >>>
+            (d_parent, d_edgeU, d_edgeV, false, skip, numEdges);
+        CUDA_CHECK_ERROR("cc_link_edges");
+    }
+
+    cc_compress<<< grid, CC_CTA_SIZE >>>(d_parent, numVertices);
+    CUDA_CHECK_ERROR("cc_compress");
+
+    // the labels array holds the root flags until the roots are ranked
+    unsigned int *d_flags = (unsigned int*)d_labels;
+    cc_flag_roots<<< grid, CC_CTA_SIZE >>>(d_flags, d_parent, numVertices);
+    CUDA_CHECK_ERROR("cc_flag_roots");
+
+    cudppScanDispatch(plan->m_d_rootRank, d_flags, numVertices, 1, plan->m_scanPlan);
+
+    unsigned int lastRank, lastFlag;
+    CUDA_SAFE_CALL(cudaMemcpy(&lastRank, plan->m_d_rootRank + numVertices - 1,
+                              sizeof(unsigned int), cudaMemcpyDeviceToHost));
+    CUDA_SAFE_CALL(cudaMemcpy(&lastFlag, d_flags + numVertices - 1,
+                              sizeof(unsigned int), cudaMemcpyDeviceToHost));
+
+    cc_label<<< grid, CC_CTA_SIZE >>>(d_labels, d_parent, plan->m_d_rootRank, numVertices);
+    CUDA_CHECK_ERROR("cc_label");
+
+    return (size_t)(lastRank + lastFlag);
+}
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @brief Allocate intermediate arrays used by connected components.
+ *
+ * The union-find parents of the plan's number of vertices are in host
+ * memory with CUDPP_OPTION_HOST.  On the GPU the plan also holds the
+ * ranks of the roots and the sampled roots.
+ *
+ * @param[in,out] plan Pointer to CUDPPComponentsPlan object
+ */
+void allocComponentsStorage(CUDPPComponentsPlan *plan)
+{
+    size_t n = plan->m_numElements;
+    if (n < 1)
+        n = 1;
+
+    if (plan->m_config.options & CUDPP_OPTION_HOST)
+    {
+        plan->m_d_parent = (int*) malloc(n * sizeof(int));
+        return;
+    }
+
+    CUDA_SAFE_CALL(cudaMalloc((void**)&plan->m_d_parent, n * sizeof(int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&plan->m_d_rootRank, n * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&plan->m_d_samples, CC_NUM_SAMPLES * sizeof(int)));
+}
+
+/** @brief Deallocate intermediate arrays in a CUDPPComponentsPlan object.
+ *
+ * @param[in,out] plan Pointer to CUDPPComponentsPlan object initialized by allocComponentsStorage().
+ */
+void freeComponentsStorage(CUDPPComponentsPlan *plan)
+{
+    if (plan->m_config.options & CUDPP_OPTION_HOST)
+    {
+        free(plan->m_d_parent);
+        return;
+    }
+
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_parent));
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_rootRank));
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_samples));
+}
+
+/** @brief Dispatch function to label the connected components of a graph.
+ *
+ * This is the app-level interface used by cudppConnectedComponents() and
+ * cudppConnectedComponentsCSR().  The graph is in CSR form when
+ * \a d_rowIndices is not NULL, and an edge list otherwise.
+ *
+ * @param[in,out] plan Pointer to CUDPPComponentsPlan object
+ * @param[out] d_labels Component of each vertex
+ * @param[in] d_rowIndices Offset of the first neighbor of each vertex (CSR), or NULL
+ * @param[in] d_indices Neighbors of all vertices (CSR)
+ * @param[in] d_edgeU First vertex of each edge (edge list)
+ * @param[in] d_edgeV Second vertex of each edge (edge list)
+ * @param[in] numEdges Number of edges (edge list)
+ * @param[in] numVertices Number of vertices
+ * @returns The number of components
+ */
+size_t cudppConnectedComponentsDispatch(CUDPPComponentsPlan  *plan,
+                                        int                  *d_labels,
+                                        const unsigned int   *d_rowIndices,
+                                        const unsigned int   *d_indices,
+                                        const int            *d_edgeU,
+                                        const int            *d_edgeV,
+                                        size_t               numEdges,
+                                        size_t               numVertices)
+{
+    if (numVertices == 0)
+        return 0;
+
+    if (plan->m_config.options & CUDPP_OPTION_HOST)
+        return ccHost(plan, d_labels, d_rowIndices, d_indices, d_edgeU, d_edgeV,
+                      numEdges, numVertices);
+    else
+        return ccDevice(plan, d_labels, d_rowIndices, d_indices, d_edgeU, d_edgeV,
+                        numEdges, numVertices);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} */ // end connected components functions
+/** @} */ // end cudpp_app
@@ -16,9 +16,23 @@
 #include "cudpp.h"
 #include "cudpp_util.h"
 #include "cudpp_plan.h"
+#include "cudpp_manager.h"
 
 #include "kernel/listrank_kernel.cuh"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#if defined(__GNUC__)
+#define LISTRANK_PREFETCH(p) __builtin_prefetch(p)
+#elif defined(_MSC_VER)
+#include <xmmintrin.h>
+#define LISTRANK_PREFETCH(p) _mm_prefetch((const char*)(p), _MM_HINT_T0)
+#else
+#define LISTRANK_PREFETCH(p)
+#endif
+
 /**
  * @file
  * listrank_app.cu
@@ -34,12 +48,361 @@
  * @{
  */
 
+/** @brief Choose the work decomposition of a list ranking
+ *
+ * The list is split into sublists that are walked in parallel.  Longer
+ * sublists mean less work ranking the sublists themselves, but there
+ * must be enough of them to keep every thread busy with some to spare
+ * for load balance, since sublist lengths vary.  The GPU path wants
+ * LISTRANK_SUBLISTS_PER_THREAD sublists for each thread the device can
+ * keep resident, and the host path LISTRANK_HOST_BATCHES_PER_THREAD
+ * batches of LISTRANK_HOST_INTERLEAVE sublists for each OpenMP thread.
+ * Either way sublists average at most LISTRANK_SUBLIST_LENGTH (GPU) or
+ * LISTRANK_HOST_SUBLIST_LENGTH (host) and at least
+ * LISTRANK_MIN_SUBLIST_LENGTH nodes, and there are at most
+ * \a maxSublists.  A list scan adds one sublist for each of its
+ * \a numHeads lists.
+ *
+ * @param[out] stats The number of sublists and of threads that walk them
+ * @param[in]  numElements Number of nodes to rank
+ * @param[in]  numHeads Number of list heads, 0 for list ranking
+ * @param[in]  maxSublists Largest number of ruling set sublists
+ * @param[in]  plan Pointer to CUDPPListRankPlan object
+ */
+void listRankDecomposition(CUDPPListRankStats      &stats,
+                           size_t                  numElements,
+                           size_t                  numHeads,
+                           size_t                  maxSublists,
+                           const CUDPPListRankPlan *plan)
+{
+    size_t numSublists;
+    size_t numThreads;
+
+    if (plan->m_config.options & CUDPP_OPTION_HOST)
+    {
+#ifdef _OPENMP
+        numThreads = omp_get_max_threads();
+#else
+        numThreads = 1;
+#endif
+        numSublists = numThreads * LISTRANK_HOST_INTERLEAVE * LISTRANK_HOST_BATCHES_PER_THREAD;
+        if (numSublists < numElements / LISTRANK_HOST_SUBLIST_LENGTH)
+            numSublists = numElements / LISTRANK_HOST_SUBLIST_LENGTH;
+    }
+    else
+    {
+        cudaDeviceProp prop;
+        plan->m_planManager->getDeviceProps(prop);
+        numThreads = (size_t)prop.multiProcessorCount * prop.maxThreadsPerMultiProcessor;
+        numSublists = numThreads * LISTRANK_SUBLISTS_PER_THREAD;
+        if (numSublists < numElements / LISTRANK_SUBLIST_LENGTH)
+            numSublists = numElements / LISTRANK_SUBLIST_LENGTH;
+    }
+
+    if (numSublists > numElements / LISTRANK_MIN_SUBLIST_LENGTH)
+        numSublists = numElements / LISTRANK_MIN_SUBLIST_LENGTH;
+    if (numSublists > maxSublists)
+        numSublists = maxSublists;
+    if (numSublists < 1)
+        numSublists = 1;
+    numSublists += numHeads;
+
+    if (plan->m_config.options & CUDPP_OPTION_HOST)
+    {
+        size_t numBatches = (numSublists + LISTRANK_HOST_INTERLEAVE - 1) / LISTRANK_HOST_INTERLEAVE;
+        if (numThreads > numBatches)
+            numThreads = numBatches;
+    }
+    else
+    {
+        size_t numBlocks = (numSublists + LISTRANK_CTA_SIZE - 1) / LISTRANK_CTA_SIZE;
+        if (numBlocks > 65535)
+            numBlocks = 65535;
+        numThreads = numBlocks * LISTRANK_CTA_SIZE;
+    }
+
+    stats.numElements = numElements;
+    stats.numSublists = numSublists;
+    stats.numThreads = numThreads;
+}
+
+/** @brief Rank the first nodes of the sublists of a ruling set
+ *
+ * Follows the sublist successors from sublist 0, which starts at the
+ * list head, adding up the sublist lengths.  Sublists that are not
+ * reached get offset -1.  The sublist arrays are in host memory.
+ *
+ * @param[in] numSublists Number of sublists
+ * @param[in] plan Pointer to CUDPPListRankPlan object holding the sublist arrays
+ */
+void listRankSublistOffsets(size_t numSublists, const CUDPPListRankPlan *plan)
+{
+    for (size_t j = 0; j < numSublists; ++j)
+        plan->m_sublistOffset[j] = (size_t)-1;
+
+    size_t rank = 0;
+    for (int j = 0; j >= 0; j = plan->m_sublistSuccessor[j])
+    {
+        plan->m_sublistOffset[j] = rank;
+        rank += plan->m_sublistLength[j];
+    }
+}
+
+/** @brief Free the sublist arrays of a list ranking plan
+ *
+ * @param[in,out] plan Pointer to CUDPPListRankPlan object
+ */
+void freeListRankSublists(CUDPPListRankPlan *plan)
+{
+    if(plan->m_d_sublistHead != NULL) CUDA_SAFE_CALL(cudaFree(plan->m_d_sublistHead));
+    if(plan->m_d_sublistSuccessor != NULL) CUDA_SAFE_CALL(cudaFree(plan->m_d_sublistSuccessor));
+    if(plan->m_d_sublistLength != NULL) CUDA_SAFE_CALL(cudaFree(plan->m_d_sublistLength));
+    if(plan->m_d_sublistOffset != NULL) CUDA_SAFE_CALL(cudaFree(plan->m_d_sublistOffset));
+
+    free(plan->m_sublistHead);
+    free(plan->m_sublistNext);
+    free(plan->m_sublistSuccessor);
+    free(plan->m_sublistLength);
+    free(plan->m_sublistOffset);
+
+    plan->m_d_sublistHead = NULL;
+    plan->m_d_sublistSuccessor = NULL;
+    plan->m_d_sublistLength = NULL;
+    plan->m_d_sublistOffset = NULL;
+    plan->m_sublistHead = NULL;
+    plan->m_sublistNext = NULL;
+    plan->m_sublistSuccessor = NULL;
+    plan->m_sublistLength = NULL;
+    plan->m_sublistOffset = NULL;
+    plan->m_numSublists = 0;
+}
+
+/** @brief Make room for \a numSublists sublists in a list ranking plan
+ *
+ * The sublist arrays only grow: list scans of forests need one sublist
+ * per list on top of the ruling set, and later calls reuse the storage.
+ * The GPU path needs the heads, successors, lengths and offsets on the
+ * device, and the successors, lengths and offsets on the host to rank
+ * the sublist heads; the host path needs all of them on the host.
+ *
+ * @param[in,out] plan Pointer to CUDPPListRankPlan object
+ * @param[in] numSublists Number of sublists
+ */
+void reserveListRankSublists(CUDPPListRankPlan *plan, size_t numSublists)
+{
+    if (numSublists <= plan->m_numSublists)
+        return;
+
+    freeListRankSublists(plan);
+    plan->m_numSublists = numSublists;
+
+    plan->m_sublistSuccessor = (int*)    malloc(numSublists * sizeof(int));
+    plan->m_sublistLength    = (size_t*) malloc(numSublists * sizeof(size_t));
+    plan->m_sublistOffset    = (size_t*) malloc(numSublists * sizeof(size_t));
+
+    if (plan->m_config.options & CUDPP_OPTION_HOST)
+    {
+        plan->m_sublistHead = (int*) malloc(numSublists * sizeof(int));
+        plan->m_sublistNext = (int*) malloc(numSublists * sizeof(int));
+        return;
+    }
+
+    CUDA_SAFE_CALL(cudaMalloc( (void**) &(plan->m_d_sublistHead),       numSublists*sizeof(int) ));
+    CUDA_SAFE_CALL(cudaMalloc( (void**) &(plan->m_d_sublistSuccessor),  numSublists*sizeof(int) ));
+    CUDA_SAFE_CALL(cudaMalloc( (void**) &(plan->m_d_sublistLength),     numSublists*sizeof(size_t) ));
+    CUDA_SAFE_CALL(cudaMalloc( (void**) &(plan->m_d_sublistOffset),     numSublists*sizeof(size_t) ));
+}
+
+/** @brief Walk a batch of sublists of the host ruling set
+ *
+ * Walks sublists \a first to \a last - 1 of the ruling set together,
+ * advancing each by one node in turn and prefetching the node after it,
+ * so that the cache misses of the walks overlap.  A walk stops at the
+ * tail of the list or at the head of another sublist, whose next index
+ * listRankHost() has replaced with -2 minus that sublist.
+ *
+ * With \a WRITE false the length and successor of each sublist are
+ * recorded in the plan; with \a WRITE true each value is written at its
+ * rank, starting from the rank of the sublist head.
+ *
+ * @param[out] ranked_values Ranked values array (only when \a WRITE)
+ * @param[in]  unranked_values Unranked values array
+ * @param[in]  next_indices Next indices array, with the sublist heads marked
+ * @param[in]  first First sublist of the batch
+ * @param[in]  last One past the last sublist of the batch
+ * @param[in]  plan Pointer to CUDPPListRankPlan object holding the sublist arrays
+ */
+template <typename T, bool WRITE>
+void walkListRankSublists(T                        *ranked_values,
+                          const T                  *unranked_values,
+                          const int                *next_indices,
+                          size_t                   first,
+                          size_t                   last,
+                          const CUDPPListRankPlan  *plan)
+{
+    int    node[LISTRANK_HOST_INTERLEAVE];
+    size_t rank[LISTRANK_HOST_INTERLEAVE];
+    size_t numWalks = last - first;
+    size_t numActive = 0;
+
+    for (size_t w = 0; w < numWalks; ++w)
+    {
+        size_t j = first + w;
+        node[w] = -1;
+        if (WRITE)
+        {
+            // sublists that are not reached from the list head have no rank
+            if (plan->m_sublistOffset[j] == (size_t)-1)
+                continue;
+            rank[w] = plan->m_sublistOffset[j];
+            ranked_values[rank[w]++] = unranked_values[plan->m_sublistHead[j]];
+        }
+        else
+        {
+            rank[w] = 1;
+            plan->m_sublistSuccessor[j] = -1;
+        }
+        node[w] = plan->m_sublistNext[j];
+        if (node[w] >= 0)
+        {
+            LISTRANK_PREFETCH(&next_indices[node[w]]);
+            ++numActive;
+        }
+    }
+
+    while (numActive > 0)
+    {
+        for (size_t w = 0; w < numWalks; ++w)
+        {
+            int i = node[w];
+            if (i < 0)
+                continue;
+
+            int next = next_indices[i];
+            if (next <= -2)
+            {
+                // i is the head of the sublist that follows
+                if (!WRITE)
+                    plan->m_sublistSuccessor[first + w] = -2 - next;
+                node[w] = -1;
+                --numActive;
+                continue;
+            }
+
+            if (WRITE)
+                ranked_values[rank[w]] = unranked_values[i];
+            ++rank[w];
+
+            node[w] = next;
+            if (next >= 0)
+            {
+                LISTRANK_PREFETCH(&next_indices[next]);
+                if (WRITE)
+                    LISTRANK_PREFETCH(&unranked_values[next]);
+            }
+            else
+                --numActive;
+        }
+    }
+
+    if (!WRITE)
+    {
+        for (size_t w = 0; w < numWalks; ++w)
+            plan->m_sublistLength[first + w] = rank[w];
+    }
+}
+
+/** @brief List ranking on the host with a sparse ruling set
+ *
+ * Helman and JaJa's algorithm: the list head and evenly spaced nodes
+ * split the list into the sublists chosen by listRankDecomposition().
+ * The sublists are walked in parallel for their lengths and successors,
+ * the sublist heads are ranked by a serial walk over the sublists, and a
+ * second parallel walk writes every value at its rank.  The work is O(n)
+ * and the extra storage one record per sublist.
+ *
+ * The sublist heads are marked by temporarily replacing their next
+ * indices, which are restored before returning.  Called by listRank()
+ * for plans with CUDPP_OPTION_HOST.
+ *
+ * @param[out] ranked_values Ranked values array, in host memory
+ * @param[in]  unranked_values Unranked values array, in host memory
+ * @param[in,out] next_indices Next indices array, in host memory
+ * @param[in]  head Head pointer index
+ * @param[in]  numElements Number of nodes values to rank
+ * @param[in]  plan Pointer to CUDPPListRankPlan object holding the sublist arrays
+ */
+template <typename T>
+void listRankHost(T                         *ranked_values,
+                  const T                   *unranked_values,
+                  int                       *next_indices,
+                  size_t                    head,
+                  size_t                    numElements,
+                  CUDPPListRankPlan         *plan)
+{
+    listRankDecomposition(plan->m_stats, numElements, 0, plan->m_numSublists, plan);
+    if (numElements == 0)
+        return;
+
+    // The sublist heads are the list head and evenly spaced nodes
+    size_t s = plan->m_stats.numSublists;
+    size_t stride = numElements / s;
+
+    // Mark each sublist head by replacing its next index with -2 minus its sublist
+    for (size_t j = 0; j < s; ++j)
+    {
+        int i = (int)listRankSublistHead(j, stride, head);
+        plan->m_sublistHead[j] = i;
+        plan->m_sublistNext[j] = next_indices[i];
+        next_indices[i] = -2 - (int)j;
+    }
+
+    int numBatches = (int)((s + LISTRANK_HOST_INTERLEAVE - 1) / LISTRANK_HOST_INTERLEAVE);
+    int numThreads = (int)plan->m_stats.numThreads;
+
+    // Lengths and successors of the sublists
+#pragma omp parallel for schedule(dynamic) num_threads(numThreads)
+    for (int b = 0; b < numBatches; ++b)
+    {
+        size_t first = (size_t)b * LISTRANK_HOST_INTERLEAVE;
+        size_t last = (first + LISTRANK_HOST_INTERLEAVE < s) ? first + LISTRANK_HOST_INTERLEAVE : s;
+        walkListRankSublists<T, false>(NULL, unranked_values, next_indices,
+                                       first, last, plan);
+    }
+
+    // Rank the sublist heads in list order
+    listRankSublistOffsets(s, plan);
+
+    // Write every value at its rank
+#pragma omp parallel for schedule(dynamic) num_threads(numThreads)
+    for (int b = 0; b < numBatches; ++b)
+    {
+        size_t first = (size_t)b * LISTRANK_HOST_INTERLEAVE;
+        size_t last = (first + LISTRANK_HOST_INTERLEAVE < s) ? first + LISTRANK_HOST_INTERLEAVE : s;
+        walkListRankSublists<T, true>(ranked_values, unranked_values, next_indices,
+                                      first, last, plan);
+    }
+
+    for (size_t j = 0; j < s; ++j)
+        next_indices[plan->m_sublistHead[j]] = plan->m_sublistNext[j];
+}
+
 /** @brief Launch list ranking
  * 
  * Given two inputs arrays, \a d_unranked_values and \a d_next_indices,
  * listRank() outputs a ranked version of the unranked values by traversing
  * the next indices. The head index is \a head. Called by ::cudppListRankDispatch().
  *
+ * The list is ranked with a sparse ruling set, like listRankHost(): the
+ * list head and evenly spaced nodes split the list into the sublists
+ * chosen by listRankDecomposition(), one GPU thread walks each sublist
+ * for its length and successor, the sublist heads are ranked on the
+ * host, and a second walk writes every value at its rank.  The sublist
+ * heads are marked in a copy of the next indices, so \a d_next_indices
+ * is not modified.
+ *
+ * Plans with CUDPP_OPTION_HOST rank the list on the host with listRankHost().
+ *
  * @param[out] d_ranked_values Ranked values array
  * @param[in]  d_unranked_values Unranked values array
  * @param[in]  d_next_indices Next indices array
@@ -54,68 +417,503 @@ void listRank(T                         *d_ranked_values,
               int                       *d_next_indices,
               size_t                    head,
               size_t                    numElements,
-              const CUDPPListRankPlan   *plan)
+              CUDPPListRankPlan         *plan)
 {
-    int step = 1;
-    int cnt = 1;
-    int* d_tmp = d_next_indices;
+    if (plan->m_config.options & CUDPP_OPTION_HOST)
+    {
+        listRankHost<T>(d_ranked_values, d_unranked_values, d_next_indices,
+                        head, numElements, plan);
+        return;
+    }
 
-    // thread info -- kernel1
-    int nThreads = LISTRANK_CTA_BLOCK;
-    int tThreads = LISTRANK_TOTAL;
-    int nBlocks  = tThreads/LISTRANK_CTA_BLOCK;
+    listRankDecomposition(plan->m_stats, numElements, 0, plan->m_numSublists, plan);
+    if (numElements == 0)
+        return;
+
+    size_t numSublists = plan->m_stats.numSublists;
+    size_t stride = numElements / numSublists;
 
-    dim3 grid_construct   (nBlocks,  1, 1);
-    dim3 threads_construct(nThreads, 1, 1);
+    dim3 grid((unsigned int)(plan->m_stats.numThreads / LISTRANK_CTA_SIZE), 1, 1);
+    dim3 threads(LISTRANK_CTA_SIZE, 1, 1);
 
-    // thread info -- kernel2
-    tThreads = LISTRANK_MAX;
-    nBlocks = tThreads/LISTRANK_CTA_BLOCK;
-    dim3 grid_construct2   (nBlocks,  1, 1);
-    dim3 threads_construct2(nThreads, 1, 1);
+    CUDA_SAFE_CALL(cudaMemcpy(plan->m_d_next, d_next_indices, numElements * sizeof(int),
+                              cudaMemcpyDeviceToDevice));
+    list_rank_mark_sublists<<< grid, threads >>>
+        (plan->m_d_next, plan->m_d_sublistHead, head, stride, numSublists);
+    CUDA_CHECK_ERROR("list_rank_mark_sublists");
 
+    // Lengths and successors of the sublists
+    list_rank_walk_sublists<T, false><<< grid, threads >>>
+        ((T*)NULL, d_unranked_values, d_next_indices, plan->m_d_next,
+         plan->m_d_sublistHead, plan->m_d_sublistSuccessor,
+         plan->m_d_sublistLength, (const size_t*)NULL, numSublists);
+    CUDA_CHECK_ERROR("list_rank_walk_sublists");
 
-    while(step<LISTRANK_MAX)
-    {
-        // Each step doubles the number of threads added to pointer "chase"
-        if(cnt%2 == 1)
-        {
-            // ping
-            list_rank_kernel_soa_1<T><<< grid_construct, threads_construct >>>
-                (d_ranked_values, d_unranked_values, d_tmp,
-                plan->m_d_tmp1, plan->m_d_tmp2, step, head, numElements);
-            d_tmp = plan->m_d_tmp3;
-        }
-        else
-        {
-            // pong
-            list_rank_kernel_soa_1<T><<< grid_construct, threads_construct >>>
-                (d_ranked_values, d_unranked_values, plan->m_d_tmp1,
-                d_tmp, plan->m_d_tmp2, step, head, numElements);
-        }
-        step *= 2;
-        cnt++;
-    }
+    // Rank the sublist heads on the host
+    CUDA_SAFE_CALL(cudaMemcpy(plan->m_sublistSuccessor, plan->m_d_sublistSuccessor,
+                              numSublists * sizeof(int), cudaMemcpyDeviceToHost));
+    CUDA_SAFE_CALL(cudaMemcpy(plan->m_sublistLength, plan->m_d_sublistLength,
+                              numSublists * sizeof(size_t), cudaMemcpyDeviceToHost));
+    listRankSublistOffsets(numSublists, plan);
+    CUDA_SAFE_CALL(cudaMemcpy(plan->m_d_sublistOffset, plan->m_sublistOffset,
+                              numSublists * sizeof(size_t), cudaMemcpyHostToDevice));
 
-    // Out of threads to dispatch, each thread now keeps chasing pointer until
-    // all lists are ranked
-    if(LISTRANK_MAX < numElements)
-    {
-        if(cnt%2 == 0)
-        {
-            list_rank_kernel_soa_2<T><<< grid_construct2, threads_construct2 >>>
-                (d_ranked_values, d_unranked_values, plan->m_d_tmp1, plan->m_d_tmp2, head, numElements);
-            CUDA_SAFE_CALL(cudaThreadSynchronize());
-        }
-        else
-        {
-            list_rank_kernel_soa_2<T><<< grid_construct2, threads_construct2 >>>
-                (d_ranked_values, d_unranked_values, d_tmp, plan->m_d_tmp2, head, numElements);
-            CUDA_SAFE_CALL(cudaThreadSynchronize());
-        }
+    // Write every value at its rank
+    list_rank_walk_sublists<T, true><<< grid, threads >>>
+        (d_ranked_values, d_unranked_values, d_next_indices, plan->m_d_next,
+         plan->m_d_sublistHead, (int*)NULL, (size_t*)NULL,
+         plan->m_d_sublistOffset, numSublists);
+    CUDA_CHECK_ERROR("list_rank_walk_sublists");
+}
+
+/** @brief Walk a batch of sublists of a host list scan
+ *
+ * Like walkListRankSublists(), walks sublists \a first to \a last - 1
+ * together so that their cache misses overlap.  Sublists whose first
+ * node is -1 are empty.  The sublist values live in the plan's sublist
+ * length array, which is large enough for any supported type.
+ *
+ * With \a WRITE false each sublist is reduced with \a Oper and its
+ * successor recorded; with \a WRITE true the sublists reached from a
+ * list head, flagged in the successor array by listScanSublistCarries(),
+ * are scanned starting from their carry-in and the prefix of each node
+ * is written at that node.
+ *
+ * @param[out] out Prefix values (only when \a WRITE)
+ * @param[in]  in Input values
+ * @param[in]  next_indices Next indices array, with the sublist heads marked
+ * @param[in]  first First sublist of the batch
+ * @param[in]  last One past the last sublist of the batch
+ * @param[in]  exclusive Whether the prefix of a node excludes its own value
+ * @param[in]  plan Pointer to CUDPPListRankPlan object holding the sublist arrays
+ */
+template <typename T, class Oper, bool WRITE>
+void walkListScanSublists(T                        *out,
+                          const T                  *in,
+                          const int                *next_indices,
+                          size_t                   first,
+                          size_t                   last,
+                          bool                     exclusive,
+                          const CUDPPListRankPlan  *plan)
+{
+    Oper   op;
+    T      *sublistValue = (T*)plan->m_sublistLength;
+    int    node[LISTRANK_HOST_INTERLEAVE];
+    T      value[LISTRANK_HOST_INTERLEAVE];
+    size_t numWalks = last - first;
+    size_t numActive = 0;
+
+    for (size_t w = 0; w < numWalks; ++w)
+    {
+        size_t j = first + w;
+        int i = plan->m_sublistHead[j];
+        node[w] = -1;
+        if (!WRITE)
+            plan->m_sublistSuccessor[j] = -1;
+        if (i < 0 || (WRITE && !plan->m_sublistSuccessor[j]))
+            continue;
+
+        if (WRITE)
+        {
+            T carry = sublistValue[j];
+            value[w] = op(carry, in[i]);
+            out[i] = exclusive ? carry : value[w];
+        }
+        else
+            value[w] = in[i];
+
+        node[w] = plan->m_sublistNext[j];
+        if (node[w] >= 0)
+        {
+            LISTRANK_PREFETCH(&next_indices[node[w]]);
+            ++numActive;
+        }
+    }
+
+    while (numActive > 0)
+    {
+        for (size_t w = 0; w < numWalks; ++w)
+        {
+            int i = node[w];
+            if (i < 0)
+                continue;
+
+            int next = next_indices[i];
+            if (next <= -2)
+            {
+                // i is the first node of the sublist that follows
+                if (!WRITE)
+                    plan->m_sublistSuccessor[first + w] = -2 - next;
+                node[w] = -1;
+                --numActive;
+                continue;
+            }
+
+            T carry = value[w];
+            value[w] = op(carry, in[i]);
+            if (WRITE)
+                out[i] = exclusive ? carry : value[w];
+
+            node[w] = next;
+            if (next >= 0)
+            {
+                LISTRANK_PREFETCH(&next_indices[next]);
+                LISTRANK_PREFETCH(&in[next]);
+            }
+            else
+                --numActive;
+        }
+    }
+
+    if (!WRITE)
+    {
+        for (size_t w = 0; w < numWalks; ++w)
+        {
+            if (plan->m_sublistHead[first + w] >= 0)
+                sublistValue[first + w] = value[w];
+        }
     }
 }
 
+/** @brief Compute the carry-in of every sublist of a list scan
+ *
+ * Follows the sublist successors from each list head, sublists 0 to
+ * \a numHeads - 1, replacing each sublist reduction with the reduction
+ * of the sublists before it in its list.  A list ends at its tail or
+ * where it runs into the head of another list.  Afterwards the
+ * successor array flags the sublists that were reached, which are the
+ * ones the second walk scans.  The sublist arrays are in host memory.
+ *
+ * @param[in] numHeads Number of lists
+ * @param[in] numSublists Number of sublists
+ * @param[in] plan Pointer to CUDPPListRankPlan object holding the sublist arrays
+ */
+template <typename T, class Oper>
+void listScanSublistCarries(size_t numHeads, size_t numSublists,
+                            const CUDPPListRankPlan *plan)
+{
+    Oper op;
+    T    *sublistValue = (T*)plan->m_sublistLength;
+    int  *successor = plan->m_sublistSuccessor;
+
+    for (size_t h = 0; h < numHeads; ++h)
+    {
+        T carry = op.identity();
+        for (int j = (int)h; j >= 0; )
+        {
+            T reduction = sublistValue[j];
+            sublistValue[j] = carry;
+            carry = op(carry, reduction);
+
+            int next = successor[j];
+            successor[j] = -2;
+            j = (next >= (int)numHeads && successor[next] != -2) ? next : -1;
+        }
+    }
+
+    for (size_t j = 0; j < numSublists; ++j)
+        successor[j] = (successor[j] == -2);
+}
+
+/** @brief List scan on the host with a sparse ruling set
+ *
+ * Each list head starts a sublist, and evenly spaced nodes that are not
+ * heads start the rest of the sublists chosen by listRankDecomposition().
+ * The sublists are reduced in parallel, the carry-in of each sublist is
+ * computed by listScanSublistCarries(), and a second parallel walk
+ * writes the prefix of every node.  The list heads are found as the
+ * nodes that are no node's successor when \a heads is NULL.
+ *
+ * The sublist heads are marked by temporarily replacing their next
+ * indices, which are restored before returning.  Called by listScan()
+ * for plans with CUDPP_OPTION_HOST.
+ *
+ * @param[out] out Prefix values, in host memory
+ * @param[in]  in Input values, in host memory
+ * @param[in,out] next_indices Next indices array, in host memory
+ * @param[in]  heads Heads of the lists, in host memory, or NULL
+ * @param[in]  numHeads Number of heads in \a heads
+ * @param[in]  numElements Number of nodes
+ * @param[in]  exclusive Whether the prefix of a node excludes its own value
+ * @param[in]  plan Pointer to CUDPPListRankPlan object holding the sublist arrays
+ */
+template <typename T, class Oper>
+void listScanHost(T                         *out,
+                  const T                   *in,
+                  int                       *next_indices,
+                  const int                 *heads,
+                  size_t                    numHeads,
+                  size_t                    numElements,
+                  bool                      exclusive,
+                  CUDPPListRankPlan         *plan)
+{
+    if (numElements == 0)
+    {
+        listRankDecomposition(plan->m_stats, 0, 0, 0, plan);
+        return;
+    }
+
+    char *isSuccessor = NULL;
+    if (heads == NULL)
+    {
+        isSuccessor = (char*)calloc(numElements, sizeof(char));
+        for (size_t i = 0; i < numElements; ++i)
+        {
+            if (next_indices[i] >= 0)
+                isSuccessor[next_indices[i]] = 1;
+        }
+        numHeads = 0;
+        for (size_t i = 0; i < numElements; ++i)
+            numHeads += !isSuccessor[i];
+    }
+
+    listRankDecomposition(plan->m_stats, numElements, numHeads, (size_t)-1, plan);
+    size_t s = plan->m_stats.numSublists;
+    size_t numSplitters = s - numHeads;
+    size_t stride = numElements / numSplitters;
+    reserveListRankSublists(plan, s);
+
+    if (heads == NULL)
+    {
+        size_t h = 0;
+        for (size_t i = 0; i < numElements; ++i)
+        {
+            if (!isSuccessor[i])
+                plan->m_sublistHead[h++] = (int)i;
+        }
+        free(isSuccessor);
+    }
+    else
+    {
+        for (size_t h = 0; h < numHeads; ++h)
+            plan->m_sublistHead[h] = heads[h];
+    }
+
+    // Mark the list heads, then the splitters that are not list heads
+    for (size_t j = 0; j < numHeads; ++j)
+    {
+        int i = plan->m_sublistHead[j];
+        plan->m_sublistNext[j] = next_indices[i];
+        next_indices[i] = -2 - (int)j;
+    }
+    for (size_t k = 0; k < numSplitters; ++k)
+    {
+        size_t j = numHeads + k;
+        int i = (int)(k * stride);
+        if (next_indices[i] <= -2)
+        {
+            plan->m_sublistHead[j] = -1;
+            continue;
+        }
+        plan->m_sublistHead[j] = i;
+        plan->m_sublistNext[j] = next_indices[i];
+        next_indices[i] = -2 - (int)j;
+    }
+
+    int numBatches = (int)((s + LISTRANK_HOST_INTERLEAVE - 1) / LISTRANK_HOST_INTERLEAVE);
+    int numThreads = (int)plan->m_stats.numThreads;
+
+    // Reductions and successors of the sublists
+#pragma omp parallel for schedule(dynamic) num_threads(numThreads)
+    for (int b = 0; b < numBatches; ++b)
+    {
+        size_t first = (size_t)b * LISTRANK_HOST_INTERLEAVE;
+        size_t last = (first + LISTRANK_HOST_INTERLEAVE < s) ? first + LISTRANK_HOST_INTERLEAVE : s;
+        walkListScanSublists<T, Oper, false>(NULL, in, next_indices,
+                                             first, last, exclusive, plan);
+    }
+
+    listScanSublistCarries<T, Oper>(numHeads, s, plan);
+
+    // Write the prefix of every node
+#pragma omp parallel for schedule(dynamic) num_threads(numThreads)
+    for (int b = 0; b < numBatches; ++b)
+    {
+        size_t first = (size_t)b * LISTRANK_HOST_INTERLEAVE;
+        size_t last = (first + LISTRANK_HOST_INTERLEAVE < s) ? first + LISTRANK_HOST_INTERLEAVE : s;
+        walkListScanSublists<T, Oper, true>(out, in, next_indices,
+                                            first, last, exclusive, plan);
+    }
+
+    for (size_t j = 0; j < s; ++j)
+    {
+        if (plan->m_sublistHead[j] >= 0)
+            next_indices[plan->m_sublistHead[j]] = plan->m_sublistNext[j];
+    }
+}
+
+/** @brief Launch a list scan
+ *
+ * Scans every list of a forest of linked lists in list order with the
+ * operator \a Oper, writing the prefix of each node at that node's
+ * index in \a d_out.  The lists start at the \a numHeads nodes in
+ * \a d_heads, or at the nodes that are no node's successor when
+ * \a d_heads is NULL; a list ends at a node whose next index is -1 or
+ * at the node before another list's head.  Called by
+ * ::cudppListScanDispatch().
+ *
+ * The forest is scanned with the sparse ruling set of listRank(): each
+ * list head and evenly spaced nodes that are not heads start the
+ * sublists, one GPU thread reduces each sublist, the carry-in of every
+ * sublist is computed on the host, and a second walk writes the
+ * prefixes.  \a d_next_indices is not modified.
+ *
+ * Plans with CUDPP_OPTION_HOST scan the lists on the host with listScanHost().
+ *
+ * @param[out] d_out Prefix values
+ * @param[in]  d_in Input values
+ * @param[in]  d_next_indices Next indices array
+ * @param[in]  d_heads Heads of the lists, or NULL
+ * @param[in]  numHeads Number of heads in \a d_heads
+ * @param[in]  numElements Number of nodes
+ * @param[in]  plan     Pointer to CUDPPListRankPlan object containing
+ *                      list ranking options and intermediate storage
+ */
+template <typename T, class Oper>
+void listScan(T                         *d_out,
+              const T                   *d_in,
+              int                       *d_next_indices,
+              const int                 *d_heads,
+              size_t                    numHeads,
+              size_t                    numElements,
+              CUDPPListRankPlan         *plan)
+{
+    bool exclusive = (plan->m_config.options & CUDPP_OPTION_EXCLUSIVE) != 0;
+
+    if (plan->m_config.options & CUDPP_OPTION_HOST)
+    {
+        listScanHost<T, Oper>(d_out, d_in, d_next_indices, d_heads, numHeads,
+                              numElements, exclusive, plan);
+        return;
+    }
+
+    if (numElements == 0)
+    {
+        listRankDecomposition(plan->m_stats, 0, 0, 0, plan);
+        return;
+    }
+
+    // Enough threads for one node each, then one sublist each
+    listRankDecomposition(plan->m_stats, numElements, 0, (size_t)-1, plan);
+    dim3 grid((unsigned int)(plan->m_stats.numThreads / LISTRANK_CTA_SIZE), 1, 1);
+    dim3 threads(LISTRANK_CTA_SIZE, 1, 1);
+
+    if (d_heads == NULL)
+    {
+        // Count the nodes that are no node's successor
+        unsigned int h_numHeads;
+        CUDA_SAFE_CALL(cudaMemset(plan->m_d_next, 0, numElements * sizeof(int)));
+        CUDA_SAFE_CALL(cudaMemset(plan->m_d_numHeads, 0, sizeof(unsigned int)));
+        list_scan_flag_successors<<< grid, threads >>>
+            (plan->m_d_next, d_next_indices, numElements);
+        CUDA_CHECK_ERROR("list_scan_flag_successors");
+        list_scan_find_heads<<< grid, threads >>>
+            ((int*)NULL, plan->m_d_numHeads, plan->m_d_next, numElements);
+        CUDA_CHECK_ERROR("list_scan_find_heads");
+        CUDA_SAFE_CALL(cudaMemcpy(&h_numHeads, plan->m_d_numHeads, sizeof(unsigned int),
+                                  cudaMemcpyDeviceToHost));
+        numHeads = h_numHeads;
+    }
+
+    listRankDecomposition(plan->m_stats, numElements, numHeads, (size_t)-1, plan);
+    size_t numSublists = plan->m_stats.numSublists;
+    size_t numSplitters = numSublists - numHeads;
+    size_t stride = numElements / numSplitters;
+    reserveListRankSublists(plan, numSublists);
+
+    if (d_heads == NULL)
+    {
+        // Gather the heads, in no particular order
+        CUDA_SAFE_CALL(cudaMemset(plan->m_d_numHeads, 0, sizeof(unsigned int)));
+        list_scan_find_heads<<< grid, threads >>>
+            (plan->m_d_sublistHead, plan->m_d_numHeads, plan->m_d_next, numElements);
+        CUDA_CHECK_ERROR("list_scan_find_heads");
+    }
+    else if (numHeads > 0)
+    {
+        CUDA_SAFE_CALL(cudaMemcpy(plan->m_d_sublistHead, d_heads, numHeads * sizeof(int),
+                                  cudaMemcpyDeviceToDevice));
+    }
+
+    grid.x = (unsigned int)(plan->m_stats.numThreads / LISTRANK_CTA_SIZE);
+
+    CUDA_SAFE_CALL(cudaMemcpy(plan->m_d_next, d_next_indices, numElements * sizeof(int),
+                              cudaMemcpyDeviceToDevice));
+    list_scan_mark_heads<<< grid, threads >>>
+        (plan->m_d_next, plan->m_d_sublistHead, numHeads);
+    CUDA_CHECK_ERROR("list_scan_mark_heads");
+    list_scan_mark_splitters<<< grid, threads >>>
+        (plan->m_d_next, plan->m_d_sublistHead, numHeads, stride, numSplitters);
+    CUDA_CHECK_ERROR("list_scan_mark_splitters");
+
+    // Reductions and successors of the sublists
+    list_scan_walk_sublists<T, Oper, false><<< grid, threads >>>
+        ((T*)NULL, d_in, d_next_indices, plan->m_d_next, plan->m_d_sublistHead,
+         plan->m_d_sublistSuccessor, (T*)plan->m_d_sublistLength, numSublists, exclusive);
+    CUDA_CHECK_ERROR("list_scan_walk_sublists");
+
+    // Carry-in of every sublist on the host
+    CUDA_SAFE_CALL(cudaMemcpy(plan->m_sublistSuccessor, plan->m_d_sublistSuccessor,
+                              numSublists * sizeof(int), cudaMemcpyDeviceToHost));
+    CUDA_SAFE_CALL(cudaMemcpy(plan->m_sublistLength, plan->m_d_sublistLength,
+                              numSublists * sizeof(T), cudaMemcpyDeviceToHost));
+    listScanSublistCarries<T, Oper>(numHeads, numSublists, plan);
+    CUDA_SAFE_CALL(cudaMemcpy(plan->m_d_sublistSuccessor, plan->m_sublistSuccessor,
+                              numSublists * sizeof(int), cudaMemcpyHostToDevice));
+    CUDA_SAFE_CALL(cudaMemcpy(plan->m_d_sublistLength, plan->m_sublistLength,
+                              numSublists * sizeof(T), cudaMemcpyHostToDevice));
+
+    // Write the prefix of every node
+    list_scan_walk_sublists<T, Oper, true><<< grid, threads >>>
+        (d_out, d_in, d_next_indices, plan->m_d_next, plan->m_d_sublistHead,
+         plan->m_d_sublistSuccessor, (T*)plan->m_d_sublistLength, numSublists, exclusive);
+    CUDA_CHECK_ERROR("list_scan_walk_sublists");
+}
+
+/** @brief Dispatch a list scan for the operator in the plan's configuration
+ *
+ * @param[out] d_out Prefix values
+ * @param[in]  d_in Input values
+ * @param[in]  d_next_indices Next indices array
+ * @param[in]  d_heads Heads of the lists, or NULL
+ * @param[in]  numHeads Number of heads in \a d_heads
+ * @param[in]  numElements Number of nodes
+ * @param[in]  plan Pointer to CUDPPListRankPlan object
+ * @returns CUDPPResult indicating success or error condition
+ */
+template <typename T>
+CUDPPResult listScanDispatchOperator(void                *d_out,
+                                     const void          *d_in,
+                                     int                 *d_next_indices,
+                                     const int           *d_heads,
+                                     size_t              numHeads,
+                                     size_t              numElements,
+                                     CUDPPListRankPlan   *plan)
+{
+    switch (plan->m_config.op)
+    {
+    case CUDPP_ADD:
+        listScan<T, OperatorAdd<T> >((T*)d_out, (const T*)d_in, d_next_indices,
+                                     d_heads, numHeads, numElements, plan);
+        break;
+    case CUDPP_MULTIPLY:
+        listScan<T, OperatorMultiply<T> >((T*)d_out, (const T*)d_in, d_next_indices,
+                                          d_heads, numHeads, numElements, plan);
+        break;
+    case CUDPP_MAX:
+        listScan<T, OperatorMax<T> >((T*)d_out, (const T*)d_in, d_next_indices,
+                                     d_heads, numHeads, numElements, plan);
+        break;
+    case CUDPP_MIN:
+        listScan<T, OperatorMin<T> >((T*)d_out, (const T*)d_in, d_next_indices,
+                                     d_heads, numHeads, numElements, plan);
+        break;
+    default:
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+    }
+    return CUDPP_SUCCESS;
+}
+
 #ifdef __cplusplus
 extern "C" 
 {
@@ -123,8 +921,12 @@ extern "C"
 
 /** @brief Allocate intermediate arrays used by ListRank.
  *
- * CUDPPListRank needs temporary device arrays to store next indices
- * so that it does not overwrite the original array.
+ * Chooses the work decomposition for the plan's number of elements and
+ * allocates the sublist arrays of the ruling set for it with
+ * reserveListRankSublists().  The GPU path also needs a device copy of
+ * the next indices, in which it marks the sublist heads so that it does
+ * not overwrite the original array, and a counter for the list heads
+ * that listScan() finds.
  *
  * @param [in,out] plan Pointer to CUDPPListRankPlan object containing
  *                      options and number of elements, which is used
@@ -135,22 +937,29 @@ void allocListRankStorage(CUDPPListRankPlan *plan)
 {
     size_t numElts = plan->m_numElements;
 
-    CUDA_SAFE_CALL(cudaMalloc( (void**) &(plan->m_d_tmp1),     numElts*sizeof(int) ));
-    CUDA_SAFE_CALL(cudaMalloc( (void**) &(plan->m_d_tmp2),     numElts*sizeof(int) ));
-    CUDA_SAFE_CALL(cudaMalloc( (void**) &(plan->m_d_tmp3),     numElts*sizeof(int) ));
+    // Smaller lists are split into no more sublists
+    listRankDecomposition(plan->m_stats, numElts, 0, (size_t)-1, plan);
+    reserveListRankSublists(plan, plan->m_stats.numSublists);
+
+    if (plan->m_config.options & CUDPP_OPTION_HOST)
+        return;
+
+    CUDA_SAFE_CALL(cudaMalloc( (void**) &(plan->m_d_next),      numElts*sizeof(int) ));
+    CUDA_SAFE_CALL(cudaMalloc( (void**) &(plan->m_d_numHeads),  sizeof(unsigned int) ));
 }
 
 /** @brief Deallocate intermediate block arrays in a CUDPPListRankPlan object.
  *
- * Deallocates the output indices array allocated by allocListRankStorage().
+ * Deallocates the sublist arrays allocated by allocListRankStorage().
  *
  * @param[in,out] plan Pointer to CUDPPListRankPlan object initialized by allocListRankStorage().
  */
 void freeListRankStorage(CUDPPListRankPlan *plan)
 {
-    if(plan->m_d_tmp1 != NULL) CUDA_SAFE_CALL(cudaFree(plan->m_d_tmp1));
-    if(plan->m_d_tmp2 != NULL) CUDA_SAFE_CALL(cudaFree(plan->m_d_tmp2));
-    if(plan->m_d_tmp3 != NULL) CUDA_SAFE_CALL(cudaFree(plan->m_d_tmp3));
+    if(plan->m_d_next != NULL) CUDA_SAFE_CALL(cudaFree(plan->m_d_next));
+    if(plan->m_d_numHeads != NULL) CUDA_SAFE_CALL(cudaFree(plan->m_d_numHeads));
+
+    freeListRankSublists(plan);
 }
 
 
@@ -167,7 +976,8 @@ void freeListRankStorage(CUDPPListRankPlan *plan)
  * @param[in]  head Head pointer index
  * @param[in]  numElements Number of nodes values to rank
  * @param[in]  plan     Pointer to CUDPPListRankPlan object containing
- *                      list ranking options and intermediate storage
+ *                      list ranking options and intermediate storage,
+ *                      in which the work decomposition is recorded
  * @returns CUDPPResult indicating success or error condition
  */
 CUDPPResult cudppListRankDispatch(void *d_ranked_values,
@@ -175,7 +985,7 @@ CUDPPResult cudppListRankDispatch(void *d_ranked_values,
                            void *d_next_indices,
                            size_t head,
                            size_t numElements,
-                           const CUDPPListRankPlan *plan)
+                           CUDPPListRankPlan *plan)
 {
     // Call to list ranker
     CUDPPResult status = CUDPP_SUCCESS;
@@ -196,6 +1006,7 @@ CUDPPResult cudppListRankDispatch(void *d_ranked_values,
     case CUDPP_USHORT:
         listRank<unsigned short>((unsigned short*) d_ranked_values, (unsigned short*) d_unranked_values,
                                (int*) d_next_indices, head, numElements, plan);
+        break;
     case CUDPP_INT:
         listRank<int>((int*) d_ranked_values, (int*) d_unranked_values,
                       (int*) d_next_indices, head, numElements, plan);
@@ -227,6 +1038,71 @@ CUDPPResult cudppListRankDispatch(void *d_ranked_values,
     return status;
 }
 
+/** @brief Dispatch function to perform a parallel list scan on a
+ * forest of linked lists with the specified configuration.
+ *
+ * A wrapper on top of listScan which calls listScan() for the data type
+ * and operator specified in \a config. This is the app-level interface
+ * to list scans used by cudppListScan().
+ *
+ * @param[out] d_out Prefix values
+ * @param[in]  d_in Input values
+ * @param[in]  d_next_indices Next indices array
+ * @param[in]  d_heads Heads of the lists, or NULL
+ * @param[in]  numHeads Number of heads in \a d_heads
+ * @param[in]  numElements Number of nodes
+ * @param[in]  plan     Pointer to CUDPPListRankPlan object containing
+ *                      list ranking options and intermediate storage,
+ *                      in which the work decomposition is recorded
+ * @returns CUDPPResult indicating success or error condition
+ */
+CUDPPResult cudppListScanDispatch(void *d_out,
+                                  const void *d_in,
+                                  void *d_next_indices,
+                                  const int *d_heads,
+                                  size_t numHeads,
+                                  size_t numElements,
+                                  CUDPPListRankPlan *plan)
+{
+    int *d_next = (int*) d_next_indices;
+
+    switch (plan->m_config.datatype)
+    {
+    case CUDPP_CHAR:
+        return listScanDispatchOperator<char>(d_out, d_in, d_next, d_heads,
+                                              numHeads, numElements, plan);
+    case CUDPP_UCHAR:
+        return listScanDispatchOperator<unsigned char>(d_out, d_in, d_next, d_heads,
+                                                       numHeads, numElements, plan);
+    case CUDPP_SHORT:
+        return listScanDispatchOperator<short>(d_out, d_in, d_next, d_heads,
+                                               numHeads, numElements, plan);
+    case CUDPP_USHORT:
+        return listScanDispatchOperator<unsigned short>(d_out, d_in, d_next, d_heads,
+                                                        numHeads, numElements, plan);
+    case CUDPP_INT:
+        return listScanDispatchOperator<int>(d_out, d_in, d_next, d_heads,
+                                             numHeads, numElements, plan);
+    case CUDPP_UINT:
+        return listScanDispatchOperator<unsigned int>(d_out, d_in, d_next, d_heads,
+                                                      numHeads, numElements, plan);
+    case CUDPP_FLOAT:
+        return listScanDispatchOperator<float>(d_out, d_in, d_next, d_heads,
+                                               numHeads, numElements, plan);
+    case CUDPP_LONGLONG:
+        return listScanDispatchOperator<long long>(d_out, d_in, d_next, d_heads,
+                                                   numHeads, numElements, plan);
+    case CUDPP_ULONGLONG:
+        return listScanDispatchOperator<unsigned long long>(d_out, d_in, d_next, d_heads,
+                                                            numHeads, numElements, plan);
+    case CUDPP_DOUBLE:
+        return listScanDispatchOperator<double>(d_out, d_in, d_next, d_heads,
+                                                numHeads, numElements, plan);
+    default:
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+    }
+}
+
 
 #ifdef __cplusplus
 }
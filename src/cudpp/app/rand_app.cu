@@ -18,6 +18,7 @@
 #include "cuda_util.h"
 #include "cudpp.h"
 #include "cudpp_util.h"
+#include "cudpp_globals.h"
 #include "cudpp_plan.h"
 
 #include <cstdlib>
@@ -69,49 +70,154 @@
 void launchRandMD5Kernel(unsigned int * d_out, unsigned int seed, 
                          size_t numElements)
 {
-    //first, we need a temporary array of uints
-    uint4 * dev_output;
-
-    //figure out how many elements are needed in this array
-    unsigned int devOutputsize = (unsigned int)(numElements / 4);
-    devOutputsize += (numElements %4 == 0) ? 0 : 1; //used for overflow
-    unsigned int memSize = devOutputsize * sizeof(uint4);
+    //each thread generates 128 bits, i.e. four unsigned ints of d_out
+    unsigned int numThreads = (unsigned int)(numElements / 4);
+    numThreads += (numElements % 4 == 0) ? 0 : 1; //partial group at the tail
 
+    if (numThreads == 0) return;
 
     //now figure out block size
     unsigned int blockSize = RAND_CTA_SIZE;
-    if(devOutputsize < RAND_CTA_SIZE) blockSize = devOutputsize;
+    if(numThreads < RAND_CTA_SIZE) blockSize = numThreads;
 
     unsigned int n_blocks = 
-            devOutputsize/blockSize + (devOutputsize%blockSize == 0 ? 0:1);  
-
-    //printf("Generating %u random numbers using %u blocks and %u threads per block\n", numElements, n_blocks, blockSize);
-/*  old debug code now removed.
-    printf("\nnumber of elements: %u, devOutputSize: %u\n", 
-            numElements, devOutputsize);
-    printf("number of blocks: %u blocksize: %u devOutputsize = %u\n", 
-            n_blocks, blockSize, devOutputsize);
-    printf("number of threads: %u\n", n_blocks * blockSize);
-    printf("seed value: %u\n", seed);
-*/
-    //now create the memory on the device
-    CUDA_SAFE_CALL( cudaMalloc((void **) &dev_output, memSize));
-    CUDA_SAFE_CALL( cudaMemset(dev_output, 0, memSize)); 
-    gen_randMD5<<<n_blocks, blockSize>>>(dev_output, devOutputsize, seed);
-
-    //here the GPU computation is done
-    //here we have all the data on the device, we copy it over into host memory
-
-
-    //calculate final memSize
-    //@TODO: write a template version of this which calls two different version 
-    // depending if numElements %4 == 0
-    size_t finalMemSize = sizeof(unsigned int) * numElements;
-    CUDA_SAFE_CALL( cudaMemcpy(d_out, dev_output, finalMemSize, 
-                               cudaMemcpyDeviceToDevice));
-    CUDA_SAFE_CALL( cudaFree(dev_output));
+            numThreads/blockSize + (numThreads%blockSize == 0 ? 0:1);  
+
+    //the output is written in place, so uint4 stores are only safe when
+    //d_out is 16-byte aligned
+    if (((size_t)d_out & (sizeof(uint4) - 1)) == 0)
+        gen_randMD5<true><<<n_blocks, blockSize>>>(d_out, numElements, seed);
+    else
+        gen_randMD5<false><<<n_blocks, blockSize>>>(d_out, numElements, seed);
+
+    CUDA_CHECK_ERROR("gen_randMD5");
 }//end launchRandMD5Kernel
 
+/**@brief Launches a counter-based (Philox or Threefry) random number 
+ * generator kernel with the distribution transform \a xform
+ *
+ * Writes elements [plan->m_offset, plan->m_offset + \a numElements) of the
+ * output sequence selected by the plan's seed, stream and distribution into
+ * \a d_out.  The generators are the Philox4x32-10 and Threefry4x32-20 
+ * generators described in <a href="http://dx.doi.org/10.1145/2063384.2063405">
+ * Parallel random numbers: as easy as 1, 2, 3</a>.  Their output is a pure
+ * function of (key, counter), so skipping ahead is O(1) and the result is 
+ * the same regardless of how the sequence is split into calls.
+ *
+ * @param[out] d_out the output array allocated on device memory
+ * @param[in] numElements the number of elements in \a d_out
+ * @param[in] plan pointer to CUDPPRandPlan holding the seed, stream and offset
+ * @param[in] xform the distribution transform
+ * @see gen_randCounter()
+ * @see cudppRand(), cudppRandSkipAhead(), cudppRandStream(), 
+ * cudppRandDistribution()
+ */
+template <CUDPPAlgorithm alg, class Transform>
+void launchRandCounterKernel(typename Transform::T * d_out, size_t numElements,
+                             const CUDPPRandPlan * plan, Transform xform)
+{
+    if (numElements == 0) return;
+
+    const int valuesPerBlock = Transform::valuesPerBlock;
+
+    uint2 key = make_uint2(plan->m_seed, plan->m_stream);
+    unsigned int firstLane = (unsigned int)(plan->m_offset % valuesPerBlock);
+
+    size_t numBlocks = (firstLane + numElements + valuesPerBlock - 1) 
+                       / valuesPerBlock;
+    size_t numCtas = (numBlocks + RAND_CTA_SIZE - 1) / RAND_CTA_SIZE;
+    unsigned int grid = (unsigned int)((numCtas > 65535) ? 65535 : numCtas);
+
+    bool isAligned = (firstLane == 0) && 
+                     (((size_t)d_out & (sizeof(uint4) - 1)) == 0);
+
+    if (isAligned)
+        gen_randCounter<alg, Transform, true><<<grid, RAND_CTA_SIZE>>>
+            (d_out, numElements, plan->m_offset, key, xform);
+    else
+        gen_randCounter<alg, Transform, false><<<grid, RAND_CTA_SIZE>>>
+            (d_out, numElements, plan->m_offset, key, xform);
+
+    CUDA_CHECK_ERROR("gen_randCounter");
+}
+
+/**@brief Launches a counter-based random number generator for the 
+ * distribution and output datatype selected in \a plan
+ *
+ * @param[out] d_out the output array allocated on device memory
+ * @param[in] numElements the number of elements in \a d_out
+ * @param[in] plan pointer to CUDPPRandPlan holding the generator state
+ * @see cudppRandDistribution()
+ */
+template <CUDPPAlgorithm alg>
+void randCounterDispatch(void * d_out, size_t numElements,
+                         const CUDPPRandPlan * plan)
+{
+    bool isDouble = (plan->m_config.datatype == CUDPP_DOUBLE);
+
+    switch(plan->m_distribution)
+    {
+    case CUDPP_RAND_BITS:
+        launchRandCounterKernel<alg>((unsigned int *) d_out, numElements, 
+                                     plan, RandBitsTransform());
+        break;
+    case CUDPP_RAND_UNIFORM_INT:
+        {
+            RandBoundedIntTransform xform;
+            xform.low = (unsigned int) plan->m_param0;
+            xform.range = (unsigned int) (plan->m_param1 - plan->m_param0);
+            xform.threshold = (0u - xform.range) % xform.range;
+            launchRandCounterKernel<alg>((unsigned int *) d_out, numElements,
+                                         plan, xform);
+        }
+        break;
+    case CUDPP_RAND_UNIFORM:
+        if (isDouble)
+            launchRandCounterKernel<alg>((double *) d_out, numElements, plan,
+                                         RandUniformTransform<double>());
+        else
+            launchRandCounterKernel<alg>((float *) d_out, numElements, plan,
+                                         RandUniformTransform<float>());
+        break;
+    case CUDPP_RAND_NORMAL:
+        if (isDouble)
+        {
+            RandNormalTransform<double> xform;
+            xform.mean = plan->m_param0;
+            xform.stddev = plan->m_param1;
+            launchRandCounterKernel<alg>((double *) d_out, numElements, plan,
+                                         xform);
+        }
+        else
+        {
+            RandNormalTransform<float> xform;
+            xform.mean = (float) plan->m_param0;
+            xform.stddev = (float) plan->m_param1;
+            launchRandCounterKernel<alg>((float *) d_out, numElements, plan,
+                                         xform);
+        }
+        break;
+    case CUDPP_RAND_EXPONENTIAL:
+        if (isDouble)
+        {
+            RandExponentialTransform<double> xform;
+            xform.lambda = plan->m_param0;
+            launchRandCounterKernel<alg>((double *) d_out, numElements, plan,
+                                         xform);
+        }
+        else
+        {
+            RandExponentialTransform<float> xform;
+            xform.lambda = (float) plan->m_param0;
+            launchRandCounterKernel<alg>((float *) d_out, numElements, plan,
+                                         xform);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -123,8 +229,8 @@ extern "C"
  * and calls the appropriate random number generation algorithm.  
  *
  * @param[out] d_out the array allocated on device memory where the random 
- * numbers will be stored
- * must be of type unsigned int
+ * numbers will be stored.  Its type depends on the plan's distribution and
+ * datatype (see cudppRandDistribution()).
  * @param[in] numElements the number of elements in the array d_out
  * @param[in] plan pointer to CUDPPRandPlan which contains the algorithm to run
  */
@@ -138,6 +244,12 @@ void cudppRandDispatch(void * d_out, size_t numElements,
         //run the md5 algorithm here
         launchRandMD5Kernel( (unsigned int *) d_out, plan->m_seed, numElements);
         break;
+    case CUDPP_RAND_PHILOX:
+        randCounterDispatch<CUDPP_RAND_PHILOX>(d_out, numElements, plan);
+        break;
+    case CUDPP_RAND_THREEFRY:
+        randCounterDispatch<CUDPP_RAND_THREEFRY>(d_out, numElements, plan);
+        break;
     default:
         break;
     }//end switch
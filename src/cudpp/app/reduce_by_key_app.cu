@@ -0,0 +1,422 @@
+// -------------------------------------------------------------
+// CUDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cuda_util.h"
+#include "cudpp_globals.h"
+#include "cudpp.h"
+#include "cudpp_util.h"
+#include "cudpp_plan.h"
+#include "cudpp_scan.h"
+#include "cudpp_segscan.h"
+
+#include "kernel/reduce_by_key_kernel.cuh"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * @file
+ * reduce_by_key_app.cu
+ *
+ * @brief CUDPP application-level reduce-by-key and run-length encoding routines
+ */
+
+/** \addtogroup cudpp_app
+ * @{
+ */
+
+/** @name Reduce-By-Key Functions
+ * @{
+ */
+
+/** @brief Grid of RBK_CTA_SIZE threads per block for \a numItems items
+ *
+ * The kernels loop over their items, so the grid is capped at 65535 blocks.
+ */
+dim3 rbkGrid(size_t numItems)
+{
+    size_t numBlocks = (numItems + RBK_CTA_SIZE - 1) / RBK_CTA_SIZE;
+    if (numBlocks > 65535)
+        numBlocks = 65535;
+    if (numBlocks < 1)
+        numBlocks = 1;
+    return dim3((unsigned int)numBlocks, 1, 1);
+}
+
+/** @brief Number of RBK_ITEMS_PER_THREAD tiles of \a numElements elements */
+size_t rbkNumTiles(size_t numElements)
+{
+    return (numElements + RBK_ITEMS_PER_THREAD - 1) / RBK_ITEMS_PER_THREAD;
+}
+
+/** @brief Reduce-by-key or run-length encoding on the host
+ *
+ * The elements are split into one chunk per OpenMP thread.  In a single
+ * pass over its keys and values, each chunk reduces its segments and
+ * writes each segment that ends in the chunk to the front of its own
+ * range of the output.  The outputs hold \a numElements entries, so
+ * every chunk's segments fit in its range.  The chunks are then moved
+ * together in order, and the part of a segment that continues from the
+ * chunks before is folded into that segment's output.
+ *
+ * @param[out] keysOut Key of each segment
+ * @param[out] valuesOut Reduction (or length) of each segment
+ * @param[in] keys Keys
+ * @param[in] values Values (unused for run-length encoding)
+ * @param[in] numElements Number of elements
+ * @returns Number of segments
+ */
+template <typename K, typename T, class Oper, bool isRLE>
+size_t reduceByKeyHost(K           *keysOut,
+                       T           *valuesOut,
+                       const K     *keys,
+                       const T     *values,
+                       size_t      numElements)
+{
+    if (numElements == 0)
+        return 0;
+
+    Oper op;
+    int numChunks = 1;
+#ifdef _OPENMP
+    numChunks = omp_get_max_threads();
+#endif
+    if ((size_t)numChunks > numElements / RBK_HOST_MIN_CHUNK + 1)
+        numChunks = (int)(numElements / RBK_HOST_MIN_CHUNK + 1);
+    size_t chunkSize = (numElements + numChunks - 1) / numChunks;
+
+    size_t *counts = (size_t*) malloc(numChunks * sizeof(size_t));
+    T      *leads = (T*) malloc(numChunks * sizeof(T));
+    char   *hasLead = (char*) malloc(numChunks * sizeof(char));
+
+    // Reduce and write the segments of each chunk in its own range
+#pragma omp parallel for num_threads(numChunks)
+    for (int c = 0; c < numChunks; ++c)
+    {
+        size_t begin = c * chunkSize;
+        size_t end = (begin + chunkSize < numElements) ? begin + chunkSize : numElements;
+        size_t out = begin;
+        bool lead = (begin < end) && !rbkIsHead(keys, begin);
+        hasLead[c] = lead;
+
+        T acc = T();
+        for (size_t i = begin; i < end; ++i)
+        {
+            T v = rbkValue<T, isRLE>(values, i);
+            acc = (i == begin || rbkIsHead(keys, i)) ? v : op(acc, v);
+
+            if (i + 1 == end || keys[i+1] != keys[i])
+            {
+                if (lead)
+                {
+                    leads[c] = acc;
+                    lead = false;
+                }
+                else
+                {
+                    keysOut[out] = keys[i];
+                    valuesOut[out] = acc;
+                    ++out;
+                }
+            }
+        }
+        counts[c] = out - begin;
+    }
+
+    // Move the segments of each chunk after those of the chunks before,
+    // folding in the part of the segment that continues into the chunk
+    size_t numSegments = counts[0];
+    for (int c = 1; c < numChunks; ++c)
+    {
+        size_t begin = c * chunkSize;
+        if (hasLead[c])
+            valuesOut[numSegments-1] = op(valuesOut[numSegments-1], leads[c]);
+        memmove(keysOut + numSegments, keysOut + begin, counts[c] * sizeof(K));
+        memmove(valuesOut + numSegments, valuesOut + begin, counts[c] * sizeof(T));
+        numSegments += counts[c];
+    }
+
+    free(counts);
+    free(leads);
+    free(hasLead);
+    return numSegments;
+}
+
+/** @brief Reduce-by-key or run-length encoding on the GPU
+ *
+ * rbk_tile_summary() counts the heads and reduces the tail of every
+ * tile.  The head counts are scanned to give the rank of the first
+ * segment of each tile, and the tails are scanned with a segmented scan
+ * that restarts at the tiles with a head, which gives the carry-in of
+ * the segment crossing into each tile.  rbk_tile_scatter() then reduces
+ * and writes every segment.  Plans with CUDPP_OPTION_HOST call
+ * reduceByKeyHost().
+ *
+ * @param[out] d_keysOut Key of each segment
+ * @param[out] d_valuesOut Reduction (or length) of each segment
+ * @param[in] d_keys Keys
+ * @param[in] d_values Values (unused for run-length encoding)
+ * @param[in] numElements Number of elements
+ * @param[in] plan Pointer to CUDPPReduceByKeyPlan object
+ * @returns Number of segments
+ */
+template <typename K, typename T, class Oper, bool isRLE>
+size_t reduceByKey(K                      *d_keysOut,
+                   T                      *d_valuesOut,
+                   const K                *d_keys,
+                   const T                *d_values,
+                   size_t                 numElements,
+                   const CUDPPReduceByKeyPlan *plan)
+{
+    if (plan->m_config.options & CUDPP_OPTION_HOST)
+        return reduceByKeyHost<K, T, Oper, isRLE>(d_keysOut, d_valuesOut, d_keys,
+                                                   d_values, numElements);
+
+    if (numElements == 0)
+        return 0;
+
+    size_t numTiles = rbkNumTiles(numElements);
+    T *d_tileTail = (T*)plan->m_d_tileTail;
+    T *d_tileCarry = (T*)plan->m_d_tileCarry;
+
+    rbk_tile_summary<K, T, Oper, isRLE><<< rbkGrid(numTiles), RBK_CTA_SIZE >>>
+        (plan->m_d_tileCount, plan->m_d_tileFlag, d_tileTail, d_keys, d_values,
+         numElements, numTiles);
+    CUDA_CHECK_ERROR("rbk_tile_summary");
+
+    cudppScanDispatch(plan->m_d_tileOffset, plan->m_d_tileCount, numTiles, 1,
+                      plan->m_scanPlan);
+    cudppSegmentedScanDispatch(d_tileCarry, d_tileTail, plan->m_d_tileFlag,
+                               numTiles, plan->m_segmentedScanPlan);
+
+    rbk_tile_scatter<K, T, Oper, isRLE><<< rbkGrid(numTiles), RBK_CTA_SIZE >>>
+        (d_keysOut, d_valuesOut, d_keys, d_values, plan->m_d_tileOffset, d_tileCarry,
+         numElements, numTiles);
+    CUDA_CHECK_ERROR("rbk_tile_scatter");
+
+    unsigned int lastOffset, lastCount;
+    CUDA_SAFE_CALL(cudaMemcpy(&lastOffset, plan->m_d_tileOffset + numTiles - 1,
+                              sizeof(unsigned int), cudaMemcpyDeviceToHost));
+    CUDA_SAFE_CALL(cudaMemcpy(&lastCount, plan->m_d_tileCount + numTiles - 1,
+                              sizeof(unsigned int), cudaMemcpyDeviceToHost));
+    return (size_t)lastOffset + lastCount;
+}
+
+/** @brief Dispatch a reduce-by-key of unsigned int keys for the operator
+ * in the plan's configuration
+ */
+template <typename T>
+size_t reduceByKeyDispatchOperator(void                        *d_keysOut,
+                                   void                        *d_valuesOut,
+                                   const void                  *d_keys,
+                                   const void                  *d_values,
+                                   size_t                      numElements,
+                                   const CUDPPReduceByKeyPlan  *plan)
+{
+    typedef unsigned int K;
+    switch (plan->m_config.op)
+    {
+    case CUDPP_ADD:
+    default:
+        return reduceByKey<K, T, OperatorAdd<T>, false>
+            ((K*)d_keysOut, (T*)d_valuesOut, (const K*)d_keys, (const T*)d_values,
+             numElements, plan);
+    case CUDPP_MULTIPLY:
+        return reduceByKey<K, T, OperatorMultiply<T>, false>
+            ((K*)d_keysOut, (T*)d_valuesOut, (const K*)d_keys, (const T*)d_values,
+             numElements, plan);
+    case CUDPP_MAX:
+        return reduceByKey<K, T, OperatorMax<T>, false>
+            ((K*)d_keysOut, (T*)d_valuesOut, (const K*)d_keys, (const T*)d_values,
+             numElements, plan);
+    case CUDPP_MIN:
+        return reduceByKey<K, T, OperatorMin<T>, false>
+            ((K*)d_keysOut, (T*)d_valuesOut, (const K*)d_keys, (const T*)d_values,
+             numElements, plan);
+    }
+}
+
+/** @brief Run-length encode elements of type \a K, which are compared
+ * bit for bit
+ */
+template <typename K>
+size_t runLengthEncode(void                        *d_runValues,
+                       unsigned int                *d_runLengths,
+                       const void                  *d_in,
+                       size_t                      numElements,
+                       const CUDPPReduceByKeyPlan  *plan)
+{
+    return reduceByKey<K, unsigned int, OperatorAdd<unsigned int>, true>
+        ((K*)d_runValues, d_runLengths, (const K*)d_in, (const unsigned int*)NULL,
+         numElements, plan);
+}
+
+/** @brief Size in bytes of the value type of the tile tails
+ *
+ * Run-length encoding counts with unsigned int; reduce-by-key reduces
+ * values of the plan's datatype.
+ */
+size_t rbkValueSize(const CUDPPReduceByKeyPlan *plan)
+{
+    if (plan->m_config.algorithm == CUDPP_RLE)
+        return sizeof(unsigned int);
+
+    switch (plan->m_config.datatype)
+    {
+    case CUDPP_DOUBLE:
+    case CUDPP_LONGLONG:
+    case CUDPP_ULONGLONG:
+        return 8;
+    default:
+        return 4;
+    }
+}
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @brief Allocate intermediate arrays used by reduce-by-key and
+ * run-length encoding.
+ *
+ * On the GPU the plan holds the head count, head flag, offset, tail and
+ * carry of every tile of RBK_ITEMS_PER_THREAD elements.  The host
+ * backend allocates its per-thread arrays in each call.
+ *
+ * @param[in,out] plan Pointer to CUDPPReduceByKeyPlan object
+ */
+void allocReduceByKeyStorage(CUDPPReduceByKeyPlan *plan)
+{
+    if (plan->m_config.options & CUDPP_OPTION_HOST)
+        return;
+
+    size_t numTiles = rbkNumTiles(plan->m_numElements);
+    if (numTiles < 1)
+        numTiles = 1;
+    size_t valueSize = rbkValueSize(plan);
+
+    CUDA_SAFE_CALL(cudaMalloc((void**)&plan->m_d_tileCount, numTiles * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&plan->m_d_tileFlag, numTiles * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&plan->m_d_tileOffset, numTiles * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc(&plan->m_d_tileTail, numTiles * valueSize));
+    CUDA_SAFE_CALL(cudaMalloc(&plan->m_d_tileCarry, numTiles * valueSize));
+}
+
+/** @brief Deallocate intermediate arrays in a CUDPPReduceByKeyPlan object.
+ *
+ * @param[in,out] plan Pointer to CUDPPReduceByKeyPlan object initialized by allocReduceByKeyStorage().
+ */
+void freeReduceByKeyStorage(CUDPPReduceByKeyPlan *plan)
+{
+    if (plan->m_config.options & CUDPP_OPTION_HOST)
+        return;
+
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_tileCount));
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_tileFlag));
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_tileOffset));
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_tileTail));
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_tileCarry));
+}
+
+/** @brief Dispatch function for reduce-by-key.
+ *
+ * This is the app-level interface used by cudppReduceByKey().
+ *
+ * @param[in] plan Pointer to CUDPPReduceByKeyPlan object
+ * @param[out] d_keysOut Key of each segment
+ * @param[out] d_valuesOut Reduction of each segment
+ * @param[in] d_keys Keys
+ * @param[in] d_values Values of the plan's datatype
+ * @param[in] numElements Number of elements
+ * @returns Number of segments
+ */
+size_t cudppReduceByKeyDispatch(const CUDPPReduceByKeyPlan *plan,
+                                unsigned int               *d_keysOut,
+                                void                       *d_valuesOut,
+                                const unsigned int         *d_keys,
+                                const void                 *d_values,
+                                size_t                     numElements)
+{
+    switch (plan->m_config.datatype)
+    {
+    case CUDPP_INT:
+        return reduceByKeyDispatchOperator<int>(d_keysOut, d_valuesOut, d_keys,
+                                                d_values, numElements, plan);
+    case CUDPP_UINT:
+    default:
+        return reduceByKeyDispatchOperator<unsigned int>(d_keysOut, d_valuesOut, d_keys,
+                                                         d_values, numElements, plan);
+    case CUDPP_FLOAT:
+        return reduceByKeyDispatchOperator<float>(d_keysOut, d_valuesOut, d_keys,
+                                                  d_values, numElements, plan);
+    case CUDPP_DOUBLE:
+        return reduceByKeyDispatchOperator<double>(d_keysOut, d_valuesOut, d_keys,
+                                                   d_values, numElements, plan);
+    case CUDPP_LONGLONG:
+        return reduceByKeyDispatchOperator<long long>(d_keysOut, d_valuesOut, d_keys,
+                                                      d_values, numElements, plan);
+    case CUDPP_ULONGLONG:
+        return reduceByKeyDispatchOperator<unsigned long long>(d_keysOut, d_valuesOut, d_keys,
+                                                               d_values, numElements, plan);
+    }
+}
+
+/** @brief Dispatch function for run-length encoding.
+ *
+ * This is the app-level interface used by cudppRLE().  Elements of the
+ * plan's datatype are compared by their bits, so the encoder is only
+ * instantiated once per element size.
+ *
+ * @param[in] plan Pointer to CUDPPReduceByKeyPlan object
+ * @param[out] d_runValues Value of each run
+ * @param[out] d_runLengths Length of each run
+ * @param[in] d_in Input elements
+ * @param[in] numElements Number of elements
+ * @returns Number of runs
+ */
+size_t cudppRLEDispatch(const CUDPPReduceByKeyPlan *plan,
+                        void                       *d_runValues,
+                        unsigned int               *d_runLengths,
+                        const void                 *d_in,
+                        size_t                     numElements)
+{
+    switch (plan->m_config.datatype)
+    {
+    case CUDPP_CHAR:
+    case CUDPP_UCHAR:
+        return runLengthEncode<unsigned char>(d_runValues, d_runLengths, d_in,
+                                              numElements, plan);
+    case CUDPP_SHORT:
+    case CUDPP_USHORT:
+        return runLengthEncode<unsigned short>(d_runValues, d_runLengths, d_in,
+                                               numElements, plan);
+    case CUDPP_DOUBLE:
+    case CUDPP_LONGLONG:
+    case CUDPP_ULONGLONG:
+        return runLengthEncode<unsigned long long>(d_runValues, d_runLengths, d_in,
+                                                   numElements, plan);
+    default:
+        return runLengthEncode<unsigned int>(d_runValues, d_runLengths, d_in,
+                                             numElements, plan);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} */ // end reduce-by-key functions
+/** @} */ // end cudpp_app
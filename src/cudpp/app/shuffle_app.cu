@@ -0,0 +1,198 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// ------------------------------------------------------------- 
+// This source code is distributed under the terms of license.txt 
+// in the root directory of this source distribution.
+// ------------------------------------------------------------- 
+
+/**
+ * @file
+ * shuffle_app.cu
+ *
+ * @brief CUDPP application-level shuffle and sampling routines
+ */
+
+#include "cuda_util.h"
+#include "cudpp.h"
+#include "cudpp_util.h"
+#include "cudpp_globals.h"
+#include "cudpp_plan.h"
+#include "cudpp_shuffle.h"
+
+#include <cstdlib>
+#include <cstdio>
+#include <assert.h>
+
+#include "cta/rand_cta.cuh"
+#include "kernel/shuffle_kernel.cuh"
+
+/** \addtogroup cudpp_app
+  * @{
+  */
+
+/** @name Shuffle Functions
+ * @{
+ */
+
+/**
+ * @brief Returns the number of bits in each half of a Feistel network whose
+ * domain covers [0, \a numElements).
+ *
+ * @param[in] numElements size of the permutation, at least 1
+ * @returns half of the number of bits needed to represent numElements - 1,
+ * rounded up, and at least 1
+ */
+unsigned int shuffleHalfBits(size_t numElements)
+{
+    unsigned int bits = 0;
+    for (size_t m = numElements - 1; m > 0; m >>= 1)
+        bits++;
+    unsigned int halfBits = (bits + 1) / 2;
+    return (halfBits < 1) ? 1 : halfBits;
+}
+
+/**
+ * @brief Launches the shuffle or sampling kernel for keys of type \a T.
+ *
+ * @param[out] d_keysOut the output keys
+ * @param[out] d_valuesOut the output values, or NULL
+ * @param[in] d_keysIn the input keys
+ * @param[in] d_valuesIn the input values, or NULL
+ * @param[in] numOutputs number of elements to output
+ * @param[in] numElements number of input elements
+ * @param[in] withReplacement true to sample with replacement
+ * @param[in] plan the shuffle plan, holding seed, stream and call index
+ */
+template <typename T>
+void launchShuffle(T                      *d_keysOut,
+                   unsigned int           *d_valuesOut,
+                   const T                *d_keysIn,
+                   const unsigned int     *d_valuesIn,
+                   size_t                 numOutputs,
+                   size_t                 numElements,
+                   bool                   withReplacement,
+                   const CUDPPShufflePlan *plan)
+{
+    if (numOutputs == 0) return;
+
+    bool hasValues = (plan->m_config.options & CUDPP_OPTION_KEY_VALUE_PAIRS) 
+                     && d_valuesIn != 0 && d_valuesOut != 0;
+
+    uint2 key = make_uint2(plan->m_seed, plan->m_stream);
+
+    size_t numThreads = withReplacement ? (numOutputs + 3) / 4 : numOutputs;
+    size_t numCtas = (numThreads + SHUFFLE_CTA_SIZE - 1) / SHUFFLE_CTA_SIZE;
+    unsigned int grid = (unsigned int)((numCtas > 65535) ? 65535 : numCtas);
+
+    if (withReplacement)
+    {
+        RandBoundedIntTransform bound;
+        bound.low = 0;
+        bound.range = (unsigned int) numElements;
+        bound.threshold = (0u - bound.range) % bound.range;
+
+        if (hasValues)
+            sampleWithReplacement<T, true><<<grid, SHUFFLE_CTA_SIZE>>>
+                (d_keysOut, d_valuesOut, d_keysIn, d_valuesIn, numOutputs, 
+                 bound, key, plan->m_offset);
+        else
+            sampleWithReplacement<T, false><<<grid, SHUFFLE_CTA_SIZE>>>
+                (d_keysOut, d_valuesOut, d_keysIn, d_valuesIn, numOutputs, 
+                 bound, key, plan->m_offset);
+        CUDA_CHECK_ERROR("sampleWithReplacement");
+    }
+    else
+    {
+        unsigned int halfBits = shuffleHalfBits(numElements);
+
+        if (hasValues)
+            shuffleGather<T, true><<<grid, SHUFFLE_CTA_SIZE>>>
+                (d_keysOut, d_valuesOut, d_keysIn, d_valuesIn, 
+                 (unsigned int) numOutputs, (unsigned int) numElements, 
+                 halfBits, key, plan->m_offset);
+        else
+            shuffleGather<T, false><<<grid, SHUFFLE_CTA_SIZE>>>
+                (d_keysOut, d_valuesOut, d_keysIn, d_valuesIn, 
+                 (unsigned int) numOutputs, (unsigned int) numElements, 
+                 halfBits, key, plan->m_offset);
+        CUDA_CHECK_ERROR("shuffleGather");
+    }
+}
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Dispatches a shuffle or sample on the key size of \a plan's 
+ * datatype.
+ *
+ * Keys are moved as opaque words of the datatype's size, so one kernel
+ * instantiation serves all datatypes of the same size.
+ *
+ * @param[out] d_keysOut the output keys
+ * @param[out] d_valuesOut the output values, or NULL
+ * @param[in] d_keysIn the input keys
+ * @param[in] d_valuesIn the input values, or NULL
+ * @param[in] numOutputs number of elements to output
+ * @param[in] numElements number of input elements
+ * @param[in] withReplacement true to sample with replacement
+ * @param[in] plan the shuffle plan
+ */
+void cudppShuffleDispatch(void                   *d_keysOut,
+                          unsigned int           *d_valuesOut,
+                          const void             *d_keysIn,
+                          const unsigned int     *d_valuesIn,
+                          size_t                 numOutputs,
+                          size_t                 numElements,
+                          bool                   withReplacement,
+                          const CUDPPShufflePlan *plan)
+{
+    switch(plan->m_config.datatype)
+    {
+    case CUDPP_CHAR:
+    case CUDPP_UCHAR:
+        launchShuffle<unsigned char>((unsigned char*)d_keysOut, d_valuesOut,
+                                     (const unsigned char*)d_keysIn, 
+                                     d_valuesIn, numOutputs, numElements,
+                                     withReplacement, plan);
+        break;
+    case CUDPP_SHORT:
+    case CUDPP_USHORT:
+        launchShuffle<unsigned short>((unsigned short*)d_keysOut, d_valuesOut,
+                                      (const unsigned short*)d_keysIn, 
+                                      d_valuesIn, numOutputs, numElements,
+                                      withReplacement, plan);
+        break;
+    case CUDPP_INT:
+    case CUDPP_UINT:
+    case CUDPP_FLOAT:
+        launchShuffle<unsigned int>((unsigned int*)d_keysOut, d_valuesOut,
+                                    (const unsigned int*)d_keysIn, 
+                                    d_valuesIn, numOutputs, numElements,
+                                    withReplacement, plan);
+        break;
+    case CUDPP_DOUBLE:
+    case CUDPP_LONGLONG:
+    case CUDPP_ULONGLONG:
+        launchShuffle<unsigned long long>((unsigned long long*)d_keysOut, 
+                                          d_valuesOut,
+                                          (const unsigned long long*)d_keysIn,
+                                          d_valuesIn, numOutputs, numElements,
+                                          withReplacement, plan);
+        break;
+    default:
+        break;
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} */ // end shuffle functions
+/** @} */ // end cudpp_app
@@ -12,7 +12,7 @@
  * @file
  * spmvmult_app.cu
  *
- * @brief CUDPP application-level scan routines
+ * @brief CUDPP application-level sparse matrix-vector multiply routines
  */
 
 /** \addtogroup cudpp_app
@@ -21,200 +21,1804 @@
 
 #include <cstdlib>
 #include <cstdio>
+#include <cstring>
+#include <climits>
 #include <assert.h>
+#include <algorithm>
+#include <utility>
+#include <vector>
 
 #include "cuda_util.h"
 #include "cudpp.h"
 #include "cudpp_util.h"
 #include "cudpp_plan.h"
 #include "cudpp_globals.h"
+#include "cudpp_scan.h"
+#include "cudpp_radixsort.h"
 #include "kernel/spmvmult_kernel.cuh"
 
-extern "C"
-void cudppSegmentedScanDispatch (void                   *d_out, 
-                                 const void             *d_idata,
-                                 const unsigned int     *d_iflags,
-                                 int                    numElements,
-                                 const CUDPPSegmentedScanPlan *plan
-                                );
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 /** @name Sparse Matrix-Vector Multiply Functions
  * @{
  */
 
-/** @brief Perform matrix-vector multiply for sparse matrices and vectors of arbitrary size.
+/** @brief Perform matrix-vector multiply for a CSR matrix in host memory (CUDPP_OPTION_HOST).
+  *
+  * The merge path of the row end offsets and the nonzeros (rows plus
+  * nonzeros items) is split evenly over the OpenMP threads, at least
+  * SPMV_HOST_MIN_ITEMS items each, so rows of any length are balanced.  Each
+  * thread finds the start and end of its share with
+  * sparseMatrixVectorMergePathSearch() and accumulates the products of each
+  * row in registers, storing every row it completes.  The partial sum of the
+  * row a thread stops in is its carry-out, which is added to y after the
+  * threads finish; a row is completed by exactly one thread, which applies
+  * \a beta.  No temporaries of the size of the matrix are used.
+  *
+  * Template parameter \a NUM_VECTORS is the number of vectors of X and Y.
+  *
+  * @param[in,out] y The output vectors Y
+  * @param[in] x The input vectors X
+  * @param[in] yPitch The distance in elements between vectors of Y
+  * @param[in] xPitch The distance in elements between vectors of X
+  * @param[in] alpha The scale of A * X
+  * @param[in] beta The scale of Y
+  * @param[in] plan Pointer to the CUDPPSparseMatrixVectorMultiplyPlan object
+  */
+template <class T, int NUM_VECTORS>
+void sparseMatrixVectorMultiplyHost(T                       *y,
+                                    const T                 *x,
+                                    size_t                  yPitch,
+                                    size_t                  xPitch,
+                                    T                       alpha,
+                                    T                       beta,
+                                    const CUDPPSparseMatrixVectorMultiplyPlan *plan)
+{
+    const T *A = (const T*)plan->m_d_A;
+    const unsigned int *indx = plan->m_d_index;
+    const unsigned int *rowEnd = plan->m_rowFinalIndex;
+    unsigned int numRows = (unsigned int)plan->m_numRows;
+    unsigned int numNZElts = (unsigned int)plan->m_numNonZeroElements;
+    unsigned int pathLength = numRows + numNZElts;
+
+    int numThreads = 1;
+#ifdef _OPENMP
+    numThreads = omp_get_max_threads();
+#endif
+    if ((size_t)numThreads > pathLength / SPMV_HOST_MIN_ITEMS + 1)
+        numThreads = (int)(pathLength / SPMV_HOST_MIN_ITEMS + 1);
+
+    std::vector<unsigned int> carryRow(numThreads);
+    std::vector<T> carryValue(numThreads * NUM_VECTORS);
+
+#pragma omp parallel for num_threads(numThreads)
+    for (int t = 0; t < numThreads; ++t)
+    {
+        unsigned int diagonal = (unsigned int)((size_t)pathLength * t / numThreads);
+        unsigned int diagonalEnd = (unsigned int)((size_t)pathLength * (t + 1) / numThreads);
+
+        unsigned int row = sparseMatrixVectorMergePathSearch(diagonal, rowEnd,
+                                                             numRows, numNZElts);
+        unsigned int rowLast = sparseMatrixVectorMergePathSearch(diagonalEnd, rowEnd,
+                                                                 numRows, numNZElts);
+        unsigned int nz = diagonal - row;
+        unsigned int nzLast = diagonalEnd - rowLast;
+
+        T sum[NUM_VECTORS];
+        for (int v = 0; v < NUM_VECTORS; ++v)
+            sum[v] = 0;
+
+        for (; row < rowLast; ++row)
+        {
+            for (; nz < rowEnd[row]; ++nz)
+            {
+                T a = A[nz];
+                const T *xCol = x + indx[nz];
+                for (int v = 0; v < NUM_VECTORS; ++v)
+                    sum[v] += a * xCol[v * xPitch];
+            }
+            sparseMatrixVectorStoreRow<T, NUM_VECTORS>(y + row, sum, yPitch, alpha, beta);
+            for (int v = 0; v < NUM_VECTORS; ++v)
+                sum[v] = 0;
+        }
+        for (; nz < nzLast; ++nz)
+        {
+            T a = A[nz];
+            const T *xCol = x + indx[nz];
+            for (int v = 0; v < NUM_VECTORS; ++v)
+                sum[v] += a * xCol[v * xPitch];
+        }
+
+        carryRow[t] = rowLast;
+        for (int v = 0; v < NUM_VECTORS; ++v)
+            carryValue[t * NUM_VECTORS + v] = sum[v];
+    }
+
+    // A row split across threads was stored by the thread that completed
+    // it; add the partial sums of the threads before
+    for (int t = 0; t < numThreads; ++t)
+    {
+        if (carryRow[t] >= numRows)
+            continue;
+        for (int v = 0; v < NUM_VECTORS; ++v)
+            y[v * yPitch + carryRow[t]] += alpha * carryValue[t * NUM_VECTORS + v];
+    }
+}
+
+/** @brief Perform matrix-vector multiply for a CSR matrix with merge-path partitioning.
   *
-  * This function performs the sparse matrix-vector multiply by executing four steps. 
+  * This function computes Y = alpha * A * X + beta * Y using merge-path 
+  * partitioning of the CSR matrix, so work is split evenly over threads by 
+  * rows plus nonzeros rather than by rows.  It runs two kernels.
   *
-  * 1. The sparseMatrixVectorFetchAndMultiply() kernel does an element-wise multiplication of a
-  *    each element e in CUDPPSparseMatrixVectorMultiplyPlan::m_d_A with the corresponding 
-  *    (i.e. in the same row as the column index of e in CUDPPSparseMatrixVectorMultiplyPlan::m_d_A) 
-  *    element in d_x and stores the product in CUDPPSparseMatrixVectorMultiplyPlan::m_d_prod. It 
-  *    also sets all elements of CUDPPSparseMatrixVectorMultiplyPlan::m_d_flags to 0.
+  * 1. The sparseMatrixVectorMergePath() kernel gives each thread
+  *    SPMV_ITEMS_PER_THREAD items of the merge path of
+  *    CUDPPSparseMatrixVectorMultiplyPlan::m_d_rowFinalIndex and the nonzeros.
+  *    Rows completed within a tile are stored to d_y, and the partial sum of the
+  *    row each tile stops in is written to
+  *    CUDPPSparseMatrixVectorMultiplyPlan::m_d_carryRow and
+  *    CUDPPSparseMatrixVectorMultiplyPlan::m_d_carryValue.
   *
-  * 2. The sparseMatrixVectorSetFlags() kernel iterates over each element in 
-  *    CUDPPSparseMatrixVectorMultiplyPlan::m_d_rowIndex and sets 
-  *    the corresponding position (indicated by CUDPPSparseMatrixVectorMultiplyPlan::m_d_rowIndex) in 
-  *    CUDPPSparseMatrixVectorMultiplyPlan::m_d_flags to 1.
+  * 2. The sparseMatrixVectorMergePathFixup() kernel adds the tile carry-outs
+  *    to d_y.
   *
-  * 3. Perform a segmented scan on CUDPPSparseMatrixVectorMultiplyPlan::m_d_prod with 
-  *    CUDPPSparseMatrixVectorMultiplyPlan::m_d_flags as the flag vector. The output is 
-  *    stored in CUDPPSparseMatrixVectorMultiplyPlan::m_d_prod.
+  * Matrices created with CUDPP_OPTION_HOST are multiplied on the host by
+  * sparseMatrixVectorMultiplyHost() instead.
   *
-  * 4. The yGather() kernel goes over each element in CUDPPSparseMatrixVectorMultiplyPlan::m_d_rowFinalIndex 
-  *    and picks the corresponding element (indicated by CUDPPSparseMatrixVectorMultiplyPlan::m_d_rowFinalIndex) 
-  *    element from CUDPPSparseMatrixVectorMultiplyPlan::m_d_prod and stores it in d_y.
+  * Template parameter \a NUM_VECTORS is the number of vectors of X and Y.
   *
-  * @param[out] d_y The output array for the sparse matrix-vector multiply (y vector)
-  * @param[in] d_x The input x vector
-  * @param[in] plan Pointer to the CUDPPSparseMatrixVectorMultiplyPlan object which stores the 
+  * @param[in,out] d_y The output vectors Y
+  * @param[in] d_x The input vectors X
+  * @param[in] yPitch The distance in elements between vectors of Y
+  * @param[in] xPitch The distance in elements between vectors of X
+  * @param[in] alpha The scale of A * X
+  * @param[in] beta The scale of Y
+  * @param[in] plan Pointer to the CUDPPSparseMatrixVectorMultiplyPlan object which stores the
   *                 configuration and pointers to temporary buffers needed by this routine
   */
-template <class T>
+template <class T, int NUM_VECTORS>
+void sparseMatrixVectorMultiplyMergePath(
+                                 T                       *d_y,
+                                 const T                 *d_x,
+                                 size_t                  yPitch,
+                                 size_t                  xPitch,
+                                 T                       alpha,
+                                 T                       beta,
+                                 const CUDPPSparseMatrixVectorMultiplyPlan *plan
+                                )
+{
+    if (plan->m_config.options & CUDPP_OPTION_HOST)
+    {
+        sparseMatrixVectorMultiplyHost<T, NUM_VECTORS>(d_y, d_x, yPitch, xPitch,
+                                                       alpha, beta, plan);
+        return;
+    }
+
+    unsigned int numCarries = (unsigned int)plan->m_numCarries;
+
+    dim3 grid(min(numCarries, 65535u), 1, 1);
+    dim3 threads(SPMV_CTA_SIZE, 1, 1);
+
+    sparseMatrixVectorMergePath<T, NUM_VECTORS><<<grid, threads>>>
+        (d_y, plan->m_d_carryRow, (T*)plan->m_d_carryValue, (const T*)plan->m_d_A, d_x,
+         plan->m_d_index, plan->m_d_rowFinalIndex,
+         (unsigned)plan->m_numRows, (unsigned)plan->m_numNonZeroElements, numCarries,
+         yPitch, xPitch, alpha, beta);
+
+    dim3 gridFixup((numCarries + SPMV_CTA_SIZE - 1) / SPMV_CTA_SIZE, 1, 1);
+
+    sparseMatrixVectorMergePathFixup<T, NUM_VECTORS><<<gridFixup, threads>>>
+        (d_y, plan->m_d_carryRow, (const T*)plan->m_d_carryValue,
+         numCarries, (unsigned)plan->m_numRows, yPitch, alpha);
+}
+
+/** @brief Perform matrix-vector multiply for sparse matrices and vectors of arbitrary size.
+  *
+  * Computes Y = alpha * A * X + beta * Y for \a NUM_VECTORS vectors with the
+  * kernel for the storage format chosen when the matrix was created:
+  * sparseMatrixVectorMultiplyMergePath() for CSR, sparseMatrixVectorSlicedEll()
+  * for ELLPACK and SELL-C-sigma, and sparseMatrixVectorBlockRow() for BSR.
+  *
+  * @param[in,out] d_y The output vectors Y
+  * @param[in] d_x The input vectors X
+  * @param[in] yPitch The distance in elements between vectors of Y
+  * @param[in] xPitch The distance in elements between vectors of X
+  * @param[in] alpha The scale of A * X
+  * @param[in] beta The scale of Y
+  * @param[in] plan Pointer to the CUDPPSparseMatrixVectorMultiplyPlan object which stores the
+  *                 configuration and pointers to temporary buffers needed by this routine
+  */
+template <class T, int NUM_VECTORS>
 void sparseMatrixVectorMultiply(
-                                 T                       *d_y, 
-                                 const T                 *d_x,  
+                                 T                       *d_y,
+                                 const T                 *d_x,
+                                 size_t                  yPitch,
+                                 size_t                  xPitch,
+                                 T                       alpha,
+                                 T                       beta,
                                  const CUDPPSparseMatrixVectorMultiplyPlan *plan
                                 )
 {
-    unsigned int numEltsBlocks = 
-        max(1, (int)ceil((double)plan->m_numNonZeroElements / 
-                         ((double)SEGSCAN_ELTS_PER_THREAD * SCAN_CTA_SIZE)));
-    
-    bool fullBlock = 
-        (plan->m_numNonZeroElements == (numEltsBlocks * SEGSCAN_ELTS_PER_THREAD * SCAN_CTA_SIZE));  
+    unsigned int numRows = (unsigned int)plan->m_numRows;
+    unsigned int numCols = (unsigned int)plan->m_numCols;
+
+    dim3 grid(min((numRows + SPMV_CTA_SIZE - 1) / SPMV_CTA_SIZE, 65535u), 1, 1);
+    dim3 threads(SPMV_CTA_SIZE, 1, 1);
+
+    switch (plan->m_format)
+    {
+    case CUDPP_OPTION_SPMV_ELL:
+    case CUDPP_OPTION_SPMV_SELL:
+        sparseMatrixVectorSlicedEll<T, NUM_VECTORS><<<grid, threads>>>
+            (d_y, (const T*)plan->m_d_A, d_x, plan->m_d_index, plan->m_d_sliceStart,
+             plan->m_d_rowLength, plan->m_d_rowPermutation,
+             (unsigned)plan->m_sliceHeight, numRows, yPitch, xPitch, alpha, beta);
+        break;
+    case CUDPP_OPTION_SPMV_BSR:
+        switch (plan->m_blockSize)
+        {
+        case 2:
+            sparseMatrixVectorBlockRow<T, 2, NUM_VECTORS><<<grid, threads>>>
+                (d_y, (const T*)plan->m_d_A, d_x, plan->m_d_index,
+                 plan->m_d_rowFinalIndex, numRows, numCols, yPitch, xPitch, alpha, beta);
+            break;
+        case 3:
+            sparseMatrixVectorBlockRow<T, 3, NUM_VECTORS><<<grid, threads>>>
+                (d_y, (const T*)plan->m_d_A, d_x, plan->m_d_index,
+                 plan->m_d_rowFinalIndex, numRows, numCols, yPitch, xPitch, alpha, beta);
+            break;
+        default:
+            sparseMatrixVectorBlockRow<T, 4, NUM_VECTORS><<<grid, threads>>>
+                (d_y, (const T*)plan->m_d_A, d_x, plan->m_d_index,
+                 plan->m_d_rowFinalIndex, numRows, numCols, yPitch, xPitch, alpha, beta);
+            break;
+        }
+        break;
+    default:
+        sparseMatrixVectorMultiplyMergePath<T, NUM_VECTORS>(d_y, d_x, yPitch, xPitch,
+                                                            alpha, beta, plan);
+        break;
+    }
+
+    if (!(plan->m_config.options & CUDPP_OPTION_HOST))
+        CUDA_CHECK_ERROR("sparseMatrixVectorMultiply");
+}
+
+/** @brief Multiply up to SPMV_VECTORS_PER_PASS vectors with one read of the matrix.
+  *
+  * @param[in,out] d_y The output vectors Y
+  * @param[in] d_x The input vectors X
+  * @param[in] numVectors The number of vectors of X and Y, at most SPMV_VECTORS_PER_PASS
+  * @param[in] yPitch The distance in elements between vectors of Y
+  * @param[in] xPitch The distance in elements between vectors of X
+  * @param[in] alpha The scale of A * X
+  * @param[in] beta The scale of Y
+  * @param[in] plan Pointer to the CUDPPSparseMatrixVectorMultiplyPlan object
+  */
+template <class T>
+void sparseMatrixMultiplyPass(T                       *d_y,
+                              const T                 *d_x,
+                              size_t                  numVectors,
+                              size_t                  yPitch,
+                              size_t                  xPitch,
+                              T                       alpha,
+                              T                       beta,
+                              const CUDPPSparseMatrixVectorMultiplyPlan *plan)
+{
+    switch (numVectors)
+    {
+    case 1:
+        sparseMatrixVectorMultiply<T, 1>(d_y, d_x, yPitch, xPitch, alpha, beta, plan);
+        break;
+    case 2:
+        sparseMatrixVectorMultiply<T, 2>(d_y, d_x, yPitch, xPitch, alpha, beta, plan);
+        break;
+    case 3:
+        sparseMatrixVectorMultiply<T, 3>(d_y, d_x, yPitch, xPitch, alpha, beta, plan);
+        break;
+    default:
+        sparseMatrixVectorMultiply<T, 4>(d_y, d_x, yPitch, xPitch, alpha, beta, plan);
+        break;
+    }
+}
+
+/** @brief Perform sparse matrix-dense matrix multiply Y = alpha * A * X + beta * Y.
+  *
+  * The vectors are processed SPMV_VECTORS_PER_PASS at a time, so A is read
+  * once per pass rather than once per vector.  For a reordered matrix each
+  * pass gathers X (and Y, unless \a beta is zero) into the reordered 
+  * numbering, multiplies there, and scatters Y back.
+  *
+  * @param[in,out] d_y The output vectors Y
+  * @param[in] d_x The input vectors X
+  * @param[in] numVectors The number of vectors of X and Y
+  * @param[in] yPitch The distance in elements between vectors of Y
+  * @param[in] xPitch The distance in elements between vectors of X
+  * @param[in] alpha The scale of A * X
+  * @param[in] beta The scale of Y
+  * @param[in] plan Pointer to the CUDPPSparseMatrixVectorMultiplyPlan object
+  */
+template <class T>
+void sparseMatrixDenseMultiply(T                       *d_y,
+                               const T                 *d_x,
+                               size_t                  numVectors,
+                               size_t                  yPitch,
+                               size_t                  xPitch,
+                               T                       alpha,
+                               T                       beta,
+                               const CUDPPSparseMatrixVectorMultiplyPlan *plan)
+{
+    unsigned int n = (unsigned int)plan->m_numRows;
+    dim3 grid(min((n + SPMV_CTA_SIZE - 1) / SPMV_CTA_SIZE, 65535u), 1, 1);
+    dim3 threads(SPMV_CTA_SIZE, 1, 1);
+
+    for (size_t v = 0; v < numVectors; v += SPMV_VECTORS_PER_PASS)
+    {
+        T *y = d_y + v * yPitch;
+        const T *x = d_x + v * xPitch;
+        size_t passVectors = std::min(numVectors - v, (size_t)SPMV_VECTORS_PER_PASS);
+
+        if (!plan->m_permutation)
+        {
+            sparseMatrixMultiplyPass<T>(y, x, passVectors, yPitch, xPitch, alpha, beta, plan);
+            continue;
+        }
+
+        T *permutedX = (T*)plan->m_d_permutedX;
+        T *permutedY = (T*)plan->m_d_permutedY;
+
+        sparseMatrixGatherVectors<T><<<grid, threads>>>
+            (permutedX, x, plan->m_d_permutation, n, (unsigned)passVectors, n, xPitch);
+        if (beta != (T)0)
+            sparseMatrixGatherVectors<T><<<grid, threads>>>
+                (permutedY, y, plan->m_d_permutation, n, (unsigned)passVectors, n, yPitch);
+
+        sparseMatrixMultiplyPass<T>(permutedY, permutedX, passVectors, n, n, alpha, beta, plan);
+
+        sparseMatrixScatterVectors<T><<<grid, threads>>>
+            (y, permutedY, plan->m_d_permutation, n, (unsigned)passVectors, yPitch, n);
+    }
+
+    if (!(plan->m_config.options & CUDPP_OPTION_HOST))
+        CUDA_CHECK_ERROR("sparseMatrixDenseMultiply");
+}
+
+/** @brief Orders sorted positions by decreasing row length */
+struct RowLongerThan
+{
+    const unsigned int *m_rowLength; //!< Number of nonzeros of each row
+
+    RowLongerThan(const unsigned int *rowLength) : m_rowLength(rowLength) {}
+
+    bool operator()(unsigned int a, unsigned int b) const
+    {
+        return m_rowLength[a] > m_rowLength[b];
+    }
+};
+
+/** @brief Sort rows by decreasing length within windows of \a window rows.
+  *
+  * Sorting only within windows keeps rows close to their original position,
+  * which preserves the locality of the accesses to x and y.
+  *
+  * @param[out] rowPermutation The row at each sorted position
+  * @param[in] rowLength The number of nonzeros of each row
+  * @param[in] numRows The number of rows
+  * @param[in] window The number of rows per sorting window (sigma)
+  */
+void sortRowsByLength(unsigned int       *rowPermutation,
+                      const unsigned int *rowLength,
+                      size_t             numRows,
+                      size_t             window)
+{
+    for (size_t i = 0; i < numRows; ++i)
+        rowPermutation[i] = (unsigned int)i;
+
+    for (size_t w = 0; w < numRows; w += window)
+        std::stable_sort(rowPermutation + w,
+                         rowPermutation + std::min(w + window, numRows),
+                         RowLongerThan(rowLength));
+}
+
+/** @brief Compute the slice offsets of a sliced ELLPACK layout.
+  *
+  * Each slice is as wide as its longest row and is stored column-major
+  * with \a sliceHeight rows per column.
+  *
+  * @param[out] sliceStart The index of the first element of each slice, or
+  *                        NULL to only count the stored elements
+  * @param[in] rowPermutation The row at each sorted position
+  * @param[in] rowLength The number of nonzeros of each row
+  * @param[in] numRows The number of rows
+  * @param[in] sliceHeight The number of rows per slice (C)
+  * @returns The number of stored elements, including padding
+  */
+size_t slicedEllLayout(unsigned int       *sliceStart,
+                       const unsigned int *rowPermutation,
+                       const unsigned int *rowLength,
+                       size_t             numRows,
+                       size_t             sliceHeight)
+{
+    size_t numStored = 0;
+    for (size_t first = 0, slice = 0; first < numRows; first += sliceHeight, ++slice)
+    {
+        size_t width = 0;
+        size_t last = std::min(first + sliceHeight, numRows);
+        for (size_t i = first; i < last; ++i)
+            width = std::max(width, (size_t)rowLength[rowPermutation[i]]);
+
+        if (sliceStart)
+            sliceStart[slice] = (unsigned int)numStored;
+        numStored += width * sliceHeight;
+    }
+    return numStored;
+}
+
+/** @brief Compute the blocks of a block sparse row layout.
+  *
+  * Blocks of a block row are numbered in order of first appearance of their
+  * block column.  With \a blockCol NULL the blocks are only counted.
+  *
+  * @param[out] blockRowEnd The index one past the last block of each block row
+  * @param[out] blockCol The block column of each block
+  * @param[out] position The index in the stored blocks of each nonzero
+  * @param[in] rowEnd The index one past the last nonzero of each row
+  * @param[in] indx The column of each nonzero
+  * @param[in] numRows The number of rows
+  * @param[in] numCols The number of columns
+  * @param[in] blockSize The block dimension
+  * @returns The number of blocks
+  */
+size_t blockRowLayout(unsigned int       *blockRowEnd,
+                      unsigned int       *blockCol,
+                      unsigned int       *position,
+                      const unsigned int *rowEnd,
+                      const unsigned int *indx,
+                      size_t             numRows,
+                      size_t             numCols,
+                      size_t             blockSize)
+{
+    size_t numBlockRows = (numRows + blockSize - 1) / blockSize;
+    size_t numBlockCols = (numCols + blockSize - 1) / blockSize;
+
+    // The block row that last used each block column, and its block there
+    unsigned int *lastBlockRow = new unsigned int[numBlockCols];
+    unsigned int *block = new unsigned int[numBlockCols];
+    for (size_t i = 0; i < numBlockCols; ++i)
+        lastBlockRow[i] = UINT_MAX;
+
+    size_t numBlocks = 0;
+    for (size_t br = 0; br < numBlockRows; ++br)
+    {
+        size_t rowLast = std::min((br + 1) * blockSize, numRows);
+        for (size_t row = br * blockSize; row < rowLast; ++row)
+        {
+            for (size_t k = (row > 0) ? rowEnd[row-1] : 0; k < rowEnd[row]; ++k)
+            {
+                size_t bc = indx[k] / blockSize;
+                if (lastBlockRow[bc] != br)
+                {
+                    lastBlockRow[bc] = (unsigned int)br;
+                    block[bc] = (unsigned int)numBlocks;
+                    if (blockCol)
+                        blockCol[numBlocks] = (unsigned int)bc;
+                    ++numBlocks;
+                }
+                if (blockCol)
+                    position[k] = (unsigned int)(block[bc] * blockSize * blockSize +
+                                                 (row % blockSize) * blockSize +
+                                                 indx[k] % blockSize);
+            }
+        }
+        if (blockCol)
+            blockRowEnd[br] = (unsigned int)numBlocks;
+    }
+
+    delete [] lastBlockRow;
+    delete [] block;
+    return numBlocks;
+}
+
+/** @brief Orders vertices by increasing degree, then by index */
+struct VertexDegreeLess
+{
+    const unsigned int *m_degree; //!< Number of neighbors of each vertex
 
-    dim3  gridElts(max(1, numEltsBlocks), 1, 1);
-    dim3  threads(SCAN_CTA_SIZE, 1, 1);
+    VertexDegreeLess(const unsigned int *degree) : m_degree(degree) {}
 
-    if (fullBlock)
-        sparseMatrixVectorFetchAndMultiply<T, true><<<gridElts, threads>>>
-            (plan->m_d_flags, (T*)plan->m_d_prod, (T*)plan->m_d_A, d_x, plan->m_d_index, (unsigned)plan->m_numNonZeroElements);
+    bool operator()(unsigned int a, unsigned int b) const
+    {
+        return m_degree[a] < m_degree[b] || (m_degree[a] == m_degree[b] && a < b);
+    }
+};
+
+/** @brief Breadth-first level structure of the vertices reachable from \a root.
+  *
+  * Vertices are marked visited by setting \a mark to \a stamp, so 
+  * successive searches need not clear it.
+  *
+  * @param[out] order The vertices in visiting order
+  * @param[out] lastLevel The index in \a order of the first vertex of the last level
+  * @param[out] numVisited The number of vertices reached
+  * @param[in,out] mark The stamp of the last search that visited each vertex
+  * @param[in] stamp The stamp of this search
+  * @param[in] root The starting vertex
+  * @param[in] adjStart The index in \a adj of the first neighbor of each vertex, and the end
+  * @param[in] adj The neighbors of each vertex
+  * @returns The number of levels (the eccentricity of \a root plus one)
+  */
+size_t vertexLevels(unsigned int       *order,
+                    size_t             *lastLevel,
+                    size_t             *numVisited,
+                    unsigned int       *mark,
+                    unsigned int       stamp,
+                    unsigned int       root,
+                    const unsigned int *adjStart,
+                    const unsigned int *adj)
+{
+    size_t levelBegin = 0, levelEnd = 1, count = 1, numLevels = 1;
+    order[0] = root;
+    mark[root] = stamp;
+
+    for (;;)
+    {
+        for (size_t i = levelBegin; i < levelEnd; ++i)
+        {
+            unsigned int u = order[i];
+            for (unsigned int k = adjStart[u]; k < adjStart[u+1]; ++k)
+            {
+                if (mark[adj[k]] != stamp)
+                {
+                    mark[adj[k]] = stamp;
+                    order[count++] = adj[k];
+                }
+            }
+        }
+        if (count == levelEnd)
+            break;
+        levelBegin = levelEnd;
+        levelEnd = count;
+        ++numLevels;
+    }
+
+    *lastLevel = levelBegin;
+    *numVisited = count;
+    return numLevels;
+}
+
+/** @brief Compute the reverse Cuthill-McKee ordering of a sparse matrix.
+  *
+  * Works on the symmetrized pattern A + A^T.  Each connected component is
+  * numbered breadth-first from a pseudo-peripheral vertex (found with the 
+  * George-Liu search, which repeatedly restarts from a minimum-degree 
+  * vertex of the last level while the eccentricity grows), visiting the 
+  * neighbors of each vertex in increasing degree order; the whole order is
+  * then reversed.  This keeps the nonzeros of each row close to the 
+  * diagonal, so nearby rows read nearby elements of x.
+  *
+  * @param[out] permutation The original row (and column) of each new one
+  * @param[in] rowEnd The index one past the last nonzero of each row
+  * @param[in] indx The column of each nonzero, less than \a n
+  * @param[in] n The number of rows and columns
+  */
+void reverseCuthillMcKee(unsigned int       *permutation,
+                         const unsigned int *rowEnd,
+                         const unsigned int *indx,
+                         size_t             n)
+{
+    // Adjacency of the symmetrized pattern, without the diagonal
+    unsigned int *adjStart = new unsigned int[n + 1];
+    memset(adjStart, 0, (n + 1) * sizeof(unsigned int));
+    for (size_t row = 0, k = 0; row < n; ++row)
+    {
+        for (; k < rowEnd[row]; ++k)
+        {
+            if (indx[k] != row)
+            {
+                adjStart[row + 1]++;
+                adjStart[indx[k] + 1]++;
+            }
+        }
+    }
+    for (size_t i = 0; i < n; ++i)
+        adjStart[i + 1] += adjStart[i];
+
+    unsigned int *adj = new unsigned int[adjStart[n]];
+    unsigned int *next = new unsigned int[n];
+    memcpy(next, adjStart, n * sizeof(unsigned int));
+    for (size_t row = 0, k = 0; row < n; ++row)
+    {
+        for (; k < rowEnd[row]; ++k)
+        {
+            if (indx[k] != row)
+            {
+                adj[next[row]++] = indx[k];
+                adj[next[indx[k]]++] = (unsigned int)row;
+            }
+        }
+    }
+
+    unsigned int *degree = next;
+    for (size_t i = 0; i < n; ++i)
+        degree[i] = adjStart[i + 1] - adjStart[i];
+    for (size_t i = 0; i < n; ++i)
+        std::sort(adj + adjStart[i], adj + adjStart[i + 1], VertexDegreeLess(degree));
+
+    unsigned int *order = new unsigned int[n];
+    unsigned int *mark = new unsigned int[n];
+    memset(mark, 0, n * sizeof(unsigned int));
+    unsigned int stamp = 0;
+
+    // A vertex is numbered once mark[v] == UINT_MAX
+    size_t numNumbered = 0;
+    for (size_t v = 0; v < n; ++v)
+    {
+        if (mark[v] == UINT_MAX)
+            continue;
+
+        size_t lastLevel, numVisited;
+        unsigned int root = (unsigned int)v;
+        size_t numLevels = vertexLevels(order, &lastLevel, &numVisited, mark, ++stamp,
+                                        root, adjStart, adj);
+        for (;;)
+        {
+            unsigned int candidate = order[lastLevel];
+            for (size_t i = lastLevel + 1; i < numVisited; ++i)
+                if (VertexDegreeLess(degree)(order[i], candidate))
+                    candidate = order[i];
+
+            size_t candidateLastLevel, candidateVisited;
+            size_t candidateLevels = vertexLevels(order, &candidateLastLevel, 
+                                                  &candidateVisited, mark, ++stamp,
+                                                  candidate, adjStart, adj);
+            if (candidateLevels <= numLevels)
+                break;
+            root = candidate;
+            numLevels = candidateLevels;
+            lastLevel = candidateLastLevel;
+        }
+
+        // Cuthill-McKee numbering of the component, breadth-first from root
+        size_t head = numNumbered;
+        permutation[numNumbered++] = root;
+        mark[root] = UINT_MAX;
+        while (head < numNumbered)
+        {
+            unsigned int u = permutation[head++];
+            for (unsigned int k = adjStart[u]; k < adjStart[u+1]; ++k)
+            {
+                if (mark[adj[k]] != UINT_MAX)
+                {
+                    mark[adj[k]] = UINT_MAX;
+                    permutation[numNumbered++] = adj[k];
+                }
+            }
+        }
+    }
+
+    std::reverse(permutation, permutation + n);
+
+    delete [] mark;
+    delete [] order;
+    delete [] next;
+    delete [] adj;
+    delete [] adjStart;
+}
+
+/** @brief Renumber the rows and columns of a square CSR matrix.
+  *
+  * Row i of the result is row permutation[i] of the input, with every 
+  * column c renumbered to the i for which permutation[i] == c, and each 
+  * row sorted by its new columns.
+  *
+  * @param[out] newRowEnd The index one past the last nonzero of each new row
+  * @param[out] newIndx The new column of each nonzero, in the new order
+  * @param[out] newPosition The index in the new order of each input nonzero
+  * @param[in] permutation The original row (and column) of each new one
+  * @param[in] rowEnd The index one past the last nonzero of each row
+  * @param[in] indx The column of each nonzero
+  * @param[in] n The number of rows and columns
+  */
+void permuteSparseMatrix(unsigned int       *newRowEnd,
+                         unsigned int       *newIndx,
+                         unsigned int       *newPosition,
+                         const unsigned int *permutation,
+                         const unsigned int *rowEnd,
+                         const unsigned int *indx,
+                         size_t             n)
+{
+    unsigned int *inverse = new unsigned int[n];
+    for (size_t i = 0; i < n; ++i)
+        inverse[permutation[i]] = (unsigned int)i;
+
+    std::vector<std::pair<unsigned int, unsigned int> > row;
+    size_t k2 = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        size_t oldRow = permutation[i];
+        row.clear();
+        for (size_t k = (oldRow > 0) ? rowEnd[oldRow-1] : 0; k < rowEnd[oldRow]; ++k)
+            row.push_back(std::make_pair(inverse[indx[k]], (unsigned int)k));
+        std::sort(row.begin(), row.end());
+
+        for (size_t j = 0; j < row.size(); ++j, ++k2)
+        {
+            newIndx[k2] = row[j].first;
+            newPosition[row[j].second] = (unsigned int)k2;
+        }
+        newRowEnd[i] = (unsigned int)k2;
+    }
+
+    delete [] inverse;
+}
+
+/** @brief Choose the storage format of a sparse matrix.
+  *
+  * An explicit CUDPP_OPTION_SPMV_* option is honored.  Otherwise the format
+  * is picked from the row length statistics, preferring the formats that
+  * read the fewest indices per nonzero:
+  *
+  * - BSR, if some block dimension up to SPMV_BSR_MAX_BLOCK stores at most
+  *   SPMV_MAX_FILL times the nonzeros,
+  * - ELLPACK, if padding every row to the longest one stores at most
+  *   SPMV_MAX_FILL times the nonzeros,
+  * - SELL-C-sigma, if its padding stays below the same bound and the longest
+  *   row is at most SPMV_SELL_MAX_ROW_SKEW times the average, since each row
+  *   is computed by one thread,
+  * - CSR with merge-path load balancing otherwise, which is insensitive to
+  *   the row length distribution.
+  *
+  * @param[out] blockSize The block dimension with the least fill, for BSR
+  * @param[in] plan The sparse matrix plan, with the number of columns set
+  * @param[in] rowEnd The index one past the last nonzero of each row
+  * @param[in] rowLength The number of nonzeros of each row
+  * @param[in] indx The column of each nonzero
+  * @returns The storage format
+  */
+CUDPPOption chooseSparseMatrixFormat(size_t             *blockSize,
+                                     const CUDPPSparseMatrixVectorMultiplyPlan *plan,
+                                     const unsigned int *rowEnd,
+                                     const unsigned int *rowLength,
+                                     const unsigned int *indx)
+{
+    unsigned int requested = plan->m_config.options &
+        (CUDPP_OPTION_SPMV_CSR | CUDPP_OPTION_SPMV_ELL |
+         CUDPP_OPTION_SPMV_SELL | CUDPP_OPTION_SPMV_BSR);
+    size_t numRows = plan->m_numRows;
+    double maxStored = SPMV_MAX_FILL * plan->m_numNonZeroElements;
+
+    if (requested == CUDPP_OPTION_SPMV_CSR)
+        return CUDPP_OPTION_SPMV_CSR;
+
+    if (requested == 0 || requested == CUDPP_OPTION_SPMV_BSR)
+    {
+        size_t bestStored = 0;
+        for (size_t b = 2; b <= SPMV_BSR_MAX_BLOCK; ++b)
+        {
+            size_t stored = b * b * blockRowLayout(0, 0, 0, rowEnd, indx,
+                                                   numRows, plan->m_numCols, b);
+            if (bestStored == 0 || stored < bestStored)
+            {
+                bestStored = stored;
+                *blockSize = b;
+            }
+        }
+        if (requested == CUDPP_OPTION_SPMV_BSR || bestStored <= maxStored)
+            return CUDPP_OPTION_SPMV_BSR;
+    }
+
+    size_t maxLength = 0;
+    for (size_t i = 0; i < numRows; ++i)
+        maxLength = std::max(maxLength, (size_t)rowLength[i]);
+
+    if (requested == CUDPP_OPTION_SPMV_ELL ||
+        (requested == 0 && maxLength * numRows <= maxStored))
+        return CUDPP_OPTION_SPMV_ELL;
+
+    if (requested == CUDPP_OPTION_SPMV_SELL)
+        return CUDPP_OPTION_SPMV_SELL;
+
+    if (maxLength * numRows <= SPMV_SELL_MAX_ROW_SKEW * plan->m_numNonZeroElements)
+    {
+        unsigned int *rowPermutation = new unsigned int[numRows];
+        sortRowsByLength(rowPermutation, rowLength, numRows, SPMV_SELL_SORT_WINDOW);
+        size_t stored = slicedEllLayout(0, rowPermutation, rowLength,
+                                        numRows, SPMV_SELL_SLICE_HEIGHT);
+        delete [] rowPermutation;
+
+        if (stored <= maxStored)
+            return CUDPP_OPTION_SPMV_SELL;
+    }
+
+    return CUDPP_OPTION_SPMV_CSR;
+}
+
+/** @brief Allocate a GPU array and copy \a n unsigned ints to it
+  *
+  * @param[out] d_array The GPU array
+  * @param[in] h_array The host array
+  * @param[in] n The number of elements
+  */
+void uploadSparseMatrixIndices(unsigned int       **d_array,
+                               const unsigned int *h_array,
+                               size_t             n)
+{
+    CUDA_SAFE_CALL(cudaMalloc((void **)d_array, n * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMemcpy(*d_array, h_array, n * sizeof(unsigned int),
+                              cudaMemcpyHostToDevice));
+}
+
+/** @brief Copy the nonzeros of A to the stored elements on the GPU.
+  *
+  * Nonzero k of the CSR input is added to stored element
+  * CUDPPSparseMatrixVectorMultiplyPlan::m_position[k] on the host, so
+  * duplicate entries are summed as in CSR, and padding is zero.  For CSR
+  * (no position map) A is copied as is, with memcpy for a matrix in host
+  * memory (CUDPP_OPTION_HOST).
+  *
+  * @param[in,out] plan The sparse matrix plan, with m_d_A allocated
+  * @param[in] A The nonzeros of A in CSR order
+  */
+template <class T>
+void copySparseMatrixValues(CUDPPSparseMatrixVectorMultiplyPlan *plan,
+                            const T                             *A)
+{
+    if (plan->m_position)
+    {
+        T *stored = new T[plan->m_numStoredElements];
+        for (size_t i = 0; i < plan->m_numStoredElements; ++i)
+            stored[i] = 0;
+        for (size_t k = 0; k < plan->m_numNonZeroElements; ++k)
+            stored[plan->m_position[k]] += A[k];
+
+        CUDA_SAFE_CALL(cudaMemcpy(plan->m_d_A, stored,
+                                  plan->m_numStoredElements * sizeof(T),
+                                  cudaMemcpyHostToDevice));
+        delete [] stored;
+    }
+    else if (plan->m_config.options & CUDPP_OPTION_HOST)
+    {
+        memcpy(plan->m_d_A, A, plan->m_numStoredElements * sizeof(T));
+    }
     else
-        sparseMatrixVectorFetchAndMultiply<T, false><<<gridElts, threads>>>
-            (plan->m_d_flags, (T*)plan->m_d_prod, (T*)plan->m_d_A, d_x, plan->m_d_index, (unsigned)plan->m_numNonZeroElements);
+    {
+        CUDA_SAFE_CALL(cudaMemcpy(plan->m_d_A, A,
+                                  plan->m_numStoredElements * sizeof(T),
+                                  cudaMemcpyHostToDevice));
+    }
+}
 
-    unsigned int numRowBlocks = 
-        max(1, (int)ceil((double)plan->m_numRows / 
-                         ((double)SEGSCAN_ELTS_PER_THREAD * SCAN_CTA_SIZE)));
+/** @brief Allocate the stored elements of A and copy them to the GPU.
+  *
+  * For CSR the merge-path carry values are allocated as well, and for a
+  * reordered matrix the permuted copies of x and y, for 
+  * SPMV_VECTORS_PER_PASS vectors.  A matrix created with CUDPP_OPTION_HOST
+  * keeps only its elements, in host memory.
+  *
+  * @param[in,out] plan The sparse matrix plan
+  * @param[in] A The nonzeros of A in CSR order
+  */
+template <class T>
+void uploadSparseMatrixValues(CUDPPSparseMatrixVectorMultiplyPlan *plan,
+                              const T                             *A)
+{
+    if (plan->m_config.options & CUDPP_OPTION_HOST)
+    {
+        plan->m_d_A = malloc(plan->m_numStoredElements * sizeof(T));
+        copySparseMatrixValues<T>(plan, A);
+        return;
+    }
 
-    dim3  gridRows(max(1, numRowBlocks), 1, 1);
+    CUDA_SAFE_CALL(cudaMalloc(&(plan->m_d_A), plan->m_numStoredElements * sizeof(T)));
+    if (plan->m_format == CUDPP_OPTION_SPMV_CSR)
+        CUDA_SAFE_CALL(cudaMalloc(&(plan->m_d_carryValue), 
+                                  plan->m_numCarries * SPMV_VECTORS_PER_PASS * sizeof(T)));
+    if (plan->m_permutation)
+    {
+        CUDA_SAFE_CALL(cudaMalloc(&(plan->m_d_permutedX), 
+                                  plan->m_numRows * SPMV_VECTORS_PER_PASS * sizeof(T)));
+        CUDA_SAFE_CALL(cudaMalloc(&(plan->m_d_permutedY), 
+                                  plan->m_numRows * SPMV_VECTORS_PER_PASS * sizeof(T)));
+    }
 
-    sparseMatrixVectorSetFlags<<<gridRows, threads>>>
-        (plan->m_d_flags, plan->m_d_rowIndex, (unsigned)plan->m_numRows);
+    copySparseMatrixValues<T>(plan, A);
+}
 
-    cudppSegmentedScanDispatch ((T*)plan->m_d_prod, 
-                                (const T*)plan->m_d_prod,
-                                plan->m_d_flags,
-                                (unsigned)plan->m_numNonZeroElements, plan->m_segmentedScanPlan);
+/** @brief Overwrite the stored elements of A with new values of the same pattern.
+  *
+  * CSR values are copied directly.  For the other formats the new values are
+  * copied to a staging array and placed by the sparseMatrixScatterValues()
+  * kernel using the position map; the staging array and the GPU copy of the
+  * map are allocated on the first update and reused afterwards.  If several
+  * nonzeros share a stored element (duplicate entries within a BSR block),
+  * the values are summed on the host instead, as at creation.
+  *
+  * If the transpose of A has been built, its values are updated as well.
+  *
+  * @param[in,out] plan The sparse matrix plan
+  * @param[in] A The new nonzeros of A in CSR order
+  */
+template <class T>
+void updateSparseMatrixValues(CUDPPSparseMatrixVectorMultiplyPlan *plan,
+                              const T                             *A)
+{
+    if (plan->m_transpose)
+    {
+        T *transposeA = new T[plan->m_numNonZeroElements];
+        for (size_t k = 0; k < plan->m_numNonZeroElements; ++k)
+            transposeA[plan->m_transposePosition[k]] = A[k];
+        updateSparseMatrixValues<T>(plan->m_transpose, transposeA);
+        delete [] transposeA;
+    }
 
-    yGather<<<gridRows, threads>>>
-        (d_y, (T*)plan->m_d_prod, plan->m_d_rowFinalIndex, (unsigned)plan->m_numRows); 
+    if (!plan->m_position || plan->m_hasSharedElements)
+    {
+        copySparseMatrixValues<T>(plan, A);
+        return;
+    }
+
+    size_t numNZElts = plan->m_numNonZeroElements;
+    if (!plan->m_d_values)
+    {
+        CUDA_SAFE_CALL(cudaMalloc(&(plan->m_d_values), numNZElts * sizeof(T)));
+        uploadSparseMatrixIndices(&plan->m_d_position, plan->m_position, numNZElts);
+    }
+
+    CUDA_SAFE_CALL(cudaMemcpy(plan->m_d_values, A, numNZElts * sizeof(T),
+                              cudaMemcpyHostToDevice));
+
+    dim3 grid(min((unsigned int)((numNZElts + SPMV_CTA_SIZE - 1) / SPMV_CTA_SIZE), 65535u), 1, 1);
+    dim3 threads(SPMV_CTA_SIZE, 1, 1);
+
+    sparseMatrixScatterValues<T><<<grid, threads>>>
+        ((T*)plan->m_d_A, (const T*)plan->m_d_values, plan->m_d_position,
+         (unsigned)numNZElts);
+
+    CUDA_CHECK_ERROR("updateSparseMatrixValues");
+}
+
+/** @brief Read the nonzeros of A back from the GPU in CSR order.
+  *
+  * The column of each nonzero is decoded from the storage format and, for a
+  * reordered matrix, mapped back to the original numbering.  Nonzeros that
+  * share a stored element carry their sum in the first of them and zero in
+  * the others.
+  *
+  * @param[in] plan The sparse matrix plan
+  * @param[out] column The column of each nonzero in CSR order
+  * @param[out] values The value of each nonzero in CSR order
+  */
+template <class T>
+void downloadSparseMatrix(const CUDPPSparseMatrixVectorMultiplyPlan *plan,
+                          unsigned int                              *column,
+                          T                                         *values)
+{
+    size_t numNZElts = plan->m_numNonZeroElements;
+    size_t b = plan->m_blockSize;
+
+    unsigned int *storedIndex = new unsigned int[plan->m_numIndices];
+    T *stored = new T[plan->m_numStoredElements];
+    CUDA_SAFE_CALL(cudaMemcpy(storedIndex, plan->m_d_index,
+                              plan->m_numIndices * sizeof(unsigned int),
+                              cudaMemcpyDeviceToHost));
+    CUDA_SAFE_CALL(cudaMemcpy(stored, plan->m_d_A,
+                              plan->m_numStoredElements * sizeof(T),
+                              cudaMemcpyDeviceToHost));
+
+    bool *isUsed = 0;
+    if (plan->m_hasSharedElements)
+    {
+        isUsed = new bool[plan->m_numStoredElements];
+        memset(isUsed, 0, plan->m_numStoredElements * sizeof(bool));
+    }
+
+    for (size_t k = 0; k < numNZElts; ++k)
+    {
+        size_t p = plan->m_position ? plan->m_position[k] : k;
+        column[k] = b ? (unsigned int)(storedIndex[p / (b * b)] * b + p % b)
+                      : storedIndex[p];
+        if (plan->m_permutation)
+            column[k] = plan->m_permutation[column[k]];
+        values[k] = (isUsed && isUsed[p]) ? (T)0 : stored[p];
+        if (isUsed)
+            isUsed[p] = true;
+    }
+
+    delete [] isUsed;
+    delete [] stored;
+    delete [] storedIndex;
+}
+
+/** @brief Build the transpose of A used by transposed multiplies.
+  *
+  * The transpose is kept as a second matrix whose rows are the columns of A
+  * (a CSC view of A) and which is converted to a storage format like any 
+  * other, so A^T * x runs the same gather kernels as A * x, with no atomic 
+  * scatter.  Column indices and values are read back from the GPU copy of A
+  * with downloadSparseMatrix(), so no host copy of the matrix is kept.  The
+  * index of each nonzero of A in the transpose is recorded in 
+  * CUDPPSparseMatrixVectorMultiplyPlan::m_transposePosition for value updates.
+  *
+  * @param[in,out] plan The sparse matrix plan
+  */
+template <class T>
+void buildSparseMatrixTranspose(CUDPPSparseMatrixVectorMultiplyPlan *plan)
+{
+    size_t numRows = plan->m_numRows;
+    size_t numCols = plan->m_numCols;
+    size_t numNZElts = plan->m_numNonZeroElements;
+    const unsigned int *rowEnd = plan->m_rowFinalIndex;
+
+    unsigned int *column = new unsigned int[numNZElts];
+    T *values = new T[numNZElts];
+    downloadSparseMatrix<T>(plan, column, values);
+
+    // The start of each column of A
+    unsigned int *columnStart = new unsigned int[numCols + 1];
+    memset(columnStart, 0, (numCols + 1) * sizeof(unsigned int));
+    for (size_t k = 0; k < numNZElts; ++k)
+        columnStart[column[k] + 1]++;
+    for (size_t c = 0; c < numCols; ++c)
+        columnStart[c + 1] += columnStart[c];
+
+    // Counting sort of the nonzeros by column, rows ascending in each column
+    unsigned int *next = new unsigned int[numCols];
+    memcpy(next, columnStart, numCols * sizeof(unsigned int));
+    unsigned int *transposeIndex = new unsigned int[numNZElts];
+    T *transposeA = new T[numNZElts];
+
+    plan->m_transposePosition = new unsigned int[numNZElts];
+    for (size_t row = 0, k = 0; row < numRows; ++row)
+    {
+        for (; k < rowEnd[row]; ++k)
+        {
+            unsigned int q = next[column[k]]++;
+            transposeIndex[q] = (unsigned int)row;
+            transposeA[q] = values[k];
+            plan->m_transposePosition[k] = q;
+        }
+    }
+
+    plan->m_transpose = new CUDPPSparseMatrixVectorMultiplyPlan(plan->m_planManager,
+                                                                plan->m_config,
+                                                                numNZElts, transposeA,
+                                                                columnStart,
+                                                                transposeIndex,
+                                                                numCols);
+
+    delete [] transposeA;
+    delete [] transposeIndex;
+    delete [] next;
+    delete [] columnStart;
+    delete [] values;
+    delete [] column;
+}
+
+/** @brief The CSR arrays of an operand of a sparse matrix product, in GPU memory */
+struct SparseMatrixOperand
+{
+    const unsigned int *d_rowEnd; //!< The end of each row
+    const unsigned int *d_index;  //!< The column of each nonzero
+    const void         *d_values; //!< The nonzeros
+    bool               isCopy;    //!< Whether the arrays were copied and must be freed
+};
+
+/** @brief Get the CSR arrays of a matrix for a sparse matrix product.
+  *
+  * A CSR matrix that is not reordered is used in place.  Other matrices are
+  * read back with downloadSparseMatrix() and copied to the GPU in CSR order;
+  * the copies are freed by freeSparseMatrixOperand().
+  *
+  * @param[out] operand The CSR arrays
+  * @param[in] plan The sparse matrix plan
+  */
+template <class T>
+void getSparseMatrixOperand(SparseMatrixOperand                       *operand,
+                            const CUDPPSparseMatrixVectorMultiplyPlan *plan)
+{
+    operand->isCopy = (plan->m_format != CUDPP_OPTION_SPMV_CSR || plan->m_permutation);
+    if (!operand->isCopy)
+    {
+        operand->d_rowEnd = plan->m_d_rowFinalIndex;
+        operand->d_index = plan->m_d_index;
+        operand->d_values = plan->m_d_A;
+        return;
+    }
+
+    size_t numNZElts = plan->m_numNonZeroElements;
+    unsigned int *column = new unsigned int[numNZElts];
+    T *values = new T[numNZElts];
+    downloadSparseMatrix<T>(plan, column, values);
+
+    unsigned int *d_rowEnd;
+    unsigned int *d_index;
+    T *d_values;
+    uploadSparseMatrixIndices(&d_rowEnd, plan->m_rowFinalIndex, plan->m_numRows);
+    uploadSparseMatrixIndices(&d_index, column, numNZElts);
+    CUDA_SAFE_CALL(cudaMalloc((void **)&d_values, numNZElts * sizeof(T)));
+    CUDA_SAFE_CALL(cudaMemcpy(d_values, values, numNZElts * sizeof(T),
+                              cudaMemcpyHostToDevice));
+
+    operand->d_rowEnd = d_rowEnd;
+    operand->d_index = d_index;
+    operand->d_values = d_values;
+
+    delete [] values;
+    delete [] column;
+}
+
+/** @brief Free the arrays of a sparse matrix product operand if they are copies
+  *
+  * @param[in] operand The CSR arrays from getSparseMatrixOperand()
+  */
+void freeSparseMatrixOperand(SparseMatrixOperand *operand)
+{
+    if (operand->isCopy)
+    {
+        cudaFree((void*)operand->d_rowEnd);
+        cudaFree((void*)operand->d_index);
+        cudaFree((void*)operand->d_values);
+    }
+}
+
+/** @brief Sort the products of L * R by row and column and find the nonzeros of the result.
+  *
+  * The (row, column) key of each product is computed with 
+  * sparseMatrixProductKeys() and the keys are sorted with the product index
+  * as value by cudppRadixSortDispatch().  Each run of equal keys is one 
+  * nonzero of the result: the runs are flagged and numbered with 
+  * cudppScanDispatch(), and sparseMatrixProductElements() writes the start,
+  * row and column of each.  \a K is unsigned int when the number of rows
+  * times the number of columns fits in 32 bits and unsigned long long 
+  * otherwise.
+  *
+  * @param[out] d_start The first sorted product of each nonzero, and the number of products
+  * @param[out] d_row The row of each nonzero
+  * @param[out] d_index The column of each nonzero
+  * @param[in,out] d_order The product at each sorted position
+  * @param[in] d_offset The index of the first product of each nonzero of L
+  * @param[in] left The CSR arrays of L
+  * @param[in] right The CSR arrays of R
+  * @param[in] numRows The number of rows of L
+  * @param[in] numLeftNZElts The number of nonzeros of L
+  * @param[in] numProducts The number of products
+  * @param[in] numCols The number of columns of R
+  * @param[in] mgr The CUDPP manager for the sort and scan plans
+  * @returns The number of nonzeros of the result
+  */
+template <class K>
+size_t sortSparseMatrixProducts(unsigned int              **d_start,
+                                unsigned int              **d_row,
+                                unsigned int              **d_index,
+                                unsigned int              *d_order,
+                                const unsigned int        *d_offset,
+                                const SparseMatrixOperand &left,
+                                const SparseMatrixOperand &right,
+                                size_t                    numRows,
+                                size_t                    numLeftNZElts,
+                                size_t                    numProducts,
+                                size_t                    numCols,
+                                CUDPPManager              *mgr)
+{
+    K *d_keys;
+    unsigned int *d_flags;
+    unsigned int *d_element;
+    CUDA_SAFE_CALL(cudaMalloc((void **)&d_keys, numProducts * sizeof(K)));
+    CUDA_SAFE_CALL(cudaMalloc((void **)&d_flags, numProducts * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void **)&d_element, numProducts * sizeof(unsigned int)));
+
+    dim3 grid(min((unsigned int)((numProducts + SPMV_CTA_SIZE - 1) / SPMV_CTA_SIZE), 65535u), 1, 1);
+    dim3 threads(SPMV_CTA_SIZE, 1, 1);
+
+    sparseMatrixProductKeys<K><<<grid, threads>>>
+        (d_keys, d_order, d_offset, left.d_rowEnd, left.d_index,
+         right.d_rowEnd, right.d_index, (unsigned)numRows, 
+         (unsigned)numLeftNZElts, (unsigned)numProducts, (unsigned)numCols);
+
+    CUDPPConfiguration sortConfig = 
+    { 
+        CUDPP_SORT_RADIX, 
+        CUDPP_ADD, 
+        (sizeof(K) == sizeof(unsigned int)) ? CUDPP_UINT : CUDPP_ULONGLONG, 
+        CUDPP_OPTION_KEY_VALUE_PAIRS 
+    };
+    CUDPPRadixSortPlan *sortPlan = new CUDPPRadixSortPlan(mgr, sortConfig, numProducts);
+    cudppRadixSortDispatch(d_keys, d_order, numProducts, sortPlan);
+    delete sortPlan;
+
+    sparseMatrixProductHeads<K><<<grid, threads>>>
+        (d_flags, d_keys, (unsigned)numProducts);
+
+    CUDPPConfiguration scanConfig = 
+    { 
+        CUDPP_SCAN, 
+        CUDPP_ADD, 
+        CUDPP_UINT, 
+        CUDPP_OPTION_FORWARD | CUDPP_OPTION_EXCLUSIVE 
+    };
+    CUDPPScanPlan *scanPlan = new CUDPPScanPlan(mgr, scanConfig, numProducts, 1, 0);
+    cudppScanDispatch(d_element, d_flags, numProducts, 1, scanPlan);
+    delete scanPlan;
+
+    unsigned int lastElement, lastFlag;
+    CUDA_SAFE_CALL(cudaMemcpy(&lastElement, d_element + numProducts - 1,
+                              sizeof(unsigned int), cudaMemcpyDeviceToHost));
+    CUDA_SAFE_CALL(cudaMemcpy(&lastFlag, d_flags + numProducts - 1,
+                              sizeof(unsigned int), cudaMemcpyDeviceToHost));
+    size_t numElements = lastElement + lastFlag;
+
+    unsigned int end = (unsigned int)numProducts;
+    CUDA_SAFE_CALL(cudaMalloc((void **)d_start, (numElements + 1) * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void **)d_row, numElements * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void **)d_index, numElements * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMemcpy(*d_start + numElements, &end, sizeof(unsigned int),
+                              cudaMemcpyHostToDevice));
+
+    sparseMatrixProductElements<K><<<grid, threads>>>
+        (*d_start, *d_row, *d_index, d_keys, d_flags, d_element,
+         (unsigned)numProducts, (unsigned)numCols);
+
+    cudaFree(d_element);
+    cudaFree(d_flags);
+    cudaFree(d_keys);
+
+    CUDA_CHECK_ERROR("sortSparseMatrixProducts");
+
+    return numElements;
+}
+
+/** @brief Compute the nonzeros of a sparse matrix product with sparseMatrixProductValues()
+  *
+  * @param[out] d_values The nonzeros of the result in CSR order
+  * @param[in] d_start The first sorted product of each nonzero, and the number of products
+  * @param[in] d_order The product at each sorted position
+  * @param[in] d_offset The index of the first product of each nonzero of L
+  * @param[in] left The CSR arrays of L
+  * @param[in] right The CSR arrays of R
+  * @param[in] numLeftNZElts The number of nonzeros of L
+  * @param[in] numElements The number of nonzeros of the result
+  */
+template <class T>
+void multiplySparseMatrixValues(T                         *d_values,
+                                const unsigned int        *d_start,
+                                const unsigned int        *d_order,
+                                const unsigned int        *d_offset,
+                                const SparseMatrixOperand &left,
+                                const SparseMatrixOperand &right,
+                                size_t                    numLeftNZElts,
+                                size_t                    numElements)
+{
+    dim3 grid(min((unsigned int)((numElements + SPMV_CTA_SIZE - 1) / SPMV_CTA_SIZE), 65535u), 1, 1);
+    dim3 threads(SPMV_CTA_SIZE, 1, 1);
+
+    sparseMatrixProductValues<T><<<grid, threads>>>
+        (d_values, d_start, d_order, d_offset, left.d_index, (const T*)left.d_values,
+         right.d_rowEnd, (const T*)right.d_values, (unsigned)numLeftNZElts,
+         (unsigned)numElements);
+
+    CUDA_CHECK_ERROR("multiplySparseMatrixValues");
+}
+
+/** @brief Compute the sparse matrix product C = A * B, or C = A^T * B.
+  *
+  * The product runs in two phases, on the GPU, with CSR operands from
+  * getSparseMatrixOperand(); for A^T the cached transpose of A is used
+  * (built by buildSparseMatrixTranspose() if needed).  In the symbolic 
+  * phase, nonzero (i, k) of the left operand L contributes one product for
+  * each nonzero of row k of B: sparseMatrixProductCounts() counts them and 
+  * cudppScanDispatch() turns the counts into the offset of each nonzero's
+  * products.  sortSparseMatrixProducts() then sorts the products by row
+  * and column, which gives the pattern of C.  In the numeric phase 
+  * sparseMatrixProductValues() sums the products of each nonzero of C.
+  *
+  * C is then created from its CSR arrays like any other sparse matrix, 
+  * with the storage format options of \a config.  The product offsets,
+  * the sorted order and the start of each nonzero are kept in C, so that
+  * recomputeSparseMatrixProduct() can repeat only the numeric phase.
+  *
+  * @param[out] product The new sparse matrix C
+  * @param[in] mgr The CUDPP manager of C
+  * @param[in] config The configuration of C
+  * @param[in,out] A The first operand
+  * @param[in] B The second operand
+  * @returns CUDPP_SUCCESS, or CUDPP_ERROR_ILLEGAL_CONFIGURATION if C has no 
+  *          nonzeros or there are more than 2^32 - 1 products
+  */
+template <class T>
+CUDPPResult sparseMatrixMultiply(CUDPPSparseMatrixVectorMultiplyPlan **product,
+                                 CUDPPManager                        *mgr,
+                                 CUDPPConfiguration                  config,
+                                 CUDPPSparseMatrixVectorMultiplyPlan *A,
+                                 CUDPPSparseMatrixVectorMultiplyPlan *B)
+{
+    bool transposeA = (config.options & CUDPP_OPTION_SPMV_TRANSPOSE_A) != 0;
+    if (transposeA && !A->m_transpose)
+        buildSparseMatrixTranspose<T>(A);
+    const CUDPPSparseMatrixVectorMultiplyPlan *L = transposeA ? A->m_transpose : A;
+
+    SparseMatrixOperand left, right;
+    getSparseMatrixOperand<T>(&left, L);
+    getSparseMatrixOperand<T>(&right, B);
+
+    size_t numRows = L->m_numRows;
+    size_t numLeftNZElts = L->m_numNonZeroElements;
+    size_t numCols = B->m_numCols;
+
+    // Symbolic phase: the offset of the products of each nonzero of L
+    unsigned int *d_count;
+    unsigned int *d_offset;
+    CUDA_SAFE_CALL(cudaMalloc((void **)&d_count, numLeftNZElts * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void **)&d_offset, numLeftNZElts * sizeof(unsigned int)));
+
+    dim3 grid(min((unsigned int)((numLeftNZElts + SPMV_CTA_SIZE - 1) / SPMV_CTA_SIZE), 65535u), 1, 1);
+    dim3 threads(SPMV_CTA_SIZE, 1, 1);
+
+    sparseMatrixProductCounts<<<grid, threads>>>
+        (d_count, left.d_index, right.d_rowEnd, (unsigned)numLeftNZElts);
+
+    CUDPPConfiguration scanConfig = 
+    { 
+        CUDPP_SCAN, 
+        CUDPP_ADD, 
+        CUDPP_UINT, 
+        CUDPP_OPTION_FORWARD | CUDPP_OPTION_EXCLUSIVE 
+    };
+    CUDPPScanPlan *scanPlan = new CUDPPScanPlan(mgr, scanConfig, numLeftNZElts, 1, 0);
+    cudppScanDispatch(d_offset, d_count, numLeftNZElts, 1, scanPlan);
+    delete scanPlan;
+
+    unsigned int lastOffset, lastCount;
+    CUDA_SAFE_CALL(cudaMemcpy(&lastOffset, d_offset + numLeftNZElts - 1,
+                              sizeof(unsigned int), cudaMemcpyDeviceToHost));
+    CUDA_SAFE_CALL(cudaMemcpy(&lastCount, d_count + numLeftNZElts - 1,
+                              sizeof(unsigned int), cudaMemcpyDeviceToHost));
+    size_t numProducts = (size_t)lastOffset + lastCount;
+
+    // Product indices are 32-bit, so give up if their sum wrapped
+    unsigned int *d_overflow;
+    unsigned int overflow = 0;
+    CUDA_SAFE_CALL(cudaMalloc((void **)&d_overflow, sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMemset(d_overflow, 0, sizeof(unsigned int)));
+    sparseMatrixProductOverflow<<<grid, threads>>>
+        (d_overflow, d_offset, d_count, (unsigned)numLeftNZElts);
+    CUDA_SAFE_CALL(cudaMemcpy(&overflow, d_overflow, sizeof(unsigned int),
+                              cudaMemcpyDeviceToHost));
+    cudaFree(d_overflow);
+    cudaFree(d_count);
+    if (overflow || numProducts > UINT_MAX)
+    {
+        cudaFree(d_offset);
+        freeSparseMatrixOperand(&right);
+        freeSparseMatrixOperand(&left);
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+    }
+
+    // Sort the products into the nonzeros of C
+    size_t numElements = 0;
+    unsigned int *d_order = 0;
+    unsigned int *d_start = 0;
+    unsigned int *d_row = 0;
+    unsigned int *d_index = 0;
+    if (numProducts > 0)
+    {
+        CUDA_SAFE_CALL(cudaMalloc((void **)&d_order, numProducts * sizeof(unsigned int)));
+        if ((unsigned long long)numRows * numCols <= (unsigned long long)UINT_MAX + 1)
+            numElements = sortSparseMatrixProducts<unsigned int>
+                (&d_start, &d_row, &d_index, d_order, d_offset, left, right, 
+                 numRows, numLeftNZElts, numProducts, numCols, mgr);
+        else
+            numElements = sortSparseMatrixProducts<unsigned long long>
+                (&d_start, &d_row, &d_index, d_order, d_offset, left, right,
+                 numRows, numLeftNZElts, numProducts, numCols, mgr);
+    }
+
+    CUDPPResult result = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+    if (numElements > 0)
+    {
+        unsigned int *d_rowEnd;
+        T *d_values;
+        CUDA_SAFE_CALL(cudaMalloc((void **)&d_rowEnd, numRows * sizeof(unsigned int)));
+        CUDA_SAFE_CALL(cudaMalloc((void **)&d_values, numElements * sizeof(T)));
+
+        grid.x = min((unsigned int)((numElements + SPMV_CTA_SIZE - 1) / SPMV_CTA_SIZE), 65535u);
+        sparseMatrixProductRowEnds<<<grid, threads>>>
+            (d_rowEnd, d_row, (unsigned)numElements, (unsigned)numRows);
+
+        // Numeric phase
+        multiplySparseMatrixValues<T>(d_values, d_start, d_order, d_offset, left, right,
+                                      numLeftNZElts, numElements);
+
+        unsigned int *rowStart = new unsigned int[numRows + 1];
+        unsigned int *index = new unsigned int[numElements];
+        T *values = new T[numElements];
+        rowStart[0] = 0;
+        CUDA_SAFE_CALL(cudaMemcpy(rowStart + 1, d_rowEnd, numRows * sizeof(unsigned int),
+                                  cudaMemcpyDeviceToHost));
+        CUDA_SAFE_CALL(cudaMemcpy(index, d_index, numElements * sizeof(unsigned int),
+                                  cudaMemcpyDeviceToHost));
+        CUDA_SAFE_CALL(cudaMemcpy(values, d_values, numElements * sizeof(T),
+                                  cudaMemcpyDeviceToHost));
+
+        *product = new CUDPPSparseMatrixVectorMultiplyPlan(mgr, config, numElements, values,
+                                                           rowStart, index, numRows);
+        (*product)->m_d_productOffset = d_offset;
+        (*product)->m_d_productOrder = d_order;
+        (*product)->m_d_productStart = d_start;
+        (*product)->m_productLeftNZElts = A->m_numNonZeroElements;
+        (*product)->m_productRightNZElts = B->m_numNonZeroElements;
+        d_offset = d_order = d_start = 0;
+        result = CUDPP_SUCCESS;
+
+        delete [] values;
+        delete [] index;
+        delete [] rowStart;
+        cudaFree(d_values);
+        cudaFree(d_rowEnd);
+    }
+
+    cudaFree(d_index);
+    cudaFree(d_row);
+    cudaFree(d_start);
+    cudaFree(d_order);
+    cudaFree(d_offset);
+    freeSparseMatrixOperand(&right);
+    freeSparseMatrixOperand(&left);
+
+    CUDA_CHECK_ERROR("sparseMatrixMultiply");
+
+    return result;
+}
+
+/** @brief Recompute the values of a sparse matrix product for new operand values.
+  *
+  * Repeats only the numeric phase of sparseMatrixMultiply(), with the 
+  * product order and nonzero starts kept in \a product.  The result is
+  * written directly into a CSR product that is not reordered and has no
+  * transpose; otherwise it is stored with updateSparseMatrixValues().
+  *
+  * @param[in,out] product The sparse matrix product C
+  * @param[in,out] A The first operand, with the sparsity pattern C was computed from
+  * @param[in] B The second operand, with the sparsity pattern C was computed from
+  */
+template <class T>
+void recomputeSparseMatrixProduct(CUDPPSparseMatrixVectorMultiplyPlan *product,
+                                  CUDPPSparseMatrixVectorMultiplyPlan *A,
+                                  CUDPPSparseMatrixVectorMultiplyPlan *B)
+{
+    bool transposeA = (product->m_config.options & CUDPP_OPTION_SPMV_TRANSPOSE_A) != 0;
+    if (transposeA && !A->m_transpose)
+        buildSparseMatrixTranspose<T>(A);
+    const CUDPPSparseMatrixVectorMultiplyPlan *L = transposeA ? A->m_transpose : A;
+
+    SparseMatrixOperand left, right;
+    getSparseMatrixOperand<T>(&left, L);
+    getSparseMatrixOperand<T>(&right, B);
+
+    size_t numElements = product->m_numNonZeroElements;
+    bool isInPlace = !product->m_position && !product->m_transpose;
+    T *d_values = (T*)product->m_d_A;
+    if (!isInPlace)
+        CUDA_SAFE_CALL(cudaMalloc((void **)&d_values, numElements * sizeof(T)));
+
+    multiplySparseMatrixValues<T>(d_values, product->m_d_productStart, 
+                                  product->m_d_productOrder, product->m_d_productOffset,
+                                  left, right, L->m_numNonZeroElements, numElements);
+
+    if (!isInPlace)
+    {
+        T *values = new T[numElements];
+        CUDA_SAFE_CALL(cudaMemcpy(values, d_values, numElements * sizeof(T),
+                                  cudaMemcpyDeviceToHost));
+        updateSparseMatrixValues<T>(product, values);
+        delete [] values;
+        cudaFree(d_values);
+    }
+
+    freeSparseMatrixOperand(&right);
+    freeSparseMatrixOperand(&left);
+}
+
+/** @brief Call uploadSparseMatrixValues() with the plan's datatype.
+  *
+  * @param[in,out] plan The sparse matrix plan
+  * @param[in] A The nonzeros of A in CSR order
+  */
+void uploadSparseMatrixData(CUDPPSparseMatrixVectorMultiplyPlan *plan,
+                            const void                          *A)
+{
+    switch(plan->m_config.datatype)
+    {
+    case CUDPP_INT:
+        uploadSparseMatrixValues<int>(plan, (const int *)A);
+        break;
+    case CUDPP_UINT:
+        uploadSparseMatrixValues<unsigned int>(plan, (const unsigned int *)A);
+        break;
+    case CUDPP_FLOAT:
+        uploadSparseMatrixValues<float>(plan, (const float *)A);
+        break;
+    case CUDPP_DOUBLE:
+        uploadSparseMatrixValues<double>(plan, (const double *)A);
+        break;
+    default:
+        break;
+    }
 }
 
 #ifdef __cplusplus
-extern "C" 
+extern "C"
 {
 #endif
 
 // file scope
-/** @brief Allocate intermediate product, flags and rowFindx (index of the last
-  *        element of each row) array .
-  *  
-  * @param[in] plan Pointer to CUDPPSparseMatrixVectorMultiplyPlan class containing sparse 
-  *             matrix-vector multiply options, number of non-zero elements and number 
+/** @brief Convert the matrix to its storage format and copy it to the GPU.
+  *
+  * The format is chosen by chooseSparseMatrixFormat().  CSR keeps the input
+  * layout and allocates the merge-path carry arrays.  ELLPACK and
+  * SELL-C-sigma sort the rows (SELL only), compute the slice offsets and
+  * place each nonzero in its slice.  BSR computes the blocks of each block
+  * row.  The conversion runs on the host once, when the matrix is created.
+  * A matrix created with CUDPP_OPTION_HOST stays in CSR in host memory.
+  *
+  * @param[in] plan Pointer to CUDPPSparseMatrixVectorMultiplyPlan class containing sparse
+  *             matrix-vector multiply options, number of non-zero elements and number
   *             of rows which is used to compute storage requirements
   * @param[in]  A The matrix A
-  * @param[in]  rowindx The indices of elements in A which are the first element of their row
   * @param[in]  indx The column number for each element in A
   */
 void allocSparseMatrixVectorMultiplyStorage(CUDPPSparseMatrixVectorMultiplyPlan *plan,
                                             const void         *A,
-                                            const unsigned int *rowindx, 
                                             const unsigned int *indx)
 {
-    
-    switch(plan->m_config.datatype)
+    size_t numRows = plan->m_numRows;
+    size_t numNZElts = plan->m_numNonZeroElements;
+    const unsigned int *rowEnd = plan->m_rowFinalIndex;
+
+    plan->m_numCols = 0;
+    for (size_t k = 0; k < numNZElts; ++k)
+        plan->m_numCols = std::max(plan->m_numCols, (size_t)indx[k] + 1);
+
+    // The host multiply reads the row ends from m_rowFinalIndex
+    if (plan->m_config.options & CUDPP_OPTION_HOST)
     {
-    case CUDPP_INT:
-        CUDA_SAFE_CALL(cudaMalloc(&(plan->m_d_prod),  
-                                  plan->m_numNonZeroElements * sizeof(int)));
-        CUDA_SAFE_CALL(cudaMalloc(&(plan->m_d_A),  
-                                  plan->m_numNonZeroElements * sizeof(int)));
-        CUDA_SAFE_CALL(cudaMemcpy(plan->m_d_A, (int *)A, 
-                                  plan->m_numNonZeroElements * sizeof(int),
-                                  cudaMemcpyHostToDevice) );
-        break;
-    case CUDPP_UINT:
-        CUDA_SAFE_CALL(cudaMalloc(&(plan->m_d_prod),  
-                                  plan->m_numNonZeroElements * sizeof(unsigned int)));
-        CUDA_SAFE_CALL(cudaMalloc(&(plan->m_d_A),  
-                                  plan->m_numNonZeroElements * sizeof(unsigned int)));
-        CUDA_SAFE_CALL(cudaMemcpy(plan->m_d_A, (unsigned int *)A, 
-                                  plan->m_numNonZeroElements * sizeof(unsigned int),
-                                  cudaMemcpyHostToDevice) );
+        plan->m_format = CUDPP_OPTION_SPMV_CSR;
+        plan->m_numStoredElements = numNZElts;
+        plan->m_numIndices = numNZElts;
+        plan->m_d_index = new unsigned int[numNZElts];
+        memcpy(plan->m_d_index, indx, numNZElts * sizeof(unsigned int));
+        uploadSparseMatrixData(plan, A);
+        return;
+    }
+
+    // Lay out the reordered matrix; m_position is composed with the
+    // reordering below so that it still refers to the caller's CSR order
+    unsigned int *reorderedRowEnd = 0;
+    unsigned int *reorderedIndx = 0;
+    unsigned int *reorderedPosition = 0;
+    if ((plan->m_config.options & CUDPP_OPTION_SPMV_REORDER) && 
+        plan->m_numCols <= numRows)
+    {
+        plan->m_numCols = numRows;
+        plan->m_permutation = new unsigned int[numRows];
+        reverseCuthillMcKee(plan->m_permutation, rowEnd, indx, numRows);
+
+        reorderedRowEnd = new unsigned int[numRows];
+        reorderedIndx = new unsigned int[numNZElts];
+        reorderedPosition = new unsigned int[numNZElts];
+        permuteSparseMatrix(reorderedRowEnd, reorderedIndx, reorderedPosition,
+                            plan->m_permutation, rowEnd, indx, numRows);
+        rowEnd = reorderedRowEnd;
+        indx = reorderedIndx;
+
+        uploadSparseMatrixIndices(&plan->m_d_permutation, plan->m_permutation, numRows);
+    }
+
+    unsigned int *rowLength = new unsigned int[numRows];
+    for (size_t i = 0; i < numRows; ++i)
+        rowLength[i] = rowEnd[i] - ((i > 0) ? rowEnd[i-1] : 0);
+
+    plan->m_format = chooseSparseMatrixFormat(&plan->m_blockSize, plan, rowEnd, 
+                                              rowLength, indx);
+    if (plan->m_format != CUDPP_OPTION_SPMV_BSR)
+        plan->m_blockSize = 0;
+
+    // The column (block column for BSR) of each stored element; the index
+    // in the stored elements of each nonzero is kept in the plan
+    unsigned int *storedIndex = 0;
+
+    switch (plan->m_format)
+    {
+    case CUDPP_OPTION_SPMV_ELL:
+    case CUDPP_OPTION_SPMV_SELL:
+        {
+            bool isSliced = (plan->m_format == CUDPP_OPTION_SPMV_SELL);
+            plan->m_sliceHeight = isSliced ? SPMV_SELL_SLICE_HEIGHT : numRows;
+            plan->m_numSlices = (numRows + plan->m_sliceHeight - 1) / plan->m_sliceHeight;
+
+            unsigned int *rowPermutation = new unsigned int[numRows];
+            unsigned int *sliceStart = new unsigned int[plan->m_numSlices];
+            sortRowsByLength(rowPermutation, rowLength, numRows,
+                             isSliced ? SPMV_SELL_SORT_WINDOW : 1);
+            plan->m_numStoredElements = slicedEllLayout(sliceStart, rowPermutation, rowLength,
+                                                        numRows, plan->m_sliceHeight);
+            plan->m_numIndices = plan->m_numStoredElements;
+
+            plan->m_position = new unsigned int[numNZElts];
+            storedIndex = new unsigned int[plan->m_numIndices];
+            memset(storedIndex, 0, plan->m_numIndices * sizeof(unsigned int));
+
+            unsigned int *sortedLength = new unsigned int[numRows];
+            for (size_t i = 0; i < numRows; ++i)
+            {
+                size_t slice = i / plan->m_sliceHeight;
+                size_t row = rowPermutation[i];
+                size_t k = (row > 0) ? rowEnd[row-1] : 0;
+                size_t p = sliceStart[slice] + (i - slice * plan->m_sliceHeight);
+
+                sortedLength[i] = rowLength[row];
+                for (; k < rowEnd[row]; ++k, p += plan->m_sliceHeight)
+                {
+                    plan->m_position[k] = (unsigned int)p;
+                    storedIndex[p] = indx[k];
+                }
+            }
+
+            uploadSparseMatrixIndices(&plan->m_d_sliceStart, sliceStart, plan->m_numSlices);
+            uploadSparseMatrixIndices(&plan->m_d_rowLength, sortedLength, numRows);
+            if (isSliced)
+                uploadSparseMatrixIndices(&plan->m_d_rowPermutation, rowPermutation, numRows);
+
+            delete [] sortedLength;
+            delete [] sliceStart;
+            delete [] rowPermutation;
+        }
         break;
-    case CUDPP_FLOAT:
-        CUDA_SAFE_CALL(cudaMalloc(&(plan->m_d_prod),  
-                                  plan->m_numNonZeroElements * sizeof(float)));
-        CUDA_SAFE_CALL(cudaMalloc(&(plan->m_d_A),  
-                                  plan->m_numNonZeroElements * sizeof(float)));
-        CUDA_SAFE_CALL(cudaMemcpy(plan->m_d_A, (float *)A, 
-                                  plan->m_numNonZeroElements * sizeof(float),
-                                  cudaMemcpyHostToDevice) );
+    case CUDPP_OPTION_SPMV_BSR:
+        {
+            size_t b = plan->m_blockSize;
+            size_t numBlockRows = (numRows + b - 1) / b;
+            size_t numBlocks = blockRowLayout(0, 0, 0, rowEnd, indx,
+                                              numRows, plan->m_numCols, b);
+            plan->m_numStoredElements = numBlocks * b * b;
+            plan->m_numIndices = numBlocks;
+
+            unsigned int *blockRowEnd = new unsigned int[numBlockRows];
+            plan->m_position = new unsigned int[numNZElts];
+            storedIndex = new unsigned int[numBlocks];
+            blockRowLayout(blockRowEnd, storedIndex, plan->m_position, rowEnd, indx,
+                           numRows, plan->m_numCols, b);
+
+            uploadSparseMatrixIndices(&plan->m_d_rowFinalIndex, blockRowEnd, numBlockRows);
+            delete [] blockRowEnd;
+        }
         break;
     default:
+        {
+            // One carry-out per tile of the merge-path kernel, which covers
+            // SPMV_CTA_SIZE * SPMV_ITEMS_PER_THREAD rows plus nonzeros
+            size_t itemsPerCTA = SPMV_CTA_SIZE * SPMV_ITEMS_PER_THREAD;
+            plan->m_numCarries = (numRows + numNZElts + itemsPerCTA - 1) / itemsPerCTA;
+            if (plan->m_numCarries == 0)
+                plan->m_numCarries = 1;
+            plan->m_numStoredElements = numNZElts;
+            plan->m_numIndices = numNZElts;
+
+            CUDA_SAFE_CALL(cudaMalloc((void **)&(plan->m_d_carryRow),
+                                      plan->m_numCarries * sizeof(unsigned int)));
+            uploadSparseMatrixIndices(&plan->m_d_rowFinalIndex, rowEnd, numRows);
+        }
         break;
     }
 
-    CUDA_SAFE_CALL(cudaMalloc((void **)&(plan->m_d_flags),  
-                              plan->m_numNonZeroElements * sizeof(unsigned int)));
-    CUDA_SAFE_CALL(cudaMalloc((void **)&(plan->m_d_index),  
-                              plan->m_numNonZeroElements * sizeof(unsigned int)));
-    CUDA_SAFE_CALL(cudaMalloc((void **)&(plan->m_d_rowFinalIndex),  
-                              plan->m_numRows * sizeof(unsigned int)));
-    CUDA_SAFE_CALL(cudaMalloc((void **)&(plan->m_d_rowIndex),  
-                              plan->m_numRows * sizeof(unsigned int)));
+    uploadSparseMatrixIndices(&plan->m_d_index, storedIndex ? storedIndex : indx,
+                              plan->m_numIndices);
 
-    CUDA_SAFE_CALL(cudaMemcpy(plan->m_d_rowFinalIndex, plan->m_rowFinalIndex, 
-                              plan->m_numRows * sizeof(unsigned int),
-                              cudaMemcpyHostToDevice) );
-    CUDA_SAFE_CALL( cudaMemcpy(plan->m_d_rowIndex, rowindx, 
-                               plan->m_numRows * sizeof(unsigned int),
-                               cudaMemcpyHostToDevice) );
-    CUDA_SAFE_CALL( cudaMemcpy(plan->m_d_index, indx, 
-                               plan->m_numNonZeroElements * sizeof(unsigned int),
-                               cudaMemcpyHostToDevice) );
+    if (reorderedPosition)
+    {
+        if (plan->m_position)
+        {
+            for (size_t k = 0; k < numNZElts; ++k)
+                reorderedPosition[k] = plan->m_position[reorderedPosition[k]];
+            delete [] plan->m_position;
+        }
+        plan->m_position = reorderedPosition;
+    }
 
+    // Value updates scatter on the GPU unless nonzeros share a stored element
+    if (plan->m_position)
+    {
+        bool *isUsed = new bool[plan->m_numStoredElements];
+        memset(isUsed, 0, plan->m_numStoredElements * sizeof(bool));
+        for (size_t k = 0; k < numNZElts && !plan->m_hasSharedElements; ++k)
+        {
+            plan->m_hasSharedElements = isUsed[plan->m_position[k]];
+            isUsed[plan->m_position[k]] = true;
+        }
+        delete [] isUsed;
+    }
+
+    uploadSparseMatrixData(plan, A);
+
+    delete [] storedIndex;
+    delete [] rowLength;
+    delete [] reorderedIndx;
+    delete [] reorderedRowEnd;
 
     CUDA_CHECK_ERROR("allocSparseMatrixVectorMultiplyStorage");
 }
 
-/** @brief Deallocate intermediate product, flags and rowFindx (index of the last
-  *        element of each row) array .
+/** @brief Deallocate the GPU copy of the matrix and the merge-path carry arrays.
+  *
+  * For a matrix created with CUDPP_OPTION_HOST, its host copy.
   *
   * These arrays must have been allocated by allocSparseMatrixVectorMultiplyStorage(), which is called
-  * by the constructor of CUDPPSparseMatrixVectorMultiplyPlan.  
+  * by the constructor of CUDPPSparseMatrixVectorMultiplyPlan.
   *
   * @param[in] plan Pointer to CUDPPSparseMatrixVectorMultiplyPlan plan initialized by its constructor.
   */
 void freeSparseMatrixVectorMultiplyStorage(CUDPPSparseMatrixVectorMultiplyPlan *plan)
 {
+    if (plan->m_config.options & CUDPP_OPTION_HOST)
+    {
+        free(plan->m_d_A);
+        delete [] plan->m_d_index;
+        plan->m_d_A = 0;
+        plan->m_d_index = 0;
+        plan->m_numStoredElements = 0;
+        plan->m_numIndices = 0;
+        plan->m_numNonZeroElements = 0;
+        plan->m_numRows = 0;
+        return;
+    }
+
     CUDA_CHECK_ERROR("freeSparseMatrixVectorMultiply");
 
-    cudaFree(plan->m_d_prod);
+    cudaFree(plan->m_d_carryValue);
     cudaFree(plan->m_d_A);
-    cudaFree((void*)plan->m_d_flags);
+    cudaFree((void*)plan->m_d_carryRow);
+    cudaFree((void*)plan->m_d_sliceStart);
+    cudaFree((void*)plan->m_d_rowLength);
+    cudaFree((void*)plan->m_d_rowPermutation);
     cudaFree((void*)plan->m_d_index);
     cudaFree((void*)plan->m_d_rowFinalIndex);
-    cudaFree((void*)plan->m_d_rowIndex);
+    cudaFree((void*)plan->m_d_position);
+    cudaFree(plan->m_d_values);
+    delete [] plan->m_position;
+    cudaFree((void*)plan->m_d_permutation);
+    cudaFree(plan->m_d_permutedX);
+    cudaFree(plan->m_d_permutedY);
+    delete [] plan->m_permutation;
+    delete [] plan->m_transposePosition;
+    delete plan->m_transpose;
+    cudaFree((void*)plan->m_d_productOffset);
+    cudaFree((void*)plan->m_d_productOrder);
+    cudaFree((void*)plan->m_d_productStart);
 
-    plan->m_d_prod = 0;
+    plan->m_d_carryValue = 0;
     plan->m_d_A = 0;
-    plan->m_d_flags = 0;
+    plan->m_d_carryRow = 0;
+    plan->m_d_sliceStart = 0;
+    plan->m_d_rowLength = 0;
+    plan->m_d_rowPermutation = 0;
     plan->m_d_index = 0;
     plan->m_d_rowFinalIndex = 0;
-    plan->m_d_rowIndex = 0;
+    plan->m_d_position = 0;
+    plan->m_d_values = 0;
+    plan->m_position = 0;
+    plan->m_d_permutation = 0;
+    plan->m_d_permutedX = 0;
+    plan->m_d_permutedY = 0;
+    plan->m_permutation = 0;
+    plan->m_transposePosition = 0;
+    plan->m_transpose = 0;
+    plan->m_d_productOffset = 0;
+    plan->m_d_productOrder = 0;
+    plan->m_d_productStart = 0;
+    plan->m_numCarries = 0;
+    plan->m_numStoredElements = 0;
+    plan->m_numIndices = 0;
     plan->m_numNonZeroElements = 0;
     plan->m_numRows = 0;
 }
@@ -222,31 +1826,197 @@ void freeSparseMatrixVectorMultiplyStorage(CUDPPSparseMatrixVectorMultiplyPlan *
 /** @brief Dispatch function to perform a sparse matrix-vector multiply
   * with the specified configuration.
   *
-  * This is the dispatch routine which calls sparseMatrixVectorMultiply() with 
-  * appropriate template parameters and arguments
+  * This is the dispatch routine which calls sparseMatrixDenseMultiply() with 
+  * appropriate template parameters and arguments.  NULL \a alpha or \a beta
+  * stand for 1, so the defaults compute Y += A * X.
   * 
-  * @param[out] d_y The output vector for y = A*x
-  * @param[in]  d_x The x vector for y = A*x
+  * @param[in,out] d_y The output vectors Y = alpha * A * X + beta * Y
+  * @param[in]  d_x The input vectors X
+  * @param[in]  numVectors The number of vectors of X and Y
+  * @param[in]  yPitch The distance in elements between vectors of Y
+  * @param[in]  xPitch The distance in elements between vectors of X
+  * @param[in]  alpha Host pointer to the scale of A * X, of the plan's datatype, or NULL
+  * @param[in]  beta Host pointer to the scale of Y, of the plan's datatype, or NULL
   * @param[in]  plan The sparse matrix plan and data
   */
 void cudppSparseMatrixVectorMultiplyDispatch (
                                               void                                      *d_y,
                                               const void                                *d_x,
+                                              size_t                                    numVectors,
+                                              size_t                                    yPitch,
+                                              size_t                                    xPitch,
+                                              const void                                *alpha,
+                                              const void                                *beta,
                                               const CUDPPSparseMatrixVectorMultiplyPlan *plan
                                              )                            
 {    
     switch(plan->m_config.datatype)
     {
         case CUDPP_INT:
-            sparseMatrixVectorMultiply<int>((int *)d_y, (int *)d_x, plan);
+            sparseMatrixDenseMultiply<int>((int *)d_y, (const int *)d_x, 
+                                           numVectors, yPitch, xPitch,
+                                           alpha ? *(const int *)alpha : 1,
+                                           beta ? *(const int *)beta : 1, plan);
             break;
         case CUDPP_UINT:
-            sparseMatrixVectorMultiply<unsigned int>((unsigned int *)d_y, (unsigned int *)d_x, 
-                                                      plan);
-                break;
+            sparseMatrixDenseMultiply<unsigned int>((unsigned int *)d_y, (const unsigned int *)d_x, 
+                                                    numVectors, yPitch, xPitch,
+                                                    alpha ? *(const unsigned int *)alpha : 1,
+                                                    beta ? *(const unsigned int *)beta : 1, plan);
+            break;
         case CUDPP_FLOAT:
-            sparseMatrixVectorMultiply<float>((float *)d_y, (float *)d_x, plan);
+            sparseMatrixDenseMultiply<float>((float *)d_y, (const float *)d_x, 
+                                             numVectors, yPitch, xPitch,
+                                             alpha ? *(const float *)alpha : 1.0f,
+                                             beta ? *(const float *)beta : 1.0f, plan);
+            break;
+        case CUDPP_DOUBLE:
+            sparseMatrixDenseMultiply<double>((double *)d_y, (const double *)d_x, 
+                                              numVectors, yPitch, xPitch,
+                                              alpha ? *(const double *)alpha : 1.0,
+                                              beta ? *(const double *)beta : 1.0, plan);
+            break;
+        default:
+            break;
+    }
+}
+
+/** @brief Dispatch function to perform a transposed sparse matrix-vector multiply
+  *
+  * Computes Y = alpha * A^T * X + beta * Y.  On the first call the transpose
+  * of A is built with buildSparseMatrixTranspose() and cached in the plan;
+  * every call then multiplies by it with cudppSparseMatrixVectorMultiplyDispatch().
+  *
+  * @param[in,out] d_y The output vectors, one element per column of A
+  * @param[in]  d_x The input vectors, one element per row of A
+  * @param[in]  numVectors The number of vectors of X and Y
+  * @param[in]  yPitch The distance in elements between vectors of Y
+  * @param[in]  xPitch The distance in elements between vectors of X
+  * @param[in]  alpha Host pointer to the scale of A^T * X, of the plan's datatype, or NULL
+  * @param[in]  beta Host pointer to the scale of Y, of the plan's datatype, or NULL
+  * @param[in,out] plan The sparse matrix plan and data
+  */
+void cudppSparseMatrixTransposeMultiplyDispatch(void                                *d_y,
+                                                const void                          *d_x,
+                                                size_t                              numVectors,
+                                                size_t                              yPitch,
+                                                size_t                              xPitch,
+                                                const void                          *alpha,
+                                                const void                          *beta,
+                                                CUDPPSparseMatrixVectorMultiplyPlan *plan)
+{
+    if (!plan->m_transpose)
+    {
+        switch(plan->m_config.datatype)
+        {
+            case CUDPP_INT:
+                buildSparseMatrixTranspose<int>(plan);
+                break;
+            case CUDPP_UINT:
+                buildSparseMatrixTranspose<unsigned int>(plan);
+                break;
+            case CUDPP_FLOAT:
+                buildSparseMatrixTranspose<float>(plan);
                 break;
+            case CUDPP_DOUBLE:
+                buildSparseMatrixTranspose<double>(plan);
+                break;
+            default:
+                return;
+        }
+    }
+
+    cudppSparseMatrixVectorMultiplyDispatch(d_y, d_x, numVectors, yPitch, xPitch,
+                                            alpha, beta, plan->m_transpose);
+}
+
+/** @brief Dispatch function to overwrite the values of a sparse matrix
+  *
+  * Calls updateSparseMatrixValues() with the plan's datatype.
+  *
+  * @param[in,out] plan The sparse matrix plan and data
+  * @param[in] A The new nonzeros of A, in the CSR order the matrix was created with
+  */
+void cudppSparseMatrixUpdateValuesDispatch(CUDPPSparseMatrixVectorMultiplyPlan *plan,
+                                           const void                          *A)
+{
+    switch(plan->m_config.datatype)
+    {
+        case CUDPP_INT:
+            updateSparseMatrixValues<int>(plan, (const int *)A);
+            break;
+        case CUDPP_UINT:
+            updateSparseMatrixValues<unsigned int>(plan, (const unsigned int *)A);
+            break;
+        case CUDPP_FLOAT:
+            updateSparseMatrixValues<float>(plan, (const float *)A);
+            break;
+        case CUDPP_DOUBLE:
+            updateSparseMatrixValues<double>(plan, (const double *)A);
+            break;
+        default:
+            break;
+    }
+}
+
+/** @brief Dispatch function to compute a sparse matrix product
+  *
+  * Calls sparseMatrixMultiply() with the datatype of \a config.
+  *
+  * @param[out] product The new sparse matrix C = A * B, or A^T * B
+  * @param[in] mgr The CUDPP manager of C
+  * @param[in] config The configuration of C
+  * @param[in,out] A The first operand
+  * @param[in] B The second operand
+  * @returns CUDPPResult indicating success or error condition
+  */
+CUDPPResult cudppSparseMatrixMultiplyDispatch(CUDPPSparseMatrixVectorMultiplyPlan **product,
+                                              CUDPPManager                        *mgr,
+                                              CUDPPConfiguration                  config,
+                                              CUDPPSparseMatrixVectorMultiplyPlan *A,
+                                              CUDPPSparseMatrixVectorMultiplyPlan *B)
+{
+    switch(config.datatype)
+    {
+        case CUDPP_INT:
+            return sparseMatrixMultiply<int>(product, mgr, config, A, B);
+        case CUDPP_UINT:
+            return sparseMatrixMultiply<unsigned int>(product, mgr, config, A, B);
+        case CUDPP_FLOAT:
+            return sparseMatrixMultiply<float>(product, mgr, config, A, B);
+        case CUDPP_DOUBLE:
+            return sparseMatrixMultiply<double>(product, mgr, config, A, B);
+        default:
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+    }
+}
+
+/** @brief Dispatch function to recompute the values of a sparse matrix product
+  *
+  * Calls recomputeSparseMatrixProduct() with the plan's datatype.
+  *
+  * @param[in,out] product The sparse matrix product C
+  * @param[in,out] A The first operand
+  * @param[in] B The second operand
+  */
+void cudppSparseMatrixMultiplyNumericDispatch(CUDPPSparseMatrixVectorMultiplyPlan *product,
+                                              CUDPPSparseMatrixVectorMultiplyPlan *A,
+                                              CUDPPSparseMatrixVectorMultiplyPlan *B)
+{
+    switch(product->m_config.datatype)
+    {
+        case CUDPP_INT:
+            recomputeSparseMatrixProduct<int>(product, A, B);
+            break;
+        case CUDPP_UINT:
+            recomputeSparseMatrixProduct<unsigned int>(product, A, B);
+            break;
+        case CUDPP_FLOAT:
+            recomputeSparseMatrixProduct<float>(product, A, B);
+            break;
+        case CUDPP_DOUBLE:
+            recomputeSparseMatrixProduct<double>(product, A, B);
+            break;
         default:
             break;
     }
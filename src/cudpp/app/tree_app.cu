@@ -0,0 +1,635 @@
+// -------------------------------------------------------------
+// CUDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cuda_util.h"
+#include "cudpp_globals.h"
+#include "cudpp.h"
+#include "cudpp_util.h"
+#include "cudpp_plan.h"
+#include "cudpp_radixsort.h"
+#include "cudpp_listrank.h"
+
+#include "kernel/tree_kernel.cuh"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * @file
+ * tree_app.cu
+ *
+ * @brief CUDPP application-level Euler tour tree routines
+ */
+
+/** \addtogroup cudpp_app
+ * @{
+ */
+
+/** @name Tree Functions
+ * @{
+ */
+
+/** @brief Grid of TREE_CTA_SIZE threads per block for \a numItems items
+ *
+ * The kernels loop over their items, so the grid is capped at 65535 blocks.
+ */
+dim3 treeGrid(size_t numItems)
+{
+    size_t numBlocks = (numItems + TREE_CTA_SIZE - 1) / TREE_CTA_SIZE;
+    if (numBlocks > 65535)
+        numBlocks = 65535;
+    if (numBlocks < 1)
+        numBlocks = 1;
+    return dim3((unsigned int)numBlocks, 1, 1);
+}
+
+/** @brief Allocate \a n elements in host memory or device memory */
+template <typename T>
+void treeMalloc(T **p, size_t n, bool host)
+{
+    if (host)
+        *p = (T*) malloc(n * sizeof(T));
+    else
+        CUDA_SAFE_CALL(cudaMalloc((void**)p, n * sizeof(T)));
+}
+
+/** @brief Free an array allocated by treeMalloc() */
+template <typename T>
+void treeFree(T *p, bool host)
+{
+    if (host)
+        free(p);
+    else if (p != NULL)
+        CUDA_SAFE_CALL(cudaFree(p));
+}
+
+/** @brief Copy \a n ints between two arrays in the same memory space */
+void treeCopy(int *dst, const int *src, size_t n, bool host)
+{
+    if (host)
+        memcpy(dst, src, n * sizeof(int));
+    else
+        CUDA_SAFE_CALL(cudaMemcpy(dst, src, n * sizeof(int), cudaMemcpyDeviceToDevice));
+}
+
+/** @brief Key of a node when grouping nodes by parent on the host */
+struct TreeParentKey
+{
+    const int *parent;   //!< Parent of each node
+    size_t    numNodes;  //!< Number of nodes
+
+    unsigned int operator()(size_t i) const { return treeParentKey(parent, i, numNodes); }
+};
+
+/** @brief Key of an arc when grouping arcs by source node on the host */
+struct TreeArcKey
+{
+    const int *edgeU;    //!< First node of each edge
+    const int *edgeV;    //!< Second node of each edge
+
+    unsigned int operator()(size_t i) const
+    {
+        return (unsigned int)((i & 1) ? edgeV[i >> 1] : edgeU[i >> 1]);
+    }
+};
+
+/** @brief Group items by key on the host
+ *
+ * A stable counting sort: the items are split into one contiguous range
+ * per OpenMP thread, and each thread counts the items of each key in its
+ * range in its own histogram.  The histograms are scanned over the
+ * threads for each key and the key totals over the keys, and each thread
+ * then scatters its range in index order, so the items of each key stay
+ * in index order, as in the stable radix sort of the GPU path.  Each
+ * histogram has \a numKeys counts, so the number of threads is limited
+ * to keep them at most TREE_HOST_HISTOGRAM_RATIO times \a numItems.
+ *
+ * @param[out] keys Key at each sorted position
+ * @param[out] order Item at each sorted position
+ * @param[out] counts Scratch array of \a numKeys elements
+ * @param[in]  numItems Number of items
+ * @param[in]  numKeys Number of keys
+ * @param[in]  key Key of each item
+ */
+template <class Key>
+void treeGroupHost(unsigned int *keys,
+                   unsigned int *order,
+                   unsigned int *counts,
+                   size_t       numItems,
+                   size_t       numKeys,
+                   Key          key)
+{
+    int numK = (int)numKeys;
+    int numI = (int)numItems;
+
+    int numChunks = 1;
+#ifdef _OPENMP
+    numChunks = omp_get_max_threads();
+#endif
+    if ((size_t)numChunks > numItems / TREE_HOST_MIN_CHUNK + 1)
+        numChunks = (int)(numItems / TREE_HOST_MIN_CHUNK + 1);
+    if ((size_t)numChunks > TREE_HOST_HISTOGRAM_RATIO * numItems / numKeys + 1)
+        numChunks = (int)(TREE_HOST_HISTOGRAM_RATIO * numItems / numKeys + 1);
+    size_t chunkSize = (numItems + numChunks - 1) / numChunks;
+
+    // histogram[c * numKeys + k]: items of key k in chunk c
+    unsigned int *histogram =
+        (unsigned int*) malloc((size_t)numChunks * numKeys * sizeof(unsigned int));
+
+#pragma omp parallel for num_threads(numChunks)
+    for (int c = 0; c < numChunks; ++c)
+    {
+        unsigned int *chunkCounts = histogram + (size_t)c * numKeys;
+        size_t begin = c * chunkSize;
+        size_t end = (begin + chunkSize < numItems) ? begin + chunkSize : numItems;
+        memset(chunkCounts, 0, numKeys * sizeof(unsigned int));
+        for (size_t i = begin; i < end; ++i)
+            ++chunkCounts[key(i)];
+    }
+
+    // Offset of each chunk within the items of each key, and key totals
+#pragma omp parallel for num_threads(numChunks)
+    for (int k = 0; k < numK; ++k)
+    {
+        unsigned int sum = 0;
+        for (int c = 0; c < numChunks; ++c)
+        {
+            unsigned int n = histogram[(size_t)c * numKeys + k];
+            histogram[(size_t)c * numKeys + k] = sum;
+            sum += n;
+        }
+        counts[k] = sum;
+    }
+
+    unsigned int sum = 0;
+    for (int k = 0; k < numK; ++k)
+    {
+        unsigned int c = counts[k];
+        counts[k] = sum;
+        sum += c;
+    }
+
+#pragma omp parallel for num_threads(numChunks)
+    for (int c = 0; c < numChunks; ++c)
+    {
+        unsigned int *chunkOffsets = histogram + (size_t)c * numKeys;
+        size_t begin = c * chunkSize;
+        size_t end = (begin + chunkSize < numItems) ? begin + chunkSize : numItems;
+        for (size_t i = begin; i < end; ++i)
+        {
+            unsigned int k = key(i);
+            order[counts[k] + chunkOffsets[k]++] = (unsigned int)i;
+        }
+    }
+
+    free(histogram);
+
+#pragma omp parallel for
+    for (int i = 0; i < numI; ++i)
+        keys[i] = key(order[i]);
+}
+
+/** @brief Group nodes by parent, or the arcs of an edge list by source
+ *
+ * The keys and the order of the sorted items are written to the tour
+ * prefix array of the plan, which is free until the tour is scanned.
+ * The GPU path sorts with cudppRadixSortDispatch(), the host path with
+ * treeGroupHost().
+ *
+ * @param[in,out] plan Pointer to CUDPPTreePlan object
+ * @param[in] numItems Number of items
+ * @param[in] numKeys Number of keys
+ * @param[in] d_parent Parent of each node, when grouping nodes
+ * @param[in] d_edgeU First node of each edge, when grouping arcs (else NULL)
+ * @param[in] d_edgeV Second node of each edge, when grouping arcs
+ */
+void treeGroup(CUDPPTreePlan  *plan,
+               size_t         numItems,
+               size_t         numKeys,
+               const int      *d_parent,
+               const int      *d_edgeU,
+               const int      *d_edgeV)
+{
+    unsigned int *d_keys = (unsigned int*)plan->m_d_tourPrefix;
+    unsigned int *d_order = d_keys + 2 * plan->m_numElements;
+
+    if (plan->m_config.options & CUDPP_OPTION_HOST)
+    {
+        // the first child array is free until the groups are linked
+        unsigned int *counts = (unsigned int*)plan->m_d_firstChild;
+        if (d_edgeU == NULL)
+        {
+            TreeParentKey key = { d_parent, numKeys - 1 };
+            treeGroupHost(d_keys, d_order, counts, numItems, numKeys, key);
+        }
+        else
+        {
+            TreeArcKey key = { d_edgeU, d_edgeV };
+            treeGroupHost(d_keys, d_order, counts, numItems, numKeys, key);
+        }
+        return;
+    }
+
+    tree_group_keys<<< treeGrid(numItems), TREE_CTA_SIZE >>>
+        (d_keys, d_order, d_parent, d_edgeU, d_edgeV, numItems, numKeys - 1);
+    CUDA_CHECK_ERROR("tree_group_keys");
+
+    cudppRadixSortDispatch(d_keys, d_order, numItems, plan->m_sortPlan);
+}
+
+/** @brief Build the Euler tour of a forest and number its nodes
+ *
+ * The children of each node are grouped by treeGroup() and linked by
+ * treeLinkGroup(), the 2n arcs of the tour are linked by treeEulerNode(),
+ * and the tour is scanned by cudppListScanDispatch() from the down arc of
+ * the first root.  The scanned prefixes give the pre-order position of
+ * each node, from which the node at each position and the LCA sparse
+ * table are built.
+ *
+ * @param[in,out] plan Pointer to CUDPPTreePlan object
+ * @param[in] d_parent Parent of each node, negative for roots
+ * @param[in] numNodes Number of nodes
+ * @returns CUDPP_ERROR_ILLEGAL_CONFIGURATION if the forest has no root
+ */
+CUDPPResult treeFromParents(CUDPPTreePlan  *plan,
+                            const int      *d_parent,
+                            size_t         numNodes)
+{
+    bool host = (plan->m_config.options & CUDPP_OPTION_HOST) != 0;
+
+    plan->m_numNodes = 0;
+    plan->m_lcaBlocks = 0;
+    if (numNodes == 0)
+        return CUDPP_SUCCESS;
+
+    size_t numBlocks = (numNodes + TREE_LCA_BLOCK_SIZE - 1) / TREE_LCA_BLOCK_SIZE;
+    int numLevels = treeLog2(numBlocks) + 1;
+    unsigned int *d_keys = (unsigned int*)plan->m_d_tourPrefix;
+    unsigned int *d_order = d_keys + 2 * plan->m_numElements;
+    int head;
+
+    treeCopy(plan->m_d_parent, d_parent, numNodes, host);
+    treeGroup(plan, numNodes, numNodes + 1, plan->m_d_parent, NULL, NULL);
+
+    if (host)
+    {
+        int n = (int)numNodes;
+
+#pragma omp parallel for
+        for (int v = 0; v <= n; ++v)
+            plan->m_d_firstChild[v] = -1;
+#pragma omp parallel for
+        for (int i = 0; i < n; ++i)
+            treeLinkGroup(plan->m_d_firstChild, plan->m_d_nextSibling,
+                          d_keys, d_order, i, numNodes);
+#pragma omp parallel for
+        for (int v = 0; v < n; ++v)
+            treeEulerNode(plan->m_d_tourNext, plan->m_d_tourValue, plan->m_d_parent,
+                          plan->m_d_firstChild, plan->m_d_nextSibling, v, numNodes);
+
+        head = plan->m_d_firstChild[numNodes];
+    }
+    else
+    {
+        dim3 grid = treeGrid(numNodes);
+
+        CUDA_SAFE_CALL(cudaMemset(plan->m_d_firstChild, 0xff, (numNodes + 1) * sizeof(int)));
+        tree_link_groups<<< grid, TREE_CTA_SIZE >>>
+            (plan->m_d_firstChild, plan->m_d_nextSibling, (int*)NULL,
+             d_keys, d_order, numNodes);
+        CUDA_CHECK_ERROR("tree_link_groups");
+        tree_euler_nodes<<< grid, TREE_CTA_SIZE >>>
+            (plan->m_d_tourNext, plan->m_d_tourValue, plan->m_d_parent,
+             plan->m_d_firstChild, plan->m_d_nextSibling, numNodes);
+        CUDA_CHECK_ERROR("tree_euler_nodes");
+
+        CUDA_SAFE_CALL(cudaMemcpy(&head, plan->m_d_firstChild + numNodes, sizeof(int),
+                                  cudaMemcpyDeviceToHost));
+    }
+
+    if (head < 0)
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    // One scan of the tour gives every node's position, depth and size
+    cudppListScanDispatch(plan->m_d_tourPrefix, plan->m_d_tourValue, plan->m_d_tourNext,
+                          plan->m_d_firstChild + numNodes, 1, 2 * numNodes,
+                          plan->m_scanPlan);
+
+    if (host)
+    {
+        int n = (int)numNodes;
+        int b = (int)numBlocks;
+
+#pragma omp parallel for
+        for (int v = 0; v < n; ++v)
+            plan->m_d_nodeAtPre[treePreorder(plan->m_d_tourPrefix, v)] = v;
+        for (int level = 0; level < numLevels; ++level)
+        {
+#pragma omp parallel for
+            for (int j = 0; j < b; ++j)
+                treeLCATableEntry(plan->m_d_lcaTable, plan->m_d_nodeAtPre,
+                                  plan->m_d_tourPrefix, j, level, numNodes, numBlocks);
+        }
+    }
+    else
+    {
+        tree_number_nodes<<< treeGrid(numNodes), TREE_CTA_SIZE >>>
+            (plan->m_d_nodeAtPre, plan->m_d_tourPrefix, numNodes);
+        CUDA_CHECK_ERROR("tree_number_nodes");
+        for (int level = 0; level < numLevels; ++level)
+        {
+            tree_lca_table<<< treeGrid(numBlocks), TREE_CTA_SIZE >>>
+                (plan->m_d_lcaTable, plan->m_d_nodeAtPre, plan->m_d_tourPrefix,
+                 level, numNodes, numBlocks);
+            CUDA_CHECK_ERROR("tree_lca_table");
+        }
+    }
+
+    plan->m_numNodes = numNodes;
+    plan->m_lcaBlocks = numBlocks;
+    return CUDPP_SUCCESS;
+}
+
+/** @brief Root a spanning tree given as an edge list and build it
+ *
+ * The two arcs of each edge are grouped by source node with treeGroup(),
+ * each arc u->v is linked to the arc after v->u around v, and the
+ * resulting Euler tour, cut before the first arc leaving \a root, is
+ * ranked with cudppListScanDispatch().  The arc of each edge that comes
+ * first runs from parent to child.  The parents are then built into a
+ * tree with treeFromParents().
+ *
+ * @param[in,out] plan Pointer to CUDPPTreePlan object
+ * @param[out] d_parent Parent of each node, -1 for \a root
+ * @param[in] d_edgeU First node of each edge
+ * @param[in] d_edgeV Second node of each edge
+ * @param[in] numNodes Number of nodes; there are \a numNodes - 1 edges
+ * @param[in] root The root
+ * @returns CUDPPResult indicating success or error condition
+ */
+CUDPPResult treeFromEdges(CUDPPTreePlan  *plan,
+                          int            *d_parent,
+                          const int      *d_edgeU,
+                          const int      *d_edgeV,
+                          size_t         numNodes,
+                          int            root)
+{
+    bool host = (plan->m_config.options & CUDPP_OPTION_HOST) != 0;
+    size_t numEdges = numNodes - 1;
+    size_t numArcs = 2 * numEdges;
+
+    unsigned int *d_keys = (unsigned int*)plan->m_d_tourPrefix;
+    unsigned int *d_order = d_keys + 2 * plan->m_numElements;
+    // The sorted position of each arc is only needed until the arcs get values
+    int *d_positionOf = (int*)plan->m_d_tourValue;
+    int *d_head = plan->m_d_firstChild + numNodes;
+
+    if (numEdges == 0)
+    {
+        int noParent = -1;
+        if (host)
+            d_parent[0] = noParent;
+        else
+            CUDA_SAFE_CALL(cudaMemcpy(d_parent, &noParent, sizeof(int),
+                                      cudaMemcpyHostToDevice));
+        return treeFromParents(plan, d_parent, numNodes);
+    }
+
+    treeGroup(plan, numArcs, numNodes, NULL, d_edgeU, d_edgeV);
+
+    if (host)
+    {
+        int numA = (int)numArcs;
+        int numE = (int)numEdges;
+
+#pragma omp parallel for
+        for (int i = 0; i < numA; ++i)
+            treeLinkArc(plan->m_d_firstChild, d_positionOf, d_keys, d_order, i);
+
+        unsigned int head = d_order[plan->m_d_firstChild[root]];
+#pragma omp parallel for
+        for (int a = 0; a < numA; ++a)
+            plan->m_d_tourNext[a] = treeEulerArc(plan->m_d_firstChild, d_positionOf,
+                                                 d_keys, d_order, head, a, numArcs);
+#pragma omp parallel for
+        for (int a = 0; a < numA; ++a)
+            plan->m_d_tourValue[a] = 1;
+        *d_head = (int)head;
+        d_parent[root] = -1;
+
+        cudppListScanDispatch(plan->m_d_tourPrefix, plan->m_d_tourValue, plan->m_d_tourNext,
+                              d_head, 1, numArcs, plan->m_scanPlan);
+
+#pragma omp parallel for
+        for (int e = 0; e < numE; ++e)
+            treeOrientEdge(d_parent, d_edgeU, d_edgeV, plan->m_d_tourPrefix, e);
+    }
+    else
+    {
+        dim3 grid = treeGrid(numArcs);
+
+        tree_link_groups<<< grid, TREE_CTA_SIZE >>>
+            (plan->m_d_firstChild, (int*)NULL, d_positionOf, d_keys, d_order, numArcs);
+        CUDA_CHECK_ERROR("tree_link_groups");
+        tree_euler_arcs<<< grid, TREE_CTA_SIZE >>>
+            (plan->m_d_tourNext, plan->m_d_firstChild, d_positionOf, d_keys, d_order,
+             root, numArcs);
+        CUDA_CHECK_ERROR("tree_euler_arcs");
+        tree_arc_values<<< grid, TREE_CTA_SIZE >>>
+            (plan->m_d_tourValue, d_head, d_parent, plan->m_d_firstChild, d_order,
+             root, numArcs);
+        CUDA_CHECK_ERROR("tree_arc_values");
+
+        cudppListScanDispatch(plan->m_d_tourPrefix, plan->m_d_tourValue, plan->m_d_tourNext,
+                              d_head, 1, numArcs, plan->m_scanPlan);
+
+        tree_orient_edges<<< treeGrid(numEdges), TREE_CTA_SIZE >>>
+            (d_parent, d_edgeU, d_edgeV, plan->m_d_tourPrefix, numEdges);
+        CUDA_CHECK_ERROR("tree_orient_edges");
+    }
+
+    return treeFromParents(plan, d_parent, numNodes);
+}
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @brief Allocate intermediate arrays used by the tree primitives.
+ *
+ * The arrays hold a forest of the plan's number of elements: the
+ * parents, children and pre-order positions of the nodes, the 2n arcs
+ * of the Euler tour with their values and prefixes, and the LCA sparse
+ * table of one entry per block of TREE_LCA_BLOCK_SIZE positions per
+ * level.  They are in host memory with CUDPP_OPTION_HOST.
+ *
+ * @param[in,out] plan Pointer to CUDPPTreePlan object
+ */
+void allocTreeStorage(CUDPPTreePlan *plan)
+{
+    bool host = (plan->m_config.options & CUDPP_OPTION_HOST) != 0;
+    size_t n = plan->m_numElements;
+    if (n < 1)
+        n = 1;
+    size_t numBlocks = (n + TREE_LCA_BLOCK_SIZE - 1) / TREE_LCA_BLOCK_SIZE;
+    size_t numLevels = treeLog2(numBlocks) + 1;
+
+    treeMalloc(&plan->m_d_parent,      n, host);
+    treeMalloc(&plan->m_d_firstChild,  n + 1, host);
+    treeMalloc(&plan->m_d_nextSibling, n, host);
+    treeMalloc(&plan->m_d_nodeAtPre,   n, host);
+    treeMalloc(&plan->m_d_tourNext,    2 * n, host);
+    treeMalloc(&plan->m_d_tourValue,   2 * n, host);
+    treeMalloc(&plan->m_d_tourPrefix,  2 * n, host);
+    treeMalloc(&plan->m_d_lcaTable,    numBlocks * numLevels, host);
+}
+
+/** @brief Deallocate intermediate arrays in a CUDPPTreePlan object.
+ *
+ * @param[in,out] plan Pointer to CUDPPTreePlan object initialized by allocTreeStorage().
+ */
+void freeTreeStorage(CUDPPTreePlan *plan)
+{
+    bool host = (plan->m_config.options & CUDPP_OPTION_HOST) != 0;
+
+    treeFree(plan->m_d_parent, host);
+    treeFree(plan->m_d_firstChild, host);
+    treeFree(plan->m_d_nextSibling, host);
+    treeFree(plan->m_d_nodeAtPre, host);
+    treeFree(plan->m_d_tourNext, host);
+    treeFree(plan->m_d_tourValue, host);
+    treeFree(plan->m_d_tourPrefix, host);
+    treeFree(plan->m_d_lcaTable, host);
+}
+
+/** @brief Dispatch function to build a forest from a parent array.
+ *
+ * This is the app-level interface used by cudppTreeFromParents().
+ *
+ * @param[in,out] plan Pointer to CUDPPTreePlan object
+ * @param[in] d_parent Parent of each node, negative for roots
+ * @param[in] numNodes Number of nodes
+ * @returns CUDPPResult indicating success or error condition
+ */
+CUDPPResult cudppTreeFromParentsDispatch(CUDPPTreePlan *plan,
+                                         const int     *d_parent,
+                                         size_t        numNodes)
+{
+    return treeFromParents(plan, d_parent, numNodes);
+}
+
+/** @brief Dispatch function to root and build a spanning tree given as
+ * an edge list.
+ *
+ * This is the app-level interface used by cudppTreeFromEdges().
+ *
+ * @param[in,out] plan Pointer to CUDPPTreePlan object
+ * @param[out] d_parent Parent of each node, -1 for \a root
+ * @param[in] d_edgeU First node of each edge
+ * @param[in] d_edgeV Second node of each edge
+ * @param[in] numNodes Number of nodes
+ * @param[in] root The root
+ * @returns CUDPPResult indicating success or error condition
+ */
+CUDPPResult cudppTreeFromEdgesDispatch(CUDPPTreePlan *plan,
+                                       int           *d_parent,
+                                       const int     *d_edgeU,
+                                       const int     *d_edgeV,
+                                       size_t        numNodes,
+                                       int           root)
+{
+    return treeFromEdges(plan, d_parent, d_edgeU, d_edgeV, numNodes, root);
+}
+
+/** @brief Dispatch function to number the nodes of the most recently
+ * built forest.
+ *
+ * This is the app-level interface used by cudppTreeOrder().  Any of the
+ * outputs may be NULL.
+ *
+ * @param[in] plan Pointer to CUDPPTreePlan object
+ * @param[out] d_preorder Pre-order number of each node
+ * @param[out] d_postorder Post-order number of each node
+ * @param[out] d_depth Depth of each node
+ * @param[out] d_subtreeSize Number of nodes in the subtree of each node
+ */
+void cudppTreeOrderDispatch(const CUDPPTreePlan *plan,
+                            int                 *d_preorder,
+                            int                 *d_postorder,
+                            int                 *d_depth,
+                            int                 *d_subtreeSize)
+{
+    size_t numNodes = plan->m_numNodes;
+    if (numNodes == 0)
+        return;
+
+    if (plan->m_config.options & CUDPP_OPTION_HOST)
+    {
+        int n = (int)numNodes;
+#pragma omp parallel for
+        for (int v = 0; v < n; ++v)
+            treeOrderNode(d_preorder, d_postorder, d_depth, d_subtreeSize,
+                          plan->m_d_tourPrefix, v, numNodes);
+        return;
+    }
+
+    tree_order<<< treeGrid(numNodes), TREE_CTA_SIZE >>>
+        (d_preorder, d_postorder, d_depth, d_subtreeSize, plan->m_d_tourPrefix, numNodes);
+    CUDA_CHECK_ERROR("tree_order");
+}
+
+/** @brief Dispatch function to answer lowest common ancestor queries on
+ * the most recently built forest.
+ *
+ * This is the app-level interface used by cudppTreeLCA().
+ *
+ * @param[in] plan Pointer to CUDPPTreePlan object
+ * @param[out] d_lca Lowest common ancestor of each pair, -1 for different trees
+ * @param[in] d_u First node of each pair
+ * @param[in] d_v Second node of each pair
+ * @param[in] numQueries Number of pairs
+ */
+void cudppTreeLCADispatch(const CUDPPTreePlan *plan,
+                          int                 *d_lca,
+                          const int           *d_u,
+                          const int           *d_v,
+                          size_t              numQueries)
+{
+    if (numQueries == 0)
+        return;
+
+    if (plan->m_config.options & CUDPP_OPTION_HOST)
+    {
+        int numQ = (int)numQueries;
+#pragma omp parallel for
+        for (int q = 0; q < numQ; ++q)
+            d_lca[q] = treeLCA(plan->m_d_parent, plan->m_d_nodeAtPre, plan->m_d_tourPrefix,
+                               plan->m_d_lcaTable, d_u[q], d_v[q], plan->m_lcaBlocks);
+        return;
+    }
+
+    tree_lca<<< treeGrid(numQueries), TREE_CTA_SIZE >>>
+        (d_lca, d_u, d_v, plan->m_d_parent, plan->m_d_nodeAtPre, plan->m_d_tourPrefix,
+         plan->m_d_lcaTable, numQueries, plan->m_lcaBlocks);
+    CUDA_CHECK_ERROR("tree_lca");
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} */ // end tree functions
+/** @} */ // end cudpp_app
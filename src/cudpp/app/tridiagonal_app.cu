@@ -26,6 +26,7 @@
 #include "cudpp_util.h"
 #include "cudpp_plan.h"
 #include "cudpp_manager.h"
+#include "cudpp_tridiagonal.h"
 #include "cuda_util.h"
 
 #include <cstdlib>
@@ -34,6 +35,10 @@
 
 #include "kernel/tridiagonal_kernel.cuh"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 template <typename T>
 inline unsigned int crpcrSharedSize(unsigned int systemSizeOriginal)
 {
@@ -54,6 +59,9 @@ inline unsigned int crpcrSharedSize(unsigned int systemSizeOriginal)
  * @param[in] d_d Right hand side
  * @param[in] systemSizeOriginal The size of the linear system
  * @param[in] numSystems The number of systems to be solved
+ * @param[in] elementStride Distance between consecutive elements of a system
+ * @param[in] systemStride Distance between the first elements of 
+ *            consecutive systems
  */
 template <typename T>
 void crpcr(T *d_a, 
@@ -62,7 +70,9 @@ void crpcr(T *d_a,
            T *d_d, 
            T *d_x, 
            unsigned int systemSizeOriginal, 
-           unsigned int numSystems)
+           unsigned int numSystems,
+           size_t elementStride,
+           size_t systemStride)
 {
     const unsigned int systemSize = ceilPow2(systemSizeOriginal);
     const unsigned int num_threads_block = systemSize/2;
@@ -80,17 +90,953 @@ void crpcr(T *d_a,
                                               d_d, 
                                               d_x, 
                                               systemSizeOriginal,
-                                              iterations);
+                                              iterations,
+                                              elementStride,
+                                              systemStride);
 
     CUDA_CHECK_ERROR("crpcr");
 }
 
 
+/**
+ * @brief Returns the grid for a kernel with one thread per item and 
+ * TRIDIAGONAL_THOMAS_CTA_SIZE threads per CTA
+ *
+ * The grid is capped at 65535 CTAs; the kernels loop over the remaining
+ * items.
+ *
+ * @param[in] numItems the number of items (systems, partitions or elements)
+ * @returns the grid dimensions
+ */
+inline dim3 tridiagonalGrid(size_t numItems)
+{
+    size_t numBlocks = 
+        (numItems + TRIDIAGONAL_THOMAS_CTA_SIZE - 1) / TRIDIAGONAL_THOMAS_CTA_SIZE;
+    return dim3((unsigned int)((numBlocks > 65535) ? 65535 : numBlocks), 1, 1);
+}
+
+/**
+ * @brief Returns the extent of a batch of systems in memory
+ *
+ * Element i of system s is at i * \a elementStride + s * \a systemStride,
+ * so the batch spans the returned number of elements.  Scratch arrays that 
+ * mirror the input layout have this size; for the contiguous and 
+ * interleaved layouts it is \a systemSize * \a numSystems.
+ *
+ * @param[in] systemSize The size of each linear system
+ * @param[in] numSystems The number of systems
+ * @param[in] elementStride Distance between consecutive elements of a system
+ * @param[in] systemStride Distance between the first elements of 
+ *            consecutive systems
+ * @returns the number of elements spanned
+ */
+inline size_t tridiagonalSpan(unsigned int systemSize, 
+                              unsigned int numSystems,
+                              size_t elementStride,
+                              size_t systemStride)
+{
+    return (size_t)(systemSize - 1) * elementStride + 
+        (size_t)(numSystems - 1) * systemStride + 1;
+}
+
+/**
+ * @brief Batched Thomas solver (one thread per system)
+ *
+ * This is a wrapper function for the GPU Thomas kernel.  It handles any
+ * system size, any number of systems and any layout.
+ *
+ * @param[out] d_x Solution vector
+ * @param[out] d_scratch Temporary storage in the layout of \a d_x, see 
+ *             tridiagonalSpan()
+ * @param[in] d_a Lower diagonal
+ * @param[in] d_b Main diagonal
+ * @param[in] d_c Upper diagonal
+ * @param[in] d_d Right hand side
+ * @param[in] systemSize The size of each linear system
+ * @param[in] numSystems The number of systems to be solved
+ * @param[in] elementStride Distance between consecutive elements of a system
+ * @param[in] systemStride Distance between the first elements of 
+ *            consecutive systems
+ */
+template <typename T>
+void thomas(const T *d_a, 
+            const T *d_b, 
+            const T *d_c, 
+            const T *d_d, 
+            T *d_x, 
+            T *d_scratch,
+            unsigned int systemSize, 
+            unsigned int numSystems,
+            size_t elementStride,
+            size_t systemStride)
+{
+    dim3 grid = tridiagonalGrid(numSystems);
+    dim3 threads(TRIDIAGONAL_THOMAS_CTA_SIZE, 1, 1);
+
+    thomasKernel<<< grid, threads >>>(d_a, d_b, d_c, d_d, d_x, d_scratch,
+                                      systemSize, numSystems, 
+                                      elementStride, systemStride);
+
+    CUDA_CHECK_ERROR("thomas");
+}
+
+/**
+ * @brief Batched Thomas solver on the host (CUDPP_OPTION_HOST)
+ *
+ * When the systems are adjacent in memory (\a systemStride 1, as in the 
+ * interleaved layout), each OpenMP thread takes a group of 
+ * TRIDIAGONAL_HOST_GROUP_SIZE systems and sweeps them together row by 
+ * row, so the inner loop runs over consecutive systems with unit stride 
+ * and the compiler can vectorize it.  Otherwise each thread solves whole 
+ * systems with thomasSystem(), and a single system is solved serially.
+ *
+ * @param[out] x Solution vector
+ * @param[out] scratch Temporary storage in the layout of \a x, see 
+ *             tridiagonalSpan()
+ * @param[in] a Lower diagonal
+ * @param[in] b Main diagonal
+ * @param[in] c Upper diagonal
+ * @param[in] d Right hand side
+ * @param[in] systemSize The size of each linear system
+ * @param[in] numSystems The number of systems to be solved
+ * @param[in] elementStride Distance between consecutive elements of a system
+ * @param[in] systemStride Distance between the first elements of 
+ *            consecutive systems
+ */
+template <typename T>
+void thomasHost(const T *a, 
+                const T *b, 
+                const T *c, 
+                const T *d, 
+                T *x, 
+                T *scratch,
+                unsigned int systemSize, 
+                unsigned int numSystems,
+                size_t elementStride,
+                size_t systemStride)
+{
+    if (systemStride != 1 || numSystems == 1)
+    {
+#pragma omp parallel for if (numSystems > 1)
+        for (int s = 0; s < (int)numSystems; ++s)
+            thomasSystem(a, b, c, d, x, scratch, 
+                         (size_t)s * systemStride, systemSize, elementStride);
+        return;
+    }
+
+    int numGroups = 
+        (int)((numSystems + TRIDIAGONAL_HOST_GROUP_SIZE - 1) / TRIDIAGONAL_HOST_GROUP_SIZE);
+
+#pragma omp parallel for
+    for (int g = 0; g < numGroups; ++g)
+    {
+        size_t first = (size_t)g * TRIDIAGONAL_HOST_GROUP_SIZE;
+        size_t end = (first + TRIDIAGONAL_HOST_GROUP_SIZE < numSystems) ? 
+            first + TRIDIAGONAL_HOST_GROUP_SIZE : numSystems;
+
+        for (size_t s = first; s < end; ++s)
+        {
+            scratch[s] = c[s] / b[s];
+            x[s] = d[s] / b[s];
+        }
+
+        size_t row = 0;
+        for (unsigned int i = 1; i < systemSize; ++i)
+        {
+            size_t prev = row;
+            row += elementStride;
+            for (size_t s = first; s < end; ++s)
+            {
+                T inv = 1 / (b[row + s] - a[row + s] * scratch[prev + s]);
+                scratch[row + s] = c[row + s] * inv;
+                x[row + s] = (d[row + s] - a[row + s] * x[prev + s]) * inv;
+            }
+        }
+
+        for (unsigned int i = systemSize - 1; i > 0; --i)
+        {
+            size_t next = row;
+            row -= elementStride;
+            for (size_t s = first; s < end; ++s)
+                x[row + s] -= scratch[row + s] * x[next + s];
+        }
+    }
+}
+
+/**
+ * @brief Returns the number of OpenMP threads the host solvers use
+ */
+inline unsigned int tridiagonalHostThreads()
+{
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+/**
+ * @brief Partitioned solver on the host (CUDPP_OPTION_HOST)
+ *
+ * The host counterpart of partitioned() for batches of fewer systems than
+ * OpenMP threads.  Every system is split into enough partitions to give 
+ * each thread TRIDIAGONAL_HOST_PARTS_PER_THREAD of them (but at least 
+ * TRIDIAGONAL_PARTITION_SIZE rows each); the threads reduce the 
+ * partitions with partitionReduce(), the small interface systems are 
+ * solved with thomasHost(), and the threads then recover the interior 
+ * unknowns with partitionSubstitute().
+ *
+ * @param[out] x Solution vector
+ * @param[out] scratch Temporary storage, see tridiagonalScratchSize()
+ * @param[in] a Lower diagonal
+ * @param[in] b Main diagonal
+ * @param[in] c Upper diagonal
+ * @param[in] d Right hand side
+ * @param[in] systemSize The size of each linear system, at least 
+ *            2 * TRIDIAGONAL_PARTITION_SIZE
+ * @param[in] numSystems The number of systems to be solved
+ * @param[in] elementStride Distance between consecutive elements of a system
+ * @param[in] systemStride Distance between the first elements of 
+ *            consecutive systems
+ */
+template <typename T>
+void partitionedHost(const T *a, 
+                     const T *b, 
+                     const T *c, 
+                     const T *d, 
+                     T *x, 
+                     T *scratch,
+                     unsigned int systemSize, 
+                     unsigned int numSystems,
+                     size_t elementStride,
+                     size_t systemStride)
+{
+    unsigned int numParts = 
+        (TRIDIAGONAL_HOST_PARTS_PER_THREAD * tridiagonalHostThreads() + numSystems - 1) / 
+        numSystems;
+    if (numParts > systemSize / TRIDIAGONAL_PARTITION_SIZE)
+        numParts = systemSize / TRIDIAGONAL_PARTITION_SIZE;
+    const unsigned int partSize = systemSize / numParts;
+    const unsigned int reducedSize = 2 * numParts;
+
+    size_t span = tridiagonalSpan(systemSize, numSystems, elementStride, systemStride);
+    size_t numReduced = (size_t)reducedSize * numSystems;
+
+    T *aPrime = scratch;
+    T *cPrime = aPrime + span;
+    T *ra = cPrime + span;
+    T *rb = ra + numReduced;
+    T *rc = rb + numReduced;
+    T *rd = rc + numReduced;
+    T *rx = rd + numReduced;
+    T *reducedScratch = rx + numReduced;
+
+    int numItems = (int)(numSystems * numParts);
+
+#pragma omp parallel for
+    for (int t = 0; t < numItems; ++t)
+        partitionReduce(a, b, c, d, x, aPrime, cPrime, ra, rb, rc, rd, systemSize,
+                        (unsigned int)t % numSystems, (unsigned int)t / numSystems,
+                        partSize, numParts, elementStride, systemStride);
+
+    thomasHost<T>(ra, rb, rc, rd, rx, reducedScratch, 
+                  reducedSize, numSystems, 1, reducedSize);
+
+#pragma omp parallel for
+    for (int t = 0; t < numItems; ++t)
+        partitionSubstitute(x, aPrime, cPrime, rx, systemSize,
+                            (unsigned int)t % numSystems, (unsigned int)t / numSystems,
+                            partSize, numParts, elementStride, systemStride);
+}
+
+// defined below; tridiagonalSolve() and partitioned() are mutually recursive
+template <typename T>
+void partitioned(const T *d_a, 
+                 const T *d_b, 
+                 const T *d_c, 
+                 const T *d_d, 
+                 T *d_x, 
+                 T *d_scratch,
+                 unsigned int systemSize, 
+                 unsigned int numSystems,
+                 size_t elementStride,
+                 size_t systemStride,
+                 const cudaDeviceProp &prop);
+
+/** @brief The solvers available to cudppTridiagonal() */
+enum TridiagonalSolver
+{
+    TRIDIAGONAL_CRPCR,          //!< Hybrid CR-PCR, one system per CTA
+    TRIDIAGONAL_THOMAS,         //!< Thomas, one system per thread
+    TRIDIAGONAL_PARTITIONED,    //!< Partitioned, one partition per thread
+    TRIDIAGONAL_HOST_THOMAS,    //!< Thomas on the host, see thomasHost()
+    TRIDIAGONAL_HOST_PARTITIONED, //!< Partitioned on the host, see partitionedHost()
+};
+
+/**
+ * @brief Chooses the solver for a batch of tridiagonal systems
+ *
+ * Systems with contiguous elements that fit in one CTA's shared memory 
+ * are solved by CR-PCR.  Otherwise, batches with enough systems to fill the GPU are 
+ * solved by Thomas, one system per thread, and batches of fewer, large 
+ * systems by the partitioned solver, which also parallelizes within each
+ * system.  Plans with CUDPP_OPTION_HOST solve on the host, likewise with
+ * the partitioned solver when there are fewer large systems than OpenMP
+ * threads and with Thomas otherwise.
+ *
+ * @param[in] systemSize The size of each linear system
+ * @param[in] numSystems The number of systems to be solved
+ * @param[in] elementStride Distance between consecutive elements of a system
+ * @param[in] host Whether to solve on the host
+ * @param[in] prop properties of the device
+ * @returns the solver to use
+ */
+template <typename T>
+TridiagonalSolver chooseTridiagonalSolver(unsigned int systemSize, 
+                                          unsigned int numSystems,
+                                          size_t elementStride,
+                                          bool host,
+                                          const cudaDeviceProp &prop)
+{
+    if (host)
+    {
+        if (systemSize >= 2 * TRIDIAGONAL_PARTITION_SIZE && 
+            numSystems < tridiagonalHostThreads())
+            return TRIDIAGONAL_HOST_PARTITIONED;
+        return TRIDIAGONAL_HOST_THOMAS;
+    }
+
+    if (elementStride == 1 && 
+        systemSize > 2 &&
+        numSystems <= 65535 &&
+        ceilPow2(systemSize) <= (unsigned)prop.maxThreadsPerBlock &&
+        crpcrSharedSize<T>(systemSize) <= prop.sharedMemPerBlock)
+        return TRIDIAGONAL_CRPCR;
+
+    size_t fillThreads = 
+        (size_t)prop.multiProcessorCount * prop.maxThreadsPerMultiProcessor;
+
+    if (systemSize >= 2 * TRIDIAGONAL_PARTITION_SIZE && numSystems < fillThreads)
+        return TRIDIAGONAL_PARTITIONED;
+
+    return TRIDIAGONAL_THOMAS;
+}
+
+/**
+ * @brief Returns the number of scratch elements tridiagonalSolve() needs
+ *
+ * At most TRIDIAGONAL_SCRATCH_FACTOR times the span of the batch (see 
+ * tridiagonalSpan()).
+ *
+ * @param[in] systemSize The size of each linear system
+ * @param[in] numSystems The number of systems to be solved
+ * @param[in] elementStride Distance between consecutive elements of a system
+ * @param[in] systemStride Distance between the first elements of 
+ *            consecutive systems
+ * @param[in] host Whether to solve on the host
+ * @param[in] prop properties of the device
+ * @returns the number of elements of type T
+ */
+template <typename T>
+size_t tridiagonalScratchSize(unsigned int systemSize, 
+                              unsigned int numSystems,
+                              size_t elementStride,
+                              size_t systemStride,
+                              bool host,
+                              const cudaDeviceProp &prop)
+{
+    size_t span = tridiagonalSpan(systemSize, numSystems, elementStride, systemStride);
+
+    switch (chooseTridiagonalSolver<T>(systemSize, numSystems, elementStride, host, prop))
+    {
+    case TRIDIAGONAL_THOMAS:
+    case TRIDIAGONAL_HOST_THOMAS:
+        return span;
+    case TRIDIAGONAL_PARTITIONED:
+        {
+            unsigned int reducedSize = 2 * (systemSize / TRIDIAGONAL_PARTITION_SIZE);
+            size_t numReduced = (size_t)reducedSize * numSystems;
+            return 2 * span + 5 * numReduced + 
+                tridiagonalScratchSize<T>(reducedSize, numSystems, 1, reducedSize, 
+                                          false, prop);
+        }
+    case TRIDIAGONAL_HOST_PARTITIONED:
+        {
+            // at most this many partitions, see partitionedHost()
+            size_t numReduced = 
+                (size_t)2 * (systemSize / TRIDIAGONAL_PARTITION_SIZE) * numSystems;
+            return 2 * span + 6 * numReduced;
+        }
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Solves batched tridiagonal systems of type \a T with the solver 
+ * chosen by chooseTridiagonalSolver()
+ *
+ * @param[out] d_x Solution vector
+ * @param[out] d_scratch Temporary storage, see tridiagonalScratchSize()
+ * @param[in] d_a Lower diagonal
+ * @param[in] d_b Main diagonal
+ * @param[in] d_c Upper diagonal
+ * @param[in] d_d Right hand side
+ * @param[in] systemSize The size of each linear system
+ * @param[in] numSystems The number of systems to be solved
+ * @param[in] elementStride Distance between consecutive elements of a system
+ * @param[in] systemStride Distance between the first elements of 
+ *            consecutive systems
+ * @param[in] host Whether to solve on the host
+ * @param[in] prop properties of the device
+ */
+template <typename T>
+void tridiagonalSolve(const T *d_a, 
+                      const T *d_b, 
+                      const T *d_c, 
+                      const T *d_d, 
+                      T *d_x, 
+                      T *d_scratch,
+                      unsigned int systemSize, 
+                      unsigned int numSystems,
+                      size_t elementStride,
+                      size_t systemStride,
+                      bool host,
+                      const cudaDeviceProp &prop)
+{
+    switch (chooseTridiagonalSolver<T>(systemSize, numSystems, elementStride, host, prop))
+    {
+    case TRIDIAGONAL_CRPCR:
+        crpcr<T>((T*)d_a, (T*)d_b, (T*)d_c, (T*)d_d, d_x, systemSize, numSystems,
+                 elementStride, systemStride);
+        break;
+    case TRIDIAGONAL_THOMAS:
+        thomas<T>(d_a, d_b, d_c, d_d, d_x, d_scratch, 
+                  systemSize, numSystems, elementStride, systemStride);
+        break;
+    case TRIDIAGONAL_PARTITIONED:
+        partitioned<T>(d_a, d_b, d_c, d_d, d_x, d_scratch, 
+                       systemSize, numSystems, elementStride, systemStride, prop);
+        break;
+    case TRIDIAGONAL_HOST_THOMAS:
+        thomasHost<T>(d_a, d_b, d_c, d_d, d_x, d_scratch, 
+                      systemSize, numSystems, elementStride, systemStride);
+        break;
+    case TRIDIAGONAL_HOST_PARTITIONED:
+        partitionedHost<T>(d_a, d_b, d_c, d_d, d_x, d_scratch, 
+                           systemSize, numSystems, elementStride, systemStride);
+        break;
+    }
+}
+
+/**
+ * @brief Partitioned solver for large tridiagonal systems
+ *
+ * Splits every system into partitions of TRIDIAGONAL_PARTITION_SIZE rows, 
+ * reduces each partition in parallel to two equations coupling it to its 
+ * neighbours, solves the resulting interface systems (of 2 equations per 
+ * partition) with tridiagonalSolve(), which recurses until they are small
+ * enough for CR-PCR or Thomas, and finally recovers the interior unknowns 
+ * of each partition in parallel.  This exposes parallelism within a 
+ * system, so a few very large systems keep the whole GPU busy.
+ *
+ * @param[out] d_x Solution vector
+ * @param[out] d_scratch Temporary storage, see tridiagonalScratchSize()
+ * @param[in] d_a Lower diagonal
+ * @param[in] d_b Main diagonal
+ * @param[in] d_c Upper diagonal
+ * @param[in] d_d Right hand side
+ * @param[in] systemSize The size of each linear system, at least 
+ *            2 * TRIDIAGONAL_PARTITION_SIZE
+ * @param[in] numSystems The number of systems to be solved
+ * @param[in] elementStride Distance between consecutive elements of a system
+ * @param[in] systemStride Distance between the first elements of 
+ *            consecutive systems
+ * @param[in] prop properties of the device
+ */
+template <typename T>
+void partitioned(const T *d_a, 
+                 const T *d_b, 
+                 const T *d_c, 
+                 const T *d_d, 
+                 T *d_x, 
+                 T *d_scratch,
+                 unsigned int systemSize, 
+                 unsigned int numSystems,
+                 size_t elementStride,
+                 size_t systemStride,
+                 const cudaDeviceProp &prop)
+{
+    const unsigned int partSize = TRIDIAGONAL_PARTITION_SIZE;
+    const unsigned int numParts = systemSize / partSize;
+    const unsigned int reducedSize = 2 * numParts;
+
+    size_t span = tridiagonalSpan(systemSize, numSystems, elementStride, systemStride);
+    size_t numReduced = (size_t)reducedSize * numSystems;
+
+    T *d_aPrime = d_scratch;
+    T *d_cPrime = d_aPrime + span;
+    T *d_ra = d_cPrime + span;
+    T *d_rb = d_ra + numReduced;
+    T *d_rc = d_rb + numReduced;
+    T *d_rd = d_rc + numReduced;
+    T *d_rx = d_rd + numReduced;
+    T *d_reducedScratch = d_rx + numReduced;
+
+    dim3 grid = tridiagonalGrid((size_t)numSystems * numParts);
+    dim3 threads(TRIDIAGONAL_THOMAS_CTA_SIZE, 1, 1);
+
+    partitionReduceKernel<<< grid, threads >>>(d_a, d_b, d_c, d_d, d_x,
+                                               d_aPrime, d_cPrime, 
+                                               d_ra, d_rb, d_rc, d_rd,
+                                               systemSize, numSystems, 
+                                               partSize, numParts,
+                                               elementStride, systemStride);
+    CUDA_CHECK_ERROR("partitionReduce");
+
+    tridiagonalSolve<T>(d_ra, d_rb, d_rc, d_rd, d_rx, d_reducedScratch,
+                        reducedSize, numSystems, 1, reducedSize, false, prop);
+
+    partitionSubstituteKernel<<< grid, threads >>>(d_x, d_aPrime, d_cPrime, d_rx,
+                                                   systemSize, numSystems, 
+                                                   partSize, numParts,
+                                                   elementStride, systemStride);
+    CUDA_CHECK_ERROR("partitionSubstitute");
+}
+
+/**
+ * @brief Solves batched cyclic tridiagonal systems with the 
+ * Sherman-Morrison formula
+ *
+ * The cyclic system is written as a plain tridiagonal system plus a 
+ * rank-one correction (see cyclicSetupKernel()).  The plain system is 
+ * solved for the right hand side and for the correction vector with 
+ * tridiagonalSolve(), so every solver and layout is available, and the 
+ * two solutions are combined.
+ *
+ * @param[out] d_x Solution vector
+ * @param[out] d_scratch Temporary storage, see cyclicScratchSize()
+ * @param[in] d_a Lower diagonal; a[0] couples the first row to x[n-1]
+ * @param[in] d_b Main diagonal
+ * @param[in] d_c Upper diagonal; c[n-1] couples the last row to x[0]
+ * @param[in] d_d Right hand side
+ * @param[in] systemSize The size of each linear system, at least 3
+ * @param[in] numSystems The number of systems to be solved
+ * @param[in] elementStride Distance between consecutive elements of a system
+ * @param[in] systemStride Distance between the first elements of 
+ *            consecutive systems
+ * @param[in] prop properties of the device
+ */
+template <typename T>
+void cyclic(const T *d_a, 
+            const T *d_b, 
+            const T *d_c, 
+            const T *d_d, 
+            T *d_x, 
+            T *d_scratch,
+            unsigned int systemSize, 
+            unsigned int numSystems,
+            size_t elementStride,
+            size_t systemStride,
+            const cudaDeviceProp &prop)
+{
+    size_t numElements = (size_t)systemSize * numSystems;
+    size_t span = tridiagonalSpan(systemSize, numSystems, elementStride, systemStride);
+
+    T *d_bMod = d_scratch;
+    T *d_u = d_bMod + span;
+    T *d_z = d_u + span;
+    T *d_factor = d_z + span;
+    T *d_solveScratch = d_factor + numSystems;
+
+    dim3 threads(TRIDIAGONAL_THOMAS_CTA_SIZE, 1, 1);
+
+    cyclicSetupKernel<<< tridiagonalGrid(numElements), threads >>>
+        (d_bMod, d_u, d_a, d_b, d_c, systemSize, numSystems, 
+         elementStride, systemStride);
+    CUDA_CHECK_ERROR("cyclicSetup");
+
+    tridiagonalSolve<T>(d_a, d_bMod, d_c, d_d, d_x, d_solveScratch,
+                        systemSize, numSystems, elementStride, systemStride, false, prop);
+    tridiagonalSolve<T>(d_a, d_bMod, d_c, d_u, d_z, d_solveScratch,
+                        systemSize, numSystems, elementStride, systemStride, false, prop);
+
+    cyclicFactorKernel<<< tridiagonalGrid(numSystems), threads >>>
+        (d_factor, d_x, d_z, d_a, d_b, systemSize, numSystems, 
+         elementStride, systemStride);
+    CUDA_CHECK_ERROR("cyclicFactor");
+
+    cyclicCorrectKernel<<< tridiagonalGrid(numElements), threads >>>
+        (d_x, d_z, d_factor, systemSize, numSystems, 
+         elementStride, systemStride);
+    CUDA_CHECK_ERROR("cyclicCorrect");
+}
+
+/**
+ * @brief Returns the number of scratch elements cyclic() needs
+ *
+ * @param[in] systemSize The size of each linear system
+ * @param[in] numSystems The number of systems to be solved
+ * @param[in] elementStride Distance between consecutive elements of a system
+ * @param[in] systemStride Distance between the first elements of 
+ *            consecutive systems
+ * @param[in] prop properties of the device
+ * @returns the number of elements of type T
+ */
+template <typename T>
+size_t cyclicScratchSize(unsigned int systemSize, 
+                         unsigned int numSystems,
+                         size_t elementStride,
+                         size_t systemStride,
+                         const cudaDeviceProp &prop)
+{
+    return 3 * tridiagonalSpan(systemSize, numSystems, elementStride, systemStride) + 
+        numSystems + 
+        tridiagonalScratchSize<T>(systemSize, numSystems, elementStride, systemStride, 
+                                  false, prop);
+}
+
+/** @brief Allocates the scratch storage of a tridiagonal plan
+  *
+  * The Thomas and partitioned solvers need temporary storage of at most 
+  * TRIDIAGONAL_SCRATCH_FACTOR elements per equation, and cyclic systems 
+  * (CUDPP_OPTION_CYCLIC) TRIDIAGONAL_CYCLIC_SCRATCH_FACTOR.  It is 
+  * allocated here when the plan is created with a nonzero maximum number
+  * of elements (systemSize * numSystems); otherwise, or if a call needs 
+  * more (as strided layouts with gaps between systems and 
+  * block-tridiagonal solves with 3x3 blocks may), the dispatch allocates 
+  * it for that call.  Plans with CUDPP_OPTION_HOST keep it in host memory.
+  *
+  * @param plan Pointer to CUDPPTridiagonalPlan object within which 
+  *             intermediate storage is allocated.
+  */
+void allocTridiagonalStorage(CUDPPTridiagonalPlan *plan)
+{
+    plan->m_d_scratch = 0;
+    plan->m_scratchElements = 0;
+    if (plan->m_numElements > 0)
+    {
+        size_t elementSize = 
+            (plan->m_config.datatype == CUDPP_DOUBLE) ? sizeof(double) : sizeof(float);
+        size_t factor = (plan->m_config.options & CUDPP_OPTION_CYCLIC) ? 
+            TRIDIAGONAL_CYCLIC_SCRATCH_FACTOR : TRIDIAGONAL_SCRATCH_FACTOR;
+        plan->m_scratchElements = factor * plan->m_numElements;
+        if (plan->m_config.options & CUDPP_OPTION_HOST)
+            plan->m_d_scratch = malloc(elementSize * plan->m_scratchElements);
+        else
+            CUDA_SAFE_CALL( cudaMalloc((void**)&plan->m_d_scratch, 
+                                       elementSize * plan->m_scratchElements) );
+    }
+}
+
+/** @brief Deallocates the scratch storage of a tridiagonal plan
+  *
+  * @param plan Pointer to CUDPPTridiagonalPlan object initialized by 
+  *             allocTridiagonalStorage().
+  */
+void freeTridiagonalStorage(CUDPPTridiagonalPlan *plan)
+{
+    if (plan->m_d_scratch)
+    {
+        if (plan->m_config.options & CUDPP_OPTION_HOST)
+            free(plan->m_d_scratch);
+        else
+            CUDA_SAFE_CALL( cudaFree(plan->m_d_scratch) );
+    }
+}
+
+/**
+ * @brief Factors the systems of a CUDPPTridiagonalFactorPlan of type \a T
+ *
+ * @param[in,out] plan pointer to CUDPPTridiagonalFactorPlan whose factor
+ *                storage is allocated
+ * @param[in] d_a Lower diagonal
+ * @param[in] d_b Main diagonal
+ * @param[in] d_c Upper diagonal
+ */
+template <typename T>
+void tridiagonalFactor(CUDPPTridiagonalFactorPlan *plan, 
+                       const T *d_a, 
+                       const T *d_b, 
+                       const T *d_c)
+{
+    bool interleaved = (plan->m_config.options & CUDPP_OPTION_INTERLEAVED) != 0;
+    bool isCyclic = (plan->m_config.options & CUDPP_OPTION_CYCLIC) != 0;
+    size_t elementStride = interleaved ? plan->m_numSystems : 1;
+    size_t systemStride = interleaved ? 1 : plan->m_systemSize;
+
+    dim3 grid = tridiagonalGrid(plan->m_numSystems);
+    dim3 threads(TRIDIAGONAL_THOMAS_CTA_SIZE, 1, 1);
+    thomasFactorKernel<<< grid, threads >>>
+        ((T*)plan->m_d_lower, (T*)plan->m_d_inverse, (T*)plan->m_d_upper, 
+         (T*)plan->m_d_z, (T*)plan->m_d_cyclic, d_a, d_b, d_c, 
+         plan->m_systemSize, plan->m_numSystems, elementStride, systemStride, 
+         isCyclic);
+    CUDA_CHECK_ERROR("thomasFactor");
+}
+
+/** @brief Allocates the factor storage of a tridiagonal factor plan and 
+  * factors its systems
+  *
+  * Three arrays of systemSize * numSystems elements hold the factors; 
+  * cyclic systems (CUDPP_OPTION_CYCLIC) add one more, and two elements per
+  * system, for the Sherman-Morrison correction.
+  *
+  * @param plan Pointer to CUDPPTridiagonalFactorPlan object within which 
+  *             the factors are stored.
+  * @param[in] d_a Lower diagonal
+  * @param[in] d_b Main diagonal
+  * @param[in] d_c Upper diagonal
+  */
+void allocTridiagonalFactorStorage(CUDPPTridiagonalFactorPlan *plan,
+                                   const void *d_a, 
+                                   const void *d_b, 
+                                   const void *d_c)
+{
+    bool isDouble = (plan->m_config.datatype == CUDPP_DOUBLE);
+    size_t size = plan->m_numElements * (isDouble ? sizeof(double) : sizeof(float));
+
+    CUDA_SAFE_CALL( cudaMalloc(&plan->m_d_lower, size) );
+    CUDA_SAFE_CALL( cudaMalloc(&plan->m_d_inverse, size) );
+    CUDA_SAFE_CALL( cudaMalloc(&plan->m_d_upper, size) );
+    if (plan->m_config.options & CUDPP_OPTION_CYCLIC)
+    {
+        CUDA_SAFE_CALL( cudaMalloc(&plan->m_d_z, size) );
+        CUDA_SAFE_CALL( cudaMalloc(&plan->m_d_cyclic, 2 * plan->m_numSystems * 
+                                   (isDouble ? sizeof(double) : sizeof(float))) );
+    }
+
+    if (isDouble)
+        tridiagonalFactor<double>(plan, (const double*)d_a, (const double*)d_b, 
+                                  (const double*)d_c);
+    else
+        tridiagonalFactor<float>(plan, (const float*)d_a, (const float*)d_b, 
+                                 (const float*)d_c);
+}
+
+/** @brief Deallocates the factor storage of a tridiagonal factor plan
+  *
+  * @param plan Pointer to CUDPPTridiagonalFactorPlan object initialized by 
+  *             allocTridiagonalFactorStorage().
+  */
+void freeTridiagonalFactorStorage(CUDPPTridiagonalFactorPlan *plan)
+{
+    CUDA_SAFE_CALL( cudaFree(plan->m_d_lower) );
+    CUDA_SAFE_CALL( cudaFree(plan->m_d_inverse) );
+    CUDA_SAFE_CALL( cudaFree(plan->m_d_upper) );
+    if (plan->m_d_z)
+        CUDA_SAFE_CALL( cudaFree(plan->m_d_z) );
+    if (plan->m_d_cyclic)
+        CUDA_SAFE_CALL( cudaFree(plan->m_d_cyclic) );
+}
+
+/**
+ * @brief Returns scratch storage of at least \a numElements elements: the 
+ * plan's if it is large enough, otherwise a new allocation
+ *
+ * @param[out] d_scratch the scratch storage
+ * @param[in] numElements the number of elements needed
+ * @param[in] plan pointer to CUDPPTridiagonalPlan
+ * @returns CUDPP_ERROR_INSUFFICIENT_RESOURCES if the allocation failed.
+ * Release \a d_scratch with releaseTridiagonalScratch().
+ */
+template <typename T>
+CUDPPResult acquireTridiagonalScratch(T *&d_scratch, 
+                                      size_t numElements,
+                                      const CUDPPTridiagonalPlan *plan)
+{
+    if (numElements <= plan->m_scratchElements)
+    {
+        d_scratch = (T*)plan->m_d_scratch;
+        return CUDPP_SUCCESS;
+    }
+    if (plan->m_config.options & CUDPP_OPTION_HOST)
+    {
+        d_scratch = (T*)malloc(numElements * sizeof(T));
+        return d_scratch ? CUDPP_SUCCESS : CUDPP_ERROR_INSUFFICIENT_RESOURCES;
+    }
+    if (cudaMalloc((void**)&d_scratch, numElements * sizeof(T)) != cudaSuccess)
+        return CUDPP_ERROR_INSUFFICIENT_RESOURCES;
+    return CUDPP_SUCCESS;
+}
+
+/**
+ * @brief Releases scratch storage returned by acquireTridiagonalScratch()
+ *
+ * @param[in] d_scratch the scratch storage
+ * @param[in] plan pointer to CUDPPTridiagonalPlan
+ */
+template <typename T>
+void releaseTridiagonalScratch(T *d_scratch, const CUDPPTridiagonalPlan *plan)
+{
+    if (d_scratch == plan->m_d_scratch)
+        return;
+    if (plan->m_config.options & CUDPP_OPTION_HOST)
+        free(d_scratch);
+    else
+        CUDA_SAFE_CALL(cudaFree(d_scratch));
+}
+
+/**
+ * @brief Solves batched tridiagonal systems of type \a T, providing the 
+ * scratch storage of the chosen solver
+ *
+ * @param[out] d_x Solution vector
+ * @param[in] d_a Lower diagonal
+ * @param[in] d_b Main diagonal
+ * @param[in] d_c Upper diagonal
+ * @param[in] d_d Right hand side
+ * @param[in] systemSize The size of the linear system
+ * @param[in] numSystems The number of systems to be solved
+ * @param[in] elementStride Distance between consecutive elements of a system
+ * @param[in] systemStride Distance between the first elements of 
+ *            consecutive systems
+ * @param[in] plan pointer to CUDPPTridiagonalPlan
+ * @returns CUDPPResult indicating success or error condition
+ */
+template <typename T>
+CUDPPResult tridiagonalDispatch(T *d_a, 
+                                T *d_b, 
+                                T *d_c, 
+                                T *d_d, 
+                                T *d_x, 
+                                unsigned int systemSize, 
+                                unsigned int numSystems, 
+                                size_t elementStride,
+                                size_t systemStride,
+                                const CUDPPTridiagonalPlan * plan)
+{
+    cudaDeviceProp prop;
+    plan->m_planManager->getDeviceProps(prop);
+
+    bool isCyclic = (plan->m_config.options & CUDPP_OPTION_CYCLIC) != 0;
+    bool host = (plan->m_config.options & CUDPP_OPTION_HOST) != 0;
+
+    // the host solvers do not handle cyclic systems
+    if (isCyclic && (systemSize < 3 || host))
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    size_t scratchSize = isCyclic ?
+        cyclicScratchSize<T>(systemSize, numSystems, elementStride, systemStride, prop) :
+        tridiagonalScratchSize<T>(systemSize, numSystems, elementStride, systemStride, 
+                                  host, prop);
+    T *d_scratch = 0;
+    CUDPPResult result = acquireTridiagonalScratch(d_scratch, scratchSize, plan);
+    if (result != CUDPP_SUCCESS)
+        return result;
+
+    if (isCyclic)
+        cyclic<T>(d_a, d_b, d_c, d_d, d_x, d_scratch, 
+                  systemSize, numSystems, elementStride, systemStride, prop);
+    else
+        tridiagonalSolve<T>(d_a, d_b, d_c, d_d, d_x, d_scratch, 
+                            systemSize, numSystems, elementStride, systemStride, 
+                            host, prop);
+
+    releaseTridiagonalScratch(d_scratch, plan);
+
+    return CUDPP_SUCCESS;
+}
+
+/**
+ * @brief Solves batched pentadiagonal systems of type \a T
+ *
+ * @param[out] d_x Solution vector
+ * @param[in] d_e Second lower diagonal
+ * @param[in] d_a Lower diagonal
+ * @param[in] d_b Main diagonal
+ * @param[in] d_c Upper diagonal
+ * @param[in] d_f Second upper diagonal
+ * @param[in] d_d Right hand side
+ * @param[in] systemSize The size of the linear system
+ * @param[in] numSystems The number of systems to be solved
+ * @param[in] plan pointer to CUDPPTridiagonalPlan
+ * @returns CUDPPResult indicating success or error condition
+ */
+template <typename T>
+CUDPPResult pentadiagonalDispatch(const T *d_e, 
+                                  const T *d_a, 
+                                  const T *d_b, 
+                                  const T *d_c, 
+                                  const T *d_f, 
+                                  const T *d_d, 
+                                  T *d_x, 
+                                  unsigned int systemSize, 
+                                  unsigned int numSystems, 
+                                  const CUDPPTridiagonalPlan * plan)
+{
+    bool interleaved = (plan->m_config.options & CUDPP_OPTION_INTERLEAVED) != 0;
+    size_t elementStride = interleaved ? numSystems : 1;
+    size_t systemStride = interleaved ? 1 : systemSize;
+
+    T *d_scratch = 0;
+    CUDPPResult result = 
+        acquireTridiagonalScratch(d_scratch, 2 * (size_t)systemSize * numSystems, plan);
+    if (result != CUDPP_SUCCESS)
+        return result;
+
+    dim3 threads(TRIDIAGONAL_THOMAS_CTA_SIZE, 1, 1);
+    pentadiagonalKernel<<< tridiagonalGrid(numSystems), threads >>>
+        (d_e, d_a, d_b, d_c, d_f, d_d, d_x, d_scratch, 
+         systemSize, numSystems, elementStride, systemStride);
+    CUDA_CHECK_ERROR("pentadiagonal");
+
+    releaseTridiagonalScratch(d_scratch, plan);
+
+    return CUDPP_SUCCESS;
+}
+
+/**
+ * @brief Solves batched block-tridiagonal systems of type \a T with 
+ * \a M x \a M blocks
+ *
+ * @param[out] d_x Solution vectors
+ * @param[in] d_a Lower diagonal blocks
+ * @param[in] d_b Main diagonal blocks
+ * @param[in] d_c Upper diagonal blocks
+ * @param[in] d_d Right hand side vectors
+ * @param[in] systemSize The number of block rows of each system
+ * @param[in] numSystems The number of systems to be solved
+ * @param[in] plan pointer to CUDPPTridiagonalPlan
+ * @returns CUDPPResult indicating success or error condition
+ */
+template <typename T, int M>
+CUDPPResult blockTridiagonalDispatch(const T *d_a, 
+                                     const T *d_b, 
+                                     const T *d_c, 
+                                     const T *d_d, 
+                                     T *d_x, 
+                                     unsigned int systemSize, 
+                                     unsigned int numSystems, 
+                                     const CUDPPTridiagonalPlan * plan)
+{
+    bool interleaved = (plan->m_config.options & CUDPP_OPTION_INTERLEAVED) != 0;
+    size_t elementStride = interleaved ? numSystems : 1;
+    size_t systemStride = interleaved ? 1 : systemSize;
+
+    T *d_scratch = 0;
+    CUDPPResult result = 
+        acquireTridiagonalScratch(d_scratch, M * M * (size_t)systemSize * numSystems, plan);
+    if (result != CUDPP_SUCCESS)
+        return result;
+
+    dim3 threads(TRIDIAGONAL_THOMAS_CTA_SIZE, 1, 1);
+    blockTridiagonalKernel<T, M><<< tridiagonalGrid(numSystems), threads >>>
+        (d_a, d_b, d_c, d_d, d_x, d_scratch, 
+         systemSize, numSystems, elementStride, systemStride);
+    CUDA_CHECK_ERROR("blockTridiagonal");
+
+    releaseTridiagonalScratch(d_scratch, plan);
+
+    return CUDPP_SUCCESS;
+}
+
 /**
  * @brief Dispatches the tridiagonal function based on the plan
  *
  * This is the dispatch call for the tridiagonal solver in either float 
- * or double datatype. 
+ * or double datatype, for systems in the contiguous layout or, with 
+ * CUDPP_OPTION_INTERLEAVED, the interleaved layout.
  *
  * @param[out] d_x Solution vector
  * @param[in] d_a Lower diagonal
@@ -111,47 +1057,253 @@ CUDPPResult cudppTridiagonalDispatch(void *d_a,
                                      int numSystems, 
                                      const CUDPPTridiagonalPlan * plan)
 {
-    cudaDeviceProp prop;
-    plan->m_planManager->getDeviceProps(prop);
+    if (systemSize <= 0 || numSystems <= 0)
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    bool interleaved = (plan->m_config.options & CUDPP_OPTION_INTERLEAVED) != 0;
 
-    if (ceilPow2(systemSize) > (unsigned)prop.maxThreadsPerBlock)
+    return cudppTridiagonalStridedDispatch(d_a, d_b, d_c, d_d, d_x, 
+                                           systemSize, numSystems,
+                                           interleaved ? numSystems : 1,
+                                           interleaved ? 1 : systemSize,
+                                           plan);
+}
+
+/**
+ * @brief Dispatches the tridiagonal function for systems in an arbitrary
+ * strided layout
+ *
+ * Element i of system s is at i * \a elementStride + s * \a systemStride;
+ * the layout option of the plan is ignored.
+ *
+ * @param[out] d_x Solution vector
+ * @param[in] d_a Lower diagonal
+ * @param[in] d_b Main diagonal
+ * @param[in] d_c Upper diagonal
+ * @param[in] d_d Right hand side
+ * @param[in] systemSize The size of the linear system
+ * @param[in] numSystems The number of systems to be solved
+ * @param[in] elementStride Distance between consecutive elements of a system
+ * @param[in] systemStride Distance between the first elements of 
+ *            consecutive systems
+ * @param[in] plan pointer to CUDPPTridiagonalPlan
+ * @returns CUDPPResult indicating success or error condition
+ */
+CUDPPResult cudppTridiagonalStridedDispatch(void *d_a, 
+                                            void *d_b, 
+                                            void *d_c, 
+                                            void *d_d, 
+                                            void *d_x, 
+                                            int systemSize, 
+                                            int numSystems, 
+                                            size_t elementStride,
+                                            size_t systemStride,
+                                            const CUDPPTridiagonalPlan * plan)
+{
+    if (systemSize <= 0 || numSystems <= 0)
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    // distinct elements must not share an address
+    if ((systemSize > 1 && elementStride == 0) || 
+        (numSystems > 1 && systemStride == 0))
         return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
 
     //figure out which algorithm to run
     if (plan->m_config.datatype == CUDPP_FLOAT)
     {
-        // check necessary memory
-        if (crpcrSharedSize<float>(systemSize) > prop.sharedMemPerBlock)
-            return CUDPP_ERROR_INSUFFICIENT_RESOURCES;
-
-        crpcr<float>((float *)d_a, 
-                     (float *)d_b, 
-                     (float *)d_c, 
-                     (float *)d_d, 
-                     (float *)d_x, 
-                     systemSize, 
-                     numSystems);
-        return CUDPP_SUCCESS;
+        return tridiagonalDispatch<float>((float *)d_a, 
+                                          (float *)d_b, 
+                                          (float *)d_c, 
+                                          (float *)d_d, 
+                                          (float *)d_x, 
+                                          systemSize, 
+                                          numSystems,
+                                          elementStride,
+                                          systemStride,
+                                          plan);
     }
     else if (plan->m_config.datatype == CUDPP_DOUBLE)
     {
-        // check necessary memory
-        if (crpcrSharedSize<double>(systemSize) > prop.sharedMemPerBlock)
-            return CUDPP_ERROR_INSUFFICIENT_RESOURCES;
-
-        crpcr<double>((double *)d_a, 
-                      (double *)d_b, 
-                      (double *)d_c, 
-                      (double *)d_d, 
-                      (double *)d_x, 
-                      systemSize, 
-                      numSystems);
-        return CUDPP_SUCCESS;
+        return tridiagonalDispatch<double>((double *)d_a, 
+                                           (double *)d_b, 
+                                           (double *)d_c, 
+                                           (double *)d_d, 
+                                           (double *)d_x, 
+                                           systemSize, 
+                                           numSystems,
+                                           elementStride,
+                                           systemStride,
+                                           plan);
     }
     else
         return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
     
 }
 
+/**
+ * @brief Dispatches the pentadiagonal solver based on the plan
+ *
+ * @param[out] d_x Solution vector
+ * @param[in] d_e Second lower diagonal
+ * @param[in] d_a Lower diagonal
+ * @param[in] d_b Main diagonal
+ * @param[in] d_c Upper diagonal
+ * @param[in] d_f Second upper diagonal
+ * @param[in] d_d Right hand side
+ * @param[in] systemSize The size of the linear system
+ * @param[in] numSystems The number of systems to be solved
+ * @param[in] plan pointer to CUDPPTridiagonalPlan
+ * @returns CUDPPResult indicating success or error condition
+ */
+CUDPPResult cudppPentadiagonalDispatch(const void *d_e, 
+                                       const void *d_a, 
+                                       const void *d_b, 
+                                       const void *d_c, 
+                                       const void *d_f, 
+                                       const void *d_d, 
+                                       void *d_x, 
+                                       int systemSize, 
+                                       int numSystems, 
+                                       const CUDPPTridiagonalPlan * plan)
+{
+    if (systemSize <= 0 || numSystems <= 0 || 
+        (plan->m_config.options & (CUDPP_OPTION_CYCLIC | CUDPP_OPTION_HOST)))
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    if (plan->m_config.datatype == CUDPP_FLOAT)
+        return pentadiagonalDispatch<float>((const float *)d_e, (const float *)d_a, 
+                                            (const float *)d_b, (const float *)d_c, 
+                                            (const float *)d_f, (const float *)d_d, 
+                                            (float *)d_x, systemSize, numSystems, 
+                                            plan);
+    else if (plan->m_config.datatype == CUDPP_DOUBLE)
+        return pentadiagonalDispatch<double>((const double *)d_e, (const double *)d_a, 
+                                             (const double *)d_b, (const double *)d_c, 
+                                             (const double *)d_f, (const double *)d_d, 
+                                             (double *)d_x, systemSize, numSystems, 
+                                             plan);
+    else
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+}
+
+/**
+ * @brief Dispatches the block-tridiagonal solver based on the plan and 
+ * the block size
+ *
+ * @param[out] d_x Solution vectors
+ * @param[in] d_a Lower diagonal blocks
+ * @param[in] d_b Main diagonal blocks
+ * @param[in] d_c Upper diagonal blocks
+ * @param[in] d_d Right hand side vectors
+ * @param[in] blockSize The dimension of the blocks, 2 or 3
+ * @param[in] systemSize The number of block rows of each system
+ * @param[in] numSystems The number of systems to be solved
+ * @param[in] plan pointer to CUDPPTridiagonalPlan
+ * @returns CUDPPResult indicating success or error condition
+ */
+CUDPPResult cudppBlockTridiagonalDispatch(const void *d_a, 
+                                          const void *d_b, 
+                                          const void *d_c, 
+                                          const void *d_d, 
+                                          void *d_x, 
+                                          int blockSize,
+                                          int systemSize, 
+                                          int numSystems, 
+                                          const CUDPPTridiagonalPlan * plan)
+{
+    if (systemSize <= 0 || numSystems <= 0 || 
+        (plan->m_config.options & (CUDPP_OPTION_CYCLIC | CUDPP_OPTION_HOST)))
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    bool isDouble = (plan->m_config.datatype == CUDPP_DOUBLE);
+    if (!isDouble && plan->m_config.datatype != CUDPP_FLOAT)
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    switch (blockSize)
+    {
+    case 2:
+        if (isDouble)
+            return blockTridiagonalDispatch<double, 2>((const double *)d_a, (const double *)d_b, 
+                                                       (const double *)d_c, (const double *)d_d, 
+                                                       (double *)d_x, systemSize, numSystems, 
+                                                       plan);
+        else
+            return blockTridiagonalDispatch<float, 2>((const float *)d_a, (const float *)d_b, 
+                                                      (const float *)d_c, (const float *)d_d, 
+                                                      (float *)d_x, systemSize, numSystems, 
+                                                      plan);
+    case 3:
+        if (isDouble)
+            return blockTridiagonalDispatch<double, 3>((const double *)d_a, (const double *)d_b, 
+                                                       (const double *)d_c, (const double *)d_d, 
+                                                       (double *)d_x, systemSize, numSystems, 
+                                                       plan);
+        else
+            return blockTridiagonalDispatch<float, 3>((const float *)d_a, (const float *)d_b, 
+                                                      (const float *)d_c, (const float *)d_d, 
+                                                      (float *)d_x, systemSize, numSystems, 
+                                                      plan);
+    default:
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+    }
+}
+
+/**
+ * @brief Solves factored tridiagonal systems of type \a T for 
+ * \a numRHS right hand sides
+ *
+ * @param[out] d_x Solution vectors
+ * @param[in] d_d Right hand sides
+ * @param[in] numRHS The number of right hand sides
+ * @param[in] plan pointer to CUDPPTridiagonalFactorPlan
+ */
+template <typename T>
+void tridiagonalSolveFactored(const T *d_d, 
+                              T *d_x, 
+                              unsigned int numRHS, 
+                              const CUDPPTridiagonalFactorPlan *plan)
+{
+    bool interleaved = (plan->m_config.options & CUDPP_OPTION_INTERLEAVED) != 0;
+    bool isCyclic = (plan->m_config.options & CUDPP_OPTION_CYCLIC) != 0;
+    size_t elementStride = interleaved ? plan->m_numSystems : 1;
+    size_t systemStride = interleaved ? 1 : plan->m_systemSize;
+
+    dim3 grid = tridiagonalGrid((size_t)plan->m_numSystems * numRHS);
+    dim3 threads(TRIDIAGONAL_THOMAS_CTA_SIZE, 1, 1);
+    thomasSolveFactoredKernel<<< grid, threads >>>
+        (d_x, d_d, (const T*)plan->m_d_lower, (const T*)plan->m_d_inverse, 
+         (const T*)plan->m_d_upper, (const T*)plan->m_d_z, (const T*)plan->m_d_cyclic,
+         plan->m_systemSize, plan->m_numSystems, numRHS, 
+         elementStride, systemStride, plan->m_numElements, isCyclic);
+    CUDA_CHECK_ERROR("thomasSolveFactored");
+}
+
+/**
+ * @brief Dispatches the factored tridiagonal solve based on the plan
+ *
+ * @param[out] d_x Solution vectors
+ * @param[in] d_d Right hand sides
+ * @param[in] numRHS The number of right hand sides
+ * @param[in] plan pointer to CUDPPTridiagonalFactorPlan
+ * @returns CUDPPResult indicating success or error condition
+ */
+CUDPPResult cudppTridiagonalSolveFactoredDispatch(const void *d_d, 
+                                                  void *d_x, 
+                                                  int numRHS,
+                                                  const CUDPPTridiagonalFactorPlan *plan)
+{
+    if (numRHS <= 0)
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    if (plan->m_config.datatype == CUDPP_FLOAT)
+        tridiagonalSolveFactored<float>((const float*)d_d, (float*)d_x, numRHS, plan);
+    else if (plan->m_config.datatype == CUDPP_DOUBLE)
+        tridiagonalSolveFactored<double>((const double*)d_d, (double*)d_x, numRHS, plan);
+    else
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    return CUDPP_SUCCESS;
+}
+
 /** @} */ // end Tridiagonal functions
 /** @} */ // end cudpp_app
@@ -0,0 +1,428 @@
+// -------------------------------------------------------------
+// CUDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cuda_util.h"
+#include "cudpp_globals.h"
+#include "cudpp.h"
+#include "cudpp_util.h"
+#include "cudpp_plan.h"
+#include "cudpp_scan.h"
+
+#include "kernel/unique_kernel.cuh"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * @file
+ * unique_app.cu
+ *
+ * @brief CUDPP application-level unique routines
+ */
+
+/** \addtogroup cudpp_app
+ * @{
+ */
+
+/** @name Unique Functions
+ * @{
+ */
+
+/** @brief Grid of UNIQUE_CTA_SIZE threads per block for \a numItems items
+ *
+ * The kernels loop over their items, so the grid is capped at 65535 blocks.
+ */
+dim3 uniqueGrid(size_t numItems)
+{
+    size_t numBlocks = (numItems + UNIQUE_CTA_SIZE - 1) / UNIQUE_CTA_SIZE;
+    if (numBlocks > 65535)
+        numBlocks = 65535;
+    if (numBlocks < 1)
+        numBlocks = 1;
+    return dim3((unsigned int)numBlocks, 1, 1);
+}
+
+/** @brief Number of UNIQUE_ITEMS_PER_THREAD tiles of \a numElements elements */
+size_t uniqueNumTiles(size_t numElements)
+{
+    return (numElements + UNIQUE_ITEMS_PER_THREAD - 1) / UNIQUE_ITEMS_PER_THREAD;
+}
+
+/** @brief Number of hash table slots for \a numElements unsorted keys:
+ * the smallest power of two of at least twice as many slots as keys
+ */
+size_t uniqueTableSize(size_t numElements)
+{
+    size_t size = 2;
+    while (size < 2 * numElements)
+        size *= 2;
+    return size;
+}
+
+/** @brief Size in bytes of the keys of the plan's datatype */
+size_t uniqueKeySize(const CUDPPUniquePlan *plan)
+{
+    switch (plan->m_config.datatype)
+    {
+    case CUDPP_CHAR:
+    case CUDPP_UCHAR:
+        return 1;
+    case CUDPP_SHORT:
+    case CUDPP_USHORT:
+        return 2;
+    case CUDPP_DOUBLE:
+    case CUDPP_LONGLONG:
+    case CUDPP_ULONGLONG:
+        return 8;
+    default:
+        return 4;
+    }
+}
+
+/** @brief Unique on the host
+ *
+ * Unsorted keys are first inserted into the plan's hash table by all
+ * OpenMP threads.  The elements are then split into one chunk per
+ * thread, and each chunk writes its kept elements to the front of its
+ * own range of the output in a single pass.  A chunk only writes at or
+ * before the elements it has read, so the output may be the input.  The
+ * chunks are then moved together in order.
+ *
+ * @param[out] keysOut Kept keys (may be \a keys)
+ * @param[out] valuesOut Values of the kept keys (may be \a values or NULL)
+ * @param[in] keys Keys
+ * @param[in] values Values, or NULL
+ * @param[in] numElements Number of elements
+ * @param[in] plan Pointer to CUDPPUniquePlan object
+ * @returns Number of kept elements
+ */
+template <typename K, bool isSorted>
+size_t uniqueHost(K                       *keysOut,
+                  unsigned int            *valuesOut,
+                  const K                 *keys,
+                  const unsigned int      *values,
+                  size_t                  numElements,
+                  const CUDPPUniquePlan   *plan)
+{
+    if (numElements == 0)
+        return 0;
+
+    int numChunks = 1;
+#ifdef _OPENMP
+    numChunks = omp_get_max_threads();
+#endif
+    if ((size_t)numChunks > numElements / UNIQUE_HOST_MIN_CHUNK + 1)
+        numChunks = (int)(numElements / UNIQUE_HOST_MIN_CHUNK + 1);
+    size_t chunkSize = (numElements + numChunks - 1) / numChunks;
+
+    size_t mask = plan->m_tableSize - 1;
+    if (!isSorted)
+    {
+        memset(plan->m_d_table, 0, plan->m_tableSize * sizeof(unsigned long long));
+#pragma omp parallel for num_threads(numChunks)
+        for (long long i = 0; i < (long long)numElements; ++i)
+            uniqueInsert(plan->m_d_table, mask, (unsigned int)keys[i], (size_t)i);
+    }
+
+    size_t *counts = (size_t*) malloc(numChunks * sizeof(size_t));
+    K      *prevKeys = (K*) malloc(numChunks * sizeof(K));
+
+    // The key before each chunk, read before any chunk writes in place
+    prevKeys[0] = keys[0];
+    for (int c = 1; c < numChunks; ++c)
+        prevKeys[c] = keys[c * chunkSize - 1];
+
+#pragma omp parallel for num_threads(numChunks)
+    for (int c = 0; c < numChunks; ++c)
+    {
+        size_t begin = c * chunkSize;
+        size_t end = (begin + chunkSize < numElements) ? begin + chunkSize : numElements;
+        size_t out = begin;
+        K prev = prevKeys[c];
+
+        for (size_t i = begin; i < end; ++i)
+        {
+            K k = keys[i];
+            bool keep = isSorted ?
+                ((i == 0) || (k != prev)) :
+                (uniqueFirstIndex(plan->m_d_table, mask, (unsigned int)k) == i);
+            prev = k;
+            if (!keep)
+                continue;
+            keysOut[out] = k;
+            if (valuesOut != NULL)
+                valuesOut[out] = values[i];
+            ++out;
+        }
+        counts[c] = out - begin;
+    }
+
+    // Move the kept elements of each chunk after those of the chunks before
+    size_t numUnique = counts[0];
+    for (int c = 1; c < numChunks; ++c)
+    {
+        size_t begin = c * chunkSize;
+        memmove(keysOut + numUnique, keysOut + begin, counts[c] * sizeof(K));
+        if (valuesOut != NULL)
+            memmove(valuesOut + numUnique, valuesOut + begin, counts[c] * sizeof(unsigned int));
+        numUnique += counts[c];
+    }
+
+    free(counts);
+    free(prevKeys);
+    return numUnique;
+}
+
+/** @brief Write the elements kept by \a keep in order on the GPU
+ *
+ * The kept elements of each tile are counted, the counts are scanned and
+ * each tile writes its kept elements at their ranks.
+ */
+template <typename K, class Pred>
+void uniqueCompact(K                       *d_keysOut,
+                   unsigned int            *d_valuesOut,
+                   const K                 *d_keys,
+                   const unsigned int      *d_values,
+                   Pred                    keep,
+                   size_t                  numElements,
+                   const CUDPPUniquePlan   *plan)
+{
+    size_t numTiles = uniqueNumTiles(numElements);
+
+    unique_tile_count<<< uniqueGrid(numTiles), UNIQUE_CTA_SIZE >>>
+        (plan->m_d_tileCount, keep, numElements, numTiles);
+    CUDA_CHECK_ERROR("unique_tile_count");
+
+    cudppScanDispatch(plan->m_d_tileOffset, plan->m_d_tileCount, numTiles, 1,
+                      plan->m_scanPlan);
+
+    unique_tile_scatter<<< uniqueGrid(numTiles), UNIQUE_CTA_SIZE >>>
+        (d_keysOut, d_valuesOut, d_keys, d_values, plan->m_d_tileOffset, keep,
+         numElements, numTiles);
+    CUDA_CHECK_ERROR("unique_tile_scatter");
+}
+
+/** @brief Unique on the GPU
+ *
+ * Unsorted keys are first inserted into the plan's hash table with
+ * unique_insert().  unique_tile_count() counts the kept elements of every
+ * tile, the counts are scanned to give the rank of the first kept element
+ * of each tile, and unique_tile_scatter() writes the kept elements.  When
+ * the output is the input, the kept elements are written to the plan's
+ * temporary arrays and copied back.  Plans with CUDPP_OPTION_HOST call
+ * uniqueHost().
+ *
+ * @param[out] d_keysOut Kept keys (may be \a d_keys)
+ * @param[out] d_valuesOut Values of the kept keys (may be \a d_values or NULL)
+ * @param[in] d_keys Keys
+ * @param[in] d_values Values, or NULL
+ * @param[in] numElements Number of elements
+ * @param[in] plan Pointer to CUDPPUniquePlan object
+ * @returns Number of kept elements
+ */
+template <typename K, bool isSorted>
+size_t uniqueKeys(K                       *d_keysOut,
+                   unsigned int            *d_valuesOut,
+                   const K                 *d_keys,
+                   const unsigned int      *d_values,
+                   size_t                  numElements,
+                   const CUDPPUniquePlan   *plan)
+{
+    if (plan->m_config.options & CUDPP_OPTION_HOST)
+        return uniqueHost<K, isSorted>(d_keysOut, d_valuesOut, d_keys, d_values,
+                                       numElements, plan);
+
+    if (numElements == 0)
+        return 0;
+
+    size_t numTiles = uniqueNumTiles(numElements);
+    size_t mask = plan->m_tableSize - 1;
+
+    if (!isSorted)
+    {
+        CUDA_SAFE_CALL(cudaMemset(plan->m_d_table, 0,
+                                  plan->m_tableSize * sizeof(unsigned long long)));
+        unique_insert<K><<< uniqueGrid(numElements), UNIQUE_CTA_SIZE >>>
+            (plan->m_d_table, mask, d_keys, numElements);
+        CUDA_CHECK_ERROR("unique_insert");
+    }
+
+    bool inPlace = ((const void*)d_keysOut == (const void*)d_keys) ||
+                   (d_valuesOut != NULL && d_valuesOut == d_values);
+    K *d_keysDest = inPlace ? (K*)plan->m_d_tempKeys : d_keysOut;
+    unsigned int *d_valuesDest =
+        (inPlace && d_valuesOut != NULL) ? plan->m_d_tempValues : d_valuesOut;
+
+    if (isSorted)
+        uniqueCompact(d_keysDest, d_valuesDest, d_keys, d_values,
+                      UniqueSortedHead<K>(d_keys), numElements, plan);
+    else
+        uniqueCompact(d_keysDest, d_valuesDest, d_keys, d_values,
+                      UniqueFirstOccurrence<K>(d_keys, plan->m_d_table, mask),
+                      numElements, plan);
+
+    unsigned int lastOffset, lastCount;
+    CUDA_SAFE_CALL(cudaMemcpy(&lastOffset, plan->m_d_tileOffset + numTiles - 1,
+                              sizeof(unsigned int), cudaMemcpyDeviceToHost));
+    CUDA_SAFE_CALL(cudaMemcpy(&lastCount, plan->m_d_tileCount + numTiles - 1,
+                              sizeof(unsigned int), cudaMemcpyDeviceToHost));
+    size_t numUnique = (size_t)lastOffset + lastCount;
+
+    if (inPlace)
+    {
+        CUDA_SAFE_CALL(cudaMemcpy(d_keysOut, d_keysDest, numUnique * sizeof(K),
+                                  cudaMemcpyDeviceToDevice));
+        if (d_valuesOut != NULL)
+            CUDA_SAFE_CALL(cudaMemcpy(d_valuesOut, d_valuesDest,
+                                      numUnique * sizeof(unsigned int),
+                                      cudaMemcpyDeviceToDevice));
+    }
+    return numUnique;
+}
+
+/** @brief Dispatch a unique of keys of type \a K, which are compared bit
+ * for bit, on sorted or unsorted input
+ */
+template <typename K>
+size_t uniqueDispatchOrder(void                    *d_keysOut,
+                           unsigned int            *d_valuesOut,
+                           const void              *d_keys,
+                           const unsigned int      *d_values,
+                           size_t                  numElements,
+                           const CUDPPUniquePlan   *plan)
+{
+    if (plan->m_config.options & CUDPP_OPTION_UNSORTED)
+        return uniqueKeys<K, false>((K*)d_keysOut, d_valuesOut, (const K*)d_keys, d_values,
+                                numElements, plan);
+    else
+        return uniqueKeys<K, true>((K*)d_keysOut, d_valuesOut, (const K*)d_keys, d_values,
+                               numElements, plan);
+}
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @brief Allocate intermediate arrays used by unique.
+ *
+ * On the GPU the plan holds the count and offset of every tile of
+ * UNIQUE_ITEMS_PER_THREAD elements and temporary key and value arrays for
+ * in-place calls.  Plans with CUDPP_OPTION_UNSORTED also hold the hash
+ * table, in host memory for the host backend.
+ *
+ * @param[in,out] plan Pointer to CUDPPUniquePlan object
+ */
+void allocUniqueStorage(CUDPPUniquePlan *plan)
+{
+    size_t numElements = plan->m_numElements;
+    bool isHost = (plan->m_config.options & CUDPP_OPTION_HOST) != 0;
+
+    if (plan->m_config.options & CUDPP_OPTION_UNSORTED)
+    {
+        plan->m_tableSize = uniqueTableSize(numElements);
+        size_t tableBytes = plan->m_tableSize * sizeof(unsigned long long);
+        if (isHost)
+            plan->m_d_table = (unsigned long long*) malloc(tableBytes);
+        else
+            CUDA_SAFE_CALL(cudaMalloc((void**)&plan->m_d_table, tableBytes));
+    }
+
+    if (isHost)
+        return;
+
+    size_t numTiles = uniqueNumTiles(numElements);
+    if (numTiles < 1)
+        numTiles = 1;
+    if (numElements < 1)
+        numElements = 1;
+
+    CUDA_SAFE_CALL(cudaMalloc((void**)&plan->m_d_tileCount, numTiles * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&plan->m_d_tileOffset, numTiles * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc(&plan->m_d_tempKeys, numElements * uniqueKeySize(plan)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&plan->m_d_tempValues, numElements * sizeof(unsigned int)));
+}
+
+/** @brief Deallocate intermediate arrays in a CUDPPUniquePlan object.
+ *
+ * @param[in,out] plan Pointer to CUDPPUniquePlan object initialized by allocUniqueStorage().
+ */
+void freeUniqueStorage(CUDPPUniquePlan *plan)
+{
+    bool isHost = (plan->m_config.options & CUDPP_OPTION_HOST) != 0;
+
+    if (plan->m_config.options & CUDPP_OPTION_UNSORTED)
+    {
+        if (isHost)
+            free(plan->m_d_table);
+        else
+            CUDA_SAFE_CALL(cudaFree(plan->m_d_table));
+    }
+
+    if (isHost)
+        return;
+
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_tileCount));
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_tileOffset));
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_tempKeys));
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_tempValues));
+}
+
+/** @brief Dispatch function for unique.
+ *
+ * This is the app-level interface used by cudppUnique().  Keys of the
+ * plan's datatype are compared by their bits, so unique is only
+ * instantiated once per key size.
+ *
+ * @param[in] plan Pointer to CUDPPUniquePlan object
+ * @param[out] d_keysOut Kept keys (may be \a d_keys)
+ * @param[out] d_valuesOut Values of the kept keys (may be \a d_values or NULL)
+ * @param[in] d_keys Keys
+ * @param[in] d_values Values, or NULL
+ * @param[in] numElements Number of elements
+ * @returns Number of kept elements
+ */
+size_t cudppUniqueDispatch(const CUDPPUniquePlan  *plan,
+                           void                   *d_keysOut,
+                           unsigned int           *d_valuesOut,
+                           const void             *d_keys,
+                           const unsigned int     *d_values,
+                           size_t                 numElements)
+{
+    switch (uniqueKeySize(plan))
+    {
+    case 1:
+        return uniqueDispatchOrder<unsigned char>(d_keysOut, d_valuesOut, d_keys,
+                                                  d_values, numElements, plan);
+    case 2:
+        return uniqueDispatchOrder<unsigned short>(d_keysOut, d_valuesOut, d_keys,
+                                                   d_values, numElements, plan);
+    case 8:
+        // hash-based unique takes keys of up to 32 bits (see validateOptions())
+        return uniqueKeys<unsigned long long, true>((unsigned long long*)d_keysOut, d_valuesOut,
+                                                (const unsigned long long*)d_keys, d_values,
+                                                numElements, plan);
+    default:
+        return uniqueDispatchOrder<unsigned int>(d_keysOut, d_valuesOut, d_keys,
+                                                 d_values, numElements, plan);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} */ // end unique functions
+/** @} */ // end cudpp_app
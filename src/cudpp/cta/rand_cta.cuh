@@ -373,5 +373,408 @@ __device__ void setupInput(unsigned int * input, unsigned int seed)
 
 //-------------------END MD5 FUNCTIONS--------------------------------------
 
+//------------COUNTER-BASED (PHILOX / THREEFRY) FUNCTIONS-------------------
+
+/**
+ * @brief Computes the high and low 32 bits of the 64-bit product \a a * \a b
+ *
+ *  @param[in] a first factor
+ *  @param[in] b second factor
+ *  @param[out] hi the high 32 bits of the product
+ *  @returns the low 32 bits of the product
+ **/
+__device__ __forceinline__ 
+unsigned int mulhilo32(unsigned int a, unsigned int b, unsigned int *hi)
+{
+    *hi = __umulhi(a, b);
+    return a * b;
+}
+
+/**
+ * @brief One round of the Philox4x32 bijection.
+ *
+ *  For more information see: <a
+ *  href="http://dx.doi.org/10.1145/2063384.2063405">Parallel random
+ *  numbers: as easy as 1, 2, 3</a> (Salmon et al., SC 2011).
+ *
+ *  @param[in] ctr the current 128-bit state
+ *  @param[in] key the current round key
+ *  @returns the state after one round
+ **/
+__device__ __forceinline__ uint4 philoxRound(uint4 ctr, uint2 key)
+{
+    unsigned int hi0, hi1;
+    unsigned int lo0 = mulhilo32(PHILOX_M4x32_0, ctr.x, &hi0);
+    unsigned int lo1 = mulhilo32(PHILOX_M4x32_1, ctr.z, &hi1);
+    return make_uint4(hi1 ^ ctr.y ^ key.x, lo1, hi0 ^ ctr.w ^ key.y, lo0);
+}
+
+/**
+ * @brief The Philox4x32-10 counter-based generator.
+ *
+ *  Maps the 128-bit counter \a ctr under the 64-bit key \a key to 128
+ *  random bits.  Since the output depends only on (\a ctr, \a key), any 
+ *  position of the sequence can be generated independently, which is what
+ *  makes O(1) skip-ahead possible.
+ *
+ *  @param[in] ctr the counter
+ *  @param[in] key the key
+ *  @returns 128 random bits
+ *
+ *  @see threefry4x32()
+ **/
+__device__ uint4 philox4x32(uint4 ctr, uint2 key)
+{
+#pragma unroll
+    for (int r = 0; r < PHILOX_ROUNDS - 1; r++)
+    {
+        ctr = philoxRound(ctr, key);
+        key.x += PHILOX_W32_0;
+        key.y += PHILOX_W32_1;
+    }
+    return philoxRound(ctr, key);
+}
+
+/**
+ * @brief Rotates the bits in \a x left by \a n bits (0 < \a n < 32)
+ **/
+__device__ __forceinline__ unsigned int rotl32(unsigned int x, unsigned int n)
+{
+    return (x << n) | (x >> (32 - n));
+}
+
+/**
+ * @brief The Threefry4x32-20 counter-based generator.
+ *
+ *  Threefry is the Threefish block cipher with a reduced number of rounds 
+ *  and no tweak. It only needs adds, rotates and xors, so it is a good fit 
+ *  for devices with slow integer multiplication.  The 128-bit key is 
+ *  (\a key.x, \a key.y, 0, 0).
+ *
+ *  For more information see: <a
+ *  href="http://dx.doi.org/10.1145/2063384.2063405">Parallel random
+ *  numbers: as easy as 1, 2, 3</a> (Salmon et al., SC 2011).
+ *
+ *  @param[in] ctr the counter
+ *  @param[in] key the key
+ *  @returns 128 random bits
+ *
+ *  @see philox4x32()
+ **/
+__device__ uint4 threefry4x32(uint4 ctr, uint2 key)
+{
+    const unsigned int rot[8][2] = { {10, 26}, {11, 21}, {13, 27}, {23,  5},
+                                     { 6, 20}, {17, 11}, {25, 10}, {18, 20} };
+    unsigned int ks[5];
+    ks[0] = key.x;
+    ks[1] = key.y;
+    ks[2] = 0;
+    ks[3] = 0;
+    ks[4] = THREEFRY_PARITY32 ^ ks[0] ^ ks[1] ^ ks[2] ^ ks[3];
+
+    unsigned int x0 = ctr.x + ks[0];
+    unsigned int x1 = ctr.y + ks[1];
+    unsigned int x2 = ctr.z + ks[2];
+    unsigned int x3 = ctr.w + ks[3];
+
+#pragma unroll
+    for (int r = 0; r < THREEFRY_ROUNDS; r++)
+    {
+        if ((r & 1) == 0)
+        {
+            x0 += x1; x1 = rotl32(x1, rot[r & 7][0]); x1 ^= x0;
+            x2 += x3; x3 = rotl32(x3, rot[r & 7][1]); x3 ^= x2;
+        }
+        else
+        {
+            x0 += x3; x3 = rotl32(x3, rot[r & 7][0]); x3 ^= x0;
+            x2 += x1; x1 = rotl32(x1, rot[r & 7][1]); x1 ^= x2;
+        }
+
+        // key injection every four rounds
+        if ((r & 3) == 3)
+        {
+            unsigned int s = (r + 1) >> 2;
+            x0 += ks[s % 5];
+            x1 += ks[(s + 1) % 5];
+            x2 += ks[(s + 2) % 5];
+            x3 += ks[(s + 3) % 5] + s;
+        }
+    }
+    return make_uint4(x0, x1, x2, x3);
+}
+
+/**
+ * @brief Generates the 128 random bits of counter block \a block.
+ *
+ * The 64-bit block index is the low half of the 128-bit counter.  The 
+ * upper half is zero for the main sequence; it is used to address extra
+ * random words (e.g. for rejection sampling) that never collide with it.
+ *
+ * @param[in] block index of the counter block
+ * @param[in] key the generator key, (seed, stream)
+ * @param[in] hi upper half of the counter
+ * @returns 128 random bits
+ *
+ * @tparam alg CUDPP_RAND_PHILOX or CUDPP_RAND_THREEFRY
+ */
+template <CUDPPAlgorithm alg>
+__device__ uint4 counterRandBlock(unsigned long long block, uint2 key,
+                                  uint2 hi = make_uint2(0, 0))
+{
+    uint4 ctr = make_uint4((unsigned int)block, (unsigned int)(block >> 32), 
+                           hi.x, hi.y);
+    if (alg == CUDPP_RAND_PHILOX)
+        return philox4x32(ctr, key);
+    else
+        return threefry4x32(ctr, key);
+}
+
+//-------------------END COUNTER-BASED FUNCTIONS----------------------------
+
+//------------RANDOM DISTRIBUTION TRANSFORMS--------------------------------
+
+/**
+ * @brief Maps 32 random bits to a float uniformly distributed in [0, 1)
+ **/
+__device__ __forceinline__ float uintToUniformFloat(unsigned int x)
+{
+    return (x >> 8) * (1.0f / 16777216.0f);
+}
+
+/**
+ * @brief Maps 32 random bits to a float uniformly distributed in (0, 1]
+ **/
+__device__ __forceinline__ float uintToUniformFloatOpen(unsigned int x)
+{
+    return ((x >> 8) + 1) * (1.0f / 16777216.0f);
+}
+
+/**
+ * @brief Maps 64 random bits to a double uniformly distributed in [0, 1)
+ **/
+__device__ __forceinline__ double uintToUniformDouble(unsigned int a, 
+                                                      unsigned int b)
+{
+    return ((a >> 5) * 67108864.0 + (b >> 6)) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * @brief Maps 64 random bits to a double uniformly distributed in (0, 1]
+ **/
+__device__ __forceinline__ double uintToUniformDoubleOpen(unsigned int a, 
+                                                          unsigned int b)
+{
+    return ((a >> 5) * 67108864.0 + (b >> 6) + 1.0) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * @brief Distribution transform that passes the raw random bits through.
+ *
+ * A distribution transform turns the 128 bits of one counter block into
+ * \a valuesPerBlock output values of type \a T, packed in the 16-byte 
+ * vector type \a V.  See gen_randCounter().
+ **/
+struct RandBitsTransform
+{
+    typedef unsigned int T;  //!< output type
+    typedef uint4 V;         //!< output values of one counter block
+    static const int valuesPerBlock = 4; //!< values per counter block
+
+    /** @brief Transforms the random bits \a r of counter block \a block */
+    template <CUDPPAlgorithm alg>
+    __device__ V apply(uint4 r, unsigned long long /*block*/, 
+                       uint2 /*key*/) const
+    {
+        return r;
+    }
+};
+
+/**
+ * @brief Distribution transform to unsigned ints uniformly distributed in
+ * [\a low, \a low + \a range) without bias.
+ *
+ * Uses Lemire's multiply-shift method: the high word of x * \a range is 
+ * uniform in [0, \a range) unless the low word falls below 
+ * \a threshold = 2^32 mod \a range, in which case x is rejected and 
+ * redrawn.  Redraws come from the same counter block with a nonzero upper
+ * counter half (lane, attempt), so they never overlap the main sequence 
+ * and the result still depends only on the position in the sequence.
+ *
+ * For more information see: Daniel Lemire, "Fast Random Integer 
+ * Generation in an Interval", ACM TOMACS 29(1), 2019.
+ **/
+struct RandBoundedIntTransform
+{
+    typedef unsigned int T;  //!< output type
+    typedef uint4 V;         //!< output values of one counter block
+    static const int valuesPerBlock = 4; //!< values per counter block
+
+    unsigned int low;        //!< lower bound (inclusive)
+    unsigned int range;      //!< number of possible values, 0 < range < 2^32
+    unsigned int threshold;  //!< 2^32 mod range
+
+    /** @brief Maps one random word \a x to [low, low + range) */
+    template <CUDPPAlgorithm alg>
+    __device__ unsigned int bound(unsigned int x, unsigned int lane,
+                                  unsigned long long block, uint2 key) const
+    {
+        unsigned long long m = (unsigned long long)x * range;
+        unsigned int attempt = 0;
+        while ((unsigned int)m < threshold)
+        {
+            x = counterRandBlock<alg>(block, key, 
+                                      make_uint2(lane + 1, attempt++)).x;
+            m = (unsigned long long)x * range;
+        }
+        return low + (unsigned int)(m >> 32);
+    }
+
+    /** @brief Transforms the random bits \a r of counter block \a block */
+    template <CUDPPAlgorithm alg>
+    __device__ V apply(uint4 r, unsigned long long block, uint2 key) const
+    {
+        return make_uint4(bound<alg>(r.x, 0, block, key),
+                          bound<alg>(r.y, 1, block, key),
+                          bound<alg>(r.z, 2, block, key),
+                          bound<alg>(r.w, 3, block, key));
+    }
+};
+
+/**
+ * @brief Distribution transform to values uniformly distributed in [0, 1)
+ **/
+template <typename T> struct RandUniformTransform;
+
+/** @brief RandUniformTransform for float: 24 random bits per value */
+template <> struct RandUniformTransform<float>
+{
+    typedef float T;         //!< output type
+    typedef float4 V;        //!< output values of one counter block
+    static const int valuesPerBlock = 4; //!< values per counter block
+
+    /** @brief Transforms the random bits \a r of counter block \a block */
+    template <CUDPPAlgorithm alg>
+    __device__ V apply(uint4 r, unsigned long long, uint2) const
+    {
+        return make_float4(uintToUniformFloat(r.x), uintToUniformFloat(r.y),
+                           uintToUniformFloat(r.z), uintToUniformFloat(r.w));
+    }
+};
+
+/** @brief RandUniformTransform for double: 53 random bits per value */
+template <> struct RandUniformTransform<double>
+{
+    typedef double T;        //!< output type
+    typedef double2 V;       //!< output values of one counter block
+    static const int valuesPerBlock = 2; //!< values per counter block
+
+    /** @brief Transforms the random bits \a r of counter block \a block */
+    template <CUDPPAlgorithm alg>
+    __device__ V apply(uint4 r, unsigned long long, uint2) const
+    {
+        return make_double2(uintToUniformDouble(r.x, r.y),
+                            uintToUniformDouble(r.z, r.w));
+    }
+};
+
+/**
+ * @brief Distribution transform to normally distributed values with the 
+ * given \a mean and standard deviation \a stddev, using the Box-Muller 
+ * transform on pairs of uniform values.
+ **/
+template <typename T> struct RandNormalTransform;
+
+/** @brief RandNormalTransform for float */
+template <> struct RandNormalTransform<float>
+{
+    typedef float T;         //!< output type
+    typedef float4 V;        //!< output values of one counter block
+    static const int valuesPerBlock = 4; //!< values per counter block
+
+    float mean;              //!< mean of the distribution
+    float stddev;            //!< standard deviation of the distribution
+
+    /** @brief Transforms the random bits \a r of counter block \a block */
+    template <CUDPPAlgorithm alg>
+    __device__ V apply(uint4 r, unsigned long long, uint2) const
+    {
+        float s0, c0, s1, c1;
+        float r0 = sqrtf(-2.0f * logf(uintToUniformFloatOpen(r.x)));
+        float r1 = sqrtf(-2.0f * logf(uintToUniformFloatOpen(r.z)));
+        sincosf(6.2831853f * uintToUniformFloat(r.y), &s0, &c0);
+        sincosf(6.2831853f * uintToUniformFloat(r.w), &s1, &c1);
+        return make_float4(mean + stddev * r0 * c0, mean + stddev * r0 * s0,
+                           mean + stddev * r1 * c1, mean + stddev * r1 * s1);
+    }
+};
+
+/** @brief RandNormalTransform for double */
+template <> struct RandNormalTransform<double>
+{
+    typedef double T;        //!< output type
+    typedef double2 V;       //!< output values of one counter block
+    static const int valuesPerBlock = 2; //!< values per counter block
+
+    double mean;             //!< mean of the distribution
+    double stddev;           //!< standard deviation of the distribution
+
+    /** @brief Transforms the random bits \a r of counter block \a block */
+    template <CUDPPAlgorithm alg>
+    __device__ V apply(uint4 r, unsigned long long, uint2) const
+    {
+        double s, c;
+        double rad = sqrt(-2.0 * log(uintToUniformDoubleOpen(r.x, r.y)));
+        sincos(6.283185307179586 * uintToUniformDouble(r.z, r.w), &s, &c);
+        return make_double2(mean + stddev * rad * c, mean + stddev * rad * s);
+    }
+};
+
+/**
+ * @brief Distribution transform to exponentially distributed values with 
+ * rate \a lambda, by inversion: -log(u) / \a lambda with u in (0, 1].
+ **/
+template <typename T> struct RandExponentialTransform;
+
+/** @brief RandExponentialTransform for float */
+template <> struct RandExponentialTransform<float>
+{
+    typedef float T;         //!< output type
+    typedef float4 V;        //!< output values of one counter block
+    static const int valuesPerBlock = 4; //!< values per counter block
+
+    float lambda;            //!< rate of the distribution
+
+    /** @brief Transforms the random bits \a r of counter block \a block */
+    template <CUDPPAlgorithm alg>
+    __device__ V apply(uint4 r, unsigned long long, uint2) const
+    {
+        return make_float4(-logf(uintToUniformFloatOpen(r.x)) / lambda,
+                           -logf(uintToUniformFloatOpen(r.y)) / lambda,
+                           -logf(uintToUniformFloatOpen(r.z)) / lambda,
+                           -logf(uintToUniformFloatOpen(r.w)) / lambda);
+    }
+};
+
+/** @brief RandExponentialTransform for double */
+template <> struct RandExponentialTransform<double>
+{
+    typedef double T;        //!< output type
+    typedef double2 V;       //!< output values of one counter block
+    static const int valuesPerBlock = 2; //!< values per counter block
+
+    double lambda;           //!< rate of the distribution
+
+    /** @brief Transforms the random bits \a r of counter block \a block */
+    template <CUDPPAlgorithm alg>
+    __device__ V apply(uint4 r, unsigned long long, uint2) const
+    {
+        return make_double2(-log(uintToUniformDoubleOpen(r.x, r.y)) / lambda,
+                            -log(uintToUniformDoubleOpen(r.z, r.w)) / lambda);
+    }
+};
+
+//-------------------END RANDOM DISTRIBUTION TRANSFORMS---------------------
+
 /** @} */ // end rand functions
 /** @} */ // end cudpp_cta
@@ -49,11 +49,19 @@
 #include "cudpp_mergesort.h"
 #include "cudpp_radixsort.h"
 #include "cudpp_rand.h"
+#include "cudpp_shuffle.h"
 #include "cudpp_reduce.h"
 #include "cudpp_stringsort.h"
 #include "cudpp_tridiagonal.h"
 #include "cudpp_compress.h"
 #include "cudpp_listrank.h"
+#include "cudpp_tree.h"
+#include "cudpp_components.h"
+#include "cudpp_bfs.h"
+#include "cudpp_reduce_by_key.h"
+#include "cudpp_unique.h"
+
+#include <limits.h>
 
 /**
  * @brief Performs a scan operation of numElements on its input in
@@ -473,18 +481,29 @@ CUDPPResult cudppStringSort(const CUDPPHandle planHandle,
         return CUDPP_ERROR_INVALID_HANDLE;
 }
 
-/** @brief Perform matrix-vector multiply y = A*x for arbitrary sparse matrix A and vector x
+/** @brief Perform matrix-vector multiply y = y + A*x for arbitrary sparse matrix A and vector x
   *
   * Given a matrix object handle (which has been initialized using cudppSparseMatrix()),
   * This function multiplies the input vector \a d_x by the matrix referred to by
-  * \a sparseMatrixHandle, returning the result in \a d_y.
+  * \a sparseMatrixHandle and adds the result to \a d_y, so \a d_y must be 
+  * initialized (e.g. to zero) before the call.
+  *
+  * The kernel depends on the storage format of the matrix (see 
+  * cudppSparseMatrix()).  For CSR, work is partitioned evenly over rows plus
+  * nonzeros (merge-path), so matrices with very long or empty rows run as 
+  * efficiently as regular ones.  For a matrix created with CUDPP_OPTION_HOST,
+  * \a d_y and \a d_x are in host memory and the multiply runs on OpenMP 
+  * threads.
   *
   * @param sparseMatrixHandle Handle to a sparse matrix object created with cudppSparseMatrix()
   * @param d_y The output vector, y
   * @param d_x The input vector, x
   * @returns CUDPPResult indicating success or error condition 
   * 
-  * @see cudppSparseMatrix, cudppDestroySparseMatrix
+  * cudppSparseMatrixDenseMultiply() computes the general form 
+  * y = alpha * A * x + beta * y, also for several vectors at once.
+  *
+  * @see cudppSparseMatrix, cudppDestroySparseMatrix, cudppSparseMatrixDenseMultiply
   */
 CUDPP_DLL
 CUDPPResult cudppSparseMatrixVectorMultiply(const CUDPPHandle  sparseMatrixHandle,
@@ -500,7 +519,303 @@ CUDPPResult cudppSparseMatrixVectorMultiply(const CUDPPHandle  sparseMatrixHandl
         if (plan->m_config.algorithm != CUDPP_SPMVMULT)
             return CUDPP_ERROR_INVALID_PLAN;
         
-        cudppSparseMatrixVectorMultiplyDispatch(d_y, d_x, plan);
+        cudppSparseMatrixVectorMultiplyDispatch(d_y, d_x, 1, 0, 0, NULL, NULL, plan);
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/** @brief Perform Y = alpha * A * X + beta * Y for a sparse matrix A and a block of dense vectors X
+  *
+  * Multiplies the \a numVectors vectors of \a d_x by the matrix referred to
+  * by \a sparseMatrixHandle (created with cudppSparseMatrix()), scales the 
+  * product by \a alpha and adds it to \a beta times \a d_y.  Vector v of 
+  * \a d_x starts at element v * \a xPitch and has one element per column 
+  * of A; vector v of \a d_y starts at element v * \a yPitch and has one 
+  * element per row.  With \a numVectors of 1 this is the BLAS-style 
+  * sparse matrix-vector multiply.
+  *
+  * \a alpha and \a beta are host pointers to scalars of the matrix 
+  * datatype.  If \a beta is zero, \a d_y is not read, so it need not be
+  * initialized.  The matrix is read once for every 
+  * four vectors, so multiplying a block of vectors in one call is faster 
+  * than one call per vector.
+  *
+  * Example: one step of a block Krylov solver, R = B - A * X, computed in 
+  * place in R after copying B to R:
+  * \code
+  * double minusOne = -1.0, one = 1.0;
+  * cudppSparseMatrixDenseMultiply(matrix, d_R, d_X, 4, n, n, &minusOne, &one);
+  * \endcode
+  *
+  * @param[in] sparseMatrixHandle Handle to a sparse matrix object created with cudppSparseMatrix()
+  * @param[in,out] d_y The output vectors, Y
+  * @param[in] d_x The input vectors, X
+  * @param[in] numVectors The number of vectors in X and Y
+  * @param[in] yPitch The distance in elements between vectors of Y 
+  *                   (at least the number of rows if \a numVectors > 1)
+  * @param[in] xPitch The distance in elements between vectors of X 
+  *                   (at least the number of columns if \a numVectors > 1)
+  * @param[in] alpha Host pointer to the scale of A * X
+  * @param[in] beta Host pointer to the scale of Y
+  * @returns CUDPPResult indicating success or error condition 
+  * 
+  * @see cudppSparseMatrix, cudppSparseMatrixVectorMultiply
+  */
+CUDPP_DLL
+CUDPPResult cudppSparseMatrixDenseMultiply(const CUDPPHandle sparseMatrixHandle,
+                                           void              *d_y,
+                                           const void        *d_x,
+                                           size_t            numVectors,
+                                           size_t            yPitch,
+                                           size_t            xPitch,
+                                           const void        *alpha,
+                                           const void        *beta)
+{
+    CUDPPSparseMatrixVectorMultiplyPlan *plan = 
+        (CUDPPSparseMatrixVectorMultiplyPlan*)
+        getPlanPtrFromHandle<CUDPPSparseMatrixVectorMultiplyPlan>(sparseMatrixHandle);
+    
+    if (plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_SPMVMULT)
+            return CUDPP_ERROR_INVALID_PLAN;
+
+        if (alpha == NULL || beta == NULL || numVectors < 1 ||
+            (numVectors > 1 && (yPitch < plan->m_numRows || xPitch < plan->m_numCols)))
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        
+        cudppSparseMatrixVectorMultiplyDispatch(d_y, d_x, numVectors, yPitch, xPitch,
+                                                alpha, beta, plan);
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/** @brief Perform Y = alpha * A^T * X + beta * Y for a sparse matrix A and a block of dense vectors X
+  *
+  * The transposed counterpart of cudppSparseMatrixDenseMultiply(), on the
+  * same matrix handle, for solvers such as BiCG that need both A * x and
+  * A^T * x.  Vector v of \a d_x starts at element v * \a xPitch and has one 
+  * element per row of A; vector v of \a d_y starts at element v * \a yPitch
+  * and has one element per column of A, where the number of columns is the 
+  * largest column index plus one.
+  *
+  * The first call builds the transpose of A on the GPU in its own storage
+  * format (chosen as for A, or the format requested when the matrix was 
+  * created) and caches it with the matrix, so later calls cost the same as
+  * cudppSparseMatrixDenseMultiply() and need no atomic operations.  The 
+  * transpose takes as much GPU memory as A; it is freed with the matrix by
+  * cudppDestroySparseMatrix() and kept current by cudppSparseMatrixUpdateValues().
+  * Matrices in host memory (CUDPP_OPTION_HOST) are not supported.
+  *
+  * @param[in] sparseMatrixHandle Handle to a sparse matrix object created with cudppSparseMatrix()
+  * @param[in,out] d_y The output vectors, Y
+  * @param[in] d_x The input vectors, X
+  * @param[in] numVectors The number of vectors in X and Y
+  * @param[in] yPitch The distance in elements between vectors of Y 
+  *                   (at least the number of columns if \a numVectors > 1)
+  * @param[in] xPitch The distance in elements between vectors of X 
+  *                   (at least the number of rows if \a numVectors > 1)
+  * @param[in] alpha Host pointer to the scale of A^T * X
+  * @param[in] beta Host pointer to the scale of Y
+  * @returns CUDPPResult indicating success or error condition 
+  * 
+  * @see cudppSparseMatrix, cudppSparseMatrixDenseMultiply
+  */
+CUDPP_DLL
+CUDPPResult cudppSparseMatrixTransposeMultiply(const CUDPPHandle sparseMatrixHandle,
+                                               void              *d_y,
+                                               const void        *d_x,
+                                               size_t            numVectors,
+                                               size_t            yPitch,
+                                               size_t            xPitch,
+                                               const void        *alpha,
+                                               const void        *beta)
+{
+    CUDPPSparseMatrixVectorMultiplyPlan *plan = 
+        (CUDPPSparseMatrixVectorMultiplyPlan*)
+        getPlanPtrFromHandle<CUDPPSparseMatrixVectorMultiplyPlan>(sparseMatrixHandle);
+    
+    if (plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_SPMVMULT)
+            return CUDPP_ERROR_INVALID_PLAN;
+
+        if (alpha == NULL || beta == NULL || numVectors < 1 ||
+            (numVectors > 1 && (yPitch < plan->m_numCols || xPitch < plan->m_numRows)) ||
+            (plan->m_config.options & CUDPP_OPTION_HOST))
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        
+        cudppSparseMatrixTransposeMultiplyDispatch(d_y, d_x, numVectors, yPitch, xPitch,
+                                                   alpha, beta, plan);
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/** @brief Recompute a sparse matrix product for new values of its operands
+  *
+  * Updates the values of C, created by cudppSparseMatrixMultiply() from A
+  * and B, after the values of A or B have changed (for example with 
+  * cudppSparseMatrixUpdateValues()) but their sparsity patterns have not.
+  * Only the numeric phase of the product is run: the products of each 
+  * nonzero of C are summed in the order found by the symbolic phase, with
+  * no scan or sort.  The handles may differ from those C was created with,
+  * but the matrices must have the same patterns; only their sizes are
+  * checked.
+  *
+  * @param[in] sparseMatrixHandleC Handle to the product created by cudppSparseMatrixMultiply()
+  * @param[in] sparseMatrixHandleA Handle to the first sparse matrix, A
+  * @param[in] sparseMatrixHandleB Handle to the second sparse matrix, B
+  * @returns CUDPPResult indicating success or error condition 
+  * 
+  * @see cudppSparseMatrixMultiply, cudppSparseMatrixUpdateValues
+  */
+CUDPP_DLL
+CUDPPResult cudppSparseMatrixMultiplyNumeric(const CUDPPHandle sparseMatrixHandleC,
+                                             const CUDPPHandle sparseMatrixHandleA,
+                                             const CUDPPHandle sparseMatrixHandleB)
+{
+    CUDPPSparseMatrixVectorMultiplyPlan *plan = 
+        getPlanPtrFromHandle<CUDPPSparseMatrixVectorMultiplyPlan>(sparseMatrixHandleC);
+    CUDPPSparseMatrixVectorMultiplyPlan *A = 
+        getPlanPtrFromHandle<CUDPPSparseMatrixVectorMultiplyPlan>(sparseMatrixHandleA);
+    CUDPPSparseMatrixVectorMultiplyPlan *B = 
+        getPlanPtrFromHandle<CUDPPSparseMatrixVectorMultiplyPlan>(sparseMatrixHandleB);
+    
+    if (plan != NULL && A != NULL && B != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_SPMVMULT ||
+            A->m_config.algorithm != CUDPP_SPMVMULT ||
+            B->m_config.algorithm != CUDPP_SPMVMULT ||
+            plan->m_d_productOrder == NULL)
+            return CUDPP_ERROR_INVALID_PLAN;
+
+        if (A->m_config.datatype != plan->m_config.datatype ||
+            B->m_config.datatype != plan->m_config.datatype ||
+            A->m_numNonZeroElements != plan->m_productLeftNZElts ||
+            B->m_numNonZeroElements != plan->m_productRightNZElts ||
+            ((A->m_config.options | B->m_config.options) & CUDPP_OPTION_HOST))
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+        cudppSparseMatrixMultiplyNumericDispatch(plan, A, B);
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/** @brief Query the storage format of a sparse matrix
+  *
+  * Returns the format that cudppSparseMatrix() converted the matrix to,
+  * either the one requested in the configuration options or the one chosen
+  * from the row length statistics.
+  *
+  * @param[in] sparseMatrixHandle Handle to a sparse matrix object created with cudppSparseMatrix()
+  * @param[out] format One of CUDPP_OPTION_SPMV_CSR, CUDPP_OPTION_SPMV_ELL, 
+  *                    CUDPP_OPTION_SPMV_SELL or CUDPP_OPTION_SPMV_BSR
+  * @returns CUDPPResult indicating success or error condition 
+  * 
+  * @see cudppSparseMatrix, CUDPPOption
+  */
+CUDPP_DLL
+CUDPPResult cudppSparseMatrixFormat(const CUDPPHandle sparseMatrixHandle,
+                                    CUDPPOption       *format)
+{
+    CUDPPSparseMatrixVectorMultiplyPlan *plan = 
+        (CUDPPSparseMatrixVectorMultiplyPlan*)
+        getPlanPtrFromHandle<CUDPPSparseMatrixVectorMultiplyPlan>(sparseMatrixHandle);
+    
+    if (plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_SPMVMULT)
+            return CUDPP_ERROR_INVALID_PLAN;
+        
+        *format = plan->m_format;
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/** @brief Get the row and column ordering of a sparse matrix
+  *
+  * For a matrix created with CUDPP_OPTION_SPMV_REORDER, writes to 
+  * \a h_permutation the original index of each row (and column) in the
+  * order the matrix is stored and multiplied in, i.e. stored row i is row
+  * h_permutation[i] of the matrix passed to cudppSparseMatrix().  Data 
+  * that is laid out in this order once, such as the vectors of an 
+  * iterative solver, gets the same locality benefit as the matrix.  For a
+  * matrix that was not reordered the identity is returned.
+  *
+  * @param[in] sparseMatrixHandle Handle to a sparse matrix object created with cudppSparseMatrix()
+  * @param[out] h_permutation CPU array with one element per row of the matrix
+  * @returns CUDPPResult indicating success or error condition 
+  * 
+  * @see cudppSparseMatrix, CUDPPOption
+  */
+CUDPP_DLL
+CUDPPResult cudppSparseMatrixPermutation(const CUDPPHandle sparseMatrixHandle,
+                                         unsigned int      *h_permutation)
+{
+    CUDPPSparseMatrixVectorMultiplyPlan *plan = 
+        (CUDPPSparseMatrixVectorMultiplyPlan*)
+        getPlanPtrFromHandle<CUDPPSparseMatrixVectorMultiplyPlan>(sparseMatrixHandle);
+    
+    if (plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_SPMVMULT)
+            return CUDPP_ERROR_INVALID_PLAN;
+        if (h_permutation == NULL)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        
+        for (size_t i = 0; i < plan->m_numRows; ++i)
+            h_permutation[i] = plan->m_permutation ? plan->m_permutation[i] : (unsigned int)i;
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/** @brief Replace the values of a sparse matrix, keeping its sparsity pattern
+  *
+  * Overwrites the nonzeros of the matrix with \a A without rebuilding the
+  * row structure, column indices or storage format chosen by
+  * cudppSparseMatrix(), so iterative methods whose values change every
+  * step but whose pattern does not can reuse one handle.  \a A is a CPU
+  * array in the same CSR order as the array passed to cudppSparseMatrix(),
+  * of the type given by the configuration's datatype.
+  *
+  * For formats other than CSR, the first update copies the mapping from
+  * CSR order to the storage format to the GPU; later updates only copy the
+  * new values and place them with a kernel.
+  *
+  * @param[in] sparseMatrixHandle Handle to a sparse matrix object created with cudppSparseMatrix()
+  * @param[in] A The new non-zero elements of the matrix, in CSR order
+  * @returns CUDPPResult indicating success or error condition 
+  * 
+  * @see cudppSparseMatrix
+  */
+CUDPP_DLL
+CUDPPResult cudppSparseMatrixUpdateValues(const CUDPPHandle sparseMatrixHandle,
+                                          const void        *A)
+{
+    CUDPPSparseMatrixVectorMultiplyPlan *plan = 
+        (CUDPPSparseMatrixVectorMultiplyPlan*)
+        getPlanPtrFromHandle<CUDPPSparseMatrixVectorMultiplyPlan>(sparseMatrixHandle);
+    
+    if (plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_SPMVMULT)
+            return CUDPP_ERROR_INVALID_PLAN;
+        if (A == NULL)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        
+        cudppSparseMatrixUpdateValuesDispatch(plan, A);
         return CUDPP_SUCCESS;
     }
     else
@@ -518,8 +833,12 @@ CUDPPResult cudppSparseMatrixVectorMultiply(const CUDPPHandle  sparseMatrixHandl
  * Depending on the specification of the pseudo random number generator(PRNG),
  * the generator may have one or more seeds.  To set the seed, use cudppRandSeed().
  * 
- * @todo Currently only MD5 PRNG is supported.  We may provide more rand routines in 
- * the future.
+ * The counter-based generators (CUDPP_RAND_PHILOX and CUDPP_RAND_THREEFRY)
+ * keep a position in their sequence: each call writes the next \a numElements
+ * elements and advances the position, so generating a sequence in several 
+ * chunks gives the same result as generating it in one call.  Use 
+ * cudppRandSkipAhead() to jump to an arbitrary position and cudppRandStream()
+ * to select an independent substream.
  *
  * @param[in] planHandle Handle to plan for rand
  * @param[in] numElements number of elements in d_out.
@@ -538,11 +857,14 @@ CUDPPResult cudppRand(const CUDPPHandle planHandle,
 
     if(plan != NULL)
     {
-        if (plan->m_config.algorithm != CUDPP_RAND_MD5)
+        if (plan->m_config.algorithm != CUDPP_RAND_MD5 &&
+            plan->m_config.algorithm != CUDPP_RAND_PHILOX &&
+            plan->m_config.algorithm != CUDPP_RAND_THREEFRY)
             return CUDPP_ERROR_INVALID_PLAN;
         
         //dispatch the rand algorithm here
         cudppRandDispatch(d_out, numElements, plan);
+        plan->m_offset += numElements;
         return CUDPP_SUCCESS;
     }
     else
@@ -559,6 +881,9 @@ CUDPPResult cudppRand(const CUDPPHandle planHandle,
  * algorithm has its own  unique set of seeds depending on what 
  * the algorithm needs.
  *
+ * For the counter-based generators, setting the seed also rewinds the 
+ * sequence to its first element.
+ *
  * @param[in] planHandle the handle to the plan which specifies which rand seed to set
  * @param[in] seed the value which the internal cudpp seed will be set to
  * @returns CUDPPResult indicating success or error condition 
@@ -572,9 +897,13 @@ CUDPPResult cudppRandSeed(const CUDPPHandle planHandle,
 
     if (plan != NULL)
     {
-        if (plan->m_config.algorithm != CUDPP_RAND_MD5)
+        if (plan->m_config.algorithm != CUDPP_RAND_MD5 &&
+            plan->m_config.algorithm != CUDPP_RAND_PHILOX &&
+            plan->m_config.algorithm != CUDPP_RAND_THREEFRY &&
+            plan->m_config.algorithm != CUDPP_SHUFFLE)
             return CUDPP_ERROR_INVALID_PLAN;
         plan->m_seed = seed;
+        plan->m_offset = 0;
     }
     else
         return CUDPP_ERROR_INVALID_HANDLE;
@@ -582,6 +911,276 @@ CUDPPResult cudppRandSeed(const CUDPPHandle planHandle,
     return CUDPP_SUCCESS;
 }//end cudppRandSeed
 
+/**@brief Selects the substream used by a counter-based rand plan
+ *
+ * The counter-based generators (CUDPP_RAND_PHILOX and CUDPP_RAND_THREEFRY)
+ * are keyed by the pair (seed, \a stream).  Different streams with the same
+ * seed produce statistically independent sequences, so each worker of a 
+ * distributed job can be given its own stream without any coordination.  
+ * Selecting a stream rewinds the sequence to its first element.
+ *
+ * @param[in] planHandle the handle to a CUDPP_RAND_PHILOX, 
+ *            CUDPP_RAND_THREEFRY or CUDPP_SHUFFLE plan
+ * @param[in] stream the substream to generate from
+ * @returns CUDPPResult indicating success or error condition 
+ * @see cudppRandSeed, cudppRandSkipAhead
+ */
+CUDPP_DLL
+CUDPPResult cudppRandStream(const CUDPPHandle planHandle, 
+                            unsigned int      stream)
+{
+    CUDPPRandPlan * plan = 
+        (CUDPPRandPlan *) getPlanPtrFromHandle<CUDPPRandPlan>(planHandle);
+
+    if (plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_RAND_PHILOX &&
+            plan->m_config.algorithm != CUDPP_RAND_THREEFRY &&
+            plan->m_config.algorithm != CUDPP_SHUFFLE)
+            return CUDPP_ERROR_INVALID_PLAN;
+        plan->m_stream = stream;
+        plan->m_offset = 0;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+
+    return CUDPP_SUCCESS;
+}//end cudppRandStream
+
+/**@brief Skips ahead in the sequence of a counter-based rand plan
+ *
+ * Advances the position of the sequence by \a offset elements in O(1) 
+ * time, so the next call to cudppRand() returns the elements starting at 
+ * the new position.  To generate part [k, k + n) of a sequence, call 
+ * cudppRandSeed(), then cudppRandSkipAhead() with \a offset = k, then 
+ * cudppRand() with n elements.  For CUDPP_SHUFFLE plans the position 
+ * counts calls to cudppShuffle() and cudppSample() instead.
+ *
+ * @param[in] planHandle the handle to a CUDPP_RAND_PHILOX, 
+ *            CUDPP_RAND_THREEFRY or CUDPP_SHUFFLE plan
+ * @param[in] offset the number of elements to skip
+ * @returns CUDPPResult indicating success or error condition 
+ * @see cudppRandSeed, cudppRandStream
+ */
+CUDPP_DLL
+CUDPPResult cudppRandSkipAhead(const CUDPPHandle  planHandle, 
+                               unsigned long long offset)
+{
+    CUDPPRandPlan * plan = 
+        (CUDPPRandPlan *) getPlanPtrFromHandle<CUDPPRandPlan>(planHandle);
+
+    if (plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_RAND_PHILOX &&
+            plan->m_config.algorithm != CUDPP_RAND_THREEFRY &&
+            plan->m_config.algorithm != CUDPP_SHUFFLE)
+            return CUDPP_ERROR_INVALID_PLAN;
+        plan->m_offset += offset;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+
+    return CUDPP_SUCCESS;
+}//end cudppRandSkipAhead
+
+/**@brief Selects the output distribution of a counter-based rand plan
+ *
+ * The counter-based generators (CUDPP_RAND_PHILOX and CUDPP_RAND_THREEFRY)
+ * transform their random bits into the selected distribution as they are
+ * generated, so each output value is written exactly once.  The type of
+ * the output array is the datatype of the plan:
+ *
+ * - CUDPP_RAND_BITS: raw 32-bit values (CUDPP_UINT).  This is the default
+ *   for CUDPP_UINT plans.
+ * - CUDPP_RAND_UNIFORM: uniform in [0, 1) (CUDPP_FLOAT or CUDPP_DOUBLE).
+ *   This is the default for CUDPP_FLOAT and CUDPP_DOUBLE plans.
+ * - CUDPP_RAND_NORMAL: normal with mean \a param0 and standard deviation 
+ *   \a param1 > 0 (CUDPP_FLOAT or CUDPP_DOUBLE).
+ * - CUDPP_RAND_EXPONENTIAL: exponential with rate \a param0 > 0 
+ *   (CUDPP_FLOAT or CUDPP_DOUBLE).
+ * - CUDPP_RAND_UNIFORM_INT: unbiased integers in [\a param0, \a param1),
+ *   where 0 <= \a param0 < \a param1 <= 2^32 are integers (CUDPP_UINT).
+ *
+ * The position used by cudppRandSkipAhead() counts output values.  Each 
+ * 128 bits of the underlying sequence yield four 32-bit values or two 
+ * double values.
+ *
+ * @param[in] planHandle the handle to a CUDPP_RAND_PHILOX or 
+ *            CUDPP_RAND_THREEFRY plan
+ * @param[in] distribution the output distribution
+ * @param[in] param0 first parameter of the distribution
+ * @param[in] param1 second parameter of the distribution
+ * @returns CUDPPResult indicating success or error condition.  Returns
+ * CUDPP_ERROR_ILLEGAL_CONFIGURATION if the distribution, its parameters
+ * and the datatype of the plan do not match.
+ * @see cudppRand, CUDPPRandDistribution
+ */
+CUDPP_DLL
+CUDPPResult cudppRandDistribution(const CUDPPHandle    planHandle, 
+                                  CUDPPRandDistribution distribution,
+                                  double               param0,
+                                  double               param1)
+{
+    CUDPPRandPlan * plan = 
+        (CUDPPRandPlan *) getPlanPtrFromHandle<CUDPPRandPlan>(planHandle);
+
+    if (plan == NULL)
+        return CUDPP_ERROR_INVALID_HANDLE;
+
+    if (plan->m_config.algorithm != CUDPP_RAND_PHILOX &&
+        plan->m_config.algorithm != CUDPP_RAND_THREEFRY)
+        return CUDPP_ERROR_INVALID_PLAN;
+
+    bool isUint = (plan->m_config.datatype == CUDPP_UINT);
+    bool isReal = (plan->m_config.datatype == CUDPP_FLOAT ||
+                   plan->m_config.datatype == CUDPP_DOUBLE);
+
+    switch (distribution)
+    {
+    case CUDPP_RAND_BITS:
+        if (!isUint)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        break;
+    case CUDPP_RAND_UNIFORM:
+        if (!isReal)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        break;
+    case CUDPP_RAND_NORMAL:
+        if (!isReal || !(param1 > 0))
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        break;
+    case CUDPP_RAND_EXPONENTIAL:
+        if (!isReal || !(param0 > 0))
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        break;
+    case CUDPP_RAND_UNIFORM_INT:
+        if (!isUint || !(param0 >= 0) || !(param1 > param0) || 
+            param1 > 4294967296.0 ||
+            param0 != (double)(unsigned long long)param0 || 
+            param1 != (double)(unsigned long long)param1)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        // the full 32-bit range is just the raw bits
+        if (param1 - param0 == 4294967296.0)
+            distribution = CUDPP_RAND_BITS;
+        break;
+    default:
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+    }
+
+    plan->m_distribution = distribution;
+    plan->m_param0 = param0;
+    plan->m_param1 = param1;
+
+    return CUDPP_SUCCESS;
+}//end cudppRandDistribution
+
+/**
+ * @brief Randomly permutes an array, optionally with values
+ *
+ * Writes a pseudorandom permutation of \a d_keysIn to \a d_keysOut.
+ * The permutation is computed without sorting: output i is gathered from
+ * input p(i), where p is a bijection on [0, \a numElements) built from a 
+ * keyed Feistel network with cycle-walking, so each element is read and
+ * written exactly once.  The keys of the network select only a small 
+ * subset of the \a numElements! permutations, so the permutation is 
+ * well mixed but not uniformly distributed over all of them.  If the plan
+ * has the option CUDPP_OPTION_KEY_VALUE_PAIRS and \a d_valuesIn and 
+ * \a d_valuesOut are not NULL, the unsigned int values in \a d_valuesIn
+ * are moved to \a d_valuesOut along with their keys.
+ *
+ * The gather is not in place: \a d_keysOut must not overlap \a d_keysIn,
+ * nor \a d_valuesOut \a d_valuesIn.  Passing the same array for both is 
+ * rejected with CUDPP_ERROR_ILLEGAL_CONFIGURATION.
+ *
+ * The permutation is determined by the plan's seed (cudppRandSeed()), 
+ * stream (cudppRandStream()) and the number of shuffle and sample calls 
+ * made since the seed was set, so each call returns a different 
+ * permutation but a sequence of calls is reproducible.  The keys may be of
+ * any datatype; they are moved as opaque words of the datatype's size.
+ *
+ * @param[in] planHandle handle to a CUDPP_SHUFFLE plan
+ * @param[out] d_keysOut output keys, \a numElements elements
+ * @param[out] d_valuesOut output values, or NULL
+ * @param[in] d_keysIn input keys, \a numElements elements
+ * @param[in] d_valuesIn input values, or NULL
+ * @param[in] numElements number of elements, at most 2^32 - 1
+ * @returns CUDPPResult indicating success or error condition 
+ * @see cudppSample, cudppPlan, CUDPPConfiguration, CUDPPAlgorithm
+ */
+CUDPP_DLL
+CUDPPResult cudppShuffle(const CUDPPHandle planHandle,
+                         void              *d_keysOut,
+                         void              *d_valuesOut,
+                         const void        *d_keysIn,
+                         const void        *d_valuesIn,
+                         size_t            numElements)
+{
+    return cudppSample(planHandle, d_keysOut, d_valuesOut, d_keysIn, 
+                       d_valuesIn, numElements, numElements, 0);
+}
+
+/**
+ * @brief Draws a random sample from an array, optionally with values
+ *
+ * Writes \a numSamples elements of \a d_keysIn, chosen pseudorandomly, 
+ * to \a d_keysOut.  Without replacement the sample is the first
+ * \a numSamples elements of the permutation cudppShuffle() would produce,
+ * computed at a cost proportional to \a numSamples; with replacement 
+ * each sample is an independent unbiased draw.  Values are moved with 
+ * their keys, and the output arrays must not overlap the input arrays, as
+ * described for cudppShuffle().
+ *
+ * @param[in] planHandle handle to a CUDPP_SHUFFLE plan
+ * @param[out] d_keysOut output keys, \a numSamples elements
+ * @param[out] d_valuesOut output values, or NULL
+ * @param[in] d_keysIn input keys, \a numElements elements
+ * @param[in] d_valuesIn input values, or NULL
+ * @param[in] numSamples number of elements to draw
+ * @param[in] numElements number of input elements, at most 2^32 - 1
+ * @param[in] withReplacement nonzero to sample with replacement
+ * @returns CUDPPResult indicating success or error condition.  Returns
+ * CUDPP_ERROR_ILLEGAL_CONFIGURATION if \a numElements is too large, if
+ * \a numSamples exceeds \a numElements when sampling without replacement,
+ * or if an output array is the same as its input array.
+ * @see cudppShuffle, cudppRandSeed, cudppRandStream
+ */
+CUDPP_DLL
+CUDPPResult cudppSample(const CUDPPHandle planHandle,
+                        void              *d_keysOut,
+                        void              *d_valuesOut,
+                        const void        *d_keysIn,
+                        const void        *d_valuesIn,
+                        size_t            numSamples,
+                        size_t            numElements,
+                        int               withReplacement)
+{
+    CUDPPShufflePlan * plan = 
+        (CUDPPShufflePlan *) getPlanPtrFromHandle<CUDPPShufflePlan>(planHandle);
+
+    if (plan == NULL)
+        return CUDPP_ERROR_INVALID_HANDLE;
+
+    if (plan->m_config.algorithm != CUDPP_SHUFFLE)
+        return CUDPP_ERROR_INVALID_PLAN;
+
+    if ((unsigned long long)numElements > 0xFFFFFFFFull ||
+        (numElements == 0 && numSamples > 0) ||
+        (!withReplacement && numSamples > numElements))
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    // the gather reads inputs that other threads may already have written
+    if (d_keysOut == d_keysIn ||
+        (d_valuesOut != NULL && d_valuesOut == d_valuesIn))
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    cudppShuffleDispatch(d_keysOut, (unsigned int*)d_valuesOut, 
+                         d_keysIn, (const unsigned int*)d_valuesIn, 
+                         numSamples, numElements, withReplacement != 0, plan);
+    plan->m_offset++;
+
+    return CUDPP_SUCCESS;
+}
+
 /**
  * @brief Solves tridiagonal linear systems
  *
@@ -594,14 +1193,44 @@ CUDPPResult cudppRandSeed(const CUDPPHandle planHandle,
  *
  * - Both float and double data types are supported. 
  * - Both power-of-two and non-power-of-two system sizes are supported.
- * - The maximum system size could be limited by the maximum number of threads
- * of a CUDA block, the number of registers per multiprocessor, and the 
- * amount of shared memory available. For example, on the GTX 280 GPU, the 
- * maximum system size is 512 for the float datatype, and 256 for the double 
- * datatype, which is limited by the size of shared memory in this case. 
- * - The maximum number of systems is 65535, that is the maximum number of 
- * one-dimensional blocks that could be launched in a kernel call. Users could 
- * launch the kernel multiple times to solve more systems if required. 
+ * - CR-PCR solves one system per CUDA block, so it is used when the system 
+ * fits in a block: the system size is limited by the maximum number of 
+ * threads of a CUDA block and the amount of shared memory available (for 
+ * example, on the GTX 280 GPU, 512 for the float datatype and 256 for the 
+ * double datatype), and the number of systems by the maximum number of 
+ * one-dimensional blocks, 65535.
+ * - Other batches with enough systems to fill the GPU are solved by a 
+ * batched Thomas solver that assigns one system to each thread.
+ * - Batches of fewer, large systems are solved by a partitioned solver: each
+ * system is split into partitions that are reduced in parallel to a small 
+ * interface system, which is solved recursively before the partitions are
+ * completed in parallel.  This handles systems of millions of equations.
+ * - There is no limit on the system size or the number of systems other 
+ * than device memory.
+ * - With the option CUDPP_OPTION_INTERLEAVED, element i of system s is 
+ * stored at index i * \a numSystems + s of each array.  This layout is 
+ * always solved by the Thomas solver with fully coalesced memory accesses, 
+ * and is the fastest choice for large batches of small systems.
+ * - With the option CUDPP_OPTION_CYCLIC, the systems are cyclic 
+ * (periodic): \a d_a[0] of each system couples its first row to its last
+ * unknown and \a d_c[n-1] its last row to its first unknown.  They are 
+ * solved with the Sherman-Morrison formula, as two plain systems with the 
+ * same matrix.  Cyclic systems must have at least 3 equations.
+ * - Otherwise \a d_a[0] and \a d_c[n-1] of each system are ignored.
+ * - For other layouts, such as systems along any axis of a 2D or 3D grid,
+ * see cudppTridiagonalStrided().
+ * - The Thomas and partitioned solvers need scratch storage of up to three
+ * times the size of \a d_x (seven for cyclic systems).  Pass the maximum 
+ * \a systemSize * \a numSystems as \a numElements to cudppPlan() to 
+ * allocate it once; otherwise it is allocated on each call that needs it.
+ * - With the option CUDPP_OPTION_HOST, the arrays are in host memory and 
+ * the systems are solved by the Thomas algorithm on OpenMP threads.  
+ * Adjacent systems (the interleaved layout) are swept in groups, row by 
+ * row, so the inner loop over systems vectorizes.  Batches of fewer large
+ * systems than threads are solved by the partitioned solver, with the 
+ * partitions spread over the threads.  Cyclic systems, 
+ * cudppPentadiagonal(), cudppBlockTridiagonal() and 
+ * cudppTridiagonalFactor() are not supported on the host.
  *
  * @param[out] d_x Solution vector
  * @param[in] planHandle Handle to plan for tridiagonal solver
@@ -630,6 +1259,8 @@ CUDPPResult cudppTridiagonal(CUDPPHandle planHandle,
     
     if(plan != NULL)
     {
+        if (plan->m_config.algorithm != CUDPP_TRIDIAGONAL)
+            return CUDPP_ERROR_INVALID_PLAN;
         //dispatch the tridiagonal solver here
         return cudppTridiagonalDispatch(d_a, d_b, d_c, d_d, d_x, 
                                         systemSize, numSystems, plan);
@@ -639,28 +1270,263 @@ CUDPPResult cudppTridiagonal(CUDPPHandle planHandle,
 }
 
 /**
- * @brief Compresses data stream
+ * @brief Solves tridiagonal linear systems stored with arbitrary strides
  *
- * Performs compression using a three stage pipeline consisting of the Burrows-Wheeler
- * transform, the move-to-front transform, and Huffman encoding.
- * The compression algorithms are described in our paper "Parallel Lossless
- * Data Compression on the GPU". (See the \ref references bibliography).
+ * Same as cudppTridiagonal(), except that element i of system s is stored 
+ * at index i * \a elementStride + s * \a systemStride of each of \a d_a, 
+ * \a d_b, \a d_c, \a d_d and \a d_x, and CUDPP_OPTION_INTERLEAVED is 
+ * ignored.  The solver reads and writes the arrays in place, so ADI-style
+ * sweeps along any axis of a grid need no transposes.  For example, for 
+ * an \a nx x \a ny grid stored row by row, the systems along x have 
+ * strides (1, \a pitch) and the systems along y have strides 
+ * (\a pitch, 1), where \a pitch >= \a nx is the row pitch; for an 
+ * \a nx x \a ny x \a nz grid, the systems along z have strides 
+ * (\a nx * \a ny, 1) with \a numSystems = \a nx * \a ny.
  *
- * - Only unsigned char type is supported.
- * - Currently, the input stream (d_a) must be a buffer of 1,048,576 (uchar) elements (~1MB).
- * - The BWT Index (d_x) is an integer number (int). This is used during the reverse-BWT stage.
- * - The Histogram size pointer (d_y) can be ignored and can be passed a null pointer.
- * - The Histrogram (d_z) is a 256-entry (unsigned int) buffer. The histogram is used to
- * construct the Huffman tree during decoding.
- * - The Encoded offset table (d_w) is a 256-entry (unsigned int) buffer. Since the input
- * stream is compressed in blocks of 4096 characters, the offset table gives the starting offset of
- * where each block starts in the compressed data (d_xx). The very first uint at each starting offset
- * gives the size (in words) of that corresponding compressed block. This allows us to decompress each 4096
- * character-block in parallel.
- * - The size of compressed data (d_xx) is a uint and gives the final size (in words)
- * of the compressed data.
- * - The compress data stream (d_yy) is a uint buffer. The user should allocate enough
- * memory for worst-case (no compression occurs).
+ * - Systems with \a elementStride 1 can use the CR-PCR solver; others use 
+ * the Thomas or partitioned solvers, whose memory accesses are coalesced 
+ * when \a systemStride is 1.
+ * - No two elements may share an address.  Scratch storage mirrors the 
+ * layout, so it is sized by the extent (systemSize - 1) * elementStride + 
+ * (numSystems - 1) * systemStride + 1 rather than by the number of 
+ * elements; if that exceeds what the plan allocated, it is allocated for 
+ * the call.
+ *
+ * @param[out] d_x Solution vector
+ * @param[in] planHandle Handle to plan for tridiagonal solver
+ * @param[in] d_a Lower diagonal
+ * @param[in] d_b Main diagonal
+ * @param[in] d_c Upper diagonal
+ * @param[in] d_d Right hand side
+ * @param[in] systemSize The size of the linear system
+ * @param[in] numSystems The number of systems to be solved
+ * @param[in] elementStride Distance, in elements, between consecutive 
+ *            elements of a system
+ * @param[in] systemStride Distance, in elements, between the first 
+ *            elements of consecutive systems
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see cudppTridiagonal, cudppPlan, CUDPPConfiguration
+ */
+CUDPP_DLL
+CUDPPResult cudppTridiagonalStrided(CUDPPHandle planHandle, 
+                                    void *d_a, 
+                                    void *d_b, 
+                                    void *d_c, 
+                                    void *d_d, 
+                                    void *d_x, 
+                                    int systemSize, 
+                                    int numSystems,
+                                    size_t elementStride,
+                                    size_t systemStride)
+{   
+    CUDPPTridiagonalPlan * plan = 
+        (CUDPPTridiagonalPlan *) getPlanPtrFromHandle<CUDPPTridiagonalPlan>(planHandle);
+    
+    if(plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_TRIDIAGONAL)
+            return CUDPP_ERROR_INVALID_PLAN;
+        return cudppTridiagonalStridedDispatch(d_a, d_b, d_c, d_d, d_x, 
+                                               systemSize, numSystems, 
+                                               elementStride, systemStride, plan);
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Solves factored tridiagonal systems for one or more right hand 
+ * sides
+ *
+ * Solves the systems factored by cudppTridiagonalFactor() for 
+ * \a numRHS right hand sides with a forward and a backward substitution,
+ * one thread per system and right hand side, so implicit time steps with
+ * a fixed matrix skip the elimination.
+ *
+ * - Each right hand side is a full batch of systemSize * numSystems 
+ * elements in the layout of the factored systems; right hand side r 
+ * starts at element r * systemSize * numSystems of \a d_d, and its 
+ * solution at the same element of \a d_x.
+ * - \a d_d is not modified unless \a d_x is the same array, which is 
+ * allowed.
+ * - A null handle is rejected with CUDPP_ERROR_INVALID_HANDLE.  A handle
+ * that is not a factor object, such as a CUDPP_TRIDIAGONAL plan, is 
+ * rejected with CUDPP_ERROR_INVALID_PLAN.
+ *
+ * @param[out] d_x Solution vectors
+ * @param[in] factorHandle Handle to a factor object from 
+ *            cudppTridiagonalFactor()
+ * @param[in] d_d Right hand sides
+ * @param[in] numRHS The number of right hand sides
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see cudppTridiagonalFactor, cudppTridiagonal
+ */
+CUDPP_DLL
+CUDPPResult cudppTridiagonalSolveFactored(const CUDPPHandle factorHandle, 
+                                          const void *d_d, 
+                                          void *d_x, 
+                                          int numRHS)
+{
+    if (factorHandle == CUDPP_INVALID_HANDLE)
+        return CUDPP_ERROR_INVALID_HANDLE;
+
+    CUDPPTridiagonalFactorPlan *plan = 
+        getPlanPtrFromHandle<CUDPPTridiagonalFactorPlan>(factorHandle);
+    
+    if (plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_TRIDIAGONAL_FACTOR)
+            return CUDPP_ERROR_INVALID_PLAN;
+
+        return cudppTridiagonalSolveFactoredDispatch(d_d, d_x, numRHS, plan);
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Solves pentadiagonal linear systems
+ *
+ * Row i of each system reads 
+ * e[i] x[i-2] + a[i] x[i-1] + b[i] x[i] + c[i] x[i+1] + f[i] x[i+2] = d[i];
+ * entries that fall outside the matrix are ignored.  Each system is solved
+ * by Gaussian elimination without pivoting in a single thread, so the 
+ * matrices should be diagonally dominant or symmetric positive definite,
+ * and the solver is fastest for large batches.
+ *
+ * - Both float and double data types are supported. 
+ * - The layout of the arrays and the number of systems are as for 
+ * cudppTridiagonal(), including CUDPP_OPTION_INTERLEAVED.  Plans with
+ * CUDPP_OPTION_CYCLIC or CUDPP_OPTION_HOST are rejected with 
+ * CUDPP_ERROR_ILLEGAL_CONFIGURATION.
+ * - There is no partitioned solver: each system is solved serially by one
+ * GPU thread, so the time grows linearly with \a systemSize, and batches 
+ * of fewer than a few thousand systems leave most of the GPU idle.
+ * - Scratch storage of twice the size of \a x is needed.
+ *
+ * @param[in] planHandle Handle to a CUDPP_TRIDIAGONAL plan
+ * @param[in] e Second lower diagonal
+ * @param[in] a Lower diagonal
+ * @param[in] b Main diagonal
+ * @param[in] c Upper diagonal
+ * @param[in] f Second upper diagonal
+ * @param[in] d Right hand side
+ * @param[out] x Solution vector
+ * @param[in] systemSize The size of the linear system
+ * @param[in] numSystems The number of systems to be solved
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see cudppTridiagonal, cudppBlockTridiagonal
+ */
+CUDPP_DLL
+CUDPPResult cudppPentadiagonal(CUDPPHandle planHandle, 
+                               const void *e, 
+                               const void *a, 
+                               const void *b, 
+                               const void *c, 
+                               const void *f, 
+                               const void *d, 
+                               void *x, 
+                               int systemSize, 
+                               int numSystems)
+{
+    CUDPPTridiagonalPlan * plan = 
+        (CUDPPTridiagonalPlan *) getPlanPtrFromHandle<CUDPPTridiagonalPlan>(planHandle);
+
+    if(plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_TRIDIAGONAL)
+            return CUDPP_ERROR_INVALID_PLAN;
+        return cudppPentadiagonalDispatch(e, a, b, c, f, d, x, 
+                                          systemSize, numSystems, plan);
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Solves block-tridiagonal linear systems with 2x2 or 3x3 blocks
+ *
+ * Block row i of each system reads A[i] X[i-1] + B[i] X[i] + C[i] X[i+1] 
+ * = D[i], where A[i], B[i] and C[i] are \a blockSize x \a blockSize 
+ * blocks stored row-major, one after another, in \a a, \a b and \a c, 
+ * and X[i] and D[i] are vectors of \a blockSize elements stored one after
+ * another in \a x and \a d.  A[0] and C[n-1] are ignored.  Each system is
+ * solved by the block Thomas algorithm in a single thread, inverting the 
+ * diagonal blocks with partial pivoting.
+ *
+ * - Both float and double data types are supported. 
+ * - Block rows are laid out as the rows of cudppTridiagonal(), including 
+ * CUDPP_OPTION_INTERLEAVED (block row i of system s at i * numSystems + s).
+ * Plans with CUDPP_OPTION_CYCLIC or CUDPP_OPTION_HOST are rejected with
+ * CUDPP_ERROR_ILLEGAL_CONFIGURATION.
+ * - As for cudppPentadiagonal(), each system is solved serially by one GPU
+ * thread, so the solver needs a large batch to fill the GPU.
+ * - Scratch storage of the size of \a c is needed.
+ *
+ * @param[in] planHandle Handle to a CUDPP_TRIDIAGONAL plan
+ * @param[in] a Lower diagonal blocks
+ * @param[in] b Main diagonal blocks
+ * @param[in] c Upper diagonal blocks
+ * @param[in] d Right hand side vectors
+ * @param[out] x Solution vectors
+ * @param[in] blockSize The dimension of the blocks, 2 or 3
+ * @param[in] systemSize The number of block rows of each system
+ * @param[in] numSystems The number of systems to be solved
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see cudppTridiagonal, cudppPentadiagonal
+ */
+CUDPP_DLL
+CUDPPResult cudppBlockTridiagonal(CUDPPHandle planHandle, 
+                                  const void *a, 
+                                  const void *b, 
+                                  const void *c, 
+                                  const void *d, 
+                                  void *x, 
+                                  int blockSize,
+                                  int systemSize, 
+                                  int numSystems)
+{
+    CUDPPTridiagonalPlan * plan = 
+        (CUDPPTridiagonalPlan *) getPlanPtrFromHandle<CUDPPTridiagonalPlan>(planHandle);
+
+    if(plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_TRIDIAGONAL)
+            return CUDPP_ERROR_INVALID_PLAN;
+        return cudppBlockTridiagonalDispatch(a, b, c, d, x, blockSize, 
+                                             systemSize, numSystems, plan);
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Compresses data stream
+ *
+ * Performs compression using a three stage pipeline consisting of the Burrows-Wheeler
+ * transform, the move-to-front transform, and Huffman encoding.
+ * The compression algorithms are described in our paper "Parallel Lossless
+ * Data Compression on the GPU". (See the \ref references bibliography).
+ *
+ * - Only unsigned char type is supported.
+ * - Currently, the input stream (d_a) must be a buffer of 1,048,576 (uchar) elements (~1MB).
+ * - The BWT Index (d_x) is an integer number (int). This is used during the reverse-BWT stage.
+ * - The Histogram size pointer (d_y) can be ignored and can be passed a null pointer.
+ * - The Histrogram (d_z) is a 256-entry (unsigned int) buffer. The histogram is used to
+ * construct the Huffman tree during decoding.
+ * - The Encoded offset table (d_w) is a 256-entry (unsigned int) buffer. Since the input
+ * stream is compressed in blocks of 4096 characters, the offset table gives the starting offset of
+ * where each block starts in the compressed data (d_xx). The very first uint at each starting offset
+ * gives the size (in words) of that corresponding compressed block. This allows us to decompress each 4096
+ * character-block in parallel.
+ * - The size of compressed data (d_xx) is a uint and gives the final size (in words)
+ * of the compressed data.
+ * - The compress data stream (d_yy) is a uint buffer. The user should allocate enough
+ * memory for worst-case (no compression occurs).
  * - \a numElements is a uint and must be set to 1048576.
  *
  * @param[out] d_x BWT Index (int)
@@ -843,7 +1709,13 @@ CUDPPResult cudppMoveToFrontTransform(CUDPPHandle planHandle,
  * @brief Performs list ranking of linked list node values
  *
  * Performs parallel list ranking on values of a linked-list
- * using a pointer-jumping algorithm.
+ * using a sparse ruling set: the list head and evenly spaced nodes
+ * split the list into sublists, which are walked in parallel for their
+ * lengths; the sublist heads are ranked, and a second walk writes every
+ * value at its rank.  The plan chooses the number of sublists and of
+ * threads from \a numElements and the size of the device (or the
+ * number of host threads), see cudppListRankStats().  \a numElements
+ * must not exceed the number of elements the plan was created for.
  *
  * Takes as input an array of values in GPU memory
  * (\a d_a) and an equal-sized int array in GPU memory
@@ -860,6 +1732,13 @@ CUDPPResult cudppMoveToFrontTransform(CUDPPHandle planHandle,
  * d_x     = [ a b c d e f ]
  * \endcode
  *
+ * With CUDPP_OPTION_HOST in the plan configuration all three arrays
+ * are in host memory and the list is ranked on the CPU with a sparse
+ * ruling set (Helman and JaJa): sublists that start at evenly spaced
+ * nodes are walked in parallel, their heads are ranked, and a second
+ * walk writes the values.  The next indices of the sublist heads are
+ * modified during the call and restored before it returns, so \a d_b
+ * must not be read concurrently.
  *
  * @param[in] planHandle Handle to plan for list ranking
  * @param[out] d_x Output ranked values
@@ -886,6 +1765,9 @@ CUDPPResult cudppListRank(CUDPPHandle planHandle,
     {
         if (plan->m_config.algorithm != CUDPP_LISTRANK)
             return CUDPP_ERROR_INVALID_PLAN;
+        if (numElements > plan->m_numElements ||
+            (numElements > 0 && head >= numElements))
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
 
         return cudppListRankDispatch(d_x, d_a, d_b, head, numElements, plan);
     }
@@ -893,6 +1775,652 @@ CUDPPResult cudppListRank(CUDPPHandle planHandle,
         return CUDPP_ERROR_INVALID_HANDLE;
 }
 
+/**
+ * @brief Scans the lists of a forest of linked lists in list order
+ *
+ * Computes, for every node of every list, the prefix of the node
+ * values along its list under the plan's operator (CUDPP_ADD,
+ * CUDPP_MULTIPLY, CUDPP_MAX or CUDPP_MIN), and writes it at the node's
+ * own index in \a d_x.  The prefix is inclusive, or exclusive (starting
+ * from the operator's identity) with CUDPP_OPTION_EXCLUSIVE.  Unlike
+ * cudppListRank(), the output is not reordered, so the same call gives
+ * per-node sums, depths or running extrema of many lists at once; with
+ * all values 1, CUDPP_ADD and CUDPP_OPTION_EXCLUSIVE it ranks every node
+ * within its list.
+ *
+ * \a d_b holds the next indices; a list ends at a node whose next index
+ * is -1, or at the node before the head of another list.  The
+ * \a numHeads heads are given in \a d_heads, or, with \a d_heads NULL,
+ * are the nodes that are no node's successor.  Nodes that are not
+ * reached from any head are not written.
+ *
+ * Example (CUDPP_ADD, inclusive, d_heads NULL):
+ * \code
+ * d_a     = [  1 1 1 1 1 1 ]
+ * d_b     = [ -1 4 3 -1 2 0 ]
+ * d_x     = [  2 1 3 4 2 1 ]
+ * \endcode
+ *
+ * The lists are scanned with the sparse ruling set of cudppListRank(),
+ * with one extra sublist per list, in a single pair of walks over the
+ * forest however many lists it has.  With CUDPP_OPTION_HOST all arrays
+ * are in host memory, and \a d_b is modified during the call and
+ * restored before it returns.
+ *
+ * @param[in] planHandle Handle to plan for list ranking
+ * @param[out] d_x Output prefix values
+ * @param[in] d_a Input node values
+ * @param[in] d_b Input next indices
+ * @param[in] d_heads Input list heads, or NULL to find them
+ * @param[in] numHeads Number of list heads in \a d_heads
+ * @param[in] numElements number of nodes
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see cudppListRank, cudppPlan, CUDPPConfiguration
+ */
+CUDPP_DLL
+CUDPPResult cudppListScan(CUDPPHandle planHandle,
+                          void *d_x,
+                          const void *d_a,
+                          void *d_b,
+                          const int *d_heads,
+                          size_t numHeads,
+                          size_t numElements)
+{
+    CUDPPListRankPlan * plan = 
+        (CUDPPListRankPlan *) getPlanPtrFromHandle<CUDPPListRankPlan>(planHandle);
+    
+    if(plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_LISTRANK)
+            return CUDPP_ERROR_INVALID_PLAN;
+        if (numElements > plan->m_numElements ||
+            (d_heads != NULL && numHeads > numElements))
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+        return cudppListScanDispatch(d_x, d_a, d_b, d_heads, numHeads,
+                                     numElements, plan);
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Reports the work decomposition of a list ranking plan
+ *
+ * Returns the number of sublists and of threads that the most recent
+ * cudppListRank() or cudppListScan() call on the plan used, or before any call the ones
+ * chosen for the number of elements the plan was created for.
+ *
+ * @param[in] planHandle Handle to plan for list ranking
+ * @param[out] stats The work decomposition
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see cudppListRank, CUDPPListRankStats
+ */
+CUDPP_DLL
+CUDPPResult cudppListRankStats(CUDPPHandle planHandle,
+                               CUDPPListRankStats *stats)
+{
+    CUDPPListRankPlan * plan = 
+        (CUDPPListRankPlan *) getPlanPtrFromHandle<CUDPPListRankPlan>(planHandle);
+    
+    if(plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_LISTRANK)
+            return CUDPP_ERROR_INVALID_PLAN;
+        if (stats == NULL)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+        *stats = plan->m_stats;
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Builds the Euler tour of a forest given by a parent array
+ *
+ * Builds the tree structures of a CUDPP_TREE plan for the forest whose
+ * node \a v has parent \a d_parent[v], or is a root if \a d_parent[v] is
+ * negative.  The children of each node are grouped by a radix sort of
+ * the nodes by parent (in node order), the 2n arcs of the Euler tour of
+ * the forest are linked, with the roots as children of a virtual root so
+ * that the tour is one list, and the tour is scanned once with
+ * cudppListScan().  The prefixes of the two arcs of each node give its
+ * pre-order and post-order numbers, its depth and its subtree size, see
+ * cudppTreeOrder(), and a sparse table over the pre-order positions is
+ * built for cudppTreeLCA().  The work is O(n) plus the sort.
+ *
+ * Pre-order and post-order numbers run over the whole forest, visiting
+ * the trees in the order of their roots and the children of each node
+ * in node order.  \a d_parent must describe a forest: parent links
+ * must not form a cycle.
+ *
+ * With CUDPP_OPTION_HOST in the plan configuration all arrays are in
+ * host memory and every step runs on the CPU with OpenMP.
+ *
+ * @param[in] planHandle Handle to a CUDPP_TREE plan
+ * @param[in] d_parent Parent of each node, negative for roots
+ * @param[in] numNodes Number of nodes, at most the plan's number of elements
+ * @returns CUDPPResult indicating success or error condition; 
+ * CUDPP_ERROR_ILLEGAL_CONFIGURATION if the forest has no root
+ *
+ * @see cudppTreeFromEdges, cudppTreeOrder, cudppTreeLCA
+ */
+CUDPP_DLL
+CUDPPResult cudppTreeFromParents(CUDPPHandle planHandle,
+                                 const int *d_parent,
+                                 size_t numNodes)
+{
+    CUDPPTreePlan * plan = 
+        (CUDPPTreePlan *) getPlanPtrFromHandle<CUDPPTreePlan>(planHandle);
+    
+    if(plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_TREE)
+            return CUDPP_ERROR_INVALID_PLAN;
+        if (numNodes > plan->m_numElements)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+        return cudppTreeFromParentsDispatch(plan, d_parent, numNodes);
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Roots a spanning tree given as an edge list and builds it
+ *
+ * The \a numNodes - 1 edges (\a d_edgeU[e], \a d_edgeV[e]) must form a
+ * spanning tree of the nodes.  The two arcs of every edge are grouped by
+ * node with a radix sort, the arc u->v is followed by the arc after v->u
+ * around v, and the resulting Euler tour from \a root is ranked with
+ * cudppListScan(): the arc of each edge that comes first runs from the
+ * parent to the child.  The parent of every node is written to
+ * \a d_parent (-1 for \a root), and the tree is then built as by
+ * cudppTreeFromParents().
+ *
+ * @param[in] planHandle Handle to a CUDPP_TREE plan
+ * @param[out] d_parent Parent of each node
+ * @param[in] d_edgeU First node of each edge
+ * @param[in] d_edgeV Second node of each edge
+ * @param[in] numNodes Number of nodes, at most the plan's number of elements
+ * @param[in] root The root
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see cudppTreeFromParents, cudppTreeOrder, cudppTreeLCA
+ */
+CUDPP_DLL
+CUDPPResult cudppTreeFromEdges(CUDPPHandle planHandle,
+                               int *d_parent,
+                               const int *d_edgeU,
+                               const int *d_edgeV,
+                               size_t numNodes,
+                               int root)
+{
+    CUDPPTreePlan * plan = 
+        (CUDPPTreePlan *) getPlanPtrFromHandle<CUDPPTreePlan>(planHandle);
+    
+    if(plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_TREE)
+            return CUDPP_ERROR_INVALID_PLAN;
+        if (numNodes == 0 || numNodes > plan->m_numElements ||
+            root < 0 || (size_t)root >= numNodes)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+        return cudppTreeFromEdgesDispatch(plan, d_parent, d_edgeU, d_edgeV,
+                                          numNodes, root);
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Numbers the nodes of the most recently built forest
+ *
+ * Writes, for every node of the forest built by cudppTreeFromParents()
+ * or cudppTreeFromEdges() on the plan, its pre-order number, post-order
+ * number, depth (0 for roots) and number of nodes in its subtree
+ * (including itself).  Any of the output arrays may be NULL.
+ *
+ * Example (parents [-1 0 0 1]):
+ * \code
+ * d_preorder    = [ 0 1 3 2 ]
+ * d_postorder   = [ 3 1 2 0 ]
+ * d_depth       = [ 0 1 1 2 ]
+ * d_subtreeSize = [ 4 2 1 1 ]
+ * \endcode
+ *
+ * @param[in] planHandle Handle to a CUDPP_TREE plan
+ * @param[out] d_preorder Pre-order number of each node
+ * @param[out] d_postorder Post-order number of each node
+ * @param[out] d_depth Depth of each node
+ * @param[out] d_subtreeSize Subtree size of each node
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see cudppTreeFromParents, cudppTreeFromEdges
+ */
+CUDPP_DLL
+CUDPPResult cudppTreeOrder(CUDPPHandle planHandle,
+                           int *d_preorder,
+                           int *d_postorder,
+                           int *d_depth,
+                           int *d_subtreeSize)
+{
+    CUDPPTreePlan * plan = 
+        (CUDPPTreePlan *) getPlanPtrFromHandle<CUDPPTreePlan>(planHandle);
+    
+    if(plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_TREE)
+            return CUDPP_ERROR_INVALID_PLAN;
+
+        cudppTreeOrderDispatch(plan, d_preorder, d_postorder, d_depth, d_subtreeSize);
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Finds the lowest common ancestors of pairs of nodes
+ *
+ * Answers \a numQueries queries on the forest most recently built on the
+ * plan: \a d_lca[q] is the lowest common ancestor of \a d_u[q] and
+ * \a d_v[q], or -1 if they are in different trees.  The shallowest node
+ * between the two nodes in pre-order is a child of their LCA; it is
+ * found from the sparse table built with the forest, which holds one
+ * entry per block of 32 pre-order positions per level, and short scans
+ * of the partial blocks at the ends of the range.
+ *
+ * @param[in] planHandle Handle to a CUDPP_TREE plan
+ * @param[out] d_lca Lowest common ancestor of each pair
+ * @param[in] d_u First node of each pair
+ * @param[in] d_v Second node of each pair
+ * @param[in] numQueries Number of pairs
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see cudppTreeFromParents, cudppTreeFromEdges
+ */
+CUDPP_DLL
+CUDPPResult cudppTreeLCA(CUDPPHandle planHandle,
+                         int *d_lca,
+                         const int *d_u,
+                         const int *d_v,
+                         size_t numQueries)
+{
+    CUDPPTreePlan * plan = 
+        (CUDPPTreePlan *) getPlanPtrFromHandle<CUDPPTreePlan>(planHandle);
+    
+    if(plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_TREE)
+            return CUDPP_ERROR_INVALID_PLAN;
+        if (numQueries > 0 && plan->m_numNodes == 0)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+        cudppTreeLCADispatch(plan, d_lca, d_u, d_v, numQueries);
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Labels the connected components of a graph given as an edge list
+ *
+ * Writes to \a d_labels[v] the component of vertex \a v.  The labels are
+ * dense: the components are numbered from 0 in the order of their
+ * smallest vertex, and their number is written to \a numComponents
+ * (a host pointer, may be NULL).  The edges are undirected and may
+ * include duplicates and self loops; every vertex must be in 
+ * [0, \a numVertices).
+ *
+ * The components are found with a lock-free union-find in which a root
+ * is swung to a smaller root with a compare-and-swap and paths are
+ * compressed between phases (Afforest, Sutton et al. 2018).  Every 
+ * eighth edge is linked first; the component that most of a sample of
+ * vertices then belongs to is skipped while linking the remaining edges,
+ * so edges within the largest component are mostly never linked.
+ *
+ * With CUDPP_OPTION_HOST in the plan configuration all arrays are in
+ * host memory and the components are found on the CPU with OpenMP.
+ *
+ * @param[in] planHandle Handle to a CUDPP_CONNECTED_COMPONENTS plan
+ * @param[out] d_labels Component of each vertex
+ * @param[out] numComponents Number of components
+ * @param[in] d_edgeU First vertex of each edge
+ * @param[in] d_edgeV Second vertex of each edge
+ * @param[in] numEdges Number of edges, at most 2,147,483,647
+ * @param[in] numVertices Number of vertices, at most the plan's number of elements
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see cudppConnectedComponentsCSR
+ */
+CUDPP_DLL
+CUDPPResult cudppConnectedComponents(CUDPPHandle planHandle,
+                                     int *d_labels,
+                                     size_t *numComponents,
+                                     const int *d_edgeU,
+                                     const int *d_edgeV,
+                                     size_t numEdges,
+                                     size_t numVertices)
+{
+    CUDPPComponentsPlan * plan = 
+        (CUDPPComponentsPlan *) getPlanPtrFromHandle<CUDPPComponentsPlan>(planHandle);
+    
+    if(plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_CONNECTED_COMPONENTS)
+            return CUDPP_ERROR_INVALID_PLAN;
+        if (numVertices > plan->m_numElements || numEdges > INT_MAX)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+        size_t count = cudppConnectedComponentsDispatch(plan, d_labels, NULL, NULL, 
+                                                        d_edgeU, d_edgeV, 
+                                                        numEdges, numVertices);
+        if (numComponents != NULL)
+            *numComponents = count;
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Labels the connected components of a graph in CSR form
+ *
+ * The neighbors of vertex \a v are \a d_indices[\a d_rowIndices[v]] to
+ * \a d_indices[\a d_rowIndices[v+1] - 1].  The graph must be symmetric:
+ * every edge is listed in the neighbors of both its vertices, as in the
+ * adjacency matrix of an undirected graph.  The labels are as for
+ * cudppConnectedComponents().
+ *
+ * The first two neighbors of every vertex are linked first; the vertices
+ * of the component that most of a sample of vertices then belongs to are
+ * skipped while linking the remaining neighbors, since their edges to
+ * other components are also listed at the other end.
+ *
+ * @param[in] planHandle Handle to a CUDPP_CONNECTED_COMPONENTS plan
+ * @param[out] d_labels Component of each vertex
+ * @param[out] numComponents Number of components
+ * @param[in] d_rowIndices Offset of the first neighbor of each vertex (numVertices + 1)
+ * @param[in] d_indices Neighbors of all vertices
+ * @param[in] numVertices Number of vertices, at most the plan's number of elements
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see cudppConnectedComponents
+ */
+CUDPP_DLL
+CUDPPResult cudppConnectedComponentsCSR(CUDPPHandle planHandle,
+                                        int *d_labels,
+                                        size_t *numComponents,
+                                        const unsigned int *d_rowIndices,
+                                        const unsigned int *d_indices,
+                                        size_t numVertices)
+{
+    CUDPPComponentsPlan * plan = 
+        (CUDPPComponentsPlan *) getPlanPtrFromHandle<CUDPPComponentsPlan>(planHandle);
+    
+    if(plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_CONNECTED_COMPONENTS)
+            return CUDPP_ERROR_INVALID_PLAN;
+        if (numVertices > plan->m_numElements || d_rowIndices == NULL)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+        size_t count = cudppConnectedComponentsDispatch(plan, d_labels, 
+                                                        d_rowIndices, d_indices,
+                                                        NULL, NULL, 0, numVertices);
+        if (numComponents != NULL)
+            *numComponents = count;
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Breadth-first search of a graph in CSR form
+ *
+ * Writes to \a d_distances[v] the number of edges on a shortest path
+ * from \a source to vertex \a v, and to \a d_parents[v] the vertex
+ * before \a v on one such path.  The source is its own parent; vertices
+ * that cannot be reached have distance and parent -1.  \a d_parents may
+ * be NULL.  The edges of vertex \a v go to \a d_indices[\a d_rowIndices[v]]
+ * to \a d_indices[\a d_rowIndices[v+1] - 1].  The graph must be
+ * symmetric, as for cudppConnectedComponentsCSR(), because pull levels
+ * (below) look for a vertex's parent among its own neighbors.
+ *
+ * The search is direction optimizing.  While the frontier is small its
+ * vertices push to their neighbors, one edge per thread.  Once the
+ * frontier's edges are a large part of those not yet explored, every
+ * unvisited vertex instead pulls from a bitmap of the frontier and stops
+ * at the first parent it finds.  Pushing resumes when the frontier is
+ * shrinking and small again.
+ *
+ * @param[in] planHandle Handle to a CUDPP_BFS plan
+ * @param[out] d_distances Distance of each vertex from \a source
+ * @param[out] d_parents Parent of each vertex in the search tree (may be NULL)
+ * @param[in] d_rowIndices Offset of the first neighbor of each vertex (numVertices + 1)
+ * @param[in] d_indices Neighbors of all vertices
+ * @param[in] numVertices Number of vertices, at most the plan's number of elements
+ * @param[in] source The vertex to start from
+ * @returns CUDPPResult indicating success or error condition
+ */
+CUDPP_DLL
+CUDPPResult cudppBFS(CUDPPHandle planHandle,
+                     int *d_distances,
+                     int *d_parents,
+                     const unsigned int *d_rowIndices,
+                     const unsigned int *d_indices,
+                     size_t numVertices,
+                     int source)
+{
+    CUDPPBfsPlan * plan = 
+        (CUDPPBfsPlan *) getPlanPtrFromHandle<CUDPPBfsPlan>(planHandle);
+    
+    if(plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_BFS)
+            return CUDPP_ERROR_INVALID_PLAN;
+        if (numVertices > plan->m_numElements || source < 0 ||
+            (size_t)source >= numVertices ||
+            d_distances == NULL || d_rowIndices == NULL)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+        cudppBFSDispatch(plan, d_distances, d_parents, d_rowIndices, d_indices,
+                         numVertices, source);
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Reduces every run of equal consecutive keys to one key and value
+ *
+ * Each maximal run of equal keys in \a d_keys is a segment.  Segment \a s
+ * writes its key to \a d_keysOut[s] and the reduction of its values in
+ * \a d_values with the plan's operator to \a d_valuesOut[s], in input
+ * order; the number of segments is written to \a numSegments (a host
+ * pointer, may be NULL).  Keys are 32 bits and are compared for equality
+ * only, so int keys may be passed as well.  Sorting the keys first (e.g.
+ * with cudppRadixSort) reduces every distinct key to one segment.
+ *
+ * The plan's datatype (CUDPP_INT, CUDPP_UINT, CUDPP_FLOAT, CUDPP_DOUBLE,
+ * CUDPP_LONGLONG or CUDPP_ULONGLONG) is the type of the values, and its
+ * operator any CUDPPOperator.  Head flags, segment ranks and reductions
+ * are computed together in registers for runs of consecutive elements,
+ * so no per-element flag or rank array is stored, and only the partial
+ * segments that cross those runs are scanned.  With CUDPP_OPTION_HOST the
+ * arrays are in host memory and each OpenMP thread flags, reduces and
+ * writes its part of the input in one pass over the keys; the parts are
+ * then moved together.  The outputs must hold \a numElements entries and
+ * must not overlap the inputs.
+ *
+ * @param[in] planHandle Handle to a CUDPP_REDUCE_BY_KEY plan
+ * @param[out] d_keysOut Key of each segment
+ * @param[out] d_valuesOut Reduction of the values of each segment
+ * @param[out] numSegments Number of segments
+ * @param[in] d_keys Keys
+ * @param[in] d_values Values
+ * @param[in] numElements Number of elements, at most the plan's number of elements
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see cudppRLE
+ */
+CUDPP_DLL
+CUDPPResult cudppReduceByKey(const CUDPPHandle planHandle,
+                             unsigned int *d_keysOut,
+                             void *d_valuesOut,
+                             size_t *numSegments,
+                             const unsigned int *d_keys,
+                             const void *d_values,
+                             size_t numElements)
+{
+    CUDPPReduceByKeyPlan * plan = 
+        (CUDPPReduceByKeyPlan *) getPlanPtrFromHandle<CUDPPReduceByKeyPlan>(planHandle);
+    
+    if(plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_REDUCE_BY_KEY)
+            return CUDPP_ERROR_INVALID_PLAN;
+        if (numElements > plan->m_numElements)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+        size_t count = cudppReduceByKeyDispatch(plan, d_keysOut, d_valuesOut,
+                                                d_keys, d_values, numElements);
+        if (numSegments != NULL)
+            *numSegments = count;
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Run-length encodes an array
+ *
+ * Each maximal run of equal consecutive elements of \a d_in writes its
+ * element to \a d_runValues[r] and its length to \a d_runLengths[r]; the
+ * number of runs is written to \a numRuns (a host pointer, may be NULL).
+ * Elements of the plan's datatype are compared bit for bit, so for
+ * CUDPP_FLOAT and CUDPP_DOUBLE 0.0 and -0.0 start different runs and
+ * equal NaNs form one run.  The plan's operator is not used.
+ *
+ * This is cudppReduceByKey() of the elements with a value of 1 each, and
+ * shares its single pass and its host backend.  The outputs must hold
+ * \a numElements entries.
+ *
+ * @param[in] planHandle Handle to a CUDPP_RLE plan
+ * @param[out] d_runValues Element of each run
+ * @param[out] d_runLengths Length of each run
+ * @param[out] numRuns Number of runs
+ * @param[in] d_in Input elements
+ * @param[in] numElements Number of elements, at most the plan's number of elements
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see cudppReduceByKey
+ */
+CUDPP_DLL
+CUDPPResult cudppRLE(const CUDPPHandle planHandle,
+                     void *d_runValues,
+                     unsigned int *d_runLengths,
+                     size_t *numRuns,
+                     const void *d_in,
+                     size_t numElements)
+{
+    CUDPPReduceByKeyPlan * plan = 
+        (CUDPPReduceByKeyPlan *) getPlanPtrFromHandle<CUDPPReduceByKeyPlan>(planHandle);
+    
+    if(plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_RLE)
+            return CUDPP_ERROR_INVALID_PLAN;
+        if (numElements > plan->m_numElements)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+        size_t count = cudppRLEDispatch(plan, d_runValues, d_runLengths, d_in,
+                                        numElements);
+        if (numRuns != NULL)
+            *numRuns = count;
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Removes duplicate keys, and optionally their values
+ *
+ * By default the keys must be sorted (or at least have equal keys
+ * adjacent), and the first key of each run of equal keys is kept.  With
+ * CUDPP_OPTION_UNSORTED in the plan's configuration the keys may be in
+ * any order, and the first occurrence of each key is kept; the kept keys
+ * stay in the order of their first occurrences.  The kept keys are
+ * written to \a d_keysOut and the number of them to \a numUnique (a host
+ * pointer, may be NULL).  Keys of the plan's datatype are compared bit
+ * for bit; CUDPP_OPTION_UNSORTED takes keys of up to 32 bits.
+ *
+ * When \a d_values is not NULL, the value of each kept key is written
+ * to \a d_valuesOut, which must then not be NULL either.
+ *
+ * The output may be the input (\a d_keysOut == \a d_keys and
+ * \a d_valuesOut == \a d_values) or must not overlap it.  The GPU counts
+ * and writes the kept elements of tiles of consecutive elements without
+ * a per-element flag array; an in-place call writes them to the plan's
+ * temporary arrays and copies them back.  The host backend
+ * (CUDPP_OPTION_HOST) reads the input once and compacts each thread's
+ * part in place.
+ *
+ * @param[in] planHandle Handle to a CUDPP_UNIQUE plan
+ * @param[out] d_keysOut Kept keys
+ * @param[out] d_valuesOut Values of the kept keys (may be NULL)
+ * @param[out] numUnique Number of kept keys
+ * @param[in] d_keys Keys
+ * @param[in] d_values Values (may be NULL)
+ * @param[in] numElements Number of elements, at most the plan's number of elements
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see cudppRLE
+ */
+CUDPP_DLL
+CUDPPResult cudppUnique(const CUDPPHandle planHandle,
+                        void *d_keysOut,
+                        unsigned int *d_valuesOut,
+                        size_t *numUnique,
+                        const void *d_keys,
+                        const unsigned int *d_values,
+                        size_t numElements)
+{
+    CUDPPUniquePlan * plan = 
+        (CUDPPUniquePlan *) getPlanPtrFromHandle<CUDPPUniquePlan>(planHandle);
+    
+    if(plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_UNIQUE)
+            return CUDPP_ERROR_INVALID_PLAN;
+        if (numElements > plan->m_numElements)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        if (d_values != NULL && d_valuesOut == NULL)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        if (d_values == NULL)
+            d_valuesOut = NULL;
+
+        size_t count = cudppUniqueDispatch(plan, d_keysOut, d_valuesOut, d_keys,
+                                           d_values, numElements);
+        if (numUnique != NULL)
+            *numUnique = count;
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
 /** @} */ // end Algorithm Interface
 /** @} */ // end of publicInterface group
 
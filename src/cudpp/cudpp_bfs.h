@@ -0,0 +1,39 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// ------------------------------------------------------------- 
+// This source code is distributed under the terms of license.txt in
+// the root directory of this source distribution.
+// ------------------------------------------------------------- 
+
+/**
+* @file
+* cudpp_bfs.h
+*
+* @brief Breadth-first search functionality header file - contains CUDPP 
+* interface (not public)
+*/
+
+#ifndef __CUDPP_BFS_H__
+#define __CUDPP_BFS_H__
+
+class CUDPPBfsPlan;
+
+extern "C"
+void allocBfsStorage(CUDPPBfsPlan *plan);
+
+extern "C"
+void freeBfsStorage(CUDPPBfsPlan *plan);
+
+extern "C"
+void cudppBFSDispatch(CUDPPBfsPlan         *plan,
+                      int                  *d_distances,
+                      int                  *d_parents,
+                      const unsigned int   *d_rowIndices,
+                      const unsigned int   *d_indices,
+                      size_t               numVertices,
+                      int                  source);
+
+#endif // __CUDPP_BFS_H__
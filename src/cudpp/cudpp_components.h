@@ -0,0 +1,40 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// ------------------------------------------------------------- 
+// This source code is distributed under the terms of license.txt in
+// the root directory of this source distribution.
+// ------------------------------------------------------------- 
+
+/**
+* @file
+* cudpp_components.h
+*
+* @brief Connected components functionality header file - contains CUDPP 
+* interface (not public)
+*/
+
+#ifndef __CUDPP_COMPONENTS_H__
+#define __CUDPP_COMPONENTS_H__
+
+class CUDPPComponentsPlan;
+
+extern "C"
+void allocComponentsStorage(CUDPPComponentsPlan *plan);
+
+extern "C"
+void freeComponentsStorage(CUDPPComponentsPlan *plan);
+
+extern "C"
+size_t cudppConnectedComponentsDispatch(CUDPPComponentsPlan  *plan,
+                                        int                  *d_labels,
+                                        const unsigned int   *d_rowIndices,
+                                        const unsigned int   *d_indices,
+                                        const int            *d_edgeU,
+                                        const int            *d_edgeV,
+                                        size_t               numEdges,
+                                        size_t               numVertices);
+
+#endif // __CUDPP_COMPONENTS_H__
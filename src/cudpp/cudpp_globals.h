@@ -55,6 +55,76 @@ const int SEGSCAN_ELTS_PER_THREAD = 8;           /**< Number of elements per seg
 #define MTF_THREADS_BLOCK   64
 #define MTF_LIST_SIZE       25
 
+// Counter-based random number generators (Philox / Threefry)
+#define PHILOX_ROUNDS       10
+#define PHILOX_M4x32_0      0xD2511F53
+#define PHILOX_M4x32_1      0xCD9E8D57
+#define PHILOX_W32_0        0x9E3779B9
+#define PHILOX_W32_1        0xBB67AE85
+#define THREEFRY_ROUNDS     20
+#define THREEFRY_PARITY32   0x1BD11BDA
+
+// Tridiagonal
+#define TRIDIAGONAL_THOMAS_CTA_SIZE    128
+#define TRIDIAGONAL_PARTITION_SIZE     32  // rows per partition of the partitioned solver
+#define TRIDIAGONAL_SCRATCH_FACTOR     3   // scratch elements per equation, an upper bound over all solvers
+#define TRIDIAGONAL_CYCLIC_SCRATCH_FACTOR 7 // scratch elements per equation for cyclic systems
+#define TRIDIAGONAL_HOST_GROUP_SIZE    256 // adjacent systems each host thread sweeps row by row
+#define TRIDIAGONAL_HOST_PARTS_PER_THREAD 4 // partitions per host thread of the host partitioned solver
+
+// Sparse matrix-vector multiply
+#define SPMV_CTA_SIZE           128
+#define SPMV_ITEMS_PER_THREAD   8     // merge-path items (rows plus nonzeros) per thread
+#define SPMV_VECTORS_PER_PASS   4     // dense vectors multiplied per read of the matrix
+#define SPMV_SELL_SLICE_HEIGHT  32    // rows per SELL-C-sigma slice (C)
+#define SPMV_SELL_SORT_WINDOW   1024  // rows per SELL-C-sigma sorting window (sigma)
+#define SPMV_MAX_FILL           1.25  // largest stored/nonzero element ratio for automatic ELL, SELL or BSR
+#define SPMV_SELL_MAX_ROW_SKEW  32    // largest longest/average row length ratio for automatic SELL
+#define SPMV_BSR_MAX_BLOCK      4     // largest BSR block dimension
+#define SPMV_HOST_MIN_ITEMS     4096  // fewest merge-path items per host thread
+
+// List ranking
+#define LISTRANK_CTA_SIZE             128
+#define LISTRANK_SUBLISTS_PER_THREAD  4     // GPU ruling set sublists per resident thread, for load balance
+#define LISTRANK_SUBLIST_LENGTH       1024  // longest average GPU sublist
+#define LISTRANK_MIN_SUBLIST_LENGTH   16    // shortest average sublist
+#define LISTRANK_HOST_SUBLIST_LENGTH  256   // longest average host sublist
+#define LISTRANK_HOST_INTERLEAVE      8     // sublists each host thread walks at once
+#define LISTRANK_HOST_BATCHES_PER_THREAD 4  // batches of interleaved sublists per host thread
+
+// Euler tour tree primitives
+#define TREE_CTA_SIZE                 256
+#define TREE_LCA_BLOCK_SIZE           32    // pre-order positions per LCA sparse table block
+#define TREE_HOST_MIN_CHUNK           4096  // fewest items per host thread when grouping
+#define TREE_HOST_HISTOGRAM_RATIO     8     // most host histogram counts per item when grouping
+
+// Connected components
+#define CC_CTA_SIZE                   256
+#define CC_NEIGHBOR_ROUNDS            2     // CSR neighbors of each vertex linked before sampling
+#define CC_EDGE_SAMPLE_STRIDE         8     // every 8th edge of an edge list is linked before sampling
+#define CC_NUM_SAMPLES                1024  // vertices sampled to find the largest component
+
+// Breadth-first search
+#define BFS_CTA_SIZE                  256
+#define BFS_ALPHA                     14    // pull once the frontier has over 1/14 of the unexplored edges
+#define BFS_BETA                      24    // push again once a shrinking frontier has under 1/24 of the vertices
+
+// Reduce-by-key and run-length encoding
+#define RBK_CTA_SIZE                  256
+#define RBK_ITEMS_PER_THREAD          8     // consecutive elements reduced by each GPU thread
+#define RBK_MAX_TILES                 67107840  // tiles carried by one segmented scan
+#define RBK_HOST_MIN_CHUNK            4096  // fewest elements per host thread
+
+// Unique
+#define UNIQUE_CTA_SIZE               256
+#define UNIQUE_ITEMS_PER_THREAD       8     // consecutive elements compacted by each GPU thread
+#define UNIQUE_MAX_TILES              67107840  // tiles ranked by one scan
+#define UNIQUE_HOST_MIN_CHUNK         4096  // fewest elements per host thread
+
+// Shuffle and sampling
+#define SHUFFLE_CTA_SIZE        256
+#define SHUFFLE_FEISTEL_ROUNDS  8
+
 // Huffman
 #define HUFF_THREADS_PER_BLOCK_HIST     64
 #define HUFF_WORK_PER_THREAD_HIST       512
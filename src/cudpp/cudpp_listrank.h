@@ -33,6 +33,15 @@ CUDPPResult cudppListRankDispatch(void *d_ranked_values,
                            void *d_next_indices,
                            size_t head,
                            size_t numElements,
-                           const CUDPPListRankPlan *plan);
+                           CUDPPListRankPlan *plan);
+
+extern "C"
+CUDPPResult cudppListScanDispatch(void *d_out,
+                                  const void *d_in,
+                                  void *d_next_indices,
+                                  const int *d_heads,
+                                  size_t numHeads,
+                                  size_t numElements,
+                                  CUDPPListRankPlan *plan);
 
 #endif // _CUDPP_LISTRANK_H_
\ No newline at end of file
@@ -20,10 +20,17 @@
 #include "cudpp_reduce.h"
 #include "cudpp_compress.h"
 #include "cudpp_listrank.h"
+#include "cudpp_tree.h"
+#include "cudpp_components.h"
+#include "cudpp_bfs.h"
+#include "cudpp_reduce_by_key.h"
+#include "cudpp_unique.h"
+#include "cudpp_tridiagonal.h"
 #include "cuda_util.h"
 #include <cuda_runtime_api.h>
 
 #include <assert.h>
+#include <limits.h>
 
 CUDPPResult validateOptions(CUDPPConfiguration config, size_t numElements, size_t numRows, size_t /*rowPitch*/)
 {
@@ -36,9 +43,65 @@ CUDPPResult validateOptions(CUDPPConfiguration config, size_t numElements, size_
     if (config.algorithm == CUDPP_COMPACT && numRows > 1)
         ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION; //!< @todo: add support for multi-row cudppCompact
 
+    if (config.algorithm == CUDPP_SHUFFLE) {
+        if (config.datatype == CUDPP_DATATYPE_INVALID)
+            ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+    }
+
     if (config.algorithm == CUDPP_TRIDIAGONAL) {
         if (config.datatype != CUDPP_FLOAT && config.datatype != CUDPP_DOUBLE) 
             ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        // the host solvers do not handle cyclic systems
+        if ((config.options & CUDPP_OPTION_HOST) && (config.options & CUDPP_OPTION_CYCLIC))
+            ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+    }
+
+    // The 2n arcs of an Euler tour are indexed by int
+    if (config.algorithm == CUDPP_TREE && numElements > INT_MAX / 2)
+        ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    // Vertices are indexed by int
+    if ((config.algorithm == CUDPP_CONNECTED_COMPONENTS ||
+         config.algorithm == CUDPP_BFS) && numElements > INT_MAX)
+        ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    // Reduce-by-key reduces the types and operators of segmented scan,
+    // which carries segments across tiles and limits the number of tiles;
+    // segment ranks and run lengths are unsigned int
+    if (config.algorithm == CUDPP_REDUCE_BY_KEY || config.algorithm == CUDPP_RLE)
+    {
+        if (config.algorithm == CUDPP_REDUCE_BY_KEY &&
+            (config.datatype < CUDPP_INT || config.datatype > CUDPP_ULONGLONG ||
+             config.op > CUDPP_MAX))
+            ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        if (config.datatype == CUDPP_DATATYPE_INVALID)
+            ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        if (config.options & CUDPP_OPTION_HOST)
+        {
+            if (numElements > UINT_MAX)
+                ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        }
+        else if (numElements > (size_t)RBK_MAX_TILES * RBK_ITEMS_PER_THREAD)
+            ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+    }
+
+    // Unique ranks its tiles with one scan; the hash table packs keys of
+    // up to 32 bits with an unsigned int index
+    if (config.algorithm == CUDPP_UNIQUE)
+    {
+        if (config.datatype == CUDPP_DATATYPE_INVALID)
+            ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        if ((config.options & CUDPP_OPTION_UNSORTED) &&
+            (config.datatype == CUDPP_DOUBLE || config.datatype == CUDPP_LONGLONG ||
+             config.datatype == CUDPP_ULONGLONG))
+            ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        if (config.options & CUDPP_OPTION_HOST)
+        {
+            if (numElements > UINT_MAX)
+                ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        }
+        else if (numElements > (size_t)UNIQUE_MAX_TILES * UNIQUE_ITEMS_PER_THREAD)
+            ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
     }
 
     return ret;
@@ -129,13 +192,20 @@ CUDPPResult cudppPlan(const CUDPPHandle  cudppHandle,
             break;
         }
     case CUDPP_RAND_MD5:
+    case CUDPP_RAND_PHILOX:
+    case CUDPP_RAND_THREEFRY:
         {
             plan = new CUDPPRandPlan(mgr, config, numElements);
             break;
         }
+    case CUDPP_SHUFFLE:
+        {
+            plan = new CUDPPShufflePlan(mgr, config, numElements);
+            break;
+        }
     case (CUDPP_TRIDIAGONAL):
         {
-            plan = new CUDPPTridiagonalPlan(mgr, config);
+            plan = new CUDPPTridiagonalPlan(mgr, config, numElements);
             break;
         }
     case CUDPP_REDUCE:
@@ -163,6 +233,32 @@ CUDPPResult cudppPlan(const CUDPPHandle  cudppHandle,
             plan = new CUDPPListRankPlan(mgr, config, numElements);
             break;
         }
+    case CUDPP_TREE:
+        {
+            plan = new CUDPPTreePlan(mgr, config, numElements);
+            break;
+        }
+    case CUDPP_CONNECTED_COMPONENTS:
+        {
+            plan = new CUDPPComponentsPlan(mgr, config, numElements);
+            break;
+        }
+    case CUDPP_BFS:
+        {
+            plan = new CUDPPBfsPlan(mgr, config, numElements);
+            break;
+        }
+    case CUDPP_REDUCE_BY_KEY:
+    case CUDPP_RLE:
+        {
+            plan = new CUDPPReduceByKeyPlan(mgr, config, numElements);
+            break;
+        }
+    case CUDPP_UNIQUE:
+        {
+            plan = new CUDPPUniquePlan(mgr, config, numElements);
+            break;
+        }
     default:
         return CUDPP_ERROR_ILLEGAL_CONFIGURATION; 
         break;
@@ -180,7 +276,8 @@ CUDPPResult cudppPlan(const CUDPPHandle  cudppHandle,
 /** @brief Destroy a CUDPP Plan
   *
   * Deletes the plan referred to by \a planHandle and all associated internal
-  * storage.
+  * storage.  Tridiagonal factor objects are rejected with 
+  * CUDPP_ERROR_INVALID_PLAN; see cudppDestroyTridiagonalFactor().
   * 
   * @param[in] planHandle The CUDPPHandle to the plan to be destroyed
   * @returns CUDPPResult indicating success or error condition
@@ -193,6 +290,9 @@ CUDPPResult cudppDestroyPlan(CUDPPHandle planHandle)
 
     CUDPPPlan* plan = getPlanPtrFromHandle<CUDPPPlan>(planHandle);
 
+    if (plan->m_config.algorithm == CUDPP_TRIDIAGONAL_FACTOR)
+        return CUDPP_ERROR_INVALID_PLAN;
+
     switch (plan->m_config.algorithm)
     {
     case CUDPP_SCAN:
@@ -226,10 +326,17 @@ CUDPPResult cudppDestroyPlan(CUDPPHandle planHandle)
             break;
         }
     case CUDPP_RAND_MD5:
+    case CUDPP_RAND_PHILOX:
+    case CUDPP_RAND_THREEFRY:
         {
             delete static_cast<CUDPPRandPlan*>(plan);
             break;
         }
+    case CUDPP_SHUFFLE:
+        {
+            delete static_cast<CUDPPShufflePlan*>(plan);
+            break;
+        }
     case (CUDPP_TRIDIAGONAL):
         {
             delete static_cast<CUDPPTridiagonalPlan*>(plan);
@@ -260,6 +367,32 @@ CUDPPResult cudppDestroyPlan(CUDPPHandle planHandle)
             delete static_cast<CUDPPListRankPlan*>(plan);
             break;
         }
+    case CUDPP_TREE:
+        {
+            delete static_cast<CUDPPTreePlan*>(plan);
+            break;
+        }
+    case CUDPP_CONNECTED_COMPONENTS:
+        {
+            delete static_cast<CUDPPComponentsPlan*>(plan);
+            break;
+        }
+    case CUDPP_BFS:
+        {
+            delete static_cast<CUDPPBfsPlan*>(plan);
+            break;
+        }
+    case CUDPP_REDUCE_BY_KEY:
+    case CUDPP_RLE:
+        {
+            delete static_cast<CUDPPReduceByKeyPlan*>(plan);
+            break;
+        }
+    case CUDPP_UNIQUE:
+        {
+            delete static_cast<CUDPPUniquePlan*>(plan);
+            break;
+        }
     default:
         return CUDPP_ERROR_ILLEGAL_CONFIGURATION; 
         break;
@@ -281,6 +414,37 @@ CUDPPResult cudppDestroyPlan(CUDPPHandle planHandle)
   * passed as \a numNonZeroElements. This is used to allocate internal
   * storage space at the time the sparse matrix plan is created.
   *
+  * The matrix is converted once, at creation, to the storage format that
+  * the multiply kernels read.  One of CUDPP_OPTION_SPMV_CSR (merge-path 
+  * load-balanced CSR), CUDPP_OPTION_SPMV_ELL (ELLPACK), 
+  * CUDPP_OPTION_SPMV_SELL (SELL-C-sigma) or CUDPP_OPTION_SPMV_BSR (block 
+  * sparse row) may be set in \a config.options to select the format.  If 
+  * none is set, the format is chosen from the row length statistics: BSR 
+  * for matrices made of small dense blocks, ELLPACK for matrices with 
+  * nearly equal row lengths, SELL-C-sigma for moderately varying row 
+  * lengths and CSR otherwise.  cudppSparseMatrixFormat() returns the 
+  * chosen format.
+  *
+  * If CUDPP_OPTION_SPMV_REORDER is set, the rows and columns of a square
+  * matrix are renumbered at creation with the reverse Cuthill-McKee 
+  * ordering of its symmetrized pattern, which gathers the nonzeros near 
+  * the diagonal so that neighboring rows read nearby elements of x.  The 
+  * multiplies permute x and y on the fly, so callers keep using the 
+  * original numbering; cudppSparseMatrixPermutation() returns the ordering.
+  * A matrix with fewer columns than rows is treated as square, so x must 
+  * then have one element per row; one with more columns than rows is not
+  * reordered.
+  *
+  * If CUDPP_OPTION_HOST is set, the matrix is kept in CSR in host memory 
+  * and cudppSparseMatrixVectorMultiply() and cudppSparseMatrixDenseMultiply()
+  * take host vectors: the merge path of rows plus nonzeros is split evenly
+  * over OpenMP threads, which accumulate their rows in registers.  Such a 
+  * matrix cannot be stored in another format, reordered, transposed or 
+  * multiplied by another sparse matrix.
+  *
+  * The datatype in \a config may be CUDPP_INT, CUDPP_UINT, CUDPP_FLOAT or
+  * CUDPP_DOUBLE.
+  *
   * @param[out] sparseMatrixHandle A pointer to an opaque handle to the sparse matrix object
   * @param[in]  cudppHandle A handle to an instance of the CUDPP library used for resource management
   * @param[in]  config The configuration struct specifying algorithm and options
@@ -306,8 +470,19 @@ CUDPPResult cudppSparseMatrix(const CUDPPHandle  cudppHandle,
     CUDPPPlan *sparseMatrix;
     CUDPPManager *mgr = CUDPPManager::getManagerFromHandle(cudppHandle);
 
+    // At most one storage format may be requested
+    unsigned int formats = config.options & 
+        (CUDPP_OPTION_SPMV_CSR | CUDPP_OPTION_SPMV_ELL | 
+         CUDPP_OPTION_SPMV_SELL | CUDPP_OPTION_SPMV_BSR);
+
     if ((config.algorithm != CUDPP_SPMVMULT) || 
-        (numNonZeroElements <= 0) || (numRows <= 0))
+        (config.datatype != CUDPP_INT && config.datatype != CUDPP_UINT &&
+         config.datatype != CUDPP_FLOAT && config.datatype != CUDPP_DOUBLE) ||
+        (numNonZeroElements <= 0) || (numRows <= 0) ||
+        (formats & (formats - 1)) ||
+        ((config.options & CUDPP_OPTION_HOST) && 
+         (config.options & (CUDPP_OPTION_SPMV_ELL | CUDPP_OPTION_SPMV_SELL | 
+                            CUDPP_OPTION_SPMV_BSR | CUDPP_OPTION_SPMV_REORDER))))
     {
         result = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
     }
@@ -356,6 +531,175 @@ CUDPPResult cudppDestroySparseMatrix(CUDPPHandle sparseMatrixHandle)
     return CUDPP_SUCCESS;
 }
 
+/** @brief Create a CUDPP Sparse Matrix Object holding the product of two sparse matrices
+  *
+  * Computes C = A * B, or C = A^T * B if CUDPP_OPTION_SPMV_TRANSPOSE_A is
+  * set in \a config.options, on the GPU, and returns C as a new sparse
+  * matrix that can be multiplied, updated and transposed like one created 
+  * with cudppSparseMatrix().  A^T uses the transpose cached by 
+  * cudppSparseMatrixTransposeMultiply(), building it if needed, so A^T * A
+  * needs no explicit transpose from the caller.
+  *
+  * The product is computed in a symbolic phase, which counts the products
+  * contributed by each nonzero of A with a scan, then expands them and 
+  * sorts them by row and column with the CUDPP radix sort to find the 
+  * nonzeros of C, and a numeric phase, which sums the sorted products of 
+  * each nonzero.  The sort order is kept in C, so 
+  * cudppSparseMatrixMultiplyNumeric() can recompute C for new values of A
+  * and B with the same sparsity patterns by repeating only the numeric 
+  * phase.  This keeps GPU memory of one unsigned int per product with C.
+  *
+  * \a config.algorithm must be CUDPP_SPMVMULT and \a config.datatype the
+  * datatype of A and B.  The storage format and reordering options of 
+  * \a config apply to C as in cudppSparseMatrix().  Duplicate entries of
+  * A and B are summed.  Columns of C are numbered as columns of B; C has 
+  * as many rows as A (A^T: as A has columns) and must have at least one
+  * nonzero.  The number of products, one per nonzero A(i,k) and nonzero
+  * of row k of B, must fit in an unsigned int; otherwise 
+  * CUDPP_ERROR_ILLEGAL_CONFIGURATION is returned, as it is for matrices 
+  * in host memory (CUDPP_OPTION_HOST).
+  *
+  * @param[in]  cudppHandle A handle to an instance of the CUDPP library used for resource management
+  * @param[out] sparseMatrixHandleC A pointer to an opaque handle to the product sparse matrix object
+  * @param[in]  config The configuration struct specifying algorithm, datatype and options of C
+  * @param[in]  sparseMatrixHandleA Handle to the first sparse matrix, A
+  * @param[in]  sparseMatrixHandleB Handle to the second sparse matrix, B
+  * @returns CUDPPResult indicating success or error condition
+  *
+  * @see cudppSparseMatrix, cudppSparseMatrixMultiplyNumeric
+  */
+CUDPP_DLL
+CUDPPResult cudppSparseMatrixMultiply(const CUDPPHandle  cudppHandle,
+                                      CUDPPHandle        *sparseMatrixHandleC,
+                                      CUDPPConfiguration config,
+                                      const CUDPPHandle  sparseMatrixHandleA,
+                                      const CUDPPHandle  sparseMatrixHandleB)
+{
+    *sparseMatrixHandleC = CUDPP_INVALID_HANDLE;
+
+    CUDPPManager *mgr = CUDPPManager::getManagerFromHandle(cudppHandle);
+    CUDPPSparseMatrixVectorMultiplyPlan *A = 
+        getPlanPtrFromHandle<CUDPPSparseMatrixVectorMultiplyPlan>(sparseMatrixHandleA);
+    CUDPPSparseMatrixVectorMultiplyPlan *B = 
+        getPlanPtrFromHandle<CUDPPSparseMatrixVectorMultiplyPlan>(sparseMatrixHandleB);
+
+    if (A == NULL || B == NULL)
+        return CUDPP_ERROR_INVALID_HANDLE;
+
+    if (A->m_config.algorithm != CUDPP_SPMVMULT || 
+        B->m_config.algorithm != CUDPP_SPMVMULT)
+        return CUDPP_ERROR_INVALID_PLAN;
+
+    unsigned int formats = config.options & 
+        (CUDPP_OPTION_SPMV_CSR | CUDPP_OPTION_SPMV_ELL | 
+         CUDPP_OPTION_SPMV_SELL | CUDPP_OPTION_SPMV_BSR);
+    size_t innerSize = (config.options & CUDPP_OPTION_SPMV_TRANSPOSE_A) ? 
+        A->m_numRows : A->m_numCols;
+
+    if ((config.algorithm != CUDPP_SPMVMULT) || 
+        (config.datatype != A->m_config.datatype) ||
+        (config.datatype != B->m_config.datatype) ||
+        (formats & (formats - 1)) ||
+        (innerSize > B->m_numRows) ||
+        ((config.options | A->m_config.options | B->m_config.options) & CUDPP_OPTION_HOST))
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    CUDPPSparseMatrixVectorMultiplyPlan *product = 0;
+    CUDPPResult result = cudppSparseMatrixMultiplyDispatch(&product, mgr, config, A, B);
+
+    if (result == CUDPP_SUCCESS)
+        *sparseMatrixHandleC = product->getHandle();
+    return result;
+}
+
+/** @brief Factor a batch of tridiagonal systems for repeated solves
+  *
+  * Creates a factor object for the matrices of \a numSystems tridiagonal 
+  * systems of \a systemSize equations, stored in device memory in the 
+  * layout of cudppTridiagonal().  The elimination coefficients are 
+  * computed once and stored in the object, and the input arrays are not
+  * modified and need not be kept.  cudppTridiagonalSolveFactored() then 
+  * solves the systems for any number of right hand sides with only a 
+  * forward and a backward substitution each.
+  *
+  * \a config.algorithm must be CUDPP_TRIDIAGONAL and \a config.datatype
+  * CUDPP_FLOAT or CUDPP_DOUBLE.  CUDPP_OPTION_INTERLEAVED and 
+  * CUDPP_OPTION_CYCLIC are supported as in cudppTridiagonal(), and 
+  * CUDPP_OPTION_HOST is not.  The 
+  * factorization is Gaussian elimination without pivoting, so the 
+  * matrices should be diagonally dominant or symmetric positive definite.
+  *
+  * @param[out] factorHandle A pointer to an opaque handle to the factor object
+  * @param[in]  cudppHandle A handle to an instance of the CUDPP library used for resource management
+  * @param[in]  config The configuration struct specifying algorithm, datatype and options
+  * @param[in]  d_a Lower diagonal
+  * @param[in]  d_b Main diagonal
+  * @param[in]  d_c Upper diagonal
+  * @param[in]  systemSize The size of each system
+  * @param[in]  numSystems The number of systems
+  * @returns CUDPPResult indicating success or error condition
+  */
+CUDPP_DLL
+CUDPPResult cudppTridiagonalFactor(const CUDPPHandle  cudppHandle,
+                                   CUDPPHandle        *factorHandle, 
+                                   CUDPPConfiguration config, 
+                                   const void         *d_a,
+                                   const void         *d_b,
+                                   const void         *d_c,
+                                   int                systemSize, 
+                                   int                numSystems)
+{
+    CUDPPManager *mgr = CUDPPManager::getManagerFromHandle(cudppHandle);
+
+    if ((config.algorithm != CUDPP_TRIDIAGONAL) || 
+        (config.datatype != CUDPP_FLOAT && config.datatype != CUDPP_DOUBLE) ||
+        (systemSize <= 0) || (numSystems <= 0) ||
+        (config.options & CUDPP_OPTION_HOST) ||
+        ((config.options & CUDPP_OPTION_CYCLIC) && systemSize < 3))
+    {
+        *factorHandle = CUDPP_INVALID_HANDLE;
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+    }
+
+    CUDPPPlan *factor = 
+        new CUDPPTridiagonalFactorPlan(mgr, config, d_a, d_b, d_c, 
+                                       systemSize, numSystems);
+
+    if (factor)
+    {
+        *factorHandle = factor->getHandle();
+        return CUDPP_SUCCESS;
+    }
+    else
+    {
+        return CUDPP_ERROR_UNKNOWN;
+    }
+}
+
+/** @brief Destroy a CUDPP tridiagonal factor object
+  *
+  * Deletes the factors referred to by \a factorHandle.  A null handle is
+  * rejected with CUDPP_ERROR_INVALID_HANDLE, and a handle that is not a 
+  * factor object with CUDPP_ERROR_INVALID_PLAN.
+  *
+  * @param[in] factorHandle The CUDPP tridiagonal factor object to destroy.
+  * @returns CUDPPResult indicating success or error condition
+  */
+CUDPP_DLL
+CUDPPResult cudppDestroyTridiagonalFactor(CUDPPHandle factorHandle)
+{
+    if (factorHandle == 0 || factorHandle == CUDPP_INVALID_HANDLE)
+        return CUDPP_ERROR_INVALID_HANDLE;
+
+    CUDPPTridiagonalFactorPlan* plan = 
+        getPlanPtrFromHandle<CUDPPTridiagonalFactorPlan>(factorHandle);
+    if (plan->m_config.algorithm != CUDPP_TRIDIAGONAL_FACTOR)
+        return CUDPP_ERROR_INVALID_PLAN;
+    delete plan;
+    plan = 0;
+    return CUDPP_SUCCESS;
+}
+
 /** @} */ // end Plan Interface
 /** @} */ // end publicInterface
 
@@ -601,24 +945,42 @@ CUDPPSparseMatrixVectorMultiplyPlan::CUDPPSparseMatrixVectorMultiplyPlan(CUDPPMa
                                                                          size_t             numRows
                                                                          )
 : CUDPPPlan(mgr, config, numNonZeroElements, 1, 0),
-  m_segmentedScanPlan(0),
-  m_d_prod(0),
-  m_d_flags(0),
+  m_format(CUDPP_OPTION_SPMV_CSR),
   m_d_rowFinalIndex(0),
+  m_d_carryRow(0),
+  m_d_carryValue(0),
+  m_d_sliceStart(0),
+  m_d_rowLength(0),
+  m_d_rowPermutation(0),
+  m_d_index(0),
+  m_d_A(0),
+  m_d_position(0),
+  m_d_values(0),
+  m_position(0),
+  m_d_permutation(0),
+  m_d_permutedX(0),
+  m_d_permutedY(0),
+  m_permutation(0),
+  m_transpose(0),
+  m_transposePosition(0),
+  m_d_productOffset(0),
+  m_d_productOrder(0),
+  m_d_productStart(0),
   m_rowFinalIndex(0),
   m_numRows(numRows),
-  m_numNonZeroElements(numNonZeroElements)  
+  m_numCols(0),
+  m_numNonZeroElements(numNonZeroElements),
+  m_numStoredElements(0),
+  m_numIndices(0),
+  m_sliceHeight(0),
+  m_numSlices(0),
+  m_blockSize(0),
+  m_numCarries(0),
+  m_productLeftNZElts(0),
+  m_productRightNZElts(0),
+  m_hasSharedElements(false)
 {
-    CUDPPConfiguration segScanConfig = 
-    { 
-      CUDPP_SEGMENTED_SCAN, 
-      CUDPP_ADD, 
-      config.datatype, 
-      (CUDPP_OPTION_FORWARD | CUDPP_OPTION_INCLUSIVE) 
-    };
-    m_segmentedScanPlan = new CUDPPSegmentedScanPlan(mgr, segScanConfig, m_numNonZeroElements);
-
-    // Generate an array of the indices of the last element of each row
+    // Generate an array of the indices one past the last element of each row
     // in the "flattened" version of the sparse matrix
     m_rowFinalIndex = new unsigned int [m_numRows];
     for (unsigned int i=0; i < m_numRows; ++i)
@@ -629,14 +991,13 @@ CUDPPSparseMatrixVectorMultiplyPlan::CUDPPSparseMatrixVectorMultiplyPlan(CUDPPMa
             m_rowFinalIndex[i] = (unsigned int)numNonZeroElements;
     }
 
-    allocSparseMatrixVectorMultiplyStorage(this, A, rowIndex, index);
+    allocSparseMatrixVectorMultiplyStorage(this, A, index);
 }
 
 /** @brief Sparse matrix-vector plan destructor */
 CUDPPSparseMatrixVectorMultiplyPlan::~CUDPPSparseMatrixVectorMultiplyPlan()
 {
     freeSparseMatrixVectorMultiplyStorage(this);
-    delete m_segmentedScanPlan;
     delete [] m_rowFinalIndex;
 }
 
@@ -648,22 +1009,91 @@ CUDPPSparseMatrixVectorMultiplyPlan::~CUDPPSparseMatrixVectorMultiplyPlan()
   */
 CUDPPRandPlan::CUDPPRandPlan(CUDPPManager *mgr, CUDPPConfiguration config, size_t num_elements) 
  : CUDPPPlan(mgr, config, num_elements, 1, 0),
-   m_seed(0)
+   m_seed(0),
+   m_stream(0),
+   m_offset(0),
+   m_distribution((config.datatype == CUDPP_FLOAT || 
+                   config.datatype == CUDPP_DOUBLE) ? CUDPP_RAND_UNIFORM 
+                                                    : CUDPP_RAND_BITS),
+   m_param0(0),
+   m_param1(0)
 {
     
 }
 
-/** @brief CUDPP Tridiagonal Plan Constructor
+/** @brief CUDPP Shuffle Plan Constructor
   *
   * @param[in]  mgr pointer to the CUDPPManager
   * @param[in] config The configuration struct specifying options
+  * @param[in] numElements The maximum number of elements to be shuffled
   */
-CUDPPTridiagonalPlan::CUDPPTridiagonalPlan(CUDPPManager *mgr, CUDPPConfiguration config) 
- : CUDPPPlan(mgr, config, 0, 0, 0)
+CUDPPShufflePlan::CUDPPShufflePlan(CUDPPManager *mgr, CUDPPConfiguration config, size_t numElements) 
+ : CUDPPRandPlan(mgr, config, numElements)
 {
     
 }
 
+/** @brief CUDPP Tridiagonal Plan Constructor
+  *
+  * @param[in]  mgr pointer to the CUDPPManager
+  * @param[in] config The configuration struct specifying options
+  * @param[in] numElements The maximum number of equations in one call 
+  *            (systemSize * numSystems) for which scratch storage is 
+  *            allocated up front, or 0
+  */
+CUDPPTridiagonalPlan::CUDPPTridiagonalPlan(CUDPPManager *mgr, CUDPPConfiguration config, size_t numElements) 
+ : CUDPPPlan(mgr, config, numElements, 1, 0),
+   m_d_scratch(0),
+   m_scratchElements(0)
+{
+    allocTridiagonalStorage(this);
+}
+
+/** @brief Tridiagonal plan destructor */
+CUDPPTridiagonalPlan::~CUDPPTridiagonalPlan()
+{
+    freeTridiagonalStorage(this);
+}
+
+/** @brief CUDPP Tridiagonal Factor Plan Constructor
+  *
+  * Factors the systems; see cudppTridiagonalFactor().
+  *
+  * @param[in] mgr pointer to the CUDPPManager
+  * @param[in] config The configuration struct specifying options
+  * @param[in] d_a Lower diagonal
+  * @param[in] d_b Main diagonal
+  * @param[in] d_c Upper diagonal
+  * @param[in] systemSize The size of each system
+  * @param[in] numSystems The number of systems
+  */
+CUDPPTridiagonalFactorPlan::CUDPPTridiagonalFactorPlan(CUDPPManager *mgr, 
+                                                       CUDPPConfiguration config, 
+                                                       const void *d_a, 
+                                                       const void *d_b, 
+                                                       const void *d_c,
+                                                       unsigned int systemSize, 
+                                                       unsigned int numSystems) 
+ : CUDPPPlan(mgr, config, (size_t)systemSize * numSystems, 1, 0),
+   m_systemSize(systemSize),
+   m_numSystems(numSystems),
+   m_d_lower(0),
+   m_d_inverse(0),
+   m_d_upper(0),
+   m_d_z(0),
+   m_d_cyclic(0)
+{
+    // tag the object so that plan handles are not taken for factors
+    m_config.algorithm = CUDPP_TRIDIAGONAL_FACTOR;
+    allocTridiagonalFactorStorage(this, d_a, d_b, d_c);
+}
+
+/** @brief Tridiagonal factor plan destructor */
+CUDPPTridiagonalFactorPlan::~CUDPPTridiagonalFactorPlan()
+{
+    freeTridiagonalFactorStorage(this);
+}
+
 /** @brief CUDPP Compress Plan Constructor
   *
   * @param[in] mgr pointer to the CUDPPManager
@@ -725,7 +1155,19 @@ CUDPPMtfPlan::~CUDPPMtfPlan()
   * @param[in] numElements The maximum number of elements to be ranked
   */
 CUDPPListRankPlan::CUDPPListRankPlan(CUDPPManager *mgr, CUDPPConfiguration config, size_t numElements) 
- : CUDPPPlan(mgr, config, numElements, 1, 0)
+ : CUDPPPlan(mgr, config, numElements, 1, 0),
+   m_d_next(0),
+   m_d_numHeads(0),
+   m_d_sublistHead(0),
+   m_d_sublistSuccessor(0),
+   m_d_sublistLength(0),
+   m_d_sublistOffset(0),
+   m_numSublists(0),
+   m_sublistHead(0),
+   m_sublistNext(0),
+   m_sublistSuccessor(0),
+   m_sublistLength(0),
+   m_sublistOffset(0)
 {
     allocListRankStorage(this);
 }
@@ -735,3 +1177,248 @@ CUDPPListRankPlan::~CUDPPListRankPlan()
 {
     freeListRankStorage(this);
 }
+
+/** @brief CUDPP Tree Plan Constructor
+  *
+  * The tour is scanned by a list ranking plan with the same backend, and
+  * on the GPU children are grouped by a radix sort plan; both hold the
+  * 2n arcs of a forest of \a numElements nodes.
+  *
+  * @param[in] mgr pointer to the CUDPPManager
+  * @param[in] config The configuration struct specifying options
+  * @param[in] numElements The maximum number of nodes of a forest
+  */
+CUDPPTreePlan::CUDPPTreePlan(CUDPPManager *mgr, CUDPPConfiguration config, size_t numElements) 
+ : CUDPPPlan(mgr, config, numElements, 1, 0),
+   m_sortPlan(0),
+   m_scanPlan(0),
+   m_numNodes(0),
+   m_lcaBlocks(0),
+   m_d_parent(0),
+   m_d_firstChild(0),
+   m_d_nextSibling(0),
+   m_d_nodeAtPre(0),
+   m_d_tourNext(0),
+   m_d_tourValue(0),
+   m_d_tourPrefix(0),
+   m_d_lcaTable(0)
+{
+    CUDPPConfiguration scanConfig = 
+    { 
+      CUDPP_LISTRANK, 
+      CUDPP_ADD, 
+      CUDPP_ULONGLONG, 
+      CUDPP_OPTION_EXCLUSIVE | (config.options & CUDPP_OPTION_HOST)
+    };
+    m_scanPlan = new CUDPPListRankPlan(mgr, scanConfig, 2 * numElements);
+
+    if (!(config.options & CUDPP_OPTION_HOST))
+    {
+        CUDPPConfiguration sortConfig = 
+        { 
+          CUDPP_SORT_RADIX, 
+          CUDPP_ADD, 
+          CUDPP_UINT, 
+          CUDPP_OPTION_KEY_VALUE_PAIRS 
+        };
+        m_sortPlan = new CUDPPRadixSortPlan(mgr, sortConfig, 2 * numElements);
+    }
+
+    allocTreeStorage(this);
+}
+
+/** @brief Tree plan destructor */
+CUDPPTreePlan::~CUDPPTreePlan()
+{
+    delete m_scanPlan;
+    delete m_sortPlan;
+    freeTreeStorage(this);
+}
+
+/** @brief CUDPP Connected Components Plan Constructor
+  *
+  * On the GPU the roots are ranked by an exclusive unsigned int scan plan
+  * of \a numElements elements; the host backend needs no sub-plan.
+  *
+  * @param[in] mgr pointer to the CUDPPManager
+  * @param[in] config The configuration struct specifying options
+  * @param[in] numElements The maximum number of vertices of a graph
+  */
+CUDPPComponentsPlan::CUDPPComponentsPlan(CUDPPManager *mgr, CUDPPConfiguration config, size_t numElements) 
+ : CUDPPPlan(mgr, config, numElements, 1, 0),
+   m_scanPlan(0),
+   m_d_parent(0),
+   m_d_rootRank(0),
+   m_d_samples(0)
+{
+    if (!(config.options & CUDPP_OPTION_HOST))
+    {
+        CUDPPConfiguration scanConfig = 
+        { 
+          CUDPP_SCAN, 
+          CUDPP_ADD, 
+          CUDPP_UINT, 
+          CUDPP_OPTION_FORWARD | CUDPP_OPTION_EXCLUSIVE 
+        };
+        m_scanPlan = new CUDPPScanPlan(mgr, scanConfig, numElements, 1, 0);
+    }
+
+    allocComponentsStorage(this);
+}
+
+/** @brief Connected components plan destructor */
+CUDPPComponentsPlan::~CUDPPComponentsPlan()
+{
+    delete m_scanPlan;
+    freeComponentsStorage(this);
+}
+
+/** @brief CUDPP Breadth-First Search Plan Constructor
+  *
+  * On the GPU the frontier degrees, and the flags of a frontier bitmap
+  * being compacted, are scanned by an exclusive unsigned int scan plan of
+  * \a numElements elements; the host backend needs no sub-plan.
+  *
+  * @param[in] mgr pointer to the CUDPPManager
+  * @param[in] config The configuration struct specifying options
+  * @param[in] numElements The maximum number of vertices of a graph
+  */
+CUDPPBfsPlan::CUDPPBfsPlan(CUDPPManager *mgr, CUDPPConfiguration config, size_t numElements) 
+ : CUDPPPlan(mgr, config, numElements, 1, 0),
+   m_scanPlan(0),
+   m_d_queue(0),
+   m_d_nextQueue(0),
+   m_d_degrees(0),
+   m_d_offsets(0),
+   m_d_visited(0),
+   m_d_frontierBits(0),
+   m_d_nextBits(0),
+   m_d_counters(0)
+{
+    if (!(config.options & CUDPP_OPTION_HOST))
+    {
+        CUDPPConfiguration scanConfig = 
+        { 
+          CUDPP_SCAN, 
+          CUDPP_ADD, 
+          CUDPP_UINT, 
+          CUDPP_OPTION_FORWARD | CUDPP_OPTION_EXCLUSIVE 
+        };
+        m_scanPlan = new CUDPPScanPlan(mgr, scanConfig, numElements, 1, 0);
+    }
+
+    allocBfsStorage(this);
+}
+
+/** @brief Breadth-first search plan destructor */
+CUDPPBfsPlan::~CUDPPBfsPlan()
+{
+    delete m_scanPlan;
+    freeBfsStorage(this);
+}
+
+/** @brief CUDPP Reduce-By-Key Plan Constructor
+  *
+  * Serves both CUDPP_REDUCE_BY_KEY and CUDPP_RLE.  On the GPU the head
+  * counts of the tiles of RBK_ITEMS_PER_THREAD elements are ranked by an
+  * exclusive unsigned int scan plan, and their tails are carried by an
+  * inclusive segmented scan plan with the configuration's operator and
+  * datatype (unsigned int addition for run lengths).  The host backend
+  * needs no sub-plans.
+  *
+  * @param[in] mgr pointer to the CUDPPManager
+  * @param[in] config The configuration struct specifying options
+  * @param[in] numElements The maximum number of elements
+  */
+CUDPPReduceByKeyPlan::CUDPPReduceByKeyPlan(CUDPPManager *mgr, CUDPPConfiguration config, size_t numElements) 
+ : CUDPPPlan(mgr, config, numElements, 1, 0),
+   m_scanPlan(0),
+   m_segmentedScanPlan(0),
+   m_d_tileCount(0),
+   m_d_tileFlag(0),
+   m_d_tileOffset(0),
+   m_d_tileTail(0),
+   m_d_tileCarry(0)
+{
+    if (!(config.options & CUDPP_OPTION_HOST))
+    {
+        size_t numTiles = (numElements + RBK_ITEMS_PER_THREAD - 1) / RBK_ITEMS_PER_THREAD;
+
+        CUDPPConfiguration scanConfig = 
+        { 
+          CUDPP_SCAN, 
+          CUDPP_ADD, 
+          CUDPP_UINT, 
+          CUDPP_OPTION_FORWARD | CUDPP_OPTION_EXCLUSIVE 
+        };
+        m_scanPlan = new CUDPPScanPlan(mgr, scanConfig, numTiles, 1, 0);
+
+        CUDPPConfiguration segScanConfig = 
+        { 
+          CUDPP_SEGMENTED_SCAN, 
+          config.op, 
+          config.datatype, 
+          CUDPP_OPTION_FORWARD | CUDPP_OPTION_INCLUSIVE 
+        };
+        if (config.algorithm == CUDPP_RLE)
+        {
+            segScanConfig.op = CUDPP_ADD;
+            segScanConfig.datatype = CUDPP_UINT;
+        }
+        m_segmentedScanPlan = new CUDPPSegmentedScanPlan(mgr, segScanConfig, numTiles);
+    }
+
+    allocReduceByKeyStorage(this);
+}
+
+/** @brief Reduce-by-key plan destructor */
+CUDPPReduceByKeyPlan::~CUDPPReduceByKeyPlan()
+{
+    delete m_scanPlan;
+    delete m_segmentedScanPlan;
+    freeReduceByKeyStorage(this);
+}
+
+/** @brief CUDPP Unique Plan Constructor
+  *
+  * On the GPU the kept elements of the tiles of UNIQUE_ITEMS_PER_THREAD
+  * elements are ranked by an exclusive unsigned int scan plan.  The host
+  * backend needs no sub-plans.
+  *
+  * @param[in] mgr pointer to the CUDPPManager
+  * @param[in] config The configuration struct specifying options
+  * @param[in] numElements The maximum number of elements
+  */
+CUDPPUniquePlan::CUDPPUniquePlan(CUDPPManager *mgr, CUDPPConfiguration config, size_t numElements) 
+ : CUDPPPlan(mgr, config, numElements, 1, 0),
+   m_scanPlan(0),
+   m_tableSize(0),
+   m_d_tileCount(0),
+   m_d_tileOffset(0),
+   m_d_tempKeys(0),
+   m_d_tempValues(0),
+   m_d_table(0)
+{
+    if (!(config.options & CUDPP_OPTION_HOST))
+    {
+        size_t numTiles = (numElements + UNIQUE_ITEMS_PER_THREAD - 1) / UNIQUE_ITEMS_PER_THREAD;
+
+        CUDPPConfiguration scanConfig = 
+        { 
+          CUDPP_SCAN, 
+          CUDPP_ADD, 
+          CUDPP_UINT, 
+          CUDPP_OPTION_FORWARD | CUDPP_OPTION_EXCLUSIVE 
+        };
+        m_scanPlan = new CUDPPScanPlan(mgr, scanConfig, numTiles, 1, 0);
+    }
+
+    allocUniqueStorage(this);
+}
+
+/** @brief Unique plan destructor */
+CUDPPUniquePlan::~CUDPPUniquePlan()
+{
+    delete m_scanPlan;
+    freeUniqueStorage(this);
+}
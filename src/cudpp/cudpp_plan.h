@@ -16,6 +16,11 @@ class CUDPPManager;
 
 #include "cudpp.h"
 
+//! @internal Algorithm of CUDPPTridiagonalFactorPlan objects, outside 
+//! CUDPPAlgorithm so that plan and factor handles are told apart
+const CUDPPAlgorithm CUDPP_TRIDIAGONAL_FACTOR = 
+    CUDPPAlgorithm(CUDPP_ALGORITHM_INVALID + 1);
+
 //! @internal Convert an opaque handle to a pointer to a plan
 template <typename T>
 T* getPlanPtrFromHandle(CUDPPHandle handle)
@@ -216,22 +221,46 @@ public:
                                         const unsigned int *indx, size_t numRows);
     virtual ~CUDPPSparseMatrixVectorMultiplyPlan();
 
-    CUDPPSegmentedScanPlan *m_segmentedScanPlan; //!< @internal Performs a segmented scan of type T using this plan
-    void             *m_d_prod;  //!< @internal Vector of products (of an element in A and its corresponding (thats is
-                                 //!            belongs to the same row) element in x; this is the input and output of 
-                                 //!            segmented scan
-    unsigned int     *m_d_flags; //!< @internal Vector of flags where a flag is set if an element of A is the first element
-                                 //!            of its row; this is the flags vector for segmented scan
-    unsigned int     *m_d_rowFinalIndex; //!< @internal Vector of row end indices, which for each row specifies an index in A
-                                         //!            which is the last element of that row. Resides in GPU memory. 
-    unsigned int     *m_d_rowIndex; //!< @internal Vector of row end indices, which for each row specifies an index in A
-                                    //!            which is the first element of that row. Resides in GPU memory. 
-    unsigned int     *m_d_index;    //!<@internal Vector of column numbers one for each element in A 
-    void             *m_d_A;        //!<@internal The A matrix 
-    unsigned int     *m_rowFinalIndex; //!< @internal Vector of row end indices, which for each row specifies an index in A
-                                       //!            which is the last element of that row. Resides in CPU memory.
+    CUDPPOption      m_format; //!< @internal Storage format of A: CUDPP_OPTION_SPMV_CSR, _ELL, _SELL or _BSR
+    unsigned int     *m_d_rowFinalIndex; //!< @internal Vector of row end indices, which for each row specifies the index in A
+                                         //!            one past the last element of that row (CSR), or of each block
+                                         //!            row the index of its last block plus one (BSR). Resides in GPU memory. 
+    unsigned int     *m_d_carryRow;   //!< @internal Row of the partial sum each merge-path tile stops in (CSR)
+    void             *m_d_carryValue; //!< @internal Partial sum of the row each merge-path tile stops in (CSR)
+    unsigned int     *m_d_sliceStart; //!< @internal Index in A of the first element of each slice (ELL, SELL)
+    unsigned int     *m_d_rowLength;  //!< @internal Number of nonzeros of the row at each sorted position (ELL, SELL)
+    unsigned int     *m_d_rowPermutation; //!< @internal Row at each sorted position (SELL)
+    unsigned int     *m_d_index;    //!<@internal Vector of column numbers one for each element in A, or of block
+                                    //!           column numbers one for each block (BSR)
+    void             *m_d_A;        //!<@internal The A matrix in the storage format
+    unsigned int     *m_d_position; //!< @internal GPU copy of m_position, allocated by the first value update
+    void             *m_d_values;   //!< @internal Staging array for new values of A in CSR order, allocated by the first value update
+    unsigned int     *m_position;   //!< @internal Index in m_d_A of each nonzero in CSR order (NULL for CSR). Resides in CPU memory.
+    unsigned int     *m_d_permutation; //!< @internal GPU copy of m_permutation (reordered matrices)
+    void             *m_d_permutedX; //!< @internal SPMV_VECTORS_PER_PASS vectors of x in the reordered numbering
+    void             *m_d_permutedY; //!< @internal SPMV_VECTORS_PER_PASS vectors of y in the reordered numbering
+    unsigned int     *m_permutation; //!< @internal Original row and column of each reordered one, or NULL if not reordered.
+                                     //!            Resides in CPU memory.
+    CUDPPSparseMatrixVectorMultiplyPlan *m_transpose; //!< @internal The transpose of A, built by the first transposed multiply
+    unsigned int     *m_transposePosition; //!< @internal Index in the transpose of each nonzero in CSR order. Resides in CPU memory.
+    unsigned int     *m_d_productOffset; //!< @internal For a product L * R: index of the first product of each nonzero of L
+    unsigned int     *m_d_productOrder; //!< @internal For a product: the product at each position sorted by row and column
+    unsigned int     *m_d_productStart; //!< @internal For a product: the first sorted product of each nonzero, and the 
+                                        //!            number of products
+    unsigned int     *m_rowFinalIndex; //!< @internal Vector of row end indices, which for each row specifies the index in A
+                                       //!            one past the last element of that row. Resides in CPU memory.
     size_t           m_numRows; //!< Number of rows
+    size_t           m_numCols; //!< @internal Number of columns (largest column index plus one)
     size_t           m_numNonZeroElements; //!<Number of non-zero elements
+    size_t           m_numStoredElements; //!< @internal Number of elements of A in the storage format, including padding
+    size_t           m_numIndices; //!< @internal Number of elements of m_d_index
+    size_t           m_sliceHeight; //!< @internal Rows per slice (ELL, SELL)
+    size_t           m_numSlices; //!< @internal Number of slices (ELL, SELL)
+    size_t           m_blockSize; //!< @internal Block dimension (BSR)
+    size_t           m_numCarries; //!< @internal Number of merge-path tiles, one carry-out each (CSR)
+    size_t           m_productLeftNZElts; //!< @internal For a product: number of nonzeros of the first operand
+    size_t           m_productRightNZElts; //!< @internal For a product: number of nonzeros of the second operand
+    bool             m_hasSharedElements; //!< @internal Whether several nonzeros map to the same element of m_d_A
 };
 
 /** @brief Plan class for random number generator
@@ -243,6 +272,23 @@ public:
     CUDPPRandPlan(CUDPPManager *mgr, CUDPPConfiguration config, size_t num_elements);
 
     unsigned int m_seed; //!< @internal the seed for the random number generator
+    unsigned int m_stream; //!< @internal the substream (second key word) of the counter-based generators
+    unsigned long long m_offset; //!< @internal position in the sequence of the next element generated by the counter-based generators
+    CUDPPRandDistribution m_distribution; //!< @internal output distribution of the counter-based generators
+    double m_param0; //!< @internal first distribution parameter
+    double m_param1; //!< @internal second distribution parameter
+};
+
+/** @brief Plan class for random permutation and sampling
+*
+* Shares the seed, stream and position of CUDPPRandPlan, so cudppRandSeed(),
+* cudppRandStream() and cudppRandSkipAhead() also apply to shuffle plans.
+* The position counts shuffle and sample calls.
+*/
+class CUDPPShufflePlan : public CUDPPRandPlan
+{
+public:
+    CUDPPShufflePlan(CUDPPManager *mgr, CUDPPConfiguration config, size_t numElements);
 };
 
 /** @brief Plan class for tridiagonal solver
@@ -251,7 +297,31 @@ public:
 class CUDPPTridiagonalPlan : public CUDPPPlan
 {
 public:
-    CUDPPTridiagonalPlan(CUDPPManager *mgr, CUDPPConfiguration config);
+    CUDPPTridiagonalPlan(CUDPPManager *mgr, CUDPPConfiguration config, size_t numElements);
+    virtual ~CUDPPTridiagonalPlan();
+
+    void *m_d_scratch;        //!< @internal Solver scratch allocated at plan time
+    size_t m_scratchElements; //!< @internal Number of elements of m_d_scratch
+};
+
+/** @brief Plan class for a factored batch of tridiagonal systems
+*
+*/
+class CUDPPTridiagonalFactorPlan : public CUDPPPlan
+{
+public:
+    CUDPPTridiagonalFactorPlan(CUDPPManager *mgr, CUDPPConfiguration config, 
+                               const void *d_a, const void *d_b, const void *d_c,
+                               unsigned int systemSize, unsigned int numSystems);
+    virtual ~CUDPPTridiagonalFactorPlan();
+
+    unsigned int m_systemSize; //!< @internal The size of each system
+    unsigned int m_numSystems; //!< @internal The number of systems
+    void *m_d_lower;   //!< @internal Lower diagonal, with a[0] = 0
+    void *m_d_inverse; //!< @internal Inverses of the eliminated pivots
+    void *m_d_upper;   //!< @internal Modified upper diagonal
+    void *m_d_z;       //!< @internal Sherman-Morrison correction (cyclic systems)
+    void *m_d_cyclic;  //!< @internal Sherman-Morrison coefficients (cyclic systems)
 };
 
 /** @brief Plan class for compressor
@@ -347,10 +417,128 @@ public:
     CUDPPListRankPlan(CUDPPManager *mgr, CUDPPConfiguration config, size_t numElements);
     virtual ~CUDPPListRankPlan();
 
-    // Intermediate buffers used during list ranking
-    int *m_d_tmp1; //!< @internal temporary next indices array
-    int *m_d_tmp2; //!< @internal temporary start indices array
-    int *m_d_tmp3; //!< @internal temporary next indices array
+    // Intermediate buffers used during list ranking on the GPU.  List
+    // scans keep the sublist reductions and carries in the length arrays
+    // and the flags of the sublists reached from a list head in the
+    // successor arrays.
+    int    *m_d_next;             //!< @internal Next indices with the sublist heads marked
+    unsigned int *m_d_numHeads;   //!< @internal Number of list heads found by a list scan
+    int    *m_d_sublistHead;      //!< @internal First node of each sublist
+    int    *m_d_sublistSuccessor; //!< @internal Sublist that follows each sublist, -1 for the last
+    size_t *m_d_sublistLength;    //!< @internal Number of nodes of each sublist
+    size_t *m_d_sublistOffset;    //!< @internal Rank of the head of each sublist
+
+    // Sublist arrays of the ruling set in host memory; the GPU path only
+    // uses the successors, lengths and offsets, to rank the sublist heads
+    size_t m_numSublists;     //!< @internal Maximum number of sublists
+    int    *m_sublistHead;    //!< @internal First node of each sublist (CUDPP_OPTION_HOST)
+    int    *m_sublistNext;    //!< @internal Saved next index of each sublist head (CUDPP_OPTION_HOST)
+    int    *m_sublistSuccessor; //!< @internal Sublist that follows each sublist, -1 for the last
+    size_t *m_sublistLength;  //!< @internal Number of nodes of each sublist
+    size_t *m_sublistOffset;  //!< @internal Rank of the head of each sublist
+
+    CUDPPListRankStats m_stats; //!< @internal Work decomposition of the most recent ranking or scan
+};
+
+/** @brief Plan class for Euler tour tree primitives
+*
+*/
+class CUDPPTreePlan : public CUDPPPlan
+{
+public:
+    CUDPPTreePlan(CUDPPManager *mgr, CUDPPConfiguration config, size_t numElements);
+    virtual ~CUDPPTreePlan();
+
+    CUDPPRadixSortPlan *m_sortPlan; //!< @internal Groups children by parent and arcs by node (GPU only)
+    CUDPPListRankPlan  *m_scanPlan; //!< @internal Scans the Euler tour (unsigned long long add, exclusive)
+
+    // Arrays in device memory, or in host memory with CUDPP_OPTION_HOST.
+    // A forest of n nodes has 2n tour arcs: v enters node v, n + v leaves it.
+    size_t m_numNodes;              //!< @internal Number of nodes of the most recently built forest
+    size_t m_lcaBlocks;             //!< @internal Number of blocks of pre-order positions in the LCA table
+    int    *m_d_parent;             //!< @internal Parent of each node, -1 for roots
+    int    *m_d_firstChild;         //!< @internal First child of each node, then first root
+    int    *m_d_nextSibling;        //!< @internal Next child of the same parent
+    int    *m_d_nodeAtPre;          //!< @internal Node at each pre-order position
+    int    *m_d_tourNext;           //!< @internal Next arc of each arc
+    unsigned long long *m_d_tourValue;  //!< @internal Value of each arc
+    unsigned long long *m_d_tourPrefix; //!< @internal Exclusive prefix of each arc; sort keys and order before the scan
+    int    *m_d_lcaTable;           //!< @internal Sparse table of the shallowest pre-order position of block ranges
+};
+
+/** @brief Plan class for connected components
+*
+*/
+class CUDPPComponentsPlan : public CUDPPPlan
+{
+public:
+    CUDPPComponentsPlan(CUDPPManager *mgr, CUDPPConfiguration config, size_t numElements);
+    virtual ~CUDPPComponentsPlan();
+
+    CUDPPScanPlan *m_scanPlan;      //!< @internal Ranks the roots to give dense labels (GPU only)
+
+    int           *m_d_parent;      //!< @internal Union-find parent of each vertex (host memory with CUDPP_OPTION_HOST)
+    unsigned int  *m_d_rootRank;    //!< @internal Exclusive scan of the root flags (GPU only)
+    int           *m_d_samples;     //!< @internal Roots of the sampled vertices (GPU only)
+};
+
+/** @brief Plan class for breadth-first search
+*
+*/
+class CUDPPBfsPlan : public CUDPPPlan
+{
+public:
+    CUDPPBfsPlan(CUDPPManager *mgr, CUDPPConfiguration config, size_t numElements);
+    virtual ~CUDPPBfsPlan();
+
+    CUDPPScanPlan *m_scanPlan;          //!< @internal Scans frontier degrees and bitmap flags (GPU only)
+
+    int           *m_d_queue;           //!< @internal Frontier of a push level (host memory with CUDPP_OPTION_HOST)
+    int           *m_d_nextQueue;       //!< @internal Next frontier of a push level
+    unsigned int  *m_d_degrees;         //!< @internal Frontier degrees or bitmap flags (GPU only)
+    unsigned int  *m_d_offsets;         //!< @internal Exclusive scan of m_d_degrees (GPU only)
+    unsigned int  *m_d_visited;         //!< @internal Visited bitmap
+    unsigned int  *m_d_frontierBits;    //!< @internal Frontier bitmap of a pull level
+    unsigned int  *m_d_nextBits;        //!< @internal Next frontier bitmap of a pull level
+    unsigned int  *m_d_counters;        //!< @internal Sizes of the next queue and bitmap (GPU only)
+};
+
+/** @brief Plan class for reduce-by-key and run-length encoding
+*
+*/
+class CUDPPReduceByKeyPlan : public CUDPPPlan
+{
+public:
+    CUDPPReduceByKeyPlan(CUDPPManager *mgr, CUDPPConfiguration config, size_t numElements);
+    virtual ~CUDPPReduceByKeyPlan();
+
+    CUDPPScanPlan          *m_scanPlan;          //!< @internal Ranks the first segment of each tile (GPU only)
+    CUDPPSegmentedScanPlan *m_segmentedScanPlan; //!< @internal Carries segments across tiles (GPU only)
+
+    unsigned int  *m_d_tileCount;       //!< @internal Number of segment heads in each tile
+    unsigned int  *m_d_tileFlag;        //!< @internal Whether each tile has a head
+    unsigned int  *m_d_tileOffset;      //!< @internal Exclusive scan of m_d_tileCount
+    void          *m_d_tileTail;        //!< @internal Reduction after the last head of each tile
+    void          *m_d_tileCarry;       //!< @internal Inclusive segmented scan of m_d_tileTail
+};
+
+/** @brief Plan class for unique
+*
+*/
+class CUDPPUniquePlan : public CUDPPPlan
+{
+public:
+    CUDPPUniquePlan(CUDPPManager *mgr, CUDPPConfiguration config, size_t numElements);
+    virtual ~CUDPPUniquePlan();
+
+    CUDPPScanPlan *m_scanPlan;          //!< @internal Ranks the first kept element of each tile (GPU only)
+    size_t        m_tableSize;          //!< @internal Number of hash table slots (CUDPP_OPTION_UNSORTED)
+
+    unsigned int  *m_d_tileCount;       //!< @internal Number of kept elements in each tile
+    unsigned int  *m_d_tileOffset;      //!< @internal Exclusive scan of m_d_tileCount
+    void          *m_d_tempKeys;        //!< @internal Kept keys of an in-place call
+    unsigned int  *m_d_tempValues;      //!< @internal Kept values of an in-place call
+    unsigned long long *m_d_table;      //!< @internal Key and first index of each slot (CUDPP_OPTION_UNSORTED)
 };
 
 #endif // __CUDPP_PLAN_H__
@@ -0,0 +1,45 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// ------------------------------------------------------------- 
+// This source code is distributed under the terms of license.txt in
+// the root directory of this source distribution.
+// ------------------------------------------------------------- 
+
+/**
+* @file
+* cudpp_reduce_by_key.h
+*
+* @brief Reduce-by-key and run-length encoding functionality header file -
+* contains CUDPP interface (not public)
+*/
+
+#ifndef __CUDPP_REDUCE_BY_KEY_H__
+#define __CUDPP_REDUCE_BY_KEY_H__
+
+class CUDPPReduceByKeyPlan;
+
+extern "C"
+void allocReduceByKeyStorage(CUDPPReduceByKeyPlan *plan);
+
+extern "C"
+void freeReduceByKeyStorage(CUDPPReduceByKeyPlan *plan);
+
+extern "C"
+size_t cudppReduceByKeyDispatch(const CUDPPReduceByKeyPlan *plan,
+                                unsigned int               *d_keysOut,
+                                void                       *d_valuesOut,
+                                const unsigned int         *d_keys,
+                                const void                 *d_values,
+                                size_t                     numElements);
+
+extern "C"
+size_t cudppRLEDispatch(const CUDPPReduceByKeyPlan *plan,
+                        void                       *d_runValues,
+                        unsigned int               *d_runLengths,
+                        const void                 *d_in,
+                        size_t                     numElements);
+
+#endif // __CUDPP_REDUCE_BY_KEY_H__
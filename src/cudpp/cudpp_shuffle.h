@@ -0,0 +1,34 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// ------------------------------------------------------------- 
+// This source code is distributed under the terms of license.txt in
+// the root directory of this source distribution.
+// ------------------------------------------------------------- 
+
+/**
+* @file
+* cudpp_shuffle.h
+*
+* @brief Shuffle and sampling functionality header file - contains CUDPP 
+* interface (not public)
+*/
+
+#ifndef __CUDPP_SHUFFLE_H__
+#define __CUDPP_SHUFFLE_H__
+
+class CUDPPShufflePlan;
+
+extern "C"
+void cudppShuffleDispatch(void                   *d_keysOut,
+                          unsigned int           *d_valuesOut,
+                          const void             *d_keysIn,
+                          const unsigned int     *d_valuesIn,
+                          size_t                 numOutputs,
+                          size_t                 numElements,
+                          bool                   withReplacement,
+                          const CUDPPShufflePlan *plan);
+
+#endif // __CUDPP_SHUFFLE_H__
@@ -19,11 +19,11 @@
 #define _CUDPP_SPMVMULT_H_
 
 class CUDPPSparseMatrixVectorMultiplyPlan;
+class CUDPPManager;
 
 extern "C"
 void allocSparseMatrixVectorMultiplyStorage(CUDPPSparseMatrixVectorMultiplyPlan *plan,
                                             const void                          *A,
-                                            const unsigned int                  *rowindx,
                                             const unsigned int                  *indx);
 
 extern "C"
@@ -32,6 +32,37 @@ void freeSparseMatrixVectorMultiplyStorage(CUDPPSparseMatrixVectorMultiplyPlan *
 extern "C"
 void cudppSparseMatrixVectorMultiplyDispatch(void                                      *d_y,
                                              const void                                *d_x,
+                                             size_t                                    numVectors,
+                                             size_t                                    yPitch,
+                                             size_t                                    xPitch,
+                                             const void                                *alpha,
+                                             const void                                *beta,
                                              const CUDPPSparseMatrixVectorMultiplyPlan *plan);
 
+extern "C"
+void cudppSparseMatrixTransposeMultiplyDispatch(void                                *d_y,
+                                                const void                          *d_x,
+                                                size_t                              numVectors,
+                                                size_t                              yPitch,
+                                                size_t                              xPitch,
+                                                const void                          *alpha,
+                                                const void                          *beta,
+                                                CUDPPSparseMatrixVectorMultiplyPlan *plan);
+
+extern "C"
+void cudppSparseMatrixUpdateValuesDispatch(CUDPPSparseMatrixVectorMultiplyPlan *plan,
+                                           const void                          *A);
+
+extern "C"
+CUDPPResult cudppSparseMatrixMultiplyDispatch(CUDPPSparseMatrixVectorMultiplyPlan **product,
+                                              CUDPPManager                        *mgr,
+                                              CUDPPConfiguration                  config,
+                                              CUDPPSparseMatrixVectorMultiplyPlan *A,
+                                              CUDPPSparseMatrixVectorMultiplyPlan *B);
+
+extern "C"
+void cudppSparseMatrixMultiplyNumericDispatch(CUDPPSparseMatrixVectorMultiplyPlan *product,
+                                              CUDPPSparseMatrixVectorMultiplyPlan *A,
+                                              CUDPPSparseMatrixVectorMultiplyPlan *B);
+
 #endif // _CUDPP_SPMVMULT_H_
@@ -0,0 +1,57 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// ------------------------------------------------------------- 
+// This source code is distributed under the terms of license.txt in
+// the root directory of this source distribution.
+// ------------------------------------------------------------- 
+
+/**
+* @file
+* cudpp_tree.h
+*
+* @brief Euler tour tree functionality header file - contains CUDPP 
+* interface (not public)
+*/
+
+#ifndef __CUDPP_TREE_H__
+#define __CUDPP_TREE_H__
+
+class CUDPPTreePlan;
+
+extern "C"
+void allocTreeStorage(CUDPPTreePlan *plan);
+
+extern "C"
+void freeTreeStorage(CUDPPTreePlan *plan);
+
+extern "C"
+CUDPPResult cudppTreeFromParentsDispatch(CUDPPTreePlan *plan,
+                                         const int     *d_parent,
+                                         size_t        numNodes);
+
+extern "C"
+CUDPPResult cudppTreeFromEdgesDispatch(CUDPPTreePlan *plan,
+                                       int           *d_parent,
+                                       const int     *d_edgeU,
+                                       const int     *d_edgeV,
+                                       size_t        numNodes,
+                                       int           root);
+
+extern "C"
+void cudppTreeOrderDispatch(const CUDPPTreePlan *plan,
+                            int                 *d_preorder,
+                            int                 *d_postorder,
+                            int                 *d_depth,
+                            int                 *d_subtreeSize);
+
+extern "C"
+void cudppTreeLCADispatch(const CUDPPTreePlan *plan,
+                          int                 *d_lca,
+                          const int           *d_u,
+                          const int           *d_v,
+                          size_t              numQueries);
+
+#endif // __CUDPP_TREE_H__
@@ -22,6 +22,17 @@
 #include "cudpp.h"
 #include "cudpp_plan.h"
 
+void allocTridiagonalStorage(CUDPPTridiagonalPlan *plan);
+
+void freeTridiagonalStorage(CUDPPTridiagonalPlan *plan);
+
+void allocTridiagonalFactorStorage(CUDPPTridiagonalFactorPlan *plan,
+                                   const void *d_a, 
+                                   const void *d_b, 
+                                   const void *d_c);
+
+void freeTridiagonalFactorStorage(CUDPPTridiagonalFactorPlan *plan);
+
 CUDPPResult cudppTridiagonalDispatch(void *d_a, 
                                      void *d_b, 
                                      void *d_c, 
@@ -31,4 +42,41 @@ CUDPPResult cudppTridiagonalDispatch(void *d_a,
                                      int numSystems, 
                                      const CUDPPTridiagonalPlan * plan);
 
+CUDPPResult cudppTridiagonalStridedDispatch(void *d_a, 
+                                            void *d_b, 
+                                            void *d_c, 
+                                            void *d_d, 
+                                            void *d_x, 
+                                            int systemSize, 
+                                            int numSystems, 
+                                            size_t elementStride,
+                                            size_t systemStride,
+                                            const CUDPPTridiagonalPlan * plan);
+
+CUDPPResult cudppPentadiagonalDispatch(const void *d_e, 
+                                       const void *d_a, 
+                                       const void *d_b, 
+                                       const void *d_c, 
+                                       const void *d_f, 
+                                       const void *d_d, 
+                                       void *d_x, 
+                                       int systemSize, 
+                                       int numSystems, 
+                                       const CUDPPTridiagonalPlan * plan);
+
+CUDPPResult cudppBlockTridiagonalDispatch(const void *d_a, 
+                                          const void *d_b, 
+                                          const void *d_c, 
+                                          const void *d_d, 
+                                          void *d_x, 
+                                          int blockSize,
+                                          int systemSize, 
+                                          int numSystems, 
+                                          const CUDPPTridiagonalPlan * plan);
+
+CUDPPResult cudppTridiagonalSolveFactoredDispatch(const void *d_d, 
+                                                  void *d_x, 
+                                                  int numRHS,
+                                                  const CUDPPTridiagonalFactorPlan *plan);
+
 #endif //__CUDPP_TRIDIAGONAL_H__
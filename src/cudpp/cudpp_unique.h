@@ -0,0 +1,37 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// ------------------------------------------------------------- 
+// This source code is distributed under the terms of license.txt in
+// the root directory of this source distribution.
+// ------------------------------------------------------------- 
+
+/**
+* @file
+* cudpp_unique.h
+*
+* @brief Unique functionality header file - contains CUDPP interface (not public)
+*/
+
+#ifndef __CUDPP_UNIQUE_H__
+#define __CUDPP_UNIQUE_H__
+
+class CUDPPUniquePlan;
+
+extern "C"
+void allocUniqueStorage(CUDPPUniquePlan *plan);
+
+extern "C"
+void freeUniqueStorage(CUDPPUniquePlan *plan);
+
+extern "C"
+size_t cudppUniqueDispatch(const CUDPPUniquePlan  *plan,
+                           void                   *d_keysOut,
+                           unsigned int           *d_valuesOut,
+                           const void             *d_keys,
+                           const unsigned int     *d_values,
+                           size_t                 numElements);
+
+#endif // __CUDPP_UNIQUE_H__
@@ -319,75 +319,89 @@ template <typename T>
 class OperatorAdd
 {
 public:
-    __device__ T operator()(const T a, const T b) { return a + b; }
-    __device__ T identity() { return (T)0; }
+    __host__ __device__ T operator()(const T a, const T b) { return a + b; }
+    __host__ __device__ T identity() { return (T)0; }
 };
 
 template <typename T>
 class OperatorMultiply
 {
 public:
-    __device__ T operator()(const T a, const T b) { return a * b; }
-    __device__ T identity() { return (T)1; }
+    __host__ __device__ T operator()(const T a, const T b) { return a * b; }
+    __host__ __device__ T identity() { return (T)1; }
 };
 
 template <typename T>
 class OperatorMax
 {
 public:
-    __device__ T operator() (const T a, const T b) const { return max(a, b); }
-    __device__ T identity() const; // no implementation - only specializations allowed
+    __host__ __device__ T operator() (const T a, const T b) const
+    {
+#ifdef __CUDA_ARCH__
+        return max(a, b);
+#else
+        return (a > b) ? a : b;
+#endif
+    }
+    __host__ __device__ T identity() const; // no implementation - only specializations allowed
 };
 
 template <>
-__device__ inline char OperatorMax<char>::identity() const { return CHAR_MIN; }
+__host__ __device__ inline char OperatorMax<char>::identity() const { return CHAR_MIN; }
 template <>
-__device__ inline unsigned char OperatorMax<unsigned char>::identity() const { return 0; }
+__host__ __device__ inline unsigned char OperatorMax<unsigned char>::identity() const { return 0; }
 template <>
-__device__ inline short OperatorMax<short>::identity() const { return SHRT_MIN; }
+__host__ __device__ inline short OperatorMax<short>::identity() const { return SHRT_MIN; }
 template <>
-__device__ inline unsigned short OperatorMax<unsigned short>::identity() const { return 0; }
+__host__ __device__ inline unsigned short OperatorMax<unsigned short>::identity() const { return 0; }
 template <>
-__device__ inline int OperatorMax<int>::identity() const { return INT_MIN; }
+__host__ __device__ inline int OperatorMax<int>::identity() const { return INT_MIN; }
 template <>
-__device__ inline unsigned int OperatorMax<unsigned int>::identity() const { return 0; }
+__host__ __device__ inline unsigned int OperatorMax<unsigned int>::identity() const { return 0; }
 template <>
-__device__ inline float OperatorMax<float>::identity() const { return -FLT_MAX; }
+__host__ __device__ inline float OperatorMax<float>::identity() const { return -FLT_MAX; }
 template <>
-__device__ inline double OperatorMax<double>::identity() const { return -DBL_MAX; }
+__host__ __device__ inline double OperatorMax<double>::identity() const { return -DBL_MAX; }
 template <>
-__device__ inline long long OperatorMax<long long>::identity() const { return LLONG_MIN; }
+__host__ __device__ inline long long OperatorMax<long long>::identity() const { return LLONG_MIN; }
 template <>
-__device__ inline unsigned long long OperatorMax<unsigned long long>::identity() const { return 0; }
+__host__ __device__ inline unsigned long long OperatorMax<unsigned long long>::identity() const { return 0; }
 
 template <typename T>
 class OperatorMin
 {
 public:
-    __device__ T operator() (const T a, const T b) const { return min(a, b); }
-    __device__ T identity() const; // no implementation - only specializations allowed
+    __host__ __device__ T operator() (const T a, const T b) const
+    {
+#ifdef __CUDA_ARCH__
+        return min(a, b);
+#else
+        return (a < b) ? a : b;
+#endif
+    }
+    __host__ __device__ T identity() const; // no implementation - only specializations allowed
 };
 
 template <>
-__device__ inline char OperatorMin<char>::identity() const { return CHAR_MAX; }
+__host__ __device__ inline char OperatorMin<char>::identity() const { return CHAR_MAX; }
 template <>
-__device__ inline unsigned char OperatorMin<unsigned char>::identity() const { return UCHAR_MAX; }
+__host__ __device__ inline unsigned char OperatorMin<unsigned char>::identity() const { return UCHAR_MAX; }
 template <>
-__device__ inline short OperatorMin<short>::identity() const { return SHRT_MAX; }
+__host__ __device__ inline short OperatorMin<short>::identity() const { return SHRT_MAX; }
 template <>
-__device__ inline unsigned short OperatorMin<unsigned short>::identity() const { return USHRT_MAX; }
+__host__ __device__ inline unsigned short OperatorMin<unsigned short>::identity() const { return USHRT_MAX; }
 template <>
-__device__ inline int OperatorMin<int>::identity() const { return INT_MAX; }
+__host__ __device__ inline int OperatorMin<int>::identity() const { return INT_MAX; }
 template <>
-__device__ inline unsigned int OperatorMin<unsigned int>::identity() const { return UINT_MAX; }
+__host__ __device__ inline unsigned int OperatorMin<unsigned int>::identity() const { return UINT_MAX; }
 template <>
-__device__ inline float OperatorMin<float>::identity() const { return FLT_MAX; }
+__host__ __device__ inline float OperatorMin<float>::identity() const { return FLT_MAX; }
 template <>
-__device__ inline double OperatorMin<double>::identity() const { return DBL_MAX; }
+__host__ __device__ inline double OperatorMin<double>::identity() const { return DBL_MAX; }
 template <>
-__device__ inline long long OperatorMin<long long>::identity() const { return LLONG_MAX; }
+__host__ __device__ inline long long OperatorMin<long long>::identity() const { return LLONG_MAX; }
 template <>
-__device__ inline unsigned long long OperatorMin<unsigned long long>::identity() const { return ULLONG_MAX; }
+__host__ __device__ inline unsigned long long OperatorMin<unsigned long long>::identity() const { return ULLONG_MAX; }
 
 #endif // __CUDPP_UTIL_H__
 
@@ -0,0 +1,366 @@
+// -------------------------------------------------------------
+// CUDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+#include <cudpp_globals.h>
+#include <stdio.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/**
+ * @file
+ * bfs_kernel.cuh
+ *
+ * @brief CUDPP kernel-level breadth-first search routines
+ */
+
+/** \addtogroup cudpp_kernel
+ * @{
+ */
+
+/** @name Breadth-First Search Functions
+ * @{
+ */
+
+/* Visited vertices and the frontier of a pull (bottom-up) level are
+ * bitmaps of one bit per vertex.  A push (top-down) level expands a
+ * queue of frontier vertices: a vertex is claimed by the thread whose
+ * atomic OR sets its visited bit, so every vertex is queued once.  The
+ * functions below are shared by the kernels and the host path.
+ */
+
+/**
+ * @brief Atomic OR of an unsigned int on the device or the host.
+ *
+ * @param[in,out] address The word
+ * @param[in] val The bits to set
+ * @returns The word before the OR
+ */
+__host__ __device__ inline
+unsigned int bfsFetchOr(unsigned int *address, unsigned int val)
+{
+#if defined(__CUDA_ARCH__)
+    return atomicOr(address, val);
+#elif defined(_MSC_VER)
+    return (unsigned int)_InterlockedOr((volatile long*)address, (long)val);
+#else
+    return __sync_fetch_and_or(address, val);
+#endif
+}
+
+/**
+ * @brief Atomic add of an int on the device or the host.
+ *
+ * @param[in,out] address The counter
+ * @param[in] val The increment
+ * @returns The counter before the add
+ */
+__host__ __device__ inline
+int bfsFetchAdd(int *address, int val)
+{
+#if defined(__CUDA_ARCH__)
+    return atomicAdd(address, val);
+#elif defined(_MSC_VER)
+    return (int)_InterlockedExchangeAdd((volatile long*)address, (long)val);
+#else
+    return __sync_fetch_and_add(address, val);
+#endif
+}
+
+/**
+ * @brief Whether the bit of vertex \a v is set in \a d_bits.
+ */
+__host__ __device__ inline
+bool bfsTestBit(const unsigned int *d_bits, int v)
+{
+    return (d_bits[v >> 5] & (1u << (v & 31))) != 0;
+}
+
+/**
+ * @brief Visit \a w from \a u at \a level, if no other thread has.
+ *
+ * @param[out] d_distances Distance of each vertex
+ * @param[out] d_parents Parent of each vertex (may be NULL)
+ * @param[in,out] d_visited Visited bitmap
+ * @param[in] u The frontier vertex
+ * @param[in] w Its neighbor
+ * @param[in] level Distance of \a w
+ * @returns Whether this call visited \a w
+ */
+__host__ __device__ inline
+bool bfsClaim(int           *d_distances,
+              int           *d_parents,
+              unsigned int  *d_visited,
+              int           u,
+              int           w,
+              int           level)
+{
+    unsigned int bit = 1u << (w & 31);
+    if ((d_visited[w >> 5] & bit) ||
+        (bfsFetchOr(&d_visited[w >> 5], bit) & bit))
+        return false;
+
+    d_distances[w] = level;
+    if (d_parents != NULL)
+        d_parents[w] = u;
+    return true;
+}
+
+/**
+ * @brief Pull level for the 32 vertices of visited word \a i.
+ *
+ * Each unvisited vertex looks for a neighbor in the frontier and stops
+ * at the first one.  Only this word's bits are written, so no atomics
+ * are needed.
+ *
+ * @param[out] d_distances Distance of each vertex
+ * @param[out] d_parents Parent of each vertex (may be NULL)
+ * @param[in,out] d_visited Visited bitmap
+ * @param[out] d_nextBits Next frontier bitmap
+ * @param[in] d_frontierBits Frontier bitmap
+ * @param[in] d_rowIndices Offset of the first neighbor of each vertex
+ * @param[in] d_indices Neighbors of all vertices
+ * @param[in] i The word
+ * @param[in] numVertices Number of vertices
+ * @param[in] level Distance of the vertices found
+ * @returns Number of vertices found
+ */
+__host__ __device__ inline
+unsigned int bfsPullWord(int                 *d_distances,
+                         int                 *d_parents,
+                         unsigned int        *d_visited,
+                         unsigned int        *d_nextBits,
+                         const unsigned int  *d_frontierBits,
+                         const unsigned int  *d_rowIndices,
+                         const unsigned int  *d_indices,
+                         size_t              i,
+                         size_t              numVertices,
+                         int                 level)
+{
+    unsigned int visited = d_visited[i];
+    unsigned int found = 0, count = 0;
+
+    for (int b = 0; b < 32; ++b)
+    {
+        int v = (int)(i * 32 + b);
+        if ((size_t)v >= numVertices)
+            break;
+        if (visited & (1u << b))
+            continue;
+        for (unsigned int j = d_rowIndices[v]; j < d_rowIndices[v+1]; ++j)
+        {
+            int u = (int)d_indices[j];
+            if (bfsTestBit(d_frontierBits, u))
+            {
+                d_distances[v] = level;
+                if (d_parents != NULL)
+                    d_parents[v] = u;
+                found |= 1u << b;
+                ++count;
+                break;
+            }
+        }
+    }
+
+    d_visited[i] = visited | found;
+    d_nextBits[i] = found;
+    return count;
+}
+
+/**
+ * @brief Largest frontier position whose first edge is at most \a k.
+ *
+ * The load-balanced search of a push level: the frontier's edges are
+ * numbered by an exclusive scan of the degrees, and edge \a k belongs
+ * to the last frontier vertex whose offset does not exceed it.
+ *
+ * @param[in] d_offsets Exclusive scan of the frontier degrees
+ * @param[in] numFrontier Number of frontier vertices
+ * @param[in] k The edge
+ * @returns The frontier position
+ */
+__host__ __device__ inline
+size_t bfsEdgeOwner(const unsigned int *d_offsets, size_t numFrontier, unsigned int k)
+{
+    size_t lo = 0, hi = numFrontier;
+    while (hi - lo > 1)
+    {
+        size_t mid = (lo + hi) / 2;
+        if (d_offsets[mid] <= k)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/**
+ * @brief Set the distances and parents of all vertices to -1, clear the
+ * visited bitmap and start at \a source.
+ *
+ * The source is its own parent and the only vertex of the first queue.
+ */
+__global__ void bfs_init(int           *d_distances,
+                         int           *d_parents,
+                         unsigned int  *d_visited,
+                         int           *d_queue,
+                         int           source,
+                         size_t        numVertices)
+{
+    size_t numWords = (numVertices + 31) / 32;
+    for (size_t v = threadIdx.x + (blockIdx.x * blockDim.x); v < numVertices;
+         v += gridDim.x * blockDim.x)
+    {
+        bool isSource = (v == (size_t)source);
+        d_distances[v] = isSource ? 0 : -1;
+        if (d_parents != NULL)
+            d_parents[v] = isSource ? source : -1;
+        if (v < numWords)
+            d_visited[v] = (v == (size_t)(source >> 5)) ? (1u << (source & 31)) : 0;
+    }
+    if (threadIdx.x == 0 && blockIdx.x == 0)
+        d_queue[0] = source;
+}
+
+/**
+ * @brief Degree of each vertex of the queue.
+ */
+__global__ void bfs_frontier_degrees(unsigned int        *d_degrees,
+                                     const int           *d_queue,
+                                     const unsigned int  *d_rowIndices,
+                                     size_t              numFrontier)
+{
+    for (size_t i = threadIdx.x + (blockIdx.x * blockDim.x); i < numFrontier;
+         i += gridDim.x * blockDim.x)
+    {
+        int u = d_queue[i];
+        d_degrees[i] = d_rowIndices[u+1] - d_rowIndices[u];
+    }
+}
+
+/**
+ * @brief Push level: expand the queue one edge per thread.
+ *
+ * Each edge of the frontier finds its vertex with bfsEdgeOwner(), so
+ * high-degree vertices are spread over many threads.  Claimed vertices
+ * are appended to the next queue.
+ *
+ * @param[out] d_nextQueue Next frontier
+ * @param[in,out] d_counters d_counters[0] counts the next frontier
+ * @param[out] d_distances Distance of each vertex
+ * @param[out] d_parents Parent of each vertex (may be NULL)
+ * @param[in,out] d_visited Visited bitmap
+ * @param[in] d_queue Frontier
+ * @param[in] d_offsets Exclusive scan of the frontier degrees
+ * @param[in] d_rowIndices Offset of the first neighbor of each vertex
+ * @param[in] d_indices Neighbors of all vertices
+ * @param[in] numFrontier Number of frontier vertices
+ * @param[in] numFrontierEdges Number of edges of the frontier
+ * @param[in] level Distance of the vertices found
+ */
+__global__ void bfs_push(int                 *d_nextQueue,
+                         unsigned int        *d_counters,
+                         int                 *d_distances,
+                         int                 *d_parents,
+                         unsigned int        *d_visited,
+                         const int           *d_queue,
+                         const unsigned int  *d_offsets,
+                         const unsigned int  *d_rowIndices,
+                         const unsigned int  *d_indices,
+                         size_t              numFrontier,
+                         size_t              numFrontierEdges,
+                         int                 level)
+{
+    for (size_t k = threadIdx.x + (blockIdx.x * blockDim.x); k < numFrontierEdges;
+         k += gridDim.x * blockDim.x)
+    {
+        size_t i = bfsEdgeOwner(d_offsets, numFrontier, (unsigned int)k);
+        int u = d_queue[i];
+        int w = (int)d_indices[d_rowIndices[u] + ((unsigned int)k - d_offsets[i])];
+        if (bfsClaim(d_distances, d_parents, d_visited, u, w, level))
+            d_nextQueue[atomicAdd(&d_counters[0], 1u)] = w;
+    }
+}
+
+/**
+ * @brief Set the frontier bit of every vertex of the queue.
+ */
+__global__ void bfs_queue_to_bitmap(unsigned int  *d_bits,
+                                    const int     *d_queue,
+                                    size_t        numFrontier)
+{
+    for (size_t i = threadIdx.x + (blockIdx.x * blockDim.x); i < numFrontier;
+         i += gridDim.x * blockDim.x)
+    {
+        int v = d_queue[i];
+        bfsFetchOr(&d_bits[v >> 5], 1u << (v & 31));
+    }
+}
+
+/**
+ * @brief Pull level, one thread per visited word (see bfsPullWord()).
+ *
+ * d_counters[1] counts the vertices found.
+ */
+__global__ void bfs_pull(unsigned int        *d_nextBits,
+                         unsigned int        *d_counters,
+                         int                 *d_distances,
+                         int                 *d_parents,
+                         unsigned int        *d_visited,
+                         const unsigned int  *d_frontierBits,
+                         const unsigned int  *d_rowIndices,
+                         const unsigned int  *d_indices,
+                         size_t              numVertices,
+                         int                 level)
+{
+    size_t numWords = (numVertices + 31) / 32;
+    for (size_t i = threadIdx.x + (blockIdx.x * blockDim.x); i < numWords;
+         i += gridDim.x * blockDim.x)
+    {
+        unsigned int count = bfsPullWord(d_distances, d_parents, d_visited, d_nextBits,
+                                         d_frontierBits, d_rowIndices, d_indices,
+                                         i, numVertices, level);
+        if (count > 0)
+            atomicAdd(&d_counters[1], count);
+    }
+}
+
+/**
+ * @brief Flag the vertices of a frontier bitmap for compaction.
+ */
+__global__ void bfs_bitmap_flags(unsigned int        *d_flags,
+                                 const unsigned int  *d_bits,
+                                 size_t              numVertices)
+{
+    for (size_t v = threadIdx.x + (blockIdx.x * blockDim.x); v < numVertices;
+         v += gridDim.x * blockDim.x)
+    {
+        d_flags[v] = bfsTestBit(d_bits, (int)v) ? 1 : 0;
+    }
+}
+
+/**
+ * @brief Compact the flagged vertices into a queue at their scanned offsets.
+ */
+__global__ void bfs_bitmap_scatter(int                 *d_queue,
+                                   const unsigned int  *d_flags,
+                                   const unsigned int  *d_offsets,
+                                   size_t              numVertices)
+{
+    for (size_t v = threadIdx.x + (blockIdx.x * blockDim.x); v < numVertices;
+         v += gridDim.x * blockDim.x)
+    {
+        if (d_flags[v])
+            d_queue[d_offsets[v]] = (int)v;
+    }
+}
+
+/** @} */ // end breadth-first search functions
+/** @} */ // end cudpp_kernel
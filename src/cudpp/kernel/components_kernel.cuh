@@ -0,0 +1,281 @@
+// -------------------------------------------------------------
+// CUDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+#include <cudpp_globals.h>
+#include <stdio.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/**
+ * @file
+ * components_kernel.cuh
+ *
+ * @brief CUDPP kernel-level connected components routines
+ */
+
+/** \addtogroup cudpp_kernel
+ * @{
+ */
+
+/** @name Connected Components Functions
+ * @{
+ */
+
+/* Components are a union-find forest in which every vertex points at a
+ * vertex of its component with a smaller or equal index, so each root is
+ * the smallest vertex of its tree.  Trees are joined without locks by
+ * swinging a root to the other tree's root with a compare-and-swap, and
+ * flattened by path compression.  The functions below are shared by the
+ * kernels and the host path.
+ */
+
+/**
+ * @brief Compare-and-swap of an int on the device or the host.
+ *
+ * @param[in,out] address The int
+ * @param[in] compare The value expected at \a address
+ * @param[in] val The value stored if \a address holds \a compare
+ * @returns The value that was at \a address
+ */
+__host__ __device__ inline
+int ccCompareAndSwap(int *address, int compare, int val)
+{
+#if defined(__CUDA_ARCH__)
+    return atomicCAS(address, compare, val);
+#elif defined(_MSC_VER)
+    return (int)_InterlockedCompareExchange((volatile long*)address, (long)val, (long)compare);
+#else
+    return __sync_val_compare_and_swap(address, compare, val);
+#endif
+}
+
+/**
+ * @brief Join the trees of vertices \a u and \a v.
+ *
+ * The larger of the two roots is swung to the smaller one.  If another
+ * thread moves either root first, the walk continues from the new
+ * parents until both vertices reach the same root.
+ *
+ * @param[in,out] d_parent Union-find parent of each vertex
+ * @param[in] u A vertex
+ * @param[in] v A vertex
+ */
+__host__ __device__ inline
+void ccLink(int *d_parent, int u, int v)
+{
+    volatile int *parent = d_parent;
+    int p1 = parent[u];
+    int p2 = parent[v];
+
+    while (p1 != p2)
+    {
+        int high = (p1 > p2) ? p1 : p2;
+        int low = (p1 > p2) ? p2 : p1;
+        int pHigh = parent[high];
+
+        if (pHigh == low ||
+            (pHigh == high && ccCompareAndSwap(d_parent + high, high, low) == high))
+            break;
+
+        p1 = parent[parent[high]];
+        p2 = parent[low];
+    }
+}
+
+/**
+ * @brief Point vertex \a v directly at the root of its tree.
+ *
+ * @param[in,out] d_parent Union-find parent of each vertex
+ * @param[in] v The vertex
+ */
+__host__ __device__ inline
+void ccCompress(int *d_parent, int v)
+{
+    volatile int *parent = d_parent;
+    while (parent[v] != parent[parent[v]])
+        parent[v] = parent[parent[v]];
+}
+
+/**
+ * @brief Vertex examined by sample \a i of the component sizes.
+ *
+ * The samples are spread over the vertices by a multiplicative hash, so
+ * that vertex order (e.g. of a mesh or a sorted edge list) does not bias
+ * them.
+ *
+ * @param[in] i The sample
+ * @param[in] numVertices Number of vertices
+ * @returns The vertex
+ */
+__host__ __device__ inline
+int ccSampleVertex(unsigned int i, size_t numVertices)
+{
+    return (int)((i * 2654435761ULL) % numVertices);
+}
+
+/**
+ * @brief Make every vertex its own root.
+ */
+__global__ void cc_init(int     *d_parent,
+                        size_t  numVertices)
+{
+    for (size_t v = threadIdx.x + (blockIdx.x * blockDim.x); v < numVertices;
+         v += gridDim.x * blockDim.x)
+    {
+        d_parent[v] = (int)v;
+    }
+}
+
+/**
+ * @brief Link every vertex to its neighbor \a round of a CSR graph.
+ *
+ * @param[in,out] d_parent Union-find parent of each vertex
+ * @param[in] d_rowIndices Offset of the first neighbor of each vertex (numVertices + 1)
+ * @param[in] d_indices Neighbors of all vertices
+ * @param[in] round Which neighbor of each vertex to link
+ * @param[in] numVertices Number of vertices
+ */
+__global__ void cc_link_neighbor(int                 *d_parent,
+                                 const unsigned int  *d_rowIndices,
+                                 const unsigned int  *d_indices,
+                                 unsigned int        round,
+                                 size_t              numVertices)
+{
+    for (size_t v = threadIdx.x + (blockIdx.x * blockDim.x); v < numVertices;
+         v += gridDim.x * blockDim.x)
+    {
+        unsigned int j = d_rowIndices[v] + round;
+        if (j < d_rowIndices[v+1])
+            ccLink(d_parent, (int)v, (int)d_indices[j]);
+    }
+}
+
+/**
+ * @brief Link the remaining neighbors of every vertex of a CSR graph that
+ * is not in component \a skip.
+ *
+ * Neighbors before CC_NEIGHBOR_ROUNDS were linked by cc_link_neighbor().
+ * Because the graph is symmetric, every edge between the skipped
+ * component and another vertex is still linked from the other side.
+ *
+ * @param[in,out] d_parent Union-find parent of each vertex
+ * @param[in] d_rowIndices Offset of the first neighbor of each vertex (numVertices + 1)
+ * @param[in] d_indices Neighbors of all vertices
+ * @param[in] skip Root of the sampled largest component
+ * @param[in] numVertices Number of vertices
+ */
+__global__ void cc_link_remaining(int                 *d_parent,
+                                  const unsigned int  *d_rowIndices,
+                                  const unsigned int  *d_indices,
+                                  int                 skip,
+                                  size_t              numVertices)
+{
+    for (size_t v = threadIdx.x + (blockIdx.x * blockDim.x); v < numVertices;
+         v += gridDim.x * blockDim.x)
+    {
+        if (d_parent[v] == skip)
+            continue;
+        for (unsigned int j = d_rowIndices[v] + CC_NEIGHBOR_ROUNDS; j < d_rowIndices[v+1]; ++j)
+            ccLink(d_parent, (int)v, (int)d_indices[j]);
+    }
+}
+
+/**
+ * @brief Link the sampled edges, or the remaining ones, of an edge list.
+ *
+ * Every CC_EDGE_SAMPLE_STRIDE-th edge is sampled.  Remaining edges with
+ * both ends in component \a skip are already linked and are skipped.
+ *
+ * @param[in,out] d_parent Union-find parent of each vertex
+ * @param[in] d_edgeU First vertex of each edge
+ * @param[in] d_edgeV Second vertex of each edge
+ * @param[in] sampled Link the sampled edges (true) or the remaining ones
+ * @param[in] skip Root of the sampled largest component, or -1
+ * @param[in] numEdges Number of edges
+ */
+__global__ void cc_link_edges(int         *d_parent,
+                              const int   *d_edgeU,
+                              const int   *d_edgeV,
+                              bool        sampled,
+                              int         skip,
+                              size_t      numEdges)
+{
+    for (size_t e = threadIdx.x + (blockIdx.x * blockDim.x); e < numEdges;
+         e += gridDim.x * blockDim.x)
+    {
+        if ((e % CC_EDGE_SAMPLE_STRIDE == 0) != sampled)
+            continue;
+        int u = d_edgeU[e];
+        int v = d_edgeV[e];
+        if (d_parent[u] == skip && d_parent[v] == skip)
+            continue;
+        ccLink(d_parent, u, v);
+    }
+}
+
+/**
+ * @brief Point every vertex directly at its root.
+ */
+__global__ void cc_compress(int     *d_parent,
+                            size_t  numVertices)
+{
+    for (size_t v = threadIdx.x + (blockIdx.x * blockDim.x); v < numVertices;
+         v += gridDim.x * blockDim.x)
+    {
+        ccCompress(d_parent, (int)v);
+    }
+}
+
+/**
+ * @brief Gather the roots of CC_NUM_SAMPLES sampled vertices.
+ */
+__global__ void cc_sample(int         *d_samples,
+                          const int   *d_parent,
+                          size_t      numVertices)
+{
+    for (unsigned int i = threadIdx.x + (blockIdx.x * blockDim.x); i < CC_NUM_SAMPLES;
+         i += gridDim.x * blockDim.x)
+    {
+        d_samples[i] = d_parent[ccSampleVertex(i, numVertices)];
+    }
+}
+
+/**
+ * @brief Flag the roots, which are the smallest vertex of each component.
+ */
+__global__ void cc_flag_roots(unsigned int    *d_flags,
+                              const int       *d_parent,
+                              size_t          numVertices)
+{
+    for (size_t v = threadIdx.x + (blockIdx.x * blockDim.x); v < numVertices;
+         v += gridDim.x * blockDim.x)
+    {
+        d_flags[v] = (d_parent[v] == (int)v) ? 1 : 0;
+    }
+}
+
+/**
+ * @brief Label every vertex with the rank of its root among the roots.
+ */
+__global__ void cc_label(int                 *d_labels,
+                         const int           *d_parent,
+                         const unsigned int  *d_rootRank,
+                         size_t              numVertices)
+{
+    for (size_t v = threadIdx.x + (blockIdx.x * blockDim.x); v < numVertices;
+         v += gridDim.x * blockDim.x)
+    {
+        d_labels[v] = (int)d_rootRank[d_parent[v]];
+    }
+}
+
+/** @} */ // end connected components functions
+/** @} */ // end cudpp_kernel
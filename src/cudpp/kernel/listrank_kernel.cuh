@@ -12,10 +12,6 @@
 #include "sharedmem.h"
 #include <stdio.h>
 
-#define LISTRANK_TOTAL 1024*1024
-#define LISTRANK_MAX 2048    // max number of threads dispatched
-#define LISTRANK_CTA_BLOCK 128       // threads per block
-
 /**
  * @file
  * listrank_kernel.cu
@@ -36,98 +32,311 @@ typedef unsigned char uchar;
 typedef unsigned short ushort;
 
 /**
- * @brief Use pointer jumping to rank values. After ranking
- * the values, calculate the next set of indices. The number
- * of values ranked doubles at each kernel call. Called by
- * listRank().
+ * @brief Returns the first node of sublist \a j of the ruling set.
  *
- * @param[out] d_ranked_values Ranked values array
- * @param[in]  d_unranked_values Unranked values array
- * @param[in]  d_ping Next indices array for the current kernel call
- * @param[in]  d_pong Next indices array for the next kernel call
- * @param[in]  d_start_indices Holds the starting node indices
- *             for "ranking" threads. The number of "ranking" threads
- *             doubles at each stage.
- * @param[in]  step The number of "ranking" threads.
- * @param[in]  head Head node index of the linked-list.
- * @param[in]  numElts Number of nodes to rank
+ * Sublist 0 starts at the list head and sublist j > 0 at node
+ * j * \a stride, or the node after it if that is the head.  With
+ * \a stride at least 2 the first nodes are distinct.
+ *
+ * @param[in] j The sublist
+ * @param[in] stride Number of nodes between the first nodes of sublists
+ * @param[in] head Head node index of the linked-list
+ * @returns The first node of sublist \a j
+ */
+__host__ __device__ inline
+size_t listRankSublistHead(size_t j, size_t stride, size_t head)
+{
+    if (j == 0)
+        return head;
+    size_t i = j * stride;
+    return (i == head) ? i + 1 : i;
+}
+
+/**
+ * @brief Mark the first node of each sublist of the ruling set.
+ *
+ * The next index of the first node of sublist j is replaced with
+ * -2 - j in \a d_marked, a copy of the next indices, so that a walk
+ * along the list knows where the following sublist starts.  Called by
+ * listRank().
  *
+ * @param[in,out] d_marked Copy of the next indices array
+ * @param[out] d_sublistHead First node of each sublist
+ * @param[in]  head Head node index of the linked-list
+ * @param[in]  stride Number of nodes between the first nodes of sublists
+ * @param[in]  numSublists Number of sublists
  */
-template <typename T>
-__global__ void list_rank_kernel_soa_1(T*               d_ranked_values,
-                                       const T*         d_unranked_values,
-                                       const int*       d_ping,
-                                       int*             d_pong,
-                                       int*             d_start_indices,
-                                       int              step,
-                                       int              head,
-                                       int              numElts)
+__global__ void list_rank_mark_sublists(int     *d_marked,
+                                        int     *d_sublistHead,
+                                        size_t  head,
+                                        size_t  stride,
+                                        size_t  numSublists)
 {
-    // Global, Local IDs
-    uint idx = threadIdx.x + (blockIdx.x * blockDim.x);
-
-    if(idx==0 && step==1) d_ranked_values[0] = d_unranked_values[head];
-
-    if(idx < step && (idx+step) < numElts)
+    for (size_t j = threadIdx.x + (blockIdx.x * blockDim.x); j < numSublists;
+         j += gridDim.x * blockDim.x)
     {
-        // Only threads which are alive/dispatched compute here
-        int myhead = (idx==0) ? head : d_start_indices[idx-1];
-        int next_index = d_ping[myhead];
-
-        d_start_indices[idx+(step-1)] = next_index;
-        d_ranked_values[idx+step] = d_unranked_values[next_index];
-    }
-
-    // All threads work to calculate next neighbors
-    // (1, 2, 4, 8, etc. neigbbors away)
-    for(int i = (int)idx; i < numElts; i += LISTRANK_TOTAL)
-    {
-        int my_next_index = d_ping[i];
-        int val_to_store = -1;
-        if(my_next_index >= 0){
-            val_to_store = d_ping[my_next_index];
-        }
-        d_pong[i] = val_to_store;
+        int i = (int)listRankSublistHead(j, stride, head);
+        d_sublistHead[j] = i;
+        d_marked[i] = -2 - (int)j;
     }
 }
 
 /**
- * @brief After pointer jumping is finished and all threads are
- * able to rank values, ranking continues serially. Each thread
- * ranks values until all values are ranked. Called by listRank().
+ * @brief Walk the sublists of the ruling set, one thread per sublist.
  *
- * @param[out] d_ranked_values Ranked values array
- * @param[in]  d_unranked_values Unranked values array
- * @param[in]  d_pong Next indices array for the current kernel call
- * @param[in]  d_start_indices Holds the starting node indices
- *             for "ranking" threads. The number of "ranking" threads
- *             doubles at each stage.
- * @param[in]  head Head node index of the linked-list.
- * @param[in]  numElts Number of nodes to rank
+ * A walk starts at the first node of its sublist and stops at the tail
+ * of the list or at the first node of the following sublist, which
+ * list_rank_mark_sublists() has marked.  With \a WRITE false the walk
+ * records the length and successor of its sublist; with \a WRITE true
+ * it writes each value at its rank, starting from the rank of the
+ * first node.  Called by listRank().
  *
+ * @param[out] d_ranked_values Ranked values array (only when \a WRITE)
+ * @param[in]  d_unranked_values Unranked values array
+ * @param[in]  d_next_indices Next indices array
+ * @param[in]  d_marked Next indices with the sublist heads marked
+ * @param[in]  d_sublistHead First node of each sublist
+ * @param[out] d_sublistSuccessor Sublist that follows each sublist, -1 for the last
+ * @param[out] d_sublistLength Number of nodes of each sublist
+ * @param[in]  d_sublistOffset Rank of the first node of each sublist,
+ *             -1 for sublists not reached from the head (only when \a WRITE)
+ * @param[in]  numSublists Number of sublists
  */
-template <typename T>
-__global__ void list_rank_kernel_soa_2(T*               d_ranked_values,
-                                       const T*         d_unranked_values,
-                                       const int*       d_pong,
-                                       const int*       d_start_indices,
-                                       int              head,
-                                       int              numElts)
+template <typename T, bool WRITE>
+__global__ void list_rank_walk_sublists(T               *d_ranked_values,
+                                        const T         *d_unranked_values,
+                                        const int       *d_next_indices,
+                                        const int       *d_marked,
+                                        const int       *d_sublistHead,
+                                        int             *d_sublistSuccessor,
+                                        size_t          *d_sublistLength,
+                                        const size_t    *d_sublistOffset,
+                                        size_t          numSublists)
 {
-    // Global, Local IDs
-    uint idx = threadIdx.x + (blockIdx.x * blockDim.x);
+    for (size_t j = threadIdx.x + (blockIdx.x * blockDim.x); j < numSublists;
+         j += gridDim.x * blockDim.x)
+    {
+        int i = d_sublistHead[j];
+        size_t rank = 1;
+        if (WRITE)
+        {
+            rank = d_sublistOffset[j];
+            if (rank == (size_t)-1)
+                continue;
+            d_ranked_values[rank++] = d_unranked_values[i];
+        }
 
-    int myIndex = (idx==0) ? head : d_start_indices[idx-1];
+        int successor = -1;
+        for (i = d_next_indices[i]; i >= 0; )
+        {
+            int next = d_marked[i];
+            if (next <= -2)
+            {
+                successor = -2 - next;
+                break;
+            }
+            if (WRITE)
+                d_ranked_values[rank] = d_unranked_values[i];
+            ++rank;
+            i = next;
+        }
 
-    // No more threads to dispatch, each thread keeps chasing
-    // until end of string (start where we left off from prev kernel)
-    for(int j=((int)idx+LISTRANK_MAX); j<numElts; j += LISTRANK_MAX)
-    {
-        int val = d_pong[myIndex];
-        d_ranked_values[j] = d_unranked_values[val];
-        myIndex = val;
+        if (!WRITE)
+        {
+            d_sublistSuccessor[j] = successor;
+            d_sublistLength[j] = rank;
+        }
     }
 }
 
+/**
+ * @brief Flag every node that is the successor of another node.
+ *
+ * The nodes left unflagged are the heads of the lists of a forest.
+ * Called by listScan().
+ *
+ * @param[out] d_flags 1 for each node with a predecessor, untouched otherwise
+ * @param[in]  d_next_indices Next indices array
+ * @param[in]  numElements Number of nodes
+ */
+__global__ void list_scan_flag_successors(int           *d_flags,
+                                          const int     *d_next_indices,
+                                          size_t        numElements)
+{
+    for (size_t i = threadIdx.x + (blockIdx.x * blockDim.x); i < numElements;
+         i += gridDim.x * blockDim.x)
+    {
+        int next = d_next_indices[i];
+        if (next >= 0)
+            d_flags[next] = 1;
+    }
+}
+
+/**
+ * @brief Count or gather the heads of the lists of a forest.
+ *
+ * Every node that list_scan_flag_successors() did not flag is a head.
+ * With \a d_heads NULL the heads are only counted in \a d_numHeads;
+ * otherwise they are also appended to \a d_heads, in no particular
+ * order.  Called by listScan().
+ *
+ * @param[out] d_heads Heads of the lists, or NULL
+ * @param[in,out] d_numHeads Number of heads found
+ * @param[in]  d_flags Successor flags
+ * @param[in]  numElements Number of nodes
+ */
+__global__ void list_scan_find_heads(int                *d_heads,
+                                     unsigned int       *d_numHeads,
+                                     const int          *d_flags,
+                                     size_t             numElements)
+{
+    for (size_t i = threadIdx.x + (blockIdx.x * blockDim.x); i < numElements;
+         i += gridDim.x * blockDim.x)
+    {
+        if (d_flags[i] == 0)
+        {
+            unsigned int h = atomicAdd(d_numHeads, 1u);
+            if (d_heads != NULL)
+                d_heads[h] = (int)i;
+        }
+    }
+}
+
+/**
+ * @brief Mark the first node of each list of a list scan.
+ *
+ * Sublist j < \a numHeads of a list scan starts at list head j, whose
+ * next index is replaced with -2 - j in \a d_marked.  Called by listScan().
+ *
+ * @param[in,out] d_marked Copy of the next indices array
+ * @param[in]  d_sublistHead First node of each sublist
+ * @param[in]  numHeads Number of lists
+ */
+__global__ void list_scan_mark_heads(int        *d_marked,
+                                     const int  *d_sublistHead,
+                                     size_t     numHeads)
+{
+    for (size_t j = threadIdx.x + (blockIdx.x * blockDim.x); j < numHeads;
+         j += gridDim.x * blockDim.x)
+    {
+        d_marked[d_sublistHead[j]] = -2 - (int)j;
+    }
+}
+
+/**
+ * @brief Mark the ruling set sublists of a list scan.
+ *
+ * Sublist \a numHeads + k starts at node k * \a stride, unless that node
+ * is already a list head, in which case the sublist is left empty (first
+ * node -1).  Called by listScan() after list_scan_mark_heads().
+ *
+ * @param[in,out] d_marked Copy of the next indices with the list heads marked
+ * @param[out] d_sublistHead First node of each sublist
+ * @param[in]  numHeads Number of lists
+ * @param[in]  stride Number of nodes between the first nodes of sublists
+ * @param[in]  numSplitters Number of ruling set sublists
+ */
+__global__ void list_scan_mark_splitters(int        *d_marked,
+                                         int        *d_sublistHead,
+                                         size_t     numHeads,
+                                         size_t     stride,
+                                         size_t     numSplitters)
+{
+    for (size_t k = threadIdx.x + (blockIdx.x * blockDim.x); k < numSplitters;
+         k += gridDim.x * blockDim.x)
+    {
+        size_t j = numHeads + k;
+        int i = (int)(k * stride);
+        if (d_marked[i] <= -2)
+            d_sublistHead[j] = -1;
+        else
+        {
+            d_sublistHead[j] = i;
+            d_marked[i] = -2 - (int)j;
+        }
+    }
+}
+
+/**
+ * @brief Walk the sublists of a list scan, one thread per sublist.
+ *
+ * With \a WRITE false the walk reduces the values of its sublist with
+ * \a Oper and records the sublist that follows it.  With \a WRITE true
+ * it scans the values of its sublist, starting from the reduction of
+ * all the sublists before it in its list, and writes the prefix of
+ * each node at that node.  Called by listScan().
+ *
+ * @param[out] d_out Prefix values (only when \a WRITE)
+ * @param[in]  d_in Input values
+ * @param[in]  d_next_indices Next indices array
+ * @param[in]  d_marked Next indices with the sublist heads marked
+ * @param[in]  d_sublistHead First node of each sublist, -1 for empty sublists
+ * @param[in,out] d_sublistSuccessor Sublist that follows each sublist
+ *             (written when not \a WRITE); 1 for each sublist that is
+ *             reached from a list head (read when \a WRITE)
+ * @param[in,out] d_sublistValue Reduction of each sublist (written when
+ *             not \a WRITE); reduction of the sublists before each
+ *             sublist (read when \a WRITE)
+ * @param[in]  numSublists Number of sublists
+ * @param[in]  exclusive Whether the prefix of a node excludes its own value
+ */
+template <typename T, class Oper, bool WRITE>
+__global__ void list_scan_walk_sublists(T               *d_out,
+                                        const T         *d_in,
+                                        const int       *d_next_indices,
+                                        const int       *d_marked,
+                                        const int       *d_sublistHead,
+                                        int             *d_sublistSuccessor,
+                                        T               *d_sublistValue,
+                                        size_t          numSublists,
+                                        bool            exclusive)
+{
+    Oper op;
+
+    for (size_t j = threadIdx.x + (blockIdx.x * blockDim.x); j < numSublists;
+         j += gridDim.x * blockDim.x)
+    {
+        int i = d_sublistHead[j];
+        if (i < 0 || (WRITE && !d_sublistSuccessor[j]))
+        {
+            if (!WRITE)
+                d_sublistSuccessor[j] = -1;
+            continue;
+        }
+
+        T value;
+        if (WRITE)
+        {
+            T carry = d_sublistValue[j];
+            value = op(carry, d_in[i]);
+            d_out[i] = exclusive ? carry : value;
+        }
+        else
+            value = d_in[i];
+
+        int successor = -1;
+        for (i = d_next_indices[i]; i >= 0; )
+        {
+            int next = d_marked[i];
+            if (next <= -2)
+            {
+                successor = -2 - next;
+                break;
+            }
+            T carry = value;
+            value = op(value, d_in[i]);
+            if (WRITE)
+                d_out[i] = exclusive ? carry : value;
+            i = next;
+        }
+
+        if (!WRITE)
+        {
+            d_sublistSuccessor[j] = successor;
+            d_sublistValue[j] = value;
+        }
+    }
+}
+
 /** @} */ // end listrank functions
 /** @} */ // end cudpp_kernel
\ No newline at end of file
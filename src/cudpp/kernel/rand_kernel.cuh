@@ -29,16 +29,22 @@
  * MD5 hashes, and uses the output as randomized bits.  To repeatedly call this
  * function, always call cudppRandSeed() first to set a new seed or else the output
  * may be the same due to the deterministic nature of hashes.  gen_randMD5 generates
- * 128 random bits per thread.  Therefore, the parameter \a d_out is expected to be
- * an array of type uint4 with \a numElements indicies.
+ * 128 random bits per thread, which are written directly into four consecutive
+ * unsigned ints of \a d_out.  The thread that owns the last, partial group of
+ * four writes only the elements that fall inside \a d_out.
  *
- * @param[out] d_out the output array of type uint4.
+ * @param[out] d_out the output array of type unsigned int.
  * @param[in] numElements the number of elements in \a d_out
  * @param[in] seed the random seed used to vary the output
  *
+ * @tparam isAligned true if \a d_out is 16-byte aligned, in which case full
+ * groups of four are written with a single uint4 store
+ *
  * @see launchRandMD5Kernel()
  */
-__global__ void gen_randMD5(uint4 *d_out, size_t numElements, unsigned int seed)
+template <bool isAligned>
+__global__ void gen_randMD5(unsigned int *d_out, size_t numElements, 
+                            unsigned int seed)
 {
     unsigned int idx = blockIdx.x*blockDim.x + threadIdx.x;
 
@@ -136,14 +142,108 @@ __global__ void gen_randMD5(uint4 *d_out, size_t numElements, unsigned int seed)
 
     __syncthreads();
 
-    if (idx < numElements)
+    size_t outIdx = (size_t)idx * 4;
+
+    if (outIdx + 4 <= numElements)
+    {
+        if (isAligned)
+        {
+            ((uint4*)d_out)[idx] = result;
+        }
+        else
+        {
+            d_out[outIdx]     = result.x;
+            d_out[outIdx + 1] = result.y;
+            d_out[outIdx + 2] = result.z;
+            d_out[outIdx + 3] = result.w;
+        }
+    }
+    else if (outIdx < numElements)
     {
-        d_out[idx].x = result.x;
-        d_out[idx].y = result.y;
-        d_out[idx].z = result.z;
-        d_out[idx].w = result.w;
+        // tail: numElements is not a multiple of 4
+        d_out[outIdx] = result.x;
+        if (outIdx + 1 < numElements) d_out[outIdx + 1] = result.y;
+        if (outIdx + 2 < numElements) d_out[outIdx + 2] = result.z;
     }
 }
+/**
+ * @brief Counter-based random number generation kernel.
+ *
+ * Each 128-bit counter block of the sequence selected by \a key is turned
+ * by \a xform into Transform::valuesPerBlock output values (4 for 32-bit 
+ * outputs, 2 for doubles), so element \a p of the output sequence is lane 
+ * \a p % valuesPerBlock of counter block \a p / valuesPerBlock.  This 
+ * kernel writes elements [\a offset, \a offset + \a numElements) of the 
+ * sequence to \a d_out, transforming and storing each value in the same
+ * pass.  Because every counter block is generated independently, the 
+ * output does not depend on the launch configuration, and a sequence 
+ * generated in several chunks is identical to one generated in a single
+ * call.
+ *
+ * Each thread generates one counter block at a time, looping over the
+ * blocks with a grid-sized stride.  The partial blocks at the start (when 
+ * \a offset is not a multiple of valuesPerBlock) and at the end of the 
+ * range only write the lanes that fall inside \a d_out.
+ *
+ * @param[out] d_out the output array
+ * @param[in] numElements the number of elements in \a d_out
+ * @param[in] offset position of \a d_out[0] in the output sequence
+ * @param[in] key the generator key, (seed, stream)
+ * @param[in] xform the distribution transform
+ *
+ * @tparam alg CUDPP_RAND_PHILOX or CUDPP_RAND_THREEFRY
+ * @tparam Transform the distribution transform, e.g. RandBitsTransform
+ * @tparam isAligned true if \a d_out is 16-byte aligned and \a offset is a
+ * multiple of valuesPerBlock, in which case full blocks are written with a
+ * single 16-byte store
+ *
+ * @see launchRandCounterKernel()
+ */
+template <CUDPPAlgorithm alg, class Transform, bool isAligned>
+__global__ void gen_randCounter(typename Transform::T *d_out, 
+                                size_t numElements,
+                                unsigned long long offset, 
+                                uint2 key,
+                                Transform xform)
+{
+    typedef typename Transform::T T;
+    typedef typename Transform::V V;
+    const int valuesPerBlock = Transform::valuesPerBlock;
+
+    unsigned long long firstBlock = offset / valuesPerBlock;
+    long long firstLane = (long long)(offset % valuesPerBlock);
+    size_t numBlocks = ((size_t)firstLane + numElements + valuesPerBlock - 1) 
+                       / valuesPerBlock;
+
+    for (size_t i = blockIdx.x * blockDim.x + threadIdx.x; 
+         i < numBlocks; 
+         i += gridDim.x * blockDim.x)
+    {
+        unsigned long long block = firstBlock + i;
+        V v = xform.template apply<alg>(counterRandBlock<alg>(block, key), 
+                                        block, key);
+
+        // index in d_out of lane 0 of this block (negative in the first 
+        // block when offset is not a multiple of valuesPerBlock)
+        long long outIdx = (long long)(i * valuesPerBlock) - firstLane;
+
+        if (isAligned && outIdx + valuesPerBlock <= (long long)numElements)
+        {
+            ((V*)d_out)[i] = v;
+        }
+        else
+        {
+            const T *vals = (const T*)&v;
+#pragma unroll
+            for (int j = 0; j < valuesPerBlock; j++)
+            {
+                if (outIdx + j >= 0 && outIdx + j < (long long)numElements)
+                    d_out[outIdx + j] = vals[j];
+            }
+        }
+    }
+}
+
 /** @} */ // end rand functions
 /** @} */ // end cudpp_kernel
 
@@ -0,0 +1,173 @@
+// -------------------------------------------------------------
+// CUDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+#include <cudpp_globals.h>
+#include <stdio.h>
+
+/**
+ * @file
+ * reduce_by_key_kernel.cuh
+ *
+ * @brief CUDPP kernel-level reduce-by-key and run-length encoding routines
+ */
+
+/** \addtogroup cudpp_kernel
+ * @{
+ */
+
+/** @name Reduce-By-Key Functions
+ * @{
+ */
+
+/* Each thread owns a tile of RBK_ITEMS_PER_THREAD consecutive elements.
+ * An element is the head of a segment when its key differs from the
+ * previous key.  The first kernel counts the heads of every tile and
+ * reduces the values after its last head (the tile's tail); the second
+ * recomputes the head flags, reduces every segment and writes it at its
+ * rank, without flags or ranks ever being stored per element.  Run-length
+ * encoding is the same with a value of 1 per element.
+ */
+
+/**
+ * @brief Whether element \a i starts a segment of equal keys.
+ */
+template <typename K>
+__host__ __device__ inline
+bool rbkIsHead(const K *d_keys, size_t i)
+{
+    return (i == 0) || (d_keys[i] != d_keys[i-1]);
+}
+
+/**
+ * @brief Value of element \a i: 1 when counting run lengths.
+ */
+template <typename T, bool isRLE>
+__host__ __device__ inline
+T rbkValue(const T *d_values, size_t i)
+{
+    return isRLE ? (T)1 : d_values[i];
+}
+
+/**
+ * @brief Count the heads of each tile and reduce the values after its
+ * last head.
+ *
+ * @param[out] d_tileCount Number of heads of each tile
+ * @param[out] d_tileFlag 1 for tiles with a head, which start a segment of tiles
+ * @param[out] d_tileTail Reduction of the values from the last head to the end of each tile
+ * @param[in] d_keys Keys
+ * @param[in] d_values Values (unused for run-length encoding)
+ * @param[in] numElements Number of elements
+ * @param[in] numTiles Number of tiles
+ */
+template <typename K, typename T, class Oper, bool isRLE>
+__global__ void rbk_tile_summary(unsigned int    *d_tileCount,
+                                 unsigned int    *d_tileFlag,
+                                 T               *d_tileTail,
+                                 const K         *d_keys,
+                                 const T         *d_values,
+                                 size_t          numElements,
+                                 size_t          numTiles)
+{
+    Oper op;
+    for (size_t t = threadIdx.x + (blockIdx.x * blockDim.x); t < numTiles;
+         t += gridDim.x * blockDim.x)
+    {
+        size_t begin = t * RBK_ITEMS_PER_THREAD;
+        size_t end = (begin + RBK_ITEMS_PER_THREAD < numElements) ?
+                     begin + RBK_ITEMS_PER_THREAD : numElements;
+
+        unsigned int count = rbkIsHead(d_keys, begin) ? 1 : 0;
+        T tail = rbkValue<T, isRLE>(d_values, begin);
+        for (size_t i = begin + 1; i < end; ++i)
+        {
+            T v = rbkValue<T, isRLE>(d_values, i);
+            if (d_keys[i] != d_keys[i-1])
+            {
+                ++count;
+                tail = v;
+            }
+            else
+                tail = op(tail, v);
+        }
+
+        d_tileCount[t] = count;
+        d_tileFlag[t] = (count > 0) ? 1 : 0;
+        d_tileTail[t] = tail;
+    }
+}
+
+/**
+ * @brief Reduce the segments of each tile and write each one at its rank.
+ *
+ * A segment is written by the tile holding its last element.  A tile
+ * whose first element is not a head continues the segment of the tile
+ * before it, whose reduction up to that tile is the inclusive segmented
+ * scan of the tile tails.
+ *
+ * @param[out] d_keysOut Key of each segment
+ * @param[out] d_valuesOut Reduction (or length) of each segment
+ * @param[in] d_keys Keys
+ * @param[in] d_values Values (unused for run-length encoding)
+ * @param[in] d_tileOffset Exclusive scan of the tile head counts
+ * @param[in] d_tileCarry Inclusive segmented scan of the tile tails
+ * @param[in] numElements Number of elements
+ * @param[in] numTiles Number of tiles
+ */
+template <typename K, typename T, class Oper, bool isRLE>
+__global__ void rbk_tile_scatter(K                   *d_keysOut,
+                                 T                   *d_valuesOut,
+                                 const K             *d_keys,
+                                 const T             *d_values,
+                                 const unsigned int  *d_tileOffset,
+                                 const T             *d_tileCarry,
+                                 size_t              numElements,
+                                 size_t              numTiles)
+{
+    Oper op;
+    for (size_t t = threadIdx.x + (blockIdx.x * blockDim.x); t < numTiles;
+         t += gridDim.x * blockDim.x)
+    {
+        size_t begin = t * RBK_ITEMS_PER_THREAD;
+        size_t end = (begin + RBK_ITEMS_PER_THREAD < numElements) ?
+                     begin + RBK_ITEMS_PER_THREAD : numElements;
+
+        // one past the rank of the current segment
+        unsigned int out = d_tileOffset[t];
+        T acc = rbkValue<T, isRLE>(d_values, begin);
+        if (rbkIsHead(d_keys, begin))
+            ++out;
+        else
+            acc = op(d_tileCarry[t-1], acc);
+
+        for (size_t i = begin; i < end; ++i)
+        {
+            if (i > begin)
+            {
+                T v = rbkValue<T, isRLE>(d_values, i);
+                if (d_keys[i] != d_keys[i-1])
+                {
+                    ++out;
+                    acc = v;
+                }
+                else
+                    acc = op(acc, v);
+            }
+            if (i + 1 == numElements || d_keys[i+1] != d_keys[i])
+            {
+                d_keysOut[out-1] = d_keys[i];
+                d_valuesOut[out-1] = acc;
+            }
+        }
+    }
+}
+
+/** @} */ // end reduce-by-key functions
+/** @} */ // end cudpp_kernel
@@ -0,0 +1,215 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// ------------------------------------------------------------- 
+// This source code is distributed under the terms of license.txt 
+// in the root directory of this source distribution.
+// ------------------------------------------------------------- 
+
+/**
+ * @file
+ * shuffle_kernel.cuh
+ *
+ * @brief CUDPP kernel-level shuffle and sampling routines
+ */
+
+/** \addtogroup cudpp_kernel
+  * @{
+  */
+/** @name Shuffle Functions
+ * @{
+ */
+
+/**
+ * @brief Derives the key of one shuffle or sample call.
+ *
+ * Every call of a shuffle plan uses its own key, derived from the plan's
+ * (seed, stream) key and the call index, so consecutive calls produce 
+ * independent permutations while remaining deterministic given the seed.
+ *
+ * @param[in] key the plan key, (seed, stream)
+ * @param[in] call index of the call since the plan was seeded
+ * @param[in] purpose distinguishes keys derived for different uses
+ * @returns 128 random bits to be used as round keys or a derived key
+ */
+__device__ uint4 shuffleCallKey(uint2 key, unsigned long long call, 
+                                unsigned int purpose)
+{
+    return counterRandBlock<CUDPP_RAND_PHILOX>(call, key, 
+                                               make_uint2(0xFFFFFFFF, purpose));
+}
+
+/**
+ * @brief Round function of the Feistel permutation.
+ *
+ * A keyed 32-bit integer mix (the MurmurHash3 finalizer) of the right half
+ * of the state.
+ *
+ * @param[in] x the right half of the state
+ * @param[in] roundKey the key of this round
+ * @returns pseudorandom bits, to be masked to the width of a half
+ */
+__device__ __forceinline__ 
+unsigned int feistelRound(unsigned int x, unsigned int roundKey)
+{
+    x = (x ^ roundKey) * 0x9E3779B1;
+    x ^= x >> 16;
+    x *= 0x85EBCA6B;
+    x ^= x >> 13;
+    x *= 0xC2B2AE35;
+    x ^= x >> 16;
+    return x;
+}
+
+/**
+ * @brief Maps \a i to its position in a random permutation of [0, \a n).
+ *
+ * A balanced Feistel network with SHUFFLE_FEISTEL_ROUNDS rounds is a 
+ * bijection on [0, 4^\a halfBits) for any round function.  Cycle-walking
+ * (reapplying the network until the result falls below \a n) restricts it
+ * to a bijection on [0, \a n).  Since 4^\a halfBits < 4 \a n, the expected
+ * number of network evaluations is less than four.
+ *
+ * @param[in] i the index to permute, \a i < \a n
+ * @param[in] n the size of the permutation
+ * @param[in] halfBits number of bits in each half of the Feistel state
+ * @param[in] roundKeys one key per round
+ * @returns the permuted index
+ */
+__device__ unsigned int feistelPermute(unsigned int i, unsigned int n, 
+                                       unsigned int halfBits,
+                                       const unsigned int *roundKeys)
+{
+    unsigned int mask = (1u << halfBits) - 1;
+    unsigned int x = i;
+    do
+    {
+        unsigned int left = x >> halfBits;
+        unsigned int right = x & mask;
+#pragma unroll
+        for (int r = 0; r < SHUFFLE_FEISTEL_ROUNDS; r++)
+        {
+            unsigned int t = right;
+            right = left ^ (feistelRound(right, roundKeys[r]) & mask);
+            left = t;
+        }
+        x = (left << halfBits) | right;
+    } while (x >= n);
+    return x;
+}
+
+/**
+ * @brief Gathers the first \a numOutputs elements of a random permutation
+ * of \a d_keysIn (and \a d_valuesIn).
+ *
+ * \a d_keysOut[i] = \a d_keysIn[p(i)], where p is the Feistel permutation
+ * of [0, \a numElements) keyed by \a key and \a call.  With \a numOutputs
+ * equal to \a numElements this is a full shuffle; with fewer it is a 
+ * sample without replacement, at a cost proportional to \a numOutputs.
+ *
+ * @param[out] d_keysOut the output keys
+ * @param[out] d_valuesOut the output values (if \a hasValues)
+ * @param[in] d_keysIn the input keys
+ * @param[in] d_valuesIn the input values (if \a hasValues)
+ * @param[in] numOutputs number of elements to output
+ * @param[in] numElements number of input elements
+ * @param[in] halfBits number of bits in each half of the Feistel state
+ * @param[in] key the plan key, (seed, stream)
+ * @param[in] call index of this call since the plan was seeded
+ *
+ * @tparam T type of the keys
+ * @tparam hasValues true if there are values to move with the keys
+ */
+template <typename T, bool hasValues>
+__global__ void shuffleGather(T                  *d_keysOut,
+                              unsigned int       *d_valuesOut,
+                              const T            *d_keysIn,
+                              const unsigned int *d_valuesIn,
+                              unsigned int       numOutputs,
+                              unsigned int       numElements,
+                              unsigned int       halfBits,
+                              uint2              key,
+                              unsigned long long call)
+{
+    unsigned int roundKeys[SHUFFLE_FEISTEL_ROUNDS];
+    uint4 k0 = shuffleCallKey(key, call, 0);
+    uint4 k1 = shuffleCallKey(key, call, 1);
+    roundKeys[0] = k0.x; roundKeys[1] = k0.y; 
+    roundKeys[2] = k0.z; roundKeys[3] = k0.w;
+    roundKeys[4] = k1.x; roundKeys[5] = k1.y; 
+    roundKeys[6] = k1.z; roundKeys[7] = k1.w;
+
+    // size_t so that the stride cannot wrap past numOutputs near 2^32
+    for (size_t i = blockIdx.x * blockDim.x + threadIdx.x; 
+         i < numOutputs; 
+         i += gridDim.x * blockDim.x)
+    {
+        unsigned int src = feistelPermute((unsigned int)i, numElements, halfBits, 
+                                          roundKeys);
+        d_keysOut[i] = d_keysIn[src];
+        if (hasValues)
+            d_valuesOut[i] = d_valuesIn[src];
+    }
+}
+
+/**
+ * @brief Samples \a numOutputs elements of \a d_keysIn (and \a d_valuesIn)
+ * uniformly with replacement.
+ *
+ * Each thread draws the source indices of four outputs at a time from one
+ * Philox counter block under a key derived for this call, bounded to 
+ * [0, \a numElements) without bias by \a bound.
+ *
+ * @param[out] d_keysOut the output keys
+ * @param[out] d_valuesOut the output values (if \a hasValues)
+ * @param[in] d_keysIn the input keys
+ * @param[in] d_valuesIn the input values (if \a hasValues)
+ * @param[in] numOutputs number of elements to output
+ * @param[in] bound maps random words to [0, numElements)
+ * @param[in] key the plan key, (seed, stream)
+ * @param[in] call index of this call since the plan was seeded
+ *
+ * @tparam T type of the keys
+ * @tparam hasValues true if there are values to move with the keys
+ */
+template <typename T, bool hasValues>
+__global__ void sampleWithReplacement(T                  *d_keysOut,
+                                      unsigned int       *d_valuesOut,
+                                      const T            *d_keysIn,
+                                      const unsigned int *d_valuesIn,
+                                      size_t             numOutputs,
+                                      RandBoundedIntTransform bound,
+                                      uint2              key,
+                                      unsigned long long call)
+{
+    uint4 k = shuffleCallKey(key, call, 2);
+    uint2 callKey = make_uint2(k.x, k.y);
+
+    size_t numBlocks = (numOutputs + 3) / 4;
+
+    for (size_t b = blockIdx.x * blockDim.x + threadIdx.x; 
+         b < numBlocks; 
+         b += gridDim.x * blockDim.x)
+    {
+        uint4 src = bound.apply<CUDPP_RAND_PHILOX>(
+            counterRandBlock<CUDPP_RAND_PHILOX>(b, callKey), b, callKey);
+        const unsigned int *srcs = (const unsigned int*)&src;
+
+#pragma unroll
+        for (int j = 0; j < 4; j++)
+        {
+            size_t i = b * 4 + j;
+            if (i < numOutputs)
+            {
+                d_keysOut[i] = d_keysIn[srcs[j]];
+                if (hasValues)
+                    d_valuesOut[i] = d_valuesIn[srcs[j]];
+            }
+        }
+    }
+}
+
+/** @} */ // end shuffle functions
+/** @} */ // end cudpp_kernel
@@ -34,254 +34,808 @@
 #include <cudpp_globals.h>
 #include <cudpp_util.h>
 
-/** 
-  * @brief Fetch and multiply kernel
-  *
-  * This __global__ device function takes an element from the vector d_A, finds its 
-  * column in d_indx and multiplies the element from d_A with its 
-  * corresponding (that is having the same row) element in d_x and stores the resulting
-  * product in d_prod. It also sets all the elements of d_flags to 0.
-  * 
-  * Template parameter \a T is the datatype of the matrix A and x. 
-  *
-  * @param[out] d_flags The output flags array
-  * @param[out] d_prod The output products array
-  * @param[in] d_A The input matrix A
-  * @param[in] d_x The input array x
-  * @param[in] d_indx The input array of column indices for each element in A
+/**
+  * @brief Merge-path search
+  *
+  * Finds the row coordinate at which \a diagonal crosses the merge path of the
+  * row end offsets \a d_rowEnd and the sequence of nonzero indices
+  * 0..numNZElts-1.  Consuming a row end means the row is complete; consuming
+  * a nonzero index means one product is accumulated.  The nonzero coordinate is
+  * \a diagonal minus the returned row.  Also used by the host multiply.
+  *
+  * @param[in] diagonal The diagonal (number of merge items consumed)
+  * @param[in] d_rowEnd The exclusive end offset of each row in d_A
+  * @param[in] numRows The number of rows in matrix A
   * @param[in] numNZElts The number of non-zero elements in matrix A
+  * @returns The number of rows completed at \a diagonal
   */
-template <class T, bool isFullBlock>
-__global__ 
-void sparseMatrixVectorFetchAndMultiply(
-                                        unsigned int       *d_flags, 
-                                        T                  *d_prod, 
-                                        const T            *d_A,
-                                        const T            *d_x,
-                                        const unsigned int *d_indx,
-                                        unsigned int       numNZElts
-                                        )
+__host__ __device__ 
+unsigned int sparseMatrixVectorMergePathSearch(unsigned int       diagonal,
+                                               const unsigned int *d_rowEnd,
+                                               unsigned int       numRows,
+                                               unsigned int       numNZElts)
 {
-// This method is currently slow
-#if 0 
-    typeToVector<T,4>::Result  tempData, outData;
-    typeToVector<unsigned int,4>::Result tempIndx, tempFlags;
-
-    typeToVector<T,4>::Result* inData = (typeToVector<T,4>::Result*)d_A;
-    typeToVector<T,4>::Result* outProd = (typeToVector<T,4>::Result*)d_prod;
-
-    typeToVector<unsigned int,4>::Result* inIndx = 
-        (typeToVector<unsigned int,4>::Result*)d_indx;
-    typeToVector<unsigned int,4>::Result* outFlags = 
-        (typeToVector<unsigned int,4>::Result*)d_flags;
-
-    unsigned int aiDev = blockIdx.x * (blockDim.x << 1) + threadIdx.x;
-    unsigned int i = aiDev * 4;
-    if (isFullBlock || ((i+3) < numNZElts) )
+    unsigned int lo = (diagonal > numNZElts) ? diagonal - numNZElts : 0;
+    unsigned int hi = (diagonal < numRows) ? diagonal : numRows;
+
+    while (lo < hi)
     {
-        tempData = inData[aiDev];
-        tempIndx = inIndx[aiDev];
+        unsigned int pivot = (lo + hi) >> 1;
+        if (d_rowEnd[pivot] <= diagonal - pivot - 1)
+            lo = pivot + 1;
+        else
+            hi = pivot;
+    }
+    return lo;
+}
 
-        outData.x = tempData.x * d_x[tempIndx.x];
-        outData.y = tempData.y * d_x[tempIndx.y];
-        outData.z = tempData.z * d_x[tempIndx.z];
-        outData.w = tempData.w * d_x[tempIndx.w];
+/**
+  * @brief Store the result of one row of Y = alpha * A * X + beta * Y
+  *
+  * \a beta is only applied where it is nonzero, so Y need not be
+  * initialized when \a beta is zero.
+  *
+  * Template parameter \a T is the datatype of the matrix A and X, and
+  * \a NUM_VECTORS the number of vectors.
+  *
+  * @param[in,out] d_y The element of the row in the first vector of Y
+  * @param[in] sum The row of A * X, one element per vector
+  * @param[in] yPitch The distance in elements between vectors of Y
+  * @param[in] alpha The scale of A * X
+  * @param[in] beta The scale of Y
+  */
+template <class T, int NUM_VECTORS>
+__host__ __device__ void sparseMatrixVectorStoreRow(T       *d_y,
+                                                    const T *sum,
+                                                    size_t  yPitch,
+                                                    T       alpha,
+                                                    T       beta)
+{
+#pragma unroll
+    for (int v = 0; v < NUM_VECTORS; ++v)
+    {
+        T out = alpha * sum[v];
+        if (beta != (T)0)
+            out += beta * d_y[v * yPitch];
+        d_y[v * yPitch] = out;
+    }
+}
 
-        outProd[aiDev] = outData;
+/**
+  * @brief Merge-path sparse matrix-vector multiply kernel
+  *
+  * Each thread consumes SPMV_ITEMS_PER_THREAD items of the merge path
+  * of the row end offsets and the nonzeros, so every thread does the same
+  * amount of work no matter how the nonzeros are distributed over the rows.
+  * A thread accumulates the rows it completes in registers and stores them
+  * to d_y.  The partial sum of the row it stops in is its carry-out; the
+  * carries are combined across the tile with a segmented (by row) scan in
+  * shared memory and added to the first row completed by the next thread.
+  * The carry-out of each tile's last thread is written to d_carryRow and
+  * d_carryValue for sparseMatrixVectorMergePathFixup().  A CTA processes
+  * tiles blockIdx.x, blockIdx.x + gridDim.x, ...
+  *
+  * Every row, including an empty one, is completed by exactly one thread,
+  * which applies \a beta; the fix-up only adds scaled carries.  Each
+  * nonzero is read once for all \a NUM_VECTORS vectors.
+  *
+  * Template parameter \a T is the datatype of the matrix A and X, and
+  * \a NUM_VECTORS the number of vectors.
+  *
+  * @param[in,out] d_y The output vectors Y = alpha * A * X + beta * Y
+  * @param[out] d_carryRow The row of each tile's carry-out
+  * @param[out] d_carryValue The partial sums of each tile's carry-out, vector
+  *                          v of tile t at v * numTiles + t
+  * @param[in] d_A The nonzeros of matrix A in row-major order
+  * @param[in] d_x The input vectors X
+  * @param[in] d_indx The column of each element of A
+  * @param[in] d_rowEnd The exclusive end offset of each row in d_A
+  * @param[in] numRows The number of rows in matrix A
+  * @param[in] numNZElts The number of non-zero elements in matrix A
+  * @param[in] numTiles The number of tiles of SPMV_CTA_SIZE * SPMV_ITEMS_PER_THREAD
+  *                     merge items, one carry-out each
+  * @param[in] yPitch The distance in elements between vectors of Y
+  * @param[in] xPitch The distance in elements between vectors of X
+  * @param[in] alpha The scale of A * X
+  * @param[in] beta The scale of Y
+  */
+template <class T, int NUM_VECTORS>
+__global__
+void sparseMatrixVectorMergePath(T                  *d_y,
+                                 unsigned int       *d_carryRow,
+                                 T                  *d_carryValue,
+                                 const T            *d_A,
+                                 const T            *d_x,
+                                 const unsigned int *d_indx,
+                                 const unsigned int *d_rowEnd,
+                                 unsigned int       numRows,
+                                 unsigned int       numNZElts,
+                                 unsigned int       numTiles,
+                                 size_t             yPitch,
+                                 size_t             xPitch,
+                                 T                  alpha,
+                                 T                  beta)
+{
+    __shared__ unsigned int s_row[SPMV_CTA_SIZE];
+    __shared__ T            s_value[NUM_VECTORS][SPMV_CTA_SIZE];
 
-        tempFlags.x = tempFlags.y = tempFlags.z = tempFlags.w = 0;
-        outFlags[aiDev] = tempFlags;
-    }
-    else
+    unsigned int pathLength = numRows + numNZElts;
+
+    // The grid may be smaller than the number of tiles of the merge path
+    for (unsigned int tile = blockIdx.x; tile < numTiles; tile += gridDim.x)
     {
-        if (i < numNZElts)
+        unsigned int thread = tile * blockDim.x + threadIdx.x;
+        unsigned int diagonal = min(thread * SPMV_ITEMS_PER_THREAD, pathLength);
+        unsigned int diagonalEnd = min(diagonal + SPMV_ITEMS_PER_THREAD, pathLength);
+
+        unsigned int row = sparseMatrixVectorMergePathSearch(diagonal, d_rowEnd,
+                                                             numRows, numNZElts);
+        unsigned int rowLast = sparseMatrixVectorMergePathSearch(diagonalEnd, d_rowEnd,
+                                                                 numRows, numNZElts);
+        unsigned int nz = diagonal - row;
+        unsigned int nzLast = diagonalEnd - rowLast;
+        unsigned int firstRow = row;
+
+        // The first completed row may have been started by the previous
+        // thread, so its sum is held back until the carries are known
+        T firstSum[NUM_VECTORS];
+        T sum[NUM_VECTORS];
+#pragma unroll
+        for (int v = 0; v < NUM_VECTORS; ++v)
+            firstSum[v] = sum[v] = 0;
+
+        for (; row < rowLast; ++row)
+        {
+            unsigned int rowEnd = d_rowEnd[row];
+            for (; nz < rowEnd; ++nz)
+            {
+                T a = d_A[nz];
+                const T *x = d_x + d_indx[nz];
+#pragma unroll
+                for (int v = 0; v < NUM_VECTORS; ++v)
+                    sum[v] += a * x[v * xPitch];
+            }
+
+            if (row == firstRow)
+            {
+#pragma unroll
+                for (int v = 0; v < NUM_VECTORS; ++v)
+                    firstSum[v] = sum[v];
+            }
+            else
+                sparseMatrixVectorStoreRow<T, NUM_VECTORS>(d_y + row, sum, yPitch, alpha, beta);
+
+#pragma unroll
+            for (int v = 0; v < NUM_VECTORS; ++v)
+                sum[v] = 0;
+        }
+        for (; nz < nzLast; ++nz)
         {
-            d_prod[i] = d_A[i] * d_x[d_indx[i]];
-            d_flags[i] = 0;
+            T a = d_A[nz];
+            const T *x = d_x + d_indx[nz];
+#pragma unroll
+            for (int v = 0; v < NUM_VECTORS; ++v)
+                sum[v] += a * x[v * xPitch];
         }
-        if ((i+1) < numNZElts)
+
+        // Segmented scan of the carries; rows are non-decreasing across
+        // threads, so equal neighbors at any distance are in the same segment
+        s_row[threadIdx.x] = rowLast;
+#pragma unroll
+        for (int v = 0; v < NUM_VECTORS; ++v)
+            s_value[v][threadIdx.x] = sum[v];
+        __syncthreads();
+
+        for (unsigned int offset = 1; offset < SPMV_CTA_SIZE; offset <<= 1)
         {
-            d_prod[i+1] = d_A[i+1] * d_x[d_indx[i+1]];
-            d_flags[i+1] = 0;
+            bool sameRow = (threadIdx.x >= offset && 
+                            s_row[threadIdx.x - offset] == rowLast);
+#pragma unroll
+            for (int v = 0; v < NUM_VECTORS; ++v)
+            {
+                sum[v] = s_value[v][threadIdx.x];
+                if (sameRow)
+                    sum[v] += s_value[v][threadIdx.x - offset];
+            }
+            __syncthreads();
+#pragma unroll
+            for (int v = 0; v < NUM_VECTORS; ++v)
+                s_value[v][threadIdx.x] = sum[v];
+            __syncthreads();
         }
-        if ((i+2) < numNZElts)
+
+        if (firstRow < rowLast)
         {
-            d_prod[i+2] = d_A[i+2] * d_x[d_indx[i+2]];
-            d_flags[i+2] = 0;
+            if (threadIdx.x > 0 && s_row[threadIdx.x - 1] == firstRow)
+            {
+#pragma unroll
+                for (int v = 0; v < NUM_VECTORS; ++v)
+                    firstSum[v] += s_value[v][threadIdx.x - 1];
+            }
+            sparseMatrixVectorStoreRow<T, NUM_VECTORS>(d_y + firstRow, firstSum, yPitch, alpha, beta);
         }
-        if ((i+3) < numNZElts)
+
+        if (threadIdx.x == SPMV_CTA_SIZE - 1)
         {
-            d_prod[i+3] = d_A[i+3] * d_x[d_indx[i+3]];
-            d_flags[i+3] = 0;
+            d_carryRow[tile] = rowLast;
+#pragma unroll
+            for (int v = 0; v < NUM_VECTORS; ++v)
+                d_carryValue[v * numTiles + tile] = s_value[v][threadIdx.x];
         }
+        __syncthreads();
     }
+}
 
-    unsigned int biDev = aiDev + blockDim.x;
-    i = biDev * 4;
-    if (isFullBlock || ((i+3) < numNZElts) )
-    {
-        tempData = inData[biDev];
-        tempIndx = inIndx[biDev];
+/**
+  * @brief Merge-path carry fix-up kernel
+  *
+  * Adds the carry-outs of sparseMatrixVectorMergePath(), scaled by
+  * \a alpha, to d_y.  A row may span several tiles, so the first carry of
+  * each run of equal rows sums the run.  Carries past the last row hold no
+  * products and are skipped.
+  *
+  * Template parameter \a T is the datatype of the matrix A and X, and
+  * \a NUM_VECTORS the number of vectors.
+  *
+  * @param[in,out] d_y The output vectors
+  * @param[in] d_carryRow The row of each tile's carry-out
+  * @param[in] d_carryValue The partial sums of each tile's carry-out
+  * @param[in] numCarries The number of carry-outs (tiles of the multiply kernel)
+  * @param[in] numRows The number of rows in matrix A
+  * @param[in] yPitch The distance in elements between vectors of Y
+  * @param[in] alpha The scale of A * X
+  */
+template <class T, int NUM_VECTORS>
+__global__
+void sparseMatrixVectorMergePathFixup(T                  *d_y,
+                                      const unsigned int *d_carryRow,
+                                      const T            *d_carryValue,
+                                      unsigned int       numCarries,
+                                      unsigned int       numRows,
+                                      size_t             yPitch,
+                                      T                  alpha)
+{
+    unsigned int i = blockIdx.x * blockDim.x + threadIdx.x;
+    if (i >= numCarries)
+        return;
 
-        outData.x = tempData.x * d_x[tempIndx.x];
-        outData.y = tempData.y * d_x[tempIndx.y];
-        outData.z = tempData.z * d_x[tempIndx.z];
-        outData.w = tempData.w * d_x[tempIndx.w];
+    unsigned int row = d_carryRow[i];
+    if (row >= numRows || (i > 0 && d_carryRow[i-1] == row))
+        return;
 
-        outProd[biDev] = outData;
+    T sum[NUM_VECTORS];
+#pragma unroll
+    for (int v = 0; v < NUM_VECTORS; ++v)
+        sum[v] = d_carryValue[v * numCarries + i];
 
-        tempFlags.x = tempFlags.y = tempFlags.z = tempFlags.w = 0;
-        outFlags[biDev] = tempFlags;
+    for (unsigned int j = i + 1; j < numCarries && d_carryRow[j] == row; ++j)
+    {
+#pragma unroll
+        for (int v = 0; v < NUM_VECTORS; ++v)
+            sum[v] += d_carryValue[v * numCarries + j];
     }
-    else
+
+#pragma unroll
+    for (int v = 0; v < NUM_VECTORS; ++v)
+        d_y[row + v * yPitch] += alpha * sum[v];
+}
+
+/**
+  * @brief Sliced ELLPACK sparse matrix-vector multiply kernel
+  *
+  * Computes one row per thread of a matrix in SELL-C-sigma format: rows are
+  * grouped into slices of \a sliceHeight rows, and the elements of a slice are
+  * stored column-major, so element k of the row in lane l of slice s is at
+  * d_sliceStart[s] + k * sliceHeight + l and a warp reads consecutive words.
+  * Rows are sorted by length within sorting windows before slicing, and
+  * \a d_rowPermutation maps a sorted position back to its row.  ELLPACK is
+  * the special case of a single slice of all rows with no permutation
+  * (\a d_rowPermutation is NULL).
+  *
+  * Template parameter \a T is the datatype of the matrix A and X, and
+  * \a NUM_VECTORS the number of vectors.
+  *
+  * @param[in,out] d_y The output vectors Y = alpha * A * X + beta * Y
+  * @param[in] d_A The stored elements of matrix A
+  * @param[in] d_x The input vectors X
+  * @param[in] d_indx The column of each stored element
+  * @param[in] d_sliceStart The index in d_A of the first element of each slice
+  * @param[in] d_rowLength The number of nonzeros of the row at each sorted position
+  * @param[in] d_rowPermutation The row at each sorted position, or NULL for none
+  * @param[in] sliceHeight The number of rows per slice
+  * @param[in] numRows The number of rows in matrix A
+  * @param[in] yPitch The distance in elements between vectors of Y
+  * @param[in] xPitch The distance in elements between vectors of X
+  * @param[in] alpha The scale of A * X
+  * @param[in] beta The scale of Y
+  */
+template <class T, int NUM_VECTORS>
+__global__
+void sparseMatrixVectorSlicedEll(T                  *d_y,
+                                 const T            *d_A,
+                                 const T            *d_x,
+                                 const unsigned int *d_indx,
+                                 const unsigned int *d_sliceStart,
+                                 const unsigned int *d_rowLength,
+                                 const unsigned int *d_rowPermutation,
+                                 unsigned int       sliceHeight,
+                                 unsigned int       numRows,
+                                 size_t             yPitch,
+                                 size_t             xPitch,
+                                 T                  alpha,
+                                 T                  beta)
+{
+    for (unsigned int i = blockIdx.x * blockDim.x + threadIdx.x; i < numRows;
+         i += gridDim.x * blockDim.x)
     {
-        if (i < numNZElts)
-        {
-            d_prod[i] = d_A[i] * d_x[d_indx[i]];
-            d_flags[i] = 0;
-        }
-        if ((i+1) < numNZElts)
-        {
-            d_prod[i+1] = d_A[i+1] * d_x[d_indx[i+1]];
-            d_flags[i+1] = 0;
-        }
-        if ((i+2) < numNZElts)
-        {
-            d_prod[i+2] = d_A[i+2] * d_x[d_indx[i+2]];
-            d_flags[i+2] = 0;
-        }
-        if ((i+3) < numNZElts)
+        unsigned int slice = i / sliceHeight;
+        unsigned int idx = d_sliceStart[slice] + (i - slice * sliceHeight);
+        unsigned int length = d_rowLength[i];
+
+        T sum[NUM_VECTORS];
+#pragma unroll
+        for (int v = 0; v < NUM_VECTORS; ++v)
+            sum[v] = 0;
+
+        for (unsigned int k = 0; k < length; ++k, idx += sliceHeight)
         {
-            d_prod[i+3] = d_A[i+3] * d_x[d_indx[i+3]];
-            d_flags[i+3] = 0;
+            T a = d_A[idx];
+            const T *x = d_x + d_indx[idx];
+#pragma unroll
+            for (int v = 0; v < NUM_VECTORS; ++v)
+                sum[v] += a * x[v * xPitch];
         }
+
+        unsigned int row = d_rowPermutation ? d_rowPermutation[i] : i;
+        sparseMatrixVectorStoreRow<T, NUM_VECTORS>(d_y + row, sum, yPitch, alpha, beta);
     }
-#endif
+}
 
-#if 1
-    bool isLastBlock = (blockIdx.x == (gridDim.x-1));
-    unsigned int iGlobal = (blockIdx.x * (blockDim.x << 3)) + threadIdx.x;
-    
-    for (unsigned int i = 0; i < 8; ++i)
+/**
+  * @brief Block sparse row (BSR) sparse matrix-vector multiply kernel
+  *
+  * Computes one row per thread of a matrix stored as dense \a BLOCK x
+  * \a BLOCK blocks.  Blocks of block row r are d_blockRowEnd[r-1] (or 0) up
+  * to d_blockRowEnd[r]; each block is stored row-major and its block column
+  * is in d_blockCol.  Only one column index is read per block, and the
+  * fixed-size inner loop is unrolled.  Columns past \a numCols (in the last
+  * block column) are padding and are skipped.
+  *
+  * Template parameter \a T is the datatype of the matrix A and X,
+  * \a BLOCK is the block dimension and \a NUM_VECTORS the number of vectors.
+  *
+  * @param[in,out] d_y The output vectors Y = alpha * A * X + beta * Y
+  * @param[in] d_A The blocks of matrix A
+  * @param[in] d_x The input vectors X
+  * @param[in] d_blockCol The block column of each block
+  * @param[in] d_blockRowEnd The exclusive end of each block row in d_blockCol
+  * @param[in] numRows The number of rows in matrix A
+  * @param[in] numCols The number of columns in matrix A
+  * @param[in] yPitch The distance in elements between vectors of Y
+  * @param[in] xPitch The distance in elements between vectors of X
+  * @param[in] alpha The scale of A * X
+  * @param[in] beta The scale of Y
+  */
+template <class T, int BLOCK, int NUM_VECTORS>
+__global__
+void sparseMatrixVectorBlockRow(T                  *d_y,
+                                const T            *d_A,
+                                const T            *d_x,
+                                const unsigned int *d_blockCol,
+                                const unsigned int *d_blockRowEnd,
+                                unsigned int       numRows,
+                                unsigned int       numCols,
+                                size_t             yPitch,
+                                size_t             xPitch,
+                                T                  alpha,
+                                T                  beta)
+{
+    for (unsigned int row = blockIdx.x * blockDim.x + threadIdx.x; row < numRows;
+         row += gridDim.x * blockDim.x)
     {
-        if (isFullBlock)
-        {
-            d_prod[iGlobal] = d_A[iGlobal] * d_x[d_indx[iGlobal]];
-            d_flags[iGlobal] = 0;
-        }
-        else
+        unsigned int blockRow = row / BLOCK;
+        unsigned int localRow = row - blockRow * BLOCK;
+        unsigned int j = (blockRow > 0) ? d_blockRowEnd[blockRow - 1] : 0;
+        unsigned int end = d_blockRowEnd[blockRow];
+
+        T sum[NUM_VECTORS];
+#pragma unroll
+        for (int v = 0; v < NUM_VECTORS; ++v)
+            sum[v] = 0;
+
+        for (; j < end; ++j)
         {
-            if (isLastBlock)
+            const T *block = d_A + (size_t)j * BLOCK * BLOCK + localRow * BLOCK;
+            unsigned int col = d_blockCol[j] * BLOCK;
+            int width = (col + BLOCK <= numCols) ? BLOCK : (int)(numCols - col);
+#pragma unroll
+            for (int c = 0; c < BLOCK; ++c)
             {
-                if (iGlobal < numNZElts)
+                if (c < width)
                 {
-                    d_prod[iGlobal] = d_A[iGlobal] * d_x[d_indx[iGlobal]];
-                    d_flags[iGlobal] = 0;
+                    T a = block[c];
+                    const T *x = d_x + col + c;
+#pragma unroll
+                    for (int v = 0; v < NUM_VECTORS; ++v)
+                        sum[v] += a * x[v * xPitch];
                 }
             }
-            else
-            {
-                d_prod[iGlobal] = d_A[iGlobal] * d_x[d_indx[iGlobal]];
-                d_flags[iGlobal] = 0;
-            }
         }
+        sparseMatrixVectorStoreRow<T, NUM_VECTORS>(d_y + row, sum, yPitch, alpha, beta);
+    }
+}
 
-        iGlobal += blockDim.x;
+/**
+  * @brief Place new values of A, given in CSR order, in the storage format
+  *
+  * Each thread copies nonzero \a k to element \a d_position[k] of the
+  * stored matrix; padding elements are not touched and stay zero.  The
+  * positions must be distinct.
+  *
+  * @param[out] d_stored The elements of A in the storage format
+  * @param[in] d_values The new nonzeros of A in CSR order
+  * @param[in] d_position The index in \a d_stored of each nonzero
+  * @param[in] numNZElts The number of nonzeros
+  */
+template <class T>
+__global__
+void sparseMatrixScatterValues(T                  *d_stored,
+                               const T            *d_values,
+                               const unsigned int *d_position,
+                               unsigned int       numNZElts)
+{
+    for (unsigned int k = blockIdx.x * blockDim.x + threadIdx.x; k < numNZElts;
+         k += gridDim.x * blockDim.x)
+    {
+        d_stored[d_position[k]] = d_values[k];
     }
-#endif
-    __syncthreads();
 }
 
-/** 
-  * @brief Set Flags kernel
+/**
+  * @brief Gather vectors into the reordered numbering: d_out[i] = d_in[d_permutation[i]]
   *
-  * This __global__ device function takes an element from the vector d_rowindx, 
-  * and sets the corresponding position in d_flags to 1 
+  * @param[out] d_out The permuted vectors
+  * @param[in] d_in The vectors in the original numbering
+  * @param[in] d_permutation The original index of each permuted element
+  * @param[in] n The number of elements of each vector
+  * @param[in] numVectors The number of vectors
+  * @param[in] outPitch The distance in elements between vectors of \a d_out
+  * @param[in] inPitch The distance in elements between vectors of \a d_in
+  */
+template <class T>
+__global__
+void sparseMatrixGatherVectors(T                  *d_out,
+                               const T            *d_in,
+                               const unsigned int *d_permutation,
+                               unsigned int       n,
+                               unsigned int       numVectors,
+                               size_t             outPitch,
+                               size_t             inPitch)
+{
+    for (unsigned int i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+         i += gridDim.x * blockDim.x)
+    {
+        unsigned int j = d_permutation[i];
+        for (unsigned int v = 0; v < numVectors; ++v)
+            d_out[v * outPitch + i] = d_in[v * inPitch + j];
+    }
+}
+
+/**
+  * @brief Scatter vectors back to the original numbering: d_out[d_permutation[i]] = d_in[i]
   *
-  * @param[out] d_flags The output flags array
-  * @param[in] d_rowindx The starting index of each row in the "flattened" version
-  *                      of matrix A
-  * @param[in] numRows The number of rows in matrix A
+  * @param[out] d_out The vectors in the original numbering
+  * @param[in] d_in The permuted vectors
+  * @param[in] d_permutation The original index of each permuted element
+  * @param[in] n The number of elements of each vector
+  * @param[in] numVectors The number of vectors
+  * @param[in] outPitch The distance in elements between vectors of \a d_out
+  * @param[in] inPitch The distance in elements between vectors of \a d_in
   */
-__global__ 
-void sparseMatrixVectorSetFlags(
-                                unsigned int             *d_flags, 
-                                const unsigned int       *d_rowindx, 
-                                unsigned int             numRows
-                                )
+template <class T>
+__global__
+void sparseMatrixScatterVectors(T                  *d_out,
+                                const T            *d_in,
+                                const unsigned int *d_permutation,
+                                unsigned int       n,
+                                unsigned int       numVectors,
+                                size_t             outPitch,
+                                size_t             inPitch)
 {
-    unsigned int iGlobal = (blockIdx.x * (blockDim.x << 3)) + threadIdx.x;
+    for (unsigned int i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+         i += gridDim.x * blockDim.x)
+    {
+        unsigned int j = d_permutation[i];
+        for (unsigned int v = 0; v < numVectors; ++v)
+            d_out[v * outPitch + j] = d_in[v * inPitch + i];
+    }
+}
 
-    bool isLastBlock = (blockIdx.x == (gridDim.x-1));
+/**
+  * @brief Binary search in a nondecreasing array
+  *
+  * @param[in] d_a The array
+  * @param[in] n The number of elements of \a d_a
+  * @param[in] value The value searched for
+  * @returns The number of elements of \a d_a that are at most \a value
+  */
+__device__ unsigned int sparseMatrixUpperBound(const unsigned int *d_a,
+                                               unsigned int       n,
+                                               unsigned int       value)
+{
+    unsigned int lo = 0;
+    unsigned int hi = n;
 
-    for (unsigned int i = 0; i < 8; ++i)
+    while (lo < hi)
     {
-        if (isLastBlock)
-        {
-            if (iGlobal < numRows)
-            {
-                d_flags[d_rowindx[iGlobal]] = 1;
-            }
-        }
+        unsigned int pivot = (lo + hi) >> 1;
+        if (d_a[pivot] <= value)
+            lo = pivot + 1;
         else
-        {
-            d_flags[d_rowindx[iGlobal]] = 1;
-        }
+            hi = pivot;
+    }
+    return lo;
+}
+
+/**
+  * @brief Locate product \a p of the sparse matrix product L * R
+  *
+  * Product \a p is the one of left nonzero \a e (the last one whose offset
+  * is at most \a p) with the nonzero \a p - d_offset[e] of the row of R
+  * given by the column of \a e.
+  *
+  * @param[out] e The nonzero of L
+  * @param[out] r The nonzero of R
+  * @param[in] p The product
+  * @param[in] d_offset The index of the first product of each nonzero of L
+  * @param[in] d_leftIndex The column of each nonzero of L
+  * @param[in] d_rightRowEnd The end of each row of R
+  * @param[in] numLeftNZElts The number of nonzeros of L
+  */
+__device__ void sparseMatrixProductSource(unsigned int       &e,
+                                          unsigned int       &r,
+                                          unsigned int       p,
+                                          const unsigned int *d_offset,
+                                          const unsigned int *d_leftIndex,
+                                          const unsigned int *d_rightRowEnd,
+                                          unsigned int       numLeftNZElts)
+{
+    e = sparseMatrixUpperBound(d_offset, numLeftNZElts, p) - 1;
+    unsigned int k = d_leftIndex[e];
+    r = ((k > 0) ? d_rightRowEnd[k-1] : 0) + p - d_offset[e];
+}
 
-        iGlobal += blockDim.x;
+/**
+  * @brief Count the products of each nonzero of L in the sparse matrix product L * R
+  *
+  * Nonzero (i, k) of L is multiplied by every nonzero of row k of R.
+  *
+  * @param[out] d_count The number of products of each nonzero of L
+  * @param[in] d_leftIndex The column of each nonzero of L
+  * @param[in] d_rightRowEnd The end of each row of R
+  * @param[in] numLeftNZElts The number of nonzeros of L
+  */
+__global__
+void sparseMatrixProductCounts(unsigned int       *d_count,
+                               const unsigned int *d_leftIndex,
+                               const unsigned int *d_rightRowEnd,
+                               unsigned int       numLeftNZElts)
+{
+    for (unsigned int e = blockIdx.x * blockDim.x + threadIdx.x; e < numLeftNZElts;
+         e += gridDim.x * blockDim.x)
+    {
+        unsigned int k = d_leftIndex[e];
+        d_count[e] = d_rightRowEnd[k] - ((k > 0) ? d_rightRowEnd[k-1] : 0);
     }
-    
-    __syncthreads();
 }
 
-/** 
-  * @brief Gather final y values kernel
+/**
+  * @brief Flag whether the 32-bit scan of the product counts overflowed
   *
-  * This __global__ device function takes an element from the vector d_rowFindx,
-  * which for each row gives the index of the last element of that row, reads the
-  * corresponding position in d_prod and write it in d_y
+  * Each count is below 2^32, so the running sum wraps at nonzero e 
+  * exactly when the offset of e plus its count is less than its offset.
   *
-  * Template parameter \a T is the datatype of the matrix A and x.
+  * @param[out] d_overflow Set to 1 if the scan overflowed; left as is otherwise
+  * @param[in] d_offset The exclusive scan of the product counts
+  * @param[in] d_count The number of products of each nonzero of L
+  * @param[in] numLeftNZElts The number of nonzeros of L
+  */
+__global__
+void sparseMatrixProductOverflow(unsigned int       *d_overflow,
+                                 const unsigned int *d_offset,
+                                 const unsigned int *d_count,
+                                 unsigned int       numLeftNZElts)
+{
+    for (unsigned int e = blockIdx.x * blockDim.x + threadIdx.x; e < numLeftNZElts;
+         e += gridDim.x * blockDim.x)
+    {
+        if (d_offset[e] + d_count[e] < d_offset[e])
+            *d_overflow = 1;
+    }
+}
+
+/**
+  * @brief Compute the sort key of each product of the sparse matrix product L * R
   *
-  * @param[out] d_y The output result array
-  * @param[in] d_prod The input products array (which now contains sums for each row)
-  * @param[in] d_rowFindx The starting index of each row in the "flattened" version
-  *                       of matrix A
-  * @param[in] numRows The number of rows in matrix A
+  * The key of a product is its row times \a numCols plus its column, so
+  * sorting the keys groups the products of each element of the result in
+  * row-major order.  The identity is written to \a d_order, to be sorted
+  * along with the keys.
+  *
+  * @param[out] d_keys The key of each product
+  * @param[out] d_order The index of each product
+  * @param[in] d_offset The index of the first product of each nonzero of L
+  * @param[in] d_leftRowEnd The end of each row of L
+  * @param[in] d_leftIndex The column of each nonzero of L
+  * @param[in] d_rightRowEnd The end of each row of R
+  * @param[in] d_rightIndex The column of each nonzero of R
+  * @param[in] numLeftRows The number of rows of L
+  * @param[in] numLeftNZElts The number of nonzeros of L
+  * @param[in] numProducts The number of products
+  * @param[in] numCols The number of columns of R
   */
-template <class T>
-__global__ 
-void yGather(
-             T                  *d_y, 
-             const T            *d_prod,
-             const unsigned int *d_rowFindx,
-             unsigned int       numRows
-             )
+template <class K>
+__global__
+void sparseMatrixProductKeys(K                  *d_keys,
+                             unsigned int       *d_order,
+                             const unsigned int *d_offset,
+                             const unsigned int *d_leftRowEnd,
+                             const unsigned int *d_leftIndex,
+                             const unsigned int *d_rightRowEnd,
+                             const unsigned int *d_rightIndex,
+                             unsigned int       numLeftRows,
+                             unsigned int       numLeftNZElts,
+                             unsigned int       numProducts,
+                             unsigned int       numCols)
+{
+    for (unsigned int p = blockIdx.x * blockDim.x + threadIdx.x; p < numProducts;
+         p += gridDim.x * blockDim.x)
+    {
+        unsigned int e, r;
+        sparseMatrixProductSource(e, r, p, d_offset, d_leftIndex, d_rightRowEnd,
+                                  numLeftNZElts);
+        unsigned int row = sparseMatrixUpperBound(d_leftRowEnd, numLeftRows, e);
+
+        d_keys[p] = (K)row * numCols + d_rightIndex[r];
+        d_order[p] = p;
+    }
+}
+
+/**
+  * @brief Flag the first of each run of equal sorted product keys
+  *
+  * @param[out] d_flags 1 for the first product of each element of the result, 0 otherwise
+  * @param[in] d_keys The sorted product keys
+  * @param[in] numProducts The number of products
+  */
+template <class K>
+__global__
+void sparseMatrixProductHeads(unsigned int *d_flags,
+                              const K      *d_keys,
+                              unsigned int numProducts)
+{
+    for (unsigned int s = blockIdx.x * blockDim.x + threadIdx.x; s < numProducts;
+         s += gridDim.x * blockDim.x)
+    {
+        d_flags[s] = (s == 0 || d_keys[s] != d_keys[s-1]) ? 1 : 0;
+    }
+}
+
+/**
+  * @brief Write the row, column and first sorted product of each element of the result
+  *
+  * @param[out] d_start The first sorted product of each element
+  * @param[out] d_row The row of each element
+  * @param[out] d_index The column of each element
+  * @param[in] d_keys The sorted product keys
+  * @param[in] d_flags The run head flags from sparseMatrixProductHeads()
+  * @param[in] d_element The exclusive scan of \a d_flags: the element of each product
+  * @param[in] numProducts The number of products
+  * @param[in] numCols The number of columns of the result
+  */
+template <class K>
+__global__
+void sparseMatrixProductElements(unsigned int       *d_start,
+                                 unsigned int       *d_row,
+                                 unsigned int       *d_index,
+                                 const K            *d_keys,
+                                 const unsigned int *d_flags,
+                                 const unsigned int *d_element,
+                                 unsigned int       numProducts,
+                                 unsigned int       numCols)
 {
-    
-    unsigned int iGlobal = (blockIdx.x * (blockDim.x << 3)) + threadIdx.x;
-    
-    bool isLastBlock = (blockIdx.x == (gridDim.x-1));
-    
-    for (unsigned int i=0; i < 8; ++i)
+    for (unsigned int s = blockIdx.x * blockDim.x + threadIdx.x; s < numProducts;
+         s += gridDim.x * blockDim.x)
     {
-        if (isLastBlock)
+        if (d_flags[s])
         {
-            if (iGlobal < numRows)
-            {
-                d_y[iGlobal] += d_prod[d_rowFindx[iGlobal]-1];
-            }
+            unsigned int c = d_element[s];
+            d_start[c] = s;
+            d_row[c] = (unsigned int)(d_keys[s] / numCols);
+            d_index[c] = (unsigned int)(d_keys[s] % numCols);
         }
-        else
+    }
+}
+
+/**
+  * @brief Compute the row end offsets of the result from the row of each element
+  *
+  * The thread of the last element of each row writes the end of that row
+  * and of the empty rows that follow it; the thread of the first element
+  * writes the empty rows before it.
+  *
+  * @param[out] d_rowEnd The end of each row of the result
+  * @param[in] d_row The row of each element, nondecreasing
+  * @param[in] numElements The number of elements of the result, at least one
+  * @param[in] numRows The number of rows of the result
+  */
+__global__
+void sparseMatrixProductRowEnds(unsigned int       *d_rowEnd,
+                                const unsigned int *d_row,
+                                unsigned int       numElements,
+                                unsigned int       numRows)
+{
+    for (unsigned int c = blockIdx.x * blockDim.x + threadIdx.x; c < numElements;
+         c += gridDim.x * blockDim.x)
+    {
+        unsigned int row = d_row[c];
+        unsigned int nextRow = (c + 1 < numElements) ? d_row[c+1] : numRows;
+
+        for (unsigned int i = row; i < nextRow; ++i)
+            d_rowEnd[i] = c + 1;
+        if (c == 0)
         {
-            d_y[iGlobal] += d_prod[d_rowFindx[iGlobal]-1];
+            for (unsigned int i = 0; i < row; ++i)
+                d_rowEnd[i] = 0;
         }
-
-        iGlobal += blockDim.x;
     }
+}
 
-    __syncthreads();
-
+/**
+  * @brief Numeric phase of the sparse matrix product L * R
+  *
+  * Each thread sums the products of one element of the result, which are
+  * the sorted products \a d_start[c] to \a d_start[c+1] - 1.  The products
+  * are recomputed from L and R through \a d_order, so the values of L and R
+  * may change between calls as long as their sparsity patterns do not.
+  *
+  * @param[out] d_values The elements of the result in CSR order
+  * @param[in] d_start The first sorted product of each element, and the number of products
+  * @param[in] d_order The product at each sorted position
+  * @param[in] d_offset The index of the first product of each nonzero of L
+  * @param[in] d_leftIndex The column of each nonzero of L
+  * @param[in] d_leftValues The nonzeros of L
+  * @param[in] d_rightRowEnd The end of each row of R
+  * @param[in] d_rightValues The nonzeros of R
+  * @param[in] numLeftNZElts The number of nonzeros of L
+  * @param[in] numElements The number of elements of the result
+  */
+template <class T>
+__global__
+void sparseMatrixProductValues(T                  *d_values,
+                               const unsigned int *d_start,
+                               const unsigned int *d_order,
+                               const unsigned int *d_offset,
+                               const unsigned int *d_leftIndex,
+                               const T            *d_leftValues,
+                               const unsigned int *d_rightRowEnd,
+                               const T            *d_rightValues,
+                               unsigned int       numLeftNZElts,
+                               unsigned int       numElements)
+{
+    for (unsigned int c = blockIdx.x * blockDim.x + threadIdx.x; c < numElements;
+         c += gridDim.x * blockDim.x)
+    {
+        T sum = 0;
+        for (unsigned int s = d_start[c]; s < d_start[c+1]; ++s)
+        {
+            unsigned int e, r;
+            sparseMatrixProductSource(e, r, d_order[s], d_offset, d_leftIndex,
+                                      d_rightRowEnd, numLeftNZElts);
+            sum += d_leftValues[e] * d_rightValues[r];
+        }
+        d_values[c] = sum;
+    }
 }
 
 /** @} */ // end sparse matrix vector multiply functions
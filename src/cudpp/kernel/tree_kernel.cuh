@@ -0,0 +1,599 @@
+// -------------------------------------------------------------
+// CUDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+#include <cudpp_globals.h>
+#include <stdio.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/**
+ * @file
+ * tree_kernel.cuh
+ *
+ * @brief CUDPP kernel-level Euler tour tree routines
+ */
+
+/** \addtogroup cudpp_kernel
+ * @{
+ */
+
+/** @name Tree Functions
+ * @{
+ */
+
+/* The Euler tour of a forest of n nodes has 2n arcs: arc v enters node v
+ * from its parent and arc n + v leaves it.  The roots are the children of
+ * a virtual root, so the tour of the whole forest is a single list.  Each
+ * down arc has value 2^32 + 1 and each up arc value -1, so the exclusive
+ * prefix of an arc holds the number of down arcs before it in its high
+ * word and the number of open nodes (down arcs minus up arcs) in its low
+ * word.  Every per-node quantity follows from the prefixes of its two
+ * arcs; the functions below are shared by the kernels and the host path.
+ */
+
+/**
+ * @brief Key of node \a v when grouping the nodes by parent.
+ *
+ * @param[in] d_parent Parent of each node, negative for roots
+ * @param[in] v The node
+ * @param[in] numNodes Number of nodes, the key of the virtual root
+ * @returns The parent of \a v, or \a numNodes for a root
+ */
+__host__ __device__ inline
+unsigned int treeParentKey(const int *d_parent, size_t v, size_t numNodes)
+{
+    int p = d_parent[v];
+    return (p < 0) ? (unsigned int)numNodes : (unsigned int)p;
+}
+
+/**
+ * @brief Link the item at sorted position \a i to its group.
+ *
+ * After the items are sorted by key, the first item of each run of equal
+ * keys is the first item of that key and each item is followed by the
+ * next item of its run.
+ *
+ * @param[out] d_first First item of each key (written for keys with items)
+ * @param[out] d_nextInGroup Next item with the same key, -1 for the last (may be NULL)
+ * @param[in]  d_keys Sorted keys
+ * @param[in]  d_order Item at each sorted position
+ * @param[in]  i The sorted position
+ * @param[in]  numItems Number of items
+ */
+__host__ __device__ inline
+void treeLinkGroup(int                 *d_first,
+                   int                 *d_nextInGroup,
+                   const unsigned int  *d_keys,
+                   const unsigned int  *d_order,
+                   size_t              i,
+                   size_t              numItems)
+{
+    unsigned int key = d_keys[i];
+    if (i == 0 || d_keys[i-1] != key)
+        d_first[key] = (int)d_order[i];
+    if (d_nextInGroup != NULL)
+        d_nextInGroup[d_order[i]] = (i + 1 < numItems && d_keys[i+1] == key) ?
+            (int)d_order[i+1] : -1;
+}
+
+/**
+ * @brief Write the Euler tour arcs of node \a v.
+ *
+ * The down arc of \a v is followed by the down arc of its first child,
+ * or by its own up arc for a leaf.  The up arc is followed by the down
+ * arc of the next sibling, or by the up arc of the parent for the last
+ * child; the up arc of the last root ends the tour.
+ *
+ * @param[out] d_next Next arc of each arc
+ * @param[out] d_value Value of each arc
+ * @param[in]  d_parent Parent of each node, negative for roots
+ * @param[in]  d_firstChild First child of each node, -1 for leaves
+ * @param[in]  d_nextSibling Next child of the same parent, -1 for the last
+ * @param[in]  v The node
+ * @param[in]  numNodes Number of nodes
+ */
+__host__ __device__ inline
+void treeEulerNode(int                      *d_next,
+                   unsigned long long       *d_value,
+                   const int                *d_parent,
+                   const int                *d_firstChild,
+                   const int                *d_nextSibling,
+                   size_t                   v,
+                   size_t                   numNodes)
+{
+    int child = d_firstChild[v];
+    int sibling = d_nextSibling[v];
+    int parent = d_parent[v];
+
+    d_next[v] = (child >= 0) ? child : (int)(numNodes + v);
+    d_value[v] = (1ULL << 32) + 1;
+
+    d_next[numNodes + v] = (sibling >= 0) ? sibling :
+                           (parent >= 0) ? (int)numNodes + parent : -1;
+    d_value[numNodes + v] = ~0ULL;
+}
+
+/**
+ * @brief Record the sorted position of the arc at position \a i.
+ *
+ * The first sorted position of the arcs leaving each node is recorded
+ * too, so that the arcs leaving a node can be followed cyclically.
+ *
+ * @param[out] d_firstPosition First sorted position of the arcs leaving each node
+ * @param[out] d_positionOf Sorted position of each arc
+ * @param[in]  d_keys Sorted source nodes
+ * @param[in]  d_order Arc at each sorted position
+ * @param[in]  i The sorted position
+ */
+__host__ __device__ inline
+void treeLinkArc(int                 *d_firstPosition,
+                 int                 *d_positionOf,
+                 const unsigned int  *d_keys,
+                 const unsigned int  *d_order,
+                 size_t              i)
+{
+    if (i == 0 || d_keys[i-1] != d_keys[i])
+        d_firstPosition[d_keys[i]] = (int)i;
+    d_positionOf[d_order[i]] = (int)i;
+}
+
+/**
+ * @brief Next arc of arc \a a in the Euler tour of a spanning tree.
+ *
+ * The arcs leaving each node are in cyclic order by sorted position, and
+ * arc u->v is followed by the arc after v->u around v.  The tour is cut
+ * before \a head, the first arc leaving the root.
+ *
+ * @param[in] d_firstPosition First sorted position of the arcs leaving each node
+ * @param[in] d_positionOf Sorted position of each arc
+ * @param[in] d_keys Source node at each sorted position
+ * @param[in] d_order Arc at each sorted position
+ * @param[in] head First arc of the tour
+ * @param[in] a The arc
+ * @param[in] numArcs Number of arcs
+ * @returns The next arc, or -1 for the last arc of the tour
+ */
+__host__ __device__ inline
+int treeEulerArc(const int           *d_firstPosition,
+                 const int           *d_positionOf,
+                 const unsigned int  *d_keys,
+                 const unsigned int  *d_order,
+                 unsigned int        head,
+                 size_t              a,
+                 size_t              numArcs)
+{
+    size_t i = d_positionOf[a ^ 1];
+    size_t j = (i + 1 < numArcs && d_keys[i+1] == d_keys[i]) ?
+        i + 1 : (size_t)d_firstPosition[d_keys[i]];
+    unsigned int next = d_order[j];
+    return (next == head) ? -1 : (int)next;
+}
+
+/**
+ * @brief Orient edge \a e by the tour ranks of its two arcs: the arc that
+ * comes first runs from the parent to the child.
+ */
+__host__ __device__ inline
+void treeOrientEdge(int                         *d_parent,
+                    const int                   *d_edgeU,
+                    const int                   *d_edgeV,
+                    const unsigned long long    *d_rank,
+                    size_t                      e)
+{
+    if (d_rank[2*e] < d_rank[2*e+1])
+        d_parent[d_edgeV[e]] = d_edgeU[e];
+    else
+        d_parent[d_edgeU[e]] = d_edgeV[e];
+}
+
+/** @brief Pre-order number of node \a v from the tour prefixes */
+__host__ __device__ inline
+int treePreorder(const unsigned long long *d_prefix, size_t v)
+{
+    return (int)(d_prefix[v] >> 32);
+}
+
+/** @brief Depth of node \a v (0 for roots) from the tour prefixes */
+__host__ __device__ inline
+int treeDepth(const unsigned long long *d_prefix, size_t v)
+{
+    return (int)(d_prefix[v] & 0xFFFFFFFFULL);
+}
+
+/** @brief Number of nodes in the subtree of node \a v from the tour prefixes */
+__host__ __device__ inline
+int treeSubtreeSize(const unsigned long long *d_prefix, size_t v, size_t numNodes)
+{
+    return (int)((d_prefix[numNodes + v] >> 32) - (d_prefix[v] >> 32));
+}
+
+/**
+ * @brief Write the pre-order, post-order, depth and subtree size of node
+ * \a v; any of the outputs may be NULL.  The post-order number is the
+ * number of up arcs before the up arc of \a v, which is the number of
+ * down arcs before it less the nodes still open.
+ */
+__host__ __device__ inline
+void treeOrderNode(int                          *d_preorder,
+                   int                          *d_postorder,
+                   int                          *d_depth,
+                   int                          *d_subtreeSize,
+                   const unsigned long long     *d_prefix,
+                   size_t                       v,
+                   size_t                       numNodes)
+{
+    int pre = treePreorder(d_prefix, v);
+    int depth = treeDepth(d_prefix, v);
+    int size = treeSubtreeSize(d_prefix, v, numNodes);
+    if (d_preorder != NULL)     d_preorder[v] = pre;
+    if (d_postorder != NULL)    d_postorder[v] = pre + size - depth - 1;
+    if (d_depth != NULL)        d_depth[v] = depth;
+    if (d_subtreeSize != NULL)  d_subtreeSize[v] = size;
+}
+
+/** @brief Largest k with 2^k <= \a x, for \a x > 0 */
+__host__ __device__ inline
+int treeLog2(size_t x)
+{
+    int k = 0;
+    while (x >>= 1)
+        ++k;
+    return k;
+}
+
+/**
+ * @brief Shallower of two pre-order positions.
+ *
+ * @param[in] a A pre-order position, or -1
+ * @param[in] b A pre-order position
+ * @param[in] d_nodeAtPre Node at each pre-order position
+ * @param[in] d_prefix Tour prefixes
+ * @returns \a b if \a a is -1 or deeper than \a b, else \a a
+ */
+__host__ __device__ inline
+int treeShallower(int a, int b, const int *d_nodeAtPre,
+                  const unsigned long long *d_prefix)
+{
+    if (a < 0)
+        return b;
+    return (treeDepth(d_prefix, d_nodeAtPre[b]) < treeDepth(d_prefix, d_nodeAtPre[a])) ? b : a;
+}
+
+/**
+ * @brief Entry \a b of level \a level of the LCA sparse table.
+ *
+ * Level 0 holds the shallowest pre-order position of each block of
+ * TREE_LCA_BLOCK_SIZE positions, and level k the shallowest position of
+ * blocks b to b + 2^k - 1, from two entries of level k - 1.
+ *
+ * @param[in,out] d_table Sparse table, \a numBlocks entries per level
+ * @param[in] d_nodeAtPre Node at each pre-order position
+ * @param[in] d_prefix Tour prefixes
+ * @param[in] b The block
+ * @param[in] level The level
+ * @param[in] numNodes Number of nodes
+ * @param[in] numBlocks Number of blocks
+ */
+__host__ __device__ inline
+void treeLCATableEntry(int                      *d_table,
+                       const int                *d_nodeAtPre,
+                       const unsigned long long *d_prefix,
+                       size_t                   b,
+                       int                      level,
+                       size_t                   numNodes,
+                       size_t                   numBlocks)
+{
+    int best = -1;
+    if (level == 0)
+    {
+        size_t last = (b + 1) * TREE_LCA_BLOCK_SIZE;
+        if (last > numNodes)
+            last = numNodes;
+        for (size_t p = b * TREE_LCA_BLOCK_SIZE; p < last; ++p)
+            best = treeShallower(best, (int)p, d_nodeAtPre, d_prefix);
+    }
+    else
+    {
+        const int *prev = d_table + (level - 1) * numBlocks;
+        size_t half = (size_t)1 << (level - 1);
+        best = prev[b];
+        if (b + half < numBlocks)
+            best = treeShallower(best, prev[b + half], d_nodeAtPre, d_prefix);
+    }
+    d_table[level * numBlocks + b] = best;
+}
+
+/**
+ * @brief Lowest common ancestor of nodes \a u and \a v.
+ *
+ * With pre[u] < pre[v], the shallowest node at pre-order positions
+ * pre[u] + 1 to pre[v] is a child of the LCA, so the LCA is its parent.
+ * Whole blocks of the range are looked up in the sparse table and the
+ * partial blocks at its ends are scanned.
+ *
+ * @param[in] d_parent Parent of each node, negative for roots
+ * @param[in] d_nodeAtPre Node at each pre-order position
+ * @param[in] d_prefix Tour prefixes
+ * @param[in] d_table LCA sparse table
+ * @param[in] u A node
+ * @param[in] v A node
+ * @param[in] numBlocks Number of blocks
+ * @returns The lowest common ancestor, or -1 for nodes of different trees
+ */
+__host__ __device__ inline
+int treeLCA(const int                   *d_parent,
+            const int                   *d_nodeAtPre,
+            const unsigned long long    *d_prefix,
+            const int                   *d_table,
+            int                         u,
+            int                         v,
+            size_t                      numBlocks)
+{
+    if (u == v)
+        return u;
+
+    size_t lo = treePreorder(d_prefix, u);
+    size_t hi = treePreorder(d_prefix, v);
+    if (lo > hi)
+    {
+        size_t t = lo; lo = hi; hi = t;
+    }
+    ++lo;
+
+    size_t loBlock = lo / TREE_LCA_BLOCK_SIZE;
+    size_t hiBlock = hi / TREE_LCA_BLOCK_SIZE;
+    int best = -1;
+
+    if (loBlock == hiBlock)
+    {
+        for (size_t p = lo; p <= hi; ++p)
+            best = treeShallower(best, (int)p, d_nodeAtPre, d_prefix);
+    }
+    else
+    {
+        for (size_t p = lo; p < (loBlock + 1) * TREE_LCA_BLOCK_SIZE; ++p)
+            best = treeShallower(best, (int)p, d_nodeAtPre, d_prefix);
+        for (size_t p = hiBlock * TREE_LCA_BLOCK_SIZE; p <= hi; ++p)
+            best = treeShallower(best, (int)p, d_nodeAtPre, d_prefix);
+        if (hiBlock > loBlock + 1)
+        {
+            size_t first = loBlock + 1;
+            size_t count = hiBlock - first;
+            int k = treeLog2(count);
+            const int *level = d_table + k * numBlocks;
+            best = treeShallower(best, level[first], d_nodeAtPre, d_prefix);
+            best = treeShallower(best, level[hiBlock - ((size_t)1 << k)], d_nodeAtPre, d_prefix);
+        }
+    }
+
+    return d_parent[d_nodeAtPre[best]];
+}
+
+/**
+ * @brief Key each item by its group for cudppRadixSortDispatch().
+ *
+ * Items are nodes keyed by parent (\a d_edgeU NULL) or the arcs of an
+ * edge list keyed by source: arc 2e runs from d_edgeU[e] to d_edgeV[e]
+ * and arc 2e + 1 back.
+ *
+ * @param[out] d_keys Key of each item
+ * @param[out] d_order Index of each item
+ * @param[in]  d_parent Parent of each node (when grouping nodes)
+ * @param[in]  d_edgeU First node of each edge (when grouping arcs)
+ * @param[in]  d_edgeV Second node of each edge (when grouping arcs)
+ * @param[in]  numItems Number of items
+ * @param[in]  numNodes Number of nodes
+ */
+__global__ void tree_group_keys(unsigned int    *d_keys,
+                                unsigned int    *d_order,
+                                const int       *d_parent,
+                                const int       *d_edgeU,
+                                const int       *d_edgeV,
+                                size_t          numItems,
+                                size_t          numNodes)
+{
+    for (size_t i = threadIdx.x + (blockIdx.x * blockDim.x); i < numItems;
+         i += gridDim.x * blockDim.x)
+    {
+        if (d_edgeU == NULL)
+            d_keys[i] = treeParentKey(d_parent, i, numNodes);
+        else
+            d_keys[i] = (unsigned int)((i & 1) ? d_edgeV[i >> 1] : d_edgeU[i >> 1]);
+        d_order[i] = (unsigned int)i;
+    }
+}
+
+/**
+ * @brief Link the sorted items to their groups with treeLinkGroup().
+ *
+ * When \a d_positionOf is not NULL the sorted position of each item is
+ * also recorded in it, and \a d_first receives the first sorted position
+ * of each key instead of its first item.
+ */
+__global__ void tree_link_groups(int                 *d_first,
+                                 int                 *d_nextInGroup,
+                                 int                 *d_positionOf,
+                                 const unsigned int  *d_keys,
+                                 const unsigned int  *d_order,
+                                 size_t              numItems)
+{
+    for (size_t i = threadIdx.x + (blockIdx.x * blockDim.x); i < numItems;
+         i += gridDim.x * blockDim.x)
+    {
+        if (d_positionOf == NULL)
+            treeLinkGroup(d_first, d_nextInGroup, d_keys, d_order, i, numItems);
+        else
+            treeLinkArc(d_first, d_positionOf, d_keys, d_order, i);
+    }
+}
+
+/**
+ * @brief Write the Euler tour of a forest with treeEulerNode().
+ */
+__global__ void tree_euler_nodes(int                        *d_next,
+                                 unsigned long long         *d_value,
+                                 const int                  *d_parent,
+                                 const int                  *d_firstChild,
+                                 const int                  *d_nextSibling,
+                                 size_t                     numNodes)
+{
+    for (size_t v = threadIdx.x + (blockIdx.x * blockDim.x); v < numNodes;
+         v += gridDim.x * blockDim.x)
+    {
+        treeEulerNode(d_next, d_value, d_parent, d_firstChild, d_nextSibling,
+                      v, numNodes);
+    }
+}
+
+/**
+ * @brief Link the arcs of a spanning tree into its Euler tour with
+ * treeEulerArc(), cut before the first arc leaving \a root.  Called by
+ * treeFromEdges().
+ *
+ * @param[out] d_next Next arc of each arc
+ * @param[in]  d_firstPosition First sorted position of the arcs leaving each node
+ * @param[in]  d_positionOf Sorted position of each arc
+ * @param[in]  d_keys Source node at each sorted position
+ * @param[in]  d_order Arc at each sorted position
+ * @param[in]  root The root
+ * @param[in]  numArcs Number of arcs
+ */
+__global__ void tree_euler_arcs(int                 *d_next,
+                                const int           *d_firstPosition,
+                                const int           *d_positionOf,
+                                const unsigned int  *d_keys,
+                                const unsigned int  *d_order,
+                                int                 root,
+                                size_t              numArcs)
+{
+    unsigned int head = d_order[d_firstPosition[root]];
+    for (size_t a = threadIdx.x + (blockIdx.x * blockDim.x); a < numArcs;
+         a += gridDim.x * blockDim.x)
+    {
+        d_next[a] = treeEulerArc(d_firstPosition, d_positionOf, d_keys, d_order,
+                                 head, a, numArcs);
+    }
+}
+
+/**
+ * @brief Give every arc of an edge list the value 1 and record the head
+ * of the tour, the first arc leaving \a root.  Called by treeFromEdges().
+ */
+__global__ void tree_arc_values(unsigned long long  *d_value,
+                                int                 *d_head,
+                                int                 *d_parent,
+                                const int           *d_firstPosition,
+                                const unsigned int  *d_order,
+                                int                 root,
+                                size_t              numArcs)
+{
+    for (size_t a = threadIdx.x + (blockIdx.x * blockDim.x); a < numArcs;
+         a += gridDim.x * blockDim.x)
+    {
+        d_value[a] = 1;
+        if (a == 0)
+        {
+            *d_head = (int)d_order[d_firstPosition[root]];
+            d_parent[root] = -1;
+        }
+    }
+}
+
+/**
+ * @brief Orient each edge of a spanning tree with treeOrientEdge().
+ */
+__global__ void tree_orient_edges(int                       *d_parent,
+                                  const int                 *d_edgeU,
+                                  const int                 *d_edgeV,
+                                  const unsigned long long  *d_rank,
+                                  size_t                    numEdges)
+{
+    for (size_t e = threadIdx.x + (blockIdx.x * blockDim.x); e < numEdges;
+         e += gridDim.x * blockDim.x)
+    {
+        treeOrientEdge(d_parent, d_edgeU, d_edgeV, d_rank, e);
+    }
+}
+
+/**
+ * @brief Record the node at each pre-order position.
+ */
+__global__ void tree_number_nodes(int                       *d_nodeAtPre,
+                                  const unsigned long long  *d_prefix,
+                                  size_t                    numNodes)
+{
+    for (size_t v = threadIdx.x + (blockIdx.x * blockDim.x); v < numNodes;
+         v += gridDim.x * blockDim.x)
+    {
+        d_nodeAtPre[treePreorder(d_prefix, v)] = (int)v;
+    }
+}
+
+/**
+ * @brief Build level \a level of the LCA sparse table with treeLCATableEntry().
+ */
+__global__ void tree_lca_table(int                      *d_table,
+                               const int                *d_nodeAtPre,
+                               const unsigned long long *d_prefix,
+                               int                      level,
+                               size_t                   numNodes,
+                               size_t                   numBlocks)
+{
+    for (size_t b = threadIdx.x + (blockIdx.x * blockDim.x); b < numBlocks;
+         b += gridDim.x * blockDim.x)
+    {
+        treeLCATableEntry(d_table, d_nodeAtPre, d_prefix, b, level,
+                          numNodes, numBlocks);
+    }
+}
+
+/**
+ * @brief Write the pre-order, post-order, depth and subtree size of every
+ * node with treeOrderNode().
+ */
+__global__ void tree_order(int                          *d_preorder,
+                           int                          *d_postorder,
+                           int                          *d_depth,
+                           int                          *d_subtreeSize,
+                           const unsigned long long     *d_prefix,
+                           size_t                       numNodes)
+{
+    for (size_t v = threadIdx.x + (blockIdx.x * blockDim.x); v < numNodes;
+         v += gridDim.x * blockDim.x)
+    {
+        treeOrderNode(d_preorder, d_postorder, d_depth, d_subtreeSize,
+                      d_prefix, v, numNodes);
+    }
+}
+
+/**
+ * @brief Answer a batch of LCA queries with treeLCA().
+ */
+__global__ void tree_lca(int                        *d_lca,
+                         const int                  *d_u,
+                         const int                  *d_v,
+                         const int                  *d_parent,
+                         const int                  *d_nodeAtPre,
+                         const unsigned long long   *d_prefix,
+                         const int                  *d_table,
+                         size_t                     numQueries,
+                         size_t                     numBlocks)
+{
+    for (size_t q = threadIdx.x + (blockIdx.x * blockDim.x); q < numQueries;
+         q += gridDim.x * blockDim.x)
+    {
+        d_lca[q] = treeLCA(d_parent, d_nodeAtPre, d_prefix, d_table,
+                           d_u[q], d_v[q], numBlocks);
+    }
+}
+
+/** @} */ // end tree functions
+/** @} */ // end cudpp_kernel
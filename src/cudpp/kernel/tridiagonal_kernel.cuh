@@ -38,6 +38,9 @@
  * @param[in] d_d Right hand side
  * @param[in] systemSizeOriginal The size of each system
  * @param[in] iterations The computed number of PCR iterations
+ * @param[in] elementStride Distance between consecutive elements of a system
+ * @param[in] systemStride Distance between the first elements of 
+ *            consecutive systems
  */
 template <class T>
 __global__ void crpcrKernel(T *d_a, 
@@ -46,10 +49,14 @@ __global__ void crpcrKernel(T *d_a,
                             T *d_d, 
                             T *d_x, 
                             unsigned int systemSizeOriginal,
-                            unsigned int iterations)
+                            unsigned int iterations,
+                            size_t elementStride,
+                            size_t systemStride)
 {
     const unsigned int thid = threadIdx.x;
     const unsigned int blid = blockIdx.x;
+    const size_t lo = blid * systemStride + thid * elementStride;
+    const size_t hi = lo + blockDim.x * elementStride;
     const unsigned int systemSize = blockDim.x * 2;
     const unsigned int restSystemSize = blockDim.x;
     
@@ -61,17 +68,17 @@ __global__ void crpcrKernel(T *d_a,
     T* d = (T*)&c[systemSize+1];
     T* x = (T*)&d[systemSize+1];
 
-    a[thid] = d_a[thid + blid * systemSizeOriginal];
-    b[thid] = d_b[thid + blid * systemSizeOriginal];
-    c[thid] = d_c[thid + blid * systemSizeOriginal];
-    d[thid] = d_d[thid + blid * systemSizeOriginal];
+    a[thid] = d_a[lo];
+    b[thid] = d_b[lo];
+    c[thid] = d_c[lo];
+    d[thid] = d_d[lo];
     
     if(thid < (systemSizeOriginal - systemSize/2))
     {
-        d[thid + blockDim.x] = d_d[thid + blockDim.x + blid * systemSizeOriginal];
-        b[thid + blockDim.x] = d_b[thid + blockDim.x + blid * systemSizeOriginal];
-        c[thid + blockDim.x] = d_c[thid + blockDim.x + blid * systemSizeOriginal];
-        a[thid + blockDim.x] = d_a[thid + blockDim.x + blid * systemSizeOriginal];
+        d[thid + blockDim.x] = d_d[hi];
+        b[thid + blockDim.x] = d_b[hi];
+        c[thid + blockDim.x] = d_c[hi];
+        a[thid + blockDim.x] = d_a[hi];
     }
     else
     {
@@ -81,6 +88,14 @@ __global__ void crpcrKernel(T *d_a,
         a[thid + blockDim.x] = 1;    
     }
     __syncthreads();
+
+    // the first lower and last upper entries are outside the matrix
+    if (thid == 0)
+    {
+        a[0] = 0;
+        c[systemSizeOriginal - 1] = 0;
+    }
+    __syncthreads();
       
     int i = 2 * thid + 1;
     if(i == systemSize - 1)
@@ -185,10 +200,966 @@ __global__ void crpcrKernel(T *d_a,
     
     __syncthreads();    
 
-    d_x[thid + blid * systemSizeOriginal] = x[thid];
+    d_x[lo] = x[thid];
     
     if(thid < (systemSizeOriginal - systemSize/2))
-        d_x[thid + blockDim.x + blid * systemSizeOriginal] = x[thid + blockDim.x];
+        d_x[hi] = x[thid + blockDim.x];
+}
+
+/**
+ * @brief Solves one tridiagonal system with the Thomas algorithm
+ *
+ * Gaussian elimination without pivoting.  The forward sweep stores the 
+ * modified upper diagonal in \a d_scratch and the modified right hand 
+ * side in \a d_x, which the backward substitution then overwrites in 
+ * place with the solution.  Shared by thomasKernel() and the host solver.
+ *
+ * @param[out] d_x Solution vector
+ * @param[out] d_scratch Temporary storage, same size and layout as \a d_x
+ * @param[in] d_a Lower diagonal
+ * @param[in] d_b Main diagonal
+ * @param[in] d_c Upper diagonal
+ * @param[in] d_d Right hand side
+ * @param[in] idx Index of the first element of the system
+ * @param[in] systemSize The size of the system
+ * @param[in] elementStride Distance between consecutive elements of the system
+ */
+template <class T>
+__host__ __device__ void thomasSystem(const T *d_a, 
+                                      const T *d_b, 
+                                      const T *d_c, 
+                                      const T *d_d, 
+                                      T *d_x, 
+                                      T *d_scratch,
+                                      size_t idx,
+                                      unsigned int systemSize,
+                                      size_t elementStride)
+{
+    T cPrev = d_c[idx] / d_b[idx];
+    T dPrev = d_d[idx] / d_b[idx];
+    d_scratch[idx] = cPrev;
+    d_x[idx] = dPrev;
+
+    for (unsigned int i = 1; i < systemSize; i++)
+    {
+        idx += elementStride;
+        T a = d_a[idx];
+        T inv = 1 / (d_b[idx] - a * cPrev);
+        cPrev = d_c[idx] * inv;
+        dPrev = (d_d[idx] - a * dPrev) * inv;
+        d_scratch[idx] = cPrev;
+        d_x[idx] = dPrev;
+    }
+
+    T xNext = dPrev;
+    for (unsigned int i = systemSize - 1; i > 0; i--)
+    {
+        idx -= elementStride;
+        xNext = d_x[idx] - d_scratch[idx] * xNext;
+        d_x[idx] = xNext;
+    }
+}
+
+/**
+ * @brief Batched Thomas tridiagonal solver, one thread per system
+ *
+ * Each thread solves whole systems with thomasSystem(), so the kernel has
+ * no limit on the system size and, through a grid-stride loop, none on 
+ * the number of systems.  Element i of system s is at index 
+ * i * \a elementStride + s * \a systemStride.  With the interleaved 
+ * layout (\a elementStride = numSystems, \a systemStride = 1) adjacent 
+ * threads access adjacent addresses, so every load and store is 
+ * coalesced; this is the fastest solver for many small systems.
+ *
+ * @param[out] d_x Solution vector
+ * @param[out] d_scratch Temporary storage, same size and layout as \a d_x
+ * @param[in] d_a Lower diagonal
+ * @param[in] d_b Main diagonal
+ * @param[in] d_c Upper diagonal
+ * @param[in] d_d Right hand side
+ * @param[in] systemSize The size of each system
+ * @param[in] numSystems The number of systems
+ * @param[in] elementStride Distance between consecutive elements of a system
+ * @param[in] systemStride Distance between the first elements of 
+ *            consecutive systems
+ */
+template <class T>
+__global__ void thomasKernel(const T *d_a, 
+                             const T *d_b, 
+                             const T *d_c, 
+                             const T *d_d, 
+                             T *d_x, 
+                             T *d_scratch,
+                             unsigned int systemSize,
+                             unsigned int numSystems,
+                             size_t elementStride,
+                             size_t systemStride)
+{
+    for (unsigned int s = blockIdx.x * blockDim.x + threadIdx.x; 
+         s < numSystems; 
+         s += gridDim.x * blockDim.x)
+    {
+        thomasSystem(d_a, d_b, d_c, d_d, d_x, d_scratch, 
+                     s * systemStride, systemSize, elementStride);
+    }
+}
+
+/**
+ * @brief Reduces partition \a k of system \a s to two equations of the
+ * interface system (partitioned solver, stage 1)
+ *
+ * See partitionReduceKernel(), which calls this for every partition; 
+ * the host partitioned solver calls it from OpenMP threads.
+ */
+template <class T>
+__host__ __device__ void partitionReduce(const T *d_a, 
+                                         const T *d_b, 
+                                         const T *d_c, 
+                                         const T *d_d, 
+                                         T *d_x, 
+                                         T *d_aPrime,
+                                         T *d_cPrime,
+                                         T *d_ra,
+                                         T *d_rb,
+                                         T *d_rc,
+                                         T *d_rd,
+                                         unsigned int systemSize,
+                                         unsigned int s,
+                                         unsigned int k,
+                                         unsigned int partSize,
+                                         unsigned int numParts,
+                                         size_t elementStride,
+                                         size_t systemStride)
+{
+    unsigned int first = k * partSize;
+    unsigned int len = (k == numParts - 1) ? systemSize - first : partSize;
+    size_t base = s * systemStride + first * elementStride;
+
+    // forward elimination: rows refer to x_first instead of x_{i-1}
+    size_t idx = base;
+    T a0 = (k == 0) ? 0 : d_a[idx];
+    T b0 = d_b[idx];
+    d_aPrime[idx] = a0 / b0;
+    d_cPrime[idx] = d_c[idx] / b0;
+    d_x[idx] = d_d[idx] / b0;
+
+    idx += elementStride;
+    T b = d_b[idx];
+    T aPrev = d_a[idx] / b;
+    T cPrev = d_c[idx] / b;
+    T dPrev = d_d[idx] / b;
+    d_aPrime[idx] = aPrev;
+    d_cPrime[idx] = cPrev;
+    d_x[idx] = dPrev;
+
+    for (unsigned int i = 2; i < len; i++)
+    {
+        idx += elementStride;
+        T a = d_a[idx];
+        T c = (first + i == systemSize - 1) ? 0 : d_c[idx];
+        T r = 1 / (d_b[idx] - a * cPrev);
+        dPrev = r * (d_d[idx] - a * dPrev);
+        cPrev = r * c;
+        aPrev = -r * a * aPrev;
+        d_aPrime[idx] = aPrev;
+        d_cPrime[idx] = cPrev;
+        d_x[idx] = dPrev;
+    }
+
+    size_t reduced = (size_t)s * 2 * numParts + 2 * k;
+
+    // the last row couples x_first, x_last and the next partition
+    d_ra[reduced + 1] = aPrev;
+    d_rb[reduced + 1] = 1;
+    d_rc[reduced + 1] = cPrev;
+    d_rd[reduced + 1] = dPrev;
+
+    // backward elimination: rows refer to x_last instead of x_{i+1}.
+    // Row len - 2 already does.
+    idx -= elementStride;
+    T aNext = d_aPrime[idx];
+    T cNext = d_cPrime[idx];
+    T dNext = d_x[idx];
+    for (unsigned int i = len - 3; i >= 1; i--)
+    {
+        idx -= elementStride;
+        T c = d_cPrime[idx];
+        dNext = d_x[idx] - c * dNext;
+        aNext = d_aPrime[idx] - c * aNext;
+        cNext = -c * cNext;
+        d_aPrime[idx] = aNext;
+        d_cPrime[idx] = cNext;
+        d_x[idx] = dNext;
+    }
+
+    // eliminate x_1 from the first row
+    T c0 = d_cPrime[base];
+    T r = 1 / (1 - aNext * c0);
+    d_ra[reduced] = r * d_aPrime[base];
+    d_rb[reduced] = 1;
+    d_rc[reduced] = -r * c0 * cNext;
+    d_rd[reduced] = r * (d_x[base] - c0 * dNext);
+}
+
+/**
+ * @brief Reduces each partition of a set of large tridiagonal systems to
+ * two equations of an interface system (partitioned solver, stage 1)
+ *
+ * Each system is split into \a numParts partitions of \a partSize rows 
+ * (the last partition also takes the remaining rows), and each thread 
+ * reduces one partition with a modified Thomas algorithm.  Afterwards 
+ * every row i of the partition reads 
+ * 
+ *     a'_i x_first + x_i + c'_i x_last = d'_i, 
+ *
+ * where x_first and x_last are the partition's first and last unknowns, 
+ * except for the first and last rows, which couple to the last unknown of
+ * the previous partition and the first unknown of the next one.  Those two
+ * rows of every partition form a tridiagonal interface system of 
+ * 2 * \a numParts unknowns per system, written contiguously to \a d_ra, 
+ * \a d_rb, \a d_rc and \a d_rd.
+ *
+ * Partitions are enumerated with the system index varying fastest, so 
+ * with the interleaved layout adjacent threads access adjacent addresses.
+ *
+ * @param[in] d_a Lower diagonal
+ * @param[in] d_b Main diagonal
+ * @param[in] d_c Upper diagonal
+ * @param[in] d_d Right hand side
+ * @param[out] d_x Modified right hand side d'
+ * @param[out] d_aPrime Modified lower diagonal a', same layout as \a d_a
+ * @param[out] d_cPrime Modified upper diagonal c', same layout as \a d_c
+ * @param[out] d_ra Lower diagonal of the interface systems
+ * @param[out] d_rb Main diagonal of the interface systems
+ * @param[out] d_rc Upper diagonal of the interface systems
+ * @param[out] d_rd Right hand side of the interface systems
+ * @param[in] systemSize The size of each system
+ * @param[in] numSystems The number of systems
+ * @param[in] partSize The number of rows of each partition, at least 3
+ * @param[in] numParts The number of partitions of each system
+ * @param[in] elementStride Distance between consecutive elements of a system
+ * @param[in] systemStride Distance between the first elements of 
+ *            consecutive systems
+ */
+template <class T>
+__global__ void partitionReduceKernel(const T *d_a, 
+                                      const T *d_b, 
+                                      const T *d_c, 
+                                      const T *d_d, 
+                                      T *d_x, 
+                                      T *d_aPrime,
+                                      T *d_cPrime,
+                                      T *d_ra,
+                                      T *d_rb,
+                                      T *d_rc,
+                                      T *d_rd,
+                                      unsigned int systemSize,
+                                      unsigned int numSystems,
+                                      unsigned int partSize,
+                                      unsigned int numParts,
+                                      size_t elementStride,
+                                      size_t systemStride)
+{
+    size_t numThreads = (size_t)numSystems * numParts;
+
+    for (size_t t = blockIdx.x * blockDim.x + threadIdx.x; 
+         t < numThreads; 
+         t += gridDim.x * blockDim.x)
+    {
+        partitionReduce(d_a, d_b, d_c, d_d, d_x, d_aPrime, d_cPrime, 
+                        d_ra, d_rb, d_rc, d_rd, systemSize,
+                        (unsigned int)(t % numSystems), (unsigned int)(t / numSystems),
+                        partSize, numParts, elementStride, systemStride);
+    }
+}
+
+/**
+ * @brief Recovers the interior unknowns of partition \a k of system \a s
+ * (partitioned solver, stage 3)
+ *
+ * See partitionSubstituteKernel(), which calls this for every partition.
+ */
+template <class T>
+__host__ __device__ void partitionSubstitute(T *d_x, 
+                                             const T *d_aPrime,
+                                             const T *d_cPrime,
+                                             const T *d_rx,
+                                             unsigned int systemSize,
+                                             unsigned int s,
+                                             unsigned int k,
+                                             unsigned int partSize,
+                                             unsigned int numParts,
+                                             size_t elementStride,
+                                             size_t systemStride)
+{
+    unsigned int first = k * partSize;
+    unsigned int len = (k == numParts - 1) ? systemSize - first : partSize;
+    size_t idx = s * systemStride + first * elementStride;
+
+    size_t reduced = (size_t)s * 2 * numParts + 2 * k;
+    T xFirst = d_rx[reduced];
+    T xLast = d_rx[reduced + 1];
+
+    d_x[idx] = xFirst;
+    for (unsigned int i = 1; i < len - 1; i++)
+    {
+        idx += elementStride;
+        d_x[idx] = d_x[idx] - d_aPrime[idx] * xFirst - d_cPrime[idx] * xLast;
+    }
+    d_x[idx + elementStride] = xLast;
+}
+
+/**
+ * @brief Recovers the interior unknowns of each partition from the 
+ * solution of the interface system (partitioned solver, stage 3)
+ *
+ * @param[in,out] d_x On input the modified right hand side d', on output 
+ *                the solution
+ * @param[in] d_aPrime Modified lower diagonal from partitionReduceKernel()
+ * @param[in] d_cPrime Modified upper diagonal from partitionReduceKernel()
+ * @param[in] d_rx Solution of the interface systems
+ * @param[in] systemSize The size of each system
+ * @param[in] numSystems The number of systems
+ * @param[in] partSize The number of rows of each partition
+ * @param[in] numParts The number of partitions of each system
+ * @param[in] elementStride Distance between consecutive elements of a system
+ * @param[in] systemStride Distance between the first elements of 
+ *            consecutive systems
+ */
+template <class T>
+__global__ void partitionSubstituteKernel(T *d_x, 
+                                          const T *d_aPrime,
+                                          const T *d_cPrime,
+                                          const T *d_rx,
+                                          unsigned int systemSize,
+                                          unsigned int numSystems,
+                                          unsigned int partSize,
+                                          unsigned int numParts,
+                                          size_t elementStride,
+                                          size_t systemStride)
+{
+    size_t numThreads = (size_t)numSystems * numParts;
+
+    for (size_t t = blockIdx.x * blockDim.x + threadIdx.x; 
+         t < numThreads; 
+         t += gridDim.x * blockDim.x)
+    {
+        partitionSubstitute(d_x, d_aPrime, d_cPrime, d_rx, systemSize,
+                            (unsigned int)(t % numSystems), (unsigned int)(t / numSystems),
+                            partSize, numParts, elementStride, systemStride);
+    }
+}
+
+/**
+ * @brief Prepares the Sherman-Morrison correction of cyclic tridiagonal 
+ * systems
+ *
+ * A cyclic system, whose first row couples to the last unknown through 
+ * a[0] and whose last row couples to the first through c[n-1], equals the 
+ * plain tridiagonal system with main diagonal \a d_bMod plus the rank-one
+ * update u v^T, with u = (-b[0], 0, ..., 0, c[n-1]) and 
+ * v = (1, 0, ..., 0, -a[0] / b[0]).  This kernel writes \a d_bMod and u.
+ *
+ * @param[out] d_bMod Modified main diagonal
+ * @param[out] d_u Right hand side of the correction system
+ * @param[in] d_a Lower diagonal; a[0] is the upper right corner
+ * @param[in] d_b Main diagonal
+ * @param[in] d_c Upper diagonal; c[n-1] is the lower left corner
+ * @param[in] systemSize The size of each system
+ * @param[in] numSystems The number of systems
+ * @param[in] elementStride Distance between consecutive elements of a system
+ * @param[in] systemStride Distance between the first elements of 
+ *            consecutive systems
+ */
+template <class T>
+__global__ void cyclicSetupKernel(T *d_bMod,
+                                  T *d_u,
+                                  const T *d_a, 
+                                  const T *d_b, 
+                                  const T *d_c, 
+                                  unsigned int systemSize,
+                                  unsigned int numSystems,
+                                  size_t elementStride,
+                                  size_t systemStride)
+{
+    size_t numElements = (size_t)systemSize * numSystems;
+
+    for (size_t j = blockIdx.x * blockDim.x + threadIdx.x; 
+         j < numElements; 
+         j += gridDim.x * blockDim.x)
+    {
+        unsigned int s = (unsigned int)(j / systemSize);
+        unsigned int i = (unsigned int)(j % systemSize);
+        size_t idx = s * systemStride + i * elementStride;
+
+        T b = d_b[idx];
+        T u = 0;
+        if (i == 0)
+        {
+            u = -b;
+            b = 2 * b;
+        }
+        else if (i == systemSize - 1)
+        {
+            size_t first = s * systemStride;
+            u = d_c[idx];
+            b = b + d_c[idx] * d_a[first] / d_b[first];
+        }
+        d_bMod[idx] = b;
+        d_u[idx] = u;
+    }
+}
+
+/**
+ * @brief Computes the Sherman-Morrison factor of each cyclic system
+ *
+ * With y the solution for the right hand side and z the solution for u 
+ * (see cyclicSetupKernel()), the solution of the cyclic system is 
+ * x = y - factor * z, where 
+ * factor = (v . y) / (1 + v . z).
+ *
+ * @param[out] d_factor One factor per system
+ * @param[in] d_y Solution of the modified system for the right hand side
+ * @param[in] d_z Solution of the modified system for u
+ * @param[in] d_a Lower diagonal; a[0] is the upper right corner
+ * @param[in] d_b Main diagonal
+ * @param[in] systemSize The size of each system
+ * @param[in] numSystems The number of systems
+ * @param[in] elementStride Distance between consecutive elements of a system
+ * @param[in] systemStride Distance between the first elements of 
+ *            consecutive systems
+ */
+template <class T>
+__global__ void cyclicFactorKernel(T *d_factor,
+                                   const T *d_y,
+                                   const T *d_z,
+                                   const T *d_a, 
+                                   const T *d_b, 
+                                   unsigned int systemSize,
+                                   unsigned int numSystems,
+                                   size_t elementStride,
+                                   size_t systemStride)
+{
+    for (unsigned int s = blockIdx.x * blockDim.x + threadIdx.x; 
+         s < numSystems; 
+         s += gridDim.x * blockDim.x)
+    {
+        size_t first = s * systemStride;
+        size_t last = first + (systemSize - 1) * elementStride;
+        T v = -d_a[first] / d_b[first];
+        d_factor[s] = (d_y[first] + v * d_y[last]) / 
+                      (1 + d_z[first] + v * d_z[last]);
+    }
+}
+
+/**
+ * @brief Applies the Sherman-Morrison correction: x = y - factor * z
+ *
+ * @param[in,out] d_x On input y, on output the solution of the cyclic system
+ * @param[in] d_z Solution of the modified system for u
+ * @param[in] d_factor One factor per system, from cyclicFactorKernel()
+ * @param[in] systemSize The size of each system
+ * @param[in] numSystems The number of systems
+ * @param[in] elementStride Distance between consecutive elements of a system
+ * @param[in] systemStride Distance between the first elements of 
+ *            consecutive systems
+ */
+template <class T>
+__global__ void cyclicCorrectKernel(T *d_x,
+                                    const T *d_z,
+                                    const T *d_factor,
+                                    unsigned int systemSize,
+                                    unsigned int numSystems,
+                                    size_t elementStride,
+                                    size_t systemStride)
+{
+    size_t numElements = (size_t)systemSize * numSystems;
+
+    for (size_t j = blockIdx.x * blockDim.x + threadIdx.x; 
+         j < numElements; 
+         j += gridDim.x * blockDim.x)
+    {
+        unsigned int s = (unsigned int)(j / systemSize);
+        unsigned int i = (unsigned int)(j % systemSize);
+        size_t idx = s * systemStride + i * elementStride;
+        d_x[idx] -= d_factor[s] * d_z[idx];
+    }
+}
+
+/**
+ * @brief Batched pentadiagonal solver, one thread per system
+ *
+ * Row i of each system reads
+ * e[i] x[i-2] + a[i] x[i-1] + b[i] x[i] + c[i] x[i+1] + f[i] x[i+2] = d[i];
+ * entries that fall outside the matrix are ignored.  The forward sweep 
+ * eliminates both lower diagonals without pivoting, leaving 
+ * x[i] + alpha[i] x[i+1] + beta[i] x[i+2] = z[i], and the backward sweep
+ * substitutes.  alpha and beta are kept in \a d_scratch, z in \a d_x.
+ * The memory layout is as for thomasKernel().
+ *
+ * @param[out] d_x Solution vector
+ * @param[out] d_scratch Temporary storage, twice the size of \a d_x
+ * @param[in] d_e Second lower diagonal
+ * @param[in] d_a Lower diagonal
+ * @param[in] d_b Main diagonal
+ * @param[in] d_c Upper diagonal
+ * @param[in] d_f Second upper diagonal
+ * @param[in] d_d Right hand side
+ * @param[in] systemSize The size of each system
+ * @param[in] numSystems The number of systems
+ * @param[in] elementStride Distance between consecutive elements of a system
+ * @param[in] systemStride Distance between the first elements of 
+ *            consecutive systems
+ */
+template <class T>
+__global__ void pentadiagonalKernel(const T *d_e, 
+                                    const T *d_a, 
+                                    const T *d_b, 
+                                    const T *d_c, 
+                                    const T *d_f, 
+                                    const T *d_d, 
+                                    T *d_x, 
+                                    T *d_scratch,
+                                    unsigned int systemSize,
+                                    unsigned int numSystems,
+                                    size_t elementStride,
+                                    size_t systemStride)
+{
+    size_t numElements = (size_t)systemSize * numSystems;
+    T *d_alpha = d_scratch;
+    T *d_beta = d_scratch + numElements;
+
+    for (unsigned int s = blockIdx.x * blockDim.x + threadIdx.x; 
+         s < numSystems; 
+         s += gridDim.x * blockDim.x)
+    {
+        size_t idx = s * systemStride;
+
+        // alpha, beta and z of rows i-2 and i-1
+        T alpha2 = 0, beta2 = 0, z2 = 0;
+        T alpha1 = 0, beta1 = 0, z1 = 0;
+
+        for (unsigned int i = 0; i < systemSize; i++, idx += elementStride)
+        {
+            T e = (i >= 2) ? d_e[idx] : 0;
+            T a = (i >= 1) ? d_a[idx] : 0;
+            T c = (i + 1 < systemSize) ? d_c[idx] : 0;
+            T f = (i + 2 < systemSize) ? d_f[idx] : 0;
+
+            T gamma = a - alpha2 * e;
+            T r = 1 / (d_b[idx] - beta2 * e - alpha1 * gamma);
+            T alpha = (c - beta1 * gamma) * r;
+            T beta = f * r;
+            T z = (d_d[idx] - z2 * e - z1 * gamma) * r;
+
+            d_alpha[idx] = alpha;
+            d_beta[idx] = beta;
+            d_x[idx] = z;
+
+            alpha2 = alpha1; beta2 = beta1; z2 = z1;
+            alpha1 = alpha;  beta1 = beta;  z1 = z;
+        }
+
+        T x1 = 0, x2 = 0;   // x[i+1], x[i+2]
+        for (unsigned int i = systemSize; i > 0; i--)
+        {
+            idx -= elementStride;
+            T x = d_x[idx] - d_alpha[idx] * x1 - d_beta[idx] * x2;
+            d_x[idx] = x;
+            x2 = x1;
+            x1 = x;
+        }
+    }
+}
+
+/**
+ * @brief Computes the inverse of a small dense matrix by Gauss-Jordan 
+ * elimination with partial pivoting
+ *
+ * @param[out] inv The inverse of \a m, row-major
+ * @param[in,out] m The matrix, row-major; destroyed
+ * @tparam T The datatype
+ * @tparam M The dimension of the matrix
+ */
+template <class T, int M>
+__device__ void blockInverse(T inv[M][M], T m[M][M])
+{
+#pragma unroll
+    for (int i = 0; i < M; i++)
+#pragma unroll
+        for (int j = 0; j < M; j++)
+            inv[i][j] = (i == j) ? 1 : 0;
+
+#pragma unroll
+    for (int k = 0; k < M; k++)
+    {
+        int p = k;
+#pragma unroll
+        for (int i = k + 1; i < M; i++)
+            if (fabs(m[i][k]) > fabs(m[p][k]))
+                p = i;
+        if (p != k)
+        {
+#pragma unroll
+            for (int j = 0; j < M; j++)
+            {
+                T t = m[k][j]; m[k][j] = m[p][j]; m[p][j] = t;
+                t = inv[k][j]; inv[k][j] = inv[p][j]; inv[p][j] = t;
+            }
+        }
+
+        T r = 1 / m[k][k];
+#pragma unroll
+        for (int j = 0; j < M; j++)
+        {
+            m[k][j] *= r;
+            inv[k][j] *= r;
+        }
+#pragma unroll
+        for (int i = 0; i < M; i++)
+        {
+            if (i != k)
+            {
+                T l = m[i][k];
+#pragma unroll
+                for (int j = 0; j < M; j++)
+                {
+                    m[i][j] -= l * m[k][j];
+                    inv[i][j] -= l * inv[k][j];
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Batched block-tridiagonal solver with \a M x \a M blocks, one 
+ * thread per system
+ *
+ * Block row i of each system reads 
+ * A[i] X[i-1] + B[i] X[i] + C[i] X[i+1] = D[i], where A, B and C are 
+ * row-major M x M blocks and X and D are M-vectors; A[0] and C[n-1] are 
+ * ignored.  This is the block Thomas algorithm: the forward sweep computes
+ * C'[i] = (B[i] - A[i] C'[i-1])^-1 C[i] and the matching D'[i], the 
+ * backward sweep X[i] = D'[i] - C'[i] X[i+1].  C' is kept in \a d_scratch,
+ * D' in \a d_x.  Block row i of system s is block 
+ * i * \a elementStride + s * \a systemStride of each array.
+ *
+ * @param[out] d_x Solution vectors
+ * @param[out] d_scratch Temporary storage of the size of \a d_c
+ * @param[in] d_a Lower diagonal blocks
+ * @param[in] d_b Main diagonal blocks
+ * @param[in] d_c Upper diagonal blocks
+ * @param[in] d_d Right hand side vectors
+ * @param[in] systemSize The number of block rows of each system
+ * @param[in] numSystems The number of systems
+ * @param[in] elementStride Distance between consecutive block rows, in blocks
+ * @param[in] systemStride Distance between the first block rows of 
+ *            consecutive systems, in blocks
+ * @tparam T The datatype
+ * @tparam M The dimension of the blocks
+ */
+template <class T, int M>
+__global__ void blockTridiagonalKernel(const T *d_a, 
+                                       const T *d_b, 
+                                       const T *d_c, 
+                                       const T *d_d, 
+                                       T *d_x, 
+                                       T *d_scratch,
+                                       unsigned int systemSize,
+                                       unsigned int numSystems,
+                                       size_t elementStride,
+                                       size_t systemStride)
+{
+    for (unsigned int s = blockIdx.x * blockDim.x + threadIdx.x; 
+         s < numSystems; 
+         s += gridDim.x * blockDim.x)
+    {
+        size_t idx = s * systemStride;
+        T cPrev[M][M];  // C'[i-1]
+        T dPrev[M];     // D'[i-1]
+
+        for (unsigned int i = 0; i < systemSize; i++, idx += elementStride)
+        {
+            const T *A = d_a + idx * M * M;
+            const T *B = d_b + idx * M * M;
+            const T *C = d_c + idx * M * M;
+            const T *D = d_d + idx * M;
+
+            // m = B[i] - A[i] C'[i-1], rhs = D[i] - A[i] D'[i-1]
+            T m[M][M];
+            T rhs[M];
+#pragma unroll
+            for (int r = 0; r < M; r++)
+            {
+                rhs[r] = D[r];
+#pragma unroll
+                for (int col = 0; col < M; col++)
+                    m[r][col] = B[r * M + col];
+                if (i > 0)
+                {
+#pragma unroll
+                    for (int k = 0; k < M; k++)
+                    {
+                        T ark = A[r * M + k];
+                        rhs[r] -= ark * dPrev[k];
+#pragma unroll
+                        for (int col = 0; col < M; col++)
+                            m[r][col] -= ark * cPrev[k][col];
+                    }
+                }
+            }
+
+            T inv[M][M];
+            blockInverse<T, M>(inv, m);
+
+            bool last = (i == systemSize - 1);
+#pragma unroll
+            for (int r = 0; r < M; r++)
+            {
+                T dr = 0;
+#pragma unroll
+                for (int k = 0; k < M; k++)
+                    dr += inv[r][k] * rhs[k];
+                dPrev[r] = dr;
+                d_x[idx * M + r] = dr;
+            }
+#pragma unroll
+            for (int r = 0; r < M; r++)
+            {
+#pragma unroll
+                for (int col = 0; col < M; col++)
+                {
+                    T cr = 0;
+                    if (!last)
+                    {
+#pragma unroll
+                        for (int k = 0; k < M; k++)
+                            cr += inv[r][k] * C[k * M + col];
+                    }
+                    cPrev[r][col] = cr;
+                    d_scratch[idx * M * M + r * M + col] = cr;
+                }
+            }
+        }
+
+        T xNext[M];
+#pragma unroll
+        for (int r = 0; r < M; r++)
+            xNext[r] = dPrev[r];
+
+        idx -= elementStride;   // last block row, already solved
+        for (unsigned int i = systemSize - 1; i > 0; i--)
+        {
+            idx -= elementStride;
+            T xi[M];
+#pragma unroll
+            for (int r = 0; r < M; r++)
+            {
+                T v = d_x[idx * M + r];
+#pragma unroll
+                for (int k = 0; k < M; k++)
+                    v -= d_scratch[idx * M * M + r * M + k] * xNext[k];
+                xi[r] = v;
+            }
+#pragma unroll
+            for (int r = 0; r < M; r++)
+            {
+                d_x[idx * M + r] = xi[r];
+                xNext[r] = xi[r];
+            }
+        }
+    }
+}
+
+/**
+ * @brief Factors batched tridiagonal systems for repeated solves, one 
+ * thread per system
+ *
+ * Performs the elimination of thomasKernel() on the matrix alone and 
+ * stores, for every row, the lower diagonal (with a[0] = 0), the inverse 
+ * of the eliminated pivot and the modified upper diagonal (with 
+ * c'[n-1] = 0), so that each right hand side then only needs a forward
+ * and a backward sweep (see thomasSolveFactoredKernel()).
+ *
+ * If \a isCyclic, the factored matrix is the modified matrix of 
+ * cyclicSetupKernel(), and the kernel also solves it for the correction 
+ * vector u into \a d_z and stores v[n-1] = -a[0] / b[0] and 
+ * 1 / (1 + z[0] + v[n-1] z[n-1]) per system in \a d_cyclic.
+ *
+ * @param[out] d_lower Lower diagonal, in the layout of \a d_a
+ * @param[out] d_inverse Inverse pivots, in the layout of \a d_a
+ * @param[out] d_upper Modified upper diagonal, in the layout of \a d_a
+ * @param[out] d_z Solution for the correction vector (cyclic systems only)
+ * @param[out] d_cyclic Two Sherman-Morrison coefficients per system 
+ *             (cyclic systems only)
+ * @param[in] d_a Lower diagonal
+ * @param[in] d_b Main diagonal
+ * @param[in] d_c Upper diagonal
+ * @param[in] systemSize The size of each system
+ * @param[in] numSystems The number of systems
+ * @param[in] elementStride Distance between consecutive elements of a system
+ * @param[in] systemStride Distance between the first elements of 
+ *            consecutive systems
+ * @param[in] isCyclic true if the systems are cyclic
+ */
+template <class T>
+__global__ void thomasFactorKernel(T *d_lower,
+                                   T *d_inverse,
+                                   T *d_upper,
+                                   T *d_z,
+                                   T *d_cyclic,
+                                   const T *d_a, 
+                                   const T *d_b, 
+                                   const T *d_c, 
+                                   unsigned int systemSize,
+                                   unsigned int numSystems,
+                                   size_t elementStride,
+                                   size_t systemStride,
+                                   bool isCyclic)
+{
+    for (unsigned int s = blockIdx.x * blockDim.x + threadIdx.x; 
+         s < numSystems; 
+         s += gridDim.x * blockDim.x)
+    {
+        size_t first = s * systemStride;
+        size_t idx = first;
+        T b0 = d_b[first];
+        T cPrev = 0;
+        T zPrev = 0;
+
+        for (unsigned int i = 0; i < systemSize; i++, idx += elementStride)
+        {
+            T a = (i == 0) ? 0 : d_a[idx];
+            T b = d_b[idx];
+            T c = (i == systemSize - 1) ? 0 : d_c[idx];
+            T u = 0;
+            if (isCyclic)
+            {
+                if (i == 0)
+                {
+                    u = -b0;
+                    b = 2 * b0;
+                }
+                else if (i == systemSize - 1)
+                {
+                    u = d_c[idx];
+                    b = b + d_c[idx] * d_a[first] / b0;
+                }
+            }
+
+            T inv = 1 / (b - a * cPrev);
+            cPrev = c * inv;
+            d_lower[idx] = a;
+            d_inverse[idx] = inv;
+            d_upper[idx] = cPrev;
+
+            if (isCyclic)
+            {
+                zPrev = (u - a * zPrev) * inv;
+                d_z[idx] = zPrev;
+            }
+        }
+
+        if (isCyclic)
+        {
+            idx -= elementStride;
+            T zLast = zPrev;
+            T zNext = zPrev;
+            for (unsigned int i = systemSize - 1; i > 0; i--)
+            {
+                idx -= elementStride;
+                zNext = d_z[idx] - d_upper[idx] * zNext;
+                d_z[idx] = zNext;
+            }
+            T v = -d_a[first] / b0;
+            d_cyclic[2 * s] = v;
+            d_cyclic[2 * s + 1] = 1 / (1 + zNext + v * zLast);
+        }
+    }
+}
+
+/**
+ * @brief Solves factored tridiagonal systems for many right hand sides, 
+ * one thread per system and right hand side
+ *
+ * Right hand side r of system s starts at r * \a rhsStride + 
+ * s * \a systemStride.  Threads are enumerated with the system index 
+ * varying fastest, so with the interleaved layout adjacent threads access
+ * adjacent addresses.  \a d_x may be the same array as \a d_d.
+ *
+ * @param[out] d_x Solution vectors
+ * @param[in] d_d Right hand sides
+ * @param[in] d_lower Lower diagonal from thomasFactorKernel()
+ * @param[in] d_inverse Inverse pivots from thomasFactorKernel()
+ * @param[in] d_upper Modified upper diagonal from thomasFactorKernel()
+ * @param[in] d_z Correction solution from thomasFactorKernel() (cyclic 
+ *            systems only)
+ * @param[in] d_cyclic Sherman-Morrison coefficients from 
+ *            thomasFactorKernel() (cyclic systems only)
+ * @param[in] systemSize The size of each system
+ * @param[in] numSystems The number of systems
+ * @param[in] numRHS The number of right hand sides per system
+ * @param[in] elementStride Distance between consecutive elements of a system
+ * @param[in] systemStride Distance between the first elements of 
+ *            consecutive systems
+ * @param[in] rhsStride Distance between consecutive right hand sides
+ * @param[in] isCyclic true if the systems are cyclic
+ */
+template <class T>
+__global__ void thomasSolveFactoredKernel(T *d_x,
+                                          const T *d_d,
+                                          const T *d_lower,
+                                          const T *d_inverse,
+                                          const T *d_upper,
+                                          const T *d_z,
+                                          const T *d_cyclic,
+                                          unsigned int systemSize,
+                                          unsigned int numSystems,
+                                          unsigned int numRHS,
+                                          size_t elementStride,
+                                          size_t systemStride,
+                                          size_t rhsStride,
+                                          bool isCyclic)
+{
+    size_t numThreads = (size_t)numSystems * numRHS;
+
+    for (size_t t = blockIdx.x * blockDim.x + threadIdx.x; 
+         t < numThreads; 
+         t += gridDim.x * blockDim.x)
+    {
+        unsigned int s = (unsigned int)(t % numSystems);
+        unsigned int r = (unsigned int)(t / numSystems);
+        size_t first = s * systemStride;
+        size_t offset = r * rhsStride;
+        size_t idx = first;
+
+        T dPrev = 0;
+        for (unsigned int i = 0; i < systemSize; i++, idx += elementStride)
+        {
+            dPrev = (d_d[offset + idx] - d_lower[idx] * dPrev) * d_inverse[idx];
+            d_x[offset + idx] = dPrev;
+        }
+
+        idx -= elementStride;
+        size_t last = idx;
+        T xNext = dPrev;
+        for (unsigned int i = systemSize - 1; i > 0; i--)
+        {
+            idx -= elementStride;
+            xNext = d_x[offset + idx] - d_upper[idx] * xNext;
+            d_x[offset + idx] = xNext;
+        }
+
+        if (isCyclic)
+        {
+            T factor = (xNext + d_cyclic[2 * s] * d_x[offset + last]) * 
+                       d_cyclic[2 * s + 1];
+            idx = first;
+            for (unsigned int i = 0; i < systemSize; i++, idx += elementStride)
+                d_x[offset + idx] -= factor * d_z[idx];
+        }
+    }
 }
 
 /** @} */ // end Tridiagonal functions
@@ -0,0 +1,261 @@
+// -------------------------------------------------------------
+// CUDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+#include <cudpp_globals.h>
+#include <stdio.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/**
+ * @file
+ * unique_kernel.cuh
+ *
+ * @brief CUDPP kernel-level unique routines
+ */
+
+/** \addtogroup cudpp_kernel
+ * @{
+ */
+
+/** @name Unique Functions
+ * @{
+ */
+
+/* An element is kept when it is the first of its run of equal keys
+ * (sorted input) or the first occurrence of its key (unsorted input).
+ * Each GPU thread owns a tile of UNIQUE_ITEMS_PER_THREAD consecutive
+ * elements: the kept elements of every tile are counted, the counts are
+ * scanned, and each tile then writes its kept elements at their ranks,
+ * so no per-element flags are stored.
+ *
+ * The first occurrences of unsorted keys are found with an open
+ * addressing hash table of 64-bit slots, each holding a key of up to 32
+ * bits in the low word and one plus the smallest index at which it
+ * occurs in the high word; an empty slot is 0.  Keys are inserted with a
+ * compare-and-swap, and the index of a key already present is lowered
+ * with a compare-and-swap loop.  The functions below are shared by the
+ * kernels and the host path.
+ */
+
+/**
+ * @brief 64-bit compare-and-swap on the device or the host.
+ *
+ * @param[in,out] address The word
+ * @param[in] compare The value expected at \a address
+ * @param[in] val The value stored if \a address holds \a compare
+ * @returns The value that was at \a address
+ */
+__host__ __device__ inline
+unsigned long long uniqueCompareAndSwap(unsigned long long *address,
+                                        unsigned long long compare,
+                                        unsigned long long val)
+{
+#if defined(__CUDA_ARCH__)
+    return atomicCAS(address, compare, val);
+#elif defined(_MSC_VER)
+    return (unsigned long long)_InterlockedCompareExchange64((volatile __int64*)address,
+                                                             (__int64)val, (__int64)compare);
+#else
+    return __sync_val_compare_and_swap(address, compare, val);
+#endif
+}
+
+/**
+ * @brief Hash of a key of up to 32 bits (the MurmurHash3 finalizer).
+ */
+__host__ __device__ inline
+unsigned int uniqueHash(unsigned int k)
+{
+    k ^= k >> 16;
+    k *= 0x85ebca6b;
+    k ^= k >> 13;
+    k *= 0xc2b2ae35;
+    k ^= k >> 16;
+    return k;
+}
+
+/**
+ * @brief Record that \a key occurs at index \a i.
+ *
+ * @param[in,out] d_table Hash table of a power of two slots
+ * @param[in] mask Number of slots minus one
+ * @param[in] key The key's bits
+ * @param[in] i The index
+ */
+__host__ __device__ inline
+void uniqueInsert(unsigned long long *d_table, size_t mask, unsigned int key, size_t i)
+{
+    volatile unsigned long long *table = d_table;
+    unsigned long long word = ((unsigned long long)(i + 1) << 32) | key;
+
+    for (size_t s = uniqueHash(key) & mask; ; s = (s + 1) & mask)
+    {
+        unsigned long long cur = table[s];
+        if (cur == 0)
+        {
+            cur = uniqueCompareAndSwap(d_table + s, 0, word);
+            if (cur == 0)
+                return;
+        }
+        if ((unsigned int)cur == key)
+        {
+            // the same key: the smaller word has the smaller index
+            while (cur > word)
+            {
+                unsigned long long prev = uniqueCompareAndSwap(d_table + s, cur, word);
+                if (prev == cur)
+                    break;
+                cur = prev;
+            }
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Smallest index at which \a key occurs; the key must have been
+ * inserted.
+ */
+__host__ __device__ inline
+size_t uniqueFirstIndex(const unsigned long long *d_table, size_t mask, unsigned int key)
+{
+    for (size_t s = uniqueHash(key) & mask; ; s = (s + 1) & mask)
+    {
+        unsigned long long cur = d_table[s];
+        if ((unsigned int)cur == key && cur != 0)
+            return (size_t)(cur >> 32) - 1;
+    }
+}
+
+/**
+ * @brief Keeps the first element of each run of equal keys.
+ */
+template <typename K>
+class UniqueSortedHead
+{
+public:
+    __host__ __device__ UniqueSortedHead(const K *d_keys) : m_keys(d_keys) {}
+    __host__ __device__ bool operator()(size_t i) const
+    {
+        return (i == 0) || (m_keys[i] != m_keys[i-1]);
+    }
+    const K *m_keys;
+};
+
+/**
+ * @brief Keeps the first occurrence of each key, as recorded by
+ * uniqueInsert().
+ */
+template <typename K>
+class UniqueFirstOccurrence
+{
+public:
+    __host__ __device__ UniqueFirstOccurrence(const K *d_keys,
+                                              const unsigned long long *d_table,
+                                              size_t mask)
+        : m_keys(d_keys), m_table(d_table), m_mask(mask) {}
+    __host__ __device__ bool operator()(size_t i) const
+    {
+        return uniqueFirstIndex(m_table, m_mask, (unsigned int)m_keys[i]) == i;
+    }
+    const K *m_keys;
+    const unsigned long long *m_table;
+    size_t m_mask;
+};
+
+/**
+ * @brief Record the index of every key in the hash table.
+ */
+template <typename K>
+__global__ void unique_insert(unsigned long long  *d_table,
+                              size_t              mask,
+                              const K             *d_keys,
+                              size_t              numElements)
+{
+    for (size_t i = threadIdx.x + (blockIdx.x * blockDim.x); i < numElements;
+         i += gridDim.x * blockDim.x)
+    {
+        uniqueInsert(d_table, mask, (unsigned int)d_keys[i], i);
+    }
+}
+
+/**
+ * @brief Count the kept elements of each tile.
+ *
+ * @param[out] d_tileCount Number of kept elements of each tile
+ * @param[in] keep Whether to keep each element
+ * @param[in] numElements Number of elements
+ * @param[in] numTiles Number of tiles
+ */
+template <class Pred>
+__global__ void unique_tile_count(unsigned int    *d_tileCount,
+                                  Pred            keep,
+                                  size_t          numElements,
+                                  size_t          numTiles)
+{
+    for (size_t t = threadIdx.x + (blockIdx.x * blockDim.x); t < numTiles;
+         t += gridDim.x * blockDim.x)
+    {
+        size_t begin = t * UNIQUE_ITEMS_PER_THREAD;
+        size_t end = (begin + UNIQUE_ITEMS_PER_THREAD < numElements) ?
+                     begin + UNIQUE_ITEMS_PER_THREAD : numElements;
+
+        unsigned int count = 0;
+        for (size_t i = begin; i < end; ++i)
+            count += keep(i) ? 1 : 0;
+        d_tileCount[t] = count;
+    }
+}
+
+/**
+ * @brief Write the kept elements of each tile at their ranks.
+ *
+ * @param[out] d_keysOut Kept keys
+ * @param[out] d_valuesOut Values of the kept keys, or NULL
+ * @param[in] d_keys Keys
+ * @param[in] d_values Values, or NULL
+ * @param[in] d_tileOffset Exclusive scan of the tile counts
+ * @param[in] keep Whether to keep each element
+ * @param[in] numElements Number of elements
+ * @param[in] numTiles Number of tiles
+ */
+template <typename K, class Pred>
+__global__ void unique_tile_scatter(K                   *d_keysOut,
+                                    unsigned int        *d_valuesOut,
+                                    const K             *d_keys,
+                                    const unsigned int  *d_values,
+                                    const unsigned int  *d_tileOffset,
+                                    Pred                keep,
+                                    size_t              numElements,
+                                    size_t              numTiles)
+{
+    for (size_t t = threadIdx.x + (blockIdx.x * blockDim.x); t < numTiles;
+         t += gridDim.x * blockDim.x)
+    {
+        size_t begin = t * UNIQUE_ITEMS_PER_THREAD;
+        size_t end = (begin + UNIQUE_ITEMS_PER_THREAD < numElements) ?
+                     begin + UNIQUE_ITEMS_PER_THREAD : numElements;
+
+        unsigned int out = d_tileOffset[t];
+        for (size_t i = begin; i < end; ++i)
+        {
+            if (!keep(i))
+                continue;
+            d_keysOut[out] = d_keys[i];
+            if (d_valuesOut != NULL)
+                d_valuesOut[out] = d_values[i];
+            ++out;
+        }
+    }
+}
+
+/** @} */ // end unique functions
+/** @} */ // end cudpp_kernel